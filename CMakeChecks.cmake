@@ -1175,6 +1175,41 @@ macro(Disable_Dyld)
 	BB_Save_Undef(HAVE_DYLD_RETURN_ON_ERROR)
 endmacro()
 
+#
+# From BSDBuild/epoll.pm:
+#
+macro(Check_Epoll)
+	check_c_source_compiles("
+#include <sys/epoll.h>
+
+int
+main(int argc, char *argv[])
+{
+	struct epoll_event ev;
+	int fd;
+
+	if ((fd = epoll_create1(EPOLL_CLOEXEC)) == -1) {
+		return (1);
+	}
+	ev.events = EPOLLIN;
+	ev.data.fd = 0;
+	if (epoll_ctl(fd, EPOLL_CTL_ADD, 0, &ev) == -1) {
+		return (1);
+	}
+	return (epoll_wait(fd, &ev, 1, 0) == -1);
+}
+" HAVE_EPOLL)
+	if (HAVE_EPOLL)
+		BB_Save_Define(HAVE_EPOLL)
+	else()
+		BB_Save_Undef(HAVE_EPOLL)
+	endif()
+endmacro()
+
+macro(Disable_Epoll)
+	BB_Save_Undef(HAVE_EPOLL)
+endmacro()
+
 #
 # From BSDBuild/execvp.pm:
 #
@@ -1789,6 +1824,46 @@ macro(Disable_Math_C99)
 	BB_Save_MakeVar(MATH_C99_LIBS "")
 endmacro()
 
+#
+# From BSDBuild/mmap.pm:
+#
+macro(Check_Mmap)
+	check_c_source_compiles("
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+int
+main(int argc, char *argv[])
+{
+	void *p;
+	int fd;
+
+	if ((fd = open(\"conftest.c\", O_RDONLY)) == -1) {
+		return (1);
+	}
+	p = mmap(NULL, 1, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (p == MAP_FAILED) {
+		return (1);
+	}
+	(void)madvise(p, 1, MADV_SEQUENTIAL);
+	munmap(p, 1);
+	close(fd);
+	return (0);
+}
+" HAVE_MMAP)
+	if (HAVE_MMAP)
+		BB_Save_Define(HAVE_MMAP)
+	else()
+		BB_Save_Undef(HAVE_MMAP)
+	endif()
+endmacro()
+
+macro(Disable_Mmap)
+	BB_Save_Undef(HAVE_MMAP)
+endmacro()
+
 #
 # From BSDBuild/mprotect.pm:
 #
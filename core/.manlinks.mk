@@ -37,6 +37,12 @@ MANLINKS+=AG_DataSource.3:AG_OpenFileHandle.3
 MANLINKS+=AG_DataSource.3:AG_OpenCore.3
 MANLINKS+=AG_DataSource.3:AG_OpenConstCore.3
 MANLINKS+=AG_DataSource.3:AG_OpenAutoCore.3
+MANLINKS+=AG_DataSource.3:AG_OpenMappedFile.3
+MANLINKS+=AG_DataSource.3:AG_CloseMappedFile.3
+MANLINKS+=AG_DataSource.3:AG_MappedFileAdvise.3
+MANLINKS+=AG_DataSource.3:AG_BorrowData.3
+MANLINKS+=AG_DataSource.3:AG_BorrowDataP.3
+MANLINKS+=AG_DataSource.3:AG_BorrowDataAt.3
 MANLINKS+=AG_DataSource.3:AG_OpenNetSocket.3
 MANLINKS+=AG_DataSource.3:AG_CloseDataSource.3
 MANLINKS+=AG_DataSource.3:AG_Read.3
@@ -58,6 +64,9 @@ MANLINKS+=AG_DataSource.3:AG_DataSourceDestroy.3
 MANLINKS+=AG_DataSource.3:AG_DataSourceSetErrorFn.3
 MANLINKS+=AG_DataSource.3:AG_DataSourceError.3
 MANLINKS+=AG_DataSource.3:AG_DataSourceRealloc.3
+MANLINKS+=AG_DataSource.3:AG_SetSourceBuffer.3
+MANLINKS+=AG_DataSource.3:AG_FlushDataSource.3
+MANLINKS+=AG_DataSource.3:AG_SyncDataSource.3
 MANLINKS+=AG_DataSource.3:AG_ReadUint8.3
 MANLINKS+=AG_DataSource.3:AG_ReadSint8.3
 MANLINKS+=AG_DataSource.3:AG_ReadUint16.3
@@ -84,6 +93,18 @@ MANLINKS+=AG_DataSource.3:AG_WriteSint32At.3
 MANLINKS+=AG_DataSource.3:AG_WriteUint64At.3
 MANLINKS+=AG_DataSource.3:AG_WriteSint64At.3
 MANLINKS+=AG_DataSource.3:AG_ReadFloat.3
+MANLINKS+=AG_DataSource.3:AG_ReadUint8v.3
+MANLINKS+=AG_DataSource.3:AG_ReadUint16v.3
+MANLINKS+=AG_DataSource.3:AG_ReadUint32v.3
+MANLINKS+=AG_DataSource.3:AG_ReadUint64v.3
+MANLINKS+=AG_DataSource.3:AG_WriteUint8v.3
+MANLINKS+=AG_DataSource.3:AG_WriteUint16v.3
+MANLINKS+=AG_DataSource.3:AG_WriteUint32v.3
+MANLINKS+=AG_DataSource.3:AG_WriteUint64v.3
+MANLINKS+=AG_DataSource.3:AG_ReadFloatv.3
+MANLINKS+=AG_DataSource.3:AG_WriteFloatv.3
+MANLINKS+=AG_DataSource.3:AG_ReadDoublev.3
+MANLINKS+=AG_DataSource.3:AG_WriteDoublev.3
 MANLINKS+=AG_DataSource.3:AG_ReadDouble.3
 MANLINKS+=AG_DataSource.3:AG_WriteFloat.3
 MANLINKS+=AG_DataSource.3:AG_WriteFloatAt.3
@@ -234,8 +255,10 @@ MANLINKS+=AG_Object.3:AG_LoadClass.3
 MANLINKS+=AG_Object.3:AG_RegisterModuleDirectory.3
 MANLINKS+=AG_Object.3:AG_UnregisterModuleDirectory.3
 MANLINKS+=AG_Object.3:AG_OfClass.3
+MANLINKS+=AG_Object.3:AG_ClassIsA.3
 MANLINKS+=AG_Object.3:AG_ObjectGetClassName.3
 MANLINKS+=AG_Object.3:AG_ObjectSuperclass.3
+MANLINKS+=AG_Object.3:AG_ObjectGetClassHier.3
 MANLINKS+=AG_Object.3:AG_ObjectGetInheritHier.3
 MANLINKS+=AG_Object.3:AGOBJECT_FOREACH_CLASS.3
 MANLINKS+=AG_Object.3:AG_Class.3
@@ -19,6 +19,8 @@ typedef Uint32 (*AG_TimerFn)(struct ag_timer *_Nonnull, AG_Event *_Nonnull);
 typedef struct ag_timer_pvt {
 	AG_TAILQ_ENTRY(ag_timer) timers;
 	AG_TAILQ_ENTRY(ag_timer) change;
+	Uint heapIdx;			/* Position in soft timer heap (1-based) */
+	Uint32 _pad;
 } AG_TimerPvt;
 
 typedef struct ag_timer {
@@ -37,6 +39,21 @@ typedef struct ag_timer {
 	char name[AG_TIMER_NAME_MAX];	/* Name string (optional) */
 } AG_Timer;
 
+#define AG_TIMEOUT_NONE 0xffffffff	/* No timer scheduled */
+
+/* Soft timer statistics (see AG_GetTimerStats()). */
+#define AG_TIMER_LATE_BUCKETS 8	/* 0, 1, 2-3, 4-7, ..., 64+ ticks late */
+
+typedef struct ag_timer_stats {
+	Uint nArmed;			/* Soft timers currently scheduled */
+	Uint nExpiredLast;		/* Expired in last AG_ProcessTimeouts() */
+	Uint nExpiredMax;		/* Most expired in one AG_ProcessTimeouts() */
+	Uint32 _pad;
+	Ulong nExpiredTotal;		/* Total expirations */
+	Ulong nTicks;			/* Total AG_ProcessTimeouts() calls */
+	Ulong late[AG_TIMER_LATE_BUCKETS]; /* Late-fire histogram (log2 ticks) */
+} AG_TimerStats;
+
 typedef struct ag_time_ops {
 	const char *_Nonnull name;
 
@@ -70,7 +87,7 @@ void AG_SetTimeOps(const AG_TimeOps *_Nullable);
 #ifdef AG_TIMERS
 /*
  * Managed timers which can be owned by objects and mapped to either
- * kernel/hardware timers, or entries in a software timing wheel.
+ * kernel/hardware timers, or entries in a software timer heap.
  */
 extern struct ag_objectq       agTimerObjQ;
 extern Uint                    agTimerCount;
@@ -94,6 +111,9 @@ int  AG_TimerIsRunning(void *_Nullable, AG_Timer *_Nonnull)
                       _Pure_Attribute;
 Uint32 AG_ExecTimer(AG_Timer *_Nonnull);
 void AG_ProcessTimeouts(Uint32);
+Uint32 AG_NextTimeout(Uint32);
+void AG_GetTimerStats(AG_TimerStats *_Nonnull);
+void AG_ResetTimerStats(void);
 
 # ifdef AG_LEGACY
 #  define AG_Timeout AG_Timer
@@ -35,6 +35,7 @@ typedef enum ag_class {
 	AGC_DRIVER_SDLGL    = 0x05010002,      /* AG_DriverSDLGL */
 	AGC_DRIVER_SDL2FB   = 0x05010003,      /* AG_DriverSDL2FB */
 	AGC_DRIVER_SDL2GL   = 0x05010004,      /* AG_DriverSDL2GL */
+	AGC_DRIVER_HEADLESS = 0x05010005,      /* AG_DriverHEADLESS */
 	AGC_DRIVER_MW       = 0x05020000,  /* AG_Driver -> AG_DriverMw (non-instantiatable) */
 	AGC_DRIVER_DUMMY    = 0x05020001,      /* AG_DriverDUMMY */
 	AGC_DRIVER_GLX      = 0x05020002,      /* AG_DriverGLX */
@@ -93,6 +93,7 @@ X86_HaveCPUID(void)
 	return (rv);
 }
 
+/* Execute CPUID for leaf fn (with subleaf 0). */
 static struct cpuid_regs /* _Pure_Attribute */
 X86_GetCPUID(int fn)
 {
@@ -104,7 +105,7 @@ X86_GetCPUID(int fn)
 		".byte 0x0f, 0xa2\n"
 		"xchg %%esi, %%ebx\n"
 		: "=a" (regs.a), "=S" (regs.b), "=c" (regs.c), "=d" (regs.d)
-		: "0" (fn));
+		: "0" (fn), "2" (0));
 
 #elif defined(__x86_64__)
 	__asm(
@@ -112,10 +113,23 @@ X86_GetCPUID(int fn)
 		".byte 0x0f, 0xa2\n"
 		"xchg %%rsi, %%rbx\n"
 		: "=a" (regs.a), "=S" (regs.b), "=c" (regs.c), "=d" (regs.d)
-		: "0" (fn));
+		: "0" (fn), "2" (0));
 #endif
 	return (regs);
 }
+
+/* Return the low 32 bits of extended control register XCR0 (XGETBV). */
+static Uint32
+X86_GetXCR0(void)
+{
+	Uint32 lo, hi;
+
+	__asm(
+		".byte 0x0f, 0x01, 0xd0\n"
+		: "=a" (lo), "=d" (hi)
+		: "c" (0));
+	return (lo);
+}
 #endif /* __GNUC__ && (__i386__ || __x86_64__) */
 
 #if defined(__i386__) || defined(i386) || defined(__x86_64__)
@@ -289,6 +303,20 @@ AG_GetCPUInfo(AG_CPUInfo *_Nonnull cpu)
 		if (rExt.c & 0x00000200) cpu->ext |= AG_EXT_SSSE3;
 		if (rExt.c & 0x00080000) cpu->ext |= AG_EXT_SSE41;
 		if (rExt.c & 0x00100000) cpu->ext |= AG_EXT_SSE42;
+
+		/*
+		 * AVX requires OS support for saving the YMM state
+		 * (OSXSAVE set and XCR0 enabling both XMM and YMM).
+		 */
+		if ((rExt.c & 0x18000000) == 0x18000000 &&
+		    (X86_GetXCR0() & 0x6) == 0x6) {
+			cpu->ext |= AG_EXT_AVX;
+			if (maxFns >= 7) {
+				rExt = X86_GetCPUID(7);
+				if (rExt.b & 0x00000020)
+					cpu->ext |= AG_EXT_AVX2;
+			}
+		}
 	}
 #endif /* i386 or x86_64 */
 
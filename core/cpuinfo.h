@@ -39,8 +39,8 @@ typedef struct ag_cpuinfo {
 #define AG_EXT_SSSE3		0x01000000 /* SSSE3 Extensions */
 #define AG_EXT_SSE41		0x02000000 /* SSE4.1 extensions */
 #define AG_EXT_SSE42		0x04000000 /* SSE4.2 extensions */
-
-	/* TODO: AVX */
+#define AG_EXT_AVX		0x08000000 /* AVX extensions (with OS support) */
+#define AG_EXT_AVX2		0x10000000 /* AVX2 extensions (with OS support) */
 
 	Uint32 icon;                         /* Graphical Icon (Unicode) */
 } AG_CPUInfo;
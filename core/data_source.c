@@ -33,11 +33,25 @@
 #include <agar/core/core.h>
 
 #include <agar/config/have_fdclose.h>
+#include <agar/config/have_mmap.h>
+#include <agar/config/_mk_have_unistd_h.h>
 
 #include <stdio.h>
 #include <string.h>
 #include <stdarg.h>
 
+#ifdef HAVE_MMAP
+# include <sys/types.h>
+# include <sys/stat.h>
+# include <sys/mman.h>
+# include <fcntl.h>
+# include <unistd.h>
+# include <errno.h>
+#elif defined(_MK_HAVE_UNISTD_H)
+# include <unistd.h>
+# include <errno.h>
+#endif
+
 static AG_Object errorMgr;
 
 void
@@ -144,6 +158,266 @@ AG_CheckTypeCode(AG_DataSource *ds, Uint32 type)
 	return (i == type) ? 0 : -1;
 }
 
+/*
+ * Release any buffered input (moving the position of the underlying source
+ * back to the first unread byte) and write out any buffered output.
+ * The data source must be locked.
+ */
+static int
+SyncBuffer(AG_DataSource *_Nonnull ds)
+{
+	AG_Size len, nWrote;
+
+	if (ds->rdCur != ds->rdEnd &&
+	    ds->seek(ds, -(AG_Offset)AG_DATA_SOURCE_RDAVAIL(ds), AG_SEEK_CUR) == -1) {
+		ds->rdCur = ds->rdEnd = NULL;
+		return (-1);
+	}
+	ds->rdCur = ds->rdEnd = NULL;
+
+	if (ds->wrCur != NULL) {
+		len = (AG_Size)(ds->wrCur - ds->buf);
+		ds->wrCur = ds->wrEnd = NULL;
+		if (len > 0) {
+			if (ds->write(ds, ds->buf, len, &nWrote) != 0) {
+				return (-1);
+			}
+			ds->wrTotal += nWrote;
+			if (nWrote < len) {
+				AG_SetErrorS("Short write");
+				return (-1);
+			}
+		}
+	}
+	return (0);
+}
+
+/* Refill the input buffer (an empty buffer indicates end of data). */
+static int
+FillBuffer(AG_DataSource *_Nonnull ds)
+{
+	AG_Size nRead;
+
+	if (ds->fill != NULL) {
+		return ds->fill(ds);
+	}
+	if (ds->read(ds, ds->buf, ds->bufSize, &nRead) != 0) {
+		return (-1);
+	}
+	ds->rdTotal += nRead;
+	ds->rdCur = ds->buf;
+	ds->rdEnd = ds->buf + nRead;
+	return (0);
+}
+
+/*
+ * Switch the buffer between input and output. As with stdio (which file
+ * sources are built upon), a stream source must be flushed between output
+ * and input, and repositioned between input and output.
+ */
+static int
+SwitchBuffer(AG_DataSource *_Nonnull ds)
+{
+	const int output = (ds->wrCur != NULL);
+
+	if (SyncBuffer(ds) == -1) {
+		return (-1);
+	}
+	if (ds->flush == NULL) {			/* Not a stream */
+		return (0);
+	}
+	return (output) ? ds->flush(ds, 0) : ds->seek(ds, 0, AG_SEEK_CUR);
+}
+
+/* Read through the input buffer. The data source must be locked. */
+static int
+ReadBuffered(AG_DataSource *_Nonnull ds, void *_Nonnull ptr, AG_Size size,
+    AG_Size *_Nonnull nRead)
+{
+	Uint8 *dst = ptr;
+	AG_Size avail, n = 0, nDirect;
+	int rv;
+
+	if (ds->wrCur != NULL && SwitchBuffer(ds) == -1) {
+		*nRead = 0;
+		return (-1);
+	}
+	if (ds->buf == NULL && ds->fill == NULL) {
+		rv = ds->read(ds, ptr, size, nRead);
+		ds->rdTotal += *nRead;
+		return (rv);
+	}
+	while (n < size) {
+		if ((avail = AG_DATA_SOURCE_RDAVAIL(ds)) >= size-n) {
+			memcpy(&dst[n], ds->rdCur, size-n);
+			ds->rdCur += size-n;
+			n = size;
+			break;
+		}
+		if (avail > 0) {
+			memcpy(&dst[n], ds->rdCur, avail);
+			n += avail;
+		}
+		ds->rdCur = ds->rdEnd = NULL;
+
+		if (ds->fill == NULL && size-n >= ds->bufSize) {
+			/* Bypass the buffer for large reads. */
+			rv = ds->read(ds, &dst[n], size-n, &nDirect);
+			ds->rdTotal += nDirect;
+			ds->rdCur = ds->rdEnd = ds->buf;	/* Still input */
+			n += nDirect;
+			if (rv != 0) {
+				*nRead = n;
+				return (-1);
+			}
+			break;
+		}
+		if (FillBuffer(ds) == -1) {
+			*nRead = n;
+			return (-1);
+		}
+		if (ds->rdCur == ds->rdEnd)		/* End of data */
+			break;
+	}
+	*nRead = n;
+	return (0);
+}
+
+/* Write through the output buffer. The data source must be locked. */
+static int
+WriteBuffered(AG_DataSource *_Nonnull ds, const void *_Nonnull ptr,
+    AG_Size size, AG_Size *_Nonnull nWrote)
+{
+	int rv;
+
+	if (ds->rdCur != NULL && SwitchBuffer(ds) == -1) {
+		*nWrote = 0;
+		return (-1);
+	}
+	if (ds->buf != NULL) {
+		if (ds->wrCur == NULL) {
+			ds->wrCur = ds->buf;
+			ds->wrEnd = ds->buf + ds->bufSize;
+		}
+		if (size <= AG_DATA_SOURCE_WRAVAIL(ds)) {
+			memcpy(ds->wrCur, ptr, size);
+			ds->wrCur += size;
+			*nWrote = size;
+			return (0);
+		}
+		if (SyncBuffer(ds) == -1) {
+			*nWrote = 0;
+			return (-1);
+		}
+		if (size < ds->bufSize) {
+			memcpy(ds->buf, ptr, size);
+			ds->wrCur = ds->buf + size;
+			ds->wrEnd = ds->buf + ds->bufSize;
+			*nWrote = size;
+			return (0);
+		}
+		/* Bypass the buffer for large writes. */
+		rv = ds->write(ds, ptr, size, nWrote);
+		ds->wrTotal += *nWrote;
+		ds->wrCur = ds->buf;			/* Still output */
+		ds->wrEnd = ds->buf + ds->bufSize;
+		return (rv);
+	}
+	rv = ds->write(ds, ptr, size, nWrote);
+	ds->wrTotal += *nWrote;
+	return (rv);
+}
+
+/*
+ * Write at an offset. Data falling within the output buffer is updated in
+ * place. The data source must be locked.
+ */
+static int
+WriteAtBuffered(AG_DataSource *_Nonnull ds, const void *_Nonnull ptr,
+    AG_Size size, AG_Offset pos, AG_Size *_Nonnull nWrote)
+{
+	AG_Offset base;
+	int rv;
+
+	if (ds->wrCur != NULL && ds->tell != NULL) {
+		base = ds->tell(ds);
+		if (pos >= base &&
+		    pos+size <= base + (AG_Offset)(ds->wrCur - ds->buf)) {
+			memcpy(&ds->buf[pos - base], ptr, size);
+			*nWrote = size;
+			return (0);
+		}
+	}
+	if ((ds->rdCur != NULL || ds->wrCur != NULL) && SyncBuffer(ds) == -1) {
+		*nWrote = 0;
+		return (-1);
+	}
+	rv = ds->write_at(ds, ptr, size, pos, nWrote);
+	ds->wrTotal += *nWrote;
+	return (rv);
+}
+
+/*
+ * Write out any buffered output and release any buffered input, such that
+ * the position of the underlying source matches AG_Tell().
+ */
+int
+AG_FlushDataSource(AG_DataSource *ds)
+{
+	int rv;
+
+	AG_MutexLock(&ds->lock);
+	if ((rv = SyncBuffer(ds)) == 0 && ds->flush != NULL) {
+		rv = ds->flush(ds, 0);
+	}
+	AG_MutexUnlock(&ds->lock);
+	return (rv);
+}
+
+/*
+ * Flush the data source as AG_FlushDataSource() does, and also commit the
+ * written data to stable storage where the source supports it (as with
+ * fsync(2) for files).
+ */
+int
+AG_SyncDataSource(AG_DataSource *ds)
+{
+	int rv;
+
+	AG_MutexLock(&ds->lock);
+	if ((rv = SyncBuffer(ds)) == 0 && ds->flush != NULL) {
+		rv = ds->flush(ds, 1);
+	}
+	AG_MutexUnlock(&ds->lock);
+	return (rv);
+}
+
+/*
+ * Set the size of the I/O buffer of a data source (0 = unbuffered).
+ * Sources returned by AG_OpenFile() are buffered by default.
+ */
+int
+AG_SetSourceBuffer(AG_DataSource *ds, AG_Size size)
+{
+	Uint8 *bufNew = NULL;
+
+	AG_MutexLock(&ds->lock);
+	if (SyncBuffer(ds) == -1) {
+		goto fail;
+	}
+	if (size > 0 && (bufNew = TryMalloc(size)) == NULL) {
+		goto fail;
+	}
+	Free(ds->buf);
+	ds->buf = bufNew;
+	ds->bufSize = size;
+	AG_MutexUnlock(&ds->lock);
+	return (0);
+fail:
+	AG_MutexUnlock(&ds->lock);
+	return (-1);
+}
+
 /* Reallocate the buffer of a dynamically-allocated memory source. */
 int
 AG_DataSourceRealloc(void *obj, AG_Size size)
@@ -151,6 +425,9 @@ AG_DataSourceRealloc(void *obj, AG_Size size)
 	AG_CoreSource *cs = (AG_CoreSource *)obj;
 	Uint8 *dataNew;
 		
+	if (SyncBuffer(&cs->ds) == -1) {
+		return (-1);
+	}
 	if ((dataNew = (Uint8 *)AG_TryRealloc(cs->data, size)) == NULL) {
 		return (-1);
 	}
@@ -167,6 +444,10 @@ AG_Tell(AG_DataSource *ds)
 
 	AG_MutexLock(&ds->lock);
 	pos = (ds->tell != NULL) ? ds->tell(ds) : 0;
+	pos -= (AG_Offset)AG_DATA_SOURCE_RDAVAIL(ds);
+	if (ds->wrCur != NULL) {
+		pos += (AG_Offset)(ds->wrCur - ds->buf);
+	}
 	AG_MutexUnlock(&ds->lock);
 	return (pos);
 }
@@ -178,7 +459,15 @@ AG_Seek(AG_DataSource *ds, AG_Offset pos, enum ag_seek_mode mode)
 	int rv;
 
 	AG_MutexLock(&ds->lock);
-	rv = ds->seek(ds, pos, mode);
+	if (mode == AG_SEEK_CUR && ds->rdCur != NULL && pos >= 0 &&
+	    (AG_Size)pos <= AG_DATA_SOURCE_RDAVAIL(ds)) {
+		ds->rdCur += pos;			/* Within input buffer */
+		AG_MutexUnlock(&ds->lock);
+		return (0);
+	}
+	if ((rv = SyncBuffer(ds)) == 0) {
+		rv = ds->seek(ds, pos, mode);
+	}
 	AG_MutexUnlock(&ds->lock);
 	return (rv);
 }
@@ -194,6 +483,7 @@ AG_CloseDataSource(AG_DataSource *ds)
 void
 AG_DataSourceDestroy(AG_DataSource *ds)
 {
+	Free(ds->buf);
 	AG_MutexDestroy(&ds->lock);
 	AG_Free(ds);
 }
@@ -310,6 +600,23 @@ fail_seek:
 	AG_SetErrorS("fseek failed");
 	return (-1);
 }
+static int
+FileFlush(AG_DataSource *_Nonnull ds, int sync)
+{
+	FILE *f = AG_FILE_SOURCE(ds)->file;
+
+	if (fflush(f) != 0) {
+		AG_SetErrorS(_("Write error"));
+		return (-1);
+	}
+#ifdef _MK_HAVE_UNISTD_H
+	if (sync && fsync(fileno(f)) == -1) {
+		AG_SetError("fsync: %s", AG_Strerror(errno));
+		return (-1);
+	}
+#endif
+	return (0);
+}
 static AG_Offset
 FileTell(AG_DataSource *_Nonnull ds)
 {
@@ -351,6 +658,36 @@ CoreRead(AG_DataSource *_Nonnull ds, void *_Nonnull buf, AG_Size len,
 	return (0);
 }
 static int
+CoreFill(AG_DataSource *_Nonnull ds)
+{
+	AG_CoreSource *cs = AG_CORE_SOURCE(ds);
+
+	/* Read directly from memory. */
+	if (cs->data == NULL || (AG_Size)cs->offs >= cs->size) {
+		ds->rdCur = ds->rdEnd = NULL;
+		return (0);
+	}
+	ds->rdCur = &cs->data[cs->offs];
+	ds->rdEnd = &cs->data[cs->size];
+	ds->rdTotal += cs->size - (AG_Size)cs->offs;
+	cs->offs = (AG_Offset)cs->size;
+	return (0);
+}
+static const void *_Nullable
+CoreBorrow(AG_DataSource *_Nonnull ds, AG_Offset pos, AG_Size *_Nonnull len)
+{
+	AG_CoreSource *cs = AG_CORE_SOURCE(ds);
+
+	if (pos < 0 || (AG_Size)pos > cs->size || cs->data == NULL) {
+		AG_SetError("Bad offset %ld", (long)pos);
+		return (NULL);
+	}
+	if (*len > cs->size - (AG_Size)pos) {
+		*len = cs->size - (AG_Size)pos;
+	}
+	return (&cs->data[pos]);
+}
+static int
 CoreReadAt(AG_DataSource *_Nonnull ds, void *_Nonnull buf, AG_Size len,
     AG_Offset pos, AG_Size *_Nonnull rv)
 {
@@ -393,9 +730,9 @@ CoreAutoWrite(AG_DataSource *_Nonnull ds, const void *_Nonnull buf, AG_Size size
 			return (-1);
 		}
 		cs->data = dataNew;
+		cs->size = cs->offs+size;
 	}
 	memcpy(&cs->data[cs->offs], buf, size);
-	cs->size += size;
 	cs->offs += size;
 	*rv = size;
 	return (0);
@@ -460,7 +797,7 @@ CoreSeek(AG_DataSource *_Nonnull ds, AG_Offset offs, enum ag_seek_mode mode)
 		nOffs = cs->size - offs;
 		break;
 	}
-	if (nOffs < 0 || nOffs >= cs->size) {
+	if (nOffs < 0 || nOffs > cs->size) {
 		AG_SetError("Bad offset %ld", (long)nOffs);
 		return (-1);
 	}
@@ -470,15 +807,80 @@ CoreSeek(AG_DataSource *_Nonnull ds, AG_Offset offs, enum ag_seek_mode mode)
 void
 AG_CloseCore(AG_DataSource *_Nonnull ds)
 {
+	AG_FlushDataSource(ds);
 	AG_DataSourceDestroy(ds);
 }
 void
 AG_CloseAutoCore(AG_DataSource *_Nonnull ds)
 {
+	AG_FlushDataSource(ds);
 	Free(AG_CORE_SOURCE(ds)->data);
 	AG_DataSourceDestroy(ds);
 }
 
+/* Close a data source created by AG_OpenMappedFile(). */
+void
+AG_CloseMappedFile(AG_DataSource *_Nonnull ds)
+{
+#ifdef HAVE_MMAP
+	AG_MappedFileSource *mfs = AG_MAPPED_FILE_SOURCE(ds);
+
+	if (ds->close != AG_CloseMappedFile) {	/* Fallback file source */
+		ds->close(ds);
+		return;
+	}
+	if (mfs->map != NULL) {
+		munmap(mfs->map, mfs->mapSize);
+	}
+	Free(mfs->path);
+	AG_DataSourceDestroy(ds);
+#else
+	AG_CloseFile(ds);
+#endif
+}
+
+/*
+ * Advise the system of the expected access pattern (AG_MAPPED_*) over a
+ * range of a mapped file. A size of 0 extends the range to the end of the
+ * file. This is a no-op for other types of data sources.
+ */
+int
+AG_MappedFileAdvise(AG_DataSource *_Nonnull ds, AG_Offset pos, AG_Size size,
+    Uint flags)
+{
+#ifdef HAVE_MMAP
+	AG_MappedFileSource *mfs = AG_MAPPED_FILE_SOURCE(ds);
+	AG_Size pageSize, offs;
+	int advice;
+
+	if (ds->close != AG_CloseMappedFile || mfs->map == NULL)
+		return (0);
+
+	if (pos < 0 || (AG_Size)pos >= mfs->mapSize) {
+		AG_SetError("Bad offset %ld", (long)pos);
+		return (-1);
+	}
+	if (size == 0 || (AG_Size)pos+size > mfs->mapSize)
+		size = mfs->mapSize - (AG_Size)pos;
+
+	if      (flags & AG_MAPPED_SEQUENTIAL) { advice = MADV_SEQUENTIAL; }
+	else if (flags & AG_MAPPED_RANDOM)     { advice = MADV_RANDOM; }
+	else if (flags & AG_MAPPED_WILLNEED)   { advice = MADV_WILLNEED; }
+	else if (flags & AG_MAPPED_DONTNEED)   { advice = MADV_DONTNEED; }
+	else                                   { advice = MADV_NORMAL; }
+
+	/* The address must be page-aligned. */
+	pageSize = (AG_Size)sysconf(_SC_PAGESIZE);
+	offs = (AG_Size)pos - ((AG_Size)pos % pageSize);
+	if (madvise((Uint8 *)mfs->map + offs, size + ((AG_Size)pos - offs),
+	    advice) == -1) {
+		AG_SetError("madvise: %s", AG_Strerror(errno));
+		return (-1);
+	}
+#endif /* HAVE_MMAP */
+	return (0);
+}
+
 #ifdef AG_NETWORK
 /*
  * Network socket operations
@@ -502,6 +904,7 @@ NetSocketWrite(AG_DataSource *_Nonnull ds, const void *_Nonnull buf, AG_Size siz
 void
 AG_CloseNetSocket(AG_DataSource *_Nonnull ds)
 {
+	AG_FlushDataSource(ds);
 	AG_DataSourceDestroy(ds);
 }
 #endif /* AG_NETWORK */
@@ -533,6 +936,15 @@ AG_DataSourceInit(AG_DataSource *_Nonnull ds)
 	ds->tell = NULL;
 	ds->seek = NULL;
 	ds->close = NULL;
+	ds->fill = NULL;
+	ds->borrow = NULL;
+	ds->flush = NULL;
+	ds->rdCur = NULL;
+	ds->rdEnd = NULL;
+	ds->wrCur = NULL;
+	ds->wrEnd = NULL;
+	ds->buf = NULL;
+	ds->bufSize = 0;
 	AG_DataSourceSetErrorFn(ds, ErrorDefault, "%p", ds);
 }
 
@@ -552,6 +964,7 @@ AG_OpenFileHandle(void *_Nonnull pf)
 	fs->ds.write_at = FileWriteAt;
 	fs->ds.tell = FileTell;
 	fs->ds.seek = FileSeek;
+	fs->ds.flush = FileFlush;
 	fs->ds.close = AG_CloseFileHandle;
 	return (&fs->ds);
 }
@@ -562,6 +975,7 @@ AG_CloseFileHandle(AG_DataSource *_Nonnull ds)
 {
 	AG_FileSource *fs = AG_FILE_SOURCE(ds);
 
+	AG_FlushDataSource(ds);
 #ifdef HAVE_FDCLOSE
 	fdclose(fs->file, NULL);
 #else
@@ -576,6 +990,7 @@ AG_CloseFile(AG_DataSource *_Nonnull ds)
 {
 	AG_FileSource *fs = AG_FILE_SOURCE(ds);
 
+	AG_FlushDataSource(ds);
 	fclose(fs->file);
 	AG_Free(fs->path);
 	AG_DataSourceDestroy(ds);
@@ -602,7 +1017,11 @@ AG_OpenFile(const char *_Nonnull path, const char *_Nonnull mode)
 	fs->ds.write_at = FileWriteAt;
 	fs->ds.tell = FileTell;
 	fs->ds.seek = FileSeek;
+	fs->ds.flush = FileFlush;
 	fs->ds.close = AG_CloseFile;
+	if ((fs->ds.buf = TryMalloc(AG_DATA_SOURCE_BUFSIZE)) != NULL)
+		fs->ds.bufSize = AG_DATA_SOURCE_BUFSIZE;
+
 	return (&fs->ds);
 }
 
@@ -626,6 +1045,8 @@ AG_OpenCore(void *_Nonnull data, AG_Size size)
 	cs->ds.tell = CoreTell;
 	cs->ds.seek = CoreSeek;
 	cs->ds.close = AG_CloseCore;
+	cs->ds.fill = CoreFill;
+	cs->ds.borrow = CoreBorrow;
 	return (&cs->ds);
 }
 
@@ -649,6 +1070,8 @@ AG_OpenConstCore(const void *_Nonnull data, AG_Size size)
 	cs->ds.tell = CoreTell;
 	cs->ds.seek = CoreSeek;
 	cs->ds.close = AG_CloseCore;
+	cs->ds.fill = CoreFill;
+	cs->ds.borrow = CoreBorrow;
 	return (&cs->ds);
 }
 
@@ -672,9 +1095,85 @@ AG_OpenAutoCore(void)
 	cs->ds.tell = CoreTell;
 	cs->ds.seek = CoreSeek;
 	cs->ds.close = AG_CloseAutoCore;
+	cs->ds.fill = CoreFill;
+	cs->ds.borrow = CoreBorrow;
 	return (&cs->ds);
 }
 
+/*
+ * Create a read-only data source from a file mapped into memory. Reads are
+ * served from the mapping, and AG_BorrowData() returns pointers into it.
+ * Flags are AG_MAPPED_* access pattern hints (or 0).
+ *
+ * On platforms without mmap(), return a buffered file source instead.
+ */
+AG_DataSource *
+AG_OpenMappedFile(const char *_Nonnull path, Uint flags)
+{
+#ifdef HAVE_MMAP
+	static const Uint8 empty[1] = { 0 };
+	AG_MappedFileSource *mfs;
+	AG_ConstCoreSource *cs;
+	struct stat sb;
+	void *map = NULL;
+	int fd;
+
+	if ((fd = open(path, O_RDONLY)) == -1) {
+		AG_SetError(_("Unable to open %s"), path);
+		return (NULL);
+	}
+	if (fstat(fd, &sb) == -1) {
+		AG_SetError("%s: %s", path, AG_Strerror(errno));
+		goto fail_close;
+	}
+	if (!S_ISREG(sb.st_mode)) {		/* Pipe, device, etc. */
+		goto fallback;
+	}
+	if (sb.st_size > 0) {
+		map = mmap(NULL, (size_t)sb.st_size, PROT_READ, MAP_PRIVATE,
+		    fd, 0);
+		if (map == MAP_FAILED)
+			goto fallback;
+	}
+	close(fd);				/* The mapping persists */
+
+	if ((mfs = TryMalloc(sizeof(AG_MappedFileSource))) == NULL) {
+		if (map != NULL) { munmap(map, (size_t)sb.st_size); }
+		return (NULL);
+	}
+	cs = &mfs->cs;
+	AG_DataSourceInit(&cs->ds);
+	cs->data = (map != NULL) ? (const Uint8 *)map : empty;
+	cs->size = (AG_Size)sb.st_size;
+	cs->offs = 0;
+	cs->ds.read = CoreRead;
+	cs->ds.read_at = CoreReadAt;
+	cs->ds.write = WriteNotSup;
+	cs->ds.write_at = WriteAtNotSup;
+	cs->ds.tell = CoreTell;
+	cs->ds.seek = CoreSeek;
+	cs->ds.close = AG_CloseMappedFile;
+	cs->ds.fill = CoreFill;
+	cs->ds.borrow = CoreBorrow;
+	mfs->path = TryStrdup(path);
+	mfs->map = map;
+	mfs->mapSize = (AG_Size)sb.st_size;
+
+	if (flags != 0)
+		(void)AG_MappedFileAdvise(&cs->ds, 0, 0, flags);
+
+	return (&cs->ds);
+fallback:
+	close(fd);
+	return AG_OpenFile(path, "rb");	/* Use stdio instead */
+fail_close:
+	close(fd);
+	return (NULL);
+#else
+	return AG_OpenFile(path, "rb");
+#endif /* HAVE_MMAP */
+}
+
 #ifdef AG_NETWORK
 /* Create a data source using a network socket. */
 AG_DataSource *
@@ -733,8 +1232,7 @@ AG_Read(AG_DataSource *_Nonnull ds, void *_Nonnull ptr, AG_Size size)
 	int rv;
 
 	AG_MutexLock(&ds->lock);
-	rv = ds->read(ds, ptr, size, &ds->rdLast);
-	ds->rdTotal += ds->rdLast;
+	rv = ReadBuffered(ds, ptr, size, &ds->rdLast);
 	if (ds->rdLast < size) {
 		AG_SetErrorS("Short read");
 		rv = -1;
@@ -751,8 +1249,7 @@ AG_ReadP(AG_DataSource *_Nonnull ds, void *_Nonnull ptr, AG_Size size,
 	int rv;
 
 	AG_MutexLock(&ds->lock);
-	rv = ds->read(ds, ptr, size, &ds->rdLast);
-	ds->rdTotal += ds->rdLast;
+	rv = ReadBuffered(ds, ptr, size, &ds->rdLast);
 	if (nRead != NULL) { *nRead = ds->rdLast; }
 	AG_MutexUnlock(&ds->lock);
 	return (rv);
@@ -765,6 +1262,10 @@ AG_ReadAt(AG_DataSource *_Nonnull ds, void *_Nonnull ptr, AG_Size size, AG_Offse
 	int rv;
 
 	AG_MutexLock(&ds->lock);
+	if (ds->wrCur != NULL && SyncBuffer(ds) == -1) {
+		AG_MutexUnlock(&ds->lock);
+		return (-1);
+	}
 	rv = ds->read_at(ds, ptr, size, pos, &ds->rdLast);
 	ds->rdTotal += ds->rdLast;
 	if (ds->rdLast < size) {
@@ -783,6 +1284,10 @@ AG_ReadAtP(AG_DataSource *_Nonnull ds, void *_Nonnull ptr, AG_Size size, AG_Offs
 	int rv;
 
 	AG_MutexLock(&ds->lock);
+	if (ds->wrCur != NULL && SyncBuffer(ds) == -1) {
+		AG_MutexUnlock(&ds->lock);
+		return (-1);
+	}
 	rv = ds->read_at(ds, ptr, size, pos, &ds->rdLast);
 	ds->rdTotal += ds->rdLast;
 	if (nRead != NULL) { *nRead = ds->rdLast; }
@@ -790,6 +1295,81 @@ AG_ReadAtP(AG_DataSource *_Nonnull ds, void *_Nonnull ptr, AG_Size size, AG_Offs
 	return (rv);
 }
 
+/*
+ * Return a pointer to the next size bytes of a memory-backed source (such
+ * as AG_OpenMappedFile() or AG_OpenConstCore()) and advance past them,
+ * without copying. The data remains valid until the source is closed (or
+ * for AG_OpenAutoCore(), until it is written to). Return NULL if the source
+ * does not support borrowing or the range is out of bounds.
+ */
+const void *
+AG_BorrowData(AG_DataSource *_Nonnull ds, AG_Size size)
+{
+	return AG_BorrowDataP(ds, size, NULL);
+}
+
+/*
+ * Variant of AG_BorrowData() which allows partial results (up to the end
+ * of the data). If nBorrowed is NULL, partial results are treated as errors.
+ */
+const void *
+AG_BorrowDataP(AG_DataSource *_Nonnull ds, AG_Size size,
+    AG_Size *_Nullable nBorrowed)
+{
+	const void *p = NULL;
+	AG_Offset pos;
+	AG_Size len = size;
+
+	AG_MutexLock(&ds->lock);
+	if (ds->borrow == NULL) {
+		AG_SetErrorS("Data source is not memory-backed");
+		goto out;
+	}
+	if (SyncBuffer(ds) == -1) {
+		goto out;
+	}
+	pos = ds->tell(ds);
+	if ((p = ds->borrow(ds, pos, &len)) == NULL) {
+		goto out;
+	}
+	if (len < size && nBorrowed == NULL) {
+		AG_SetError("Out of bounds (@%lu+%lu)", (Ulong)pos, (Ulong)size);
+		p = NULL;
+		goto out;
+	}
+	if (ds->seek(ds, pos + (AG_Offset)len, AG_SEEK_SET) == -1) {
+		p = NULL;
+		goto out;
+	}
+	ds->rdLast = len;
+	ds->rdTotal += len;
+	if (nBorrowed != NULL) { *nBorrowed = len; }
+out:
+	AG_MutexUnlock(&ds->lock);
+	return (p);
+}
+
+/*
+ * Return a pointer to size bytes at offset pos of a memory-backed source,
+ * without moving the current position.
+ */
+const void *
+AG_BorrowDataAt(AG_DataSource *_Nonnull ds, AG_Size size, AG_Offset pos)
+{
+	const void *p = NULL;
+	AG_Size len = size;
+
+	AG_MutexLock(&ds->lock);
+	if (ds->borrow == NULL) {
+		AG_SetErrorS("Data source is not memory-backed");
+	} else if ((p = ds->borrow(ds, pos, &len)) != NULL && len < size) {
+		AG_SetError("Out of bounds (@%lu+%lu)", (Ulong)pos, (Ulong)size);
+		p = NULL;
+	}
+	AG_MutexUnlock(&ds->lock);
+	return (p);
+}
+
 /* Standard write operation (write complete or fail). */
 int
 AG_Write(AG_DataSource *_Nonnull ds, const void *_Nonnull ptr, AG_Size size)
@@ -797,8 +1377,7 @@ AG_Write(AG_DataSource *_Nonnull ds, const void *_Nonnull ptr, AG_Size size)
 	int rv;
 
 	AG_MutexLock(&ds->lock);
-	rv = ds->write(ds, ptr, size, &ds->wrLast);
-	ds->wrTotal += ds->wrLast;
+	rv = WriteBuffered(ds, ptr, size, &ds->wrLast);
 	if (ds->wrLast < size) {
 		AG_SetErrorS("Short write");
 		rv = -1;
@@ -815,8 +1394,7 @@ AG_WriteP(AG_DataSource *_Nonnull ds, const void *_Nonnull ptr, AG_Size size,
 	int rv;
 
 	AG_MutexLock(&ds->lock);
-	rv = ds->write(ds, ptr, size, &ds->wrLast);
-	ds->wrTotal += ds->wrLast;
+	rv = WriteBuffered(ds, ptr, size, &ds->wrLast);
 	if (nWrote != NULL) { *nWrote = ds->wrLast; }
 	AG_MutexUnlock(&ds->lock);
 	return (rv);
@@ -830,8 +1408,7 @@ AG_WriteAt(AG_DataSource *_Nonnull ds, const void *_Nonnull ptr,
 	int rv;
 
 	AG_MutexLock(&ds->lock);
-	rv = ds->write_at(ds, ptr, size, pos, &ds->wrLast);
-	ds->wrTotal += ds->wrLast;
+	rv = WriteAtBuffered(ds, ptr, size, pos, &ds->wrLast);
 	if (ds->wrLast < size) {
 		AG_SetErrorS("Short write");
 		rv = -1;
@@ -848,8 +1425,7 @@ AG_WriteAtP(AG_DataSource *_Nonnull ds, const void *_Nonnull ptr, AG_Size size,
 	int rv;
 
 	AG_MutexLock(&ds->lock);
-	rv = ds->write_at(ds, ptr, size, pos, &ds->wrLast);
-	ds->wrTotal += ds->wrLast;
+	rv = WriteAtBuffered(ds, ptr, size, pos, &ds->wrLast);
 	if (nWrote != NULL) { *nWrote = ds->wrLast; }
 	AG_MutexUnlock(&ds->lock);
 	return (rv);
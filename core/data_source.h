@@ -54,6 +54,18 @@ typedef struct ag_data_source {
 	AG_Size wrTotal;			/* Total write count (bytes) */
 	AG_Size rdTotal;			/* Total read count (bytes) */
 
+	/*
+	 * Buffered input and output, accessed without locking by the
+	 * primitive read and write routines. At most one of the two
+	 * buffers is active at any time.
+	 */
+	const Uint8 *_Nullable rdCur;		/* Next buffered input byte */
+	const Uint8 *_Nullable rdEnd;		/* End of buffered input */
+	Uint8 *_Nullable wrCur;			/* Next buffered output byte */
+	Uint8 *_Nullable wrEnd;			/* End of output buffer */
+	Uint8 *_Nullable buf;			/* I/O buffer (or NULL) */
+	AG_Size bufSize;			/* I/O buffer size (bytes) */
+
 	int   (*_Nullable read)(struct ag_data_source *_Nonnull,
 	                        void *_Nonnull, AG_Size,
 				AG_Size *_Nonnull);
@@ -70,8 +82,20 @@ typedef struct ag_data_source {
 	int   (*_Nullable seek)(struct ag_data_source *_Nonnull, AG_Offset,
 	                        enum ag_seek_mode);
 	void  (*_Nullable close)(struct ag_data_source *_Nonnull);
+	int   (*_Nullable fill)(struct ag_data_source *_Nonnull);
+	const void *_Nullable (*_Nullable borrow)(struct ag_data_source *_Nonnull,
+	                                          AG_Offset, AG_Size *_Nonnull);
+	int   (*_Nullable flush)(struct ag_data_source *_Nonnull, int);
 } AG_DataSource;
 
+#ifndef AG_DATA_SOURCE_BUFSIZE
+#define AG_DATA_SOURCE_BUFSIZE 8192	/* Default buffer size for files */
+#endif
+
+/* Bytes available in the input and output buffers of a data source. */
+#define AG_DATA_SOURCE_RDAVAIL(ds) ((AG_Size)((ds)->rdEnd - (ds)->rdCur))
+#define AG_DATA_SOURCE_WRAVAIL(ds) ((AG_Size)((ds)->wrEnd - (ds)->wrCur))
+
 /* File */
 typedef struct ag_file_source {
 	struct ag_data_source ds;
@@ -95,6 +119,20 @@ typedef struct ag_const_core_source {
 	AG_Offset offs;			/* Current position */
 } AG_ConstCoreSource;
 
+/* Memory-mapped file (read-only) */
+typedef struct ag_mapped_file_source {
+	struct ag_const_core_source cs;	/* Mapped region */
+	char *_Nullable path;		/* Mapped file path */
+	void *_Nullable map;		/* Mapping (NULL = empty file) */
+	AG_Size mapSize;		/* Size of mapping */
+} AG_MappedFileSource;
+
+/* Access pattern hints for AG_OpenMappedFile() and AG_MappedFileAdvise(). */
+#define AG_MAPPED_SEQUENTIAL	0x01	/* Read mostly sequentially */
+#define AG_MAPPED_RANDOM	0x02	/* Read in random order */
+#define AG_MAPPED_WILLNEED	0x04	/* Read ahead now */
+#define AG_MAPPED_DONTNEED	0x08	/* Release pages not needed soon */
+
 /* Network socket */
 typedef struct ag_net_socket_source {
 	struct ag_data_source ds;
@@ -105,6 +143,7 @@ typedef struct ag_net_socket_source {
 #define AG_FILE_SOURCE(ds) ((AG_FileSource *)(ds))
 #define AG_CORE_SOURCE(ds) ((AG_CoreSource *)(ds))
 #define AG_CONST_CORE_SOURCE(ds) ((AG_ConstCoreSource *)(ds))
+#define AG_MAPPED_FILE_SOURCE(ds) ((AG_MappedFileSource *)(ds))
 #define AG_NET_SOCKET_SOURCE(ds) ((AG_NetSocketSource *)(ds))
 
 /* For AG_Write<Type>At() */
@@ -127,6 +166,7 @@ void AG_DataSourceError(AG_DataSource *_Nonnull, const char *_Nullable, ...);
 
 AG_ByteOrder AG_SetByteOrder(AG_DataSource *_Nonnull, AG_ByteOrder);
 int          AG_SetSourceDebug(AG_DataSource *_Nonnull, int);
+int          AG_SetSourceBuffer(AG_DataSource *_Nonnull, AG_Size);
 
 AG_DataSource *_Nullable AG_OpenFile(const char *_Nonnull, const char *_Nonnull)
                                      _Warn_Unused_Result;
@@ -134,6 +174,8 @@ AG_DataSource *_Nullable AG_OpenFileHandle(void *_Nonnull) _Warn_Unused_Result;
 AG_DataSource *_Nullable AG_OpenCore(void *_Nonnull, AG_Size) _Warn_Unused_Result;
 AG_DataSource *_Nullable AG_OpenConstCore(const void *_Nonnull, AG_Size) _Warn_Unused_Result;
 AG_DataSource *_Nullable AG_OpenAutoCore(void) _Warn_Unused_Result;
+AG_DataSource *_Nullable AG_OpenMappedFile(const char *_Nonnull, Uint)
+                                           _Warn_Unused_Result;
 AG_DataSource *_Nullable AG_OpenNetSocket(struct ag_net_socket *_Nonnull) _Warn_Unused_Result;
 
 int AG_Read(AG_DataSource *_Nonnull, void *_Nonnull, AG_Size);
@@ -142,6 +184,11 @@ int AG_ReadAt(AG_DataSource *_Nonnull, void *_Nonnull, AG_Size, AG_Offset);
 int AG_ReadAtP(AG_DataSource *_Nonnull, void *_Nonnull, AG_Size, AG_Offset,
 	       AG_Size *_Nullable);
 
+const void *_Nullable AG_BorrowData(AG_DataSource *_Nonnull, AG_Size);
+const void *_Nullable AG_BorrowDataP(AG_DataSource *_Nonnull, AG_Size,
+                                     AG_Size *_Nullable);
+const void *_Nullable AG_BorrowDataAt(AG_DataSource *_Nonnull, AG_Size, AG_Offset);
+
 int AG_Write(AG_DataSource *_Nonnull, const void *_Nonnull, AG_Size);
 int AG_WriteP(AG_DataSource *_Nonnull, const void *_Nonnull, AG_Size, AG_Size *_Nullable);
 int AG_WriteAt(AG_DataSource *_Nonnull, const void *_Nonnull, AG_Size, AG_Offset);
@@ -153,6 +200,8 @@ void    AG_CloseFileHandle(AG_DataSource *_Nonnull);
 void    AG_CloseCore(AG_DataSource *_Nonnull);
 #define AG_CloseConstCore(ds) AG_CloseCore(ds)
 void    AG_CloseAutoCore(AG_DataSource *_Nonnull);
+void    AG_CloseMappedFile(AG_DataSource *_Nonnull);
+int     AG_MappedFileAdvise(AG_DataSource *_Nonnull, AG_Offset, AG_Size, Uint);
 void    AG_CloseNetSocket(AG_DataSource *_Nonnull);
 
 void    AG_WriteTypeCode(AG_DataSource *_Nonnull, Uint32);
@@ -166,6 +215,8 @@ int     AG_CheckTypeCode(AG_DataSource *_Nonnull, Uint32);
 int       AG_DataSourceRealloc(void *_Nonnull, AG_Size);
 AG_Offset AG_Tell(AG_DataSource *_Nonnull);
 int       AG_Seek(AG_DataSource *_Nonnull, AG_Offset, enum ag_seek_mode);
+int       AG_FlushDataSource(AG_DataSource *_Nonnull);
+int       AG_SyncDataSource(AG_DataSource *_Nonnull);
 void      AG_CloseDataSource(AG_DataSource *_Nonnull);
 void      AG_DataSourceDestroy(AG_DataSource *_Nonnull);
 __END_DECLS
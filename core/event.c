@@ -34,9 +34,14 @@
 #include <stdarg.h>
 
 #include <agar/config/have_kqueue.h>
+#include <agar/config/have_epoll.h>
 #include <agar/config/have_timerfd.h>
 #include <agar/config/have_select.h>
 
+#if defined(HAVE_KQUEUE) && defined(HAVE_EPOLL)
+# undef HAVE_EPOLL			/* Prefer kqueue */
+#endif
+
 #if defined(HAVE_KQUEUE)
 # ifdef __NetBSD__
 #   define _NETBSD_SOURCE
@@ -46,6 +51,13 @@
 # include <unistd.h>
 # include <errno.h>
 #endif
+#if defined(HAVE_EPOLL)
+# include <sys/epoll.h>
+# include <sys/inotify.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+# include <errno.h>
+#endif
 #if defined(HAVE_TIMERFD)
 # include <sys/timerfd.h>
 # include <errno.h>
@@ -91,6 +103,42 @@ typedef struct ag_event_source_kqueue {
 static int GrowKqChangelist(AG_EventSourceKQUEUE *_Nonnull, Uint);
 #endif /* HAVE_KQUEUE */
 
+#ifdef HAVE_EPOLL
+
+/* Size of epoll input event buffer (in epoll_events). */
+# ifndef AG_EPOLL_EVBUFSIZE
+# define AG_EPOLL_EVBUFSIZE 64
+# endif
+
+/* Size of inotify read buffer (in bytes). */
+# ifndef AG_EPOLL_INBUFSIZE
+# define AG_EPOLL_INBUFSIZE 4096
+# endif
+
+/*
+ * Per-descriptor epoll registration. A descriptor may be watched by both
+ * a READ and a WRITE sink, so sinks are looked up by fd (data.fd) rather
+ * than by pointer. Timers use timerfds and process events use pidfds which
+ * are owned by the event source.
+ */
+typedef struct ag_epoll_fd {
+	AG_EventSink *_Nullable rd;	/* READ sink (or PROCEVENT on pidfd) */
+	AG_EventSink *_Nullable wr;	/* WRITE sink */
+	struct ag_timer *_Nullable to;	/* Timer (on timerfd) */
+} AG_EpollFD;
+
+typedef struct ag_event_source_epoll {
+	struct ag_event_source _inherit;  /* EventSource -> EventSourceEPOLL */
+	int fd;                           /* epoll_create1() fd */
+	int inFd;                         /* inotify fd (or -1) */
+	AG_EpollFD *_Nullable fds;        /* Registrations (by fd) */
+	Uint                 nFds;
+	Uint                nWds;
+	AG_EventSink *_Nullable *_Nullable wds;  /* FSEVENT sinks (by wd) */
+	struct epoll_event events[AG_EPOLL_EVBUFSIZE];  /* Input event buffer */
+} AG_EventSourceEPOLL;
+#endif /* HAVE_EPOLL */
+
 /* #define DEBUG_TIMERS */
 
 #ifdef __NetBSD__
@@ -616,9 +664,12 @@ fail:
 static AG_EventSource *_Nullable
 CreateEventSource(void)
 {
-# ifdef HAVE_KQUEUE
+# if defined(HAVE_KQUEUE)
 	AG_EventSourceKQUEUE *kq = TryMalloc(sizeof(AG_EventSourceKQUEUE));
 	AG_EventSource *src = (AG_EventSource *)kq;
+# elif defined(HAVE_EPOLL)
+	AG_EventSourceEPOLL *ep = TryMalloc(sizeof(AG_EventSourceEPOLL));
+	AG_EventSource *src = (AG_EventSource *)ep;
 # else
 	AG_EventSource *src = TryMalloc(sizeof(AG_EventSource));
 # endif
@@ -660,6 +711,29 @@ CreateEventSource(void)
 	if (GrowKqChangelist(kq, AG_KQ_INIT_MAXCHANGES) == -1) {
 		AG_FatalError("GrowKqChangelist");
 	}
+# elif defined(HAVE_EPOLL)
+	if ((ep->fd = epoll_create1(EPOLL_CLOEXEC)) == -1) {
+		AG_SetError("epoll_create1: %s", AG_Strerror(errno));
+		free(ep);
+		return (NULL);
+	}
+	ep->inFd = -1;
+	ep->fds = NULL;
+	ep->nFds = 0;
+	ep->wds = NULL;
+	ep->nWds = 0;
+	src->sinkFn = AG_EventSinkEPOLL;
+#  if defined(AG_TIMERS) && defined(HAVE_TIMERFD)
+	src->addTimerFn = AG_AddTimerEPOLL;
+	src->delTimerFn = AG_DelTimerEPOLL;
+	src->caps[AG_SINK_TIMER] = 1;		/* Timers on timerfds */
+#  endif
+	src->caps[AG_SINK_READ] = 1;
+	src->caps[AG_SINK_WRITE] = 1;
+	src->caps[AG_SINK_FSEVENT] = 1;		/* Using inotify */
+#  ifdef SYS_pidfd_open
+	src->caps[AG_SINK_PROCEVENT] = 1;	/* Using pidfds (exit only) */
+#  endif
 # elif defined(HAVE_TIMERFD)
 	src->sinkFn = AG_EventSinkTIMERFD;
 #  ifdef AG_TIMERS
@@ -711,6 +785,23 @@ DestroyEventSource(void *_Nullable pEventSource)
 		}
 		Free(kq->changes);
 	}
+# elif defined(HAVE_EPOLL)
+	{
+		AG_EventSourceEPOLL *ep = pEventSource;
+		Uint i;
+
+		for (i = 0; i < ep->nFds; i++) {	/* Close pidfds */
+			if (ep->fds[i].rd != NULL &&
+			    ep->fds[i].rd->type == AG_SINK_PROCEVENT)
+				close((int)i);
+		}
+		if (ep->inFd != -1) {
+			close(ep->inFd);
+		}
+		close(ep->fd);
+		Free(ep->fds);
+		Free(ep->wds);
+	}
 # endif
 	for (es = TAILQ_FIRST(&src->prologues);
 	     es != TAILQ_END(&src->prologues);
@@ -836,6 +927,277 @@ GetSinkFlags(Uint fflags)
 }
 # endif /* HAVE_KQUEUE */
 
+# ifdef HAVE_EPOLL
+/*
+ * Routines for translating between AG_EventSink flags and inotify masks.
+ * inotify cannot distinguish writes from extensions, nor attribute changes
+ * from link count changes.
+ */
+static Uint32 _Const_Attribute
+GetInotifyMask(Uint flags)
+{
+	Uint32 mask = 0;
+	if (flags & AG_FSEVENT_DELETE) { mask |= IN_DELETE_SELF; }
+	if (flags & AG_FSEVENT_WRITE)  { mask |= IN_MODIFY;      }
+	if (flags & AG_FSEVENT_EXTEND) { mask |= IN_MODIFY;      }
+	if (flags & AG_FSEVENT_ATTRIB) { mask |= IN_ATTRIB;      }
+	if (flags & AG_FSEVENT_LINK)   { mask |= IN_ATTRIB;      }
+	if (flags & AG_FSEVENT_RENAME) { mask |= IN_MOVE_SELF;   }
+	if (flags & AG_FSEVENT_REVOKE) { mask |= IN_UNMOUNT;     }
+	return (mask);
+}
+static Uint _Const_Attribute
+GetSinkFlagsInotify(Uint32 mask)
+{
+	Uint flags = 0;
+	if (mask & IN_DELETE_SELF) { flags |= AG_FSEVENT_DELETE; }
+	if (mask & IN_MODIFY)      { flags |= AG_FSEVENT_WRITE |
+	                                      AG_FSEVENT_EXTEND; }
+	if (mask & IN_ATTRIB)      { flags |= AG_FSEVENT_ATTRIB |
+	                                      AG_FSEVENT_LINK;   }
+	if (mask & IN_MOVE_SELF)   { flags |= AG_FSEVENT_RENAME; }
+	if (mask & IN_UNMOUNT)     { flags |= AG_FSEVENT_REVOKE; }
+	return (flags);
+}
+
+#  define EPOLL_FD_IN_USE(ent) \
+	((ent)->rd != NULL || (ent)->wr != NULL || (ent)->to != NULL)
+
+/* Grow the registration table to accommodate descriptor fd. */
+static int
+GrowEpollFDs(AG_EventSourceEPOLL *_Nonnull ep, int fd)
+{
+	AG_EpollFD *fdsNew;
+	Uint nNew;
+
+	if (fd < 0) {
+		AG_SetErrorS("Bad fd");
+		return (-1);
+	}
+	if ((Uint)fd < ep->nFds) {
+		return (0);
+	}
+	nNew = (ep->nFds > 0) ? ep->nFds : 16;
+	while (nNew <= (Uint)fd) {
+		nNew <<= 1;
+	}
+	if ((fdsNew = TryRealloc(ep->fds, nNew*sizeof(AG_EpollFD))) == NULL) {
+		return (-1);
+	}
+	memset(&fdsNew[ep->nFds], 0, (nNew - ep->nFds)*sizeof(AG_EpollFD));
+	ep->fds = fdsNew;
+	ep->nFds = nNew;
+	return (0);
+}
+
+/*
+ * Update the epoll interest set of descriptor fd from its registration
+ * (add, modify or delete). wasInUse indicates whether fd was registered.
+ */
+static int
+UpdateEpollFD(AG_EventSourceEPOLL *_Nonnull ep, int fd, int wasInUse)
+{
+	const AG_EpollFD *ent = &ep->fds[fd];
+	struct epoll_event ev;
+	int op;
+
+	memset(&ev, 0, sizeof(ev));
+	if (ent->rd != NULL || ent->to != NULL) { ev.events |= EPOLLIN;  }
+	if (ent->wr != NULL)                    { ev.events |= EPOLLOUT; }
+	ev.data.fd = fd;
+
+	if (ev.events == 0) {
+		if (!wasInUse) {
+			return (0);
+		}
+		op = EPOLL_CTL_DEL;
+	} else {
+		op = (wasInUse) ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+	}
+	if (epoll_ctl(ep->fd, op, fd, &ev) == -1) {
+		AG_SetError("epoll_ctl(%d): %s", fd, AG_Strerror(errno));
+		return (-1);
+	}
+	return (0);
+}
+
+/* Watch the file referenced by an FSEVENT sink's fd with inotify. */
+static int
+AddFsEventEPOLL(AG_EventSourceEPOLL *_Nonnull ep, AG_EventSink *_Nonnull es)
+{
+	char path[32];
+	int wd;
+
+	if (ep->inFd == -1) {
+		struct epoll_event ev;
+
+		if ((ep->inFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) == -1) {
+			AG_SetError("inotify_init1: %s", AG_Strerror(errno));
+			return (-1);
+		}
+		memset(&ev, 0, sizeof(ev));
+		ev.events = EPOLLIN;
+		ev.data.fd = ep->inFd;
+		if (epoll_ctl(ep->fd, EPOLL_CTL_ADD, ep->inFd, &ev) == -1) {
+			AG_SetError("epoll_ctl: %s", AG_Strerror(errno));
+			close(ep->inFd);
+			ep->inFd = -1;
+			return (-1);
+		}
+	}
+	Snprintf(path, sizeof(path), "/proc/self/fd/%d", es->ident);
+	if ((wd = inotify_add_watch(ep->inFd, path,
+	    GetInotifyMask(es->flags))) == -1) {
+		AG_SetError("inotify_add_watch(%d): %s", es->ident,
+		    AG_Strerror(errno));
+		return (-1);
+	}
+	if ((Uint)wd >= ep->nWds) {
+		AG_EventSink **wdsNew;
+		Uint nNew;
+
+		nNew = (ep->nWds > 0) ? ep->nWds : 16;
+		while (nNew <= (Uint)wd) {
+			nNew <<= 1;
+		}
+		if ((wdsNew = TryRealloc(ep->wds, nNew*sizeof(AG_EventSink *)))
+		    == NULL) {
+			inotify_rm_watch(ep->inFd, wd);
+			return (-1);
+		}
+		memset(&wdsNew[ep->nWds], 0,
+		    (nNew - ep->nWds)*sizeof(AG_EventSink *));
+		ep->wds = wdsNew;
+		ep->nWds = nNew;
+	}
+	if (ep->wds[wd] != NULL) {
+		AG_SetError("fd %d: File is already being watched", es->ident);
+		return (-1);
+	}
+	ep->wds[wd] = es;
+	return (0);
+}
+
+/* Close the pidfd at fds[fd] (registered by a PROCEVENT sink). */
+static void
+ClosePidfd(AG_EventSourceEPOLL *_Nonnull ep, int fd)
+{
+	ep->fds[fd].rd = NULL;
+	(void)UpdateEpollFD(ep, fd, 1);
+	close(fd);
+}
+
+/* Register a new sink with epoll. */
+static int
+AddSinkEPOLL(AG_EventSourceEPOLL *_Nonnull ep, AG_EventSink *_Nonnull es)
+{
+	AG_EpollFD *ent;
+	int fd, wasInUse;
+
+	switch (es->type) {
+	case AG_SINK_READ:
+	case AG_SINK_WRITE:
+		fd = es->ident;
+		if (GrowEpollFDs(ep, fd) == -1) {
+			return (-1);
+		}
+		ent = &ep->fds[fd];
+		wasInUse = EPOLL_FD_IN_USE(ent);
+		if (es->type == AG_SINK_READ) {
+			if (ent->rd != NULL) { goto exists; }
+			ent->rd = es;
+		} else {
+			if (ent->wr != NULL) { goto exists; }
+			ent->wr = es;
+		}
+		if (UpdateEpollFD(ep, fd, wasInUse) == -1) {
+			if (es->type == AG_SINK_READ) {
+				ent->rd = NULL;
+			} else {
+				ent->wr = NULL;
+			}
+			return (-1);
+		}
+		return (0);
+	case AG_SINK_FSEVENT:
+		return AddFsEventEPOLL(ep, es);
+#  ifdef SYS_pidfd_open
+	case AG_SINK_PROCEVENT:
+		if (es->flags & (AG_PROCEVENT_FORK | AG_PROCEVENT_EXEC)) {
+			AG_SetErrorS("Only AG_PROCEVENT_EXIT is supported");
+			return (-1);
+		}
+		if ((fd = (int)syscall(SYS_pidfd_open, es->ident, 0)) == -1) {
+			AG_SetError("pidfd_open(%d): %s", es->ident,
+			    AG_Strerror(errno));
+			return (-1);
+		}
+		if (GrowEpollFDs(ep, fd) == -1) {
+			close(fd);
+			return (-1);
+		}
+		ep->fds[fd].rd = es;
+		if (UpdateEpollFD(ep, fd, 0) == -1) {
+			ep->fds[fd].rd = NULL;
+			close(fd);
+			return (-1);
+		}
+		return (0);
+#  endif
+	default:
+		return (0);
+	}
+exists:
+	AG_SetError("fd %d: Event sink exists", es->ident);
+	return (-1);
+}
+
+/* Unregister a sink from epoll. */
+static void
+DelSinkEPOLL(AG_EventSourceEPOLL *_Nonnull ep, AG_EventSink *_Nonnull es)
+{
+	AG_EpollFD *ent;
+	Uint i;
+
+	switch (es->type) {
+	case AG_SINK_READ:
+	case AG_SINK_WRITE:
+		if (es->ident < 0 || (Uint)es->ident >= ep->nFds) {
+			break;
+		}
+		ent = &ep->fds[es->ident];
+		if (es->type == AG_SINK_READ && ent->rd == es) {
+			ent->rd = NULL;
+		} else if (es->type == AG_SINK_WRITE && ent->wr == es) {
+			ent->wr = NULL;
+		} else {
+			break;
+		}
+		(void)UpdateEpollFD(ep, es->ident, 1);
+		break;
+	case AG_SINK_FSEVENT:
+		for (i = 0; i < ep->nWds; i++) {
+			if (ep->wds[i] == es) {
+				inotify_rm_watch(ep->inFd, (int)i);
+				ep->wds[i] = NULL;
+				break;
+			}
+		}
+		break;
+	case AG_SINK_PROCEVENT:
+		for (i = 0; i < ep->nFds; i++) {
+			if (ep->fds[i].rd == es) {
+				ClosePidfd(ep, (int)i);
+				break;
+			}
+		}
+		break;
+	default:
+		break;
+	}
+}
+# endif /* HAVE_EPOLL */
+
 /*
  * Add/remove an event processing prologue. The function will be invoked
  * only once at the beginning of AG_EventLoop().
@@ -1007,6 +1369,11 @@ AG_AddEventSink(enum ag_event_sink_type type, int ident, Uint flags,
 		kq->nChanges--;
 		break;
 	}
+# elif defined(HAVE_EPOLL)
+	if (AddSinkEPOLL((AG_EventSourceEPOLL *)src, es) == -1) {
+		free(es);
+		return (NULL);
+	}
 # endif /* HAVE_KQUEUE */
 
 	es->fn = fn;
@@ -1070,6 +1437,8 @@ AG_DelEventSink(AG_EventSink *es)
 		kq->nChanges--;
 		break;
 	}
+# elif defined(HAVE_EPOLL)
+	DelSinkEPOLL((AG_EventSourceEPOLL *)src, es);
 # endif /* HAVE_KQUEUE */
 
 	TAILQ_REMOVE(&src->sinks, es, sinks);
@@ -1298,6 +1667,213 @@ AG_DelTimerKQUEUE(AG_Timer *to)
 #  endif /* AG_TIMERS */
 # endif /* HAVE_KQUEUE */
 
+# ifdef HAVE_EPOLL
+/* Read pending inotify events and invoke the matching FSEVENT sinks. */
+static void
+ProcessFsEventsEPOLL(AG_EventSourceEPOLL *_Nonnull ep)
+{
+	union {
+		struct inotify_event ev;		/* For alignment */
+		char buf[AG_EPOLL_INBUFSIZE];
+	} in;
+	const struct inotify_event *iev;
+	AG_EventSink *es;
+	ssize_t len;
+	char *p;
+
+	while ((len = read(ep->inFd, in.buf, sizeof(in.buf))) > 0) {
+		for (p = in.buf;
+		     p < &in.buf[len];
+		     p += sizeof(struct inotify_event) + iev->len) {
+			iev = (const struct inotify_event *)p;
+			if (iev->wd < 0 || (Uint)iev->wd >= ep->nWds ||
+			    (es = ep->wds[iev->wd]) == NULL) {
+				continue;
+			}
+			if (iev->mask & IN_IGNORED) {	/* Watch was removed */
+				ep->wds[iev->wd] = NULL;
+				continue;
+			}
+			es->flagsMatched = GetSinkFlagsInotify(iev->mask) &
+			                   es->flags;
+			if (es->flagsMatched != 0)
+				es->fn(es, &es->fnArgs);
+		}
+	}
+}
+
+#  if defined(AG_TIMERS) && defined(HAVE_TIMERFD)
+/* Run the callback of an expired timerfd-based timer. */
+static void
+ProcessTimerEPOLL(AG_EventSourceEPOLL *_Nonnull ep, int fd)
+{
+	AG_Timer *to = ep->fds[fd].to;
+	AG_Object *ob = to->obj;
+	char nExp[8];
+	Uint32 rvt;
+
+	if (read(fd, nExp, sizeof(nExp)) != sizeof(nExp))  /* Not expired */
+		return;
+
+	AG_ObjectLock(ob);
+	rvt = to->fn(to, &to->fnEvent);
+	if ((Uint)fd < ep->nFds && ep->fds[fd].to == to) {  /* Still active */
+		if (rvt == 0 ||
+		    AG_ResetTimer(ob, to, rvt) == -1)
+			AG_DelTimer(ob, to);
+	}
+	AG_ObjectUnlock(ob);
+}
+#  endif /* AG_TIMERS and HAVE_TIMERFD */
+
+/*
+ * Standard event sink using epoll(7), available on Linux. Sinks are
+ * registered persistently (so the cost of a wakeup is proportional to the
+ * number of ready descriptors). Timers use timerfds in the same epoll set,
+ * filesystem events use inotify and process events use pidfds.
+ */
+int
+AG_EventSinkEPOLL(void)
+{
+	AG_EventSourceEPOLL *ep = (AG_EventSourceEPOLL *)agEventSource;
+	int i, rv, timeout;
+#  ifdef AG_TIMERS
+	Uint32 tNext;
+#  endif
+
+restart:
+	timeout = -1;
+	if (!TAILQ_EMPTY(&agEventSource->spinners)) {
+		timeout = 0;
+	}
+#  ifdef AG_TIMERS
+	else if (!agEventSource->caps[AG_SINK_TIMER]) {	/* Soft timers */
+		if ((tNext = AG_NextTimeout(AG_GetTicks())) != AG_TIMEOUT_NONE)
+			timeout = (tNext > AG_INT_MAX) ? AG_INT_MAX : (int)tNext;
+	}
+#  endif
+	rv = epoll_wait(ep->fd, ep->events, AG_EPOLL_EVBUFSIZE, timeout);
+	if (rv == -1) {
+		if (errno == EINTR) {
+			goto restart;
+		}
+		AG_SetError("epoll_wait: %s", AG_Strerror(errno));
+		return (-1);
+	}
+
+#  ifdef AG_TIMERS
+	/* 1. Process timer expirations. */
+	if (!agEventSource->caps[AG_SINK_TIMER]) {
+		AG_ProcessTimeouts(AG_GetTicks());
+	}
+#   ifdef HAVE_TIMERFD
+	else {
+		AG_LockTiming();
+		for (i = 0; i < rv; i++) {
+			const int fd = ep->events[i].data.fd;
+
+			if (fd != ep->inFd &&
+			    (Uint)fd < ep->nFds && ep->fds[fd].to != NULL)
+				ProcessTimerEPOLL(ep, fd);
+		}
+		AG_UnlockTiming();
+	}
+#   endif
+#  endif /* AG_TIMERS */
+
+	/* 2. Process I/O and other events. */
+	for (i = 0; i < rv; i++) {
+		const int fd = ep->events[i].data.fd;
+		const Uint32 revents = ep->events[i].events;
+		AG_EventSink *es;
+
+		if (fd == ep->inFd) {
+			ProcessFsEventsEPOLL(ep);
+			continue;
+		}
+		if ((Uint)fd < ep->nFds && (es = ep->fds[fd].rd) != NULL &&
+		    (revents & (EPOLLIN | EPOLLHUP | EPOLLERR))) {
+			if (es->type == AG_SINK_PROCEVENT) {
+				es->flagsMatched = AG_PROCEVENT_EXIT;
+				ClosePidfd(ep, fd);	/* Exit is final */
+			}
+			es->fn(es, &es->fnArgs);
+		}
+		if ((Uint)fd < ep->nFds && (es = ep->fds[fd].wr) != NULL &&
+		    (revents & (EPOLLOUT | EPOLLHUP | EPOLLERR))) {
+			es->fn(es, &es->fnArgs);
+		}
+	}
+	return (0);
+}
+
+#  if defined(AG_TIMERS) && defined(HAVE_TIMERFD)
+/*
+ * Add/remove a timerfd-based timer in the epoll set.
+ */
+int
+AG_AddTimerEPOLL(AG_Timer *to, Uint32 ival, int newTimer)
+{
+	AG_EventSourceEPOLL *ep = (AG_EventSourceEPOLL *)agEventSource;
+	struct itimerspec its;
+
+	if (newTimer) {
+		/* Create a timerfd. Store the file descriptor as ID. */
+		if ((to->id = timerfd_create(CLOCK_MONOTONIC,
+		    TFD_NONBLOCK | TFD_CLOEXEC)) == -1) {
+			AG_SetError("timerfd_create: %s", AG_Strerror(errno));
+			return (-1);
+		}
+		if (GrowEpollFDs(ep, to->id) == -1) {
+			goto fail_close;
+		}
+		ep->fds[to->id].to = to;
+		if (UpdateEpollFD(ep, to->id, 0) == -1) {
+			ep->fds[to->id].to = NULL;
+			goto fail_close;
+		}
+	}
+	its.it_value.tv_sec = ival/1000;
+	its.it_value.tv_nsec = (ival % 1000)*1000000L;
+	if (ival == 0) {
+		its.it_value.tv_nsec = 1L;	/* Zero would disarm */
+	}
+	its.it_interval.tv_sec = 0;
+	its.it_interval.tv_nsec = 0L;
+	if (timerfd_settime(to->id, 0, &its, NULL) == -1) {
+		AG_SetError("timerfd_settime: %s", AG_Strerror(errno));
+		if (newTimer) {
+			ep->fds[to->id].to = NULL;
+			(void)UpdateEpollFD(ep, to->id, 1);
+			goto fail_close;
+		}
+		return (-1);
+	}
+	to->ival = ival;
+	return (0);
+fail_close:
+	close(to->id);
+	to->id = -1;
+	return (-1);
+}
+void
+AG_DelTimerEPOLL(AG_Timer *to)
+{
+	AG_EventSourceEPOLL *ep = (AG_EventSourceEPOLL *)agEventSource;
+
+#   ifdef AG_DEBUG
+	if (to->id == -1)
+		AG_FatalError("timerfd inconsistency");
+#   endif
+	if ((Uint)to->id < ep->nFds && ep->fds[to->id].to == to) {
+		ep->fds[to->id].to = NULL;
+		(void)UpdateEpollFD(ep, to->id, 1);
+	}
+	close(to->id);
+}
+#  endif /* AG_TIMERS and HAVE_TIMERFD */
+# endif /* HAVE_EPOLL */
+
 # ifdef HAVE_TIMERFD
 /*
  * Standard event sink using select(2) and fd-based timers,
@@ -1468,13 +2044,11 @@ int
 AG_EventSinkTIMEDSELECT(void)
 {
 	fd_set rdFds, wrFds;
-	int i, nFds, rv;
+	int nFds, rv;
 	AG_EventSink *es;
+	struct timeval timeo;
 #  ifdef AG_TIMERS
-	AG_Object *ob, *obNext;
-	AG_Timer *to, *toNext;
-	struct timeval timeo, *pTimeo;
-	Uint32 t, tSoonest;
+	Uint32 tSoonest;
 #  endif
 
 restart:
@@ -1498,18 +2072,12 @@ restart:
 		timeo.tv_sec = 0;
 		timeo.tv_usec = 0;
 	} else {
-		AG_LockTiming();
-		t = AG_GetTicks();
-		tSoonest = 0xfffffffe;
-		TAILQ_FOREACH(ob, &agTimerObjQ, tobjs) {
-			TAILQ_FOREACH(to, &ob->timers, pvt.timers) {
-				if ((to->tSched - t) < tSoonest)
-					tSoonest = (to->tSched - t);
-			}
+		tSoonest = AG_NextTimeout(AG_GetTicks());
+		if (tSoonest == AG_TIMEOUT_NONE) {
+			tSoonest = 0xfffffffe;
 		}
 		timeo.tv_sec = tSoonest/1000;
 		timeo.tv_usec = (tSoonest % 1000)*1000;
-		AG_UnlockTiming();
 	}
 #  else /* !AG_TIMERS */
 	timeo.tv_sec = 0;
@@ -1526,7 +2094,7 @@ restart:
 #  ifdef AG_TIMERS
 	AG_LockTiming();
 	/* 1. Process timer expirations. */
-	AG_ProcessTimeouts(t);
+	AG_ProcessTimeouts(AG_GetTicks());
 #  endif
 	if (rv > 0) {
 		/* 2. Process I/O events */
@@ -428,10 +428,13 @@ void                     AG_TerminateEv(AG_Event *_Nonnull);
 # ifdef AG_TIMERS
 int                      AG_AddTimerKQUEUE(struct ag_timer *_Nonnull, Uint32, int);
 void                     AG_DelTimerKQUEUE(struct ag_timer *_Nonnull);
+int                      AG_AddTimerEPOLL(struct ag_timer *_Nonnull, Uint32, int);
+void                     AG_DelTimerEPOLL(struct ag_timer *_Nonnull);
 int                      AG_AddTimerTIMERFD(struct ag_timer *_Nonnull, Uint32, int);
 void                     AG_DelTimerTIMERFD(struct ag_timer *_Nonnull);
 # endif
 int                      AG_EventSinkKQUEUE(void);
+int                      AG_EventSinkEPOLL(void);
 int                      AG_EventSinkTIMERFD(void);
 int                      AG_EventSinkTIMEDSELECT(void);
 int                      AG_EventSinkSELECT(void);
@@ -19,7 +19,10 @@ ag_read_uint8(AG_DataSource *ds)
 #ifdef AG_DEBUG
 	if (ds->debug && AG_CheckTypeCode(ds, AG_SOURCE_UINT8) == -1) { return (0); }
 #endif
-	if (AG_Read(ds, &i, sizeof(i)) != 0) {
+	if (AG_DATA_SOURCE_RDAVAIL(ds) >= sizeof(i)) {
+		memcpy(&i, ds->rdCur, sizeof(i));
+		ds->rdCur += sizeof(i);
+	} else if (AG_Read(ds, &i, sizeof(i)) != 0) {
 		AG_DataSourceError(ds, NULL);
 		return (0);
 	}
@@ -37,8 +40,12 @@ ag_write_uint8(AG_DataSource *ds, Uint8 i)
 #ifdef AG_DEBUG
 	if (ds->debug) { AG_WriteTypeCode(ds, AG_SOURCE_UINT8); }
 #endif
-	if (AG_Write(ds, &i, sizeof(i)) != 0)
+	if (AG_DATA_SOURCE_WRAVAIL(ds) >= sizeof(i)) {
+		memcpy(ds->wrCur, &i, sizeof(i));
+		ds->wrCur += sizeof(i);
+	} else if (AG_Write(ds, &i, sizeof(i)) != 0) {
 		AG_DataSourceError(ds, NULL);
+	}
 }
 
 #ifdef AG_INLINE_HEADER
@@ -68,7 +75,10 @@ ag_read_sint8(AG_DataSource *ds)
 #ifdef AG_DEBUG
 	if (ds->debug && AG_CheckTypeCode(ds, AG_SOURCE_SINT8) == -1) { return (0); }
 #endif
-	if (AG_Read(ds, &i, sizeof(i)) != 0) {
+	if (AG_DATA_SOURCE_RDAVAIL(ds) >= sizeof(i)) {
+		memcpy(&i, ds->rdCur, sizeof(i));
+		ds->rdCur += sizeof(i);
+	} else if (AG_Read(ds, &i, sizeof(i)) != 0) {
 		AG_DataSourceError(ds, NULL);
 		return (0);
 	}
@@ -86,8 +96,12 @@ ag_write_sint8(AG_DataSource *ds, Sint8 i)
 #ifdef AG_DEBUG
 	if (ds->debug) { AG_WriteTypeCode(ds, AG_SOURCE_SINT8); }
 #endif
-	if (AG_Write(ds, &i, sizeof(i)) != 0)
+	if (AG_DATA_SOURCE_WRAVAIL(ds) >= sizeof(i)) {
+		memcpy(ds->wrCur, &i, sizeof(i));
+		ds->wrCur += sizeof(i);
+	} else if (AG_Write(ds, &i, sizeof(i)) != 0) {
 		AG_DataSourceError(ds, NULL);
+	}
 }
 
 #ifdef AG_INLINE_HEADER
@@ -120,7 +134,10 @@ ag_read_uint16(AG_DataSource *ds)
 #ifdef AG_DEBUG
 	if (ds->debug && AG_CheckTypeCode(ds, AG_SOURCE_UINT16) == -1) { return (0); }
 #endif
-	if (AG_Read(ds, &i, sizeof(i)) != 0) {
+	if (AG_DATA_SOURCE_RDAVAIL(ds) >= sizeof(i)) {
+		memcpy(&i, ds->rdCur, sizeof(i));
+		ds->rdCur += sizeof(i);
+	} else if (AG_Read(ds, &i, sizeof(i)) != 0) {
 		AG_DataSourceError(ds, NULL);
 		return (0);
 	}
@@ -141,8 +158,12 @@ ag_write_uint16(AG_DataSource *ds, Uint16 u16)
 #ifdef AG_DEBUG
 	if (ds->debug) { AG_WriteTypeCode(ds, AG_SOURCE_UINT16); }
 #endif
-	if (AG_Write(ds, &i, sizeof(i)) != 0)
+	if (AG_DATA_SOURCE_WRAVAIL(ds) >= sizeof(i)) {
+		memcpy(ds->wrCur, &i, sizeof(i));
+		ds->wrCur += sizeof(i);
+	} else if (AG_Write(ds, &i, sizeof(i)) != 0) {
 		AG_DataSourceError(ds, NULL);
+	}
 }
 
 #ifdef AG_INLINE_HEADER
@@ -175,7 +196,10 @@ ag_read_sint16(AG_DataSource *ds)
 #ifdef AG_DEBUG
 	if (ds->debug && AG_CheckTypeCode(ds, AG_SOURCE_SINT16) == -1) { return (0); }
 #endif
-	if (AG_Read(ds, &i, sizeof(i)) != 0) {
+	if (AG_DATA_SOURCE_RDAVAIL(ds) >= sizeof(i)) {
+		memcpy(&i, ds->rdCur, sizeof(i));
+		ds->rdCur += sizeof(i);
+	} else if (AG_Read(ds, &i, sizeof(i)) != 0) {
 		AG_DataSourceError(ds, NULL);
 		return (0);
 	}
@@ -196,8 +220,12 @@ ag_write_sint16(AG_DataSource *ds, Sint16 s16)
 #ifdef AG_DEBUG
 	if (ds->debug) { AG_WriteTypeCode(ds, AG_SOURCE_SINT16); }
 #endif
-	if (AG_Write(ds, &i, sizeof(i)) != 0)
+	if (AG_DATA_SOURCE_WRAVAIL(ds) >= sizeof(i)) {
+		memcpy(ds->wrCur, &i, sizeof(i));
+		ds->wrCur += sizeof(i);
+	} else if (AG_Write(ds, &i, sizeof(i)) != 0) {
 		AG_DataSourceError(ds, NULL);
+	}
 }
 
 #ifdef AG_INLINE_HEADER
@@ -232,7 +260,10 @@ ag_read_uint32(AG_DataSource *ds)
 #ifdef AG_DEBUG
 	if (ds->debug && AG_CheckTypeCode(ds, AG_SOURCE_UINT32) == -1) { return (0); }
 #endif
-	if (AG_Read(ds, &i, sizeof(i)) != 0) {
+	if (AG_DATA_SOURCE_RDAVAIL(ds) >= sizeof(i)) {
+		memcpy(&i, ds->rdCur, sizeof(i));
+		ds->rdCur += sizeof(i);
+	} else if (AG_Read(ds, &i, sizeof(i)) != 0) {
 		AG_DataSourceError(ds, NULL);
 		return (0);
 	}
@@ -253,8 +284,12 @@ ag_write_uint32(AG_DataSource *ds, Uint32 u32)
 #ifdef AG_DEBUG
 	if (ds->debug) { AG_WriteTypeCode(ds, AG_SOURCE_UINT32); }
 #endif
-	if (AG_Write(ds, &i, sizeof(i)) != 0)
+	if (AG_DATA_SOURCE_WRAVAIL(ds) >= sizeof(i)) {
+		memcpy(ds->wrCur, &i, sizeof(i));
+		ds->wrCur += sizeof(i);
+	} else if (AG_Write(ds, &i, sizeof(i)) != 0) {
 		AG_DataSourceError(ds, NULL);
+	}
 }
 
 #ifdef AG_INLINE_HEADER
@@ -286,7 +321,10 @@ ag_read_sint32(AG_DataSource *ds)
 #ifdef AG_DEBUG
 	if (ds->debug && AG_CheckTypeCode(ds, AG_SOURCE_SINT32) == -1) { return (0); }
 #endif
-	if (AG_Read(ds, &i, sizeof(i)) != 0) {
+	if (AG_DATA_SOURCE_RDAVAIL(ds) >= sizeof(i)) {
+		memcpy(&i, ds->rdCur, sizeof(i));
+		ds->rdCur += sizeof(i);
+	} else if (AG_Read(ds, &i, sizeof(i)) != 0) {
 		AG_DataSourceError(ds, NULL);
 		return (0);
 	}
@@ -307,8 +345,12 @@ ag_write_sint32(AG_DataSource *ds, Sint32 s32)
 #ifdef AG_DEBUG
 	if (ds->debug) { AG_WriteTypeCode(ds, AG_SOURCE_SINT32); }
 #endif
-	if (AG_Write(ds, &i, sizeof(i)) != 0)
+	if (AG_DATA_SOURCE_WRAVAIL(ds) >= sizeof(i)) {
+		memcpy(ds->wrCur, &i, sizeof(i));
+		ds->wrCur += sizeof(i);
+	} else if (AG_Write(ds, &i, sizeof(i)) != 0) {
 		AG_DataSourceError(ds, NULL);
+	}
 }
 
 #ifdef AG_INLINE_HEADER
@@ -344,7 +386,10 @@ ag_read_uint64(AG_DataSource *ds)
 # ifdef AG_DEBUG
 	if (ds->debug && AG_CheckTypeCode(ds, AG_SOURCE_UINT64) == -1) { return (0); }
 # endif
-	if (AG_Read(ds, &i, sizeof(i)) != 0) {
+	if (AG_DATA_SOURCE_RDAVAIL(ds) >= sizeof(i)) {
+		memcpy(&i, ds->rdCur, sizeof(i));
+		ds->rdCur += sizeof(i);
+	} else if (AG_Read(ds, &i, sizeof(i)) != 0) {
 		AG_DataSourceError(ds, NULL);
 		return (0);
 	}
@@ -365,8 +410,12 @@ ag_write_uint64(AG_DataSource *ds, Uint64 u64)
 # ifdef AG_DEBUG
 	if (ds->debug) { AG_WriteTypeCode(ds, AG_SOURCE_UINT64); }
 # endif
-	if (AG_Write(ds, &i, sizeof(i)) != 0)
+	if (AG_DATA_SOURCE_WRAVAIL(ds) >= sizeof(i)) {
+		memcpy(ds->wrCur, &i, sizeof(i));
+		ds->wrCur += sizeof(i);
+	} else if (AG_Write(ds, &i, sizeof(i)) != 0) {
 		AG_DataSourceError(ds, NULL);
+	}
 }
 
 # ifdef AG_INLINE_HEADER
@@ -398,7 +447,10 @@ ag_read_sint64(AG_DataSource *ds)
 # ifdef AG_DEBUG
 	if (ds->debug && AG_CheckTypeCode(ds, AG_SOURCE_SINT64) == -1) { return (0); }
 # endif
-	if (AG_Read(ds, &i, sizeof(i)) != 0) {
+	if (AG_DATA_SOURCE_RDAVAIL(ds) >= sizeof(i)) {
+		memcpy(&i, ds->rdCur, sizeof(i));
+		ds->rdCur += sizeof(i);
+	} else if (AG_Read(ds, &i, sizeof(i)) != 0) {
 		AG_DataSourceError(ds, NULL);
 		return (0);
 	}
@@ -419,8 +471,12 @@ ag_write_sint64(AG_DataSource *ds, Sint64 s64)
 # ifdef AG_DEBUG
 	if (ds->debug) { AG_WriteTypeCode(ds, AG_SOURCE_SINT64); }
 # endif
-	if (AG_Write(ds, &i, sizeof(i)) != 0)
+	if (AG_DATA_SOURCE_WRAVAIL(ds) >= sizeof(i)) {
+		memcpy(ds->wrCur, &i, sizeof(i));
+		ds->wrCur += sizeof(i);
+	} else if (AG_Write(ds, &i, sizeof(i)) != 0) {
 		AG_DataSourceError(ds, NULL);
+	}
 }
 
 # ifdef AG_INLINE_HEADER
@@ -20,7 +20,10 @@ ag_read_float(AG_DataSource *ds)
 	if (ds->debug && AG_CheckTypeCode(ds, AG_SOURCE_FLOAT) == -1)
 		return (0.0f);
 #endif
-	if (AG_Read(ds, &f, sizeof(float)) != 0) {
+	if (AG_DATA_SOURCE_RDAVAIL(ds) >= sizeof(float)) {
+		memcpy(&f, ds->rdCur, sizeof(float));
+		ds->rdCur += sizeof(float);
+	} else if (AG_Read(ds, &f, sizeof(float)) != 0) {
 		AG_DataSourceError(ds, NULL);
 		return (0.0f);
 	}
@@ -38,8 +41,12 @@ ag_write_float(AG_DataSource *ds, float x)
 #ifdef AG_DEBUG
 	if (ds->debug) { AG_WriteTypeCode(ds, AG_SOURCE_FLOAT); }
 #endif
-	if (AG_Write(ds, &x, sizeof(float)) != 0)
+	if (AG_DATA_SOURCE_WRAVAIL(ds) >= sizeof(float)) {
+		memcpy(ds->wrCur, &x, sizeof(float));
+		ds->wrCur += sizeof(float);
+	} else if (AG_Write(ds, &x, sizeof(float)) != 0) {
 		AG_DataSourceError(ds, NULL);
+	}
 }
 
 #ifdef AG_INLINE_HEADER
@@ -74,7 +81,10 @@ ag_read_double(AG_DataSource *ds)
 	if (ds->debug && AG_CheckTypeCode(ds, AG_SOURCE_DOUBLE) == -1)
 		return (0.0);
 #endif
-	if (AG_Read(ds, &f, sizeof(f)) != 0) {
+	if (AG_DATA_SOURCE_RDAVAIL(ds) >= sizeof(f)) {
+		memcpy(&f, ds->rdCur, sizeof(f));
+		ds->rdCur += sizeof(f);
+	} else if (AG_Read(ds, &f, sizeof(f)) != 0) {
 		AG_DataSourceError(ds, NULL);
 		return (0.0);
 	}
@@ -92,8 +102,12 @@ ag_write_double(AG_DataSource *ds, double x)
 #ifdef AG_DEBUG
 	if (ds->debug) { AG_WriteTypeCode(ds, AG_SOURCE_DOUBLE); }
 #endif
-	if (AG_Write(ds, &x, sizeof(double)) != 0)
-		AG_DataSourceError(ds, NULL); 
+	if (AG_DATA_SOURCE_WRAVAIL(ds) >= sizeof(double)) {
+		memcpy(ds->wrCur, &x, sizeof(double));
+		ds->wrCur += sizeof(double);
+	} else if (AG_Write(ds, &x, sizeof(double)) != 0) {
+		AG_DataSourceError(ds, NULL);
+	}
 }
 
 #ifdef AG_INLINE_HEADER
@@ -71,6 +71,28 @@ ag_class_is_named(const void *pClass, const char *pat)
 	return AG_ClassIsNamedGeneral(cls, pat);	/* General case */
 }
 
+/*
+ * Test whether class C is Cbase or a subclass of Cbase, without any string
+ * comparisons. Both classes must be registered.
+ */
+#ifdef AG_INLINE_HEADER
+static __inline__ int _Pure_Attribute
+AG_ClassIsA(const void *_Nonnull pClass, const void *_Nonnull pBase)
+#else
+int
+ag_class_is_a(const void *pClass, const void *pBase)
+#endif
+{
+	const AG_ObjectClass *C = (const AG_ObjectClass *)pClass;
+	const AG_ObjectClass *Cbase = (const AG_ObjectClass *)pBase;
+	const int n = Cbase->nHier;
+
+	if (Cbase == &agObjectClass)
+		return (1);
+
+	return (n > 0 && C->nHier >= n && C->hierTbl[n-1] == Cbase);
+}
+
 /*
  * Test whether an object's class matches a given pattern.
  */
@@ -256,25 +278,58 @@ ag_unlock_timers(void *p)
 #endif /* AG_THREADS */
 
 /*
- * Evaluate whether the named object variable exists.
+ * Return the named object variable (without dereferencing proxies and
+ * without acquiring any lock on it), or NULL if there is no such variable.
  * The object must be locked.
  */
 #ifdef AG_INLINE_HEADER
-static __inline__ int _Pure_Attribute
-AG_Defined(void *_Nonnull pObj, const char *_Nonnull name)
+static __inline__ AG_Variable *_Nullable _Pure_Attribute
+AG_LookupVariable(void *_Nonnull pObj, const char *_Nonnull name)
 #else
-int
-ag_defined(void *pObj, const char *name)
+AG_Variable *
+ag_lookup_variable(void *pObj, const char *name)
 #endif
 {
 	AG_Object *obj = AGOBJECT(pObj);
 	AG_Variable *V;
+#if AG_MODEL != AG_SMALL
+	const Uint32 h = AG_VariableHash(name);
 
+	if (obj->varIndex != NULL) {
+		for (V = obj->varIndex[h & (obj->nVarIndex - 1)];
+		     V != NULL;
+		     V = V->varsHash) {
+			if (V->nameHash == h && strcmp(name, V->name) == 0)
+				return (V);
+		}
+		return (NULL);
+	}
+	AG_TAILQ_FOREACH(V, &obj->vars, vars) {
+		if (V->nameHash == h && strcmp(name, V->name) == 0)
+			return (V);
+	}
+#else
 	AG_TAILQ_FOREACH(V, &obj->vars, vars) {
 		if (strcmp(name, V->name) == 0)
-			return (1);
+			return (V);
 	}
-	return (0);
+#endif
+	return (NULL);
+}
+
+/*
+ * Evaluate whether the named object variable exists.
+ * The object must be locked.
+ */
+#ifdef AG_INLINE_HEADER
+static __inline__ int _Pure_Attribute
+AG_Defined(void *_Nonnull pObj, const char *_Nonnull name)
+#else
+int
+ag_defined(void *pObj, const char *name)
+#endif
+{
+	return (AG_LookupVariable(pObj, name) != NULL);
 }
 
 /*
@@ -290,17 +345,12 @@ AG_Variable *
 ag_fetch_variable(void *pObj, const char *name, enum ag_variable_type type)
 #endif
 {
-	AG_Object *obj = (AG_Object *)pObj;
 	AG_Variable *V;
 
-	AG_TAILQ_FOREACH(V, &obj->vars, vars) {
-		if (strcmp(V->name, name) == 0)
-			break;
-	}
-	if (V == NULL) {
+	if ((V = AG_LookupVariable(pObj, name)) == NULL) {
 		V = AG_Malloc(sizeof(AG_Variable));
 		AG_InitVariable(V, type, name);
-		AG_TAILQ_INSERT_TAIL(&obj->vars, V, vars);
+		AG_ObjectInsertVariable(pObj, V);
 	}
 	return (V);
 }
@@ -354,14 +404,9 @@ AG_Variable *
 ag_access_variable(void *pObj, const char *name)
 #endif
 {
-	AG_Object *obj = AGOBJECT(pObj);
 	AG_Variable *V, *Vtgt;
 
-	AG_TAILQ_FOREACH(V, &obj->vars, vars) {
-		if (strcmp(name, V->name) == 0)
-			break;
-	}
-	if (V == NULL) {
+	if ((V = AG_LookupVariable(pObj, name)) == NULL) {
 		return (NULL);
 	}
 	AG_LockVariable(V);
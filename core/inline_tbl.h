@@ -1,6 +1,9 @@
 /*	Public domain	*/
 
-/* General hash function */
+/*
+ * General hash function (32-bit FNV-1a). The full hash is returned; it is
+ * reduced to a slot index internally so that it remains valid across resizes.
+ */
 #ifdef AG_INLINE_HEADER
 static __inline__ Uint _Pure_Attribute
 AG_TblHash(AG_Tbl *_Nonnull tbl, const char *_Nonnull key)
@@ -9,13 +12,14 @@ Uint
 ag_tbl_hash(AG_Tbl *tbl, const char *key)
 #endif
 {
-	Uint h;
-	Uchar *p;
+	Uint32 h = 2166136261U;
+	const Uchar *p;
 
-	for (h = 0, p = (Uchar *)key; *p != '\0'; p++) {
-		h = 31*h + *p;
+	for (p = (const Uchar *)key; *p != '\0'; p++) {
+		h ^= *p;
+		h *= 16777619U;
 	}
-	return (h % tbl->nBuckets);
+	return (Uint)h;
 }
 
 /*
@@ -1,5 +1,23 @@
 /*	Public domain	*/
 
+/* Compute the hash of a variable name (used by the AG_Object var index). */
+#ifdef AG_INLINE_HEADER
+static __inline__ Uint32 _Pure_Attribute
+AG_VariableHash(const char *_Nonnull name)
+#else
+Uint32
+ag_variable_hash(const char *name)
+#endif
+{
+	Uint32 h;
+	const Uchar *p;
+
+	for (h = 0, p = (const Uchar *)name; *p != '\0'; p++) {
+		h = 31*h + *p;
+	}
+	return (h);
+}
+
 /* Initialize the generic part of an AG_Variable. */
 #ifdef AG_INLINE_HEADER
 static __inline__ void
@@ -24,6 +42,10 @@ ag_init_variable(AG_Variable *V, AG_VariableType type, const char *name)
 		V->name[0] = '\0';
 #endif
 	}
+#if AG_MODEL != AG_SMALL
+	V->nameHash = AG_VariableHash(V->name);
+	V->revision = 0;
+#endif
 	V->type = type;
 #ifdef AG_THREADS
 	V->mutex = NULL;
@@ -11,4 +11,252 @@
 #undef AG_INLINE_HEADER
 #include <agar/core/inline_load_integral.h>
 
+/*
+ * Bulk array operations. The arrays are transferred in a single operation
+ * (or in chunks of VEC_CHUNK elements, if byte swapping is needed).
+ */
+#define VEC_CHUNK 256
+
+/*
+ * Read an array of 8-bit integers. In debug mode, each element carries
+ * its own type code (as if written by a sequence of AG_WriteUint8()).
+ */
+void
+AG_ReadUint8v(AG_DataSource *ds, Uint8 *v, AG_Size count)
+{
+#ifdef AG_DEBUG
+	AG_Size i;
+
+	if (ds->debug) {
+		for (i = 0; i < count; i++) {
+			v[i] = AG_ReadUint8(ds);
+		}
+		return;
+	}
+#endif
+	if (count > 0 && AG_Read(ds, v, count) != 0)
+		AG_DataSourceError(ds, NULL);
+}
+
+/* Write an array of 8-bit integers. */
+void
+AG_WriteUint8v(AG_DataSource *ds, const Uint8 *v, AG_Size count)
+{
+#ifdef AG_DEBUG
+	AG_Size i;
+
+	if (ds->debug) {
+		for (i = 0; i < count; i++) {
+			AG_WriteUint8(ds, v[i]);
+		}
+		return;
+	}
+#endif
+	if (count > 0 && AG_Write(ds, v, count) != 0)
+		AG_DataSourceError(ds, NULL);
+}
+
+/* Read an array of 16-bit integers. */
+void
+AG_ReadUint16v(AG_DataSource *ds, Uint16 *v, AG_Size count)
+{
+	AG_Size i;
+
+#ifdef AG_DEBUG
+	if (ds->debug) {
+		for (i = 0; i < count; i++) {
+			v[i] = AG_ReadUint16(ds);
+		}
+		return;
+	}
+#endif
+	if (count == 0) {
+		return;
+	}
+	if (AG_Read(ds, v, count*sizeof(Uint16)) != 0) {
+		AG_DataSourceError(ds, NULL);
+		return;
+	}
+	if (ds->byte_order == AG_BYTEORDER_BE) {
+		for (i = 0; i < count; i++)
+			v[i] = AG_SwapBE16(v[i]);
+	} else {
+		for (i = 0; i < count; i++)
+			v[i] = AG_SwapLE16(v[i]);
+	}
+}
+
+/* Write an array of 16-bit integers. */
+void
+AG_WriteUint16v(AG_DataSource *ds, const Uint16 *v, AG_Size count)
+{
+	Uint16 buf[VEC_CHUNK];
+	AG_Size i, j, n;
+
+#ifdef AG_DEBUG
+	if (ds->debug) {
+		for (i = 0; i < count; i++) {
+			AG_WriteUint16(ds, v[i]);
+		}
+		return;
+	}
+#endif
+#if AG_BYTEORDER == AG_BIG_ENDIAN
+	if (ds->byte_order == AG_BYTEORDER_BE) {
+#else
+	if (ds->byte_order == AG_BYTEORDER_LE) {
+#endif
+		if (count > 0 && AG_Write(ds, v, count*sizeof(Uint16)) != 0) {
+			AG_DataSourceError(ds, NULL);
+		}
+		return;
+	}
+	for (i = 0; i < count; i += n) {
+		n = AG_MIN(count-i, VEC_CHUNK);
+		for (j = 0; j < n; j++) {
+			buf[j] = AG_Swap16(v[i+j]);
+		}
+		if (AG_Write(ds, buf, n*sizeof(Uint16)) != 0) {
+			AG_DataSourceError(ds, NULL);
+			return;
+		}
+	}
+}
+
+/* Read an array of 32-bit integers. */
+void
+AG_ReadUint32v(AG_DataSource *ds, Uint32 *v, AG_Size count)
+{
+	AG_Size i;
+
+#ifdef AG_DEBUG
+	if (ds->debug) {
+		for (i = 0; i < count; i++) {
+			v[i] = AG_ReadUint32(ds);
+		}
+		return;
+	}
+#endif
+	if (count == 0) {
+		return;
+	}
+	if (AG_Read(ds, v, count*sizeof(Uint32)) != 0) {
+		AG_DataSourceError(ds, NULL);
+		return;
+	}
+	if (ds->byte_order == AG_BYTEORDER_BE) {
+		for (i = 0; i < count; i++)
+			v[i] = AG_SwapBE32(v[i]);
+	} else {
+		for (i = 0; i < count; i++)
+			v[i] = AG_SwapLE32(v[i]);
+	}
+}
+
+/* Write an array of 32-bit integers. */
+void
+AG_WriteUint32v(AG_DataSource *ds, const Uint32 *v, AG_Size count)
+{
+	Uint32 buf[VEC_CHUNK];
+	AG_Size i, j, n;
+
+#ifdef AG_DEBUG
+	if (ds->debug) {
+		for (i = 0; i < count; i++) {
+			AG_WriteUint32(ds, v[i]);
+		}
+		return;
+	}
+#endif
+#if AG_BYTEORDER == AG_BIG_ENDIAN
+	if (ds->byte_order == AG_BYTEORDER_BE) {
+#else
+	if (ds->byte_order == AG_BYTEORDER_LE) {
+#endif
+		if (count > 0 && AG_Write(ds, v, count*sizeof(Uint32)) != 0) {
+			AG_DataSourceError(ds, NULL);
+		}
+		return;
+	}
+	for (i = 0; i < count; i += n) {
+		n = AG_MIN(count-i, VEC_CHUNK);
+		for (j = 0; j < n; j++) {
+			buf[j] = AG_Swap32(v[i+j]);
+		}
+		if (AG_Write(ds, buf, n*sizeof(Uint32)) != 0) {
+			AG_DataSourceError(ds, NULL);
+			return;
+		}
+	}
+}
+
+#ifdef AG_HAVE_64BIT
+/* Read an array of 64-bit integers. */
+void
+AG_ReadUint64v(AG_DataSource *ds, Uint64 *v, AG_Size count)
+{
+	AG_Size i;
+
+#ifdef AG_DEBUG
+	if (ds->debug) {
+		for (i = 0; i < count; i++) {
+			v[i] = AG_ReadUint64(ds);
+		}
+		return;
+	}
+#endif
+	if (count == 0) {
+		return;
+	}
+	if (AG_Read(ds, v, count*sizeof(Uint64)) != 0) {
+		AG_DataSourceError(ds, NULL);
+		return;
+	}
+	if (ds->byte_order == AG_BYTEORDER_BE) {
+		for (i = 0; i < count; i++)
+			v[i] = AG_SwapBE64(v[i]);
+	} else {
+		for (i = 0; i < count; i++)
+			v[i] = AG_SwapLE64(v[i]);
+	}
+}
+
+/* Write an array of 64-bit integers. */
+void
+AG_WriteUint64v(AG_DataSource *ds, const Uint64 *v, AG_Size count)
+{
+	Uint64 buf[VEC_CHUNK];
+	AG_Size i, j, n;
+
+#ifdef AG_DEBUG
+	if (ds->debug) {
+		for (i = 0; i < count; i++) {
+			AG_WriteUint64(ds, v[i]);
+		}
+		return;
+	}
+#endif
+#if AG_BYTEORDER == AG_BIG_ENDIAN
+	if (ds->byte_order == AG_BYTEORDER_BE) {
+#else
+	if (ds->byte_order == AG_BYTEORDER_LE) {
+#endif
+		if (count > 0 && AG_Write(ds, v, count*sizeof(Uint64)) != 0) {
+			AG_DataSourceError(ds, NULL);
+		}
+		return;
+	}
+	for (i = 0; i < count; i += n) {
+		n = AG_MIN(count-i, VEC_CHUNK);
+		for (j = 0; j < n; j++) {
+			buf[j] = AG_Swap64(v[i+j]);
+		}
+		if (AG_Write(ds, buf, n*sizeof(Uint64)) != 0) {
+			AG_DataSourceError(ds, NULL);
+			return;
+		}
+	}
+}
+#endif /* AG_HAVE_64BIT */
+
 #endif /* AG_SERIALIZATION */
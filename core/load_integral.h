@@ -37,6 +37,17 @@ Sint64 ag_read_sint64(AG_DataSource *_Nonnull);
 void   ag_write_sint64(AG_DataSource *_Nonnull, Sint64);
 void   ag_write_sint64_at(AG_DataSource *_Nonnull, Sint64, AG_Offset);
 #endif
+
+void AG_ReadUint8v(AG_DataSource *_Nonnull, Uint8 *_Nonnull, AG_Size);
+void AG_WriteUint8v(AG_DataSource *_Nonnull, const Uint8 *_Nonnull, AG_Size);
+void AG_ReadUint16v(AG_DataSource *_Nonnull, Uint16 *_Nonnull, AG_Size);
+void AG_WriteUint16v(AG_DataSource *_Nonnull, const Uint16 *_Nonnull, AG_Size);
+void AG_ReadUint32v(AG_DataSource *_Nonnull, Uint32 *_Nonnull, AG_Size);
+void AG_WriteUint32v(AG_DataSource *_Nonnull, const Uint32 *_Nonnull, AG_Size);
+#ifdef AG_HAVE_64BIT
+void AG_ReadUint64v(AG_DataSource *_Nonnull, Uint64 *_Nonnull, AG_Size);
+void AG_WriteUint64v(AG_DataSource *_Nonnull, const Uint64 *_Nonnull, AG_Size);
+#endif
 #ifdef AG_INLINE_IO
 # define AG_INLINE_HEADER
 # include <agar/core/inline_load_integral.h>
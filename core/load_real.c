@@ -11,6 +11,78 @@
 /* Import inlinables */
 # undef AG_INLINE_HEADER
 # include <agar/core/inline_load_real.h>
+
+/* Read an array of floats (in native representation, like AG_ReadFloat()). */
+void
+AG_ReadFloatv(AG_DataSource *ds, float *v, AG_Size count)
+{
+# ifdef AG_DEBUG
+	AG_Size i;
+
+	if (ds->debug) {
+		for (i = 0; i < count; i++) {
+			v[i] = AG_ReadFloat(ds);
+		}
+		return;
+	}
+# endif
+	if (count > 0 && AG_Read(ds, v, count*sizeof(float)) != 0)
+		AG_DataSourceError(ds, NULL);
+}
+
+/* Write an array of floats. */
+void
+AG_WriteFloatv(AG_DataSource *ds, const float *v, AG_Size count)
+{
+# ifdef AG_DEBUG
+	AG_Size i;
+
+	if (ds->debug) {
+		for (i = 0; i < count; i++) {
+			AG_WriteFloat(ds, v[i]);
+		}
+		return;
+	}
+# endif
+	if (count > 0 && AG_Write(ds, v, count*sizeof(float)) != 0)
+		AG_DataSourceError(ds, NULL);
+}
+
+/* Read an array of doubles (in native representation, like AG_ReadDouble()). */
+void
+AG_ReadDoublev(AG_DataSource *ds, double *v, AG_Size count)
+{
+# ifdef AG_DEBUG
+	AG_Size i;
+
+	if (ds->debug) {
+		for (i = 0; i < count; i++) {
+			v[i] = AG_ReadDouble(ds);
+		}
+		return;
+	}
+# endif
+	if (count > 0 && AG_Read(ds, v, count*sizeof(double)) != 0)
+		AG_DataSourceError(ds, NULL);
+}
+
+/* Write an array of doubles. */
+void
+AG_WriteDoublev(AG_DataSource *ds, const double *v, AG_Size count)
+{
+# ifdef AG_DEBUG
+	AG_Size i;
+
+	if (ds->debug) {
+		for (i = 0; i < count; i++) {
+			AG_WriteDouble(ds, v[i]);
+		}
+		return;
+	}
+# endif
+	if (count > 0 && AG_Write(ds, v, count*sizeof(double)) != 0)
+		AG_DataSourceError(ds, NULL);
+}
 #endif /* AG_HAVE_FLOAT */
 
 #endif /* AG_SERIALIZATION */
@@ -19,6 +19,11 @@ double      ag_read_double(AG_DataSource *_Nonnull);
 void        ag_write_double(AG_DataSource *_Nonnull, double);
 void        ag_write_double_at(AG_DataSource *_Nonnull, double, AG_Offset);
 
+void AG_ReadFloatv(AG_DataSource *_Nonnull, float *_Nonnull, AG_Size);
+void AG_WriteFloatv(AG_DataSource *_Nonnull, const float *_Nonnull, AG_Size);
+void AG_ReadDoublev(AG_DataSource *_Nonnull, double *_Nonnull, AG_Size);
+void AG_WriteDoublev(AG_DataSource *_Nonnull, const double *_Nonnull, AG_Size);
+
 # ifdef AG_INLINE_IO
 #  define AG_INLINE_HEADER
 #  include <agar/core/inline_load_real.h>
@@ -145,7 +145,6 @@ AG_WriteString(AG_DataSource *ds, const char *s)
 {
 	Uint32 encLen;
 	AG_Size slen;
-	int rv;
 
 	if (s == NULL || *s == '\0') {
 		s = "";
@@ -162,18 +161,14 @@ AG_WriteString(AG_DataSource *ds, const char *s)
 	if (ds->debug)
 		AG_WriteTypeCode(ds, AG_SOURCE_STRING);
 #endif
-	if ((rv = ds->write(ds, &encLen, sizeof(encLen), &ds->wrLast)) != 0) {
+	if (AG_Write(ds, &encLen, sizeof(encLen)) != 0) {
 		goto fail;
 	}
-	ds->wrTotal += ds->wrLast;
 	
 	/* String */
-	if (slen > 0) {
-		if ((rv = ds->write(ds, s, slen, &ds->wrLast)) != 0) {
-			goto fail;
-		}
-		ds->wrTotal += ds->wrLast;
-	}
+	if (slen > 0 && AG_Write(ds, s, slen) != 0)
+		goto fail;
+
 	AG_UnlockDataSource(ds);
 	return;
 fail:
@@ -187,7 +182,6 @@ AG_WriteStringPadded(AG_DataSource *ds, const char *s, AG_Size lenPadded)
 {
 	AG_Size slen, padLen, chunkLen;
 	Uint32 encLen[2];
-	int rv;
 
 	if (s == NULL) {
 		s = "";
@@ -210,18 +204,13 @@ AG_WriteStringPadded(AG_DataSource *ds, const char *s, AG_Size lenPadded)
 	if (ds->debug)
 		AG_WriteTypeCode(ds, AG_SOURCE_STRING_PAD);
 #endif
-	if ((rv = ds->write(ds, encLen, sizeof(encLen), &ds->wrLast)) != 0) {
+	if (AG_Write(ds, encLen, sizeof(encLen)) != 0) {
 		goto fail;
 	}
-	ds->wrTotal += ds->wrLast;
 
 	/* String */
-	if (slen > 0) {
-		if ((rv = ds->write(ds, s, slen, &ds->wrLast)) != 0) {
-			goto fail;
-		}
-		ds->wrTotal += ds->wrLast;
-	}
+	if (slen > 0 && AG_Write(ds, s, slen) != 0)
+		goto fail;
 	
 	/* Padding */
 	padLen = lenPadded - slen;
@@ -229,11 +218,10 @@ AG_WriteStringPadded(AG_DataSource *ds, const char *s, AG_Size lenPadded)
 		static char zeroBuf[1024];
 	
 		chunkLen = AG_MIN(padLen, sizeof(zeroBuf));
-		if ((rv = ds->write(ds, zeroBuf, chunkLen, &ds->wrLast)) != 0) {
+		if (AG_Write(ds, zeroBuf, chunkLen) != 0) {
 			goto fail;
 		}
-		ds->wrTotal += ds->wrLast;
-		padLen -= ds->wrLast;
+		padLen -= chunkLen;
 	}
 	AG_UnlockDataSource(ds);
 	return;
@@ -252,9 +240,8 @@ fail:
 AG_Size
 AG_CopyString(char *dst, AG_DataSource *ds, AG_Size dst_size)
 {
-	AG_Size rvLen;
+	AG_Size rvLen, lenSkip = 0;
 	Uint32 len;
-	int rv;
 
 	AG_LockDataSource(ds);
 
@@ -262,12 +249,8 @@ AG_CopyString(char *dst, AG_DataSource *ds, AG_Size dst_size)
 	if (ds->debug && AG_CheckTypeCode(ds, AG_SOURCE_STRING) == -1)
 		goto fail;
 #endif
-	if ((rv = ds->read(ds, &len, sizeof(len), &ds->rdLast)) != 0) {
-		goto fail;
-	}
-	ds->rdTotal += ds->rdLast;
-	if (ds->rdLast < sizeof(len)) {
-		AG_SetError("String header");
+	if (AG_Read(ds, &len, sizeof(len)) != 0) {
+		AG_SetError("String header: %s", AG_GetError());
 		goto fail;
 	}
 	len = (ds->byte_order == AG_BYTEORDER_BE) ? AG_SwapBE32(len) :
@@ -278,6 +261,7 @@ AG_CopyString(char *dst, AG_DataSource *ds, AG_Size dst_size)
 		    (Uint)AG_Tell(ds), (Ulong)len, (Ulong)dst_size);
 #endif
 		rvLen = (AG_Size)len+1;	/* Save the intended length */
+		lenSkip = (AG_Size)len - (dst_size-1);
 		len = dst_size-1;
 	} else {
 		rvLen = (AG_Size)len;
@@ -285,16 +269,15 @@ AG_CopyString(char *dst, AG_DataSource *ds, AG_Size dst_size)
 	if (len == 0) {
 		*dst = '\0';
 	} else {
-		if ((rv = ds->read(ds, dst, len, &ds->rdLast)) != 0) {
-			goto fail;
-		}
-		ds->rdTotal += ds->rdLast;
-		if (ds->rdLast < len) {
-			AG_SetErrorS("Reading string");
+		if (AG_Read(ds, dst, len) != 0) {
+			AG_SetError("Reading string: %s", AG_GetError());
 			goto fail;
 		}
-		dst[ds->rdLast] = '\0';
+		dst[len] = '\0';
 	}
+	if (lenSkip > 0 && AG_Seek(ds, (AG_Offset)lenSkip, AG_SEEK_CUR) == -1)
+		goto fail;
+
 	AG_UnlockDataSource(ds);
 	return (rvLen);			/* Count does not include NUL */
 fail:
@@ -310,7 +293,6 @@ AG_CopyStringPadded(char *dst, AG_DataSource *ds, AG_Size dst_size)
 {
 	AG_Size rvLen, len, lenPadded, lenPadding;
 	Uint32 encLen[2];
-	int rv;
 
 	AG_LockDataSource(ds);
 
@@ -318,14 +300,10 @@ AG_CopyStringPadded(char *dst, AG_DataSource *ds, AG_Size dst_size)
 	if (ds->debug && AG_CheckTypeCode(ds, AG_SOURCE_STRING_PAD) == -1)
 		goto fail;
 #endif
-	if ((rv = ds->read(ds, encLen, sizeof(encLen), &ds->rdLast)) != 0) {
+	if (AG_Read(ds, encLen, sizeof(encLen)) != 0) {
+		AG_SetError("Padded string header: %s", AG_GetError());
 		goto fail;
 	}
-	if (ds->rdLast < sizeof(encLen)) {
-		AG_SetErrorS("Padded string header");
-		goto fail;
-	}
-	ds->rdTotal += ds->rdLast;
 	if (ds->byte_order == AG_BYTEORDER_BE) {
 		len = AG_SwapBE32(encLen[0]);
 		lenPadded = AG_SwapBE32(encLen[1]);
@@ -348,15 +326,11 @@ AG_CopyStringPadded(char *dst, AG_DataSource *ds, AG_Size dst_size)
 	if (len == 0) {
 		*dst = '\0';
 	} else {
-		if ((rv = ds->read(ds, dst, len, &ds->rdLast)) != 0) {
-			goto fail;
-		}
-		ds->rdTotal += ds->rdLast;
-		if (ds->rdLast < len) {
-			AG_SetErrorS("Padded string");
+		if (AG_Read(ds, dst, len) != 0) {
+			AG_SetError("Padded string: %s", AG_GetError());
 			goto fail;
 		}
-		dst[ds->rdLast] = '\0';
+		dst[len] = '\0';
 	}
 
 	/* Padding */
@@ -55,6 +55,9 @@ AG_ObjectClass agObjectClass = {
 	NULL   /* edit */
 };
 
+/* Inheritance hierarchy of the base AG_Object class. */
+static AG_ObjectClass *agObjectClassHier[1] = { &agObjectClass };
+
 Uint32 agObjectSignature = 0;           /* Object validity signature */
 Uint32 agNonObjectSignature = 0;        /* Non-Object validity signature */
 
@@ -89,7 +92,7 @@ AG_ObjectInit(void *pObj, void *pClass)
 	AG_Object *ob = pObj;
 	AG_ObjectClass *C = (pClass != NULL) ? AGOBJECTCLASS(pClass) :
 	                                       &agObjectClass;
-	AG_ObjectClass **hier;
+	AG_ObjectClass *const *hier;
 	int i, nHier;
 	
 	ob->tag = agObjectSignature;
@@ -112,16 +115,20 @@ AG_ObjectInit(void *pObj, void *pClass)
 	TAILQ_INIT(&ob->timers);
 #endif
 	TAILQ_INIT(&ob->vars);
+#if AG_MODEL != AG_SMALL
+	ob->varIndex = NULL;
+	ob->nVarIndex = 0;
+	ob->nVars = 0;
+#endif
 	TAILQ_INIT(&ob->children);
 
-	if (AG_ObjectGetInheritHier(ob, &hier, &nHier) != 0) {
+	if ((hier = AG_ObjectGetClassHier(ob, &nHier)) == NULL) {
 		AG_FatalError(NULL);
 	}
 	for (i = 0; i < nHier; i++) {
 		if (hier[i]->init != NULL)
 			hier[i]->init(ob);
 	}
-	free(hier);
 }
 
 /* Initialize an AG_Object instance (and set the STATIC flag on it). */
@@ -170,12 +177,12 @@ void
 AG_ObjectReset(void *p)
 {
 	AG_Object *ob = p;
-	AG_ObjectClass **hier;
+	AG_ObjectClass *const *hier;
 	int i, nHier;
 
 	AG_ObjectLock(ob);
 
-	if (AG_ObjectGetInheritHier(ob, &hier, &nHier) != 0) {
+	if ((hier = AG_ObjectGetClassHier(ob, &nHier)) == NULL) {
 		AG_FatalError(NULL);
 	}
 	for (i = nHier-1; i >= 0; i--) {
@@ -183,8 +190,6 @@ AG_ObjectReset(void *p)
 			hier[i]->reset(ob);
 	}
 	AG_ObjectUnlock(ob);
-
-	free(hier);
 }
 
 #if AG_MODEL != AG_SMALL
@@ -781,9 +786,101 @@ AG_ObjectFreeVariables(void *pObj)
 		free(V);
 	}
 	TAILQ_INIT(&ob->vars);
+#if AG_MODEL != AG_SMALL
+	free(ob->varIndex);
+	ob->varIndex = NULL;
+	ob->nVarIndex = 0;
+	ob->nVars = 0;
+#endif
 	AG_ObjectUnlock(ob);
 }
 
+#if AG_MODEL != AG_SMALL
+/*
+ * Rebuild the variable hash index with the given number of buckets.
+ * On failure, the current index (or linear scan) is left unchanged.
+ */
+static int
+RehashVariables(AG_Object *ob, Uint nBuckets)
+{
+	AG_Variable **index, *V;
+	Uint i;
+
+	if ((index = TryMalloc(nBuckets * sizeof(AG_Variable *))) == NULL)
+		return (-1);
+
+	for (i = 0; i < nBuckets; i++) {
+		index[i] = NULL;
+	}
+	TAILQ_FOREACH(V, &ob->vars, vars) {
+		AG_Variable **head = &index[V->nameHash & (nBuckets - 1)];
+
+		V->varsHash = *head;
+		*head = V;
+	}
+	free(ob->varIndex);
+	ob->varIndex = index;
+	ob->nVarIndex = nBuckets;
+	return (0);
+}
+#endif /* !AG_SMALL */
+
+/*
+ * Attach an initialized variable to an object's variable list (and hash
+ * index, if the object has one). The object must be locked.
+ */
+void
+AG_ObjectInsertVariable(void *pObj, AG_Variable *V)
+{
+	AG_Object *ob = pObj;
+
+	TAILQ_INSERT_TAIL(&ob->vars, V, vars);
+#if AG_MODEL != AG_SMALL
+	ob->nVars++;
+	if (ob->varIndex != NULL) {
+		AG_Variable **head;
+
+		if (ob->nVars > (ob->nVarIndex << 1) &&
+		    RehashVariables(ob, ob->nVarIndex << 1) == 0)
+			return;
+
+		head = &ob->varIndex[V->nameHash & (ob->nVarIndex - 1)];
+		V->varsHash = *head;
+		*head = V;
+	} else if (ob->nVars > AG_OBJECT_VAR_INDEX_MIN) {
+		RehashVariables(ob, AG_OBJECT_VAR_INDEX_MIN << 1);
+	}
+#endif
+}
+
+/*
+ * Detach a variable from an object's variable list (and hash index).
+ * The variable itself is not freed. The object must be locked.
+ */
+void
+AG_ObjectRemoveVariable(void *pObj, AG_Variable *V)
+{
+	AG_Object *ob = pObj;
+
+	TAILQ_REMOVE(&ob->vars, V, vars);
+#if AG_MODEL != AG_SMALL
+	ob->nVars--;
+	if (ob->varIndex != NULL) {
+		AG_Variable **pp;
+
+		for (pp = &ob->varIndex[V->nameHash & (ob->nVarIndex - 1)];
+		     *pp != NULL;
+		     pp = &(*pp)->varsHash) {
+			if (*pp == V) {
+				*pp = V->varsHash;
+				break;
+			}
+		}
+	}
+	V->varsHash = NULL;
+#endif
+}
+
 /* Destroy the event handler structures. */
 void
 AG_ObjectFreeEvents(AG_Object *ob)
@@ -811,7 +908,7 @@ void
 AG_ObjectDestroy(void *p)
 {
 	AG_Object *ob = p;
-	AG_ObjectClass **hier;
+	AG_ObjectClass *const *hier;
 	AG_Object *child, *childNext;
 	AG_Variable *V, *Vnext;
 	AG_Event *ev, *evNext;
@@ -849,7 +946,7 @@ AG_ObjectDestroy(void *p)
 	 * Invoke reset() and destroy() for every class in the object's
 	 * inheritance hierarchy.
 	 */
-	if (AG_ObjectGetInheritHier(ob, &hier, &nHier) != 0) {
+	if ((hier = AG_ObjectGetClassHier(ob, &nHier)) == NULL) {
 		AG_FatalError(NULL);
 	}
 	for (i = nHier-1; i >= 0; i--) {
@@ -858,7 +955,6 @@ AG_ObjectDestroy(void *p)
 		if (hier[i]->destroy != NULL)
 			hier[i]->destroy(ob);
 	}
-	free(hier);
 
 	/*
 	 * Release defined variables and event handler structures.
@@ -870,6 +966,10 @@ AG_ObjectDestroy(void *p)
 		AG_FreeVariable(V);
 		free(V);
 	}
+#if AG_MODEL != AG_SMALL
+	free(ob->varIndex);
+	ob->varIndex = NULL;
+#endif
 	for (ev = TAILQ_FIRST(&ob->events);
 	     ev != TAILQ_END(&ob->events);
 	     ev = evNext) {
@@ -1248,7 +1348,7 @@ AG_ObjectLoadGenericFromFile(void *p, const char *pPath)
 #ifdef DEBUG_SERIALIZATION
 	Debug(ob, "Loading generic data from %s\n", path);
 #endif
-	if ((ds = AG_OpenFile(path, "rb")) == NULL)
+	if ((ds = AG_OpenMappedFile(path, AG_MAPPED_SEQUENTIAL)) == NULL)
 		goto fail_unlock;
 
 	/* Free any resident dataset in order to clear the dependencies. */
@@ -1342,13 +1442,13 @@ AG_ObjectLoadGenericFromFile(void *p, const char *pPath)
 			goto fail;
 	}
 
-	AG_CloseFile(ds);
+	AG_CloseMappedFile(ds);
 	AG_ObjectUnlock(ob);
 	AG_UnlockVFS(ob);
 	return (0);
 fail:
 	AG_ObjectReset(ob);
-	AG_CloseFile(ds);
+	AG_CloseMappedFile(ds);
 fail_unlock:
 	AG_ObjectUnlock(ob);
 	AG_UnlockVFS(ob);
@@ -1364,7 +1464,7 @@ AG_ObjectLoadDataFromFile(void *p, int *dataFound, const char *pPath)
 	AG_Object *ob = p;
 	AG_DataSource *ds;
 	AG_Version ver;
-	AG_ObjectClass **hier;
+	AG_ObjectClass *const *hier;
 	int i, nHier;
 
 	AG_LockVFS(ob);
@@ -1384,7 +1484,7 @@ AG_ObjectLoadDataFromFile(void *p, int *dataFound, const char *pPath)
 #ifdef DEBUG_SERIALIZATION
 	Debug(ob, "Loading dataset from %s\n", path);
 #endif
-	if ((ds = AG_OpenFile(path, "rb")) == NULL) {
+	if ((ds = AG_OpenMappedFile(path, AG_MAPPED_SEQUENTIAL)) == NULL) {
 		*dataFound = 0;
 		goto fail_unlock;
 	}
@@ -1401,7 +1501,7 @@ AG_ObjectLoadDataFromFile(void *p, int *dataFound, const char *pPath)
 		goto fail;
 #endif
 	}
-	if (AG_ObjectGetInheritHier(ob, &hier, &nHier) == -1)
+	if ((hier = AG_ObjectGetClassHier(ob, &nHier)) == NULL)
 		goto fail;
 
 	AG_ObjectReset(ob);
@@ -1418,19 +1518,17 @@ AG_ObjectLoadDataFromFile(void *p, int *dataFound, const char *pPath)
 #else
 			AG_SetErrorS("E16");
 #endif
-			free(hier);
 			goto fail;
 		}
 	}
-	free(hier);
 
-	AG_CloseFile(ds);
+	AG_CloseMappedFile(ds);
 	AG_PostEvent(ob->root, "object-post-load", "%p,%s", ob, path);
 	AG_ObjectUnlock(ob);
 	AG_UnlockVFS(ob);
 	return (0);
 fail:
-	AG_CloseFile(ds);
+	AG_CloseMappedFile(ds);
 fail_unlock:
 	AG_ObjectUnlock(ob);
 	AG_UnlockVFS(ob);
@@ -1485,7 +1583,7 @@ AG_ObjectSerialize(void *p, AG_DataSource *ds)
 {
 	AG_Object *ob = p;
 	AG_Offset dataOffs;
-	AG_ObjectClass **hier;
+	AG_ObjectClass *const *hier;
 	int i, nHier;
 #ifdef AG_DEBUG
 	int debugSave;
@@ -1524,7 +1622,7 @@ AG_ObjectSerialize(void *p, AG_DataSource *ds)
 		debugSave = 0;
 	}
 #endif
-	if (AG_ObjectGetInheritHier(ob, &hier, &nHier) == -1) {
+	if ((hier = AG_ObjectGetClassHier(ob, &nHier)) == NULL) {
 		goto fail;
 	}
 	for (i = 0; i < nHier; i++) {
@@ -1534,11 +1632,9 @@ AG_ObjectSerialize(void *p, AG_DataSource *ds)
 		if (hier[i]->save == NULL)
 			continue;
 		if (hier[i]->save(ob, ds) == -1) {
-			free(hier);
 			goto fail;
 		}
 	}
-	free(hier);
 
 #ifdef AG_DEBUG
 	if (ob->flags & AG_OBJECT_DEBUG_DATA)
@@ -1565,7 +1661,7 @@ AG_ObjectUnserialize(void *p, AG_DataSource *ds)
 	AG_Object *ob = p;
 	AG_ObjectHeader oh;
 	AG_Version ver;
-	AG_ObjectClass **hier = NULL;
+	AG_ObjectClass *const *hier;
 	Uint32 count;
 	int i, nHier;
 #ifdef AG_DEBUG
@@ -1612,7 +1708,7 @@ AG_ObjectUnserialize(void *p, AG_DataSource *ds)
 		debugSave = 0;
 #endif
 	}
-	if (AG_ObjectGetInheritHier(ob, &hier, &nHier) == -1) {
+	if ((hier = AG_ObjectGetClassHier(ob, &nHier)) == NULL) {
 		goto fail_dbg;
 	}
 	for (i = 0; i < nHier; i++) {
@@ -1627,11 +1723,9 @@ AG_ObjectUnserialize(void *p, AG_DataSource *ds)
 #else
 			AG_SetErrorS("E18");
 #endif
-			free(hier);
 			goto fail_dbg;
 		}
 	}
-	free(hier);
 
 #ifdef AG_DEBUG
 	if (ob->flags & AG_OBJECT_DEBUG_DATA)
@@ -2136,6 +2230,34 @@ too_big:
 	AG_FatalError("Class name overflow");
 }
 
+/*
+ * Resolve the inheritance hierarchy of a class from that of its superclass
+ * (which must already be resolved). The base AG_Object class itself only
+ * appears in its own hierarchy.
+ */
+static void
+InitClassHier(AG_ObjectClass *_Nonnull C)
+{
+	AG_ObjectClass *Csuper = C->super;
+	int nSuper;
+
+	if (C == &agObjectClass) {
+		C->hierTbl = agObjectClassHier;
+		C->nHier = 1;
+		return;
+	}
+	nSuper = (Csuper != &agObjectClass) ? Csuper->nHier : 0;
+
+	free(C->hierTbl);
+	C->hierTbl = Malloc((nSuper + 1) * sizeof(AG_ObjectClass *));
+	if (nSuper > 0) {
+		memcpy(C->hierTbl, Csuper->hierTbl,
+		    nSuper * sizeof(AG_ObjectClass *));
+	}
+	C->hierTbl[nSuper] = C;
+	C->nHier = nSuper + 1;
+}
+
 /*
  * Initialize the object class description table.
  * Invoked internally by AG_InitCore().
@@ -2156,6 +2278,7 @@ AG_InitClassTbl(void)
 #endif
 	/* Initialize the class tree */
 	InitClass(&agObjectClass, "AG_Object");
+	InitClassHier(&agObjectClass);
 #ifdef AG_ENABLE_DSO
 	agObjectClass.libs[0] = '\0';
 #endif
@@ -2381,6 +2504,7 @@ AG_RegisterClass(void *p)
 		C->super = &agObjectClass;	/* Base AG_Object class */
 	}
 	TAILQ_INSERT_TAIL(&C->super->sub, C, subclasses);
+	InitClassHier(C);
 
 	/* Insert into the class table. */
 	AG_InitPointer(&V, C);
@@ -2407,6 +2531,9 @@ AG_UnregisterClass(void *p)
 		/* Remove from the class tree. */
 		TAILQ_REMOVE(&Csuper->sub, C, subclasses);
 		C->super = NULL;
+		free(C->hierTbl);
+		C->hierTbl = NULL;
+		C->nHier = 0;
 
 		/* Remove from the class table. */
 		AG_TblDeleteHash(agClassTbl, h, C->hier);
@@ -2705,74 +2832,108 @@ AG_UnregisterModuleDirectory(const char *path)
 int
 AG_ClassIsNamedGeneral(const AG_ObjectClass *C, const char *cn)
 {
-	char cname[AG_OBJECT_HIER_MAX], *cp, *c;
-	char nname[AG_OBJECT_HIER_MAX], *np, *s;
+	const char *c, *cEnd;
+	AG_Size len;
+	int i;
 
-	Strlcpy(cname, cn, sizeof(cname));
-	Strlcpy(nname, C->hier, sizeof(nname));
-	cp = cname;
-	np = nname;
+	if (C->hierTbl == NULL) {
+		char cname[AG_OBJECT_HIER_MAX], *cp, *pc;
+		char nname[AG_OBJECT_HIER_MAX], *np, *s;
 
-	while ((c = Strsep(&cp, ":")) != NULL &&
-	       (s = Strsep(&np, ":")) != NULL) {
-		if (c[0] == '*' && c[1] == '\0')
-			continue;
-		if (strcmp(c, s) != 0)
+		Strlcpy(cname, cn, sizeof(cname));
+		Strlcpy(nname, C->hier, sizeof(nname));
+		cp = cname;
+		np = nname;
+
+		while ((pc = Strsep(&cp, ":")) != NULL &&
+		       (s = Strsep(&np, ":")) != NULL) {
+			if (pc[0] == '*' && pc[1] == '\0')
+				continue;
+			if (strcmp(pc, s) != 0)
+				return (0);
+		}
+		return (1);
+	}
+
+	/*
+	 * Compare each component of the pattern against the name of the
+	 * corresponding class in the resolved hierarchy.
+	 */
+	for (c = cn, i = 0; i < C->nHier; c = &cEnd[1], i++) {
+		if ((cEnd = strchr(c, ':')) == NULL) {
+			cEnd = &c[strlen(c)];
+		}
+		len = cEnd - c;
+		if (!(len == 1 && c[0] == '*') &&
+		    (strncmp(C->hierTbl[i]->name, c, len) != 0 ||
+		     C->hierTbl[i]->name[len] != '\0')) {
 			return (0);
+		}
+		if (*cEnd == '\0')
+			break;
 	}
 	return (1);
 }
 
 /*
- * Return an array of class description pointers ("AG_ObjectClass *") for
+ * Return the array of class description pointers ("AG_ObjectClass *") for
  * each class in the inheritance hierarchy of obj. For example:
  *
  *   "AG_Widget:AG_Box:AG_Titlebar" -> { &agWidgetClass,
  *                                       &agBoxClass,
  *                                       &agTitlebarClass }
  *
- * The caller should release the returned array using free() after use.
+ * The array is resolved by AG_RegisterClass() and must not be modified
+ * or freed. Return NULL if the class is not registered.
  */
-int
-AG_ObjectGetInheritHier(void *obj, AG_ObjectClass ***hier, int *nHier)
+AG_ObjectClass *const *
+AG_ObjectGetClassHier(const void *obj, int *nHier)
 {
-	char cname[AG_OBJECT_HIER_MAX], *c;
-	AG_ObjectClass *C, **pHier;
-	int i, stop = 0;
+	static AG_ObjectClass *const noHier[1] = { NULL };
+	const AG_ObjectClass *C = AGOBJECT(obj)->cls;
 
-	if (AGOBJECT(obj)->cls->hier[0] == '\0') {
-		(*nHier) = 0;
-		return (0);
-	}
-	(*nHier) = 1;
-	Strlcpy(cname, AGOBJECT(obj)->cls->hier, sizeof(cname));
-	for (c = &cname[0]; *c != '\0'; c++) {
-		if (*c == ':')
-			(*nHier)++;
-	}
-	pHier = (*hier) = Malloc((*nHier)*sizeof(AG_ObjectClass *));
-	for (c = &cname[0], i = 0; ; c++) {
-		if (*c != ':' && *c != '\0') {
-			continue;
+	if (C->hierTbl == NULL) {
+		/*
+		 * Not a registered class description (or a copy of one);
+		 * use the registered class of the same name, if any.
+		 */
+		if (C->hier[0] == '\0') {
+			(*nHier) = 0;
+			return (noHier);
 		}
-		if (*c == '\0') {
-			stop++;
-		} else {
-			*c = '\0';
+		if ((C = AG_LookupClass(C->hier)) == &agObjectClass) {
+			(*nHier) = 1;
+			return (agObjectClassHier);
 		}
-		if ((C = AG_LookupClass(cname)) == NULL) {
+		if (C == NULL || C->hierTbl == NULL) {
 			AG_SetError(
 			    _("No such class " AGSI_BR_CYAN "%s" AGSI_RST ". "
 			      "Missing AG_RegisterClass(3) call?"),
 			    AGOBJECT(obj)->cls->hier);
-			free(pHier);
-			return (-1);
+			return (NULL);
 		}
-		*c = ':';
-		pHier[i++] = C;
-		
-		if (stop)
-			break;
 	}
+	(*nHier) = C->nHier;
+	return (C->hierTbl);
+}
+
+/*
+ * Return a copy of the inheritance hierarchy of obj, as returned by
+ * AG_ObjectGetClassHier(). The caller should release the returned array
+ * using free() after use.
+ */
+int
+AG_ObjectGetInheritHier(void *obj, AG_ObjectClass ***hier, int *nHier)
+{
+	AG_ObjectClass *const *hierTbl;
+
+	if ((hierTbl = AG_ObjectGetClassHier(obj, nHier)) == NULL) {
+		return (-1);
+	}
+	if ((*nHier) == 0) {
+		return (0);
+	}
+	(*hier) = Malloc((*nHier)*sizeof(AG_ObjectClass *));
+	memcpy(*hier, hierTbl, (*nHier)*sizeof(AG_ObjectClass *));
 	return (0);
 }
@@ -39,7 +39,7 @@
 #  define AG_OBJECT_LIBS_MAX 32
 # endif
 #endif
-#ifndef AG_OBJECT_CLASSTBLSIZE     /* Number of buckets for the class table */
+#ifndef AG_OBJECT_CLASSTBLSIZE     /* Initial size of the class table */
 # if AG_MODEL == AG_SMALL
 #  define AG_OBJECT_CLASSTBLSIZE 8
 # elif AG_MODEL == AG_MEDIUM
@@ -111,6 +111,9 @@ typedef struct ag_object_class {              /* --- Required fields --- */
 	char libs[AG_OBJECT_LIBS_MAX];              /* List of required modules */
 	AG_TAILQ_HEAD_(ag_object_class) sub;        /* Direct subclasses */
 	AG_TAILQ_ENTRY(ag_object_class) subclasses; /* Subclass entry */
+	struct ag_object_class *_Nonnull *_Nullable hierTbl; /* Resolved hier */
+	int nHier;                                  /* Entries in hierTbl */
+	Uint32 _pad;
 } AG_ObjectClass;
 
 AG_TAILQ_HEAD(ag_objectq, ag_object);
@@ -146,6 +149,11 @@ typedef struct ag_object {
 	AG_TAILQ_HEAD_(ag_timer) timers;  /* Registered timers */
 #endif
 	AG_TAILQ_HEAD_(ag_variable) vars; /* Properties / Variables */
+#if AG_MODEL != AG_SMALL
+	AG_Variable *_Nullable *_Nullable varIndex; /* Hash index over vars */
+	Uint nVarIndex;                   /* Buckets in varIndex (power of 2) */
+	Uint nVars;                       /* Number of variables in vars */
+#endif
 	struct ag_objectq children;       /* List of child objects */
 	AG_TAILQ_ENTRY(ag_object) cobjs;  /* Entry in parent's children list */
 	void *_Nullable parent;           /* Parent in VFS (NULL = is root) */
@@ -156,6 +164,12 @@ typedef struct ag_object {
 	_Nonnull_Mutex AG_Mutex lock;     /* General object lock */
 } AG_Object;
 
+/*
+ * Objects with more than AG_OBJECT_VAR_INDEX_MIN variables maintain a hash
+ * index over their variable names. Below that, a linear scan is used.
+ */
+#define AG_OBJECT_VAR_INDEX_MIN 8
+
 /* Object archive header information. */
 typedef struct ag_object_header {
 	AG_ObjectClassSpec cs;            /* Class specification */
@@ -343,6 +357,9 @@ int AG_ClassIsNamedGeneral(const AG_ObjectClass *_Nonnull, const char *_Nonnull)
 int AG_ObjectGetInheritHier(void *_Nonnull,
                             AG_ObjectClass *_Nonnull *_Nonnull *_Nullable,
                             int *_Nonnull);
+AG_ObjectClass *_Nonnull const *_Nullable AG_ObjectGetClassHier(const void *_Nonnull,
+                                                                int *_Nonnull)
+                                                               _Warn_Unused_Result;
 
 void *_Nullable AG_ObjectNew(void *_Nullable, const char *_Nullable,
                              AG_ObjectClass *_Nonnull);
@@ -395,6 +412,8 @@ void AG_ObjectFreeChildrenOfTypeLockless(AG_Object *_Nonnull, const char *_Nonnu
 void AG_ObjectFreeChildrenOfType(void *_Nonnull, const char *_Nonnull);
 #endif
 void AG_ObjectFreeVariables(void *_Nonnull);
+void AG_ObjectInsertVariable(void *_Nonnull, AG_Variable *_Nonnull);
+void AG_ObjectRemoveVariable(void *_Nonnull, AG_Variable *_Nonnull);
 void AG_ObjectFreeChildren(void *_Nonnull);
 void AG_ObjectFreeChildrenLockless(AG_Object *_Nonnull);
 void AG_ObjectFreeEvents(AG_Object *_Nonnull);
@@ -451,6 +470,9 @@ AG_Namespace *_Nullable ag_get_namespace(const char *_Nonnull)
 
 int ag_class_is_named(const void *_Nonnull, const char *_Nonnull)
                      _Warn_Unused_Result;
+int ag_class_is_a(const void *_Nonnull, const void *_Nonnull)
+                 _Pure_Attribute
+                 _Warn_Unused_Result;
 
 void *_Nullable ag_object_find_child(void *_Nonnull, const char *_Nonnull)
                                     _Pure_Attribute_If_Unthreaded
@@ -462,6 +484,10 @@ AG_ObjectClass *_Nullable ag_object_superclass(const void *_Nonnull)
 
 void ag_object_delete(void *_Nonnull);
 
+AG_Variable *_Nullable ag_lookup_variable(void *_Nonnull, const char *_Nonnull)
+                                         _Pure_Attribute
+                                         _Warn_Unused_Result;
+
 int ag_defined(void *_Nonnull, const char *_Nonnull)
               _Pure_Attribute
               _Warn_Unused_Result;
@@ -492,12 +518,14 @@ void ag_unlock_timers(void *_Nullable);
 #else
 # define AG_GetNamespace(s)            ag_get_namespace(s)
 # define AG_ClassIsNamed(C,s)          ag_class_is_named((C),(s))
+# define AG_ClassIsA(C,Cbase)          ag_class_is_a((C),(Cbase))
 # define AG_OfClass(o,s)               ag_of_class((o),(s))
 # define AG_ObjectRoot(o)              ag_object_root(o)
 # define AG_ObjectParent(o)            ag_object_parent(o)
 # define AG_ObjectDelete(o)            ag_object_delete(o)
 # define AG_ObjectFindChild(o,n)       ag_object_find_child((o),(n))
 # define AG_ObjectSuperclass(o)        ag_object_superclass(o)
+# define AG_LookupVariable(o,n)        ag_lookup_variable((o),(n))
 # define AG_Defined(o,n)               ag_defined((o),(n))
 # define AG_FetchVariable(o,n,t)       ag_fetch_variable((o),(n),(t))
 # define AG_FetchVariableOfType(o,n,t) ag_fetch_variable_of_type((o),(n),(t))
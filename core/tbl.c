@@ -25,6 +25,13 @@
 
 /*
  * Implementation of a generic hash table of AG_Variable(3) items.
+ *
+ * Entries are stored in a power-of-2 sized slot array using open addressing
+ * with Robin Hood displacement. Each slot caches the full hash of its key,
+ * so that probing rarely needs to compare strings and resizing never needs
+ * to rehash. Growing the table is incremental: the previous slot array is
+ * kept around and drained AG_TBL_MIGRATE_STEP slots at a time by subsequent
+ * inserts and deletes, so no single operation pays for a full rehash.
  */
 
 #include <agar/core/core.h>
@@ -44,22 +51,46 @@ AG_TblNew(Uint nBuckets, Uint flags)
 	return (t);
 }
 
-/* Initialize a table structure. */
+/* Allocate a slot array of the given size (a power of 2). */
+static AG_TblEnt *
+AllocSlots(Uint nSlots)
+{
+	AG_TblEnt *ents;
+	Uint i;
+
+	if ((ents = TryMalloc(nSlots*sizeof(AG_TblEnt))) == NULL) {
+		return (NULL);
+	}
+	for (i = 0; i < nSlots; i++) {
+		ents[i].key = NULL;
+	}
+	return (ents);
+}
+
+/*
+ * Initialize a table structure. The nBuckets argument is a hint for the
+ * initial number of slots (it is rounded up to a power of 2).
+ */
 void
 AG_TblInit(AG_Tbl *tbl, Uint nBuckets, Uint flags)
 {
-	Uint i;
+	Uint nSlots = AG_TBL_MIN_SLOTS;
 
+	while (nSlots < nBuckets) {
+		nSlots <<= 1;
+	}
 	tbl->flags = flags;
-	tbl->nBuckets = nBuckets;
-	tbl->buckets = Malloc(nBuckets*sizeof(AG_TblBucket));
+	tbl->nEnts = 0;
+	tbl->ents[0] = Malloc(nSlots*sizeof(AG_TblEnt));
+	tbl->nSlots[0] = nSlots;
+	tbl->maxDist[0] = 0;
+	tbl->ents[1] = NULL;
+	tbl->nSlots[1] = 0;
+	tbl->maxDist[1] = 0;
+	tbl->migrate = 0;
 
-	for (i = 0; i < nBuckets; i++) {
-		AG_TblBucket *buck = &tbl->buckets[i];
-		buck->keys = NULL;
-		buck->ents = NULL;
-		buck->nEnts = 0;
-	}
+	while (nSlots-- > 0)
+		tbl->ents[0][nSlots].key = NULL;
 }
 
 /* Release the resources allocated by a table. */
@@ -68,48 +99,182 @@ AG_TblDestroy(AG_Tbl *t)
 {
 	Uint i, j;
 
-	for (i = 0; i < t->nBuckets; i++) {
-		AG_TblBucket *buck = &t->buckets[i];
+	for (i = 0; i < 2; i++) {
+		for (j = 0; j < t->nSlots[i]; j++) {
+			AG_TblEnt *ent = &t->ents[i][j];
 
-		for (j = 0; j < buck->nEnts; j++) {
-			free(buck->keys[j]);
-			AG_FreeVariable(&buck->ents[j]);
+			if (ent->key == NULL) {
+				continue;
+			}
+			free(ent->key);
+			AG_FreeVariable(&ent->V);
 		}
-		free(buck->keys);
-		free(buck->ents);
+		free(t->ents[i]);
+		t->ents[i] = NULL;
+		t->nSlots[i] = 0;
 	}
-	free(t->buckets);
+	t->nEnts = 0;
 }
 
-/* Look up a named table entry. */
-AG_Variable *
-AG_TblLookupHash(AG_Tbl *tbl, Uint h, const char *key)
+/*
+ * Insert an entry into the current slot array (which must have a free slot),
+ * displacing entries closer to their home slot (Robin Hood).
+ */
+static void
+PlaceEnt(AG_Tbl *tbl, const AG_TblEnt *entIns)
 {
-	AG_TblBucket *buck = &tbl->buckets[h];
-	Uint i;
+	const Uint mask = tbl->nSlots[0] - 1;
+	AG_TblEnt ent, tmp;
+	Uint pos;
+
+	ent = *entIns;
+	ent.dist = 0;
+	for (pos = ent.hash & mask; ; pos = (pos+1) & mask) {
+		AG_TblEnt *slot = &tbl->ents[0][pos];
 
-	for (i = 0; i < buck->nEnts; i++) {
-		if (strcmp(buck->keys[i], key) == 0)
+		if (slot->key == NULL) {
+			*slot = ent;
+			if (ent.dist > tbl->maxDist[0]) {
+				tbl->maxDist[0] = ent.dist;
+			}
+			return;
+		}
+		if (slot->dist < ent.dist) {
+			if (ent.dist > tbl->maxDist[0]) {
+				tbl->maxDist[0] = ent.dist;
+			}
+			tmp = *slot;
+			*slot = ent;
+			ent = tmp;
+		}
+		ent.dist++;
+	}
+}
+
+/* Move up to nSlots slots from the old slot array into the current one. */
+static void
+Migrate(AG_Tbl *tbl, Uint nSlots)
+{
+	if (tbl->ents[1] == NULL)
+		return;
+
+	for (; nSlots > 0 && tbl->migrate < tbl->nSlots[1]; nSlots--) {
+		AG_TblEnt *ent = &tbl->ents[1][tbl->migrate++];
+
+		if (ent->key != NULL) {
+			PlaceEnt(tbl, ent);
+			ent->key = NULL;		/* Now owned by ents[0] */
+			memset(&ent->V, 0, sizeof(AG_Variable));
+		}
+	}
+	if (tbl->migrate == tbl->nSlots[1]) {
+		free(tbl->ents[1]);
+		tbl->ents[1] = NULL;
+		tbl->nSlots[1] = 0;
+		tbl->maxDist[1] = 0;
+		tbl->migrate = 0;
+	}
+}
+
+/*
+ * Ensure that the current slot array can hold one more entry without
+ * exceeding a 3/4 load factor. If not, allocate a larger array and begin
+ * migrating entries from the current one.
+ */
+static int
+Reserve(AG_Tbl *tbl)
+{
+	AG_TblEnt *entsNew;
+	Uint nSlotsNew;
+
+	if ((tbl->nEnts + 1) <= (tbl->nSlots[0] >> 1) + (tbl->nSlots[0] >> 2))
+		return (0);
+
+	if (tbl->ents[1] != NULL) {			/* Previous resize */
+		Migrate(tbl, tbl->nSlots[1]);
+	}
+	nSlotsNew = tbl->nSlots[0] << 1;
+	if ((entsNew = AllocSlots(nSlotsNew)) == NULL) {
+		return (-1);
+	}
+	tbl->ents[1] = tbl->ents[0];
+	tbl->nSlots[1] = tbl->nSlots[0];
+	tbl->maxDist[1] = tbl->maxDist[0];
+	tbl->migrate = 0;
+	tbl->ents[0] = entsNew;
+	tbl->nSlots[0] = nSlotsNew;
+	tbl->maxDist[0] = 0;
+	return (0);
+}
+
+/* Find the slot holding the given key in the current array. */
+static AG_TblEnt *
+FindEnt(const AG_Tbl *tbl, Uint h, const char *key)
+{
+	const Uint mask = tbl->nSlots[0] - 1;
+	Uint pos, dist;
+
+	for (pos = h & mask, dist = 0;
+	     dist <= tbl->maxDist[0];
+	     pos = (pos+1) & mask, dist++) {
+		AG_TblEnt *slot = &tbl->ents[0][pos];
+
+		if (slot->key == NULL || slot->dist < dist) {
 			break;
+		}
+		if (slot->hash == h && strcmp(slot->key, key) == 0)
+			return (slot);
 	}
-	if (i == buck->nEnts) {
+	return (NULL);
+}
+
+/*
+ * Find the slot holding the given key in the old (migrating) array. Since
+ * migration leaves holes, probe up to maxDist without stopping at free slots.
+ */
+static AG_TblEnt *
+FindEntOld(const AG_Tbl *tbl, Uint h, const char *key)
+{
+	const Uint mask = tbl->nSlots[1] - 1;
+	Uint pos, dist;
+
+	if (tbl->ents[1] == NULL)
+		return (NULL);
+
+	for (pos = h & mask, dist = 0;
+	     dist <= tbl->maxDist[1];
+	     pos = (pos+1) & mask, dist++) {
+		AG_TblEnt *slot = &tbl->ents[1][pos];
+
+		if (slot->key != NULL && slot->hash == h &&
+		    strcmp(slot->key, key) == 0)
+			return (slot);
+	}
+	return (NULL);
+}
+
+/*
+ * Look up a named table entry. The returned pointer remains valid until
+ * the next insert or delete operation on the table.
+ */
+AG_Variable *
+AG_TblLookupHash(AG_Tbl *tbl, Uint h, const char *key)
+{
+	AG_TblEnt *ent;
+
+	if ((ent = FindEnt(tbl, h, key)) == NULL &&
+	    (ent = FindEntOld(tbl, h, key)) == NULL) {
 		return (NULL);
 	}
-	return (&buck->ents[i]);
+	return (&ent->V);
 }
 
 /* Evaluate whether a table entry exists. */
 int
 AG_TblExistsHash(AG_Tbl *tbl, Uint h, const char *key)
 {
-	AG_TblBucket *buck = &tbl->buckets[h];
-	Uint i;
-	
-	for (i = 0; i < buck->nEnts; i++) {
-		if (strcmp(buck->keys[i], key) == 0)
-			return (1);
-	}
-	return (0);
+	return (FindEnt(tbl, h, key) != NULL ||
+	        FindEntOld(tbl, h, key) != NULL);
 }
 
 /*
@@ -119,34 +284,28 @@ AG_TblExistsHash(AG_Tbl *tbl, Uint h, const char *key)
 int
 AG_TblInsertHash(AG_Tbl *tbl, Uint h, const char *key, const AG_Variable *V)
 {
-	AG_TblBucket *buck = &tbl->buckets[h];
-	AG_Variable *entsNew;
-	char **keysNew;
-	Uint i;
+	AG_TblEnt ent;
 
-	for (i = 0; i < buck->nEnts; i++) {
-		if (strcmp(buck->keys[i], key) == 0)
-			break;
-	}
-	if (!(tbl->flags & AG_TBL_DUPLICATES) && i < buck->nEnts) {
+	if (!(tbl->flags & AG_TBL_DUPLICATES) &&
+	    AG_TblExistsHash(tbl, h, key)) {
 		AG_SetErrorV("E27", "Table entry exists");
 		return (-1);
 	}
-
-	if ((entsNew = TryRealloc(buck->ents,
-	    (buck->nEnts+1)*sizeof(AG_Variable))) == NULL) {
+	if (Reserve(tbl) == -1) {
+		return (-1);
+	}
+	if ((ent.key = TryStrdup(key)) == NULL) {
 		return (-1);
 	}
-	if ((keysNew = TryRealloc(buck->keys,
-	    (buck->nEnts+1)*sizeof(char *))) == NULL) {
-		free(entsNew);
+	if (AG_CopyVariable(&ent.V, V) == -1) {
+		free(ent.key);
 		return (-1);
 	}
-	buck->ents = entsNew;
-	buck->keys = keysNew;
-	buck->keys[buck->nEnts] = Strdup(key);
-	AG_CopyVariable(&buck->ents[buck->nEnts], V);
-	buck->nEnts++;
+	ent.hash = h;
+	PlaceEnt(tbl, &ent);
+	tbl->nEnts++;
+
+	Migrate(tbl, AG_TBL_MIGRATE_STEP);
 	return (0);
 }
 
@@ -154,27 +313,37 @@ AG_TblInsertHash(AG_Tbl *tbl, Uint h, const char *key, const AG_Variable *V)
 int
 AG_TblDeleteHash(AG_Tbl *tbl, Uint h, const char *key)
 {
-	AG_TblBucket *buck = &tbl->buckets[h];
-	Uint i;
+	AG_TblEnt *ent;
 
-	for (i = 0; i < buck->nEnts; i++) {
-		if (strcmp(buck->keys[i], key) == 0)
-			break;
-	}
-	if (i == buck->nEnts) {
+	if ((ent = FindEnt(tbl, h, key)) != NULL) {
+		const Uint mask = tbl->nSlots[0] - 1;
+		Uint pos = (Uint)(ent - tbl->ents[0]);
+
+		free(ent->key);
+		AG_FreeVariable(&ent->V);
+
+		/* Backward-shift the following displaced entries. */
+		for (;;) {
+			AG_TblEnt *next = &tbl->ents[0][(pos+1) & mask];
+
+			if (next->key == NULL || next->dist == 0) {
+				break;
+			}
+			tbl->ents[0][pos] = *next;
+			tbl->ents[0][pos].dist--;
+			pos = (pos+1) & mask;
+		}
+		tbl->ents[0][pos].key = NULL;
+	} else if ((ent = FindEntOld(tbl, h, key)) != NULL) {
+		free(ent->key);
+		AG_FreeVariable(&ent->V);
+		ent->key = NULL;
+	} else {
 		AG_SetErrorV("E28", "No such table entry");
 		return (-1);
 	}
+	tbl->nEnts--;
 
-	free(buck->keys[i]);
-	AG_FreeVariable(&buck->ents[i]);
-
-	if (i < buck->nEnts-1) {
-		memmove(&buck->ents[i], &buck->ents[i+1],
-		    (buck->nEnts - i - 1)*sizeof(AG_Variable));
-		memmove(&buck->keys[i], &buck->keys[i+1],
-		    (buck->nEnts - i - 1)*sizeof(char *));
-	}
-	buck->nEnts--;
+	Migrate(tbl, AG_TBL_MIGRATE_STEP);
 	return (0);
 }
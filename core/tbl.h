@@ -7,21 +7,35 @@
 #define _AGAR_CORE_TBL_H_
 #include <agar/core/begin.h>
 
-typedef struct ag_tbl_bucket {
-	char *_Nullable *_Nonnull keys;
-	AG_Variable *_Nullable    ents;
-	Uint                     nEnts;
-	Uint32 _pad;
-} AG_TblBucket;
+/* Table slot (open addressing with Robin Hood displacement). */
+typedef struct ag_tbl_ent {
+	char *_Nullable key;		/* Key string (NULL = free slot) */
+	Uint hash;			/* Precomputed hash of key */
+	Uint dist;			/* Displacement from home slot */
+	AG_Variable V;			/* Entry data */
+} AG_TblEnt;
 
 typedef struct ag_tbl {
 	Uint flags;
 #define AG_TBL_DUPLICATES	0x01	/* Allow duplicate entries */
 
-	Uint                  nBuckets;		/* Bucket count */
-	AG_TblBucket *_Nonnull buckets;		/* Hash buckets */
+	Uint nEnts;			/* Total entry count */
+
+	/*
+	 * Slot arrays. Growing the table allocates a new ents[0] and moves
+	 * the previous array to ents[1], from which entries are migrated a
+	 * few slots at a time on every subsequent insert or delete.
+	 */
+	AG_TblEnt *_Nullable ents[2];
+	Uint                nSlots[2];	/* Size of ents[] (power of 2) */
+	Uint               maxDist[2];	/* Largest displacement in ents[] */
+	Uint migrate;			/* Migration cursor in ents[1] */
+	Uint32 _pad;
 } AG_Tbl;
 
+#define AG_TBL_MIGRATE_STEP  8		/* Slots migrated per insert/delete */
+#define AG_TBL_MIN_SLOTS     8		/* Minimum slot array size */
+
 __BEGIN_DECLS
 AG_Tbl *_Nonnull AG_TblNew(Uint, Uint);
 void             AG_TblInit(AG_Tbl *_Nonnull, Uint, Uint);
@@ -37,11 +51,12 @@ int                    AG_TblDeleteHash(AG_Tbl *_Nonnull, Uint, const char *_Non
 
 /* Iterate over each entry. */
 #define AG_TBL_FOREACH(var, i,j, tbl)					\
-	for ((i) = 0; ((i) < (tbl)->nBuckets); (i)++)			\
-		for ((j) = 0;						\
-		    ((j) < (tbl)->buckets[i].nEnts) &&			\
-		     ((var) = &(tbl)->buckets[i].ents[j]);		\
-		     (j)++)
+	for ((i) = 0; (i) < 2; (i)++)					\
+		for ((j) = 0; (j) < (tbl)->nSlots[i]; (j)++)		\
+			if ((tbl)->ents[i][j].key == NULL ||		\
+			    ((var) = &(tbl)->ents[i][j].V) == NULL) {	\
+				continue;				\
+			} else
 /*
  * Inlinables
  */
@@ -154,6 +154,8 @@ typedef struct ag_text_ent {
 	char *_Nullable buf;		/* String buffer */
 	AG_Size maxLen;			/* Length (allocated) */
 	AG_Size len;			/* Length (chars) */
+	Uint32 revision;		/* Bumped when text is modified */
+	Uint32 _pad;
 } AG_TextEnt;
 
 /* Text object */
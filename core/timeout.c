@@ -37,12 +37,121 @@ AG_Object agTimerMgr;
 AG_Mutex agTimerLock;
 #endif
 
+/*
+ * Binary min-heap of scheduled soft timers (ordered by tSched), used when
+ * the event sink has no native timer support (!caps[AG_SINK_TIMER]).
+ * Element 0 is unused; AG_TimerPvt.heapIdx is the 1-based position of a
+ * timer in the heap (0 = not in heap). Protected by agTimerLock.
+ */
+static AG_Timer *_Nullable *_Nullable agTimerHeap = NULL;
+static Uint                           agTimerHeapCount = 0;
+static Uint                           agTimerHeapMax = 0;
+static AG_TimerStats                  agTimerStats;
+
+/* Return true if timer a expires before timer b (wraparound-safe). */
+#define TIMER_BEFORE(a,b) ((int)((a)->tSched - (b)->tSched) < 0)
+
+static void
+HeapSiftUp(Uint i)
+{
+	AG_Timer *to = agTimerHeap[i];
+
+	while (i > 1 && TIMER_BEFORE(to, agTimerHeap[i >> 1])) {
+		agTimerHeap[i] = agTimerHeap[i >> 1];
+		agTimerHeap[i]->pvt.heapIdx = i;
+		i >>= 1;
+	}
+	agTimerHeap[i] = to;
+	to->pvt.heapIdx = i;
+}
+
+static void
+HeapSiftDown(Uint i)
+{
+	AG_Timer *to = agTimerHeap[i];
+	const Uint n = agTimerHeapCount;
+	Uint child;
+
+	while ((child = (i << 1)) <= n) {
+		if (child < n &&
+		    TIMER_BEFORE(agTimerHeap[child+1], agTimerHeap[child])) {
+			child++;
+		}
+		if (!TIMER_BEFORE(agTimerHeap[child], to)) {
+			break;
+		}
+		agTimerHeap[i] = agTimerHeap[child];
+		agTimerHeap[i]->pvt.heapIdx = i;
+		i = child;
+	}
+	agTimerHeap[i] = to;
+	to->pvt.heapIdx = i;
+}
+
+/* Insert a timer into the heap (or reposition it if already present). */
+static int
+HeapUpdate(AG_Timer *to)
+{
+	Uint i;
+
+	if ((i = to->pvt.heapIdx) != 0) {
+		if (i > 1 && TIMER_BEFORE(to, agTimerHeap[i >> 1])) {
+			HeapSiftUp(i);
+		} else {
+			HeapSiftDown(i);
+		}
+		return (0);
+	}
+	if (agTimerHeapCount+1 >= agTimerHeapMax) {
+		Uint maxNew = (agTimerHeapMax > 0) ? (agTimerHeapMax << 1) : 32;
+		AG_Timer **heapNew;
+
+		if ((heapNew = TryRealloc(agTimerHeap,
+		    maxNew*sizeof(AG_Timer *))) == NULL) {
+			return (-1);
+		}
+		agTimerHeap = heapNew;
+		agTimerHeapMax = maxNew;
+	}
+	i = ++agTimerHeapCount;
+	agTimerHeap[i] = to;
+	HeapSiftUp(i);
+	agTimerStats.nArmed = agTimerHeapCount;
+	return (0);
+}
+
+/* Remove a timer from the heap (if present). */
+static void
+HeapRemove(AG_Timer *to)
+{
+	const Uint i = to->pvt.heapIdx;
+	AG_Timer *last;
+
+	if (i == 0) {
+		return;
+	}
+	to->pvt.heapIdx = 0;
+	last = agTimerHeap[agTimerHeapCount--];
+	agTimerStats.nArmed = agTimerHeapCount;
+	if (last == to) {
+		return;
+	}
+	agTimerHeap[i] = last;
+	last->pvt.heapIdx = i;
+	if (i > 1 && TIMER_BEFORE(last, agTimerHeap[i >> 1])) {
+		HeapSiftUp(i);
+	} else {
+		HeapSiftDown(i);
+	}
+}
+
 void
 AG_InitTimers(void)
 {
 	AG_MutexInitRecursive(&agTimerLock);
 	AG_ObjectInit(&agTimerMgr, NULL);
 	agTimerMgr.flags |= AG_OBJECT_STATIC;
+	memset(&agTimerStats, 0, sizeof(AG_TimerStats));
 }
 
 void
@@ -50,6 +159,10 @@ AG_DestroyTimers(void)
 {
 	AG_ObjectDestroy(&agTimerMgr);
 	AG_MutexDestroy(&agTimerLock);
+	free(agTimerHeap);
+	agTimerHeap = NULL;
+	agTimerHeapCount = 0;
+	agTimerHeapMax = 0;
 }
 
 /*
@@ -102,7 +215,6 @@ AG_AddTimer(void *p, AG_Timer *to, Uint32 ival, AG_TimerFn fn,
 {
 	AG_EventSource *src = AG_GetEventSource();
 	AG_Object *ob = (p != NULL) ? OBJECT(p) : &agTimerMgr;
-	AG_Timer *toOther;
 	int newTimer = 0;
 	AG_Event *ev;
 	
@@ -120,31 +232,25 @@ AG_AddTimer(void *p, AG_Timer *to, Uint32 ival, AG_TimerFn fn,
 		} else if (to->obj != ob) {
 			AG_FatalError("to->obj != ob");
 		}
-	} else {				/* Ordered timing wheel */
+	} else {				/* Soft timer heap */
+		to->tSched = AG_GetTicks()+ival;
 		if (to->obj == NULL) {
+			to->pvt.heapIdx = 0;
+			if (HeapUpdate(to) == -1) {
+				AG_UnlockTimers(ob);
+				return (-1);
+			}
+			if (TAILQ_EMPTY(&ob->timers)) {
+				TAILQ_INSERT_TAIL(&agTimerObjQ, ob, tobjs);
+			}
+			TAILQ_INSERT_TAIL(&ob->timers, to, pvt.timers);
 			newTimer = 1;
 			to->obj = ob;
 		} else if (to->obj != ob) {
 			AG_FatalError("to->obj != ob");
-		}
-		if (TAILQ_EMPTY(&ob->timers)) {
-			TAILQ_INSERT_TAIL(&agTimerObjQ, ob, tobjs);
-		}
-		to->tSched = AG_GetTicks()+ival;
-reinsert:
-		TAILQ_FOREACH(toOther, &ob->timers, pvt.timers) {
-			if (toOther == to) {
-				newTimer = 0;
-				TAILQ_REMOVE(&ob->timers, to, pvt.timers);
-				goto reinsert;
-			}
-			if (to->tSched < toOther->tSched) {
-				TAILQ_INSERT_BEFORE(toOther, to, pvt.timers);
-				break;
-			}
-		}
-		if (toOther == TAILQ_END(&ob->timers)) {
-			TAILQ_INSERT_TAIL(&ob->timers, to, pvt.timers);
+		} else if (HeapUpdate(to) == -1) {
+			AG_UnlockTimers(ob);
+			return (-1);
 		}
 		to->ival = ival;
 		to->id = 0;				/* Not needed */
@@ -171,6 +277,7 @@ reinsert:
 	return (0);
 fail:
 	to->obj = NULL;
+	HeapRemove(to);
 	TAILQ_REMOVE(&ob->timers, to, pvt.timers);
 	if (TAILQ_EMPTY(&ob->timers)) { TAILQ_REMOVE(&agTimerObjQ, ob, tobjs); }
 	AG_UnlockTimers(ob);
@@ -197,18 +304,20 @@ AG_InitTimer(AG_Timer *to, const char *name, Uint flags)
 	to->ival = 0;
 	to->tSched = 0;
 	to->fn = NULL;
+	to->pvt.heapIdx = 0;
 }
 
 /*
  * Change the interval of a timer. The timer must be running.
  * This is called whenever a timer callback returns a new interval.
+ * On failure, the timer is left unscheduled and the caller should
+ * cancel it with AG_DelTimer().
  */
 int
 AG_ResetTimer(void *p, AG_Timer *to, Uint32 ival)
 {
 	AG_EventSource *src = AG_GetEventSource();
 	AG_Object *ob = (p != NULL) ? OBJECT(p) : &agTimerMgr;
-	AG_Timer *toOther;
 	int rv = 0;
 	
 	AG_LockTimers(ob);
@@ -217,17 +326,12 @@ AG_ResetTimer(void *p, AG_Timer *to, Uint32 ival)
 		rv = -1;
 		goto out;
 	}
-	if (!src->caps[AG_SINK_TIMER]) {	/* Ordered timing wheel */
+	if (!src->caps[AG_SINK_TIMER]) {	/* Soft timer heap */
 		to->tSched = AG_GetTicks()+ival;
-		TAILQ_REMOVE(&ob->timers, to, pvt.timers);
-		TAILQ_FOREACH(toOther, &ob->timers, pvt.timers) {
-			if (to->tSched < toOther->tSched) {
-				TAILQ_INSERT_BEFORE(toOther, to, pvt.timers);
-				break;
-			}
+		if (HeapUpdate(to) == -1) {
+			rv = -1;
+			goto out;
 		}
-		if (toOther == TAILQ_END(&ob->timers))
-			TAILQ_INSERT_TAIL(&ob->timers, to, pvt.timers);
 	}
 	to->ival = ival;
 out:
@@ -257,6 +361,7 @@ AG_DelTimer(void *p, AG_Timer *to)
 	}
 	to->id = -1;
 	to->obj = NULL;
+	HeapRemove(to);
 
 	TAILQ_REMOVE(&ob->timers, to, pvt.timers);
 	if (TAILQ_EMPTY(&ob->timers))
@@ -320,42 +425,100 @@ AG_ExecTimer(AG_Timer *to)
  * as a time source. This is used on platforms where system timers are not
  * available and delay loops are the only option.
  *
+ * Expired timers are popped off the top of the soft timer heap, so the
+ * cost is proportional to the number of expired timers (not the total
+ * number of timers). A timer which is restarted with an interval short
+ * enough to expire again is not re-executed until the next call.
+ *
  * Applications calling this routine explicitely must pass AG_SOFT_TIMERS to
  * AG_InitCore().
  */
 void
 AG_ProcessTimeouts(Uint32 t)
 {
-	AG_Timer *to, *toNext;
-	AG_Object *ob, *obNext;
-	Uint32 rv;
+	AG_Timer *to;
+	AG_Object *ob;
+	Uint32 rv, late;
+	Uint nExpired = 0, nMax, bucket;
 
 	AG_LockTiming();
 
-	for (ob = TAILQ_FIRST(&agTimerObjQ);
-	     ob != TAILQ_END(&agTimerObjQ);
-	     ob = obNext) {
-		obNext = TAILQ_NEXT(ob, tobjs);
+	for (nMax = agTimerHeapCount; nMax > 0; nMax--) {
+		if (agTimerHeapCount == 0) {
+			break;
+		}
+		to = agTimerHeap[1];
+		if ((int)(to->tSched - t) > 0) {
+			break;
+		}
+		late = t - to->tSched;
+		for (bucket = 0;
+		     late > 0 && bucket < AG_TIMER_LATE_BUCKETS-1;
+		     bucket++) {
+			late >>= 1;
+		}
+		agTimerStats.late[bucket]++;
+		nExpired++;
+
+		ob = to->obj;
 		AG_ObjectLock(ob);
-rescan:
-		for (to = TAILQ_FIRST(&ob->timers);
-		     to != TAILQ_END(&ob->timers);
-		     to = toNext) {
-			toNext = TAILQ_NEXT(to, pvt.timers);
-
-			if ((int)(to->tSched - t) > 0) {
-				continue;
-			}
-			rv = to->fn(to, &to->fnEvent);
-			if (rv > 0) {				/* Restart */
-				(void)AG_ResetTimer(ob, to, rv);
-				goto rescan;
-			} else {				/* Cancel */
+		rv = to->fn(to, &to->fnEvent);
+		if (AG_TimerIsRunning(ob, to)) {	/* Not deleted by fn? */
+			if (rv == 0 ||			/* Cancel */
+			    AG_ResetTimer(ob, to, rv) == -1)
 				AG_DelTimer(ob, to);
-			}
 		}
 		AG_ObjectUnlock(ob);
 	}
+
+	agTimerStats.nExpiredLast = nExpired;
+	if (nExpired > agTimerStats.nExpiredMax) {
+		agTimerStats.nExpiredMax = nExpired;
+	}
+	agTimerStats.nExpiredTotal += nExpired;
+	agTimerStats.nTicks++;
+
+	AG_UnlockTiming();
+}
+
+/*
+ * Return the number of ticks until the next soft timer expires (relative
+ * to time t), 0 if a timer has already expired, or AG_TIMEOUT_NONE if no
+ * soft timers are scheduled.
+ */
+Uint32
+AG_NextTimeout(Uint32 t)
+{
+	Uint32 rv;
+
+	AG_LockTiming();
+	if (agTimerHeapCount == 0) {
+		rv = AG_TIMEOUT_NONE;
+	} else if ((int)(agTimerHeap[1]->tSched - t) <= 0) {
+		rv = 0;
+	} else {
+		rv = agTimerHeap[1]->tSched - t;
+	}
+	AG_UnlockTiming();
+	return (rv);
+}
+
+/* Return a snapshot of the soft timer statistics. */
+void
+AG_GetTimerStats(AG_TimerStats *st)
+{
+	AG_LockTiming();
+	memcpy(st, &agTimerStats, sizeof(AG_TimerStats));
+	AG_UnlockTiming();
+}
+
+/* Reset the soft timer statistics counters. */
+void
+AG_ResetTimerStats(void)
+{
+	AG_LockTiming();
+	memset(&agTimerStats, 0, sizeof(AG_TimerStats));
+	agTimerStats.nArmed = agTimerHeapCount;
 	AG_UnlockTiming();
 }
 #endif /* AG_TIMERS */
@@ -308,13 +308,10 @@ AG_Unset(void *pObj, const char *name)
 #ifdef AG_DEBUG
 	Debug2(obj, "Unset \"" AGSI_YEL "%s" AGSI_RST "\"\n", name);
 #endif
-	TAILQ_FOREACH(V, &obj->vars, vars) {
-		if (strcmp(V->name, name) == 0) {
-			TAILQ_REMOVE(&obj->vars, V, vars);
-			AG_FreeVariable(V);
-			free(V);
-			break;
-		}
+	if ((V = AG_LookupVariable(obj, name)) != NULL) {
+		AG_ObjectRemoveVariable(obj, V);
+		AG_FreeVariable(V);
+		free(V);
 	}
 }
 
@@ -324,6 +321,14 @@ AG_Unset(void *pObj, const char *name)
 	if (OBJECT(obj)->flags & AG_OBJECT_BOUND_EVENTS) \
 		AG_PostEvent((obj), "bound", "%p", (V))
 
+/* Record a change to the contents of a string variable. */
+#undef  FN_STRING_CHANGED
+#if AG_MODEL != AG_SMALL
+# define FN_STRING_CHANGED(V) (V)->revision++
+#else
+# define FN_STRING_CHANGED(V)
+#endif
+
 #define FN_VARIABLE_GET_ACCESS_VARIABLE				\
 	if ((V = AG_AccessVariable(obj,name)) == NULL) 		\
 		AG_FatalErrorV("E20", "No such variable")
@@ -1340,14 +1345,10 @@ AG_SetString(void *pObj, const char *name, const char *s)
 	Debug2(obj, "Set \"" AGSI_YEL "%s" AGSI_RST "\" -> \""
 	    AGSI_BOLD "%s" AGSI_RST "\"\n", name, s);
 #endif
-	TAILQ_FOREACH(V, &obj->vars, vars) {
-		if (strcmp(V->name, name) == 0)
-			break;
-	}
-	if (V == NULL) {
+	if ((V = AG_LookupVariable(obj, name)) == NULL) {
 		V = Malloc(sizeof(AG_Variable));
 		AG_InitVariable(V, AG_VARIABLE_STRING, name);
-		TAILQ_INSERT_TAIL(&obj->vars, V, vars);
+		AG_ObjectInsertVariable(obj, V);
 
 		V->info.size = 0;				/* Allocated */
 		V->data.s = Strdup(s);
@@ -1359,6 +1360,7 @@ AG_SetString(void *pObj, const char *name, const char *s)
 			}
 			V->data.s = Strdup(s);
 			V->info.size = 0;
+			FN_STRING_CHANGED(V);
 			break;
 		case AG_VARIABLE_P_STRING:
 			AG_LockVariable(V);
@@ -1369,6 +1371,7 @@ AG_SetString(void *pObj, const char *name, const char *s)
 #else
 			Strlcpy(V->data.s, s, V->info.size);
 #endif
+			FN_STRING_CHANGED(V);
 			AG_UnlockVariable(V);
 			break;
 		default:
@@ -1440,6 +1443,7 @@ AG_SetStringNODUP(void *obj, const char *name, char *s)
 		}
 		V->data.s = s;
 		V->info.size = 0;
+		FN_STRING_CHANGED(V);
 		break;
 	case AG_VARIABLE_P_STRING:
 		AG_LockVariable(V);
@@ -1450,6 +1454,7 @@ AG_SetStringNODUP(void *obj, const char *name, char *s)
 #else
 		Strlcpy(V->data.s, s, V->info.size);
 #endif
+		FN_STRING_CHANGED(V);
 		AG_UnlockVariable(V);
 		break;
 	default:
@@ -1493,6 +1498,7 @@ AG_BindString(void *obj, const char *name, char *buf, AG_Size bufSize)
 	V = AG_FetchVariableOfType(obj, name, AG_VARIABLE_P_STRING);
 	V->data.s = buf;
 	V->info.size = bufSize;
+	FN_STRING_CHANGED(V);
 	FN_POST_BOUND_EVENT(obj, V);
 	AG_ObjectUnlock(obj);
 	return (V);
@@ -1516,6 +1522,7 @@ AG_BindStringMp(void *obj, const char *name, char *v, AG_Size size,
 	V->mutex = mutex;
 	V->data.s = v;
 	V->info.size = size;
+	FN_STRING_CHANGED(V);
 	FN_POST_BOUND_EVENT(obj, V);
 	AG_ObjectUnlock(obj);
 	return (V);
@@ -166,6 +166,11 @@ typedef struct ag_variable {
 	} info;
 	union ag_variable_data data;	/* Variable-stored data */
 	AG_TAILQ_ENTRY(ag_variable) vars;
+#if AG_MODEL != AG_SMALL
+	struct ag_variable *_Nullable varsHash; /* Next in object's var index */
+	Uint32 nameHash;                        /* Hash of name (or 0) */
+	Uint32 revision;                        /* Bumped when string is set */
+#endif
 } AG_Variable;
 
 #define AG_VARIABLE_TYPE(V)      (agVariableTypes[(V)->type].typeTgt)
@@ -577,6 +582,7 @@ AG_Variable *_Nonnull AG_BindVariable(void *_Nonnull, const char *_Nonnull,
 /*
  * Inlinables
  */
+Uint32 ag_variable_hash(const char *_Nonnull) _Pure_Attribute;
 void ag_init_variable(AG_Variable *_Nonnull, AG_VariableType, const char *_Nonnull);
 void ag_lock_variable(AG_Variable *_Nonnull);
 void ag_unlock_variable(AG_Variable *_Nonnull);
@@ -586,6 +592,7 @@ void ag_free_variable(AG_Variable *_Nonnull);
 # define AG_INLINE_HEADER
 # include <agar/core/inline_variable.h>
 #else
+# define AG_VariableHash(n)     ag_variable_hash(n)
 # define AG_InitVariable(V,t,n) ag_init_variable((V),(t),(n))
 # define AG_FreeVariable(V)     ag_free_variable(V)
 # ifdef AG_THREADS
@@ -75,6 +75,8 @@ MANLINKS+=AG_Console.3:AG_ConsoleMsgCatS.3
 MANLINKS+=AG_Console.3:AG_ConsoleMsgPtr.3
 MANLINKS+=AG_Console.3:AG_ConsoleMsgColor.3
 MANLINKS+=AG_Console.3:AG_ConsoleClear.3
+MANLINKS+=AG_Console.3:AG_ConsoleSetMaxLines.3
+MANLINKS+=AG_Console.3:AG_ConsoleSetMaxBytes.3
 MANLINKS+=AG_Console.3:AG_ConsoleExportText.3
 MANLINKS+=AG_Console.3:AG_ConsoleExportBuffer.3
 MANLINKS+=AG_Console.3:AG_ConsoleOpenFile.3
@@ -491,6 +493,8 @@ MANLINKS+=AG_StyleSheet.3:AG_InitStyleSheet.3
 MANLINKS+=AG_StyleSheet.3:AG_DestroyStyleSheet.3
 MANLINKS+=AG_StyleSheet.3:AG_LoadStyleSheet.3
 MANLINKS+=AG_StyleSheet.3:AG_LookupStyleSheet.3
+MANLINKS+=AG_StyleSheet.3:AG_MatchStyleSheet.3
+MANLINKS+=AG_StyleSheet.3:AG_LookupStyleMatch.3
 MANLINKS+=AG_Surface.3:AG_SurfaceNew.3
 MANLINKS+=AG_Surface.3:AG_SurfaceEmpty.3
 MANLINKS+=AG_Surface.3:AG_SurfaceIndexed.3
@@ -613,6 +617,7 @@ MANLINKS+=AG_Table.3:AG_TableSelectAllCols.3
 MANLINKS+=AG_Table.3:AG_TableDeselectAllCols.3
 MANLINKS+=AG_Table.3:AG_TableColSelected.3
 MANLINKS+=AG_Table.3:AG_TableAddRow.3
+MANLINKS+=AG_Table.3:AG_TableAddRowKeyed.3
 MANLINKS+=AG_Table.3:AG_TableSelectRow.3
 MANLINKS+=AG_Table.3:AG_TableDeselectRow.3
 MANLINKS+=AG_Table.3:AG_TableSelectAllRows.3
@@ -635,6 +640,12 @@ MANLINKS+=AG_Text.3:AG_TextSize.3
 MANLINKS+=AG_Text.3:AG_TextSizeInternal.3
 MANLINKS+=AG_Text.3:AG_TextSizeMulti.3
 MANLINKS+=AG_Text.3:AG_TextSizeMultiInternal.3
+MANLINKS+=AG_Text.3:AG_TextCacheNew.3
+MANLINKS+=AG_Text.3:AG_TextCacheGet.3
+MANLINKS+=AG_Text.3:AG_TextCacheClear.3
+MANLINKS+=AG_Text.3:AG_TextCacheDestroy.3
+MANLINKS+=AG_Text.3:AG_TextCacheSetMaxBytes.3
+MANLINKS+=AG_Text.3:AG_GetTextCacheStats.3
 MANLINKS+=AG_Text.3:AG_PushTextState.3
 MANLINKS+=AG_Text.3:AG_CopyTextState.3
 MANLINKS+=AG_Text.3:AG_PopTextState.3
@@ -728,6 +739,11 @@ MANLINKS+=AG_Tlist.3:AG_TlistCompareUints.3
 MANLINKS+=AG_Tlist.3:AG_TlistCompareStrings.3
 MANLINKS+=AG_Tlist.3:AG_TlistComparePtrs.3
 MANLINKS+=AG_Tlist.3:AG_TlistComparePtrsAndCats.3
+MANLINKS+=AG_Tlist.3:AG_TlistHashFn.3
+MANLINKS+=AG_Tlist.3:AG_TlistSetHashFn.3
+MANLINKS+=AG_Tlist.3:AG_TlistHashPtrs.3
+MANLINKS+=AG_Tlist.3:AG_TlistHashStrings.3
+MANLINKS+=AG_Tlist.3:AG_TlistHashPtrsAndCats.3
 MANLINKS+=AG_Tlist.3:AG_TlistUniq.3
 MANLINKS+=AG_Tlist.3:AG_TlistSetCompareFn.3
 MANLINKS+=AG_Tlist.3:AG_TlistCompareInts.3
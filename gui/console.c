@@ -46,7 +46,19 @@
 #include <errno.h>
 #include <ctype.h>
 
+/* Size accounted to a line (and its text) against maxBytes. */
+#define LINE_SIZE(ln) (sizeof(AG_ConsoleLine) + (ln)->len + 1)
+
+/* Text allocated along with the line structure. */
+#define LINE_TEXT(ln) ((char *)&(ln)[1])
+
+/* Align allocations from line storage chunks. */
+#define CHUNK_ALIGN(n) (((n) + 7) & ~((AG_Size)7))
+#define CHUNK_DATA(ch) ((Uint8 *)(ch) + CHUNK_ALIGN(sizeof(AG_ConsoleChunk)))
+
+static AG_ConsoleLine *AppendLine(AG_Console *_Nonnull, const char *_Nullable);
 static AG_ConsoleLine *AppendMultiLine(AG_Console *_Nonnull, const char *_Nonnull);
+static void UnmapLine(AG_Console *_Nonnull, AG_ConsoleLine *_Nonnull);
 
 #define RETURN_IF_INVALID(cons) \
 	if (!AG_OBJECT_VALID(cons) || !AG_CONSOLE_ISA(cons)) \
@@ -677,23 +689,14 @@ static void
 StyleChanged(AG_Event *_Nonnull event)
 {
 	AG_Console *cons = AG_CONSOLE_SELF();
-	Uint i;
-	int j;
+	AG_ConsoleLine *ln;
 
 	cons->lineskip = WFONT(cons)->lineskip + WIDGET(cons)->spacingVert;
 /*	cons->rOffs = 0; */
 	ComputeVisible(cons);
 
-	for (i = 0; i < cons->nLines; i++) {
-		AG_ConsoleLine *ln = cons->lines[i];
-
-		for (j = 0; j < 2; j++) {
-			if (ln->surface[j] != -1) {
-				AG_WidgetUnmapSurface(cons, ln->surface[j]);
-				ln->surface[j] = -1;
-			}
-		}
-	}
+	while ((ln = TAILQ_FIRST(&cons->mapped)) != NULL)
+		UnmapLine(cons, ln);
 }
 
 static void
@@ -716,14 +719,21 @@ Init(void *_Nonnull obj)
 	cons->pm = NULL;
 	cons->pos = -1;
 	cons->sel = 0;
-	cons->gcCounter = 0;
-	cons->gcTrigger = 128;
+	cons->maxLines = 0;
+	cons->nBytes = 0;
+	cons->maxBytes = 0;
+	cons->linesBuf = NULL;
+	cons->linesOffs = 0;
+	cons->linesMax = 0;
+	cons->drawSeq = 0;
 	cons->r.x = 0;
 	cons->r.y = 0;
 	cons->r.w = 0;
 	cons->r.h = 0;
 	cons->scrollTo = NULL;
 	TAILQ_INIT(&cons->files);
+	TAILQ_INIT(&cons->chunks);
+	TAILQ_INIT(&cons->mapped);
 
 	AG_InitTimer(&cons->beginSelectTo, "beginSel", 0);
 
@@ -831,8 +841,9 @@ Draw(void *_Nonnull p)
 	const AG_Color *cBg = &WCOLOR(cons, BG_COLOR);
 	const AG_Color *cSel = &WCOLOR(cons, SELECTION_COLOR);
 	const AG_Color *cText = &WCOLOR(cons, TEXT_COLOR);
+	AG_ConsoleLine *ln, *lnNext;
 	AG_Rect r;
-	Uint lnIdx;
+	Uint lnIdx, drawSeq;
 	int pos, sel;
 
 	if (cBg->a > 0) {
@@ -858,14 +869,17 @@ Draw(void *_Nonnull p)
 	r.h = cons->lineskip + 1;
 	pos = cons->pos;
 	sel = cons->sel;
+	drawSeq = ++cons->drawSeq;
 
 	for (lnIdx = cons->rOffs;
 	     lnIdx < cons->nLines && r.y < WIDGET(cons)->h;
 	     lnIdx++) {
-		AG_ConsoleLine *ln = cons->lines[lnIdx];
 		AG_Surface *S;
 		int isSel;
 
+		ln = cons->lines[lnIdx];
+		ln->drawSeq = drawSeq;
+
 		if ((pos != -1) &&
 		    ((lnIdx == pos) ||
 		     ((sel > 0 && lnIdx > pos && lnIdx <= pos+sel+1) ||
@@ -897,6 +911,9 @@ Draw(void *_Nonnull p)
 				r.y += cons->lineskip;
 				continue;
 			}
+			if (ln->surface[!isSel] == -1) {
+				TAILQ_INSERT_TAIL(&cons->mapped, ln, mapped);
+			}
 			ln->surface[isSel] = AG_WidgetMapSurface(cons, S);
 		} else {
 			S = WSURFACE(cons, ln->surface[isSel]);
@@ -919,30 +936,203 @@ Draw(void *_Nonnull p)
 		r.y += cons->lineskip;
 	}
 	AG_PopClipRect(cons);
+
+	/* Release the surfaces of lines which have scrolled out of view. */
+	for (ln = TAILQ_FIRST(&cons->mapped); ln != NULL; ln = lnNext) {
+		lnNext = TAILQ_NEXT(ln, mapped);
+		if (ln->drawSeq != drawSeq)
+			UnmapLine(cons, ln);
+	}
 out:
 	AG_WidgetDraw(cons->vBar);
 	AG_WidgetDraw(cons->hBar);
 }
 
+/* Release the surfaces cached for a line. */
+static void
+UnmapLine(AG_Console *_Nonnull cons, AG_ConsoleLine *_Nonnull ln)
+{
+	int i;
+
+	if (ln->surface[0] == -1 && ln->surface[1] == -1) {
+		return;
+	}
+	for (i = 0; i < 2; i++) {
+		if (ln->surface[i] != -1) {
+			AG_WidgetUnmapSurface(cons, ln->surface[i]);
+			ln->surface[i] = -1;
+		}
+	}
+	TAILQ_REMOVE(&cons->mapped, ln, mapped);
+}
+
+/*
+ * Allocate a line along with a copy of its text. Small lines are carved
+ * out of the current storage chunk; chunks are freed once all of their
+ * lines have been freed.
+ */
+static AG_ConsoleLine *
+AllocLine(AG_Console *_Nonnull cons, const char *_Nullable s, AG_Size len)
+{
+	const AG_Size size = CHUNK_ALIGN(sizeof(AG_ConsoleLine) +
+	                                 ((s != NULL) ? len+1 : 0));
+	AG_ConsoleLine *ln;
+	AG_ConsoleChunk *ch;
+
+	if (size > AG_CONSOLE_CHUNK_SIZE/4) {
+		ln = Malloc(size);
+		ch = NULL;
+	} else {
+		ch = TAILQ_LAST(&cons->chunks, ag_console_chunkq);
+		if (ch == NULL || ch->len + size > AG_CONSOLE_CHUNK_SIZE) {
+			ch = Malloc(CHUNK_ALIGN(sizeof(AG_ConsoleChunk)) +
+			            AG_CONSOLE_CHUNK_SIZE);
+			ch->len = 0;
+			ch->nLines = 0;
+			TAILQ_INSERT_TAIL(&cons->chunks, ch, chunks);
+		}
+		ln = (AG_ConsoleLine *)(CHUNK_DATA(ch) + ch->len);
+		ch->len += size;
+		ch->nLines++;
+	}
+	if (s != NULL) {
+		ln->text = LINE_TEXT(ln);
+		memcpy(ln->text, s, len);
+		ln->text[len] = '\0';
+		ln->len = len;
+	} else {
+		ln->text = NULL;
+		ln->len = 0;
+	}
+	ln->surface[0] = -1;
+	ln->surface[1] = -1;
+	AG_ColorNone(&ln->c);			/* Inherit default */
+	ln->drawSeq = 0;
+	ln->p = NULL;
+	ln->cons = cons;
+	ln->parent = NULL;		/* top level / standalone line by default */
+	ln->chunk = ch;
+	return (ln);
+}
+
+static void
+FreeLine(AG_Console *_Nonnull cons, AG_ConsoleLine *_Nonnull ln)
+{
+	AG_ConsoleChunk *ch;
+
+	UnmapLine(cons, ln);
+
+	if (ln->text != LINE_TEXT(ln)) {
+		free(ln->text);
+	}
+	if ((ch = ln->chunk) == NULL) {
+		free(ln);
+		return;
+	}
+	if (--ch->nLines == 0) {
+		if (ch == TAILQ_LAST(&cons->chunks, ag_console_chunkq)) {
+			ch->len = 0;			/* Reuse current chunk */
+		} else {
+			TAILQ_REMOVE(&cons->chunks, ch, chunks);
+			free(ch);
+		}
+	}
+}
+
+/*
+ * Insert a line at the end of the buffer. Evicted entries are removed from
+ * the front of linesBuf, which is compacted once half of it is unused.
+ */
+static void
+InsertLine(AG_Console *_Nonnull cons, AG_ConsoleLine *_Nonnull ln)
+{
+	if (cons->linesOffs + cons->nLines == cons->linesMax) {
+		if (cons->linesOffs > 0 &&
+		    cons->linesOffs >= (cons->linesMax >> 1)) {
+			memmove(cons->linesBuf, cons->lines,
+			    cons->nLines * sizeof(AG_ConsoleLine *));
+			cons->linesOffs = 0;
+		} else {
+			cons->linesMax = (cons->linesMax > 0) ?
+			                 (cons->linesMax << 1) : 64;
+			cons->linesBuf = Realloc(cons->linesBuf,
+			    cons->linesMax * sizeof(AG_ConsoleLine *));
+		}
+		cons->lines = &cons->linesBuf[cons->linesOffs];
+	}
+	cons->lines[cons->nLines++] = ln;
+	cons->nBytes += LINE_SIZE(ln);
+}
+
+/*
+ * Evict the oldest lines until the buffer fits within maxLines and maxBytes.
+ * The most recent line is always retained.
+ */
+static void
+EvictLines(AG_Console *_Nonnull cons)
+{
+	Uint n = 0;
+
+	while (cons->nLines - n > 1 &&
+	       ((cons->maxLines > 0 && cons->nLines - n > cons->maxLines) ||
+	        (cons->maxBytes > 0 && cons->nBytes > cons->maxBytes))) {
+		AG_ConsoleLine *ln = cons->lines[n++];
+
+		cons->nBytes -= LINE_SIZE(ln);
+		FreeLine(cons, ln);
+	}
+	if (n == 0)
+		return;
+
+	cons->lines += n;
+	cons->linesOffs += n;
+	cons->nLines -= n;
+
+	cons->rOffs = (cons->rOffs > n) ? (cons->rOffs - n) : 0;
+
+	if (cons->pos != -1) {
+		if (cons->pos >= (int)n) {
+			cons->pos -= (int)n;
+			if (cons->pos + cons->sel < 0)
+				cons->sel = -cons->pos;
+		} else if (cons->sel > 0 && cons->pos + cons->sel >= (int)n) {
+			cons->sel -= (int)n - cons->pos;
+			cons->pos = 0;
+		} else {
+			cons->pos = -1;
+			cons->sel = 0;
+		}
+	}
+}
+
 static void
 FreeLines(AG_Console *_Nonnull cons)
 {
+	AG_ConsoleChunk *ch, *chNext;
 	Uint i;
 
 	for (i = 0; i < cons->nLines; i++) {
 		AG_ConsoleLine *ln = cons->lines[i];
-		int j;
 
-		for (j = 0; j < 2; j++) {
-			if (ln->surface[j] != -1)
-				AG_WidgetUnmapSurface(cons, ln->surface[j]);
+		UnmapLine(cons, ln);
+		if (ln->text != LINE_TEXT(ln)) {
+			free(ln->text);
 		}
-		free(ln->text);
-		free(ln);
+		if (ln->chunk == NULL)
+			free(ln);
+	}
+	for (ch = TAILQ_FIRST(&cons->chunks); ch != NULL; ch = chNext) {
+		chNext = TAILQ_NEXT(ch, chunks);
+		free(ch);
 	}
-	Free(cons->lines);
+	TAILQ_INIT(&cons->chunks);
+	Free(cons->linesBuf);
+	cons->linesBuf = NULL;
 	cons->lines = NULL;
+	cons->linesOffs = 0;
+	cons->linesMax = 0;
 	cons->nLines = 0;
+	cons->nBytes = 0;
 }
 
 static void
@@ -965,92 +1155,51 @@ AG_ConsoleSetPadding(AG_Console *cons, int padding)
 }
 #endif /* AG_LEGACY */
 
-/* Append a line to the console; backend to AG_ConsoleMsg(). */
-AG_ConsoleLine *
-AG_ConsoleAppendLine(AG_Console *cons, const char *s)
+/* Append a line to the console without locking or redrawing. */
+static AG_ConsoleLine *
+AppendLine(AG_Console *_Nonnull cons, const char *_Nullable s)
 {
 	AG_ConsoleLine *ln;
 
-	RETURN_NULL_IF_INVALID(cons);
-	AG_ObjectLock(cons);
-
 	if (s && (strchr(s, agNewlineFormats[AG_NEWLINE_NATIVE].s[0]))) {
 		ln = AppendMultiLine(cons, s);
 	} else {
-		ln = Malloc(sizeof(AG_ConsoleLine));
-
-		/* top level / standalone line by default */
-		ln->parent = NULL;
-
-		if (s && strlen(s) == 0) {
-			/* zero length strings */
-			ln->text = Strdup(s);
-			ln->len = 0;
-		} else if (s != NULL) {
-			ln->text = Strdup(s);
-			ln->len = strlen(s);
-		} else {
-			ln->text = NULL;
-			ln->len = 0;
-		}
+		ln = AllocLine(cons, s, (s != NULL) ? strlen(s) : 0);
 	}
+	InsertLine(cons, ln);
+	EvictLines(cons);
+	return (ln);
+}
 
-	cons->lines = Realloc(cons->lines, (cons->nLines+1) *
-	                                   sizeof(AG_ConsoleLine *));
-	cons->lines[cons->nLines++] = ln;
+/* Append a line to the console; backend to AG_ConsoleMsg(). */
+AG_ConsoleLine *
+AG_ConsoleAppendLine(AG_Console *cons, const char *s)
+{
+	AG_ConsoleLine *ln;
 
-	ln->cons = cons;
-	ln->p = NULL;
-	ln->surface[0] = -1;
-	ln->surface[1] = -1;
-	AG_ColorNone(&ln->c);			/* Inherit default */
+	RETURN_NULL_IF_INVALID(cons);
+	AG_ObjectLock(cons);
+
+	ln = AppendLine(cons, s);
 
 	if ((cons->flags & AG_CONSOLE_NOAUTOSCROLL) == 0)
 		cons->scrollTo = &cons->nLines;
 
-	if (++cons->gcCounter > cons->gcTrigger) {
-		Uint i;
-
-		for (i = 0;
-		     i < cons->nLines;
-		     i++) {
-			AG_ConsoleLine *ln = cons->lines[i];
-			int j;
-
-			if (i >= cons->rOffs &&
-			    i <  cons->rOffs + cons->rVisible)
-				continue;
-
-			for (j = 0; j < 2; j++) {
-				if (ln->surface[j] != -1) {
-					AG_WidgetUnmapSurface(cons,
-					    ln->surface[j]);
-					ln->surface[j] = -1;
-				}
-			}
-		}
-
-		cons->gcCounter = 0;
-	}
-
 	AG_Redraw(cons);
 	AG_ObjectUnlock(cons);
 	return (ln);
 }
 
-/* Append a line to the console; backend to AG_ConsoleMsg(). */
+/*
+ * Allocate a multi-line group; backend to AppendLine(). The child lines
+ * are inserted here, and the parent line is returned for insertion.
+ */
 static AG_ConsoleLine *
 AppendMultiLine(AG_Console *cons, const char *s)
 {
 	const AG_NewlineFormat *newline = &agNewlineFormats[AG_NEWLINE_NATIVE];
-	AG_ConsoleLine *ln;
+	AG_ConsoleLine *ln = NULL, *lnChld;
 	char *tok = NULL, *dup, *pDup;
-	int first = 1;
-
-	ln = Malloc(sizeof(AG_ConsoleLine));
-
-	/* top level / standalone line by default */
-	ln->parent = NULL;
 
 	dup = pDup = Strdup(s);
 
@@ -1058,15 +1207,14 @@ AppendMultiLine(AG_Console *cons, const char *s)
 		if (newline->len == 2 && tok[0] != '\0') { 	/* XXX */
 			tok[strlen(tok)-1] = '\0';
 		}	
-		if (first == 1) {
-			first = 0;
-
+		if (ln == NULL) {
 			/* populate this line with the first slice */
-			ln->text = Strdup(tok);
-			ln->len = strlen(tok);
+			ln = AllocLine(cons, tok, strlen(tok));
 		} else {
 			/* create a child line */
-			(AG_ConsoleAppendLine(cons, tok))->parent = ln;
+			lnChld = AllocLine(cons, tok, strlen(tok));
+			lnChld->parent = ln;
+			InsertLine(cons, lnChld);
 		}
 	}
 	free(pDup);
@@ -1076,6 +1224,23 @@ AppendMultiLine(AG_Console *cons, const char *s)
 
 }
 
+/* Append a line, stripping any trailing newline; backend to AG_ConsoleMsgS(). */
+static AG_ConsoleLine *
+AppendMsgS(AG_Console *_Nonnull cons, const char *_Nonnull s)
+{
+	AG_ConsoleLine *ln;
+	AG_Size len;
+
+	ln = AppendLine(cons, s);
+	len = ln->len;
+	if (len > 1 && ln->text[len-1] == '\n') {
+		ln->text[len-1] = '\0';
+		ln->len--;
+		cons->nBytes--;
+	}
+	return (ln);
+}
+
 /* Append a message to the console (format string). */
 AG_ConsoleLine *
 AG_ConsoleMsg(AG_Console *cons, const char *fmt, ...)
@@ -1099,6 +1264,7 @@ AG_ConsoleMsg(AG_Console *cons, const char *fmt, ...)
 		ln->text[len-1] = '\0';
 		ln->len--;
 	}
+	cons->nBytes += ln->len;
 
 	AG_ObjectUnlock(cons);
 	return (ln);
@@ -1112,25 +1278,18 @@ AG_ConsoleLine *
 AG_ConsoleMsgS(AG_Console *cons, const char *s)
 {
 	AG_ConsoleLine *ln;
-	AG_Size len;
 
 	RETURN_NULL_IF_INVALID(cons);
 	AG_ObjectLock(cons);
 
-	if ((ln = AG_ConsoleAppendLine(cons, s)) == NULL) {
-		goto fail;
-	}
-	len = ln->len;
-	if (len > 1 && ln->text[len-1] == '\n') {
-		ln->text[len-1] = '\0';
-		ln->len--;
-	}
+	ln = AppendMsgS(cons, s);
+
+	if ((cons->flags & AG_CONSOLE_NOAUTOSCROLL) == 0)
+		cons->scrollTo = &cons->nLines;
 
+	AG_Redraw(cons);
 	AG_ObjectUnlock(cons);
 	return (ln);
-fail:
-	AG_ObjectUnlock(cons);
-	return (NULL);
 }
 
 /*
@@ -1212,14 +1371,7 @@ AG_ConsoleBinary(AG_Console *cons, const void *data, AG_Size size,
 static void
 InvalidateCachedLabel(AG_Console *cons, AG_ConsoleLine *ln)
 {
-	int i;
-
-	for (i = 0; i < 2; i++) {
-		if (ln->surface[i] != -1) {
-			AG_WidgetUnmapSurface(cons, ln->surface[i]);
-			ln->surface[i] = -1;
-		}
-	}
+	UnmapLine(cons, ln);
 	AG_Redraw(cons);
 }
 
@@ -1232,9 +1384,13 @@ AG_ConsoleMsgEdit(AG_ConsoleLine *ln, const char *s)
 	RETURN_IF_INVALID(cons);
 	AG_ObjectLock(cons);
 
-	free(ln->text);
+	if (ln->text != LINE_TEXT(ln)) {
+		free(ln->text);
+	}
+	cons->nBytes -= ln->len;
 	ln->text = Strdup(s);
 	ln->len = strlen(s);
+	cons->nBytes += ln->len;
 
 	InvalidateCachedLabel(cons, ln);
 	AG_ObjectUnlock(cons);
@@ -1253,8 +1409,17 @@ AG_ConsoleMsgCatS(AG_ConsoleLine *ln, const char *s)
 	AG_ObjectLock(cons);
 
 	newLen = ln->len + sLen + 1;
-	ln->text = Realloc(ln->text, newLen);
+	if (ln->text == LINE_TEXT(ln)) {		/* Move out of chunk */
+		char *textNew;
+
+		textNew = Malloc(newLen);
+		memcpy(textNew, ln->text, ln->len + 1);
+		ln->text = textNew;
+	} else {
+		ln->text = Realloc(ln->text, newLen);
+	}
 	ln->len = newLen-1;
+	cons->nBytes += sLen;
 	Strlcat(ln->text, s, newLen);
 
 	InvalidateCachedLabel(cons, ln);
@@ -1305,6 +1470,40 @@ AG_ConsoleClear(AG_Console *cons)
 	AG_Redraw(cons);
 }
 
+/*
+ * Limit the number of lines retained in the buffer (0 = no limit).
+ * The oldest lines are evicted as new lines are appended.
+ */
+void
+AG_ConsoleSetMaxLines(AG_Console *cons, Uint maxLines)
+{
+	RETURN_IF_INVALID(cons);
+	AG_ObjectLock(cons);
+
+	cons->maxLines = maxLines;
+	EvictLines(cons);
+
+	AG_ObjectUnlock(cons);
+	AG_Redraw(cons);
+}
+
+/*
+ * Limit the total size of the lines retained in the buffer, in bytes
+ * (0 = no limit). The oldest lines are evicted as new lines are appended.
+ */
+void
+AG_ConsoleSetMaxBytes(AG_Console *cons, AG_Size maxBytes)
+{
+	RETURN_IF_INVALID(cons);
+	AG_ObjectLock(cons);
+
+	cons->maxBytes = maxBytes;
+	EvictLines(cons);
+
+	AG_ObjectUnlock(cons);
+	AG_Redraw(cons);
+}
+
 /*
  * Process available data on a file we are following.
  */
@@ -1352,6 +1551,7 @@ ConsoleReadFile(AG_EventSink *_Nonnull es, AG_Event *_Nonnull event)
 	cf->offs += nRead;
 
 	if (nRead > 0) {
+		AG_ObjectLock(cons);
 		if (cf->flags & AG_CONSOLE_FILE_BINARY) {
 			AG_ConsoleBinary(cons, buf, nRead, cf->label, NULL);
 		} else {
@@ -1365,7 +1565,7 @@ ConsoleReadFile(AG_EventSink *_Nonnull es, AG_Event *_Nonnull event)
 				     	if (line[0] == '\0') {
 						continue;
 					}
-					AG_ConsoleMsgS(cons, line);
+					AppendMsgS(cons, line);
 				}
 				break;
 			case 2:
@@ -1377,11 +1577,15 @@ ConsoleReadFile(AG_EventSink *_Nonnull es, AG_Event *_Nonnull event)
 						continue;
 					}
 					line[strlen(line)-1] = '\0';
-					AG_ConsoleMsgS(cons, line);
+					AppendMsgS(cons, line);
 				}
 				break;
 			}
+			if ((cons->flags & AG_CONSOLE_NOAUTOSCROLL) == 0)
+				cons->scrollTo = &cons->nLines;
 		}
+		AG_Redraw(cons);
+		AG_ObjectUnlock(cons);
 	}
 out:
 	free(buf);
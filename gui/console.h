@@ -10,6 +10,7 @@
 #include <agar/gui/begin.h>
 
 struct ag_console;
+struct ag_console_chunk;
 struct ag_popup_menu;
 
 /* TODO: timestamps, markup */
@@ -18,12 +19,27 @@ typedef struct ag_console_line {
 	AG_Size len;            /* Size in bytes excluding NUL */
 	int surface[2];         /* Cached surfaces (0=not selected; 1=selected) */
 	AG_Color c;             /* Alternate text color */
+	Uint drawSeq;           /* Draw sequence number when last visible */
 
 	void *_Nullable p;                        /* User pointer */
 	struct ag_console *_Nonnull cons;         /* Back pointer to console */
 	struct ag_console_line *_Nullable parent; /* Parent line for multi-line groups */
+	struct ag_console_chunk *_Nullable chunk; /* Storage chunk (or NULL) */
+	AG_TAILQ_ENTRY(ag_console_line) mapped;   /* In list of mapped lines */
 } AG_ConsoleLine;
 
+/* Block of storage for line structures and their text. */
+typedef struct ag_console_chunk {
+	AG_Size len;                             /* Bytes allocated */
+	Uint nLines;                             /* Live lines in chunk */
+	Uint32 _pad;
+	AG_TAILQ_ENTRY(ag_console_chunk) chunks;
+} AG_ConsoleChunk;
+
+#ifndef AG_CONSOLE_CHUNK_SIZE
+#define AG_CONSOLE_CHUNK_SIZE 32768	/* Line storage chunk size (bytes) */
+#endif
+
 typedef struct ag_console_file {
 	Uint flags;
 #define AG_CONSOLE_FILE_BINARY     0x01  /* Display binary in hex dump format */
@@ -55,6 +71,12 @@ typedef struct ag_console {
 
 	AG_ConsoleLine *_Nullable *_Nonnull lines;  /* Lines in buffer */
 	Uint                               nLines;  /* Line count */
+	Uint maxLines;                           /* Line limit (0 = unlimited) */
+	AG_Size nBytes;                          /* Total size of lines in buffer */
+	AG_Size maxBytes;                        /* Size limit (0 = unlimited) */
+	AG_ConsoleLine *_Nullable *_Nullable linesBuf; /* Allocated line array */
+	Uint linesOffs;                          /* Offset of lines[] in linesBuf */
+	Uint linesMax;                           /* Allocated size of linesBuf */
 
 	int wMax;                                /* Width of widest line (px) */
 	Uint rOffs;                              /* Row display offset */
@@ -64,11 +86,13 @@ typedef struct ag_console {
 	AG_Rect r;                               /* View area */
 	Uint *_Nullable scrollTo;                /* Scrolling request */
 	int pos, sel;                            /* Position and selection */
-	int gcCounter;                           /* Garbage collection counter */
-	int gcTrigger;                           /* Garbage collection threshold */
+	Uint drawSeq;                            /* Draw sequence number */
+	Uint32 _pad;
 	struct ag_popup_menu *_Nullable pm;      /* Active popup menu */
 	AG_Timer beginSelectTo;	                 /* Timer for double-click */
 	AG_TAILQ_HEAD_(ag_console_file) files;   /* Files being monitored */
+	AG_TAILQ_HEAD(ag_console_chunkq, ag_console_chunk) chunks; /* Line storage */
+	AG_TAILQ_HEAD(ag_console_lineq, ag_console_line) mapped; /* Lines with surfaces */
 } AG_Console;
 
 #define   AGCONSOLE(obj)    ((AG_Console *)(obj))
@@ -100,6 +124,8 @@ void AG_ConsoleMsgCatS(AG_ConsoleLine *_Nonnull, const char *_Nonnull);
 void AG_ConsoleMsgPtr(AG_ConsoleLine *_Nonnull, void *_Nullable);
 void AG_ConsoleMsgColor(AG_ConsoleLine *_Nonnull, const AG_Color *_Nonnull);
 void AG_ConsoleClear(AG_Console *_Nonnull);
+void AG_ConsoleSetMaxLines(AG_Console *_Nonnull, Uint);
+void AG_ConsoleSetMaxBytes(AG_Console *_Nonnull, AG_Size);
 
 char *_Nullable AG_ConsoleExportText(const AG_Console *_Nonnull, enum ag_newline_type);
 char *_Nullable AG_ConsoleExportBuffer(const AG_Console *_Nonnull, enum ag_newline_type);
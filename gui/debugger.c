@@ -49,6 +49,7 @@
 #include <agar/gui/file_dlg.h>
 #include <agar/gui/cursors.h>
 #include <agar/gui/icons.h>
+#include <agar/gui/text_cache.h>
 
 #include <string.h>
 #include <ctype.h>
@@ -153,6 +154,8 @@ PollWidgets(AG_Event *_Nonnull event)
 	AG_Label *lblStats = AG_LABEL_PTR(1);
 	const AG_Window *tgt = agDebuggerTgtWindow;
 	AG_Driver *drv;
+	AG_RedrawStats rs;
+	AG_TextCacheStats tcs;
 	Uint nWindows=0, nContainers=0, nLeaves=0;
 
 	AG_TlistBegin(tl);
@@ -176,9 +179,19 @@ PollWidgets(AG_Event *_Nonnull event)
 
 	AG_TlistEnd(tl);
 
+	AG_GetRedrawStats(&rs);
+	AG_GetTextCacheStats(&tcs);
 	AG_LabelText(lblStats,
-	    _("%u windows, %u containers & %u leaves (t = %ums)"),
-	    nWindows, nContainers, nLeaves, (Uint)AG_GetTicks());
+	    _("%u windows, %u containers & %u leaves (t = %ums)\n"
+	      "Last frame: %u widgets drawn, %u skipped "
+	      "(%u of %u frames partial)\n"
+	      "Text cache: %u hits, %u shared, %u misses, "
+	      "%u evicted (%luK); %u ents, %luK of %luK"),
+	    nWindows, nContainers, nLeaves, (Uint)AG_GetTicks(),
+	    rs.nDrawn, rs.nSkipped, rs.nPartial, rs.nFrames,
+	    tcs.nHits, tcs.nSharedHits, tcs.nMisses, tcs.nEvicted,
+	    (Ulong)(tcs.nEvictedBytes >> 10), tcs.nEnts,
+	    (Ulong)(tcs.curBytes >> 10), (Ulong)(tcs.maxBytes >> 10));
 }
 
 static void
@@ -69,6 +69,8 @@ AG_FlagDescrRO agArchExtnNames[] = {
 	{ AG_EXT_SSE4A,          "SSE4a" },
 	{ AG_EXT_SSE41,          "SSE41" },
 	{ AG_EXT_SSE42,          "SSE42" },
+	{ AG_EXT_AVX,            "AVX" },
+	{ AG_EXT_AVX2,           "AVX2" },
 	{ AG_EXT_SSE5A,          "SSE5a" },
 	{ AG_EXT_SSE_MISALIGNED, N_("Misaligned SSE Mode") },
 	{ AG_EXT_LONG_MODE,      N_("Long Mode") },
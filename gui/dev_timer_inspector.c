@@ -41,7 +41,9 @@ RefreshTableTimeout(AG_Timer *_Nonnull refreshTo, AG_Event *_Nonnull event)
 	AG_Treetbl *tt = AG_TREETBL_SELF();
 	AG_Label *lbl = AG_LABEL_PTR(1);
 	const int *pauseFlag = (const int *)AG_PTR(2);
+	AG_Label *lblStats = AG_LABEL_PTR(3);
 	extern struct ag_objectq agTimerObjQ;
+	AG_TimerStats st;
 	AG_Object *ob;
 	int id;
 
@@ -50,6 +52,15 @@ RefreshTableTimeout(AG_Timer *_Nonnull refreshTo, AG_Event *_Nonnull event)
 	}
 	AG_LabelText(lbl, _("Ticks: %u"), (Uint)AG_GetTicks());
 
+	AG_GetTimerStats(&st);
+	AG_LabelText(lblStats,
+	    _("Soft timers: %u armed, %u expired (max %u, total %lu)\n"
+	      "Late by 0:%lu 1:%lu 2-3:%lu 4-7:%lu 8-15:%lu 16-31:%lu "
+	      "32-63:%lu 64+:%lu"),
+	    st.nArmed, st.nExpiredLast, st.nExpiredMax, st.nExpiredTotal,
+	    st.late[0], st.late[1], st.late[2], st.late[3],
+	    st.late[4], st.late[5], st.late[6], st.late[7]);
+
 	AG_TreetblClearRows(tt);
 
 	id = 0;
@@ -91,7 +102,7 @@ AG_DEV_TimerInspector(void)
 	static int pauseFlag = 0;
 	AG_Window *win;
 	AG_Treetbl *tt;
-	AG_Label *lbl;
+	AG_Label *lbl, *lblStats;
 	AG_Timer *to;
 
 	if ((win = AG_WindowNewNamedS(0, "DEV_TimerInspector")) == NULL) {
@@ -100,6 +111,7 @@ AG_DEV_TimerInspector(void)
 	AG_WindowSetCaptionS(win, _("Timer Inspector"));
 
 	lbl = AG_LabelNew(win, AG_LABEL_HFILL, _("Ticks: ..."));
+	lblStats = AG_LabelNew(win, AG_LABEL_HFILL, _("Soft timers: ..."));
 	AG_ButtonNewInt(win, AG_BUTTON_EXCL | AG_BUTTON_STICKY, _("Pause"), &pauseFlag);
 
 	tt = AG_TreetblNew(win, AG_TREETBL_EXPAND, NULL, NULL);
@@ -109,7 +121,8 @@ AG_DEV_TimerInspector(void)
 	AG_TreetblAddCol(tt, 2, "<XXXXXXXX>", _("Ticks"));
 	AG_TreetblAddCol(tt, 3, "<XXXXXXXX>", "tSched");
 
-	to = AG_AddTimerAuto(tt, 100, RefreshTableTimeout, "%p,%p", lbl, &pauseFlag);
+	to = AG_AddTimerAuto(tt, 100, RefreshTableTimeout, "%p,%p,%p",
+	    lbl, &pauseFlag, lblStats);
 	if (to != NULL)
 		Strlcpy(to->name, "timerInspector", sizeof(to->name));
 	
@@ -65,6 +65,7 @@ extern AG_DriverClass agDriverWGL;
 extern AG_DriverClass agDriverCocoa;
 #endif
 extern AG_DriverClass agDriverDUMMY;
+extern AG_DriverClass agDriverHEADLESS;
 
 AG_Object       agDrivers;			/* Drivers VFS */
 AG_DriverClass *agDriverOps = NULL;		/* Current driver class */
@@ -93,6 +94,7 @@ AG_DriverClass *agDriverList[] = {
 	&agDriverSDLFB,
 #endif
 	&agDriverDUMMY,
+	&agDriverHEADLESS,
 	NULL
 };
 
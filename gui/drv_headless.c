@@ -0,0 +1,1824 @@
+/*
+ * Copyright (c) 2026 Julien Nadeau Carriere <vedge@csoft.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Headless framebuffer driver. Renders into an in-memory AG_Surface(3)
+ * using the generic surface routines (no display, no GPU). Rendered frames
+ * can optionally be written out to PNG files.
+ */
+
+#include <agar/core/core.h>
+#include <agar/gui/gui.h>
+#include <agar/gui/drv.h>
+#include <agar/gui/text.h>
+#include <agar/gui/window.h>
+#include <agar/gui/cursors.h>
+#include <agar/gui/gui_math.h>
+
+#include <stdlib.h>
+
+#define HEADLESS_DEFAULT_W 800
+#define HEADLESS_DEFAULT_H 600
+
+/* Blending mode (see pushBlendingMode()) */
+typedef struct ag_headless_blend {
+	AG_AlphaFn fnSrc;		/* Source factor */
+	AG_AlphaFn fnDst;		/* Destination factor */
+} AG_HeadlessBlend;
+
+typedef struct ag_driver_headless {
+	struct ag_driver_sw _inherit;	/* AG_Driver -> AG_DriverSw */
+
+	AG_Surface *_Nullable s;	/* Display surface */
+	int ownSurface;			/* Display surface allocated by us */
+	Uint nFrame;			/* Frames presented so far */
+	AG_Rect2 rUpdated;		/* Area updated in current frame */
+
+	AG_Rect *_Nullable clipRects;	/* Clipping rectangle stack */
+	Uint              nClipRects;
+	Uint nBlendModes;
+	AG_HeadlessBlend *_Nullable blendModes;	/* Blending mode stack */
+
+	Uint           nPolyInts;
+	int  *_Nullable polyInts;	/* Sorted intersections for drawPolygon */
+
+	char capture[AG_PATHNAME_MAX];	/* PNG output path (or "") */
+} AG_DriverHEADLESS;
+
+AG_DriverSwClass agDriverHEADLESS;
+
+static int nDrivers = 0;			/* Opened driver instances */
+#ifdef AG_EVENT_LOOP
+static AG_EventSink *_Nullable hlEventPrologue = NULL;
+static AG_EventSink *_Nullable hlEventEpilogue = NULL;
+#endif
+
+static void HL_DrawLineH(void *_Nonnull, int, int, int, const AG_Color *_Nonnull);
+static void HL_DrawLineV(void *_Nonnull, int, int, int, const AG_Color *_Nonnull);
+static void HL_DrawRectFilled(void *_Nonnull, const AG_Rect *_Nonnull,
+                              const AG_Color *_Nonnull);
+static void HL_DrawPolygon(void *_Nonnull, const AG_Pt *_Nonnull, Uint,
+                           const AG_Color *_Nonnull);
+static int CompareInts(const void *_Nonnull, const void *_Nonnull);
+#ifdef AG_EVENT_LOOP
+static int HL_EventPrologue(AG_EventSink *_Nonnull, AG_Event *_Nonnull);
+static int HL_EventEpilogue(AG_EventSink *_Nonnull, AG_Event *_Nonnull);
+#endif
+
+static void
+Init(void *_Nonnull obj)
+{
+	AG_DriverHEADLESS *hl = obj;
+
+	hl->s = NULL;
+	hl->ownSurface = 0;
+	hl->nFrame = 0;
+	memset(&hl->rUpdated, 0, sizeof(AG_Rect2));
+	hl->clipRects = NULL;
+	hl->nClipRects = 0;
+	hl->blendModes = NULL;
+	hl->nBlendModes = 0;
+	hl->nPolyInts = 0;
+	hl->polyInts = NULL;
+	hl->capture[0] = '\0';
+}
+
+static void
+Destroy(void *_Nonnull obj)
+{
+	AG_DriverHEADLESS *hl = obj;
+
+	if (hl->s != NULL && hl->ownSurface) {
+		AG_SurfaceFree(hl->s);
+	}
+	Free(hl->clipRects);
+	Free(hl->blendModes);
+	Free(hl->polyInts);
+}
+
+/*
+ * Return the value of an integer driver option (or def if undefined).
+ */
+static int
+GetIntOption(void *_Nonnull drv, const char *_Nonnull key, int def)
+{
+	char buf[16];
+
+	if (!AG_Defined(drv, key)) {
+		return (def);
+	}
+	AG_GetString(drv, key, buf, sizeof(buf));
+	return (buf[0] >= '0' && buf[0] <= '9') ? atoi(buf) : def;
+}
+
+/*
+ * Validate a frame capture path. It may contain at most one "%u"
+ * conversion (with optional zero-padding width), which is replaced by the
+ * frame number.
+ */
+static int
+ValidCapturePath(const char *_Nonnull path)
+{
+	const char *c;
+	int nConv = 0;
+
+	for (c = path; *c != '\0'; c++) {
+		if (*c != '%') {
+			continue;
+		}
+		if (c[1] == '%') {
+			c++;
+			continue;
+		}
+		for (c++; *c >= '0' && *c <= '9'; c++)
+			;;
+		if (*c != 'u' || ++nConv > 1)
+			return (0);
+	}
+	return (1);
+}
+
+/*
+ * Generic driver operations
+ */
+
+static int
+HL_Open(void *_Nonnull obj, const char *_Nullable spec)
+{
+	AG_Driver *drv = obj;
+	AG_DriverHEADLESS *hl = obj;
+
+	if (nDrivers != 0) {
+		AG_SetErrorS(_("Multiple headless displays are not supported"));
+		return (-1);
+	}
+	if (AG_Defined(drv, "capture")) {
+		AG_GetString(drv, "capture", hl->capture, sizeof(hl->capture));
+		if (!ValidCapturePath(hl->capture)) {
+			AG_SetError(_("Bad capture path \"%s\" "
+			              "(expecting at most one %%u)"), hl->capture);
+			return (-1);
+		}
+	}
+
+	/* Initialize the main mouse and keyboard devices. */
+	if ((drv->mouse = AG_MouseNew(hl, "Headless mouse")) == NULL ||
+	    (drv->kbd = AG_KeyboardNew(hl, "Headless keyboard")) == NULL)
+		goto fail;
+
+#ifdef AG_EVENT_LOOP
+	/*
+	 * There are no input events to wait for, so don't spin. Render the
+	 * initial frame from a prologue and subsequent frames after each
+	 * iteration of the event loop (e.g., following timer expirations).
+	 */
+	if ((hlEventPrologue = AG_AddEventPrologue(HL_EventPrologue,
+	    NULL)) == NULL ||
+	    (hlEventEpilogue = AG_AddEventEpilogue(HL_EventEpilogue,
+	    NULL)) == NULL)
+		goto fail;
+#endif
+	nDrivers = 1;
+	return (0);
+fail:
+#ifdef AG_EVENT_LOOP
+	if (hlEventPrologue != NULL) { AG_DelEventPrologue(hlEventPrologue); hlEventPrologue = NULL; }
+	if (hlEventEpilogue != NULL) { AG_DelEventEpilogue(hlEventEpilogue); hlEventEpilogue = NULL; }
+#endif
+	if (drv->kbd != NULL) { AG_ObjectDelete(drv->kbd); drv->kbd = NULL; }
+	if (drv->mouse != NULL) { AG_ObjectDelete(drv->mouse); drv->mouse = NULL; }
+	return (-1);
+}
+
+static void
+HL_Close(void *_Nonnull obj)
+{
+	AG_Driver *drv = obj;
+
+#ifdef AG_DEBUG
+	if (nDrivers != 1) { AG_FatalError("Driver close without open"); }
+#endif
+#ifdef AG_EVENT_LOOP
+	AG_DelEventPrologue(hlEventPrologue); hlEventPrologue = NULL;
+	AG_DelEventEpilogue(hlEventEpilogue); hlEventEpilogue = NULL;
+#endif
+	AG_FreeCursors(drv);
+
+	AG_ObjectDelete(drv->kbd); drv->kbd = NULL;
+	AG_ObjectDelete(drv->mouse); drv->mouse = NULL;
+
+	nDrivers = 0;
+}
+
+static int
+HL_GetDisplaySize(Uint *_Nonnull w, Uint *_Nonnull h)
+{
+	*w = HEADLESS_DEFAULT_W;
+	*h = HEADLESS_DEFAULT_H;
+	return (0);
+}
+
+static void
+HL_BeginEventProcessing(void *_Nonnull obj)
+{
+	/* Nothing to do */
+}
+
+static int
+HL_PendingEvents(void *_Nonnull obj)
+{
+	return (0);
+}
+
+static int
+HL_GetNextEvent(void *_Nullable obj, AG_DriverEvent *_Nonnull dev)
+{
+	return (0);
+}
+
+/*
+ * Process an AG_DriverEvent. The headless driver has no input source of
+ * its own, but applications may still submit resize and close events.
+ */
+static int
+HL_ProcessEvent(void *_Nullable obj, AG_DriverEvent *_Nonnull dev)
+{
+	int rv = 1;
+
+	AG_LockVFS(&agDrivers);
+
+	switch (dev->type) {
+	case AG_DRIVER_EXPOSE:
+		if (agDriverSw != NULL) {
+			agDriverSw->flags |= AG_DRIVER_SW_REDRAW;
+		}
+		break;
+	case AG_DRIVER_VIDEORESIZE:
+		if (AG_ResizeDisplay(dev->videoresize.w, dev->videoresize.h) == -1) {
+			Verbose("ResizeDisplay: %s\n", AG_GetError());
+		}
+		break;
+	case AG_DRIVER_CLOSE:
+		AG_UnlockVFS(&agDrivers);
+		AG_Terminate(0);
+		/* NOTREACHED */
+		return (rv);
+	default:
+		rv = 0;
+		break;
+	}
+
+	AG_UnlockVFS(&agDrivers);
+	return (rv);
+}
+
+static void
+HL_BeginRendering(void *_Nonnull obj)
+{
+	/* Nothing to do */
+}
+
+static void
+HL_UpdateRegion(void *_Nonnull obj, const AG_Rect *_Nonnull rRegion)
+{
+	AG_DriverHEADLESS *hl = obj;
+	AG_Rect2 r;
+
+	AG_RectToRect2(&r, rRegion);
+	AG_RectUnion2(&hl->rUpdated, &hl->rUpdated, &r);
+}
+
+static void
+HL_RenderWindow(AG_Window *_Nonnull win)
+{
+	AG_Rect rd;
+
+	AG_WidgetDraw(win);
+
+	if (win->dirty == AG_WINDOW_DIRTY_DAMAGED) {   /* Partial update */
+		AG_Rect2ToRect(&rd, &win->rDamage);
+	} else {
+		rd.x = WIDGET(win)->x;
+		rd.y = WIDGET(win)->y;
+		rd.w = WIDTH(win);
+		rd.h = HEIGHT(win);
+	}
+	HL_UpdateRegion(WIDGET(win)->drv, &rd);
+}
+
+/* Write the display surface to a PNG file (per the "capture" option). */
+static void
+CaptureFrame(AG_DriverHEADLESS *_Nonnull hl)
+{
+	char path[AG_PATHNAME_MAX];
+
+	if (strchr(hl->capture, '%') != NULL) {
+#ifdef __GNUC__
+# pragma GCC diagnostic push
+# pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#endif
+		Snprintf(path, sizeof(path), hl->capture, hl->nFrame);
+#ifdef __GNUC__
+# pragma GCC diagnostic pop
+#endif
+	} else {
+		Strlcpy(path, hl->capture, sizeof(path));
+	}
+	if (AG_SurfaceExportPNG(hl->s, path, 0) == -1)
+		Verbose("%s: %s\n", OBJECT(hl)->name, AG_GetError());
+}
+
+static void
+HL_EndRendering(void *_Nonnull obj)
+{
+	AG_DriverHEADLESS *hl = obj;
+
+#ifdef AG_DEBUG
+	if (hl->nClipRects != 1)
+		AG_FatalError("Inconsistent PushClipRect() / PopClipRect()");
+	if (hl->nBlendModes != 1)
+		AG_FatalError("Inconsistent PushBlendingMode() / PopBlendingMode()");
+#endif
+	if (hl->rUpdated.w <= 0 || hl->rUpdated.h <= 0) {
+		return;
+	}
+	if (hl->capture[0] != '\0') {
+		CaptureFrame(hl);
+	}
+	hl->nFrame++;
+	hl->rUpdated.w = 0;
+}
+
+static void
+HL_FillRect(void *_Nonnull obj, const AG_Rect *_Nonnull r,
+    const AG_Color *_Nonnull c)
+{
+	AG_DriverHEADLESS *hl = obj;
+
+	AG_FillRect(hl->s, r, c);
+}
+
+static void
+HL_UpdateTexture(void *_Nonnull obj, Uint texture, AG_Surface *_Nonnull S,
+    AG_TexCoord *_Nullable tc)
+{
+	/* No-op */
+}
+
+static void
+HL_DeleteTexture(void *_Nonnull obj, Uint texture)
+{
+	/* No-op */
+}
+
+/*
+ * Clipping and blending control (rendering context)
+ */
+
+static void
+HL_PushClipRect(void *_Nonnull obj, const AG_Rect *_Nonnull r)
+{
+	AG_DriverHEADLESS *hl = obj;
+	AG_Rect *cr;
+
+	hl->clipRects = Realloc(hl->clipRects, (hl->nClipRects+1) *
+	                                       sizeof(AG_Rect));
+	cr = &hl->clipRects[hl->nClipRects++];
+	if (!AG_RectIntersect(cr, &cr[-1], r)) {
+		cr->w = 0;
+		cr->h = 0;
+	}
+	hl->s->clipRect = *cr;
+}
+
+static void
+HL_PopClipRect(void *_Nonnull obj)
+{
+	AG_DriverHEADLESS *hl = obj;
+
+#ifdef AG_DEBUG
+	if (hl->nClipRects <= 1)
+		AG_FatalError("PopClipRect() without PushClipRect()");
+#endif
+	hl->s->clipRect = hl->clipRects[--hl->nClipRects - 1];
+}
+
+static void
+HL_PushBlendingMode(void *_Nonnull obj, AG_AlphaFn fnSrc, AG_AlphaFn fnDst)
+{
+	AG_DriverHEADLESS *hl = obj;
+	AG_HeadlessBlend *bm;
+
+	hl->blendModes = Realloc(hl->blendModes, (hl->nBlendModes+1) *
+	                                         sizeof(AG_HeadlessBlend));
+	bm = &hl->blendModes[hl->nBlendModes++];
+	bm->fnSrc = fnSrc;
+	bm->fnDst = fnDst;
+}
+
+static void
+HL_PopBlendingMode(void *_Nonnull obj)
+{
+	AG_DriverHEADLESS *hl = obj;
+
+#ifdef AG_DEBUG
+	if (hl->nBlendModes <= 1)
+		AG_FatalError("PopBlendingMode() without PushBlendingMode()");
+#endif
+	hl->nBlendModes--;
+}
+
+/* Compute a blending factor (0-255) from an AG_AlphaFn. */
+static __inline__ int
+BlendFactor(AG_AlphaFn fn, int sa, int da)
+{
+	switch (fn) {
+	case AG_ALPHA_OVERLAY:		return MIN(sa+da, 255);
+	case AG_ALPHA_ZERO:		return (0);
+	case AG_ALPHA_SRC:		return (sa);
+	case AG_ALPHA_DST:		return (da);
+	case AG_ALPHA_ONE_MINUS_DST:	return (255 - da);
+	case AG_ALPHA_ONE_MINUS_SRC:	return (255 - sa);
+	case AG_ALPHA_ONE:
+	default:			return (255);
+	}
+}
+
+/*
+ * Blend a color with the pixel at p using the given source and destination
+ * factors (dst <- src*fnSrc + dst*fnDst, as in glBlendFunc(3G)).
+ * No clipping is done.
+ */
+static void
+BlendAt(AG_Surface *_Nonnull S, Uint8 *_Nonnull p, const AG_Color *_Nonnull c,
+    AG_AlphaFn fnSrc, AG_AlphaFn fnDst)
+{
+	const int sr = AG_Hto8(c->r), sg = AG_Hto8(c->g), sb = AG_Hto8(c->b);
+	const int sa = AG_Hto8(c->a);
+	Uint8 dr,dg,db,da;
+	int fs, fd;
+
+	AG_GetColor_RGBA8(AG_SurfaceGet_At(S,p), &S->format, &dr,&dg,&db,&da);
+	fs = BlendFactor(fnSrc, sa, da);
+	fd = BlendFactor(fnDst, sa, da);
+
+	AG_SurfacePut_At(S, p, AG_MapPixel_RGBA8(&S->format,
+	    (Uint8)MIN((sr*fs + dr*fd) / 255, 255),
+	    (Uint8)MIN((sg*fs + dg*fd) / 255, 255),
+	    (Uint8)MIN((sb*fs + db*fd) / 255, 255),
+	    (Uint8)MIN((sa*fs + da*fd) / 255, 255)));
+}
+
+/*
+ * Surface operations (rendering context)
+ */
+
+/*
+ * Blit a surface to the display. Under the default blending mode (or
+ * when no blending mode was pushed) use AG_SurfaceBlit(3). Otherwise
+ * blend pixel by pixel according to the current blending mode.
+ */
+static void
+BlitToDisplay(AG_DriverHEADLESS *_Nonnull hl, const AG_Surface *_Nonnull S,
+    const AG_Rect *_Nullable rSrc, int xDst, int yDst)
+{
+	const AG_HeadlessBlend *bm = &hl->blendModes[hl->nBlendModes-1];
+	AG_Surface *D = hl->s;
+	AG_Rect rs, rd;
+	int x, y;
+
+	if (hl->nBlendModes == 1 ||
+	    (bm->fnSrc == AG_ALPHA_SRC && bm->fnDst == AG_ALPHA_ONE_MINUS_SRC)) {
+		AG_SurfaceBlit(S, rSrc, D, xDst, yDst);
+		return;
+	}
+	if (rSrc != NULL) {
+		rs = *rSrc;
+	} else {
+		rs.x = 0;
+		rs.y = 0;
+		rs.w = S->w;
+		rs.h = S->h;
+	}
+	rd.x = xDst;
+	rd.y = yDst;
+	rd.w = rs.w;
+	rd.h = rs.h;
+	if (!AG_RectIntersect(&rd, &rd, &D->clipRect))
+		return;
+
+	for (y = rd.y; y < rd.y+rd.h; y++) {
+		const int ys = rs.y + (y - yDst);
+		Uint8 *pDst;
+
+		if (ys < 0 || ys >= S->h) {
+			continue;
+		}
+		pDst = D->pixels + y*D->pitch + D->Lpadding +
+		       rd.x*D->format.BytesPerPixel;
+		for (x = rd.x; x < rd.x+rd.w; x++) {
+			const int xs = rs.x + (x - xDst);
+			AG_Color c;
+
+			if (xs >= 0 && xs < S->w) {
+				AG_GetColor(&c, AG_SurfaceGet(S, xs,ys),
+				    &S->format);
+				BlendAt(D, pDst, &c, bm->fnSrc, bm->fnDst);
+			}
+			pDst += D->format.BytesPerPixel;
+		}
+	}
+}
+
+static void
+HL_BlitSurface(void *_Nonnull obj, AG_Widget *_Nonnull wid,
+    AG_Surface *_Nonnull S, int x, int y)
+{
+	BlitToDisplay((AG_DriverHEADLESS *)obj, S, NULL, x,y);
+}
+
+static void
+HL_BlitSurfaceFrom(void *_Nonnull obj, AG_Widget *_Nonnull wid, int s,
+    const AG_Rect *_Nullable rSrc, int x, int y)
+{
+	BlitToDisplay((AG_DriverHEADLESS *)obj, wid->surfaces[s], rSrc, x,y);
+}
+
+#ifdef HAVE_OPENGL
+static void
+HL_BlitSurfaceGL(void *_Nonnull obj, AG_Widget *_Nonnull wid,
+    AG_Surface *_Nonnull S, float w, float h)
+{
+	/* Not applicable */
+}
+
+static void
+HL_BlitSurfaceFromGL(void *_Nonnull obj, AG_Widget *_Nonnull wid, int s,
+    float w, float h)
+{
+	/* Not applicable */
+}
+
+static void
+HL_BlitSurfaceFlippedGL(void *_Nonnull obj, AG_Widget *_Nonnull wid, int s,
+    float w, float h)
+{
+	/* Not applicable */
+}
+#endif /* HAVE_OPENGL */
+
+static int
+HL_RenderToSurface(void *_Nonnull obj, AG_Widget *_Nonnull wid,
+    AG_Surface *_Nonnull *_Nullable pS)
+{
+	AG_DriverHEADLESS *hl = obj;
+	AG_Surface *S;
+	AG_Rect r;
+	int visiblePrev;
+
+	S = AG_SurfaceStdRGBA(wid->w, wid->h);
+
+	AG_BeginRendering(hl);
+	visiblePrev = wid->window->visible;
+	wid->window->visible = 1;
+	AG_WindowDraw(wid->window);
+	wid->window->visible = visiblePrev;
+	AG_EndRendering(hl);
+
+	r.x = wid->rView.x1;
+	r.y = wid->rView.y1;
+	r.w = wid->w;
+	r.h = wid->h;
+	AG_SurfaceBlit(hl->s, &r, S, 0,0);
+	*pS = S;
+	return (0);
+}
+
+/*
+ * Rendering operations (rendering context)
+ */
+
+/* Write a pixel mapped with AG_MapPixel() (64-bit under AG_LARGE). */
+static __inline__ void
+PutPixel(void *_Nonnull obj, int x, int y, AG_Pixel px)
+{
+	AG_DriverHEADLESS *hl = obj;
+	AG_Surface *S = hl->s;
+
+	if (!AG_SurfaceClipped(S, x,y))
+		AG_SurfacePut(S, x,y, px);
+}
+
+static void
+HL_PutPixel(void *_Nonnull obj, int x, int y, const AG_Color *_Nonnull c)
+{
+	AG_DriverHEADLESS *hl = obj;
+
+	PutPixel(obj, x,y, AG_MapPixel(&hl->s->format, c));
+}
+
+static void
+HL_PutPixel32(void *_Nonnull obj, int x, int y, Uint32 px)
+{
+	AG_DriverHEADLESS *hl = obj;
+	AG_Surface *S = hl->s;
+
+	if (!AG_SurfaceClipped(S, x,y))
+		AG_SurfacePut32(S, x,y, px);
+}
+
+static void
+HL_PutPixelRGB8(void *_Nonnull obj, int x, int y, Uint8 r, Uint8 g, Uint8 b)
+{
+	AG_DriverHEADLESS *hl = obj;
+
+	PutPixel(obj, x,y, AG_MapPixel_RGB8(&hl->s->format, r,g,b));
+}
+
+#if AG_MODEL == AG_LARGE
+static void
+HL_PutPixel64(void *_Nonnull obj, int x, int y, Uint64 px)
+{
+	AG_Driver *drv = obj;
+	AG_DriverHEADLESS *hl = obj;
+	Uint16 r,g,b;
+
+	AG_GetColor64_RGB16(px, drv->videoFmt, &r,&g,&b);
+	PutPixel(obj, x,y, AG_MapPixel_RGB16(&hl->s->format, r,g,b));
+}
+
+static void
+HL_PutPixelRGB16(void *_Nonnull obj, int x, int y, Uint16 r, Uint16 g, Uint16 b)
+{
+	AG_DriverHEADLESS *hl = obj;
+
+	PutPixel(obj, x,y, AG_MapPixel_RGB16(&hl->s->format, r,g,b));
+}
+#endif /* AG_LARGE */
+
+static void
+HL_BlendPixel(void *_Nonnull obj, int x, int y, const AG_Color *_Nonnull c,
+    AG_AlphaFn fnSrc, AG_AlphaFn fnDst)
+{
+	AG_DriverHEADLESS *hl = obj;
+	AG_Surface *S = hl->s;
+
+	if (AG_SurfaceClipped(S, x,y)) {
+		return;
+	}
+	BlendAt(S, S->pixels + y*S->pitch + S->Lpadding +
+	    x*S->format.BytesPerPixel, c, fnSrc, fnDst);
+}
+
+static void
+HL_DrawLine(void *_Nonnull obj, int x1, int y1, int x2, int y2,
+    const AG_Color *_Nonnull C)
+{
+	AG_DriverHEADLESS *hl = obj;
+	const AG_Pixel c = AG_MapPixel(&hl->s->format, C);
+	const int dx = abs(x2-x1), sx = (x1 < x2) ? 1 : -1;
+	const int dy = -abs(y2-y1), sy = (y1 < y2) ? 1 : -1;
+	int err = dx + dy, e2;
+
+	for (;;) {
+		PutPixel(obj, x1,y1, c);
+		if (x1 == x2 && y1 == y2) {
+			break;
+		}
+		e2 = (err << 1);
+		if (e2 >= dy) { err += dy; x1 += sx; }
+		if (e2 <= dx) { err += dx; y1 += sy; }
+	}
+}
+
+static void
+HL_DrawLineBlended(void *_Nonnull obj, int x1, int y1, int x2, int y2,
+    const AG_Color *_Nonnull c, AG_AlphaFn fnSrc, AG_AlphaFn fnDst)
+{
+	const int dx = abs(x2-x1), sx = (x1 < x2) ? 1 : -1;
+	const int dy = -abs(y2-y1), sy = (y1 < y2) ? 1 : -1;
+	int err = dx + dy, e2;
+
+	for (;;) {
+		HL_BlendPixel(obj, x1,y1, c, fnSrc, fnDst);
+		if (x1 == x2 && y1 == y2) {
+			break;
+		}
+		e2 = (err << 1);
+		if (e2 >= dy) { err += dy; x1 += sx; }
+		if (e2 <= dx) { err += dx; y1 += sy; }
+	}
+}
+
+/* Draw a horizontal line from x1 to x2 inclusive. */
+static void
+HL_DrawLineH(void *_Nonnull obj, int x1, int x2, int y,
+    const AG_Color *_Nonnull C)
+{
+	AG_DriverHEADLESS *hl = obj;
+	AG_Surface *S = hl->s;
+	const AG_Rect *cr = &S->clipRect;
+	const int BytesPerPixel = S->format.BytesPerPixel;
+	Uint8 *p, *pEnd;
+	AG_Pixel c;
+
+	if (y < cr->y || y >= cr->y+cr->h) {
+		return;
+	}
+	if (x1 > x2) {
+		const int xTmp = x1;
+		x1 = x2;
+		x2 = xTmp;
+	}
+	if (x1 < cr->x)          { x1 = cr->x; }
+	if (x2 >= cr->x + cr->w) { x2 = cr->x + cr->w - 1; }
+	if (x2 < x1)
+		return;
+
+	c = AG_MapPixel(&S->format, C);
+	p = S->pixels + y*S->pitch + S->Lpadding + x1*BytesPerPixel;
+	pEnd = p + (x2-x1)*BytesPerPixel;
+	if (BytesPerPixel == 4) {
+		for (; p <= pEnd; p += 4)
+			*(Uint32 *)p = (Uint32)c;
+	} else {
+		for (; p <= pEnd; p += BytesPerPixel)
+			AG_SurfacePut_At(S, p, c);
+	}
+}
+
+/* Draw a vertical line from y1 to y2 (exclusive). */
+static void
+HL_DrawLineV(void *_Nonnull obj, int x, int y1, int y2,
+    const AG_Color *_Nonnull C)
+{
+	AG_DriverHEADLESS *hl = obj;
+	AG_Surface *S = hl->s;
+	const AG_Rect *cr = &S->clipRect;
+	Uint8 *p;
+	AG_Pixel c;
+	int y;
+
+	if (x < cr->x || x >= cr->x+cr->w) {
+		return;
+	}
+	if (y1 > y2) {
+		const int yTmp = y1;
+		y1 = y2;
+		y2 = yTmp;
+	}
+	if (y1 < cr->y)        { y1 = cr->y; }
+	if (y2 > cr->y+cr->h)  { y2 = cr->y + cr->h; }
+
+	c = AG_MapPixel(&S->format, C);
+	p = S->pixels + y1*S->pitch + S->Lpadding + x*S->format.BytesPerPixel;
+	for (y = y1; y < y2; y++) {
+		AG_SurfacePut_At(S, p, c);
+		p += S->pitch;
+	}
+}
+
+/*
+ * Draw a line of the given width as a filled quadrilateral. Fall back to
+ * a plain Bresenham line for widths of one pixel or less.
+ */
+static void
+DrawLineThick(void *_Nonnull obj, int x1, int y1, int x2, int y2,
+    const AG_Color *_Nonnull c, float width)
+{
+	const double dx = (double)(x2 - x1);
+	const double dy = (double)(y2 - y1);
+	const double len = AG_Norm2(dx,dy);
+	int nx, ny;
+	AG_Pt pts[4];
+
+	if (width <= 1.0f) {
+		HL_DrawLine(obj, x1,y1, x2,y2, c);
+		return;
+	}
+	if (len == 0.0) {				/* Single point */
+		AG_Rect r;
+
+		r.w = r.h = (int)(width + 0.5f);
+		r.x = x1 - (r.w >> 1);
+		r.y = y1 - (r.h >> 1);
+		HL_DrawRectFilled(obj, &r, c);
+		return;
+	}
+	/* Half-width normal, rounded to the nearest pixel. */
+	nx = (int)AG_Floor(-dy*width / (2.0*len) + 0.5);
+	ny = (int)AG_Floor( dx*width / (2.0*len) + 0.5);
+
+	pts[0].x = x1 + nx;  pts[0].y = y1 + ny;
+	pts[1].x = x2 + nx;  pts[1].y = y2 + ny;
+	pts[2].x = x2 - nx;  pts[2].y = y2 - ny;
+	pts[3].x = x1 - nx;  pts[3].y = y1 - ny;
+	HL_DrawPolygon(obj, pts, 4, c);
+}
+
+static void
+HL_DrawLineW(void *_Nonnull obj, int x1, int y1, int x2, int y2,
+    const AG_Color *_Nonnull c, float width)
+{
+	DrawLineThick(obj, x1,y1, x2,y2, c, width);
+}
+
+/*
+ * Draw a wide line with a 16-bit stipple pattern. As with OpenGL line
+ * stippling, bit (n % 16) of the mask (LSB first) selects whether the n-th
+ * pixel along the major axis is drawn. Each run of set bits is drawn as
+ * one wide segment.
+ */
+static void
+HL_DrawLineW_Sti16(void *_Nonnull obj, int x1, int y1, int x2, int y2,
+    const AG_Color *_Nonnull c, float width, Uint16 mask)
+{
+	const int dx = x2 - x1, adx = abs(dx);
+	const int dy = y2 - y1, ady = abs(dy);
+	const int n = (adx > ady) ? adx : ady;
+	int i, iRun = -1;
+
+	if (mask == 0xffff) {
+		DrawLineThick(obj, x1,y1, x2,y2, c, width);
+		return;
+	}
+	if (n == 0) {
+		if (mask & 1) { DrawLineThick(obj, x1,y1, x1,y1, c, width); }
+		return;
+	}
+	for (i = 0; i <= n+1; i++) {
+		const int on = (i <= n) && (mask & (1 << (i & 15)));
+
+		if (on && iRun == -1) {
+			iRun = i;
+		} else if (!on && iRun != -1) {
+			DrawLineThick(obj,
+			    x1 + dx*iRun/n,    y1 + dy*iRun/n,
+			    x1 + dx*(i-1)/n,   y1 + dy*(i-1)/n, c, width);
+			iRun = -1;
+		}
+	}
+}
+
+/* Return the x coordinate of edge a-b at row y. */
+static __inline__ int
+EdgeX(const AG_Pt *_Nonnull a, const AG_Pt *_Nonnull b, int y)
+{
+	if (a->y == b->y) {
+		return (a->x);
+	}
+	return a->x + (b->x - a->x)*(y - a->y) / (b->y - a->y);
+}
+
+static void
+HL_DrawTriangle(void *_Nonnull obj, const AG_Pt *_Nonnull v1,
+    const AG_Pt *_Nonnull v2, const AG_Pt *_Nonnull v3,
+    const AG_Color *_Nonnull c)
+{
+	const AG_Pt *p0 = v1, *p1 = v2, *p2 = v3, *pt;
+	int y;
+
+	/* Sort the three vertices by y coordinate ascending. */
+	if (p0->y > p1->y) { pt = p0; p0 = p1; p1 = pt; }
+	if (p1->y > p2->y) { pt = p1; p1 = p2; p2 = pt; }
+	if (p0->y > p1->y) { pt = p0; p0 = p1; p1 = pt; }
+
+	for (y = p0->y; y <= p2->y; y++) {
+		const int xa = EdgeX(p0, p2, y);
+		const int xb = (y < p1->y) ? EdgeX(p0, p1, y) :
+		                             EdgeX(p1, p2, y);
+
+		HL_DrawLineH(obj, xa, xb, y, c);
+	}
+}
+
+static void
+HL_DrawPolygon(void *_Nonnull obj, const AG_Pt *_Nonnull pts, Uint nPts,
+    const AG_Color *_Nonnull c)
+{
+	AG_DriverHEADLESS *hl = obj;
+	int y, x1, y1, x2, y2;
+	int miny, maxy;
+	int i, i1, i2;
+	Uint nPolyInts;
+
+	if (nPts < 3)
+		return;
+
+	/* Allocate/resize the array of intersections. */
+	if (nPts > hl->nPolyInts) {
+		hl->nPolyInts = nPts;
+		hl->polyInts = Realloc(hl->polyInts, nPts*sizeof(int));
+	}
+
+	/* Find Y maxima */
+	miny = pts[0].y;
+	maxy = miny;
+	for (i = 1; i < nPts; i++) {
+		const int vy = pts[i].y;
+
+		if (vy < miny) {
+			miny = vy;
+		} else if (vy > maxy) {
+			maxy = vy;
+		}
+	}
+
+	/* Find the intersections. */
+	for (y = miny; y <= maxy; y++) {
+		nPolyInts = 0;
+		for (i = 0; i < nPts; i++) {
+			if (i == 0) {
+				i1 = nPts - 1;
+				i2 = 0;
+			} else {
+				i1 = i - 1;
+				i2 = i;
+			}
+			y1 = pts[i1].y;
+			y2 = pts[i2].y;
+			if (y1 < y2) {
+				x1 = pts[i1].x;
+				x2 = pts[i2].x;
+			} else if (y1 > y2) {
+				x2 = pts[i1].x;
+				y2 = pts[i1].y;
+				x1 = pts[i2].x;
+				y1 = pts[i2].y;
+			} else {
+				continue;
+			}
+			if (((y >= y1) && (y < y2)) ||
+			    ((y == maxy) && (y > y1) && (y <= y2))) {
+				hl->polyInts[nPolyInts++] =
+				    (((y - y1) << 16) / (y2 - y1)) *
+				     (x2 - x1) + (x1 << 16);
+			}
+		}
+		qsort(hl->polyInts, nPolyInts, sizeof(int), CompareInts);
+
+		for (i = 0; i+1 < nPolyInts; i += 2) {
+			int xa, xb;
+
+			xa = hl->polyInts[i] + 1;
+			xa = (xa >> 16) + ((xa & 0x8000) >> 15);
+			xb = hl->polyInts[i+1] - 1;
+			xb = (xb >> 16) + ((xb & 0x8000) >> 15);
+			HL_DrawLineH(hl, xa,xb, y, c);
+		}
+	}
+}
+
+/*
+ * Draw a filled polygon with a 32x32 stipple pattern. As with OpenGL
+ * polygon stippling, the pattern is 32 rows of 4 bytes (MSB first) aligned
+ * on the display origin.
+ */
+static void
+HL_DrawPolygon_Sti32(void *_Nonnull obj, const AG_Pt *_Nonnull pts, Uint nPts,
+    const AG_Color *_Nonnull C, const Uint8 *_Nonnull stipple)
+{
+	AG_DriverHEADLESS *hl = obj;
+	AG_Surface *S = hl->s;
+	const AG_Rect *cr = &S->clipRect;
+	const AG_Pixel c = AG_MapPixel(&S->format, C);
+	int y, x1, y1, x2, y2;
+	int miny, maxy;
+	int i, i1, i2;
+	Uint nPolyInts;
+
+	if (nPts < 3)
+		return;
+
+	if (nPts > hl->nPolyInts) {
+		hl->nPolyInts = nPts;
+		hl->polyInts = Realloc(hl->polyInts, nPts*sizeof(int));
+	}
+	miny = pts[0].y;
+	maxy = miny;
+	for (i = 1; i < nPts; i++) {
+		const int vy = pts[i].y;
+
+		if (vy < miny) {
+			miny = vy;
+		} else if (vy > maxy) {
+			maxy = vy;
+		}
+	}
+	if (miny < cr->y)            { miny = cr->y; }
+	if (maxy >= cr->y + cr->h)   { maxy = cr->y + cr->h - 1; }
+
+	/* Same scanline conversion as HL_DrawPolygon(). */
+	for (y = miny; y <= maxy; y++) {
+		const Uint8 *row = &stipple[(y & 31) << 2];
+
+		nPolyInts = 0;
+		for (i = 0; i < nPts; i++) {
+			if (i == 0) {
+				i1 = nPts - 1;
+				i2 = 0;
+			} else {
+				i1 = i - 1;
+				i2 = i;
+			}
+			y1 = pts[i1].y;
+			y2 = pts[i2].y;
+			if (y1 < y2) {
+				x1 = pts[i1].x;
+				x2 = pts[i2].x;
+			} else if (y1 > y2) {
+				x2 = pts[i1].x;
+				y2 = pts[i1].y;
+				x1 = pts[i2].x;
+				y1 = pts[i2].y;
+			} else {
+				continue;
+			}
+			if (((y >= y1) && (y < y2)) ||
+			    ((y == maxy) && (y > y1) && (y <= y2))) {
+				hl->polyInts[nPolyInts++] =
+				    (((y - y1) << 16) / (y2 - y1)) *
+				     (x2 - x1) + (x1 << 16);
+			}
+		}
+		qsort(hl->polyInts, nPolyInts, sizeof(int), CompareInts);
+
+		for (i = 0; i+1 < nPolyInts; i += 2) {
+			int xa, xb, x;
+
+			xa = hl->polyInts[i] + 1;
+			xa = (xa >> 16) + ((xa & 0x8000) >> 15);
+			xb = hl->polyInts[i+1] - 1;
+			xb = (xb >> 16) + ((xb & 0x8000) >> 15);
+			if (xa < cr->x)          { xa = cr->x; }
+			if (xb >= cr->x + cr->w) { xb = cr->x + cr->w - 1; }
+			for (x = xa; x <= xb; x++) {
+				if (row[(x & 31) >> 3] & (0x80 >> (x & 7)))
+					AG_SurfacePut(S, x,y, c);
+			}
+		}
+	}
+}
+
+static int
+CompareInts(const void *_Nonnull p1, const void *_Nonnull p2)
+{
+	return (*(const int *)p1 - *(const int *)p2);
+}
+
+static void
+HL_DrawArrow(void *_Nonnull obj, Uint8 angle, int x0, int y0, int h,
+    const AG_Color *_Nonnull C)
+{
+	AG_DriverHEADLESS *hl = obj;
+	const AG_Pixel c = AG_MapPixel(&hl->s->format, C);
+	const int a1 = -(h >> 1) + 1;
+	const int a2 = a1 + h-2;
+	int i, j, k;
+
+#ifdef AG_DEBUG
+	if (angle >= 4) { AG_FatalError("Bad angle"); }
+#endif
+	/*
+	 * Fill the triangle one row (or column) at a time, widening by one
+	 * pixel on each side as we move away from the tip.
+	 */
+	for (i = a1, k = 0; i < a2; i++, k++) {
+		for (j = -k; j <= k; j++) {
+			switch (angle) {
+			case 0:					/* Up */
+				PutPixel(obj, x0+j, y0+i, c);
+				break;
+			case 1:					/* Right */
+				PutPixel(obj, x0+a2-k, y0+j, c);
+				break;
+			case 2:					/* Down */
+				PutPixel(obj, x0+j, y0+a2-k, c);
+				break;
+			case 3:					/* Left */
+				PutPixel(obj, x0+i, y0+j, c);
+				break;
+			}
+		}
+	}
+}
+
+static void
+HL_DrawBoxRoundedTop(void *_Nonnull obj, const AG_Rect *_Nonnull r, int z,
+    int rad, const AG_Color *_Nonnull c1, const AG_Color *_Nonnull c2,
+    const AG_Color *_Nonnull c3)
+{
+	AG_DriverHEADLESS *hl = obj;
+	const AG_PixelFormat *pf = &hl->s->format;
+	AG_Rect rd;
+	int rx = r->x;
+	int ry = r->y;
+	int rw = r->w;
+	int rh = r->h;
+	int x2 = rx + rad;
+	int x3 = rx - rad + rw - 1;
+	int y2 = ry + rad;
+	int v, e, u;
+	int x, y, i;
+	AG_Pixel c[3];
+
+	c[0] = AG_MapPixel(pf, c1);
+	c[1] = AG_MapPixel(pf, c2);
+	c[2] = AG_MapPixel(pf, c3);
+
+	rd.x = x2;					/* Center rect */
+	rd.y = ry;
+	rd.w = rw - (rad << 1);
+	rd.h = rh;
+	HL_DrawRectFilled(obj, &rd, c1);
+	rd.x = rx;					/* Left rect */
+	rd.y = y2;
+	rd.w = rad;
+	rd.h = rh - rad;
+	HL_DrawRectFilled(obj, &rd, c1);
+	rd.x = rx + rw - rad;				/* Right rect */
+	HL_DrawRectFilled(obj, &rd, c1);
+
+	/* Top, left and right lines */
+	HL_DrawLineH(obj, x2,      rx+rw-rad, ry,    c1);
+	HL_DrawLineV(obj, rx,      y2,        ry+rh, c2);
+	HL_DrawLineV(obj, rx+rw-1, y2,        ry+rh, c3);
+
+	/* Top left and top right rounded edges */
+	v = (rad << 1) - 1;
+	e = 0;
+	u = 0;
+	x = 0;
+	y = rad;
+
+	while (x <= y) {
+		PutPixel(obj, x2-x, y2-y, c[1]);
+		PutPixel(obj, x2-y, y2-x, c[1]);
+		PutPixel(obj, x3+x, y2-y, c[2]);
+		PutPixel(obj, x3+y, y2-x, c[2]);
+		for (i = 0; i < x; i++) {
+			PutPixel(obj, x2-i, y2-y, c[0]);
+			PutPixel(obj, x3+i, y2-y, c[0]);
+		}
+		for (i = 0; i < y; i++) {
+			PutPixel(obj, x2-i, y2-x, c[0]);
+			PutPixel(obj, x3+i, y2-x, c[0]);
+		}
+		e += u;
+		u += 2;
+		if (v < (e << 1)) {
+			y--;
+			e -= v;
+			v -= 2;
+		}
+		x++;
+	}
+}
+
+static void
+HL_DrawBoxRounded(void *_Nonnull obj, const AG_Rect *_Nonnull r, int z,
+    int rad, const AG_Color *_Nonnull c1, const AG_Color *_Nonnull c2,
+    const AG_Color *_Nonnull c3)
+{
+	AG_DriverHEADLESS *hl = obj;
+	const AG_PixelFormat *pf = &hl->s->format;
+	AG_Rect rd;
+	AG_Pixel c[3];
+	int v, e, u;
+	int x, y, i;
+	int rx = r->x, ry = r->y;
+	int rw = r->w, rh = r->h;
+	int w1 = rw - 1;
+	int x2, y2, x3, y3, rad2, rad_2;
+
+	if (rw < 4 || rh < 4) {
+		return;
+	}
+	if ((rad << 1) > rw || (rad << 1) > rh) {
+		rad = MIN(rw >> 1, rh >> 1);
+	}
+	x2 = rx + rad;
+	y2 = ry + rad;
+	x3 = rx - rad + w1;
+	y3 = ry + rh - rad;
+	rad2 = (rad << 1);
+	rad_2 = (rad >> 1);
+
+	c[0] = AG_MapPixel(pf, c1);
+	c[1] = AG_MapPixel(pf, c2);
+	c[2] = AG_MapPixel(pf, c3);
+
+	rd.x = rx + rad;					/* Center */
+	rd.y = ry;
+	rd.w = rw - rad2;
+	rd.h = rh;
+	HL_DrawRectFilled(obj, &rd, c1);
+	rd.x = rx;						/* Left */
+	rd.y = ry + rad;
+	rd.w = rad;
+	rd.h = rh - rad2;
+	HL_DrawRectFilled(obj, &rd, c1);
+	rd.x = rx + rw - rad;					/* Right */
+	HL_DrawRectFilled(obj, &rd, c1);
+
+	/* Rounded edges */
+	v = (rad << 1) - 1;
+	e = 0;
+	u = 0;
+	x = 0;
+	y = rad;
+	while (x <= y) {
+		PutPixel(obj, x2-x, y2-y, c[1]);
+		PutPixel(obj, x2-y, y2-x, c[1]);
+		PutPixel(obj, x3+x, y2-y, c[2]);
+		PutPixel(obj, x3+y, y2-x, c[2]);
+
+		PutPixel(obj, x2-x, y3+y, c[1]);
+		PutPixel(obj, x2-y, y3+x, c[1]);
+		PutPixel(obj, x3+x, y3+y, c[2]);
+		PutPixel(obj, x3+y, y3+x, c[2]);
+
+		for (i = 0; i < x; i++) {
+			PutPixel(obj, x2-i, y2-y, c[0]);
+			PutPixel(obj, x3+i, y2-y, c[0]);
+			PutPixel(obj, x2-i, y3+y, c[0]);
+			PutPixel(obj, x3+i, y3+y, c[0]);
+		}
+		for (i = 0; i < y; i++) {
+			PutPixel(obj, x2-i, y2-x, c[0]);
+			PutPixel(obj, x3+i, y2-x, c[0]);
+			PutPixel(obj, x2-i, y3+x, c[0]);
+			PutPixel(obj, x3+i, y3+x, c[0]);
+		}
+		e += u;
+		u += 2;
+		if (v < (e << 1)) {
+			y--;
+			e -= v;
+			v -= 2;
+		}
+		x++;
+	}
+
+	/* Contour lines */
+	HL_DrawLineH(obj, rx+rad_2, rx+rw-rad_2, ry,      c2);
+	HL_DrawLineH(obj, rx+rad_2, rx+rw-rad_2, ry+rh-1, c3);
+	HL_DrawLineV(obj, rx,       y2,          y3,      c2);
+	HL_DrawLineV(obj, rx+w1,    y2,          y3,      c3);
+}
+
+static void
+HL_DrawCircle(void *_Nonnull obj, int x1, int y1, int radius,
+    const AG_Color *_Nonnull C)
+{
+	AG_DriverHEADLESS *hl = obj;
+	const AG_Pixel c = AG_MapPixel(&hl->s->format, C);
+	int v = (radius << 1) - 1;
+	int e = 0, u = 1;
+	int x = 0, y = radius;
+
+	while (x < y) {
+		PutPixel(obj, x1+x, y1+y, c);
+		PutPixel(obj, x1+x, y1-y, c);
+		PutPixel(obj, x1-x, y1+y, c);
+		PutPixel(obj, x1-x, y1-y, c);
+		e += u;
+		u += 2;
+		if (v < (e << 1)) {
+			y--;
+			e -= v;
+			v -= 2;
+		}
+		x++;
+		PutPixel(obj, x1+y, y1+x, c);
+		PutPixel(obj, x1+y, y1-x, c);
+		PutPixel(obj, x1-y, y1+x, c);
+		PutPixel(obj, x1-y, y1-x, c);
+	}
+	PutPixel(obj, x1-radius, y1, c);
+	PutPixel(obj, x1+radius, y1, c);
+}
+
+static void
+HL_DrawCircleFilled(void *_Nonnull obj, int x1, int y1, int radius,
+    const AG_Color *_Nonnull c)
+{
+	int v = (radius << 1) - 1;
+	int e = 0, u = 1;
+	int x = 0, y = radius;
+
+	while (x < y) {
+		HL_DrawLineV(obj, x1+x, y1+y, y1-y, c);
+		HL_DrawLineV(obj, x1-x, y1+y, y1-y, c);
+
+		e += u;
+		u += 2;
+		if (v < (e << 1)) {
+			y--;
+			e -= v;
+			v -= 2;
+		}
+		x++;
+
+		HL_DrawLineV(obj, x1+y, y1+x, y1-x, c);
+		HL_DrawLineV(obj, x1-y, y1+x, y1-x, c);
+	}
+}
+
+static void
+HL_DrawRectFilled(void *_Nonnull obj, const AG_Rect *_Nonnull r,
+    const AG_Color *_Nonnull c)
+{
+	AG_DriverHEADLESS *hl = obj;
+
+	AG_FillRect(hl->s, r, c);
+}
+
+static void
+HL_DrawRectBlended(void *_Nonnull obj, const AG_Rect *_Nonnull r,
+    const AG_Color *_Nonnull c, AG_AlphaFn fnSrc, AG_AlphaFn fnDst)
+{
+	AG_DriverHEADLESS *hl = obj;
+	AG_Surface *S = hl->s;
+	const int BytesPerPixel = S->format.BytesPerPixel;
+	AG_Rect rd;
+	int x, y;
+
+	if (!AG_RectIntersect(&rd, r, &S->clipRect)) {
+		return;
+	}
+	for (y = rd.y; y < rd.y+rd.h; y++) {
+		Uint8 *p = S->pixels + y*S->pitch + S->Lpadding +
+		           rd.x*BytesPerPixel;
+
+		for (x = 0; x < rd.w; x++) {
+			BlendAt(S, p, c, fnSrc, fnDst);
+			p += BytesPerPixel;
+		}
+	}
+}
+
+static void
+HL_DrawRectDithered(void *_Nonnull obj, const AG_Rect *_Nonnull r,
+    const AG_Color *_Nonnull C)
+{
+	AG_DriverHEADLESS *hl = obj;
+	const AG_Pixel c = AG_MapPixel(&hl->s->format, C);
+	const int x2 = r->x + r->w - 2;
+	const int y2 = r->y + r->h - 2;
+	int x, y, flag = 0;
+
+	for (y = r->y; y < y2; y++) {
+		flag = !flag;
+		for (x = r->x+1+flag; x < x2; x+=2)
+			PutPixel(obj, x,y, c);
+	}
+}
+
+static void
+HL_UpdateGlyph(void *_Nonnull obj, AG_Glyph *_Nonnull G)
+{
+	/* Nothing to do */
+}
+
+static void
+HL_DrawGlyph(void *_Nonnull obj, const AG_Glyph *_Nonnull G, int x, int y)
+{
+	BlitToDisplay((AG_DriverHEADLESS *)obj, G->su, NULL, x,y);
+}
+
+/*
+ * Cursor operations. Cursors are tracked but never drawn.
+ */
+
+static AG_Cursor *
+HL_CreateCursor(void *_Nonnull obj, Uint w, Uint h, const Uint8 *_Nonnull data,
+    const Uint8 *_Nonnull mask, int xHot, int yHot)
+{
+	AG_Cursor *ac;
+	const Uint size = w*h;
+
+	if ((ac = TryMalloc(sizeof(AG_Cursor))) == NULL) {
+		return (NULL);
+	}
+	AG_CursorInit(ac);
+	if ((ac->data = TryMalloc(size)) == NULL) {
+		goto fail;
+	}
+	if ((ac->mask = TryMalloc(size)) == NULL) {
+		free(ac->data);
+		goto fail;
+	}
+	memcpy(ac->data, data, size);
+	memcpy(ac->mask, mask, size);
+	ac->w = w;
+	ac->h = h;
+	ac->xHot = xHot;
+	ac->yHot = yHot;
+	return (ac);
+fail:
+	free(ac);
+	return (NULL);
+}
+
+static void
+HL_FreeCursor(void *_Nonnull obj, AG_Cursor *_Nonnull ac)
+{
+	AG_Driver *drv = obj;
+
+	if (ac == drv->activeCursor) {
+		drv->activeCursor = NULL;
+	}
+	Free(ac->data);
+	Free(ac->mask);
+	free(ac);
+}
+
+static int
+HL_SetCursor(void *_Nonnull obj, AG_Cursor *_Nonnull ac)
+{
+	AG_Driver *drv = obj;
+
+	drv->activeCursor = ac;
+	return (0);
+}
+
+static void
+HL_UnsetCursor(void *_Nonnull obj)
+{
+	AG_Driver *drv = obj;
+
+	drv->activeCursor = TAILQ_FIRST(&drv->cursors);
+}
+
+static int
+HL_GetCursorVisibility(void *_Nonnull obj)
+{
+	return (0);
+}
+
+static void
+HL_SetCursorVisibility(void *_Nonnull obj, int flag)
+{
+	/* Not applicable */
+}
+
+static void
+InitDefaultCursor(AG_Driver *_Nonnull drv)
+{
+	AG_Cursor *ac;
+
+	ac = Malloc(sizeof(AG_Cursor));
+	AG_CursorInit(ac);
+	TAILQ_INSERT_HEAD(&drv->cursors, ac, cursors);
+	drv->nCursors++;
+	drv->activeCursor = ac;
+}
+
+/*
+ * Single-display specific operations.
+ */
+
+/* Initialize the clipping rectangle and blending mode stacks. */
+static int
+InitStacks(AG_DriverHEADLESS *_Nonnull hl)
+{
+	AG_Rect *cr;
+
+	if ((hl->clipRects = TryMalloc(sizeof(AG_Rect))) == NULL ||
+	    (hl->blendModes = TryMalloc(sizeof(AG_HeadlessBlend))) == NULL) {
+		return (-1);
+	}
+	cr = &hl->clipRects[0];			/* Covers the whole view */
+	cr->x = 0;
+	cr->y = 0;
+	cr->w = hl->s->w;
+	cr->h = hl->s->h;
+	hl->nClipRects = 1;
+	hl->s->clipRect = *cr;
+
+	hl->blendModes[0].fnSrc = AG_ALPHA_SRC;
+	hl->blendModes[0].fnDst = AG_ALPHA_ONE_MINUS_SRC;
+	hl->nBlendModes = 1;
+	return (0);
+}
+
+/* Use S as the display surface. */
+static int
+SetDisplaySurface(AG_DriverHEADLESS *_Nonnull hl, AG_Surface *_Nonnull S,
+    int ownSurface)
+{
+	AG_Driver *drv = AGDRIVER(hl);
+	AG_DriverSw *dsw = AGDRIVERSW(hl);
+
+	if (S->format.mode != AG_SURFACE_PACKED ||
+	    S->format.BitsPerPixel < 16 || S->format.BitsPerPixel > 32) {
+		AG_SetErrorS(_("Display surface must be packed 16- to 32-bpp"));
+		return (-1);
+	}
+	if (hl->s != NULL && hl->ownSurface) {
+		AG_SurfaceFree(hl->s);
+	}
+	hl->s = S;
+	hl->ownSurface = ownSurface;
+
+	if (drv->videoFmt != NULL) {
+		AG_PixelFormatFree(drv->videoFmt);
+		free(drv->videoFmt);
+	}
+	if ((drv->videoFmt = AG_PixelFormatDup(&S->format)) == NULL) {
+		return (-1);
+	}
+	dsw->w = S->w;
+	dsw->h = S->h;
+	dsw->depth = (Uint)S->format.BitsPerPixel;
+
+	if (hl->clipRects != NULL) {		/* Update clipping rectangle 0 */
+		hl->clipRects[0].w = S->w;
+		hl->clipRects[0].h = S->h;
+		S->clipRect = hl->clipRects[0];
+	}
+	return (0);
+}
+
+/* Allocate a display surface of the given size and depth. */
+static AG_Surface *_Nonnull
+NewDisplaySurface(Uint w, Uint h, int depth)
+{
+	switch (depth) {
+	case 16:
+		return AG_SurfaceRGB(w,h, 16, 0, 0xf800, 0x07e0, 0x001f);
+	case 24:
+	default:
+#if AG_BYTEORDER == AG_BIG_ENDIAN
+		return AG_SurfaceRGB(w,h, (depth == 24) ? 24 : 32, 0,
+		    0xff0000, 0x00ff00, 0x0000ff);
+#else
+		return AG_SurfaceRGB(w,h, (depth == 24) ? 24 : 32, 0,
+		    0x0000ff, 0x00ff00, 0xff0000);
+#endif
+	}
+}
+
+/* Apply the options shared by openVideo() and openVideoContext(). */
+static void
+ApplyOptions(AG_DriverHEADLESS *_Nonnull hl, Uint flags)
+{
+	AG_Driver *drv = AGDRIVER(hl);
+	AG_DriverSw *dsw = AGDRIVERSW(hl);
+
+	if (flags & AG_VIDEO_OVERLAY)
+		dsw->flags |= AG_DRIVER_SW_OVERLAY;
+	if ((flags & AG_VIDEO_BGPOPUPMENU) || !AG_Defined(drv, "!bgPopup"))
+		dsw->flags |= AG_DRIVER_SW_BGPOPUP;
+
+	if (AG_Defined(drv, "bgColor"))
+		AG_ColorFromString(&dsw->bgColor, AG_GetStringP(drv,"bgColor"),
+		    NULL);
+}
+
+static int
+HL_OpenVideo(void *_Nonnull obj, Uint w, Uint h, int depth, Uint flags)
+{
+	AG_Driver *drv = obj;
+	AG_DriverSw *dsw = obj;
+	AG_DriverHEADLESS *hl = obj;
+
+	if (w == 0) { w = (Uint)GetIntOption(drv, "width", HEADLESS_DEFAULT_W); }
+	if (h == 0) { h = (Uint)GetIntOption(drv, "height", HEADLESS_DEFAULT_H); }
+	if (depth == 0) { depth = GetIntOption(drv, "depth", 32); }
+	if (w < 1 || h < 1) {
+		AG_SetError(_("Bad display size %ux%u"), w, h);
+		return (-1);
+	}
+	ApplyOptions(hl, flags);
+
+	if (SetDisplaySurface(hl, NewDisplaySurface(w, h, depth), 1) == -1 ||
+	    InitStacks(hl) == -1)
+		return (-1);
+
+	Verbose(_("%s: New %ux%u display (%d-bpp)\n"), OBJECT(hl)->name,
+	    w, h, (int)dsw->depth);
+
+	InitDefaultCursor(drv);
+	AG_InitStockCursors(drv);
+
+	AG_FillRect(hl->s, NULL, &dsw->bgColor);
+	return (0);
+}
+
+/* Render to an existing AG_Surface(3) provided by the application. */
+static int
+HL_OpenVideoContext(void *_Nonnull obj, void *_Nonnull ctx, Uint flags)
+{
+	AG_Driver *drv = obj;
+	AG_DriverHEADLESS *hl = obj;
+
+	ApplyOptions(hl, flags);
+
+	if (SetDisplaySurface(hl, (AG_Surface *)ctx, 0) == -1 ||
+	    InitStacks(hl) == -1)
+		return (-1);
+
+	InitDefaultCursor(drv);
+	AG_InitStockCursors(drv);
+	return (0);
+}
+
+static int
+HL_SetVideoContext(void *_Nonnull obj, void *_Nonnull ctx)
+{
+	return SetDisplaySurface((AG_DriverHEADLESS *)obj, (AG_Surface *)ctx, 0);
+}
+
+static void
+HL_CloseVideo(void *_Nonnull obj)
+{
+	/* Nothing to do */
+}
+
+static int
+HL_VideoResize(void *_Nonnull obj, Uint w, Uint h)
+{
+	AG_DriverSw *dsw = obj;
+	AG_DriverHEADLESS *hl = obj;
+
+	if (!hl->ownSurface) {
+		AG_SetErrorS(_("Cannot resize an application-provided surface"));
+		return (-1);
+	}
+	if (AG_SurfaceResize(hl->s, w, h) == -1) {
+		return (-1);
+	}
+	dsw->w = w;
+	dsw->h = h;
+	hl->clipRects[0].w = w;
+	hl->clipRects[0].h = h;
+	hl->s->clipRect = hl->clipRects[0];
+
+	if (!(dsw->flags & AG_DRIVER_SW_OVERLAY)) {
+		AG_FillRect(hl->s, NULL, &dsw->bgColor);
+	}
+	return (0);
+}
+
+static AG_Surface *
+HL_VideoCapture(void *_Nonnull obj)
+{
+	AG_DriverHEADLESS *hl = obj;
+
+	return AG_SurfaceDup(hl->s);
+}
+
+static void
+HL_VideoClear(void *_Nonnull obj, const AG_Color *_Nonnull c)
+{
+	AG_DriverHEADLESS *hl = obj;
+
+	AG_FillRect(hl->s, NULL, c);
+}
+
+#ifdef AG_EVENT_LOOP
+/* Event loop prologue: render the initial frame in full. */
+static int
+HL_EventPrologue(AG_EventSink *_Nonnull es, AG_Event *_Nonnull event)
+{
+	if (agDriverSw != NULL) {
+		agDriverSw->flags |= AG_DRIVER_SW_REDRAW;
+	}
+	AG_WindowDrawQueued();
+	return (0);
+}
+
+/*
+ * Event loop epilogue: render any queued window and process any queued
+ * window operation.
+ */
+static int
+HL_EventEpilogue(AG_EventSink *_Nonnull es, AG_Event *_Nonnull event)
+{
+	AG_WindowDrawQueued();
+	AG_WindowProcessQueued();
+	return (0);
+}
+#endif /* AG_EVENT_LOOP */
+
+AG_DriverSwClass agDriverHEADLESS = {
+	{
+		{
+			"AG_Driver:AG_DriverSw:AG_DriverHEADLESS",
+			sizeof(AG_DriverHEADLESS),
+			{ 1,7, AGC_DRIVER_HEADLESS, 0xE024 },
+			Init,
+			NULL,		/* reset */
+			Destroy,
+			NULL,		/* load */
+			NULL,		/* save */
+			NULL,		/* edit */
+		},
+		"headless",
+		AG_FRAMEBUFFER,
+		AG_WM_SINGLE,
+		0,
+		HL_Open,
+		HL_Close,
+		HL_GetDisplaySize,
+		HL_BeginEventProcessing,
+		HL_PendingEvents,
+		HL_GetNextEvent,
+		HL_ProcessEvent,
+		NULL,				/* genericEventLoop */
+		NULL,				/* endEventProcessing */
+		NULL,				/* terminate */
+		HL_BeginRendering,
+		HL_RenderWindow,
+		HL_EndRendering,
+		HL_FillRect,
+		HL_UpdateRegion,
+		NULL,				/* uploadTexture */
+		HL_UpdateTexture,
+		HL_DeleteTexture,
+		NULL,				/* setRefreshRate */
+		HL_PushClipRect,
+		HL_PopClipRect,
+		HL_PushBlendingMode,
+		HL_PopBlendingMode,
+		HL_CreateCursor,
+		HL_FreeCursor,
+		HL_SetCursor,
+		HL_UnsetCursor,
+		HL_GetCursorVisibility,
+		HL_SetCursorVisibility,
+		HL_BlitSurface,
+		HL_BlitSurfaceFrom,
+#ifdef HAVE_OPENGL
+		HL_BlitSurfaceGL,
+		HL_BlitSurfaceFromGL,
+		HL_BlitSurfaceFlippedGL,
+#endif
+		NULL,				/* backupSurfaces */
+		NULL,				/* restoreSurfaces */
+		HL_RenderToSurface,
+		HL_PutPixel,
+		HL_PutPixel32,
+		HL_PutPixelRGB8,
+#if AG_MODEL == AG_LARGE
+		HL_PutPixel64,
+		HL_PutPixelRGB16,
+#endif
+		HL_BlendPixel,
+		HL_DrawLine,
+		HL_DrawLineH,
+		HL_DrawLineV,
+		HL_DrawLineBlended,
+		HL_DrawLineW,
+		HL_DrawLineW_Sti16,
+		HL_DrawTriangle,
+		HL_DrawPolygon,
+		HL_DrawPolygon_Sti32,
+		HL_DrawArrow,
+		HL_DrawBoxRounded,
+		HL_DrawBoxRoundedTop,
+		HL_DrawCircle,
+		HL_DrawCircleFilled,
+		HL_DrawRectFilled,
+		HL_DrawRectBlended,
+		HL_DrawRectDithered,
+		HL_UpdateGlyph,
+		HL_DrawGlyph,
+		NULL,				/* deleteList */
+		NULL,				/* getClipboardText */
+		NULL,				/* setClipboardText */
+		NULL				/* setMouseAutoCapture */
+	},
+	0,
+	HL_OpenVideo,
+	HL_OpenVideoContext,
+	HL_SetVideoContext,
+	HL_CloseVideo,
+	HL_VideoResize,
+	HL_VideoCapture,
+	HL_VideoClear
+};
@@ -182,11 +182,14 @@ SDL2FB_RenderWindow(struct ag_window *_Nonnull win)
 
 	AG_WidgetDraw(win);
 
-	rd.x = WIDGET(win)->x;
-	rd.y = WIDGET(win)->y;
-	rd.w = WIDTH(win);
-	rd.h = HEIGHT(win);
-
+	if (win->dirty == AG_WINDOW_DIRTY_DAMAGED) {   /* Partial update */
+		AG_Rect2ToRect(&rd, &win->rDamage);
+	} else {
+		rd.x = WIDGET(win)->x;
+		rd.y = WIDGET(win)->y;
+		rd.w = WIDTH(win);
+		rd.h = HEIGHT(win);
+	}
 	SDL2FB_UpdateRegion(WIDGET(win)->drv, &rd);
 }
 
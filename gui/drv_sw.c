@@ -60,6 +60,7 @@ Init(void *_Nonnull obj)
 	dsw->windowIconWidth = 32;
 	dsw->windowIconHeight = 32;
 	dsw->bgPopup = NULL;
+	memset(&dsw->rDamage, 0, sizeof(AG_Rect2));
 
 	AG_SetString(dsw, "bgColor", "rgb(0,0,0)");
 }
@@ -248,6 +249,7 @@ WM_Move(AG_Window *_Nonnull win, int xRel, int yRel)
 	AG_DriverClass *dc = AGDRIVER_CLASS(dsw);
 	AG_Rect rPrev, rNew;
 	AG_Rect a, b;
+	AG_Rect2 r2;
 
 	rPrev.x = WIDGET(win)->x;
 	rPrev.y = WIDGET(win)->y;
@@ -292,11 +294,15 @@ WM_Move(AG_Window *_Nonnull win, int xRel, int yRel)
 			AGDRIVER_CLASS(dsw)->fillRect(dsw, &a, &dsw->bgColor);
 			if (AGDRIVER_CLASS(dsw)->updateRegion != NULL)
 				AGDRIVER_CLASS(dsw)->updateRegion(dsw, &a);
+			AG_RectToRect2(&r2, &a);
+			AG_RectUnion2(&dsw->rDamage, &dsw->rDamage, &r2);
 		}
 		if (b.w > 0) {
 			AGDRIVER_CLASS(dsw)->fillRect(dsw, &b, &dsw->bgColor);
 			if (AGDRIVER_CLASS(dsw)->updateRegion != NULL)
 				AGDRIVER_CLASS(dsw)->updateRegion(dsw, &b);
+			AG_RectToRect2(&r2, &b);
+			AG_RectUnion2(&dsw->rDamage, &dsw->rDamage, &r2);
 		}
 	}
 
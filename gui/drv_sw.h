@@ -75,6 +75,7 @@ typedef struct ag_driver_sw {
 	AG_COLOR_PADDING(_pad);
 	Uint rLast;			/* Refresh rate timestamp */
 	struct ag_menu *_Nullable bgPopup;	/* Background popup menu */
+	AG_Rect2 rDamage;		/* Exposed region needing redraw */
 } AG_DriverSw;
 
 
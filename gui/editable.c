@@ -64,55 +64,350 @@ static Uint32 AutocompleteTimeout(AG_Timer *_Nonnull, AG_Event *_Nonnull);
 /* #define DEBUG_CLIPBOARD */
 /* #define DEBUG_UNDO */
 
+#if AG_MODEL != AG_SMALL
+# define STRING_REVISION(V) (V)->revision
+#else
+# define STRING_REVISION(V) 0
+#endif
+
 /*
- * Return a new working buffer. The variable is returned locked; the caller
- * should invoke ReleaseBuffer() after use.
+ * Compare the bound text s (in the given encoding) against the working
+ * buffer, without making a copy of either. Return 1 if they match.
  */
-static __inline__ AG_EditableBuffer *_Nullable
-GetBuffer(AG_Editable *_Nonnull ed)
+static int
+SourceMatches(const AG_Editable *_Nonnull ed, const char *_Nonnull encoding,
+    const char *_Nullable s)
 {
-	AG_EditableBuffer *buf;
+	const AG_EditableBuffer *buf = &ed->sBuf;
+#ifdef AG_UNICODE
+	const AG_Char *c;
+#endif
+
+	if (s == NULL) {
+		return (buf->len == 0);
+	}
+#ifdef AG_UNICODE
+	if (strcmp(encoding, "UTF-8") == 0) {
+		static const Uint8 lead[7] = { 0, 0, 0xc0, 0xe0, 0xf0, 0xf8, 0xfc };
+		char ch[6];
+		int i, n;
+
+		for (c = buf->s; *c != '\0'; c++) {
+			AG_Char uch = *c;
 
-	if (ed->flags & AG_EDITABLE_EXCL) {
-		buf = &ed->sBuf;
+			if (uch < 0x80) {
+				if (*s++ != (char)uch) {
+					return (0);
+				}
+				continue;
+			}
+			if ((n = AG_CharLengthUTF8FromUCS4(uch)) == -1) {
+				return (0);
+			}
+			for (i = n-1; i > 0; i--) {
+				ch[i] = (char)((uch & 0x3f) | 0x80);
+				uch >>= 6;
+			}
+			ch[0] = (char)(uch | lead[n]);
+			for (i = 0; i < n; i++) {
+				if (s[i] != ch[i])		/* Stops at NUL */
+					return (0);
+			}
+			s += n;
+		}
+		return (*s == '\0');
+	} else if (strcmp(encoding, "US-ASCII") == 0) {
+		for (c = buf->s; *c != '\0'; c++) {
+			if (*s++ != (char)*c)
+				return (0);
+		}
+		return (*s == '\0');
 	} else {
-		if ((buf = TryMalloc(sizeof(AG_EditableBuffer))) == NULL) {
-			return (NULL);
+		AG_Char *ucs;
+		AG_Size len;
+		int rv;
+
+		if ((ucs = AG_ImportUnicode(encoding, s, &len, NULL)) == NULL) {
+			return (0);
 		}
-		buf->s = NULL;
-		buf->len = 0;
-		buf->maxLen = 0;
+		rv = (len == buf->len &&
+		      memcmp(ucs, buf->s, len*sizeof(AG_Char)) == 0);
+		free(ucs);
+		return (rv);
+	}
+#else
+	return (strcmp((const char *)buf->s, s) == 0);
+#endif
+}
+
+/*
+ * Return 1 if the bound text has not changed since it was last synchronized
+ * with the working buffer, as indicated by its revision. Since the text may
+ * also be written to directly (without updating its revision), also compare
+ * it against the working buffer so that a commit never exports from a stale
+ * anchor.
+ */
+static int
+SourceUnchanged(const AG_Editable *_Nonnull ed, const void *_Nonnull key,
+    Uint32 revision, const char *_Nonnull encoding, const char *_Nullable s)
+{
+	const AG_EditableSource *src = &ed->src;
+
+	if (src->key != key || src->encoding != ed->encoding ||
+	    src->revision != revision) {
+		return (0);
+	}
+	if (ed->sBuf.s == NULL || src->stale ||
+	    src->revBuffer != ed->sBuf.revision)
+		return (1);			/* Will be imported again */
+
+	return SourceMatches(ed, encoding, s);
+}
+
+/*
+ * Record the state of the bound text after it was imported into (or
+ * exported from) the working buffer. The byte offset of character index
+ * anchor in the bound text is recorded for use by the next commit.
+ */
+static void
+SyncSource(AG_Editable *_Nonnull ed, const void *_Nonnull key, Uint32 revision,
+    AG_Size len, AG_Size anchor, AG_Size anchorOffs)
+{
+	AG_EditableSource *src = &ed->src;
+
+	src->key = key;
+	src->encoding = ed->encoding;
+	src->len = len;
+	src->dirty = AG_SIZE_MAX;
+	src->anchor = anchor;
+	src->anchorOffs = anchorOffs;
+	src->revision = revision;
+	src->revBuffer = ed->sBuf.revision;
+	src->stale = 0;
+}
+
+/*
+ * Record the state of newly imported bound text. If exporting the working
+ * buffer would not reproduce it byte for byte, the first commit rewrites
+ * the text entirely.
+ */
+static void
+SyncImported(AG_Editable *_Nonnull ed, const void *_Nonnull key,
+    Uint32 revision, const char *_Nonnull encoding, const char *_Nullable s)
+{
+	SyncSource(ed, key, revision, (s != NULL) ? strlen(s) : 0, 0, 0);
+
+	if (strcmp(encoding, "UTF-8") == 0 && !SourceMatches(ed, encoding, s))
+		ed->src.dirty = 0;
+}
+
+/*
+ * Return the index of the first character of the working buffer which must
+ * be exported to the bound text s, and its offset in bytes into s. This is
+ * the first character modified since the last synchronization, unless the
+ * bound text has been changed since (or the encoding does not allow it).
+ */
+static AG_Size
+CommitStart(const AG_Editable *_Nonnull ed, const void *_Nonnull key,
+    Uint32 revision, const char *_Nonnull encoding, const char *_Nullable s,
+    AG_Size *_Nonnull offs)
+{
+	const AG_EditableSource *src = &ed->src;
+	const AG_EditableBuffer *buf = &ed->sBuf;
+	AG_Size pos, i, o;
+	int n;
+
+	*offs = 0;
+	if (s == NULL || src->key != key || src->encoding != ed->encoding ||
+	    src->revision != revision) {
+		return (0);
+	}
+	if (src->dirty == AG_SIZE_MAX) {
+		if (src->revBuffer != buf->revision) {
+			return (0);
+		}
+		*offs = src->len;			/* Unmodified */
+		return (buf->len);
+	}
+	pos = MIN(src->dirty, buf->len);
+
+	if (strcmp(encoding, "US-ASCII") == 0) {
+		*offs = pos;
+		return (pos);
+	} else if (strcmp(encoding, "UTF-8") != 0) {
+		return (0);
+	}
+	if (pos < src->anchor && src->anchor - pos < pos) {
+		/* Walk back from the anchor over the bound text. */
+		for (o = src->anchorOffs, i = src->anchor; i > pos; i--) {
+			do {
+				o--;
+			} while (o > 0 && (s[o] & 0xc0) == 0x80);
+		}
+	} else {
+		if (pos >= src->anchor) {
+			i = src->anchor;
+			o = src->anchorOffs;
+		} else {
+			i = 0;
+			o = 0;
+		}
+		for (; i < pos; i++) {
+			if ((n = AG_CharLengthUTF8FromUCS4(buf->s[i])) == -1) {
+				return (0);
+			}
+			o += n;
+		}
+	}
+	*offs = o;
+	return (pos);
+}
+
+/* Clear a working buffer. */
+static __inline__ void
+ClearBuffer(AG_EditableBuffer *_Nonnull buf)
+{
+	AG_Free(buf->s);
+	buf->s = NULL;
+	buf->len = 0;
+	buf->maxLen = 0;
+}
+
+/* Discard the display line index (lay out all lines on next access). */
+static __inline__ void
+InvalidateLines(AG_Editable *_Nonnull ed)
+{
+	ed->lines.n = 0;
+	ed->lines.dirtyStart = -1;
+}
+
+/* Record a modification of the working buffer starting at pos. */
+static __inline__ void
+BufferChanged(AG_Editable *_Nonnull ed, int pos)
+{
+	ed->sBuf.revision++;
+	if ((AG_Size)pos < ed->src.dirty)
+		ed->src.dirty = (AG_Size)pos;
+}
+
+/*
+ * Record the insertion of nIns and the removal of nDel characters at pos
+ * in the working buffer, for incremental update of the display line index.
+ */
+static void
+LinesChanged(AG_Editable *_Nonnull ed, int pos, int nIns, int nDel)
+{
+	AG_EditableLines *li = &ed->lines;
+
+	BufferChanged(ed, pos);
+
+	if (li->n == 0)
+		return;
+
+	if (li->dirtyStart == -1) {
+		li->dirtyStart = pos;
+		li->dirtyEnd = pos + nIns;
+	} else {
+		int end = li->dirtyEnd;
+
+		if (end >= pos + nDel) {
+			end += (nIns - nDel);
+		} else if (end > pos) {
+			end = pos + nIns;
+		}
+		li->dirtyStart = MIN(li->dirtyStart, pos);
+		li->dirtyEnd = MAX(end, pos + nIns);
 	}
+	li->delta += (nIns - nDel);
+}
+
+/*
+ * Replace the contents of the working buffer with newly imported text.
+ * Only the range differing from the previous contents is marked for layout.
+ */
+static void
+ReplaceBuffer(AG_Editable *_Nonnull ed, AG_EditableBuffer *_Nonnull buf,
+    AG_Char *_Nonnull s, AG_Size len, AG_Size maxLen)
+{
+	const AG_Char *sOld = buf->s;
+
+	if (sOld != NULL && ed->lines.n > 0) {
+		const AG_Size lenOld = buf->len;
+		const AG_Size lenMin = MIN(len, lenOld);
+		AG_Size nPre, nSuf;
+
+		for (nPre = 0; nPre < lenMin && s[nPre] == sOld[nPre]; nPre++)
+			;
+		for (nSuf = 0;
+		     nSuf < lenMin - nPre &&
+		     s[len-1-nSuf] == sOld[lenOld-1-nSuf];
+		     nSuf++)
+			;
+		if (nPre < lenMin || len != lenOld)
+			LinesChanged(ed, (int)nPre,
+			    (int)(len - nPre - nSuf),
+			    (int)(lenOld - nPre - nSuf));
+	} else {
+		InvalidateLines(ed);
+	}
+	Free(buf->s);
+	buf->s = s;
+	buf->len = len;
+	buf->maxLen = maxLen;
+}
+
+/*
+ * Return the working buffer. The variable is returned locked; the caller
+ * should invoke ReleaseBuffer() after use.
+ *
+ * The working buffer persists between calls. In Shared Access mode, the
+ * bound text is only imported again if its revision (or a comparison
+ * against the working buffer) shows that it was changed externally, in
+ * which case the Undo/Redo history no longer applies and is cleared.
+ */
+static __inline__ AG_EditableBuffer *_Nullable
+GetBuffer(AG_Editable *_Nonnull ed)
+{
+	AG_EditableBuffer *buf = &ed->sBuf;
+	const int shared = !(ed->flags & AG_EDITABLE_EXCL);
+	AG_Char *sNew;
+	AG_Size len = 0, maxLen = sizeof(AG_Char);
 
 #ifdef AG_UNICODE
 	if (AG_Defined(ed, "text")) {                    /* AG_TextElement(3) */
 		AG_TextElement *txt;
+		const AG_TextEnt *te;
 
 		buf->var = AG_GetVariable(ed, "text", (void *)&txt);
 		buf->reallocable = 1;
 
 		AG_MutexLock(&txt->lock);
-
-		if ((ed->flags & AG_EDITABLE_EXCL) == 0 || buf->s == NULL) {
-			const AG_TextEnt *te = &txt->ent[ed->lang];
-
-			if (te->buf != NULL) {
-				buf->s = AG_ImportUnicode("UTF-8", te->buf,
-				                          &buf->len,
-				                          &buf->maxLen);
-			} else {
-				if ((buf->s = TryMalloc(sizeof(AG_Char))) != NULL) {
-					buf->s[0] = (AG_Char)'\0';
-				}
-				buf->len = 0;
-			}
-			if (buf->s == NULL) {
-				AG_MutexUnlock(&txt->lock);
-				AG_UnlockVariable(buf->var);
-				buf->var = NULL;
-				goto fail;
+		te = &txt->ent[ed->lang];
+
+		if (shared) {
+			if (SourceUnchanged(ed, te, te->revision, "UTF-8",
+			    te->buf)) {
+				if (buf->s != NULL && !ed->src.stale)
+					return (buf);
+			} else if (ed->src.key != NULL) {
+				AG_EditableClearHistory(ed);
 			}
+		} else if (buf->s != NULL) {
+			return (buf);
+		}
+		if (te->buf != NULL) {
+			sNew = AG_ImportUnicode("UTF-8", te->buf, &len, &maxLen);
+		} else if ((sNew = TryMalloc(sizeof(AG_Char))) != NULL) {
+			sNew[0] = (AG_Char)'\0';
+		}
+		if (sNew == NULL) {
+			AG_MutexUnlock(&txt->lock);
+			AG_UnlockVariable(buf->var);
+			buf->var = NULL;
+			return (NULL);
 		}
+		ReplaceBuffer(ed, buf, sNew, len, maxLen);
+		SyncImported(ed, te, te->revision, "UTF-8", te->buf);
 	} else
 #endif /* AG_UNICODE */
 	{                                                       /* "C" string */
@@ -121,65 +416,93 @@ GetBuffer(AG_Editable *_Nonnull ed)
 		buf->var = AG_GetVariable(ed, "string", (void *)&s);
 		buf->reallocable = 0;
 
-		if ((ed->flags & AG_EDITABLE_EXCL) == 0 || buf->s == NULL) {
+		if (shared) {
+			if (SourceUnchanged(ed, s, STRING_REVISION(buf->var),
+			    ed->encoding, s)) {
+				if (buf->s != NULL && !ed->src.stale)
+					return (buf);
+			} else if (ed->src.key != NULL) {
+				AG_EditableClearHistory(ed);
+			}
+		} else if (buf->s != NULL) {
+			return (buf);
+		}
 #ifdef AG_UNICODE
-			buf->s = AG_ImportUnicode(ed->encoding, s, &buf->len,
-			                          &buf->maxLen);
+		sNew = AG_ImportUnicode(ed->encoding, s, &len, &maxLen);
 #else
-			buf->s = (Uint8 *)TryStrdup(s);
-			buf->maxLen = buf->len = strlen(s);
+		if ((sNew = (Uint8 *)TryStrdup(s)) != NULL)
+			maxLen = len = strlen(s);
 #endif
-			if (buf->s == NULL) {
-				AG_UnlockVariable(buf->var);
-				goto fail;
-			}
+		if (sNew == NULL) {
+			AG_UnlockVariable(buf->var);
+			buf->var = NULL;
+			return (NULL);
 		}
+		ReplaceBuffer(ed, buf, sNew, len, maxLen);
+		SyncImported(ed, s, STRING_REVISION(buf->var), ed->encoding, s);
 	}
 	return (buf);
-fail:
-	if ((ed->flags & AG_EDITABLE_EXCL) == 0) { free(buf); }
-	return (NULL);
-}
-
-/* Clear a working buffer. */
-static __inline__ void
-ClearBuffer(AG_EditableBuffer *_Nonnull buf)
-{
-	AG_Free(buf->s);
-	buf->s = NULL;
-	buf->len = 0;
-	buf->maxLen = 0;
 }
 
-/* Commit changes to the working buffer. */
+/*
+ * Commit changes to the working buffer. Only the characters following the
+ * first one modified since the last synchronization are exported (when the
+ * encoding allows it), and the revision of the bound text is incremented.
+ */
 static void
 CommitBuffer(AG_Editable *_Nonnull ed, AG_EditableBuffer *_Nonnull buf)
 {
 #ifdef AG_UNICODE
+	AG_Size pos, offs, len;
+
 	if (AG_Defined(ed, "text")) {                    /* AG_TextElement(3) */
 		AG_TextElement *txt = buf->var->data.p;
 		AG_TextEnt *te = &txt->ent[ed->lang];
-		AG_Size len;
 
-		if (AG_LengthUTF8FromUCS4(buf->s, &len) == -1)
+		pos = CommitStart(ed, te, te->revision, "UTF-8", te->buf, &offs);
+
+		if (AG_LengthUTF8FromUCS4(&buf->s[pos], &len) == -1)
 			goto fail;
 
-		if ((++len > te->maxLen) && AG_TextRealloc(te, len) == -1)
+		len += offs;
+		if ((len+1 > te->maxLen) && AG_TextRealloc(te, len+1) == -1)
 			goto fail;
 
-		if (AG_ExportUnicode(ed->encoding, te->buf, buf->s,
-		                     te->maxLen + 1) == -1)
+		if (AG_ExportUnicode("UTF-8", &te->buf[offs], &buf->s[pos],
+		                     te->maxLen - offs) == -1)
 			goto fail;
+
+		te->len = len;
+		te->revision++;
+		SyncSource(ed, te, te->revision, len, pos, offs);
 	} else {                                                /* "C" string */
-		if (AG_ExportUnicode(ed->encoding,
-		                     buf->var->data.s, buf->s,
-				     buf->var->info.size) == -1)
+		AG_Variable *V = buf->var;
+		char *s = V->data.s;
+
+		pos = CommitStart(ed, s, STRING_REVISION(V), ed->encoding, s,
+		    &offs);
+		if (offs >= V->info.size) {
+			pos = 0;
+			offs = 0;
+		}
+
+		if (AG_ExportUnicode(ed->encoding, &s[offs], &buf->s[pos],
+		                     V->info.size - offs) == -1)
 			goto fail;
+
+		len = offs + strlen(&s[offs]);
+# if AG_MODEL != AG_SMALL
+		V->revision++;
+# endif
+		SyncSource(ed, s, STRING_REVISION(V), len, pos, offs);
 	}
 #else  /* !AG_UNICODE */
 
 	Strlcpy(buf->var->data.s, (const char *)buf->s, buf->var->info.size);
 
+	SyncSource(ed, buf->var->data.s, STRING_REVISION(buf->var),
+	    strlen(buf->var->data.s), 0, 0);
+
 #endif /* !AG_UNICODE */
 
 	ed->flags |= AG_EDITABLE_MARKPREF;
@@ -188,10 +511,16 @@ CommitBuffer(AG_Editable *_Nonnull ed, AG_EditableBuffer *_Nonnull buf)
 #ifdef AG_UNICODE
 fail:
 	Verbose("CommitBuffer: %s; ignoring\n", AG_GetError());
+	if (!(ed->flags & AG_EDITABLE_EXCL))
+		ClearBuffer(buf);		/* Re-import on next access */
 #endif
 }
 
-/* Release the working buffer. */
+/*
+ * Release the working buffer. In Shared Access mode, import the bound text
+ * again on next access if the working buffer was modified without being
+ * committed.
+ */
 static __inline__ void
 ReleaseBuffer(AG_Editable *_Nonnull ed, AG_EditableBuffer *_Nonnull buf)
 {
@@ -203,13 +532,12 @@ ReleaseBuffer(AG_Editable *_Nonnull ed, AG_EditableBuffer *_Nonnull buf)
 		AG_UnlockVariable(buf->var);
 		buf->var = NULL;
 	}
-	if (!(ed->flags & AG_EDITABLE_EXCL)) {
-		ClearBuffer(buf);
-		Free(buf);
-	}
+	if (!(ed->flags & AG_EDITABLE_EXCL) &&
+	    buf->revision != ed->src.revBuffer)
+		ed->src.stale = 1;
 }
 
-/* Allocate and return a new buffer handle in a locked condition */
+/* Return the working buffer in a locked condition. */
 AG_EditableBuffer *
 AG_EditableGetBuffer(AG_Editable *ed)
 {
@@ -246,46 +574,59 @@ AG_EditableGrowBuffer(AG_Editable *ed, AG_EditableBuffer *buf, AG_Char *ins,
 
 	newLen = (buf->len + nIns + 1)*sizeof(AG_Char);
 
+	if (!buf->reallocable) {		/* Check against bound size */
 #ifdef AG_UNICODE
-	if (strcmp(ed->encoding, "UTF-8") == 0) {
-		AG_Size sLen, insLen;
+		if (strcmp(ed->encoding, "UTF-8") == 0) {
+			AG_Size sLen, insLen;
+
+			if (buf == &ed->sBuf && ed->src.key != NULL &&
+			    buf->revision == ed->src.revBuffer) {
+				sLen = ed->src.len;	/* Unmodified since sync */
+			} else if (AG_LengthUTF8FromUCS4(buf->s, &sLen) == -1) {
+				return (-1);
+			}
+			if (AG_LengthUTF8FromUCS4(ins, &insLen) == -1)
+				return (-1);
 
-		if (AG_LengthUTF8FromUCS4(buf->s, &sLen) == -1 ||
-		    AG_LengthUTF8FromUCS4(ins, &insLen) == -1) {
-			return (-1);
+			convLen = sLen + insLen + 1;
+		} else if (strcmp(ed->encoding, "US-ASCII") == 0) {
+			convLen = buf->len + nIns + 1;
+		} else {
+			/* TODO Proper estimates for other charsets */
+			convLen = newLen;
 		}
-		convLen = sLen + insLen + 1;
-	} else if (strcmp(ed->encoding, "US-ASCII") == 0) {
-		convLen = AG_LengthUCS4(buf->s) + nIns + 1;
-	} else {
-		/* TODO Proper estimates for other charsets */
-		convLen = newLen;
-	}
 #else /* !AG_UNICODE */
-	if (strcmp(ed->encoding, "US-ASCII") == 0) {
-		convLen = strlen((const char *)buf->s) + nIns + 1;
-	} else {
-		convLen = newLen;
-	}
+		if (strcmp(ed->encoding, "US-ASCII") == 0) {
+			convLen = buf->len + nIns + 1;
+		} else {
+			convLen = newLen;
+		}
 #endif /* AG_UNICODE */
-
-	if (!buf->reallocable) {
 		if (convLen > buf->var->info.size) {
 			AG_SetError("%u > %u bytes", (Uint)convLen, (Uint)buf->var->info.size);
 			return (-1);
 		}
 	}
 	if (newLen > buf->maxLen) {
-		if ((sNew = TryRealloc(buf->s, newLen)) == NULL) {
+		AG_Size maxLenNew = buf->maxLen + (buf->maxLen >> 1);
+
+		if (maxLenNew < newLen) {
+			maxLenNew = newLen;
+		}
+		if ((sNew = TryRealloc(buf->s, maxLenNew)) == NULL) {
 			return (-1);
 		}
 		buf->s = sNew;
-		buf->maxLen = newLen;
+		buf->maxLen = maxLenNew;
 	}
 	return (0);
 }
 
-/* Release a working buffer. */
+/*
+ * Release a working buffer. In Shared Access mode, changes made directly to
+ * the buffer by the caller are discarded (the bound text is imported again
+ * on next access). In Exclusive mode, the display line index is rebuilt.
+ */
 void
 AG_EditableReleaseBuffer(AG_Editable *ed, AG_EditableBuffer *buf)
 {
@@ -293,6 +634,11 @@ AG_EditableReleaseBuffer(AG_Editable *ed, AG_EditableBuffer *buf)
 
 	ReleaseBuffer(ed, buf);
 
+	if (!(ed->flags & AG_EDITABLE_EXCL)) {
+		ed->src.stale = 1;
+	} else {
+		InvalidateLines(ed);
+	}
 	AG_ObjectUnlock(ed);
 }
 
@@ -434,14 +780,13 @@ AG_EditableSetWordWrap(AG_Editable *ed, int enable)
  * Disabled mode may still access its contents for reading.
  *
  * In Shared Access mode (the default), every interaction and operation must
- * acquire an internal working buffer (which involves allocations and UTF-8
- * conversions). Checksums must be calculated in order for Undo/Redo to work
- * safely against potentially-changing buffer, and the Editable must be
- * redrawn periodically.
+ * check the bound text for external changes (by comparing it against a copy
+ * of the text last imported or committed) and import it again if it has
+ * changed. The Editable must also be redrawn periodically.
  *
- * Exclusive Access mode allows Editable to operate more efficiently through
- * the use of a persistent working buffer, which avoids the need for regular
- * redrawing, allocations, UTF-8 conversions and checksumming.
+ * Exclusive Access mode allows Editable to operate more efficiently by
+ * trusting its persistent working buffer, which avoids the need for regular
+ * redrawing and comparisons.
  */
 void
 AG_EditableSetExcl(AG_Editable *ed, int enable)
@@ -455,6 +800,7 @@ AG_EditableSetExcl(AG_Editable *ed, int enable)
 			AG_RedrawOnTick(ed, -1);
 			AG_EditableClearHistory(ed);
 			ClearBuffer(&ed->sBuf);
+			ed->src.key = NULL;
 		}
 	} else {
 		if (ed->flags & AG_EDITABLE_EXCL) {
@@ -462,6 +808,7 @@ AG_EditableSetExcl(AG_Editable *ed, int enable)
 			AG_RedrawOnTick(ed, 1000);
 			AG_EditableClearHistory(ed);
 			ClearBuffer(&ed->sBuf);
+			ed->src.key = NULL;
 		}
 	}
 	AG_ObjectUnlock(ed);
@@ -714,6 +1061,11 @@ OnHide(AG_Event *_Nonnull event)
 	if (ed->pm != NULL) {
 		AG_PopupHide(ed->pm);
 	}
+	AG_ObjectLock(ed);
+	if (!(ed->flags & AG_EDITABLE_EXCL)) {
+		ClearBuffer(&ed->sBuf);		/* Import again when shown */
+	}
+	AG_ObjectUnlock(ed);
 	OnFocusLoss(event);
 }
 
@@ -727,6 +1079,7 @@ OnFontChange(AG_Event *_Nonnull event)
 	ed->fontMaxHeight = height;
 	ed->lineSkip = lineskip;
 	ed->yVis = HEIGHT(ed) / lineskip;
+	InvalidateLines(ed);
 
 	if (ed->suPlaceholder != -1) {
 		AG_WidgetUnmapSurface(ed, ed->suPlaceholder);
@@ -768,10 +1121,326 @@ WrapAtChar(AG_Editable *_Nonnull ed, int x, AG_Char *_Nonnull s,
 	return (0);
 }
 
+#define LAYOUT_FLAGS (AG_EDITABLE_WORDWRAP | AG_EDITABLE_PASSWORD | \
+                      AG_EDITABLE_UPPERCASE | AG_EDITABLE_LOWERCASE)
+
+/* Return the advance of a character as displayed. */
+static __inline__ int
+CharAdvance(AG_Editable *_Nonnull ed, AG_Font *_Nonnull font,
+    const AG_TextState *_Nonnull ts, AG_Char c)
+{
+	AG_Glyph *G;
+
+	if (c == '\t') {
+		return (agTextTabWidth);
+	}
+	if (ed->flags & AG_EDITABLE_PASSWORD) {
+		c = '*';
+	} else if (ed->flags & AG_EDITABLE_UPPERCASE) {
+		c = toupper(c);
+	} else if (ed->flags & AG_EDITABLE_LOWERCASE) {
+		c = tolower(c);
+	}
+	G = AG_TextRenderGlyph(WIDGET(ed)->drv, font, &ts->colorBG, &ts->color, c);
+	return (G->advance);
+}
+
+/* Return the length of the ANSI sequence at s (or 0 if none). */
+static __inline__ int
+SkipANSI(const AG_TextState *_Nonnull ts, const AG_Char *_Nonnull s)
+{
+	AG_TextANSI ansi;
+
+	if (s[0] == 0x1b &&
+	    s[1] >= 0x40 && s[1] <= 0x5f && s[2] != '\0' &&
+	    AG_TextParseANSI(ts, &ansi, &s[1]) == 0) {
+		return (ansi.len + 1);
+	}
+	return (0);
+}
+
+/* Return the index of the display line containing character pos. */
+static __inline__ Uint
+FindLine(const AG_EditableLines *_Nonnull li, int pos)
+{
+	Uint lo = 0, hi = li->n;
+
+	while (hi - lo > 1) {
+		const Uint mid = (lo + hi) >> 1;
+
+		if (li->lines[mid].start <= pos) {
+			lo = mid;
+		} else {
+			hi = mid;
+		}
+	}
+	return (lo);
+}
+
+/* Append a line to the scratch array. */
+static int
+AddLine(AG_EditableLines *_Nonnull li, Uint *_Nonnull n, int start, int w,
+    Uint flags)
+{
+	AG_EditableLine *L;
+
+	if (*n == li->maxTmp) {
+		const Uint maxNew = (li->maxTmp > 0) ? (li->maxTmp << 1) : 32;
+
+		if ((L = TryRealloc(li->tmp, maxNew*sizeof(AG_EditableLine))) == NULL) {
+			return (-1);
+		}
+		li->tmp = L;
+		li->maxTmp = maxNew;
+	}
+	L = &li->tmp[(*n)++];
+	L->start = start;
+	L->w = w;
+	L->flags = flags;
+	return (0);
+}
+
+/*
+ * Check whether a line starting at character start (past the modified range)
+ * also started a line of the previous layout. Layout may resume from there.
+ */
+static __inline__ int
+Resync(const AG_EditableLines *_Nonnull li, Uint *_Nonnull j, Uint nOld,
+    int start, int delta)
+{
+	if (start < li->dirtyEnd) {
+		return (0);
+	}
+	while (*j < nOld && li->lines[*j].start + delta < start) {
+		(*j)++;
+	}
+	return (*j < nOld && li->lines[*j].start + delta == start);
+}
+
+/* Horizontal extent of a line for the purpose of scrolling. */
+#define LINE_EXTENT(L) \
+	((L)->w + (((L)->flags & AG_EDITABLE_LINE_NEWLINE) ? 10 : 0))
+
+/*
+ * Update the index of display lines of the working buffer.
+ *
+ * Only the lines affected by modifications since the last update are laid
+ * out again. Since word wrapping of a line depends on the first word of the
+ * next, we start two lines before the first modified line and continue until
+ * a line begins where a line of the previous layout began (in which case the
+ * remaining lines are only offset). Changes of font, width or display flags
+ * cause the entire buffer to be laid out again.
+ */
+static int
+UpdateLines(AG_Editable *_Nonnull ed, const AG_EditableBuffer *_Nonnull buf)
+{
+	const AG_TextState *ts = AG_TEXT_STATE_CUR();
+	AG_EditableLines *li = &ed->lines;
+	AG_Font *font = WFONT(ed);
+	const AG_Char *s = buf->s;
+	const int len = (int)buf->len;
+	const Uint flags = (ed->flags & LAYOUT_FLAGS);
+	const int width = (flags & AG_EDITABLE_WORDWRAP) ? WIDTH(ed) : 0;
+	const int paddingLeft = WIDGET(ed)->paddingLeft;
+	AG_EditableLine *L;
+	Uint k=0, j, m, nOld=0, nNew=0, nLines, lineFlags=0;
+	int i=0, x, lineStart, delta, full, xMaxNew=10, xMaxOld=0;
+
+	full = (li->n == 0 ||
+	        li->font != font ||
+	        li->flags != flags ||
+	        li->width != width ||
+	        li->paddingLeft != paddingLeft ||
+	        li->tabWidth != agTextTabWidth ||
+	        li->len + li->delta != len);
+	if (!full) {
+		if (li->dirtyStart == -1) {
+			return (0);                          /* Up to date */
+		}
+		nOld = li->n;
+		k = FindLine(li, li->dirtyStart);
+		if (flags & AG_EDITABLE_WORDWRAP) {
+			k = (k > 2) ? (k - 2) : 0;
+		}
+		i = li->lines[k].start;
+		lineFlags = (li->lines[k].flags & AG_EDITABLE_LINE_WRAPPED);
+	}
+	delta = len - li->len;
+	j = k + 1;
+	x = paddingLeft;
+
+	for (lineStart = i; ; ) {
+		AG_Char c;
+		int nSkip;
+
+		if (i >= len || (c = s[i]) == '\0') {
+			if (AddLine(li, &nNew, lineStart, x, lineFlags) == -1) {
+				goto fail;
+			}
+			j = nOld;
+			break;
+		}
+		if ((flags & AG_EDITABLE_WORDWRAP) && i > lineStart &&
+		    WrapAtChar(ed, x, (AG_Char *)&s[i], font, &ts->colorBG,
+		               &ts->color)) {
+			if (AddLine(li, &nNew, lineStart, x, lineFlags) == -1) {
+				goto fail;
+			}
+			lineStart = i;
+			lineFlags = AG_EDITABLE_LINE_WRAPPED;
+			x = paddingLeft;
+			if (!full && Resync(li, &j, nOld, i, delta))
+				break;
+		}
+		if (c == '\n') {
+			if (AddLine(li, &nNew, lineStart, x,
+			    lineFlags | AG_EDITABLE_LINE_NEWLINE) == -1) {
+				goto fail;
+			}
+			lineStart = ++i;
+			lineFlags = 0;
+			x = paddingLeft;
+			if (!full && Resync(li, &j, nOld, i, delta)) {
+				break;
+			}
+			continue;
+		}
+		if (c == 0x1b && (nSkip = SkipANSI(ts, &s[i])) > 0) {
+			lineFlags |= AG_EDITABLE_LINE_ANSI;
+			i += nSkip;
+			continue;
+		}
+		x += CharAdvance(ed, font, ts, c);
+		i++;
+	}
+
+	/* Replace lines [k,j) of the previous layout with the new lines. */
+	nLines = k + nNew + (nOld - j);
+	if (nLines > li->maxLines) {
+		Uint maxNew = li->maxLines + (li->maxLines >> 1);
+
+		if (maxNew < nLines) {
+			maxNew = nLines;
+		}
+		if ((L = TryRealloc(li->lines, maxNew*sizeof(AG_EditableLine))) == NULL) {
+			goto fail;
+		}
+		li->lines = L;
+		li->maxLines = maxNew;
+	}
+	for (m = k; m < j; m++) {
+		xMaxOld = MAX(xMaxOld, LINE_EXTENT(&li->lines[m]));
+	}
+	for (m = 0; m < nNew; m++) {
+		xMaxNew = MAX(xMaxNew, LINE_EXTENT(&li->tmp[m]));
+	}
+	if (j < nOld) {
+		if (k + nNew != j) {
+			memmove(&li->lines[k + nNew], &li->lines[j],
+			    (nOld - j)*sizeof(AG_EditableLine));
+		}
+		L = &li->lines[k + nNew];
+		L->flags = (L->flags & ~(AG_EDITABLE_LINE_WRAPPED)) | lineFlags;
+		if (delta != 0) {
+			for (m = k + nNew; m < nLines; m++)
+				li->lines[m].start += delta;
+		}
+	}
+	memcpy(&li->lines[k], li->tmp, nNew*sizeof(AG_EditableLine));
+
+	if (full || li->firstANSI == -1 || li->firstANSI >= (int)k) {
+		const int firstOld = (full) ? -1 : li->firstANSI;
+		Uint mEnd = k + nNew;                    /* First ANSI line */
+
+		if (firstOld != -1 && firstOld < (int)j) {
+			mEnd = nLines;          /* Previous first line replaced */
+		}
+		li->firstANSI = -1;
+		for (m = k; m < mEnd; m++) {
+			if (li->lines[m].flags & AG_EDITABLE_LINE_ANSI) {
+				li->firstANSI = (int)m;
+				break;
+			}
+		}
+		if (li->firstANSI == -1 && firstOld >= (int)j)
+			li->firstANSI = firstOld + (int)(k + nNew) - (int)j;
+	}
+
+	if (nLines == 1) {                                 /* Single line */
+		li->xMax = li->lines[0].w;
+	} else if (full || nOld == 1 ||
+	           (xMaxOld >= li->xMax && xMaxNew < li->xMax)) {
+		li->xMax = 10;
+		for (m = 0; m < nLines; m++)
+			li->xMax = MAX(li->xMax, LINE_EXTENT(&li->lines[m]));
+	} else {
+		li->xMax = MAX(li->xMax, xMaxNew);
+	}
+
+	li->n = nLines;
+	li->len = len;
+	li->delta = 0;
+	li->dirtyStart = -1;
+	li->font = font;
+	li->flags = flags;
+	li->width = width;
+	li->paddingLeft = paddingLeft;
+	li->tabWidth = agTextTabWidth;
+	return (0);
+fail:
+	InvalidateLines(ed);
+	return (-1);
+}
+
+/*
+ * Return the display line and the x position (px) of the cursor placed
+ * before character pos. A cursor placed at a word wrap is displayed at the
+ * end of the preceding line.
+ */
+static void
+LocateChar(AG_Editable *_Nonnull ed, const AG_EditableBuffer *_Nonnull buf,
+    int pos, int *_Nonnull x, int *_Nonnull line)
+{
+	const AG_TextState *ts = AG_TEXT_STATE_CUR();
+	const AG_EditableLines *li = &ed->lines;
+	AG_Font *font = WFONT(ed);
+	const AG_EditableLine *L;
+	Uint j;
+	int i, nSkip;
+
+	if (li->n == 0) {
+		*x = WIDGET(ed)->paddingLeft;
+		*line = 0;
+		return;
+	}
+	j = FindLine(li, pos);
+	L = &li->lines[j];
+	if (j > 0 && pos == L->start && (L->flags & AG_EDITABLE_LINE_WRAPPED)) {
+		*x = L[-1].w;
+		*line = (int)(j - 1);
+		return;
+	}
+	*x = WIDGET(ed)->paddingLeft;
+	*line = (int)j;
+	for (i = L->start; i < pos && i < buf->len; i++) {
+		const AG_Char c = buf->s[i];
+
+		if (c == '\n') {
+			break;
+		}
+		if (c == 0x1b && (nSkip = SkipANSI(ts, &buf->s[i])) > 0) {
+			i += nSkip - 1;
+			continue;
+		}
+		*x += CharAdvance(ed, font, ts, c);
+	}
+}
+
 /*
  * Map mouse coordinates to a character position within the buffer.
+ * The display line is found from the line index, so only that line is
+ * measured.
  */
-#define ON_LINE(my,y)     ((my) >= (y) && (my) <= (y)+ed->lineSkip)
 #define ON_CHAR(mx,x,adv) ((mx) >= (x) && (mx) <= (x)+(adv))
 int
 AG_EditableMapPosition(AG_Editable *ed, AG_EditableBuffer *buf, int mx, int my,
@@ -781,8 +1450,10 @@ AG_EditableMapPosition(AG_Editable *ed, AG_EditableBuffer *buf, int mx, int my,
 	AG_Driver *drv = WIDGET(ed)->drv;
 	AG_Font *font = WFONT(ed);
 	const enum ag_font_type fontType = font->spec.type;
+	const AG_EditableLines *li = &ed->lines;
 	AG_TextANSI ansi;
-	int i, x, y, yMouse;
+	Uint line;
+	int i, iEnd, x, yMouse, rv = 0;
 	
 	AG_OBJECT_ISA(ed, "AG_Widget:AG_Editable:*");
 	AG_ObjectLock(ed);
@@ -791,32 +1462,29 @@ AG_EditableMapPosition(AG_Editable *ed, AG_EditableBuffer *buf, int mx, int my,
 		*pos = 0;
 		goto out;
 	}
-	for (i=0, x=0, y=0; i < buf->len; i++) {
+	if (UpdateLines(ed, buf) == -1) {
+		rv = -1;
+		goto out;
+	}
+	line = (yMouse > 0) ? (yMouse - 1) / ed->lineSkip : 0;
+	if (line >= li->n) {
+		*pos = buf->len;
+		goto out;
+	}
+	i = li->lines[line].start;
+	iEnd = (line + 1 < li->n) ? li->lines[line + 1].start : (int)buf->len;
+	if (mx <= 0) {
+		*pos = i;
+		goto out;
+	}
+	for (x = 0; i < iEnd; i++) {
 		const AG_Char c = buf->s[i];
 
-		if (mx <= 0 && ON_LINE(yMouse,y)) {
+		if (c == '\n') {
 			*pos = i;
 			goto out;
-		}
-		if (WrapAtChar(ed, x, &buf->s[i], font, &ts->colorBG, &ts->color)) {
-			if (ON_LINE(yMouse,y) && mx > x) {
-				*pos = i;
-				goto out;
-			}
-			y += ed->lineSkip;
-			x = 0;
-		}
-		if (c == '\n') {
-			if (ON_LINE(yMouse,y) && mx > x) {
-				*pos = i;
-				goto out;
-			}
-			y += ed->lineSkip;
-			x = 0;
-			continue;
 		} else if (c == '\t') {
-			if (ON_LINE(yMouse,y) &&
-			    mx >= x && mx <= x+agTextTabWidth) {
+			if (mx >= x && mx <= x+agTextTabWidth) {
 				*pos = (mx < x + (agTextTabWidth >> 1)) ? i : i+1;
 				goto out;
 			}
@@ -844,8 +1512,7 @@ AG_EditableMapPosition(AG_Editable *ed, AG_EditableBuffer *buf, int mx, int my,
 					/* TODO blank box advance */
 					continue;
 				}
-				if (ON_LINE(yMouse, y) &&
-				    ON_CHAR(mx, x, Gft->advance)) {
+				if (ON_CHAR(mx, x, Gft->advance)) {
 					*pos = (mx < x + (Gft->advance >> 1)) ?
 					       i : i+1;
 					if (buf->s[*pos]   == 0x1b &&
@@ -869,9 +1536,7 @@ AG_EditableMapPosition(AG_Editable *ed, AG_EditableBuffer *buf, int mx, int my,
 				G = AG_TextRenderGlyph(drv, font,
 				    &ts->colorBG, &ts->color, c);
 
-				if (ON_LINE(yMouse,y) &&
-				    mx >= x &&
-				    mx <= x + G->su->w) {
+				if (mx >= x && mx <= x + G->su->w) {
 					*pos = i;
 					if (buf->s[*pos]   == 0x1b &&
 					    buf->s[*pos+1] >= 0x40 &&
@@ -891,12 +1556,11 @@ AG_EditableMapPosition(AG_Editable *ed, AG_EditableBuffer *buf, int mx, int my,
 			break;
 		}
 	}
-	*pos = buf->len;
+	*pos = iEnd;
 out:
 	AG_ObjectUnlock(ed);
-	return (0);
+	return (rv);
 }
-#undef ON_LINE
 #undef ON_CHAR
 
 /* Move cursor to the given position in pixels. */
@@ -975,6 +1639,35 @@ KeepVisibleCursor(AG_Editable *_Nonnull ed, AG_EditableBuffer *_Nonnull buf)
 	}
 }
 
+/* Apply the color effects of an ANSI SGR sequence. */
+static __inline__ void
+SetColorANSI(const AG_TextState *_Nonnull ts, const AG_TextANSI *_Nonnull ansi,
+    AG_Color *_Nonnull cFg, AG_Color *_Nonnull cBg)
+{
+	if (ansi->ctrl != AG_ANSI_CSI_SGR)
+		return;
+
+	switch (ansi->sgr) {
+	case AG_SGR_RESET:
+	case AG_SGR_NO_FG_NO_BG:
+		*cFg = ts->color;
+		*cBg = ts->colorBG;
+		break;
+	case AG_SGR_FG:
+		*cFg = ansi->color;
+		break;
+	case AG_SGR_BG:
+		*cBg = ansi->color;
+		break;
+	case AG_SGR_BOLD:
+		break;
+	case AG_SGR_UNDERLINE:
+		break;
+	default:
+		break;
+	}
+}
+
 static void
 Draw(void *_Nonnull obj)
 {
@@ -1002,7 +1695,9 @@ Draw(void *_Nonnull obj)
 	const int selEnd = ed->selEnd;
 	const int paddingLeft = WIDGET(ed)->paddingLeft;
 	const int paddingTop  = WIDGET(ed)->paddingTop;
-	int i, dx,dy, x,y, yCurs=0, selected=0;
+	const AG_EditableLines *li = &ed->lines;
+	Uint line;
+	int i, dx,dy, x,y, yCurs, selected;
 
 	if (cEditableBg->a > 0)
 		AG_DrawRectFilled(ed, &WIDGET(ed)->r, cEditableBg);
@@ -1010,6 +1705,10 @@ Draw(void *_Nonnull obj)
 	if ((buf = GetBuffer(ed)) == NULL) {
 		return;
 	}
+	if (UpdateLines(ed, buf) == -1) {
+		ReleaseBuffer(ed, buf);
+		return;
+	}
 	AG_EditableValidateSelection(ed, buf);
 
 	/* TODO Opaque glyph optimizations */
@@ -1037,137 +1736,126 @@ Draw(void *_Nonnull obj)
 		    paddingLeft, paddingTop);
 	}
 
-	x = paddingLeft;
-	y = paddingTop - ed->y*lineSkip;
-	ed->xMax = 10;
-	ed->yMax = 1;
-	for (i = 0; i <= buf->len; i++) {
-		AG_Glyph *G;
-		AG_Char c = buf->s[i];
-		AG_Rect r;
-
-		if (i == pos) {                                /* At cursor */
-			ed->xCurs = x;
-			if (flags & AG_EDITABLE_MARKPREF) {
-				ed->flags &= ~(AG_EDITABLE_MARKPREF);
-				ed->xCursPref = x;
+	ed->xMax = li->xMax;
+	ed->yMax = (int)li->n;
+
+	LocateChar(ed, buf, pos, &ed->xCurs, &ed->yCurs);       /* Cursor */
+	if (flags & AG_EDITABLE_MARKPREF) {
+		ed->flags &= ~(AG_EDITABLE_MARKPREF);
+		ed->xCursPref = ed->xCurs;
+	}
+	yCurs = paddingTop + (ed->yCurs - ed->y)*lineSkip;
+	if (selEnd > selStart) {                                 /* Selection */
+		LocateChar(ed, buf, selStart, &ed->xSelStart, &ed->ySelStart);
+		LocateChar(ed, buf, selEnd, &ed->xSelEnd, &ed->ySelEnd);
+	}
+
+	/*
+	 * Render the visible lines only. Colors set by ANSI sequences in the
+	 * preceding lines are carried over.
+	 */
+	line = (ed->y > 0) ? (Uint)ed->y : 0;
+	if (line < li->n && li->firstANSI != -1 && li->firstANSI < (int)line) {
+		for (i = li->lines[li->firstANSI].start;
+		     i < li->lines[line].start;
+		     i++) {
+			AG_TextANSI ansi;
+
+			if (buf->s[i] == 0x1b &&
+			    buf->s[i+1] >= 0x40 &&
+			    buf->s[i+1] <= 0x5f &&
+			    buf->s[i+2] != '\0' &&
+			    AG_TextParseANSI(ts, &ansi, &buf->s[i+1]) == 0) {
+				SetColorANSI(ts, &ansi, &cFg, &cBg);
+				i += ansi.len;
 			}
-			ed->yCurs = y/lineSkip + ed->y;
-			yCurs = y;
-		}
-		if (selEnd > selStart) {
-			if (i >= selStart && i < selEnd) {
-				if (!selected) {
-					selected = 1;
-					ed->xSelStart = x;
-					ed->ySelStart = y/lineSkip + ed->y;
+		}
+	}
+	for (; line < li->n; line++) {
+		const int iEnd = (line + 1 < li->n) ? li->lines[line + 1].start :
+		                                      (int)buf->len;
+
+		y = paddingTop + ((int)line - ed->y)*lineSkip;
+		if (WIDGET(ed)->rView.y1 + y >= clipY2) {
+			break;
+		}
+		x = paddingLeft;
+
+		for (i = li->lines[line].start; i < iEnd; i++) {
+			AG_Glyph *G;
+			AG_Char c = buf->s[i];
+			AG_Rect r;
+
+			if (c == '\0')
+				break;
+
+			selected = (i >= selStart && i < selEnd);
+
+			if (c == '\n') {
+				if (selected) {
+					AG_DrawLineV(ed, 1, y + lineSkip,
+					    y + (lineSkip << 1), cSel);
 				}
-			} else {
+				break;
+			} else if (c == '\t') {
 				if (selected) {
-					selected = 0;
-					ed->xSelEnd = x;
-					ed->ySelEnd = y/lineSkip + ed->y;
+					r.x = x - ed->x;
+					r.y = y;
+					r.w = agTextTabWidth + 1;
+					r.h = lineSkip + 1;
+					AG_DrawRectFilled(ed, &r, cSel);
+				}
+				/* TODO */
+				x += agTextTabWidth;
+				continue;
+			} else if    (c == 0x1b &&
+			    buf->s[i+1] >= 0x40 &&
+			    buf->s[i+1] <= 0x5f &&
+			    buf->s[i+2] != '\0') {
+				AG_TextANSI ansi;
+
+				if (AG_TextParseANSI(ts, &ansi, &buf->s[i+1]) == 0) {
+					SetColorANSI(ts, &ansi, &cFg, &cBg);
+					i += ansi.len;
+					continue;
 				}
 			}
-		}
-		if (i == buf->len || c == '\0')
-			break;
 
-		if (WrapAtChar(ed, x, &buf->s[i], font, &cBg, &cFg)) {
-			y += lineSkip;
-			ed->xMax = MAX(ed->xMax, x);
-			ed->yMax++;
-			x = paddingLeft;
-		}
-		if (c == '\n') {
-			y += lineSkip;
-			if (selected) {
-				AG_DrawLineV(ed, 1, y, y+lineSkip, cSel);
+			/* TODO separate loops for transformed cases */
+			if (isTransformed) {
+				if      (flags & AG_EDITABLE_PASSWORD)  { c = '*'; }
+				else if (flags & AG_EDITABLE_UPPERCASE) { c = toupper(c); }
+				else if (flags & AG_EDITABLE_LOWERCASE) { c = tolower(c); }
+			}
+
+			G = AG_TextRenderGlyph(drv, font, &cBg, &cFg, c);
+			dx = WIDGET(ed)->rView.x1 + x - ed->x;
+			dy = WIDGET(ed)->rView.y1 + y;
+
+			if (dx < clipX1 || dx >= clipX2 ||       /* Outside */
+			    dy < clipY1) {
+				x += G->advance;
+				continue;
 			}
-			ed->xMax = MAX(ed->xMax, x+10);
-			ed->yMax++;
-			x = paddingLeft;
-			continue;
-		} else if (c == '\t') {
 			if (selected) {
 				r.x = x - ed->x;
-				r.y = y;
-				r.w = agTextTabWidth + 1;
+				r.y = y + 1;
+				r.w = G->su->w + 1;
 				r.h = lineSkip + 1;
+				/* TODO queue and combine rectangles */
 				AG_DrawRectFilled(ed, &r, cSel);
 			}
-			/* TODO */
-			x += agTextTabWidth;
-			continue;
-		} else if    (c == 0x1b &&
-		    buf->s[i+1] >= 0x40 &&
-		    buf->s[i+1] <= 0x5f &&
-		    buf->s[i+2] != '\0') {
-			AG_TextANSI ansi;
-			
-			if (AG_TextParseANSI(ts, &ansi, &buf->s[i+1]) == 0) {
-				if (ansi.ctrl == AG_ANSI_CSI_SGR) {
-					switch (ansi.sgr) {
-					case AG_SGR_RESET:
-					case AG_SGR_NO_FG_NO_BG:
-						cFg = ts->color;
-						cBg = ts->colorBG;
-						break;
-					case AG_SGR_FG:
-						cFg = ansi.color;
-						break;
-					case AG_SGR_BG:
-						cBg = ansi.color;
-						break;
-					case AG_SGR_BOLD:
-						break;
-					case AG_SGR_UNDERLINE:
-						break;
-					default:
-						break;
-					}
-				}
-				i += ansi.len;
-				continue;
-			}
-		}
-
-		/* TODO separate loops for transformed cases */
-		if (isTransformed) {
-			if      (flags & AG_EDITABLE_PASSWORD)  { c = '*'; }
-			else if (flags & AG_EDITABLE_UPPERCASE) { c = toupper(c); }
-			else if (flags & AG_EDITABLE_LOWERCASE) { c = tolower(c); }
-		}
 
-		G = AG_TextRenderGlyph(drv, font, &cBg, &cFg, c);
-		dx = WIDGET(ed)->rView.x1 + x - ed->x;
-		dy = WIDGET(ed)->rView.y1 + y;
+			/*
+			 * Render the character to the display using the
+			 * drawGlyph() driver call. This allows driver-specific
+			 * filters or optimizations to be applied.
+			 */
+			drvOps->drawGlyph(drv, G, dx,dy);
 
-		if (dx < clipX1 || dx >= clipX2 ||               /* Outside */
-		    dy < clipY1 || dy >= clipY2) {
 			x += G->advance;
-			continue;
-		}
-		if (selected) {
-			r.x = x - ed->x;
-			r.y = y + 1;
-			r.w = G->su->w + 1;
-			r.h = lineSkip + 1;
-			/* TODO queue and combine rectangles */
-			AG_DrawRectFilled(ed, &r, cSel);
 		}
-
-		/*
-		 * Render the character to the display using the drawGlyph()
-		 * driver call. This allows driver-specific filters or
-		 * optimizations to be applied.
-		 */
-		drvOps->drawGlyph(drv, G, dx,dy);
-
-		x += G->advance;
 	}
-	if (ed->yMax == 1)
-		ed->xMax = x;
 	
 	/*
 	 * Draw the cursor.
@@ -1847,8 +2535,6 @@ AG_EditableCopyChunk(AG_Editable *ed, AG_EditableClipboard *cb, AG_Char *s,
 static __inline__ void
 InitRevision(AG_EditableRevision *_Nonnull rev)
 {
-	rev->lenBuffer = 0;
-	rev->crc32 = 0;
 	rev->posStart = 0;
 	rev->posEnd = 0;
 	rev->nCharsAdded = 0;
@@ -1886,9 +2572,8 @@ AG_EditableClearHistory(AG_Editable *ed)
  * Create a new revision.
  * 
  * This function must be called *before* any modifications are made to
- * the buffer. Under Shared Access, a checksum of the buffer contents is
- * generated and recorded in the Undo/Redo stack. If any external changes
- * are detected then the Undo/Redo stack is invalidated.
+ * the buffer. Under Shared Access, the Undo/Redo stack is invalidated by
+ * GetBuffer() whenever external changes are detected.
  */
 AG_EditableRevision *
 AG_EditableBeginRevision(AG_Editable *ed, AG_EditableBuffer *buf)
@@ -1944,22 +2629,12 @@ AG_EditableCommitRevision(AG_Editable *ed, AG_EditableBuffer *buf)
 
 	if (rev->nCharsAdded == 0 && rev->nCharsRemoved == 0) {
 		ed->nUndo--;                                  /* No changes */
-	} else {
-		if (!(ed->flags & AG_EDITABLE_EXCL)) {
-			rev->crc32 = AG_GetCRC32(buf->s, (buf->len << 2));
-			rev->lenBuffer = buf->len;
-#ifdef DEBUG_UNDO
-			Debug(ed, "COMMIT Undo Rev#%d (crc=%x, lenBuffer=%u)\n",
-			    ed->nUndo - 1, rev->crc32, rev->lenBuffer);
-#endif
-		}
+		return;
+	}
 #ifdef DEBUG_UNDO
-		else {
-			Debug(ed, "COMMIT Undo Rev#%d\n", ed->nUndo - 1);
-		}
+	Debug(ed, "COMMIT Undo Rev#%d\n", ed->nUndo - 1);
 #endif
-
-	}
+	LinesChanged(ed, rev->posStart, rev->nCharsAdded, rev->nCharsRemoved);
 }
 
 /*
@@ -1989,11 +2664,6 @@ AG_EditableRevert(AG_Editable *ed, AG_EditableBuffer *buf,
 		memcpy(revUR->s, &buf->s[posStart], nCharsAdded*sizeof(AG_Char));
 		revUR->s[nCharsAdded] = '\0';
 
-		if (!(ed->flags & AG_EDITABLE_EXCL)) {
-			revUR->lenBuffer = rev->lenBuffer;
-			revUR->crc32 = rev->crc32;
-		}
-
 		if (posStart == (len - 1)) {
 			buf->s[len - nCharsAdded] = '\0';
 		} else if (posStart < posEnd) {
@@ -2002,6 +2672,7 @@ AG_EditableRevert(AG_Editable *ed, AG_EditableBuffer *buf,
 		}
 		buf->len -= nCharsAdded;
 		ed->pos = posStart;
+		LinesChanged(ed, posStart, 0, nCharsAdded);
 	} else if (nCharsRemoved > 0) {
 		if (AG_EditableGrowBuffer(ed, buf, rev->s, nCharsRemoved) == -1) {
 			Verbose("AG_EditableGrowBuffer: %s\n", AG_GetError());
@@ -2012,11 +2683,6 @@ AG_EditableRevert(AG_Editable *ed, AG_EditableBuffer *buf,
 		revUR->posEnd = posEnd;
 		revUR->nCharsAdded = nCharsRemoved;
 
-		if (!(ed->flags & AG_EDITABLE_EXCL)) {
-			revUR->lenBuffer = rev->lenBuffer;
-			revUR->crc32 = rev->crc32;
-		}
-
 		if (posStart < len) {
 			memmove(&buf->s[posStart + nCharsRemoved],
 			    &buf->s[posStart],
@@ -2026,6 +2692,7 @@ AG_EditableRevert(AG_Editable *ed, AG_EditableBuffer *buf,
 		buf->len += nCharsRemoved;
 		buf->s[buf->len] = '\0';
 		ed->pos = posStart + nCharsRemoved;
+		LinesChanged(ed, posStart, nCharsRemoved, 0);
 	}
 	ed->xScrollTo = &ed->xCurs;
 	ed->yScrollTo = &ed->yCurs;
@@ -2045,23 +2712,6 @@ AG_EditableUndo(AG_Editable *ed, AG_EditableBuffer *buf)
 #endif
 	revUndo = &ed->undo[ed->nUndo - 1];
 
-	if (!(ed->flags & AG_EDITABLE_EXCL)) {
-		Uint32 crc;
-
-		crc = AG_GetCRC32(buf->s, (buf->len << 2));
-		if (revUndo->lenBuffer != buf->len ||
-		    revUndo->crc32 != crc) {
-			Debug(ed,
-			    "Buffer changed externally (len %u->%lu, crc %x->%x). "
-			    "Clearing history.\n",
-			    revUndo->lenBuffer, (Ulong)buf->len,
-			    revUndo->crc32, crc);
-
-			AG_EditableClearHistory(ed);
-			return;
-		}
-	}
-
 	/* Record changes made by AG_EditableRevert() onto the Redo stack. */
 	ed->redo = Realloc(ed->redo, (ed->nRedo + 1)*sizeof(AG_EditableRevision));
 	revRedo = &ed->redo[ed->nRedo++];
@@ -2629,12 +3279,11 @@ PollHistoryBuffer(AG_Event *_Nonnull event)
 	for (i = 0; i < ed->nUndo; i++) {
 		rev = &ed->undo[i];
 		it = AG_TlistAdd(tl, agIconDown.s,
-		    _("%s" "Undo Level %d ([%d,%d] +%d -%d) crc(%x,%d)"),
+		    _("%s" "Undo Level %d ([%d,%d] +%d -%d)"),
 		    (i == ed->nUndo - 1) ? ">" : "",
 		    i,
 		    rev->posStart, rev->posEnd,
-		    rev->nCharsAdded, rev->nCharsRemoved,
-		    rev->crc32, rev->lenBuffer);
+		    rev->nCharsAdded, rev->nCharsRemoved);
 		it->depth = 0;
 		it->p1 = rev;
 	}
@@ -2646,12 +3295,11 @@ PollHistoryBuffer(AG_Event *_Nonnull event)
 	for (i = 0; i < ed->nRedo; i++) {
 		rev = &ed->redo[i];
 		it = AG_TlistAdd(tl, agIconUp.s,
-		    _("%s" "Redo Level %d ([%d,%d] +%d -%d) crc(%x,%d)"),
+		    _("%s" "Redo Level %d ([%d,%d] +%d -%d)"),
 		    (i == ed->nRedo - 1) ? ">" : "",
 		    i,
 		    rev->posStart, rev->posEnd,
-		    rev->nCharsAdded, rev->nCharsRemoved,
-		    rev->crc32, rev->lenBuffer);
+		    rev->nCharsAdded, rev->nCharsRemoved);
 		it->depth = 0;
 		it->p1 = rev;
 	}
@@ -2676,7 +3324,7 @@ MenuHistoryBuffer(AG_Event *_Nonnull event)
 
 	tl = AG_TlistNew(win, AG_TLIST_POLL | AG_TLIST_EXPAND);
 	AG_TlistSetRefresh(tl, 125);
-	AG_TlistSizeHint(tl, "<Undo Level 8888 ([8888,8888] +88 -88) crc(88888888)>", 25);
+	AG_TlistSizeHint(tl, "<Undo Level 8888 ([8888,8888] +88 -88)>", 25);
 	AG_SetEvent(tl, "tlist-poll", PollHistoryBuffer,"%p",ed);
 
 	AG_WindowSetCaption(win, _("%s - History Buffer"), OBJECT(ed)->name);
@@ -3056,6 +3704,8 @@ AG_EditableSetString(AG_Editable *ed, const char *text)
 	}
 	ed->selStart = 0;
 	ed->selEnd = 0;
+	BufferChanged(ed, 0);
+	InvalidateLines(ed);
 	CommitBuffer(ed, buf);
 	ReleaseBuffer(ed, buf);
 out:
@@ -3174,7 +3824,9 @@ AG_EditableCatStringS(AG_Editable *ed, const char *s)
 			goto fail;
 		}
 		memcpy(&buf->s[buf->len], ucs, ucsLen*sizeof(AG_Char));
+		LinesChanged(ed, (int)buf->len, (int)ucsLen, 0);
 		buf->len += ucsLen;
+		buf->s[buf->len] = '\0';
 		ed->pos += ucsLen;
 		CommitBuffer(ed, buf);
 		ReleaseBuffer(ed, buf);
@@ -3348,6 +4000,10 @@ Init(void *_Nonnull obj)
 	ed->nRedo = 0;
 	ed->undo = Malloc(sizeof(AG_EditableRevision));
 	ed->redo = Malloc(sizeof(AG_EditableRevision));
+	memset(&ed->src, 0, sizeof(AG_EditableSource));
+	memset(&ed->lines, 0, sizeof(AG_EditableLines));
+	ed->lines.dirtyStart = -1;
+	ed->lines.firstANSI = -1;
 
 	AG_AddEvent(ed, "font-changed", OnFontChange, NULL);
 	AG_AddEvent(ed, "widget-hidden", OnHide, NULL);
@@ -3373,8 +4029,9 @@ Destroy(void *_Nonnull obj)
 	if (ed->pm != NULL) {
 		AG_PopupDestroy(ed->pm);
 	}
-	if (ed->flags & AG_EDITABLE_EXCL)
-		Free(ed->sBuf.s);
+	Free(ed->sBuf.s);
+	Free(ed->lines.lines);
+	Free(ed->lines.tmp);
 
 	for (i = 0; i < ed->nUndo; i++) {
 		FreeRevision(&ed->undo[i]);
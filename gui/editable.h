@@ -24,13 +24,54 @@ typedef struct ag_editable_buffer {
 	AG_Size len;			/* String length (chars) */
 	AG_Size maxLen;			/* Available buffer size (bytes) */
 	int reallocable;		/* Buffer can be realloc'd */
-	Uint32 _pad;
+	Uint32 revision;		/* Bumped when contents are modified */
 } AG_EditableBuffer;
 
+/* State of the bound text as of the last synchronization */
+typedef struct ag_editable_source {
+	const void *_Nullable key;	/* Bound string (or AG_TextEnt) */
+	const char *_Nullable encoding;	/* Encoding at synchronization */
+	AG_Size len;			/* Length of bound text (bytes) */
+	AG_Size dirty;			/* First char modified since (or MAX) */
+	AG_Size anchor;			/* Char index with known byte offset */
+	AG_Size anchorOffs;		/* Byte offset of anchor in bound text */
+	Uint32 revision;		/* Revision of bound text */
+	Uint32 revBuffer;		/* Revision of working buffer */
+	int stale;			/* Working buffer must be imported again */
+} AG_EditableSource;
+
+/* Display line (as laid out for rendering) */
+typedef struct ag_editable_line {
+	int start;			/* Index of first character */
+	int w;				/* Rightmost x (px) */
+	Uint flags;
+#define AG_EDITABLE_LINE_WRAPPED 0x01	/* Begins at a word wrap */
+#define AG_EDITABLE_LINE_NEWLINE 0x02	/* Ends with a newline */
+#define AG_EDITABLE_LINE_ANSI    0x04	/* Contains ANSI sequences */
+} AG_EditableLine;
+
+/* Index of display lines, updated incrementally as the buffer is edited */
+typedef struct ag_editable_lines {
+	AG_EditableLine *_Nullable lines; /* Display lines */
+	AG_EditableLine *_Nullable tmp;	/* Scratch lines for layout */
+	Uint n;				/* Number of lines (0 = invalid) */
+	Uint maxLines;			/* Allocated lines */
+	Uint maxTmp;			/* Allocated scratch lines */
+	Uint flags;			/* AG_Editable flags at layout */
+	int len;			/* Buffer length at layout (chars) */
+	int delta;			/* Length change since layout */
+	int dirtyStart, dirtyEnd;	/* Modified range (or -1) */
+	int firstANSI;			/* First line with ANSI sequences (or -1) */
+	int xMax;			/* Rightmost x of largest line (px) */
+	int width;			/* Word wrapping width at layout (px) */
+	int paddingLeft;		/* Left padding at layout (px) */
+	int tabWidth;			/* Tab width at layout (px) */
+	Uint32 _pad;
+	AG_Font *_Nullable font;	/* Font at layout */
+} AG_EditableLines;
+
 /* Recorded modification for Undo/Redo */
 typedef struct ag_editable_revision {
-	Uint lenBuffer;                  /* Length of buffer (for Shared Access) */
-	Uint32 crc32;                    /* CRC32 of buffer (for Shared Access) */
 	int posStart;                    /* Start position (char index) */
 	int posEnd;                      /* End position (char index) */
 	int nCharsAdded;       	         /* Number of characters added */
@@ -106,7 +147,7 @@ typedef struct ag_editable {
 	int yVis;                            /* Maximum visible area (lines) */
 	int posKbdSel;                       /* Start of keyboard selection */
 	Uint32 _pad;
-	AG_EditableBuffer sBuf;              /* Working buffer (for Exclusive Access) */
+	AG_EditableBuffer sBuf;              /* Persistent working buffer */
 	AG_Rect r;                           /* Clipping rectangle */
 	AG_CursorArea *_Nullable ca;         /* Text cursor-change area */
 	enum ag_language lang;               /* Selected language (for AG_Text) */
@@ -127,6 +168,8 @@ typedef struct ag_editable {
 	Uint nRedo;                          /* Redo stack size */
 	AG_EditableRevision *_Nonnull undo;  /* Undo stack (History Buffer) */
 	AG_EditableRevision *_Nonnull redo;  /* Redo stack */
+	AG_EditableSource src;               /* Bound text of sBuf (for Shared Access) */
+	AG_EditableLines lines;              /* Display line index of sBuf */
 } AG_Editable;
 
 #define   AGEDITABLE(o)       ((AG_Editable *)(o))
@@ -287,16 +287,147 @@ FlushCache(void *_Nonnull obj)
 {
 	AG_FontFt *fontFt = obj;
 	const int size = sizeof(fontFt->cache) / sizeof(fontFt->cache[0]);
+	AG_GlyphFt *G, *Gnext;
 	int i;
 
 	for (i = 0; i < size; i++) {
-		AG_GlyphFt *G = &fontFt->cache[i];
-
+		G = &fontFt->cache[i];
 		if (G->cached)
 			FlushGlyph(G);
 	}
-	if (fontFt->scratch.cached)
-		FlushGlyph(&fontFt->scratch);
+	for (G = TAILQ_FIRST(&fontFt->glyphLRU);
+	     G != TAILQ_END(&fontFt->glyphLRU);
+	     G = Gnext) {
+		Gnext = TAILQ_NEXT(G, lru);
+		FlushGlyph(G);
+		free(G);
+	}
+	TAILQ_INIT(&fontFt->glyphLRU);
+	if (fontFt->glyphTbl != NULL) {
+		memset(fontFt->glyphTbl, 0,
+		    fontFt->glyphTblSize * sizeof(AG_GlyphFt *));
+	}
+	fontFt->nGlyphs = 0;
+	fontFt->glyphBytes = 0;
+}
+
+static __inline__ Uint _Const_Attribute
+HashGlyph(AG_Char ch, Uint tblSize)
+{
+	return (((Uint32)ch * 2654435761U) >> 8) & (tblSize - 1);
+}
+
+/* Memory used by a hashed glyph entry. */
+static AG_Size
+GlyphBytes(const AG_GlyphFt *_Nonnull G)
+{
+	AG_Size nBytes = sizeof(AG_GlyphFt);
+
+	if (G->bitmap.buffer != NULL)
+		nBytes += G->bitmap.pitch * G->bitmap.rows;
+	if (G->pixmap.buffer != NULL)
+		nBytes += G->pixmap.pitch * G->pixmap.rows;
+
+	return (nBytes);
+}
+
+/* Double the size of the glyph hash table. */
+static void
+GrowGlyphTable(AG_FontFt *_Nonnull fontFt)
+{
+	AG_GlyphFt **tblNew, *G;
+	const Uint sizeNew = (fontFt->glyphTblSize > 0) ?
+	                     (fontFt->glyphTblSize << 1) : 64;
+
+	if ((tblNew = TryMalloc(sizeNew * sizeof(AG_GlyphFt *))) == NULL) {
+		return;
+	}
+	memset(tblNew, 0, sizeNew * sizeof(AG_GlyphFt *));
+	TAILQ_FOREACH(G, &fontFt->glyphLRU, lru) {
+		const Uint h = HashGlyph(G->cached, sizeNew);
+
+		G->hNext = tblNew[h];
+		tblNew[h] = G;
+	}
+	Free(fontFt->glyphTbl);
+	fontFt->glyphTbl = tblNew;
+	fontFt->glyphTblSize = sizeNew;
+}
+
+/* Remove a hashed glyph from the cache and free it. */
+static void
+EvictGlyph(AG_FontFt *_Nonnull fontFt, AG_GlyphFt *_Nonnull G)
+{
+	AG_GlyphFt **pG;
+
+	pG = &fontFt->glyphTbl[HashGlyph(G->cached, fontFt->glyphTblSize)];
+	while (*pG != G) {
+		pG = &(*pG)->hNext;
+	}
+	*pG = G->hNext;
+	TAILQ_REMOVE(&fontFt->glyphLRU, G, lru);
+	fontFt->glyphBytes -= GlyphBytes(G);
+	fontFt->nGlyphs--;
+	FlushGlyph(G);
+	free(G);
+}
+
+/*
+ * Return the cache entry for a character outside of Latin-1, creating it
+ * if needed. Return NULL on allocation failure.
+ */
+static AG_GlyphFt *_Nullable
+LookupGlyph(AG_FontFt *_Nonnull fontFt, AG_Char ch)
+{
+	AG_GlyphFt *G;
+	Uint h;
+
+	if (fontFt->glyphTbl != NULL) {
+		h = HashGlyph(ch, fontFt->glyphTblSize);
+		for (G = fontFt->glyphTbl[h]; G != NULL; G = G->hNext) {
+			if (G->cached == ch)
+				break;
+		}
+		if (G != NULL) {
+			if (G != TAILQ_FIRST(&fontFt->glyphLRU)) {
+				TAILQ_REMOVE(&fontFt->glyphLRU, G, lru);
+				TAILQ_INSERT_HEAD(&fontFt->glyphLRU, G, lru);
+			}
+			return (G);
+		}
+	}
+	if (fontFt->nGlyphs >= fontFt->glyphTblSize) {
+		GrowGlyphTable(fontFt);
+		if (fontFt->glyphTbl == NULL)
+			return (NULL);
+	}
+	if ((G = TryMalloc(sizeof(AG_GlyphFt))) == NULL) {
+		return (NULL);
+	}
+	memset(G, 0, sizeof(AG_GlyphFt));
+	G->cached = ch;
+	h = HashGlyph(ch, fontFt->glyphTblSize);
+	G->hNext = fontFt->glyphTbl[h];
+	fontFt->glyphTbl[h] = G;
+	TAILQ_INSERT_HEAD(&fontFt->glyphLRU, G, lru);
+	fontFt->nGlyphs++;
+	fontFt->glyphBytes += sizeof(AG_GlyphFt);
+	return (G);
+}
+
+/*
+ * Evict least recently used glyphs (other than G) until the glyph table
+ * fits in AG_FONTFT_GLYPH_CACHE_MAX bytes.
+ */
+static void
+ExpireGlyphs(AG_FontFt *_Nonnull fontFt, const AG_GlyphFt *_Nonnull G)
+{
+	AG_GlyphFt *Glast;
+
+	while (fontFt->glyphBytes > AG_FONTFT_GLYPH_CACHE_MAX &&
+	       (Glast = TAILQ_LAST(&fontFt->glyphLRU, ag_glyph_ftq)) != NULL &&
+	       Glast != G)
+		EvictGlyph(fontFt, Glast);
 }
 
 static void
@@ -305,6 +436,9 @@ Close(void *_Nonnull obj)
 	AG_FontFt *fontFt = obj;
 
 	FlushCache(fontFt);
+	Free(fontFt->glyphTbl);
+	fontFt->glyphTbl = NULL;
+	fontFt->glyphTblSize = 0;
 	FT_Done_Face(fontFt->face);
 
 	if (--agFtInited == 0) {
@@ -363,6 +497,8 @@ GetGlyph(void *_Nonnull obj, AG_Char ch, Uint want)
 	FT_GlyphSlot Gslot;
 	FT_Glyph_Metrics *Gmetrics;
 	FT_Error rv;
+	AG_Size nBytesPrev;
+	int hashed = 0;
 
 #ifdef AG_UNICODE
 	if (ch < 256) {
@@ -371,16 +507,19 @@ GetGlyph(void *_Nonnull obj, AG_Char ch, Uint want)
 #endif
 		fontFt->current = &fontFt->cache[ch];
 	} else {
-		if (fontFt->scratch.cached != ch) {
-			FlushGlyph(&fontFt->scratch);
+		if ((G = LookupGlyph(fontFt, ch)) == NULL) {
+			return (NULL);
 		}
-		fontFt->current = &fontFt->scratch;
+		fontFt->current = G;
+		hashed = 1;
 	}
 	G = fontFt->current;
 
 	if ((G->stored & want) == want) 
 		return (void *)(G);
 
+	nBytesPrev = GlyphBytes(G);
+
 	if (G->index == 0) {
 		G->index = FT_Get_Char_Index(face, ch);
 	}
@@ -500,6 +639,11 @@ GetGlyph(void *_Nonnull obj, AG_Char ch, Uint want)
 		}
 	}
 	G->cached = ch;                           /* Mark this glyph cached */
+
+	if (hashed) {
+		fontFt->glyphBytes += GlyphBytes(G) - nBytesPrev;
+		ExpireGlyphs(fontFt, G);
+	}
 	return (G);
 }
 
@@ -921,8 +1065,12 @@ Init(void *_Nonnull obj)
 
 	memset(&font->current, 0, sizeof(AG_GlyphFt *) +   /* current */
 	                          sizeof(AG_GlyphFt)*256 + /* cache */
-	                          sizeof(AG_GlyphFt) +     /* scratch */
-	                          sizeof(int));            /* fixedSize */
+	                          sizeof(int) +            /* fixedSize */
+	                          sizeof(Uint));           /* nGlyphs */
+	font->glyphTbl = NULL;
+	font->glyphTblSize = 0;
+	font->glyphBytes = 0;
+	TAILQ_INIT(&font->glyphLRU);
 }
 
 AG_FontClass agFontFtClass = {
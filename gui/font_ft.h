@@ -27,17 +27,27 @@ typedef struct ag_glyph_ft {
 	int advance;                   /* Horizontal advance */
 	AG_Char cached;                /* Cached character */
 	AG_CHAR_PADDING(_pad);
+	struct ag_glyph_ft *_Nullable hNext;  /* In glyph hash chain */
+	AG_TAILQ_ENTRY(ag_glyph_ft) lru;      /* In LRU list */
 } AG_GlyphFt;
 
+#ifndef AG_FONTFT_GLYPH_CACHE_MAX
+#define AG_FONTFT_GLYPH_CACHE_MAX (2*1024*1024) /* Max bytes in glyph table */
+#endif
+
 /* FreeType font */
 typedef struct ag_font_ft {
 	AG_Font _inherit;              /* AG_Font -> AG_FontFt */
 	_Nonnull FT_Face face;         /* Typographical font face handle */
 	AG_GlyphFt *_Nonnull current;
-	AG_GlyphFt cache[256];         /* Transform cache */
-	AG_GlyphFt scratch;
+	AG_GlyphFt cache[256];         /* Transform cache (Latin-1) */
 	int fixedSize;                 /* For non-scalable formats */
+	Uint nGlyphs;                  /* Glyphs in glyphTbl */
+	AG_GlyphFt *_Nullable *_Nullable glyphTbl; /* Glyphs >= 256 (hashed) */
+	Uint glyphTblSize;             /* Size of glyphTbl (power of 2) */
 	Uint32 _pad;
+	AG_Size glyphBytes;            /* Memory used by glyphTbl entries */
+	AG_TAILQ_HEAD(ag_glyph_ftq,ag_glyph_ft) glyphLRU; /* MRU first */
 } AG_FontFt;
 
 #define   AGFONTFT(o)      ((AG_FontFt *)(o))
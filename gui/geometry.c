@@ -216,6 +216,32 @@ AG_RectIntersect2(AG_Rect2 *rd, const AG_Rect2 *a, const AG_Rect2 *b)
 	return (r.w > 0 && r.h > 0);
 }
 
+/*
+ * Return the smallest Rect2 enclosing two Rect2's. A rectangle with zero
+ * or negative width or height is considered empty.
+ */
+void
+AG_RectUnion2(AG_Rect2 *rd, const AG_Rect2 *a, const AG_Rect2 *b)
+{
+	AG_Rect2 r;
+
+	if (a->w <= 0 || a->h <= 0) {
+		*rd = *b;
+		return;
+	}
+	if (b->w <= 0 || b->h <= 0) {
+		*rd = *a;
+		return;
+	}
+	r.x1 = AG_MIN(a->x1, b->x1);
+	r.y1 = AG_MIN(a->y1, b->y1);
+	r.x2 = AG_MAX(a->x2, b->x2);
+	r.y2 = AG_MAX(a->y2, b->y2);
+	r.w = r.x2 - r.x1;
+	r.h = r.y2 - r.y1;
+	*rd = r;
+}
+
 /* Test whether two Rect's are the same. */
 int
 AG_RectCompare(const AG_Rect *a, const AG_Rect *b)
@@ -65,6 +65,10 @@ int AG_RectIntersect2(AG_Rect2 *_Nonnull,
                       const AG_Rect2 *_Nonnull,
                       const AG_Rect2 *_Nonnull);
 
+void AG_RectUnion2(AG_Rect2 *_Nonnull,
+                   const AG_Rect2 *_Nonnull,
+                   const AG_Rect2 *_Nonnull);
+
 int AG_RectCompare(const AG_Rect *_Nonnull,
                    const AG_Rect *_Nonnull)
                   _Pure_Attribute;
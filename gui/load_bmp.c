@@ -92,15 +92,15 @@ AG_SurfaceFromBMP(const char *_Nonnull path)
 	AG_DataSource *ds;
 	AG_Surface *S;
 
-	if ((ds = AG_OpenFile(path, "rb")) == NULL) {
+	if ((ds = AG_OpenMappedFile(path, AG_MAPPED_SEQUENTIAL)) == NULL) {
 		return (NULL);
 	}
 	if ((S = AG_ReadSurfaceFromBMP(ds)) == NULL) {
 		AG_SetError("%s: %s", path, AG_GetError());
-		AG_CloseFile(ds);
+		AG_CloseMappedFile(ds);
 		return (NULL);
 	}
-	AG_CloseFile(ds);
+	AG_CloseMappedFile(ds);
 	return (S);
 }
 
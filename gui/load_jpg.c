@@ -62,8 +62,16 @@ static boolean
 AG_JPG_FillInputBuffer(j_decompress_ptr cinfo)
 {
 	struct ag_jpg_sourcemgr *sm = (struct ag_jpg_sourcemgr *)cinfo->src;
+	const Uint8 *p;
 	AG_Size rv;
 
+	if (sm->ds->borrow != NULL &&
+	    (p = AG_BorrowDataP(sm->ds, ~(AG_Size)0, &rv)) != NULL && rv > 0) {
+		/* Decode memory-backed sources in place. */
+		sm->pub.next_input_byte = p;
+		sm->pub.bytes_in_buffer = rv;
+		return (TRUE);
+	}
 	if (AG_ReadP(sm->ds, sm->buffer, sizeof(sm->buffer), &rv) == -1) {
 		return (FALSE);
 	}
@@ -114,15 +122,15 @@ AG_SurfaceFromJPEG(const char *_Nonnull path)
 	AG_DataSource *ds;
 	AG_Surface *s;
 
-	if ((ds = AG_OpenFile(path, "rb")) == NULL) {
+	if ((ds = AG_OpenMappedFile(path, AG_MAPPED_SEQUENTIAL)) == NULL) {
 		return (NULL);
 	}
 	if ((s = AG_ReadSurfaceFromJPEG(ds)) == NULL) {
 		AG_SetError("%s: %s", path, AG_GetError());
-		AG_CloseFile(ds);
+		AG_CloseMappedFile(ds);
 		return (NULL);
 	}
-	AG_CloseFile(ds);
+	AG_CloseMappedFile(ds);
 	return (s);
 }
 
@@ -47,15 +47,15 @@ AG_SurfaceFromPNG(const char *path)
 	AG_DataSource *ds;
 	AG_Surface *s;
 
-	if ((ds = AG_OpenFile(path, "rb")) == NULL) {
+	if ((ds = AG_OpenMappedFile(path, AG_MAPPED_SEQUENTIAL)) == NULL) {
 		return (NULL);
 	}
 	if ((s = AG_ReadSurfaceFromPNG(ds)) == NULL) {
 		AG_SetError("%s: %s", path, AG_GetError());
-		AG_CloseFile(ds);
+		AG_CloseMappedFile(ds);
 		return (NULL);
 	}
-	AG_CloseFile(ds);
+	AG_CloseMappedFile(ds);
 	return (s);
 }
 
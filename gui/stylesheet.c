@@ -37,8 +37,16 @@
 
 /* #define DEBUG_CSS */
 
+#ifndef AG_STYLE_MEMO_MAX
+#define AG_STYLE_MEMO_MAX 4096		/* Flush memoized matches beyond */
+#endif
+
 AG_StyleSheet agDefaultCSS;
 
+#ifdef AG_THREADS
+static AG_Mutex agStyleMemoLock = AG_MUTEX_INITIALIZER;
+#endif
+
 AG_StaticCSS *agBuiltinStyles[] = {
 	&agStyleDefault
 };
@@ -49,6 +57,220 @@ AG_InitStyleSheet(AG_StyleSheet *css)
 {
 	TAILQ_INIT(&css->blks);
 	TAILQ_INIT(&css->blksCond);
+	css->selTbl = NULL;
+	css->nSelTbl = 0;
+	css->nPats = 0;
+	css->pats = NULL;
+	css->keyTbl = NULL;
+	css->nKeyTbl = 0;
+	css->nKeys = 0;
+	css->memoTbl = NULL;
+	css->nMemoTbl = 0;
+	css->nMemos = 0;
+}
+
+/* FNV-1a hash of a string (continuing from h). */
+static __inline__ Uint32
+HashStr(Uint32 h, const char *_Nonnull s)
+{
+	const Uint8 *c;
+
+	for (c = (const Uint8 *)s; *c != '\0'; c++) {
+		h ^= *c;
+		h *= 16777619;
+	}
+	return (h);
+}
+
+/* Hash a selector of the given type in the selector table. */
+static __inline__ Uint32
+HashSelector(enum ag_style_selector_type sel, const char *_Nonnull e,
+    const char *_Nonnull f)
+{
+	Uint32 h = 2166136261u;
+
+	h ^= (Uint32)sel;
+	h *= 16777619;
+	h = HashStr(h, e);
+	h ^= '>';
+	h *= 16777619;
+	return HashStr(h, f);
+}
+
+static __inline__ Uint32
+HashMemo(const AG_ObjectClass *_Nonnull cls,
+    const AG_ObjectClass *_Nullable clsParent, int zoom)
+{
+	AG_Size h;
+
+	h = (AG_Size)cls ^ ((AG_Size)clsParent * 31) ^ ((AG_Size)zoom << 8);
+	return (Uint32)(h ^ (h >> 7) ^ (h >> 17));
+}
+
+/* Release the memoized matches of a style sheet. */
+static void
+ClearMemos(AG_StyleSheet *_Nonnull css)
+{
+	AG_StyleMemo *memo, *memoNext;
+	Uint i;
+
+	for (i = 0; css->memoTbl != NULL && i < css->nMemoTbl; i++) {
+		for (memo = css->memoTbl[i]; memo != NULL; memo = memoNext) {
+			memoNext = memo->next;
+			free(memo);
+		}
+		css->memoTbl[i] = NULL;
+	}
+	css->nMemos = 0;
+}
+
+/* Release the compiled tables of a style sheet. */
+static void
+FreeCompiled(AG_StyleSheet *_Nonnull css)
+{
+	AG_StyleKey *key, *keyNext;
+	Uint i;
+
+	ClearMemos(css);
+	free(css->memoTbl);
+	css->memoTbl = NULL;
+	css->nMemoTbl = 0;
+
+	for (i = 0; css->keyTbl != NULL && i < css->nKeyTbl; i++) {
+		for (key = css->keyTbl[i]; key != NULL; key = keyNext) {
+			keyNext = key->next;
+			free(key);
+		}
+	}
+	free(css->keyTbl);
+	css->keyTbl = NULL;
+	css->nKeyTbl = 0;
+	css->nKeys = 0;
+
+	free(css->selTbl);
+	css->selTbl = NULL;
+	css->nSelTbl = 0;
+	free(css->pats);
+	css->pats = NULL;
+	css->nPats = 0;
+}
+
+/* Look up an interned property key. */
+static __inline__ const AG_StyleKey *
+LookupKey(const AG_StyleSheet *_Nonnull css, const char *_Nonnull name)
+{
+	const Uint32 h = HashStr(2166136261u, name);
+	const AG_StyleKey *key;
+
+	if (css->nKeyTbl == 0) {
+		return (NULL);
+	}
+	for (key = css->keyTbl[h & (css->nKeyTbl - 1)];
+	     key != NULL;
+	     key = key->next) {
+		if (key->hash == h && strcmp(key->name, name) == 0)
+			return (key);
+	}
+	return (NULL);
+}
+
+/*
+ * Compile a parsed style sheet: number its blocks, index them by selector
+ * and intern the property keys of their entries.
+ */
+static int
+CompileStyleSheet(AG_StyleSheet *_Nonnull css)
+{
+	AG_StyleBlock *blk;
+	AG_StyleEntry *ent;
+	Uint nBlks = 0, nEnts = 0, seq;
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		seq = 0;
+		for (blk = (i == 0) ? TAILQ_FIRST(&css->blksCond) :
+		                      TAILQ_FIRST(&css->blks);
+		     blk != NULL;
+		     blk = TAILQ_NEXT(blk, blks)) {
+			blk->seq = seq++;
+			if (blk->selector == AG_SELECTOR_CLASS_PATTERN) {
+				css->nPats++;
+			}
+			TAILQ_FOREACH(ent, &blk->ents, ents) {
+				nEnts++;
+			}
+			nBlks++;
+		}
+	}
+	for (css->nSelTbl = 16; css->nSelTbl < nBlks*2; css->nSelTbl <<= 1)
+		;
+	for (css->nKeyTbl = 16; css->nKeyTbl < nEnts; css->nKeyTbl <<= 1)
+		;
+	css->nMemoTbl = 64;
+
+	css->selTbl = TryMalloc(css->nSelTbl * sizeof(AG_StyleBlock *));
+	css->keyTbl = TryMalloc(css->nKeyTbl * sizeof(AG_StyleKey *));
+	css->memoTbl = TryMalloc(css->nMemoTbl * sizeof(AG_StyleMemo *));
+	if (css->nPats > 0) {
+		css->pats = TryMalloc(css->nPats * sizeof(AG_StyleBlock *));
+	}
+	if (css->selTbl == NULL || css->keyTbl == NULL ||
+	    css->memoTbl == NULL || (css->nPats > 0 && css->pats == NULL)) {
+		goto fail;
+	}
+	memset(css->selTbl, 0, css->nSelTbl * sizeof(AG_StyleBlock *));
+	memset(css->keyTbl, 0, css->nKeyTbl * sizeof(AG_StyleKey *));
+	memset(css->memoTbl, 0, css->nMemoTbl * sizeof(AG_StyleMemo *));
+	css->nPats = 0;
+
+	/*
+	 * Insert at the tail of the chains so that blocks sharing a selector
+	 * appear in order of precedence.
+	 */
+	for (i = 0; i < 2; i++) {
+		for (blk = (i == 0) ? TAILQ_FIRST(&css->blksCond) :
+		                      TAILQ_FIRST(&css->blks);
+		     blk != NULL;
+		     blk = TAILQ_NEXT(blk, blks)) {
+			AG_StyleBlock **pBlk;
+
+			if (blk->selector == AG_SELECTOR_CLASS_PATTERN) {
+				css->pats[css->nPats++] = blk;
+			} else {
+				pBlk = &css->selTbl[HashSelector(blk->selector,
+				    blk->e, blk->f) & (css->nSelTbl - 1)];
+				while (*pBlk != NULL) {
+					pBlk = &(*pBlk)->hNext;
+				}
+				*pBlk = blk;
+			}
+			blk->hNext = NULL;
+
+			TAILQ_FOREACH(ent, &blk->ents, ents) {
+				const Uint32 h = HashStr(2166136261u, ent->key);
+				const AG_StyleKey *keyFound;
+				AG_StyleKey *key;
+
+				if ((keyFound = LookupKey(css, ent->key)) != NULL) {
+					ent->keyID = keyFound->id;
+					continue;
+				}
+				if ((key = TryMalloc(sizeof(AG_StyleKey))) == NULL) {
+					goto fail;
+				}
+				key->name = ent->key;
+				key->hash = h;
+				key->id = css->nKeys++;
+				key->next = css->keyTbl[h & (css->nKeyTbl - 1)];
+				css->keyTbl[h & (css->nKeyTbl - 1)] = key;
+				ent->keyID = key->id;
+			}
+		}
+	}
+	return (0);
+fail:
+	FreeCompiled(css);
+	return (-1);
 }
 
 static __inline__ void
@@ -70,6 +292,10 @@ AG_DestroyStyleSheet(AG_StyleSheet *css)
 {
 	AG_StyleBlock *blk, *blkNext;
 
+	AG_MutexLock(&agStyleMemoLock);
+	FreeCompiled(css);
+	AG_MutexUnlock(&agStyleMemoLock);
+
 	for (blk = TAILQ_FIRST(&css->blksCond);
 	     blk != TAILQ_END(&css->blksCond);
 	     blk = blkNext) {
@@ -257,6 +483,7 @@ AG_LoadStyleSheet(void *obj, const char *path)
 
 			if ((blk = TryMalloc(sizeof(AG_StyleBlock))) == NULL)
 				goto fail_parse;
+			blk->f[0] = '\0';
 
 			if ((cond = strchr(c, '(')) != NULL) {
 				++cond;
@@ -381,6 +608,12 @@ AG_LoadStyleSheet(void *obj, const char *path)
 	}
 
 	free(buf);
+
+	if (CompileStyleSheet(css) == -1) {
+		AG_DestroyStyleSheet(css);
+		if (css != &agDefaultCSS) { free(css); }
+		return (NULL);
+	}
 	return (css);
 fail_close:
 	AG_CloseFile(ds);
@@ -416,157 +649,287 @@ TestSelectorCondition(AG_StyleBlock *blk, void *obj)
 }
 
 /*
- * Search a style sheet for an attribute "key" applicable to widget obj
- * (given its current geometry and the zoom level of its parent window).
- *
- * Returns a pointer to a read-only (internally-managed) string into rv.
- * Return 1 on success or 0 if the attribute was not found. A pointer may
- * be written to rv even in the case of an unsuccessful lookup.
+ * Return the first block (in order of precedence) of one of the hashed
+ * selector chains which matches (sel, e, f) and satisfies its condition.
+ * Set *dynamic if a candidate depends on the geometry of the widget.
  */
-int
-AG_LookupStyleSheet(AG_StyleSheet *_Nonnull css, void *_Nonnull obj,
-    const char *_Nonnull key, char *_Nonnull *_Nonnull rv)
+static AG_StyleBlock *
+MatchSelector(const AG_StyleSheet *_Nonnull css, void *_Nonnull obj,
+    enum ag_style_selector_type sel, const char *_Nonnull e,
+    const char *_Nonnull f, int cond, AG_StyleBlock *_Nullable best,
+    int *_Nonnull dynamic)
 {
-	AG_ObjectClass **hier;
 	AG_StyleBlock *blk;
-	AG_StyleEntry *ent;
-	const char *clName;
-	const AG_Object *parent = OBJECT(obj)->parent;
-	int nHier;
-
-	if (AG_ObjectGetInheritHier(obj, &hier, &nHier) != 0) {
-		return (0);
+	const Uint32 h = HashSelector(sel, e, f);
+
+	for (blk = css->selTbl[h & (css->nSelTbl - 1)];
+	     blk != NULL;
+	     blk = blk->hNext) {
+		if (blk->selector != sel ||
+		    (blk->cond != AG_SELECTOR_COND_NONE) != cond ||
+		    (best != NULL && blk->seq > best->seq) ||
+		    strcmp(blk->e, e) != 0 ||
+		    strcmp(blk->f, f) != 0) {
+			continue;
+		}
+		if (blk->cond == AG_SELECTOR_COND_WIDTH ||
+		    blk->cond == AG_SELECTOR_COND_HEIGHT) {
+			*dynamic = 1;
+		}
+		if (cond && !TestSelectorCondition(blk, obj)) {
+			continue;
+		}
+		return (blk);
 	}
-	clName = hier[nHier - 1]->name;
+	return (best);
+}
 
-	/* Conditional Selector `E > F' */
-	TAILQ_FOREACH(blk, &css->blksCond, blks) {
-		if (blk->selector == AG_SELECTOR_CHILD_NAMED) {
-			if (parent == NULL) {
-				continue;
-			}
-			if (strcmp(blk->f, OBJECT(obj)->name) == 0 &&
-			    strcmp(blk->e, AGOBJECT_CLASS(parent)->name) == 0 &&
-			    TestSelectorCondition(blk, obj)) {
-				break;
-			}
-		} else if (blk->selector == AG_SELECTOR_CHILD_OF_CLASS) {
-			if (parent == NULL) {
-				continue;
-			}
-			if (strcmp(blk->f, AGOBJECT_CLASS(obj)->name) == 0 &&
-			    strcmp(blk->e, AGOBJECT_CLASS(parent)->name) == 0 &&
-			    TestSelectorCondition(blk, obj)) {
-				break;
-			}
+/*
+ * Return the first `E' block (by class name or pattern) matching the class
+ * of obj and satisfying its condition.
+ */
+static AG_StyleBlock *
+MatchClass(const AG_StyleSheet *_Nonnull css, void *_Nonnull obj, int cond,
+    int *_Nonnull dynamic)
+{
+	AG_StyleBlock *best;
+	Uint i;
+
+	best = MatchSelector(css, obj, AG_SELECTOR_CLASS_NAME,
+	    AGOBJECT_CLASS(obj)->name, "", cond, NULL, dynamic);
+
+	for (i = 0; i < css->nPats; i++) {
+		AG_StyleBlock *blk = css->pats[i];
+
+		if ((blk->cond != AG_SELECTOR_COND_NONE) != cond ||
+		    (best != NULL && blk->seq > best->seq) ||
+		    !AG_OfClass(obj, blk->e)) {
+			continue;
 		}
-	}
-	if (blk != NULL) {
-#ifdef DEBUG_CSS
-		Debug(obj, "CSS (%s > %s) Cond#%d (%d - %d)\n",
-		    blk->e, blk->f, blk->cond, blk->x, blk->y);
-#endif
-		TAILQ_FOREACH(ent, &blk->ents, ents) {
-			if (strcmp(ent->key, key) == 0) {
-				*rv = ent->value;
-				break;
-			}
+		if (blk->cond == AG_SELECTOR_COND_WIDTH ||
+		    blk->cond == AG_SELECTOR_COND_HEIGHT) {
+			*dynamic = 1;
 		}
-		if (ent != NULL) {
-			goto out;                            /* Match found */
-		} else {
-			goto match_uncond_EF;
+		if (cond && !TestSelectorCondition(blk, obj)) {
+			continue;
 		}
+		best = blk;
 	}
+	return (best);
+}
 
-	/* Conditional Selector `E' */
-	TAILQ_FOREACH(blk, &css->blksCond, blks) {
-		if (blk->selector == AG_SELECTOR_CLASS_NAME) {
-			if (strcmp(blk->e, clName) == 0 &&
-			    TestSelectorCondition(blk, obj)) {
-				break;
-			}
-		} else if (blk->selector == AG_SELECTOR_CLASS_PATTERN) {
-			if (AG_OfClass(obj, blk->e) &&
-			    TestSelectorCondition(blk, obj)) {
-				break;
-			}
+/*
+ * Return the first `E > F' block (by child name or child class) matching
+ * obj under its parent and satisfying its condition.
+ */
+static AG_StyleBlock *
+MatchChild(const AG_StyleSheet *_Nonnull css, void *_Nonnull obj, int cond,
+    int *_Nonnull dynamic)
+{
+	const AG_Object *parent = OBJECT(obj)->parent;
+	AG_StyleBlock *best;
+
+	if (parent == NULL) {
+		return (NULL);
+	}
+	best = MatchSelector(css, obj, AG_SELECTOR_CHILD_NAMED,
+	    AGOBJECT_CLASS(parent)->name, OBJECT(obj)->name, cond, NULL,
+	    dynamic);
+	return MatchSelector(css, obj, AG_SELECTOR_CHILD_OF_CLASS,
+	    AGOBJECT_CLASS(parent)->name, AGOBJECT_CLASS(obj)->name, cond,
+	    best, dynamic);
+}
+
+/*
+ * Return 1 if the style sheet has any `E > "F"' selectors under a parent
+ * of the given class (in which case matches depend on the object name).
+ */
+static int
+HasNamedChildren(const AG_StyleSheet *_Nonnull css,
+    const AG_ObjectClass *_Nonnull clsParent)
+{
+	const AG_StyleBlock *blk;
+	Uint i;
+
+	for (i = 0; i < css->nSelTbl; i++) {
+		for (blk = css->selTbl[i]; blk != NULL; blk = blk->hNext) {
+			if (blk->selector == AG_SELECTOR_CHILD_NAMED &&
+			    strcmp(blk->e, clsParent->name) == 0)
+				return (1);
 		}
 	}
-	if (blk != NULL) {
+	return (0);
+}
+
+/* Evaluate the selectors of a compiled style sheet against widget obj. */
+static void
+ComputeMatch(const AG_StyleSheet *_Nonnull css, void *_Nonnull obj,
+    AG_StyleBlock *_Nullable blk[AG_STYLE_MATCH_LAST], int *_Nonnull dynamic)
+{
+	blk[AG_STYLE_MATCH_COND_EF] = MatchChild(css, obj, 1, dynamic);
+	blk[AG_STYLE_MATCH_COND_E] = MatchClass(css, obj, 1, dynamic);
+	blk[AG_STYLE_MATCH_EF] = MatchChild(css, obj, 0, dynamic);
+	blk[AG_STYLE_MATCH_E] = MatchClass(css, obj, 0, dynamic);
 #ifdef DEBUG_CSS
+	if (blk[AG_STYLE_MATCH_COND_EF] != NULL)
+		Debug(obj, "CSS (%s > %s) Cond#%d (%d - %d)\n",
+		    blk[AG_STYLE_MATCH_COND_EF]->e,
+		    blk[AG_STYLE_MATCH_COND_EF]->f,
+		    blk[AG_STYLE_MATCH_COND_EF]->cond,
+		    blk[AG_STYLE_MATCH_COND_EF]->x,
+		    blk[AG_STYLE_MATCH_COND_EF]->y);
+	if (blk[AG_STYLE_MATCH_COND_E] != NULL)
 		Debug(obj, "CSS (%s) Cond#%d (%d - %d)\n",
-		    blk->e, blk->cond, blk->x, blk->y);
+		    blk[AG_STYLE_MATCH_COND_E]->e,
+		    blk[AG_STYLE_MATCH_COND_E]->cond,
+		    blk[AG_STYLE_MATCH_COND_E]->x,
+		    blk[AG_STYLE_MATCH_COND_E]->y);
 #endif
-		TAILQ_FOREACH(ent, &blk->ents, ents) {
-			if (strcmp(ent->key, key) == 0) {
-				*rv = ent->value;
-				break;
-			}
-		}
-		if (ent != NULL) {
-			goto out;                            /* Match found */
-		} else {
-			goto match_uncond_E;   /* Try `E' with no condition */
-		}
-	}
+}
 
-match_uncond_EF:
-	/* Unconditional Selector `E > F' */
-	TAILQ_FOREACH(blk, &css->blks, blks) {
-		if (blk->selector == AG_SELECTOR_CHILD_NAMED) {
-			if (parent == NULL) {
-				continue;
-			}
-			if (strcmp(blk->f, OBJECT(obj)->name) == 0 &&
-			    strcmp(blk->e, AGOBJECT_CLASS(parent)->name) == 0)
-				break;
-		} else if (blk->selector == AG_SELECTOR_CHILD_OF_CLASS) {
-			if (parent == NULL) {
-				continue;
-			}
-			if (strcmp(blk->f, AGOBJECT_CLASS(obj)->name) == 0 &&
-			    strcmp(blk->e, AGOBJECT_CLASS(parent)->name) == 0)
-				break;
-		}
+/*
+ * Evaluate the selectors of a style sheet against widget obj (given its
+ * current geometry and the zoom level of its parent window), returning
+ * the matching blocks into m for use with AG_LookupStyleMatch().
+ *
+ * Matches which depend only on the class of obj, the class of its parent
+ * and the zoom level are memoized, so that similar widgets share them.
+ */
+void
+AG_MatchStyleSheet(AG_StyleSheet *css, void *obj, AG_StyleMatch *m)
+{
+	const AG_ObjectClass *cls = AGOBJECT_CLASS(obj);
+	const AG_ObjectClass *clsParent;
+	AG_StyleMemo *memo;
+	const int zoom = (WIDGET(obj)->window != NULL) ?
+	                 WIDGET(obj)->window->zoom : -1;
+	Uint32 h;
+	int i, dynamic = 0;
+
+	m->css = css;
+	if (css->nSelTbl == 0) {				/* Empty */
+		for (i = 0; i < AG_STYLE_MATCH_LAST; i++) {
+			m->blk[i] = NULL;
+		}
+		return;
 	}
-	if (blk != NULL) {
-		TAILQ_FOREACH(ent, &blk->ents, ents) {
-			if (strcmp(ent->key, key) == 0) {
-				*rv = ent->value;
-				break;
-			}
-		}
-		if (ent != NULL)
-			goto out;                            /* Match found */
+	clsParent = (OBJECT(obj)->parent != NULL) ?
+	            AGOBJECT_CLASS(OBJECT(obj)->parent) : NULL;
+	h = HashMemo(cls, clsParent, zoom) & (css->nMemoTbl - 1);
+
+	AG_MutexLock(&agStyleMemoLock);
+	for (memo = css->memoTbl[h]; memo != NULL; memo = memo->next) {
+		if (memo->cls == cls && memo->clsParent == clsParent &&
+		    memo->zoom == zoom)
+			break;
+	}
+	if (memo != NULL) {
+		if (!(memo->flags & AG_STYLE_MEMO_VOLATILE)) {
+			memcpy(m->blk, memo->blk, sizeof(m->blk));
+			AG_MutexUnlock(&agStyleMemoLock);
+			return;
+		}
+		ComputeMatch(css, obj, m->blk, &dynamic);
+		AG_MutexUnlock(&agStyleMemoLock);
+		return;
 	}
+	ComputeMatch(css, obj, m->blk, &dynamic);
 
-match_uncond_E:
-	/* Unconditional Selector `E' */
-	TAILQ_FOREACH(blk, &css->blks, blks) {
-		if (blk->selector == AG_SELECTOR_CLASS_NAME) {
-			if (strcmp(blk->e, clName) == 0)
-				break;
-		} else if (blk->selector == AG_SELECTOR_CLASS_PATTERN) {
-			if (AG_OfClass(obj, blk->e))
-				break;
-		}
+	if (clsParent != NULL && HasNamedChildren(css, clsParent)) {
+		dynamic = 1;
 	}
- 	if (blk == NULL) {
-		goto fail;
+	if (css->nMemos >= AG_STYLE_MEMO_MAX) {
+		ClearMemos(css);
+	}
+	if ((memo = TryMalloc(sizeof(AG_StyleMemo))) != NULL) {
+		memo->cls = cls;
+		memo->clsParent = clsParent;
+		memo->zoom = zoom;
+		memo->flags = (dynamic) ? AG_STYLE_MEMO_VOLATILE : 0;
+		memcpy(memo->blk, m->blk, sizeof(memo->blk));
+		memo->next = css->memoTbl[h];
+		css->memoTbl[h] = memo;
+		css->nMemos++;
 	}
+	AG_MutexUnlock(&agStyleMemoLock);
+}
+
+/* Search a style block for an entry of the given (interned) key. */
+static __inline__ AG_StyleEntry *
+LookupEntry(const AG_StyleBlock *_Nonnull blk, Uint keyID)
+{
+	AG_StyleEntry *ent;
+
 	TAILQ_FOREACH(ent, &blk->ents, ents) {
-		if (strcmp(ent->key, key) == 0) {
-			*rv = ent->value;
-			break;
-		}
+		if (ent->keyID == keyID)
+			return (ent);
 	}
-	if (ent == NULL)
-		goto fail;
+	return (NULL);
+}
+
+/*
+ * Search the blocks of a match returned by AG_MatchStyleSheet() for an
+ * attribute "key".
+ *
+ * Returns a pointer to a read-only (internally-managed) string into rv.
+ * Return 1 on success or 0 if the attribute was not found.
+ */
+int
+AG_LookupStyleMatch(const AG_StyleMatch *m, const char *key, char **rv)
+{
+	AG_StyleBlock *const *blk = m->blk;
+	const AG_StyleKey *sk;
+	AG_StyleEntry *ent;
+
+	if (m->css == NULL || (sk = LookupKey(m->css, key)) == NULL)
+		return (0);
+
+	if (blk[AG_STYLE_MATCH_COND_EF] != NULL) {
+		if ((ent = LookupEntry(blk[AG_STYLE_MATCH_COND_EF], sk->id)))
+			goto out;
+		goto match_uncond_EF;
+	}
+	if (blk[AG_STYLE_MATCH_COND_E] != NULL) {
+		if ((ent = LookupEntry(blk[AG_STYLE_MATCH_COND_E], sk->id)))
+			goto out;
+		goto match_uncond_E;           /* Try `E' with no condition */
+	}
+match_uncond_EF:
+	if (blk[AG_STYLE_MATCH_EF] != NULL &&
+	    (ent = LookupEntry(blk[AG_STYLE_MATCH_EF], sk->id)) != NULL)
+		goto out;
+match_uncond_E:
+	if (blk[AG_STYLE_MATCH_E] != NULL &&
+	    (ent = LookupEntry(blk[AG_STYLE_MATCH_E], sk->id)) != NULL)
+		goto out;
+
+	return (0);
 out:
-	free(hier);
+	*rv = ent->value;
 	return (1);
-fail:
-	free(hier);
-	return (0);
+}
+
+/*
+ * Search a style sheet for an attribute "key" applicable to widget obj
+ * (given its current geometry and the zoom level of its parent window).
+ *
+ * Conditional `E > F' selectors take precedence over conditional `E'
+ * selectors, which take precedence over unconditional `E > F' and `E'
+ * selectors. Callers looking up several attributes of the same widget
+ * should use AG_MatchStyleSheet() and AG_LookupStyleMatch() instead.
+ *
+ * Returns a pointer to a read-only (internally-managed) string into rv.
+ * Return 1 on success or 0 if the attribute was not found.
+ */
+int
+AG_LookupStyleSheet(AG_StyleSheet *_Nonnull css, void *_Nonnull obj,
+    const char *_Nonnull key, char *_Nonnull *_Nonnull rv)
+{
+	AG_StyleMatch m;
+
+	if (LookupKey(css, key) == NULL) {
+		return (0);
+	}
+	AG_MatchStyleSheet(css, obj, &m);
+	return AG_LookupStyleMatch(&m, key, rv);
 }
@@ -11,6 +11,8 @@
 typedef struct ag_style_entry {
 	char key[AG_VARIABLE_NAME_MAX];  /* Target parameter */
 	char value[AG_STYLE_VALUE_MAX];  /* Set value */
+	Uint keyID;                      /* Interned key (compiled) */
+	Uint32 _pad;
 	AG_TAILQ_ENTRY(ag_style_entry) ents;
 } AG_StyleEntry;
 
@@ -39,11 +41,59 @@ typedef struct ag_style_block {
 	char f[32];                             /* Child name or class (F) */
 	AG_TAILQ_HEAD_(ag_style_entry) ents;    /* Entries in block */
 	AG_TAILQ_ENTRY(ag_style_block) blks;
+	Uint seq;                               /* Position in list (compiled) */
+	Uint32 _pad;
+	struct ag_style_block *_Nullable hNext; /* In selector table */
 } AG_StyleBlock;
 
+/* Interned property key (compiled). */
+typedef struct ag_style_key {
+	const char *_Nonnull name;              /* Key (in first entry) */
+	Uint32 hash;                            /* Hash of name */
+	Uint id;                                /* Key ID */
+	struct ag_style_key *_Nullable next;    /* In key table */
+} AG_StyleKey;
+
+/* Blocks matching a given widget, in order of precedence. */
+enum ag_style_match_type {
+	AG_STYLE_MATCH_COND_EF,                 /* Conditional `E > F' */
+	AG_STYLE_MATCH_COND_E,                  /* Conditional `E' */
+	AG_STYLE_MATCH_EF,                      /* Unconditional `E > F' */
+	AG_STYLE_MATCH_E,                       /* Unconditional `E' */
+	AG_STYLE_MATCH_LAST
+};
+
+typedef struct ag_style_match {
+	struct ag_style_sheet *_Nullable css;
+	AG_StyleBlock *_Nullable blk[AG_STYLE_MATCH_LAST];
+} AG_StyleMatch;
+
+/* Memoized match for a (class, parent class, zoom) combination. */
+typedef struct ag_style_memo {
+	const AG_ObjectClass *_Nonnull cls;       /* Class of widget */
+	const AG_ObjectClass *_Nullable clsParent; /* Class of parent */
+	int zoom;                                 /* Zoom level of window */
+	Uint flags;
+#define AG_STYLE_MEMO_VOLATILE 0x01   /* Depends on name or geometry */
+	AG_StyleBlock *_Nullable blk[AG_STYLE_MATCH_LAST];
+	struct ag_style_memo *_Nullable next;     /* In memo table */
+} AG_StyleMemo;
+
 typedef struct ag_style_sheet {
 	AG_TAILQ_HEAD_(ag_style_block) blks;     /* Blocks with no condition */
 	AG_TAILQ_HEAD_(ag_style_block) blksCond; /* Blocks with condition */
+
+	                                         /* --- Compiled --- */
+	AG_StyleBlock *_Nullable *_Nullable selTbl; /* Blocks by selector */
+	Uint nSelTbl;
+	Uint nPats;                              /* Pattern blocks */
+	AG_StyleBlock *_Nonnull *_Nullable pats;
+	AG_StyleKey *_Nullable *_Nullable keyTbl; /* Interned keys */
+	Uint nKeyTbl;
+	Uint nKeys;
+	AG_StyleMemo *_Nullable *_Nullable memoTbl; /* Memoized matches */
+	Uint nMemoTbl;
+	Uint nMemos;
 } AG_StyleSheet;
 
 /* Built-in Agar stylesheet */
@@ -69,6 +119,10 @@ AG_StyleSheet *_Nullable AG_LoadStyleSheet(void *_Nullable, const char *_Nonnull
 
 int AG_LookupStyleSheet(AG_StyleSheet *_Nonnull, void *_Nonnull,
                         const char *_Nonnull, char *_Nonnull *_Nonnull);
+void AG_MatchStyleSheet(AG_StyleSheet *_Nonnull, void *_Nonnull,
+                        AG_StyleMatch *_Nonnull);
+int AG_LookupStyleMatch(const AG_StyleMatch *_Nonnull, const char *_Nonnull,
+                        char *_Nonnull *_Nonnull);
 __END_DECLS
 
 #include <agar/gui/close.h>
@@ -1226,13 +1226,289 @@ AG_LowerBlit_Co(AG_Surface *D, const AG_Rect *rd, const AG_Surface *S,
 			}
 next_pixel:
 			pSrc += S->format.BytesPerPixel;
-			pDst += S->format.BytesPerPixel;
+			pDst += D->format.BytesPerPixel;
 		}
 		pSrc += S->padding;
 		pDst += D->padding;
 	}
 }
 
+/*
+ * Fast lower blits for 32-bit packed RGB(A) to 32-bit packed RGB(A) where
+ * source and destination share the same RGB masks and any alpha channel
+ * is in the most significant byte (e.g., the standard agSurfaceFmt).
+ *
+ * These are equivalent to the generic blitters above, except that blending
+ * is done in 8-bit precision (rounded; differs by at most 1 from the
+ * generic blitters). Row kernels are provided in SSE2 and AVX2 versions
+ * (selected at runtime by agCPU.ext per agLowerBlits_Std_Packed[]), with
+ * a scalar fallback.
+ */
+typedef struct ag_blit32 {
+	Uint32 srcOr;		/* OR'd into source (0xff000000 if no Asrc) */
+	Uint32 alphaMax;	/* 0x00ffffff | per-surface alpha << 24 */
+	Uint32 key;		/* Source colorkey */
+	Uint32 dstA;		/* Destination alpha mask (0xff000000 or 0) */
+	int keyOn;		/* Colorkey test is enabled */
+	int copy;		/* Straight copy (opaque source, no colorkey) */
+} AG_Blit32;
+
+typedef void (*AG_Blit32RowFn)(Uint32 *_Nonnull, const Uint32 *_Nonnull,
+                               int, const AG_Blit32 *_Nonnull);
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && \
+    (__GNUC__ >= 5 || defined(__clang__))
+# define AG_BLIT32_X86
+# include <immintrin.h>
+#endif
+
+/* Blend (opaque-extended) source pixel s over destination pixel d. */
+static __inline__ Uint32
+Blit32_Blend(Uint32 s, Uint32 d)
+{
+	const Uint32 a = (s >> 24), ia = 255 - a;
+	Uint32 rb, g, oa;
+
+	rb = (s & 0xff00ff)*a + (d & 0xff00ff)*ia + 0x800080;
+	rb = ((rb + ((rb >> 8) & 0xff00ff)) >> 8) & 0xff00ff;
+	g = ((s >> 8) & 0xff)*a + ((d >> 8) & 0xff)*ia + 0x80;
+	g = ((g + (g >> 8)) >> 8) & 0xff;
+	oa = (d >> 24) + a;
+	if (oa > 255) { oa = 255; }
+
+	return (rb | (g << 8) | (oa << 24));
+}
+
+static void
+Blit32_RowScalar(Uint32 *_Nonnull d, const Uint32 *_Nonnull s, int w,
+    const AG_Blit32 *_Nonnull p)
+{
+	int x;
+
+	if (p->copy) {
+		for (x = 0; x < w; x++) {
+			d[x] = (s[x] & 0x00ffffff) | p->dstA;
+		}
+		return;
+	}
+	for (x = 0; x < w; x++) {
+		Uint32 px = s[x], out;
+
+		if (p->keyOn && px == p->key) {
+			continue;
+		}
+		px |= p->srcOr;
+		if ((px >> 24) > (p->alphaMax >> 24))      /* Per-surface alpha */
+			px = (px & 0x00ffffff) | (p->alphaMax & 0xff000000);
+		out = Blit32_Blend(px, d[x]);
+		d[x] = (out & 0x00ffffff) | (out & p->dstA);
+	}
+}
+
+#ifdef AG_BLIT32_X86
+__attribute__((target("sse2")))
+static void
+Blit32_RowSSE2(Uint32 *_Nonnull d, const Uint32 *_Nonnull s, int w,
+    const AG_Blit32 *_Nonnull p)
+{
+	const __m128i zero    = _mm_setzero_si128();
+	const __m128i rgbMask = _mm_set1_epi32(0x00ffffff);
+	const __m128i dstA    = _mm_set1_epi32((int)p->dstA);
+	int x = 0;
+
+	if (p->copy) {
+		for (; x+4 <= w; x += 4) {
+			__m128i vs = _mm_loadu_si128((const __m128i *)&s[x]);
+
+			_mm_storeu_si128((__m128i *)&d[x],
+			    _mm_or_si128(_mm_and_si128(vs, rgbMask), dstA));
+		}
+	} else {
+		const __m128i srcOr    = _mm_set1_epi32((int)p->srcOr);
+		const __m128i alphaMax = _mm_set1_epi32((int)p->alphaMax);
+		const __m128i key      = _mm_set1_epi32((int)p->key);
+		const __m128i keyOn    = _mm_set1_epi32(p->keyOn ? -1 : 0);
+		const __m128i c255     = _mm_set1_epi16(255);
+		const __m128i c128     = _mm_set1_epi16(128);
+
+		for (; x+4 <= w; x += 4) {
+			__m128i vs0, vs, vd, sl,sh, dl,dh, al,ah, tl,th, vr, m;
+
+			vs0 = _mm_loadu_si128((const __m128i *)&s[x]);
+			vd  = _mm_loadu_si128((const __m128i *)&d[x]);
+			vs  = _mm_min_epu8(_mm_or_si128(vs0, srcOr), alphaMax);
+
+			sl = _mm_unpacklo_epi8(vs, zero);
+			sh = _mm_unpackhi_epi8(vs, zero);
+			dl = _mm_unpacklo_epi8(vd, zero);
+			dh = _mm_unpackhi_epi8(vd, zero);
+			al = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sl, 0xff), 0xff);
+			ah = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sh, 0xff), 0xff);
+
+			/* (s*a + d*(255-a)) / 255, rounded */
+			tl = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(sl, al),
+			     _mm_mullo_epi16(dl, _mm_sub_epi16(c255, al))), c128);
+			th = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(sh, ah),
+			     _mm_mullo_epi16(dh, _mm_sub_epi16(c255, ah))), c128);
+			tl = _mm_srli_epi16(_mm_add_epi16(tl, _mm_srli_epi16(tl, 8)), 8);
+			th = _mm_srli_epi16(_mm_add_epi16(th, _mm_srli_epi16(th, 8)), 8);
+
+			vr = _mm_or_si128(
+			    _mm_and_si128(_mm_packus_epi16(tl, th), rgbMask),
+			    _mm_and_si128(_mm_adds_epu8(vs, vd), dstA));
+
+			/* Keep the destination pixel where colorkey matches. */
+			m = _mm_and_si128(_mm_cmpeq_epi32(vs0, key), keyOn);
+			vr = _mm_or_si128(_mm_and_si128(m, vd),
+			                  _mm_andnot_si128(m, vr));
+
+			_mm_storeu_si128((__m128i *)&d[x], vr);
+		}
+	}
+	Blit32_RowScalar(&d[x], &s[x], w-x, p);
+}
+
+__attribute__((target("avx2")))
+static void
+Blit32_RowAVX2(Uint32 *_Nonnull d, const Uint32 *_Nonnull s, int w,
+    const AG_Blit32 *_Nonnull p)
+{
+	const __m256i zero    = _mm256_setzero_si256();
+	const __m256i rgbMask = _mm256_set1_epi32(0x00ffffff);
+	const __m256i dstA    = _mm256_set1_epi32((int)p->dstA);
+	int x = 0;
+
+	if (p->copy) {
+		for (; x+8 <= w; x += 8) {
+			__m256i vs = _mm256_loadu_si256((const __m256i *)&s[x]);
+
+			_mm256_storeu_si256((__m256i *)&d[x],
+			    _mm256_or_si256(_mm256_and_si256(vs, rgbMask), dstA));
+		}
+	} else {
+		const __m256i srcOr    = _mm256_set1_epi32((int)p->srcOr);
+		const __m256i alphaMax = _mm256_set1_epi32((int)p->alphaMax);
+		const __m256i key      = _mm256_set1_epi32((int)p->key);
+		const __m256i keyOn    = _mm256_set1_epi32(p->keyOn ? -1 : 0);
+		const __m256i c255     = _mm256_set1_epi16(255);
+		const __m256i c128     = _mm256_set1_epi16(128);
+
+		for (; x+8 <= w; x += 8) {
+			__m256i vs0, vs, vd, sl,sh, dl,dh, al,ah, tl,th, vr, m;
+
+			vs0 = _mm256_loadu_si256((const __m256i *)&s[x]);
+			vd  = _mm256_loadu_si256((const __m256i *)&d[x]);
+			vs  = _mm256_min_epu8(_mm256_or_si256(vs0, srcOr), alphaMax);
+
+			/* Unpack and pack operate per 128-bit lane (consistently). */
+			sl = _mm256_unpacklo_epi8(vs, zero);
+			sh = _mm256_unpackhi_epi8(vs, zero);
+			dl = _mm256_unpacklo_epi8(vd, zero);
+			dh = _mm256_unpackhi_epi8(vd, zero);
+			al = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(sl, 0xff), 0xff);
+			ah = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(sh, 0xff), 0xff);
+
+			tl = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(sl, al),
+			     _mm256_mullo_epi16(dl, _mm256_sub_epi16(c255, al))), c128);
+			th = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(sh, ah),
+			     _mm256_mullo_epi16(dh, _mm256_sub_epi16(c255, ah))), c128);
+			tl = _mm256_srli_epi16(_mm256_add_epi16(tl, _mm256_srli_epi16(tl, 8)), 8);
+			th = _mm256_srli_epi16(_mm256_add_epi16(th, _mm256_srli_epi16(th, 8)), 8);
+
+			vr = _mm256_or_si256(
+			    _mm256_and_si256(_mm256_packus_epi16(tl, th), rgbMask),
+			    _mm256_and_si256(_mm256_adds_epu8(vs, vd), dstA));
+
+			m = _mm256_and_si256(_mm256_cmpeq_epi32(vs0, key), keyOn);
+			vr = _mm256_or_si256(_mm256_and_si256(m, vd),
+			                     _mm256_andnot_si256(m, vr));
+
+			_mm256_storeu_si256((__m256i *)&d[x], vr);
+		}
+	}
+	Blit32_RowSSE2(&d[x], &s[x], w-x, p);
+}
+#endif /* AG_BLIT32_X86 */
+
+/*
+ * Perform a 32-bit to 32-bit lower blit using the given row kernel.
+ * Fall back to the generic blitter if the formats are not supported.
+ */
+static void
+Blit32(AG_Surface *_Nonnull D, const AG_Rect *_Nonnull rd,
+    const AG_Surface *_Nonnull S, const AG_Rect *_Nonnull rs, Uint caps,
+    AG_Blit32RowFn rowFn)
+{
+	const AG_PixelFormat *pfS = &S->format, *pfD = &D->format;
+	AG_Blit32 p;
+	int y;
+
+	if (pfS->Rmask != pfD->Rmask || pfS->Gmask != pfD->Gmask ||
+	    pfS->Bmask != pfD->Bmask ||
+	    (pfS->Rmask | pfS->Gmask | pfS->Bmask) != 0x00ffffff ||
+	    (pfS->Amask != 0 && pfS->Amask != 0xff000000) ||
+	    (pfD->Amask != 0 && pfD->Amask != 0xff000000)) {
+		switch (caps) {
+		case AG_LOWERBLIT_PSALPHA_SRC | AG_LOWERBLIT_COLORKEY_SRC:
+			AG_LowerBlit_AlCo(D, rd, S, rs);
+			break;
+		case AG_LOWERBLIT_PSALPHA_SRC:
+			AG_LowerBlit_Al(D, rd, S, rs);
+			break;
+		case AG_LOWERBLIT_COLORKEY_SRC:
+			AG_LowerBlit_Co(D, rd, S, rs);
+			break;
+		default:
+			AG_LowerBlit_Any_to_Any(D, rd, S, rs);
+			break;
+		}
+		return;
+	}
+	p.srcOr = (pfS->Amask != 0) ? 0 : 0xff000000;
+	p.alphaMax = 0x00ffffff;
+	p.alphaMax |= (caps & AG_LOWERBLIT_PSALPHA_SRC) ?
+	              ((Uint32)AG_Hto8(S->alpha) << 24) : 0xff000000;
+	p.keyOn = (caps & AG_LOWERBLIT_COLORKEY_SRC) ? 1 : 0;
+	p.key = (Uint32)S->colorkey;
+	p.dstA = (pfD->Amask != 0) ? 0xff000000 : 0;
+	p.copy = (p.srcOr != 0 && p.alphaMax == 0xffffffff && !p.keyOn);
+
+	for (y = 0; y < rd->h; y++) {
+		const Uint32 *pSrc = (const Uint32 *)(S->pixels +
+		    (rs->y + y)*S->pitch + S->Lpadding) + rs->x;
+		Uint32 *pDst = (Uint32 *)(D->pixels +
+		    (rd->y + y)*D->pitch + D->Lpadding) + rd->x;
+
+		rowFn(pDst, pSrc, rd->w, &p);
+	}
+}
+
+#define AG_BLIT32_FN(name, caps, rowFn)					\
+static void								\
+name(AG_Surface *D, const AG_Rect *rd, const AG_Surface *S,		\
+    const AG_Rect *rs)							\
+{									\
+	Blit32(D, rd, S, rs, (caps), (rowFn));				\
+}
+#define AG_BLIT32_AL   AG_LOWERBLIT_PSALPHA_SRC
+#define AG_BLIT32_CO   AG_LOWERBLIT_COLORKEY_SRC
+#define AG_BLIT32_ALCO (AG_LOWERBLIT_PSALPHA_SRC | AG_LOWERBLIT_COLORKEY_SRC)
+
+AG_BLIT32_FN(AG_LowerBlit_32,          0,              Blit32_RowScalar)
+AG_BLIT32_FN(AG_LowerBlit_32_Al,       AG_BLIT32_AL,   Blit32_RowScalar)
+AG_BLIT32_FN(AG_LowerBlit_32_Co,       AG_BLIT32_CO,   Blit32_RowScalar)
+AG_BLIT32_FN(AG_LowerBlit_32_AlCo,     AG_BLIT32_ALCO, Blit32_RowScalar)
+#ifdef AG_BLIT32_X86
+AG_BLIT32_FN(AG_LowerBlit_32_SSE2,     0,              Blit32_RowSSE2)
+AG_BLIT32_FN(AG_LowerBlit_32_Al_SSE2,  AG_BLIT32_AL,   Blit32_RowSSE2)
+AG_BLIT32_FN(AG_LowerBlit_32_Co_SSE2,  AG_BLIT32_CO,   Blit32_RowSSE2)
+AG_BLIT32_FN(AG_LowerBlit_32_AlCo_SSE2,AG_BLIT32_ALCO, Blit32_RowSSE2)
+AG_BLIT32_FN(AG_LowerBlit_32_AVX2,     0,              Blit32_RowAVX2)
+AG_BLIT32_FN(AG_LowerBlit_32_Al_AVX2,  AG_BLIT32_AL,   Blit32_RowAVX2)
+AG_BLIT32_FN(AG_LowerBlit_32_Co_AVX2,  AG_BLIT32_CO,   Blit32_RowAVX2)
+AG_BLIT32_FN(AG_LowerBlit_32_AlCo_AVX2,AG_BLIT32_ALCO, Blit32_RowAVX2)
+#endif
+
 /*
  * Copy/blend a region of pixels (per srcRect) from a source surface S to a
  * destination surface D, at coordinates xDst,yDst of D.
@@ -1489,18 +1765,30 @@ AG_FillRect(AG_Surface *S, const AG_Rect *rd, const AG_Color *c)
 		const int cy = S->clipRect.y, cy2 = S->clipRect.y+S->clipRect.h;
 
 		r = *rd;
-		if (r.x < cx)       { r.x = cx; }
-		if (r.y < cy)       { r.y = cy; }
+		if (r.x < cx)       { r.w -= cx-r.x; r.x = cx; }
+		if (r.y < cy)       { r.h -= cy-r.y; r.y = cy; }
 		if (r.x+r.w >= cx2) { r.w = cx2-r.x; }
 		if (r.y+r.h >= cy2) { r.h = cy2-r.y; }
+		if (r.w <= 0 || r.h <= 0)
+			return;
 	} else {
 		r = S->clipRect;
 	}
 	px = AG_MapPixel(&S->format, c);
 
-	/* XXX TODO optimized cases */
-	for (y = r.y; y < r.h; y++)
-		for (x = r.x; x < r.w; x++)
+	if (S->format.mode == AG_SURFACE_PACKED &&
+	    S->format.BytesPerPixel == 4) {
+		for (y = r.y; y < r.y+r.h; y++) {
+			Uint32 *p = (Uint32 *)(S->pixels + y*S->pitch +
+			            S->Lpadding) + r.x;
+
+			for (x = 0; x < r.w; x++)
+				*p++ = (Uint32)px;
+		}
+		return;
+	}
+	for (y = r.y; y < r.y+r.h; y++)
+		for (x = r.x; x < r.x+r.w; x++)
 			AG_SurfacePut(S, x, y, px);
 }
 
@@ -2440,6 +2728,20 @@ AG_SurfaceAddFrame(AG_Surface *Sanim, const AG_Surface *Sframe,
 const AG_LowerBlit agLowerBlits_Std_Packed[] = {
 	/*                  |-Depth-|          |-----Masks----| */
 	/* Destination       Src Dst  Cap Cpu  R,G,B,A, R,G,B,A */
+#ifdef AG_BLIT32_X86
+	{ AG_SURFACE_PACKED, 32, 32, 0,              AG_EXT_AVX2, 0,0,0,0, 0,0,0,0, AG_LowerBlit_32_AVX2 },
+	{ AG_SURFACE_PACKED, 32, 32, AG_BLIT32_AL,   AG_EXT_AVX2, 0,0,0,0, 0,0,0,0, AG_LowerBlit_32_Al_AVX2 },
+	{ AG_SURFACE_PACKED, 32, 32, AG_BLIT32_CO,   AG_EXT_AVX2, 0,0,0,0, 0,0,0,0, AG_LowerBlit_32_Co_AVX2 },
+	{ AG_SURFACE_PACKED, 32, 32, AG_BLIT32_ALCO, AG_EXT_AVX2, 0,0,0,0, 0,0,0,0, AG_LowerBlit_32_AlCo_AVX2 },
+	{ AG_SURFACE_PACKED, 32, 32, 0,              AG_EXT_SSE2, 0,0,0,0, 0,0,0,0, AG_LowerBlit_32_SSE2 },
+	{ AG_SURFACE_PACKED, 32, 32, AG_BLIT32_AL,   AG_EXT_SSE2, 0,0,0,0, 0,0,0,0, AG_LowerBlit_32_Al_SSE2 },
+	{ AG_SURFACE_PACKED, 32, 32, AG_BLIT32_CO,   AG_EXT_SSE2, 0,0,0,0, 0,0,0,0, AG_LowerBlit_32_Co_SSE2 },
+	{ AG_SURFACE_PACKED, 32, 32, AG_BLIT32_ALCO, AG_EXT_SSE2, 0,0,0,0, 0,0,0,0, AG_LowerBlit_32_AlCo_SSE2 },
+#endif
+	{ AG_SURFACE_PACKED, 32, 32, 0,              0,           0,0,0,0, 0,0,0,0, AG_LowerBlit_32 },
+	{ AG_SURFACE_PACKED, 32, 32, AG_BLIT32_AL,   0,           0,0,0,0, 0,0,0,0, AG_LowerBlit_32_Al },
+	{ AG_SURFACE_PACKED, 32, 32, AG_BLIT32_CO,   0,           0,0,0,0, 0,0,0,0, AG_LowerBlit_32_Co },
+	{ AG_SURFACE_PACKED, 32, 32, AG_BLIT32_ALCO, 0,           0,0,0,0, 0,0,0,0, AG_LowerBlit_32_AlCo },
 	{ AG_SURFACE_INDEXED, 0,  1,   0,  0,  0,0,0,0, 0,0,0,0, AG_LowerBlit_Packed_to_Sub8 },
 	{ AG_SURFACE_INDEXED, 0,  2,   0,  0,  0,0,0,0, 0,0,0,0, AG_LowerBlit_Packed_to_Sub8 },
 	{ AG_SURFACE_INDEXED, 0,  4,   0,  0,  0,0,0,0, 0,0,0,0, AG_LowerBlit_Packed_to_Sub8 },
@@ -52,6 +52,9 @@ static int     CompareCellsFnTxt(const AG_TableCell *_Nonnull, const AG_TableCel
 static void    RestoreRowSelections(AG_Table *_Nonnull);
 static void    RestoreCellSelections(AG_Table *_Nonnull);
 static void    RestoreColSelections(AG_Table *_Nonnull);
+static void    RemoveStaleRows(AG_Table *_Nonnull);
+static void    FreeRowKey(AG_Table *_Nonnull, AG_TableRowKey *_Nonnull);
+static void    ClearRowKeys(AG_Table *_Nonnull);
 
 #undef  COLUMN_RESIZE_RANGE
 #define COLUMN_RESIZE_RANGE 10  /* TODO css */
@@ -964,12 +967,21 @@ HashPrevCell(AG_Table *_Nonnull t, const AG_TableCell *_Nonnull c)
 void
 AG_TableClear(AG_Table *t)
 {
+	AG_OBJECT_ISA(t, "AG_Widget:AG_Table:*");
+	AG_ObjectLock(t);
+	if (t->flags & AG_TABLE_KEYED) {
+		ClearRowKeys(t);
+	}
 	AG_TableBegin(t);
+	AG_ObjectUnlock(t);
 }
 
 /*
  * Clear the items on the table and save the selection state. The function
  * returns with the table locked.
+ *
+ * If rows were inserted with AG_TableAddRowKeyed(), they are retained and
+ * a new update generation is started instead.
  */
 void
 AG_TableBegin(AG_Table *t)
@@ -979,6 +991,12 @@ AG_TableBegin(AG_Table *t)
 	AG_OBJECT_ISA(t, "AG_Widget:AG_Table:*");
 	AG_ObjectLock(t);		/* Lock across TableBegin/End */
 
+	if (t->flags & AG_TABLE_KEYED) {
+		t->keyGen++;
+		t->nKeysSeen = 0;
+		return;
+	}
+
 	/* Copy the existing cells to the backing store and free the table. */
 	for (m = 0; m < t->m; m++) {
 		for (n = 0; n < t->n; n++) {
@@ -999,6 +1017,35 @@ AG_TableBegin(AG_Table *t)
 	t->flags &= ~(AG_TABLE_WIDGETS);
 }
 
+/*
+ * Remove the rows whose key was not updated in the current generation,
+ * as well as any rows inserted without a key.
+ */
+static void
+RemoveStaleRows(AG_Table *_Nonnull t)
+{
+	int m, mNew, n;
+
+	for (m = 0, mNew = 0; m < t->m; m++) {
+		AG_TableCell *row = t->cells[m];
+		AG_TableRowKey *k = row[0].key;
+
+		if (k != NULL && k->gen == t->keyGen) {
+			t->cells[mNew++] = row;
+			continue;
+		}
+		if (k != NULL) {
+			FreeRowKey(t, k);
+		}
+		for (n = 0; n < t->n; n++) {
+			AG_TableFreeCell(t, &row[n]);
+		}
+		free(row);
+	}
+	t->m = mNew;
+	AG_Redraw(t);
+}
+
 /*
  * Restore the selection state and recover the surfaces of matching
  * items in the backing store. Unlock the table.
@@ -1015,6 +1062,13 @@ AG_TableEnd(AG_Table *t)
 
 	AG_OBJECT_ISA(t, "AG_Widget:AG_Table:*");
 
+	if (t->flags & AG_TABLE_KEYED) {
+		if (t->nKeysSeen < (Uint)t->m) {
+			RemoveStaleRows(t);
+		}
+		if (TAILQ_EMPTY(&t->cPrevList))
+			goto out;
+	}
 	if (t->n == 0)
 		goto out;
 
@@ -2114,37 +2168,26 @@ AG_TableInitCell(AG_Table *t, AG_TableCell *c)
 	c->surface = -1;
 	c->widget = NULL;
 	c->tbl = t;
+	c->key = NULL;
 	c->id = 0;
 	c->nPrev = 0;
 }
 
-int
-AG_TableAddRow(AG_Table *t, const char *fmtp, ...)
+/*
+ * Initialize the cells of a row from a format string and arguments.
+ * Embedded widgets are not attached (see AttachCellWidget()).
+ */
+static void
+ParseRow(AG_Table *_Nonnull t, AG_TableCell *_Nonnull row,
+    const char *_Nonnull fmtp, va_list ap)
 {
 	char fmt[64], *sp = &fmt[0];
-	va_list ap;
-	int n, rv;
-	AG_TableCell **cNew;
+	int n;
 
 	Strlcpy(fmt, fmtp, sizeof(fmt));
 
-	AG_OBJECT_ISA(t, "AG_Widget:AG_Table:*");
-	AG_ObjectLock(t);
-
-	if ((cNew = TryRealloc(t->cells, (t->m+1)*sizeof(AG_TableCell))) == NULL) {
-		rv = -1;
-		goto out;
-	}
-	if ((cNew[t->m] = TryMalloc(t->n*sizeof(AG_TableCell))) == NULL) {
-		Free(cNew);
-		rv = -1;
-		goto out;
-	}
-	t->cells = cNew;
-
-	va_start(ap, fmtp);
 	for (n = 0; n < t->n; n++) {
-		AG_TableCell *c = &t->cells[t->m][n];
+		AG_TableCell *c = &row[n];
 		char *s = AG_Strsep(&sp, t->sep), *sc;
 		int ptr = 0, lflag = 0, ptr_long = 0;
 		int infmt = 0;
@@ -2212,17 +2255,8 @@ AG_TableAddRow(AG_Table *t, const char *fmtp, ...)
 				c->fnSu = c->data.p;
 				c->data.p = c;
 			} else if (sc[0] == 'W') {
-				AG_SizeAlloc a;
-
-				a.x = 0;
-				a.y = 0;
-				a.w = 0;
-				a.h = 0;
 				c->type = AG_CELL_WIDGET;
 				c->widget = c->data.p;
-				AG_ObjectAttach(t, c->widget);
-				AG_WidgetSizeAlloc(c->widget, &a);
-				t->flags |= AG_TABLE_WIDGETS;
 			}
 		}
 		switch (sc[0]) {
@@ -2321,13 +2355,266 @@ AG_TableAddRow(AG_Table *t, const char *fmtp, ...)
 			break;
 		}
 	}
-	va_end(ap);
+}
 
-	rv = t->m++;
+/* Attach the widget of an AG_CELL_WIDGET cell to the table. */
+static void
+AttachCellWidget(AG_Table *_Nonnull t, AG_TableCell *_Nonnull c)
+{
+	AG_SizeAlloc a;
 
-	t->flags |= AG_TABLE_NEEDSORT;
+	a.x = 0;
+	a.y = 0;
+	a.w = 0;
+	a.h = 0;
+	AG_ObjectAttach(t, c->widget);
+	AG_WidgetSizeAlloc(c->widget, &a);
+	t->flags |= AG_TABLE_WIDGETS;
+}
+
+/* Append a new row. The table must be locked. */
+static int
+AddRow(AG_Table *_Nonnull t, const char *_Nonnull fmt, va_list ap)
+{
+	AG_TableCell **cNew, *row;
+	int n;
 
+	if ((cNew = TryRealloc(t->cells, (t->m+1)*sizeof(AG_TableCell *))) == NULL) {
+		return (-1);
+	}
+	t->cells = cNew;
+	if ((row = TryMalloc(t->n*sizeof(AG_TableCell))) == NULL) {
+		return (-1);
+	}
+	ParseRow(t, row, fmt, ap);
+	for (n = 0; n < t->n; n++) {
+		if (row[n].type == AG_CELL_WIDGET)
+			AttachCellWidget(t, &row[n]);
+	}
+	t->cells[t->m] = row;
+	t->flags |= AG_TABLE_NEEDSORT;
 	AG_Redraw(t);
+	return (t->m++);
+}
+
+int
+AG_TableAddRow(AG_Table *t, const char *fmt, ...)
+{
+	va_list ap;
+	int rv;
+
+	AG_OBJECT_ISA(t, "AG_Widget:AG_Table:*");
+	AG_ObjectLock(t);
+
+	va_start(ap, fmt);
+	rv = AddRow(t, fmt, ap);
+	va_end(ap);
+
+	AG_ObjectUnlock(t);
+	return (rv);
+}
+
+static __inline__ Uint _Const_Attribute
+HashRowID(AG_TableRowID id, Uint nBuckets)
+{
+#ifdef AG_HAVE_64BIT
+	return (Uint)((id * 0x9e3779b97f4a7c15ULL) >> 32) & (nBuckets - 1);
+#else
+	return ((id * 2654435761U) >> 8) & (nBuckets - 1);
+#endif
+}
+
+static AG_TableRowKey *_Nullable
+LookupRowKey(const AG_Table *_Nonnull t, AG_TableRowID id)
+{
+	AG_TableRowKey *k;
+
+	for (k = t->keys[HashRowID(id, t->nKeyBuckets)]; k != NULL; k = k->next) {
+		if (k->id == id)
+			break;
+	}
+	return (k);
+}
+
+/* Double the size of the row key table. */
+static void
+GrowRowKeys(AG_Table *_Nonnull t)
+{
+	AG_TableRowKey **keysNew, *k, *kNext;
+	const Uint nNew = t->nKeyBuckets << 1;
+	Uint i;
+
+	if ((keysNew = TryMalloc(nNew*sizeof(AG_TableRowKey *))) == NULL) {
+		return;
+	}
+	memset(keysNew, 0, nNew*sizeof(AG_TableRowKey *));
+	for (i = 0; i < t->nKeyBuckets; i++) {
+		for (k = t->keys[i]; k != NULL; k = kNext) {
+			const Uint h = HashRowID(k->id, nNew);
+
+			kNext = k->next;
+			k->next = keysNew[h];
+			keysNew[h] = k;
+		}
+	}
+	free(t->keys);
+	t->keys = keysNew;
+	t->nKeyBuckets = nNew;
+}
+
+/* Remove a row key from the hash table and free it. */
+static void
+FreeRowKey(AG_Table *_Nonnull t, AG_TableRowKey *_Nonnull k)
+{
+	AG_TableRowKey **pk;
+
+	pk = &t->keys[HashRowID(k->id, t->nKeyBuckets)];
+	while (*pk != k) {
+		pk = &(*pk)->next;
+	}
+	*pk = k->next;
+	k->row[0].key = NULL;
+	free(k);
+	t->nKeys--;
+}
+
+/* Free all row keys and leave keyed mode. */
+static void
+ClearRowKeys(AG_Table *_Nonnull t)
+{
+	AG_TableRowKey *k, *kNext;
+	Uint i;
+
+	for (i = 0; i < t->nKeyBuckets; i++) {
+		for (k = t->keys[i]; k != NULL; k = kNext) {
+			kNext = k->next;
+			k->row[0].key = NULL;
+			free(k);
+		}
+	}
+	Free(t->keys);
+	t->keys = NULL;
+	t->nKeyBuckets = 0;
+	t->nKeys = 0;
+	t->nKeysSeen = 0;
+	t->flags &= ~(AG_TABLE_KEYED);
+}
+
+/* Return 1 if a cell would be displayed identically to another. */
+static int
+CellsEqual(const AG_TableCell *_Nonnull c1, const AG_TableCell *_Nonnull c2)
+{
+	if (c1->type == AG_CELL_WIDGET) {
+		return (c2->type == AG_CELL_WIDGET && c1->widget == c2->widget);
+	}
+	return (AG_TableCompareCells(c1, c2) == 0);
+}
+
+/*
+ * Insert or update the row identified by an application-supplied key.
+ *
+ * Between AG_TableBegin() and AG_TableEnd(), existing rows are kept and
+ * only cells whose contents differ are replaced, so unchanged cells keep
+ * their rendered surfaces and selection state. Rows whose key was not
+ * updated are removed by AG_TableEnd().
+ */
+int
+AG_TableAddRowKeyed(AG_Table *t, AG_TableRowID id, const char *fmt, ...)
+{
+	AG_TableRowKey *k;
+	AG_TableCell *row;
+	va_list ap;
+	int n, changed = 0, rv = 0;
+
+	AG_OBJECT_ISA(t, "AG_Widget:AG_Table:*");
+	AG_ObjectLock(t);
+
+	if (t->n == 0) {
+		AG_SetErrorS("No columns");
+		rv = -1;
+		goto out;
+	}
+	if (t->keys == NULL) {
+		t->nKeyBuckets = 256;
+		t->keys = Malloc(t->nKeyBuckets*sizeof(AG_TableRowKey *));
+		memset(t->keys, 0, t->nKeyBuckets*sizeof(AG_TableRowKey *));
+		t->flags |= AG_TABLE_KEYED;
+	}
+	if ((k = LookupRowKey(t, id)) == NULL) {
+		if ((k = TryMalloc(sizeof(AG_TableRowKey))) == NULL) {
+			rv = -1;
+			goto out;
+		}
+		va_start(ap, fmt);
+		n = AddRow(t, fmt, ap);
+		va_end(ap);
+		if (n == -1) {
+			free(k);
+			rv = -1;
+			goto out;
+		}
+		if (t->nKeys >= t->nKeyBuckets) {
+			GrowRowKeys(t);
+		}
+		k->id = id;
+		k->row = t->cells[n];
+		k->gen = t->keyGen;
+		k->next = t->keys[HashRowID(id, t->nKeyBuckets)];
+		t->keys[HashRowID(id, t->nKeyBuckets)] = k;
+		k->row[0].key = k;
+		t->nKeys++;
+		t->nKeysSeen++;
+		goto out;
+	}
+	if (k->gen != t->keyGen) {
+		k->gen = t->keyGen;
+		t->nKeysSeen++;
+	}
+	if (t->nRowTmp < t->n) {
+		AG_TableCell *rowNew;
+
+		if ((rowNew = TryRealloc(t->rowTmp,
+		    t->n*sizeof(AG_TableCell))) == NULL) {
+			rv = -1;
+			goto out;
+		}
+		t->rowTmp = rowNew;
+		t->nRowTmp = t->n;
+	}
+	va_start(ap, fmt);
+	ParseRow(t, t->rowTmp, fmt, ap);
+	va_end(ap);
+
+	for (n = 0, row = k->row; n < t->n; n++) {
+		AG_TableCell *c = &row[n];
+		const int selected = c->selected;
+
+		if (CellsEqual(c, &t->rowTmp[n])) {
+			continue;
+		}
+		AG_TableFreeCell(t, c);
+		memcpy(c, &t->rowTmp[n], sizeof(AG_TableCell));
+		c->selected = selected;
+		c->key = (n == 0) ? k : NULL;
+
+		switch (c->type) {
+		case AG_CELL_FN_TXT:
+		case AG_CELL_FN_SU:
+		case AG_CELL_FN_SU_NODUP:
+			c->data.p = c;			/* Was rowTmp[n] */
+			break;
+		case AG_CELL_WIDGET:
+			AttachCellWidget(t, c);
+			break;
+		default:
+			break;
+		}
+		changed++;
+	}
+	if (changed) {
+		t->flags |= AG_TABLE_NEEDSORT;
+		AG_Redraw(t);
+	}
 out:
 	AG_ObjectUnlock(t);
 	return (rv);
@@ -2476,6 +2763,14 @@ Init(void *_Nonnull obj)
 		TAILQ_INIT(&tb->cells);
 	}
 	TAILQ_INIT(&t->cPrevList);
+
+	t->keys = NULL;
+	t->nKeyBuckets = 0;
+	t->nKeys = 0;
+	t->keyGen = 0;
+	t->nKeysSeen = 0;
+	t->rowTmp = NULL;
+	t->nRowTmp = 0;
 	
 	AG_AddEvent(t, "font-changed", OnFontChange, NULL);
 	AG_SetEvent(t, "widget-lostfocus", LostFocus, NULL);
@@ -2499,6 +2794,11 @@ Destroy(void *_Nonnull obj)
 		free(pop);
 	}
 
+	if (t->flags & AG_TABLE_KEYED) {
+		ClearRowKeys(t);
+	}
+	Free(t->rowTmp);
+
 	for (i = 0; i < t->m; i++) {
 		free(t->cells[i]);
 	}
@@ -18,7 +18,8 @@
 #define AG_TABLE_HASHBUF_MAX 64		/* Buffer used in hash function */
 
 struct ag_table;
-	
+struct ag_table_row_key;
+
 enum ag_table_selmode {
 	AG_TABLE_SEL_ROWS,	/* Select entire rows */
 	AG_TABLE_SEL_CELLS,	/* Select individual cells */
@@ -105,6 +106,7 @@ typedef struct ag_table_cell {
 	int selected;				/* Cell is selected */
 	int surface;				/* Named of mapped surface */
 	struct ag_table *_Nonnull tbl;		/* Back pointer to Table */
+	struct ag_table_row_key *_Nullable key;	/* Row key (in first cell) */
 	Uint id;				/* Optional user-specified ID */
 	Uint nPrev;				/* For SEL_ROWS mode */
 
@@ -112,6 +114,21 @@ typedef struct ag_table_cell {
 	AG_TAILQ_ENTRY(ag_table_cell) cells_list; /* In AG_Table */
 } AG_TableCell;
 
+#ifdef AG_HAVE_64BIT
+typedef Uint64 AG_TableRowID;
+#else
+typedef Uint AG_TableRowID;
+#endif
+
+/* Application-supplied row key (AG_TableAddRowKeyed()). */
+typedef struct ag_table_row_key {
+	AG_TableRowID id;			/* Application row ID */
+	AG_TableCell *_Nonnull row;		/* Row cells */
+	Uint gen;				/* Last updated in generation */
+	Uint32 _pad;
+	struct ag_table_row_key *_Nullable next; /* In hash chain */
+} AG_TableRowKey;
+
 typedef struct ag_table_bucket {
 	AG_TAILQ_HEAD_(ag_table_cell) cells;
 } AG_TableBucket;
@@ -144,6 +161,7 @@ typedef struct ag_table {
 #define AG_TABLE_WIDGETS        0x080	/* Embedded widgets are in use */
 #define AG_TABLE_NOAUTOSORT     0x100	/* Disable automatic sorting */
 #define AG_TABLE_NEEDSORT       0x200	/* Need sorting */
+#define AG_TABLE_KEYED          0x400	/* Rows are keyed (read-only) */
 
 	enum ag_table_selmode selMode;	/* Selection mode */
 	int wHint, hHint;		/* Size hint */
@@ -168,6 +186,15 @@ typedef struct ag_table {
 
 	AG_TAILQ_HEAD_(ag_table_cell) cPrevList;	
 
+	AG_TableRowKey *_Nullable *_Nullable keys; /* Row keys (hash table) */
+	Uint nKeyBuckets;		/* Size of keys[] (power of 2) */
+	Uint nKeys;			/* Number of keyed rows */
+	Uint keyGen;			/* Current update generation */
+	Uint nKeysSeen;			/* Keys updated in this generation */
+	AG_TableCell *_Nullable rowTmp;	/* Scratch row for keyed updates */
+	int nRowTmp;			/* Cells allocated in rowTmp */
+	Uint32 _pad;
+
 	int n;				/* Number of columns */
 	int m;				/* Number of rows */
 	int mVis;			/* Maximum number of visible rows */
@@ -239,6 +266,8 @@ AG_Size AG_TablePrintCell(const AG_TableCell *_Nonnull, char *_Nonnull, AG_Size)
 void    AG_TableFreeCell(AG_Table *_Nonnull, AG_TableCell *_Nonnull);
 
 int  AG_TableAddRow(AG_Table *_Nonnull, const char *_Nonnull, ...);
+int  AG_TableAddRowKeyed(AG_Table *_Nonnull, AG_TableRowID,
+                         const char *_Nonnull, ...);
 void AG_TableDelRow(AG_Table *_Nonnull, int);
 
 void AG_TableSelectRow(AG_Table *_Nonnull, int);
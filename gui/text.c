@@ -53,6 +53,7 @@
 #endif
 
 #include <agar/gui/text.h>
+#include <agar/gui/text_cache.h>
 #include <agar/gui/window.h>
 #ifdef AG_WIDGETS
 # include <agar/gui/box.h>
@@ -1668,6 +1669,7 @@ AG_InitTextSubsystem(void)
 
 	AG_MutexInitRecursive(&agTextLock);
 	TAILQ_INIT(&agFontCache);
+	AG_InitTextCache();
 
 	AG_ObjectLock(agConfig);
 
@@ -1770,6 +1772,8 @@ AG_DestroyTextSubsystem(void)
 	if (--agTextInitedSubsystem > 0) {
 		return;
 	}
+	AG_DestroyTextCache();
+
 	for (font = TAILQ_FIRST(&agFontCache);
 	     font != TAILQ_END(&agFontCache);
 	     font = fontNext) {
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2008-2019 Julien Nadeau Carriere <vedge@csoft.net>
+ * Copyright (c) 2008-2026 Julien Nadeau Carriere <vedge@csoft.net>
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -25,6 +25,14 @@
 
 /*
  * A cache of rendered text surfaces tagged with rendering attributes.
+ *
+ * Rendered surfaces are kept in a process-wide table keyed by a hash of
+ * the text and its AG_TextState. Entries are reference counted and sorted
+ * by last use; once the total size of the pixel data exceeds maxBytes, the
+ * least recently used entries which are no longer referenced are freed.
+ *
+ * Each AG_TextCache maps shared surfaces (with NODUP) into its widget so
+ * that textures remain associated with the widget's rendering context.
  */
 
 #include <agar/core/core.h>
@@ -34,18 +42,276 @@
 
 /* #define TEXTCACHE_DEBUG */
 
+#ifdef AG_HAVE_64BIT
+# define FNV_OFFSET 0xcbf29ce484222325ULL
+# define FNV_PRIME  0x100000001b3ULL
+#else
+# define FNV_OFFSET 0x811c9dc5U
+# define FNV_PRIME  0x01000193U
+#endif
+
+static AG_TextCacheEnt *_Nullable *_Nullable agTextCacheTbl = NULL;
+static Uint                                  agTextCacheTblSize = 0;
+static AG_TAILQ_HEAD(ag_text_cache_lru,ag_text_cache_ent) agTextCacheLRU;
+static AG_TextCacheStats                     agTextCacheStats;
+
 static void FreeCachedText(AG_TextCache *_Nonnull, AG_CachedText *_Nonnull);
 
-static __inline__ Uint _Pure_Attribute
-Hash_Text(AG_TextCache *_Nonnull tc, const char *_Nonnull s)
+static __inline__ AG_TextCacheHash
+HashBytes(AG_TextCacheHash h, const void *_Nonnull p, AG_Size len)
+{
+	const Uint8 *c = p;
+
+	while (len-- > 0) {
+		h ^= *c++;
+		h *= FNV_PRIME;
+	}
+	return (h);
+}
+
+/* Compute the hash of a string under the given rendering state. */
+static AG_TextCacheHash _Pure_Attribute
+HashText(const char *_Nonnull s, const AG_TextState *_Nonnull ts)
+{
+	AG_TextCacheHash h = FNV_OFFSET;
+	const Uchar *p;
+
+	for (p = (const Uchar *)s; *p != '\0'; p++) {
+		h ^= *p;
+		h *= FNV_PRIME;
+	}
+	h = HashBytes(h, &ts->font, sizeof(ts->font));
+	h = HashBytes(h, &ts->color, sizeof(AG_Color));
+	h = HashBytes(h, &ts->colorBG, sizeof(AG_Color));
+	h = HashBytes(h, &ts->justify, sizeof(ts->justify));
+	h = HashBytes(h, &ts->valign, sizeof(ts->valign));
+	h = HashBytes(h, &ts->tabWd, sizeof(ts->tabWd));
+	return (h);
+}
+
+/* Compare two text states. */
+static __inline__ int
+CompareTextStates(const AG_TextState *_Nonnull a, const AG_TextState *_Nonnull b)
+{
+	if (a->font == b->font &&
+	    AG_ColorCompare(&a->color, &b->color) == 0 &&
+	    AG_ColorCompare(&a->colorBG, &b->colorBG) == 0 &&
+	    a->justify == b->justify &&
+	    a->valign == b->valign &&
+	    a->tabWd == b->tabWd) {
+		return (0);
+	}
+	return (1);
+}
+
+/* Initialize the global text cache (called from AG_InitTextSubsystem()). */
+void
+AG_InitTextCache(void)
+{
+	agTextCacheTblSize = 256;
+	agTextCacheTbl = Malloc(agTextCacheTblSize * sizeof(AG_TextCacheEnt *));
+	memset(agTextCacheTbl, 0, agTextCacheTblSize * sizeof(AG_TextCacheEnt *));
+	TAILQ_INIT(&agTextCacheLRU);
+	memset(&agTextCacheStats, 0, sizeof(AG_TextCacheStats));
+	agTextCacheStats.maxBytes = AG_TEXT_CACHE_MAX_BYTES;
+}
+
+static void
+FreeEnt(AG_TextCacheEnt *_Nonnull ent)
+{
+	ent->su->flags &= ~(AG_SURFACE_MAPPED);
+	AG_SurfaceFree(ent->su);
+	free(ent->text);
+	free(ent);
+}
+
+/* Release the global text cache (called from AG_DestroyTextSubsystem()). */
+void
+AG_DestroyTextCache(void)
+{
+	AG_TextCacheEnt *ent, *entNext;
+
+	for (ent = TAILQ_FIRST(&agTextCacheLRU);
+	     ent != TAILQ_END(&agTextCacheLRU);
+	     ent = entNext) {
+		entNext = TAILQ_NEXT(ent, lru);
+#ifdef AG_DEBUG
+		if (ent->nRefs > 0)
+			Debug(NULL, "TextCache: \"%s\" still referenced (%u)\n",
+			    ent->text, ent->nRefs);
+#endif
+		FreeEnt(ent);
+	}
+	TAILQ_INIT(&agTextCacheLRU);
+	Free(agTextCacheTbl);
+	agTextCacheTbl = NULL;
+	agTextCacheTblSize = 0;
+	agTextCacheStats.nEnts = 0;
+	agTextCacheStats.curBytes = 0;
+}
+
+/* Remove an unreferenced entry from the global cache and free it. */
+static void
+EvictEnt(AG_TextCacheEnt *_Nonnull ent)
+{
+	AG_TextCacheEnt **pEnt;
+
+	pEnt = &agTextCacheTbl[ent->hash & (agTextCacheTblSize - 1)];
+	while (*pEnt != ent) {
+		pEnt = &(*pEnt)->hNext;
+	}
+	*pEnt = ent->hNext;
+	TAILQ_REMOVE(&agTextCacheLRU, ent, lru);
+
+#ifdef TEXTCACHE_DEBUG
+	Debug(NULL, "TextCache: evicting \"%s\" (%lu bytes)\n", ent->text,
+	    (Ulong)ent->nBytes);
+#endif
+	agTextCacheStats.curBytes -= ent->nBytes;
+	agTextCacheStats.nEvictedBytes += ent->nBytes;
+	agTextCacheStats.nEvicted++;
+	agTextCacheStats.nEnts--;
+	FreeEnt(ent);
+}
+
+/*
+ * Evict least recently used entries until the pixel data fits in maxBytes.
+ * Entries still referenced by a widget are skipped.
+ */
+static void
+ExpireEntries(void)
 {
-	Uint h;
-	Uchar *p;
+	AG_TextCacheEnt *ent, *entPrev;
+
+	for (ent = TAILQ_LAST(&agTextCacheLRU, ag_text_cache_lru);
+	     ent != NULL && agTextCacheStats.curBytes > agTextCacheStats.maxBytes;
+	     ent = entPrev) {
+		entPrev = TAILQ_PREV(ent, ag_text_cache_lru, lru);
+		if (ent->nRefs == 0)
+			EvictEnt(ent);
+	}
+}
+
+/* Double the size of the global hash table. */
+static void
+GrowTable(void)
+{
+	AG_TextCacheEnt **tblNew, *ent, *entNext;
+	Uint sizeNew = agTextCacheTblSize << 1;
+	Uint i;
+
+	if ((tblNew = TryMalloc(sizeNew * sizeof(AG_TextCacheEnt *))) == NULL) {
+		return;
+	}
+	memset(tblNew, 0, sizeNew * sizeof(AG_TextCacheEnt *));
+	for (i = 0; i < agTextCacheTblSize; i++) {
+		for (ent = agTextCacheTbl[i]; ent != NULL; ent = entNext) {
+			entNext = ent->hNext;
+			ent->hNext = tblNew[ent->hash & (sizeNew - 1)];
+			tblNew[ent->hash & (sizeNew - 1)] = ent;
+		}
+	}
+	free(agTextCacheTbl);
+	agTextCacheTbl = tblNew;
+	agTextCacheTblSize = sizeNew;
+}
+
+/*
+ * Look up a rendering of text under the current text state in the global
+ * cache, rendering it on a miss. Return a new reference to the entry.
+ * Must be called with agTextLock held.
+ */
+static AG_TextCacheEnt *_Nullable
+GetSharedEnt(const char *_Nonnull text, const AG_TextState *_Nonnull ts,
+    AG_TextCacheHash h)
+{
+	AG_TextCacheEnt *ent;
+	AG_Surface *S;
+
+	for (ent = agTextCacheTbl[h & (agTextCacheTblSize - 1)];
+	     ent != NULL;
+	     ent = ent->hNext) {
+		if (ent->hash == h &&
+		    strcmp(ent->text, text) == 0 &&
+		    CompareTextStates(&ent->state, ts) == 0)
+			break;
+	}
+	if (ent != NULL) {
+		TAILQ_REMOVE(&agTextCacheLRU, ent, lru);
+		TAILQ_INSERT_HEAD(&agTextCacheLRU, ent, lru);
+		agTextCacheStats.nSharedHits++;
+		ent->nRefs++;
+		return (ent);
+	}
 
-	for (h = 0, p = (Uchar *)s; *p != '\0'; p++) {
-		h = 31*h + *p;
+	if ((S = AG_TextRender(text)) == NULL) {
+		return (NULL);
 	}
-	return (h % tc->nBuckets);
+	if ((ent = TryMalloc(sizeof(AG_TextCacheEnt))) == NULL) {
+		goto fail;
+	}
+	if ((ent->text = TryStrdup(text)) == NULL) {
+		free(ent);
+		goto fail;
+	}
+	ent->hash = h;
+	ent->su = S;
+	ent->nBytes = (AG_Size)S->h * S->pitch;
+	ent->nRefs = 1;
+	memcpy(&ent->state, ts, sizeof(AG_TextState));
+
+	if (agTextCacheStats.nEnts >= (agTextCacheTblSize << 1)) {
+		GrowTable();
+	}
+	ent->hNext = agTextCacheTbl[h & (agTextCacheTblSize - 1)];
+	agTextCacheTbl[h & (agTextCacheTblSize - 1)] = ent;
+	TAILQ_INSERT_HEAD(&agTextCacheLRU, ent, lru);
+
+	agTextCacheStats.nMisses++;
+	agTextCacheStats.nEnts++;
+	agTextCacheStats.curBytes += ent->nBytes;
+	if (agTextCacheStats.curBytes > agTextCacheStats.maxBytes) {
+		ExpireEntries();
+	}
+	return (ent);
+fail:
+	AG_SurfaceFree(S);
+	return (NULL);
+}
+
+/* Release a reference to a shared entry. Called with agTextLock held. */
+static void
+ReleaseSharedEnt(AG_TextCacheEnt *_Nonnull ent)
+{
+#ifdef AG_DEBUG
+	if (ent->nRefs == 0)
+		AG_FatalError("TextCache: refcount underflow");
+#endif
+	if (--ent->nRefs == 0 &&
+	    agTextCacheStats.curBytes > agTextCacheStats.maxBytes)
+		ExpireEntries();
+}
+
+/*
+ * Set the maximum size of the pixel data held by the global text cache.
+ * Unreferenced entries beyond this limit are freed immediately.
+ */
+void
+AG_TextCacheSetMaxBytes(AG_Size maxBytes)
+{
+	AG_MutexLock(&agTextLock);
+	agTextCacheStats.maxBytes = maxBytes;
+	ExpireEntries();
+	AG_MutexUnlock(&agTextLock);
+}
+
+/* Return a snapshot of the global text cache statistics. */
+void
+AG_GetTextCacheStats(AG_TextCacheStats *st)
+{
+	AG_MutexLock(&agTextLock);
+	memcpy(st, &agTextCacheStats, sizeof(AG_TextCacheStats));
+	AG_MutexUnlock(&agTextLock);
 }
 
 AG_TextCache *
@@ -63,6 +329,7 @@ AG_TextCacheNew(void *widget, Uint nBuckets, Uint nBucketEnts)
 	tc->buckets = Malloc(nBuckets*sizeof(AG_TextCacheBucket));
 	tc->nBuckets = nBuckets;
 	tc->nBucketEnts = nBucketEnts;
+	TAILQ_INIT(&tc->lru);
 
 	for (i = 0; i < nBuckets; i++) {
 		AG_TextCacheBucket *buck = &tc->buckets[i];
@@ -76,21 +343,25 @@ AG_TextCacheNew(void *widget, Uint nBuckets, Uint nBucketEnts)
 void
 AG_TextCacheClear(AG_TextCache *tc)
 {
-	Uint i;
 	AG_CachedText *ct, *ctNext;
+	Uint i;
 
 #ifdef TEXTCACHE_DEBUG
-	Debug(NULL, "TextCacheDestroy: freeing %d buckets\n", tc->nBuckets);
+	Debug(NULL, "TextCacheClear: freeing %d entries\n", tc->curEnts);
 #endif
+	AG_MutexLock(&agTextLock);
+	for (ct = TAILQ_FIRST(&tc->lru);
+	     ct != TAILQ_END(&tc->lru);
+	     ct = ctNext) {
+		ctNext = TAILQ_NEXT(ct, lru);
+		FreeCachedText(tc, ct);
+	}
+	AG_MutexUnlock(&agTextLock);
+
+	TAILQ_INIT(&tc->lru);
 	for (i = 0; i < tc->nBuckets; i++) {
 		AG_TextCacheBucket *buck = &tc->buckets[i];
 
-		for (ct = TAILQ_FIRST(&buck->ents);
-		     ct != TAILQ_END(&buck->ents);
-		     ct = ctNext) {
-			ctNext = TAILQ_NEXT(ct, ents);
-			FreeCachedText(tc, ct);
-		}
 		TAILQ_INIT(&buck->ents);
 		buck->nEnts = 0;
 	}
@@ -105,110 +376,81 @@ AG_TextCacheDestroy(AG_TextCache *tc)
 	free(tc);
 }
 
-/* Expire some of the oldest entries from the cache. */
-static void
-ExpireEntries(AG_TextCache *_Nonnull tc)
-{
-	AG_CachedText *ct;
-	Uint i;
-
-	for (i = 0; i < tc->nBuckets; i++) {
-		AG_TextCacheBucket *buck = &tc->buckets[i];
-
-		if (buck->nEnts > tc->nBucketEnts) {
-			ct = TAILQ_LAST(&buck->ents, ag_cached_textq);
-#ifdef TEXTCACHE_DEBUG
-			Debug(NULL,
-			    "TextCache: expiring entry #%u (\"%s\"), %u ents\n",
-			    i, ct->text, buck->nEnts);
-#endif
-			TAILQ_REMOVE(&buck->ents, ct, ents);
-			FreeCachedText(tc, ct);
-			buck->nEnts--;
-			tc->curEnts--;
-		}
-	}
-}
-
+/* Unmap the surface and drop our reference to the shared entry. */
 static void
 FreeCachedText(AG_TextCache *_Nonnull tc, AG_CachedText *_Nonnull ct)
 {
 	AG_WidgetUnmapSurface(tc->widget, ct->surface);
-	Free(ct->text);
+	ReleaseSharedEnt(ct->ent);
 	free(ct);
 }
 
-/* Compare two text states. */
-static __inline__ int
-CompareTextStates(const AG_TextState *_Nonnull a, const AG_TextState *_Nonnull b)
+/* Expire the least recently used entry from a widget cache. */
+static void
+ExpireWidgetEntry(AG_TextCache *_Nonnull tc)
 {
-	if (a->font == b->font &&
-	    AG_ColorCompare(&a->color, &b->color) == 0 &&
-	    AG_ColorCompare(&a->colorBG, &b->colorBG) == 0 &&
-	    a->justify == b->justify &&
-	    a->valign == b->valign &&
-	    a->tabWd == b->tabWd) {
-		return (0);
-	}
-	return (1);
+	AG_CachedText *ct;
+	AG_TextCacheBucket *buck;
+
+	ct = TAILQ_LAST(&tc->lru, ag_cached_text_lru);
+	buck = &tc->buckets[ct->ent->hash % tc->nBuckets];
+#ifdef TEXTCACHE_DEBUG
+	Debug(NULL, "TextCache: expiring \"%s\" (%u ents)\n", ct->ent->text,
+	    tc->curEnts);
+#endif
+	TAILQ_REMOVE(&buck->ents, ct, ents);
+	TAILQ_REMOVE(&tc->lru, ct, lru);
+	buck->nEnts--;
+	tc->curEnts--;
+	FreeCachedText(tc, ct);
 }
 
 int
 AG_TextCacheGet(AG_TextCache *tc, const char *text)
 {
-	const AG_TextState *ts = AG_TEXT_STATE_CUR();
+	const AG_TextState *ts;
 	AG_TextCacheBucket *buck;
+	AG_TextCacheEnt *ent;
 	AG_CachedText *ct;
-	AG_Surface *S;
-	Uint h;
+	AG_TextCacheHash h;
 
-	h = Hash_Text(tc, text);
-#ifdef TEXTCACHE_DEBUG
-	Debug(NULL, "TextCacheLookup: string \"%s\" = %u...", text, h);
-#endif
-	buck = &tc->buckets[h];
+	AG_MutexLock(&agTextLock);
+	ts = AG_TEXT_STATE_CUR();
+	h = HashText(text, ts);
+	buck = &tc->buckets[h % tc->nBuckets];
 	TAILQ_FOREACH(ct, &buck->ents, ents) {
-		if (strcmp(ct->text, text) == 0 &&
-		    CompareTextStates(&ct->state, ts) == 0)
+		if (ct->ent->hash == h &&
+		    strcmp(ct->ent->text, text) == 0 &&
+		    CompareTextStates(&ct->ent->state, ts) == 0)
 			break;
 	}
-	if (ct == NULL) {
-#ifdef TEXTCACHE_DEBUG
-		Debug(NULL, "MISS (ent %u)\n", tc->curEnts+1);
-#endif
-		if ((S = AG_TextRender(text)) == NULL) {
-			return (-1);
-		}
-		if ((ct = TryMalloc(sizeof(AG_CachedText))) == NULL) {
-			goto fail;
-		}
-		if ((ct->text = strdup(text)) == NULL) {
-			free(ct);
-			goto fail;
+	if (ct != NULL) {
+		if (ct != TAILQ_FIRST(&tc->lru)) {
+			TAILQ_REMOVE(&tc->lru, ct, lru);
+			TAILQ_INSERT_HEAD(&tc->lru, ct, lru);
 		}
-		ct->surface = AG_WidgetMapSurface(tc->widget, S);
-		memcpy(&ct->state, ts, sizeof(AG_TextState));
-		tc->curEnts++;
-		TAILQ_INSERT_HEAD(&buck->ents, ct, ents);
-		buck->nEnts++;
-
-		if (tc->curEnts > tc->nBuckets*tc->nBucketEnts) {
-#ifdef TEXTCACHE_DEBUG
-			Debug(NULL, "TextCache: Expiring entries "
-			    "(%u > %u)...\n", tc->curEnts,
-			    tc->nBuckets*tc->nBucketEnts);
-#endif
-			ExpireEntries(tc);
-		}
-	} else {
-		TAILQ_REMOVE(&buck->ents, ct, ents);
-		TAILQ_INSERT_HEAD(&buck->ents, ct, ents);
-#ifdef TEXTCACHE_DEBUG
-		Debug(NULL, "HIT\n");
-#endif
+		agTextCacheStats.nHits++;
+		goto out;
+	}
+	if ((ent = GetSharedEnt(text, ts, h)) == NULL) {
+		AG_MutexUnlock(&agTextLock);
+		return (-1);
 	}
+	if ((ct = TryMalloc(sizeof(AG_CachedText))) == NULL) {
+		ReleaseSharedEnt(ent);
+		AG_MutexUnlock(&agTextLock);
+		return (-1);
+	}
+	ct->ent = ent;
+	ct->surface = AG_WidgetMapSurfaceNODUP(tc->widget, ent->su);
+	TAILQ_INSERT_HEAD(&buck->ents, ct, ents);
+	TAILQ_INSERT_HEAD(&tc->lru, ct, lru);
+	buck->nEnts++;
+	tc->curEnts++;
+
+	if (tc->curEnts > tc->nBuckets*tc->nBucketEnts)
+		ExpireWidgetEntry(tc);
+out:
+	AG_MutexUnlock(&agTextLock);
 	return (ct->surface);
-fail:
-	AG_SurfaceFree(S);
-	return (-1);
 }
@@ -6,12 +6,32 @@
 #include <agar/gui/text.h>
 #include <agar/gui/begin.h>
 
-typedef struct ag_cached_text {
+#ifdef AG_HAVE_64BIT
+typedef Uint64 AG_TextCacheHash;		/* FNV-1a hash */
+#else
+typedef Uint32 AG_TextCacheHash;
+#endif
+
+/* Rendered text surface (shared process-wide, reference counted). */
+typedef struct ag_text_cache_ent {
+	AG_TextCacheHash hash;			/* Hash of text and state */
 	char *_Nonnull text;			/* Text string */
-	int surface;				/* Surface mapping */
+	AG_Surface *_Nonnull su;		/* Rendered surface */
+	AG_Size nBytes;				/* Size of pixel data */
+	Uint nRefs;				/* Per-widget references */
 	Uint32 _pad;
 	AG_TextState state;			/* Text rendering state */
-	AG_TAILQ_ENTRY(ag_cached_text) ents;
+	struct ag_text_cache_ent *_Nullable hNext; /* In hash chain */
+	AG_TAILQ_ENTRY(ag_text_cache_ent) lru;	/* In global LRU */
+} AG_TextCacheEnt;
+
+/* Reference to a shared entry, mapped into a widget. */
+typedef struct ag_cached_text {
+	AG_TextCacheEnt *_Nonnull ent;		/* Shared entry */
+	int surface;				/* Surface mapping */
+	Uint32 _pad;
+	AG_TAILQ_ENTRY(ag_cached_text) ents;	/* In bucket */
+	AG_TAILQ_ENTRY(ag_cached_text) lru;	/* In per-widget LRU */
 } AG_CachedText;
 
 typedef struct ag_text_cache_bucket {
@@ -29,14 +49,37 @@ typedef struct ag_text_cache {
 	Uint curEnts;				/* Current entries */
 	Uint nBucketEnts;			/* Target bucket utilization */
 	Uint32 _pad;
+	AG_TAILQ_HEAD(ag_cached_text_lru,ag_cached_text) lru; /* MRU first */
 } AG_TextCache;
 
+/* Statistics on the global text cache. */
+typedef struct ag_text_cache_stats {
+	Uint nHits;				/* Found in widget cache */
+	Uint nSharedHits;			/* Found in global cache */
+	Uint nMisses;				/* Rendered */
+	Uint nEvicted;				/* Evicted from global cache */
+	Uint nEnts;				/* Entries in global cache */
+	Uint32 _pad;
+	AG_Size curBytes;			/* Pixel bytes in use */
+	AG_Size maxBytes;			/* Eviction threshold */
+	AG_Size nEvictedBytes;			/* Total evicted bytes */
+} AG_TextCacheStats;
+
+#ifndef AG_TEXT_CACHE_MAX_BYTES
+#define AG_TEXT_CACHE_MAX_BYTES (8*1024*1024)	/* Default maxBytes */
+#endif
+
 __BEGIN_DECLS
 AG_TextCache *_Nonnull AG_TextCacheNew(void *_Nonnull, Uint, Uint);
 
 void AG_TextCacheClear(AG_TextCache *_Nonnull);
 void AG_TextCacheDestroy(AG_TextCache *_Nonnull);
 int  AG_TextCacheGet(AG_TextCache *_Nonnull, const char *_Nonnull);
+
+void AG_InitTextCache(void);
+void AG_DestroyTextCache(void);
+void AG_TextCacheSetMaxBytes(AG_Size);
+void AG_GetTextCacheStats(AG_TextCacheStats *_Nonnull);
 __END_DECLS
 
 #include <agar/gui/close.h>
@@ -343,6 +343,46 @@ InvalidateLabels(AG_Tlist *tl, AG_TlistItem *it)
 	}
 }
 
+static __inline__ void
+FreeItem(AG_Tlist *_Nonnull tl, AG_TlistItem *_Nonnull it)
+{
+	int i;
+
+	it->tag = 0;
+
+	for (i = 0; i < 3; i++) {
+		if (it->label[i] != -1)
+			AG_WidgetUnmapSurface(tl, it->label[i]);
+	}
+	if (it->iconsrc) {
+		AG_SurfaceFree(it->iconsrc);
+	}
+	if (it->color)
+		free(it->color);
+
+	free(it);
+}
+
+/* Free the recyclable items not reused since the last AG_TlistBegin(). */
+static void
+FreeRecycled(AG_Tlist *_Nonnull tl)
+{
+	AG_TlistItem *it, *nit;
+	Uint i;
+
+	if (tl->nFree == 0) {
+		return;
+	}
+	for (i = 0; i < tl->nFreeTbl; i++) {
+		for (it = tl->freeTbl[i]; it != NULL; it = nit) {
+			nit = it->hNext;
+			FreeItem(tl, it);
+		}
+		tl->freeTbl[i] = NULL;
+	}
+	tl->nFree = 0;
+}
+
 static void
 StyleChanged(AG_Event *_Nonnull event)
 {
@@ -373,7 +413,7 @@ StyleChanged(AG_Event *_Nonnull event)
 		}
 		InvalidateLabels(tl, it);
 	}
-
+	FreeRecycled(tl);
 
 	if ((tl->flags & AG_TLIST_FIXED_HEIGHT) == 0) {
 		tl->item_h = WFONT(tl)->lineskip +
@@ -466,26 +506,6 @@ AG_TlistSizeHintLargest(AG_Tlist *tl, int nItems)
 	AG_ObjectUnlock(tl);
 }
 
-static __inline__ void
-FreeItem(AG_Tlist *_Nonnull tl, AG_TlistItem *_Nonnull it)
-{
-	int i;
-
-	it->tag = 0;
-
-	for (i = 0; i < 3; i++) {
-		if (it->label[i] != -1)
-			AG_WidgetUnmapSurface(tl, it->label[i]);
-	}
-	if (it->iconsrc) {
-		AG_SurfaceFree(it->iconsrc);
-	}
-	if (it->color)
-		free(it->color);
-
-	free(it);
-}
-
 static void
 Destroy(void *_Nonnull p)
 {
@@ -493,6 +513,10 @@ Destroy(void *_Nonnull p)
 	AG_TlistItem *it, *nit;
 	AG_TlistPopup *tp, *ntp;
 
+	FreeRecycled(tl);
+	free(tl->freeTbl);
+	free(tl->savedTbl);
+
 	for (it = TAILQ_FIRST(&tl->selitems);
 	     it != TAILQ_END(&tl->selitems);
 	     it = nit) {
@@ -625,10 +649,8 @@ Draw(void *_Nonnull obj)
 	AG_Rect r = tl->r;
 	int y, i=0, j, selSeen=0, selPos=1, yLast;
 
-	TAILQ_FOREACH(it, &tl->items, items)
-		InvalidateLabels(tl, it);
-
 	UpdatePolled(tl);
+	FreeRecycled(tl);
 
 	if (drawLines)
 		memset(tl->expLevels, 0, tl->nExpLevels * sizeof(int));
@@ -925,22 +947,139 @@ restart:							/* XXX */
 	AG_ObjectUnlock(tl);
 }
 
-/* Clear the items on the list, save the selections if polling. */
+/*
+ * Size a hash table of AG_TlistItem chains for n entries and clear it.
+ * Return -1 if the table could not be allocated.
+ */
+static int
+ResizeTbl(AG_TlistItem *_Nullable *_Nullable *_Nonnull tbl,
+    Uint *_Nonnull nBuckets, Uint n)
+{
+	AG_TlistItem **tblNew;
+	Uint size = 16;
+
+	while (size < n) {
+		size <<= 1;
+	}
+	if (size != *nBuckets) {
+		if ((tblNew = TryRealloc(*tbl, size*sizeof(AG_TlistItem *))) == NULL) {
+			return (-1);
+		}
+		*tbl = tblNew;
+		*nBuckets = size;
+	}
+	memset(*tbl, 0, size*sizeof(AG_TlistItem *));
+	return (0);
+}
+
+/*
+ * Index the saved items by hash_fn. The chains are kept in the order of
+ * the selitems list, so lookups see the same precedence as a linear search.
+ */
+static void
+IndexSavedItems(AG_Tlist *_Nonnull tl)
+{
+	AG_TlistItem *it, **pBucket;
+	Uint nSaved = 0;
+
+	tl->nSaved = 0;
+	if (tl->hash_fn == NULL) {
+		return;
+	}
+	TAILQ_FOREACH(it, &tl->selitems, selitems) {
+		nSaved++;
+	}
+	if (nSaved == 0 ||
+	    ResizeTbl(&tl->savedTbl, &tl->nSavedTbl, nSaved) == -1) {
+		return;
+	}
+	TAILQ_FOREACH_REVERSE(it, &tl->selitems, ag_tlist_itemq, selitems) {
+		it->hash = tl->hash_fn(it);
+		pBucket = &tl->savedTbl[it->hash & (tl->nSavedTbl - 1)];
+		it->hNext = *pBucket;
+		*pBucket = it;
+	}
+	tl->nSaved = nSaved;
+}
+
+/*
+ * Look up the saved state of an item. With multiple matches, return the
+ * first (or last) match in selitems order.
+ */
+static AG_TlistItem *_Nullable
+LookupSaved(AG_Tlist *_Nonnull tl, const AG_TlistItem *_Nonnull it, int last)
+{
+	AG_TlistItem *itSaved, *itMatch = NULL;
+
+	if (tl->nSaved > 0) {
+		const Uint32 h = tl->hash_fn(it);
+
+		for (itSaved = tl->savedTbl[h & (tl->nSavedTbl - 1)];
+		     itSaved != NULL;
+		     itSaved = itSaved->hNext) {
+			if (itSaved->hash == h && tl->compare_fn(itSaved, it)) {
+				itMatch = itSaved;
+				if (!last)
+					break;
+			}
+		}
+	} else {
+		TAILQ_FOREACH(itSaved, &tl->selitems, selitems) {
+			if (tl->compare_fn(itSaved, it)) {
+				itMatch = itSaved;
+				if (!last)
+					break;
+			}
+		}
+	}
+	return (itMatch);
+}
+
+/*
+ * Clear the items on the list, save the selections if polling.
+ *
+ * Cleared items are kept in a table of recyclable items (indexed by text),
+ * along with their rendered labels, until AG_TlistEnd() or the next draw.
+ * The saved selection and expansion state is kept in copies of the items.
+ */
 void
 AG_TlistBegin(AG_Tlist *tl)
 {
-	AG_TlistItem *it, *nit;
+	AG_TlistItem *it, *nit, *itSaved, **pBucket;
+	int recycle;
 	
 	AG_OBJECT_ISA(tl, "AG_Widget:AG_Tlist:*");
 	AG_ObjectLock(tl);
 
+	FreeRecycled(tl);
+	recycle = (tl->nItems > 0 &&
+	           ResizeTbl(&tl->freeTbl, &tl->nFreeTbl, tl->nItems) == 0);
+
 	for (it = TAILQ_FIRST(&tl->items);
 	     it != TAILQ_END(&tl->items);
 	     it = nit) {
 		nit = TAILQ_NEXT(it, items);
 		if ((!(tl->flags & AG_TLIST_STATELESS) && it->selected) ||
 		      (it->flags & AG_TLIST_HAS_CHILDREN)) {
-			TAILQ_INSERT_HEAD(&tl->selitems, it, selitems);
+			if (!recycle ||
+			    (itSaved = TryMalloc(sizeof(AG_TlistItem))) == NULL) {
+				TAILQ_INSERT_HEAD(&tl->selitems, it, selitems);
+				continue;
+			}
+			memcpy(itSaved, it, sizeof(AG_TlistItem));
+			itSaved->label[0] = -1;
+			itSaved->label[1] = -1;
+			itSaved->label[2] = -1;
+			itSaved->iconsrc = NULL;
+			itSaved->color = NULL;
+			TAILQ_INSERT_HEAD(&tl->selitems, itSaved, selitems);
+		}
+		if (recycle) {
+			it->hash = AG_TlistHashStrings(it);
+			pBucket = &tl->freeTbl[it->hash & (tl->nFreeTbl - 1)];
+			it->hNext = *pBucket;
+			*pBucket = it;
+			tl->nFree++;
 		} else {
 			FreeItem(tl, it);
 		}
@@ -948,6 +1087,8 @@ AG_TlistBegin(AG_Tlist *tl)
 	TAILQ_INIT(&tl->items);
 	tl->nItems = 0;
 
+	IndexSavedItems(tl);
+
 	AG_Redraw(tl);
 	AG_ObjectUnlock(tl);
 }
@@ -996,7 +1137,54 @@ AG_TlistComparePtrsAndCats(const AG_TlistItem *a, const AG_TlistItem *b)
 		 (strcmp(a->cat, b->cat) == 0)));
 }
 
-/* Set an alternate compare function for items. */
+/*
+ * Hash the fields compared by AG_TlistComparePtrs(), AG_TlistCompareStrings()
+ * and AG_TlistComparePtrsAndCats() (32-bit FNV-1a).
+ */
+static __inline__ Uint32
+HashBytes(Uint32 h, const void *_Nonnull p, AG_Size len)
+{
+	const Uchar *c = p, *cEnd = &c[len];
+
+	for (; c < cEnd; c++) {
+		h ^= *c;
+		h *= 16777619U;
+	}
+	return (h);
+}
+static __inline__ Uint32
+HashStr(Uint32 h, const char *_Nonnull s)
+{
+	const Uchar *c;
+
+	for (c = (const Uchar *)s; *c != '\0'; c++) {
+		h ^= *c;
+		h *= 16777619U;
+	}
+	return (h);
+}
+Uint32
+AG_TlistHashPtrs(const AG_TlistItem *it)
+{
+	return HashBytes(2166136261U, &it->p1, sizeof(void *));
+}
+Uint32
+AG_TlistHashStrings(const AG_TlistItem *it)
+{
+	return HashStr(2166136261U, it->text);
+}
+Uint32
+AG_TlistHashPtrsAndCats(const AG_TlistItem *it)
+{
+	const Uint32 h = HashBytes(2166136261U, &it->p1, sizeof(void *));
+
+	return (it->cat != NULL) ? HashStr(h, it->cat) : h;
+}
+
+/*
+ * Set an alternate compare function for items. If it is one of the
+ * standard compare functions, select the matching hash function.
+ */
 AG_TlistCompareFn
 AG_TlistSetCompareFn(AG_Tlist *tl,
     int (*fn)(const AG_TlistItem *_Nonnull, const AG_TlistItem *_Nonnull))
@@ -1009,6 +1197,39 @@ AG_TlistSetCompareFn(AG_Tlist *tl,
 	fnOrig = tl->compare_fn;
 	tl->compare_fn = fn;
 
+	if (fn == AG_TlistComparePtrs) {
+		tl->hash_fn = AG_TlistHashPtrs;
+	} else if (fn == AG_TlistCompareStrings) {
+		tl->hash_fn = AG_TlistHashStrings;
+	} else if (fn == AG_TlistComparePtrsAndCats) {
+		tl->hash_fn = AG_TlistHashPtrsAndCats;
+	} else {
+		tl->hash_fn = NULL;
+	}
+	IndexSavedItems(tl);
+
+	AG_ObjectUnlock(tl);
+
+	return (fnOrig);
+}
+
+/*
+ * Set a hash function consistent with the compare function (items which
+ * compare equal must hash equal) for restoring saved item state in constant
+ * time. If NULL, saved items are searched linearly.
+ */
+AG_TlistHashFn
+AG_TlistSetHashFn(AG_Tlist *tl, AG_TlistHashFn fn)
+{
+	AG_TlistHashFn fnOrig;
+
+	AG_OBJECT_ISA(tl, "AG_Widget:AG_Tlist:*");
+	AG_ObjectLock(tl);
+
+	fnOrig = tl->hash_fn;
+	tl->hash_fn = fn;
+	IndexSavedItems(tl);
+
 	AG_ObjectUnlock(tl);
 
 	return (fnOrig);
@@ -1023,12 +1244,9 @@ AG_TlistEnd(AG_Tlist *tl)
 	AG_OBJECT_ISA(tl, "AG_Widget:AG_Tlist:*");
 	AG_ObjectLock(tl);
 
-	for (sit = TAILQ_FIRST(&tl->selitems);
-	     sit != TAILQ_END(&tl->selitems);
-	     sit = nsit) {
-		nsit = TAILQ_NEXT(sit, selitems);
+	if (!TAILQ_EMPTY(&tl->selitems)) {
 		TAILQ_FOREACH(cit, &tl->items, items) {
-			if (!tl->compare_fn(sit, cit)) {
+			if ((sit = LookupSaved(tl, cit, 1)) == NULL) {
 				continue;
 			}
 			if (!(tl->flags & AG_TLIST_STATELESS)) {
@@ -1040,9 +1258,17 @@ AG_TlistEnd(AG_Tlist *tl)
 				cit->flags &= ~(AG_TLIST_ITEM_EXPANDED);
 			}
 		}
+	}
+	for (sit = TAILQ_FIRST(&tl->selitems);
+	     sit != TAILQ_END(&tl->selitems);
+	     sit = nsit) {
+		nsit = TAILQ_NEXT(sit, selitems);
 		FreeItem(tl, sit);
 	}
 	TAILQ_INIT(&tl->selitems);
+	tl->nSaved = 0;
+
+	FreeRecycled(tl);
 
 	AG_ObjectUnlock(tl);
 }
@@ -1062,11 +1288,7 @@ AG_TlistVisibleChildren(AG_Tlist *tl, AG_TlistItem *it)
 	if ((it->flags & AG_TLIST_HAS_CHILDREN) == 0) {
 		return (0);
 	}
-	AG_TAILQ_FOREACH(itSaved, &tl->selitems, selitems) {
-		if (tl->compare_fn(itSaved, it))
-			break;
-	}
-	if (itSaved == NULL) {
+	if ((itSaved = LookupSaved(tl, it, 0)) == NULL) {
 		return (tl->flags & AG_TLIST_EXPAND_NODES);  /* Default state */
 	}
 	return (itSaved->flags & AG_TLIST_ITEM_EXPANDED);      /* Saved state */
@@ -1084,6 +1306,80 @@ AG_TlistRefresh(AG_Tlist *tl)
 	AG_ObjectUnlock(tl);
 }
 
+/* Test whether two item icons have identical contents. */
+static int
+SameIcon(const AG_Surface *_Nullable a, const AG_Surface *_Nullable b)
+{
+	Uint y, len;
+
+	if (a == NULL || b == NULL) {
+		return (a == b);
+	}
+	if (a->w != b->w || a->h != b->h ||
+	    AG_PixelFormatCompare(&a->format, &b->format) != 0) {
+		return (0);
+	}
+	len = (a->w * a->format.BitsPerPixel + 7) >> 3;
+	for (y = 0; y < a->h; y++) {
+		if (memcmp(&a->pixels[y*a->pitch], &b->pixels[y*b->pitch],
+		    len) != 0)
+			return (0);
+	}
+	return (1);
+}
+
+/*
+ * Return a new item with the given icon and text. If an item with the same
+ * icon and text was cleared by AG_TlistBegin(), recycle it (along with its
+ * rendered labels).
+ */
+static AG_TlistItem *_Nonnull
+NewItem(AG_Tlist *_Nonnull tl, const AG_Surface *_Nullable icon,
+    const char *_Nonnull text)
+{
+	AG_TlistItem *it, **pit;
+	Uint32 h;
+
+	if (tl->nFree == 0) {
+		goto new_item;
+	}
+	h = HashStr(2166136261U, text);
+	for (pit = &tl->freeTbl[h & (tl->nFreeTbl - 1)];
+	     (it = *pit) != NULL;
+	     pit = &it->hNext) {
+		if (it->hash == h && strcmp(it->text, text) == 0 &&
+		    SameIcon(it->iconsrc, icon))
+			break;
+	}
+	if (it == NULL) {
+		goto new_item;
+	}
+	*pit = it->hNext;
+	tl->nFree--;
+
+	if (it->color != NULL || it->font != NULL) {
+		InvalidateLabels(tl, it);
+		free(it->color);
+	}
+	it->tag = agNonObjectSignature;
+	it->v = -1;
+	it->cat = "";
+	memset(&it->p1, 0, sizeof(void *) +         /* p1 */
+	                   sizeof(AG_Color *) +     /* color */
+	                   sizeof(AG_Font *) +      /* font */
+	                   sizeof(int) +            /* selected */
+	                   sizeof(Uint) +           /* depth */
+	                   sizeof(Uint));           /* flags */
+	it->scale = 1.0f;
+	it->u = 0;
+	it->hNext = NULL;
+	return (it);
+new_item:
+	it = AG_TlistItemNew(icon);
+	Strlcpy(it->text, text, sizeof(it->text));
+	return (it);
+}
+
 static __inline__ void
 InsertItemHead(AG_Tlist *_Nonnull tl, AG_TlistItem *_Nonnull it)
 {
@@ -1117,9 +1413,8 @@ AG_TlistAddPtr(AG_Tlist *tl, const AG_Surface *icon, const char *text,
 
 	AG_OBJECT_ISA(tl, "AG_Widget:AG_Tlist:*");
 
-	it = AG_TlistItemNew(icon);
+	it = NewItem(tl, icon, text);
 	it->p1 = p1;
-	Strlcpy(it->text, text, sizeof(it->text));
 
 	InsertItemTail(tl, it);
 	return (it);
@@ -1130,15 +1425,16 @@ AG_TlistItem *_Nonnull
 AG_TlistAdd(AG_Tlist *tl, const AG_Surface *icon, const char *fmt, ...)
 {
 	AG_TlistItem *it;
+	char text[AG_TLIST_LABEL_MAX];
 	va_list args;
 
 	AG_OBJECT_ISA(tl, "AG_Widget:AG_Tlist:*");
 	
-	it = AG_TlistItemNew(icon);
-	it->p1 = it->text;
 	va_start(args, fmt);
-	Vsnprintf(it->text, sizeof(it->text), fmt, args);
+	Vsnprintf(text, sizeof(text), fmt, args);
 	va_end(args);
+	it = NewItem(tl, icon, text);
+	it->p1 = it->text;
 
 	InsertItemTail(tl, it);
 	return (it);
@@ -1152,9 +1448,8 @@ AG_TlistAddS(AG_Tlist *tl, const AG_Surface *icon, const char *text)
 
 	AG_OBJECT_ISA(tl, "AG_Widget:AG_Tlist:*");
 
-	it = AG_TlistItemNew(icon);
+	it = NewItem(tl, icon, text);
 	it->p1 = it->text;
-	Strlcpy(it->text, text, sizeof(it->text));
 
 	InsertItemTail(tl, it);
 	return (it);
@@ -1165,15 +1460,16 @@ AG_TlistItem *
 AG_TlistAddHead(AG_Tlist *tl, const AG_Surface *icon, const char *fmt, ...)
 {
 	AG_TlistItem *it;
+	char text[AG_TLIST_LABEL_MAX];
 	va_list args;
 
 	AG_OBJECT_ISA(tl, "AG_Widget:AG_Tlist:*");
 	
-	it = AG_TlistItemNew(icon);
-	it->p1 = it->text;
 	va_start(args, fmt);
-	Vsnprintf(it->text, sizeof(it->text), fmt, args);
+	Vsnprintf(text, sizeof(text), fmt, args);
 	va_end(args);
+	it = NewItem(tl, icon, text);
+	it->p1 = it->text;
 
 	InsertItemHead(tl, it);
 	return (it);
@@ -1187,9 +1483,8 @@ AG_TlistAddHeadS(AG_Tlist *tl, const AG_Surface *icon, const char *text)
 
 	AG_OBJECT_ISA(tl, "AG_Widget:AG_Tlist:*");
 
-	it = AG_TlistItemNew(icon);
+	it = NewItem(tl, icon, text);
 	it->p1 = it->text;
-	Strlcpy(it->text, text, sizeof(it->text));
 
 	InsertItemHead(tl, it);
 	return (it);
@@ -1204,9 +1499,8 @@ AG_TlistAddPtrHead(AG_Tlist *tl, const AG_Surface *icon, const char *text,
 
 	AG_OBJECT_ISA(tl, "AG_Widget:AG_Tlist:*");
 
-	it = AG_TlistItemNew(icon);
+	it = NewItem(tl, icon, text);
 	it->p1 = p1;
-	Strlcpy(it->text, text, sizeof(it->text));
 
 	InsertItemHead(tl, it);
 	return (it);
@@ -1299,6 +1593,8 @@ AG_TlistItemNew(const AG_Surface *icon)
 	it->scale = 1.0f;
 	it->text[0] = '\0';
 	it->u = 0;
+	it->hash = 0;
+	it->hNext = NULL;
 
 	return (it);
 }
@@ -1846,6 +2142,13 @@ Init(void *_Nonnull obj)
 	tl->nVisible = 0;
 	TAILQ_INIT(&tl->popups);
 	tl->compare_fn = AG_TlistComparePtrs;
+	tl->hash_fn = AG_TlistHashPtrs;
+	tl->savedTbl = NULL;
+	tl->freeTbl = NULL;
+	tl->nSavedTbl = 0;
+	tl->nSaved = 0;
+	tl->nFreeTbl = 0;
+	tl->nFree = 0;
 	tl->popupEv = NULL;
 	tl->changedEv = NULL;
 	tl->dblClickEv = NULL;
@@ -2044,6 +2347,7 @@ AG_TlistSetItemHeight(AG_Tlist *tl, int ih)
 	TAILQ_FOREACH(it, &tl->items, items) {
 		InvalidateLabels(tl, it);
 	}
+	FreeRecycled(tl);
 	AG_Redraw(tl);
 	AG_ObjectUnlock(tl);
 }
@@ -2062,6 +2366,7 @@ AG_TlistSetIconWidth(AG_Tlist *tl, int iw)
 	TAILQ_FOREACH(it, &tl->items, items) {
 		InvalidateLabels(tl, it);
 	}
+	FreeRecycled(tl);
 	AG_Redraw(tl);
 	AG_ObjectUnlock(tl);
 }
@@ -48,6 +48,8 @@ typedef struct ag_tlist_item {
 	float scale;                     /* Text scaling factor */
 	char text[AG_TLIST_LABEL_MAX];   /* Label text */
 	Uint u;                          /* App-specific unsigned integer */
+	Uint32 hash;                     /* Key hash (saved or recycled item) */
+	struct ag_tlist_item *_Nullable hNext;  /* In hash chain */
 
 	AG_TAILQ_ENTRY(ag_tlist_item) items;    /* Items in list */
 	AG_TAILQ_ENTRY(ag_tlist_item) selitems; /* Saved selection state */
@@ -57,6 +59,7 @@ typedef AG_TAILQ_HEAD(ag_tlist_itemq, ag_tlist_item) AG_TlistItemQ;
 
 typedef int (*AG_TlistCompareFn)(const AG_TlistItem *_Nonnull,
 	                         const AG_TlistItem *_Nonnull);
+typedef Uint32 (*AG_TlistHashFn)(const AG_TlistItem *_Nonnull);
 
 /* Tree/list widget */
 typedef struct ag_tlist {
@@ -96,6 +99,13 @@ typedef struct ag_tlist {
 	AG_Scrollbar *_Nonnull sbar;    /* Vertical scrollbar */
 	AG_TAILQ_HEAD_(ag_tlist_popup) popups; /* Popup menus */
 	AG_TlistCompareFn compare_fn;   /* Item-item comparison function */
+	AG_TlistHashFn hash_fn;         /* Hash of compared fields (or NULL) */
+	AG_TlistItem *_Nullable *_Nullable savedTbl; /* Saved items by hash_fn */
+	AG_TlistItem *_Nullable *_Nullable freeTbl;  /* Recyclable items by text */
+	Uint nSavedTbl;                 /* Buckets in savedTbl (power of 2) */
+	Uint nSaved;                    /* Items in savedTbl (0 = linear search) */
+	Uint nFreeTbl;                  /* Buckets in freeTbl (power of 2) */
+	Uint nFree;                     /* Items in freeTbl */
 	AG_Event *_Nullable popupEv;    /* Popup menu hook */
 	AG_Event *_Nullable changedEv;  /* Selection change hook */
 	AG_Event *_Nullable dblClickEv; /* Double click hook */
@@ -241,6 +251,7 @@ void AG_TlistSetChangedFn(AG_Tlist *_Nonnull, _Nonnull AG_EventFn,
                           const char *_Nullable, ...);
 
 AG_TlistCompareFn AG_TlistSetCompareFn(AG_Tlist *_Nonnull, AG_TlistCompareFn);
+AG_TlistHashFn AG_TlistSetHashFn(AG_Tlist *_Nonnull, AG_TlistHashFn _Nullable);
 
 int  AG_TlistCompareInts(const AG_TlistItem *_Nonnull, const AG_TlistItem *_Nonnull)
                          _Pure_Attribute;
@@ -257,6 +268,10 @@ int  AG_TlistComparePtrsAndCats(const AG_TlistItem *_Nonnull,
                                 const AG_TlistItem *_Nonnull)
                                 _Pure_Attribute;
 
+Uint32 AG_TlistHashPtrs(const AG_TlistItem *_Nonnull) _Pure_Attribute;
+Uint32 AG_TlistHashStrings(const AG_TlistItem *_Nonnull) _Pure_Attribute;
+Uint32 AG_TlistHashPtrsAndCats(const AG_TlistItem *_Nonnull) _Pure_Attribute;
+
 void AG_TlistSort(AG_Tlist *_Nonnull);
 void AG_TlistSortByInt(AG_Tlist *_Nonnull);
 void AG_TlistRefresh(AG_Tlist *_Nonnull);
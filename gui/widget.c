@@ -1627,9 +1627,8 @@ void
 AG_WidgetUpdateCoords(void *obj, int x, int y)
 {
 	AG_Widget *wid = obj, *chld;
-#ifdef HAVE_OPENGL
 	const AG_Rect2 rPrev = wid->rView;
-#endif
+
 	wid->flags &= ~(AG_WIDGET_UPDATE_WINDOW);
 
 	if (AG_WINDOW_ISA(wid) &&
@@ -1651,10 +1650,19 @@ AG_WidgetUpdateCoords(void *obj, int x, int y)
 	wid->rSens.x2 = x + wid->w;
 	wid->rSens.y2 = y + wid->h;
 
+	if (AG_RectCompare2(&wid->rView, &rPrev) != 0) {
 #ifdef HAVE_OPENGL
-	if (AG_RectCompare2(&wid->rView, &rPrev) != 0)
 		wid->flags |= AG_WIDGET_GL_RESHAPE;
 #endif
+		/*
+		 * The widget was moved or resized. Damage both the area it
+		 * used to cover and its new area.
+		 */
+		if (wid->window != NULL && !AG_WINDOW_ISA(wid)) {
+			AG_WindowDamage(wid->window, &rPrev);
+			AG_WindowDamage(wid->window, &wid->rView);
+		}
+	}
 	OBJECT_FOREACH_CHILD(chld, wid, ag_widget)               /* Recurse */
 		AG_WidgetUpdateCoords(chld,
 		    wid->rView.x1 + chld->x,
@@ -1964,6 +1972,19 @@ AG_WidgetDraw(void *p)
 	    (flags & (AG_WIDGET_HIDE | AG_WIDGET_UNDERSIZE)))
 		goto out;
 
+	if (wid->window != NULL &&
+	    wid->window->dirty == AG_WINDOW_DIRTY_DAMAGED) {
+		const AG_Rect2 *rDmg = &wid->window->rDamage;
+		const AG_Rect2 *rView = &wid->rView;
+
+		if (rView->x2 <= rDmg->x1 || rView->x1 >= rDmg->x2 ||
+		    rView->y2 <= rDmg->y1 || rView->y1 >= rDmg->y2) {
+			agRedrawStats.nSkippedCur++;      /* Outside damage */
+			goto out;
+		}
+	}
+	agRedrawStats.nDrawnCur++;
+
 	if (flags & AG_WIDGET_DISABLED)       { wid->state = AG_DISABLED_STATE; }
 	else if (flags & AG_WIDGET_MOUSEOVER) { wid->state = AG_HOVER_STATE;    }
 	else if (flags & AG_WIDGET_FOCUSED)   { wid->state = AG_FOCUSED_STATE;  }
@@ -2179,6 +2200,7 @@ CompileStyleRecursive(AG_Widget *_Nonnull wid, const char *_Nonnull parentFace,
     float parentFontSize, Uint parentFontFlags, const AG_WidgetPalette *parentPalette)
 {
 	AG_StyleSheet *css = &agDefaultCSS;
+	AG_StyleMatch sm;
 	char *fontFace, *cssData;
 	AG_Widget *chld;
 	AG_Variable *V;
@@ -2198,6 +2220,7 @@ CompileStyleRecursive(AG_Widget *_Nonnull wid, const char *_Nonnull parentFace,
 			break;
 		}
 	}
+	AG_MatchStyleSheet(css, wid, &sm);
 
 	/*
 	 * Font face (fontconfig name or specific filename under font-path).
@@ -2205,7 +2228,7 @@ CompileStyleRecursive(AG_Widget *_Nonnull wid, const char *_Nonnull parentFace,
 	if ((V = AG_AccessVariable(wid, "font-family")) != NULL) {
 		fontFace = Strdup(V->data.s);
 		AG_UnlockVariable(V);
-	} else if (AG_LookupStyleSheet(css, wid, "font-family", &cssData)) {
+	} else if (AG_LookupStyleMatch(&sm, "font-family", &cssData)) {
 		fontFace = Strdup(cssData);
 	} else {
 		fontFace = Strdup(parentFace);
@@ -2218,7 +2241,7 @@ CompileStyleRecursive(AG_Widget *_Nonnull wid, const char *_Nonnull parentFace,
 	if ((V = AG_AccessVariable(wid, "font-size")) != NULL) {
 		Apply_Font_Size(&fontSize, parentFontSize, V->data.s);
 		AG_UnlockVariable(V);
-	} else if (AG_LookupStyleSheet(css, wid, "font-size", &cssData)) {
+	} else if (AG_LookupStyleMatch(&sm, "font-size", &cssData)) {
 		Apply_Font_Size(&fontSize, parentFontSize, cssData);
 	} else {
 		fontSize = parentFontSize;
@@ -2231,7 +2254,7 @@ CompileStyleRecursive(AG_Widget *_Nonnull wid, const char *_Nonnull parentFace,
 	if ((V = AG_AccessVariable(wid, "font-weight")) != NULL) {
 		Apply_Font_Weight(&fontFlags, parentFontFlags, V->data.s);
 		AG_UnlockVariable(V);
-	} else if (AG_LookupStyleSheet(css, wid, "font-weight", &cssData)) {
+	} else if (AG_LookupStyleMatch(&sm, "font-weight", &cssData)) {
 		Apply_Font_Weight(&fontFlags, parentFontFlags, cssData);
 	} else {
 		fontFlags &= ~(AG_FONT_WEIGHTS);
@@ -2244,7 +2267,7 @@ CompileStyleRecursive(AG_Widget *_Nonnull wid, const char *_Nonnull parentFace,
 	if ((V = AG_AccessVariable(wid, "font-style")) != NULL) {
 		Apply_Font_Style(&fontFlags, parentFontFlags, V->data.s);
 		AG_UnlockVariable(V);
-	} else if (AG_LookupStyleSheet(css, wid, "font-style", &cssData)) {
+	} else if (AG_LookupStyleMatch(&sm, "font-style", &cssData)) {
 		Apply_Font_Style(&fontFlags, parentFontFlags, cssData);
 	} else {
 		fontFlags &= ~(AG_FONT_STYLES);
@@ -2258,7 +2281,7 @@ CompileStyleRecursive(AG_Widget *_Nonnull wid, const char *_Nonnull parentFace,
 	if ((V = AG_AccessVariable(wid, "font-stretch")) != NULL) {
 		Apply_Font_Stretch(&fontFlags, parentFontFlags, V->data.s);
 		AG_UnlockVariable(V);
-	} else if (AG_LookupStyleSheet(css, wid, "font-stretch", &cssData)) {
+	} else if (AG_LookupStyleMatch(&sm, "font-stretch", &cssData)) {
 		Apply_Font_Stretch(&fontFlags, parentFontFlags, cssData);
 	} else {
 		fontFlags &= ~(AG_FONT_WD_VARIANTS);
@@ -2274,13 +2297,13 @@ CompileStyleRecursive(AG_Widget *_Nonnull wid, const char *_Nonnull parentFace,
 	if ((V = AG_AccessVariable(wid, "padding")) != NULL) {
 		Apply_Padding(wid, V->data.s);
 		AG_UnlockVariable(V);
-	} else if (AG_LookupStyleSheet(css, wid, "padding", &cssData)) {
+	} else if (AG_LookupStyleMatch(&sm, "padding", &cssData)) {
 		Apply_Padding(wid, cssData);
 	}
 	if ((V = AG_AccessVariable(wid, "margin")) != NULL) {
 		Apply_Margin(wid, V->data.s);
 		AG_UnlockVariable(V);
-	} else if (AG_LookupStyleSheet(css, wid, "margin", &cssData)) {
+	} else if (AG_LookupStyleMatch(&sm, "margin", &cssData)) {
 		Apply_Margin(wid, cssData);
 	}
 
@@ -2290,7 +2313,7 @@ CompileStyleRecursive(AG_Widget *_Nonnull wid, const char *_Nonnull parentFace,
 	if ((V = AG_AccessVariable(wid, "spacing")) != NULL) {
 		Apply_Spacing(wid, V->data.s);
 		AG_UnlockVariable(V);
-	} else if (AG_LookupStyleSheet(css, wid, "spacing", &cssData)) {
+	} else if (AG_LookupStyleMatch(&sm, "spacing", &cssData)) {
 		Apply_Spacing(wid, cssData);
 	}
 	
@@ -2314,8 +2337,8 @@ CompileStyleRecursive(AG_Widget *_Nonnull wid, const char *_Nonnull parentFace,
 			      V->data.s[0] != '\0') {
 				AG_ColorFromString(&cNew, V->data.s, cParent);
 				AG_UnlockVariable(V);
-			} else if ((AG_LookupStyleSheet(css, wid, nameFull, &cssData) ||
-			            AG_LookupStyleSheet(css, wid, name, &cssData)) &&
+			} else if ((AG_LookupStyleMatch(&sm, nameFull, &cssData) ||
+			            AG_LookupStyleMatch(&sm, name, &cssData)) &&
 			           cssData[0] != '\0') {
 				AG_ColorFromString(&cNew, cssData, cParent);
 			} else {
@@ -66,6 +66,7 @@ AG_WindowQ agWindowHideQ;               /* Async Window Hide queue */
 AG_Window *agWindowToFocus = NULL;      /* Window to focus next */
 AG_Window *agWindowFocused = NULL;      /* Window holding focus */
 Uint       agWindowPinnedCount = 0;     /* Number of pinned windows */
+AG_RedrawStats agRedrawStats = { 0,0,0,0,0,0 };  /* Redraw statistics */
 
 #if defined(AG_DEBUG) && defined(AG_WIDGETS)
 AG_Window *_Nullable agDebuggerTgtWindow = NULL;     /* For GUI debugger */
@@ -911,6 +912,9 @@ OnHide(AG_Event *_Nonnull event)
 				r.h = HEIGHT(win) + 1;
 				AGDRIVER_CLASS(drv)->updateRegion(drv, &r);
 			}
+			/* Windows below need redrawing in the exposed area. */
+			AG_RectUnion2(&dsw->rDamage, &dsw->rDamage,
+			    &WIDGET(win)->rView);
 		}
 		break;
 	case AG_WM_MULTIPLE:
@@ -1122,9 +1126,72 @@ out:
 	AG_UnlockVFS(&agDrivers);
 }
 
+/*
+ * Redraw the damaged region of a single-window framebuffer display.
+ *
+ * The region is the union of the damaged regions of all visible windows
+ * (and of areas exposed by window moves or hides). Every window which
+ * intersects it is rendered in z-order with the region as clipping
+ * rectangle, so widgets outside of it are skipped by AG_WidgetDraw().
+ */
+static void
+DrawDamagedSW(AG_DriverSw *_Nonnull dsw)
+{
+	AG_Window *win;
+	AG_Rect2 rDamage = dsw->rDamage;
+	AG_Rect r;
+
+	AG_FOREACH_WINDOW(win, dsw) {
+		if (!win->visible || !win->dirty) {
+			continue;
+		}
+		if (win->dirty == AG_WINDOW_DIRTY_DAMAGED) {
+			AG_RectUnion2(&rDamage, &rDamage, &win->rDamage);
+		} else {
+			AG_RectUnion2(&rDamage, &rDamage, &WIDGET(win)->rView);
+		}
+	}
+	dsw->rDamage.w = 0;
+	if (rDamage.w <= 0 || rDamage.h <= 0)
+		return;
+
+	AG_Rect2ToRect(&r, &rDamage);
+	AGDRIVER_CLASS(dsw)->pushClipRect(dsw, &r);
+	AG_FOREACH_WINDOW(win, dsw) {
+		if (!win->visible) {
+			continue;
+		}
+		AG_ObjectLock(win);
+		if (AG_RectIntersect2(&win->rDamage, &rDamage,
+		    &WIDGET(win)->rView)) {
+			win->dirty = AG_WINDOW_DIRTY_DAMAGED;
+			AGDRIVER_CLASS(dsw)->renderWindow(win);
+		}
+		win->dirty = 0;
+		AG_ObjectUnlock(win);
+	}
+	AGDRIVER_CLASS(dsw)->popClipRect(dsw);
+	agRedrawStats.nPartial++;
+}
+
+/* Close the redraw statistics of the current frame. */
+static __inline__ void
+EndRedrawStats(void)
+{
+	agRedrawStats.nFrames++;
+	agRedrawStats.nDrawn = agRedrawStats.nDrawnCur;
+	agRedrawStats.nSkipped = agRedrawStats.nSkippedCur;
+	agRedrawStats.nDrawnCur = 0;
+	agRedrawStats.nSkippedCur = 0;
+}
+
 /*
  * Render all windows that need to be redrawn. This is typically invoked
  * by the main event loop after all events have been processed.
+ *
+ * On single-window framebuffer drivers, only the damaged region (see
+ * AG_Redraw()) is redrawn and presented. Other drivers redraw entire
+ * windows.
  */ 
 void
 AG_WindowDrawQueued(void)
@@ -1143,10 +1210,12 @@ AG_WindowDrawQueued(void)
 				}
 				AG_ObjectLock(win);
 				AG_BeginRendering(drv);
+				win->dirty = 1;			/* Full redraw */
 				AGDRIVER_CLASS(drv)->renderWindow(win);
 				AG_EndRendering(drv);
 				win->dirty = 0;
 				AG_ObjectUnlock(win);
+				EndRedrawStats();
 			}
 			break;
 		case AG_WM_SINGLE:
@@ -1170,19 +1239,28 @@ AG_WindowDrawQueued(void)
 						if (win->visible && win->dirty)
 							break;
 				}
-				if (doRedraw || win != NULL) {
-					AG_BeginRendering(drv);
+				if (!doRedraw && win == NULL && dsw->rDamage.w <= 0)
+					break;
+
+				AG_BeginRendering(drv);
+				if (!doRedraw &&
+				    AGDRIVER_CLASS(drv)->type == AG_FRAMEBUFFER) {
+					DrawDamagedSW(dsw);
+				} else {
+					dsw->rDamage.w = 0;
 					AG_FOREACH_WINDOW(win, drv) {
 						if (!win->visible) {
 							continue;
 						}
 						AG_ObjectLock(win);
+						win->dirty = 1;	/* Full redraw */
 						AGDRIVER_CLASS(drv)->renderWindow(win);
 						win->dirty = 0;
 						AG_ObjectUnlock(win);
 					}
-					AG_EndRendering(drv);
 				}
+				AG_EndRendering(drv);
+				EndRedrawStats();
 			}
 			break;
 		}
@@ -2796,8 +2874,20 @@ AG_WindowDraw(AG_Window *_Nonnull win)
 		return;
 
 	AG_OBJECT_ISA(drv, "AG_Driver:*");
-	AGDRIVER_CLASS(drv)->renderWindow(win);
 
+	if (win->dirty == AG_WINDOW_DIRTY_DAMAGED &&
+	    AGDRIVER_SINGLE(drv) &&
+	    AGDRIVER_CLASS(drv)->type == AG_FRAMEBUFFER) {
+		AG_Rect r;
+
+		AG_Rect2ToRect(&r, &win->rDamage);
+		AGDRIVER_CLASS(drv)->pushClipRect(drv, &r);
+		AGDRIVER_CLASS(drv)->renderWindow(win);
+		AGDRIVER_CLASS(drv)->popClipRect(drv);
+	} else {
+		win->dirty = 1;					/* Full redraw */
+		AGDRIVER_CLASS(drv)->renderWindow(win);
+	}
 	win->dirty = 0;
 }
 
@@ -2905,7 +2995,11 @@ AG_WindowSetGeometryMax(AG_Window *_Nonnull win)
 	AG_WindowSetGeometry(win, 0, 0, wMax, hMax);
 }
 
-/* Request widget redraw. */
+/*
+ * Request widget redraw. If obj is a window, redraw it entirely.
+ * Otherwise, add the widget's area to the window's damaged region
+ * (on framebuffer drivers, only this region will be redrawn).
+ */
 void
 AG_Redraw(void *_Nonnull obj)
 {
@@ -2917,10 +3011,47 @@ AG_Redraw(void *_Nonnull obj)
 	    WIDGET(obj)->window ? OBJECT(WIDGET(obj)->window)->name : "(null)",
 	    AG_GetTicks());
 #endif
-	if ((win = WIDGET(obj)->window) != NULL) {
-		AG_OBJECT_ISA(win, "AG_Widget:AG_Window:*");
-		win->dirty = 1;
+	if ((win = WIDGET(obj)->window) == NULL) {
+		return;
+	}
+	AG_OBJECT_ISA(win, "AG_Widget:AG_Window:*");
+
+	if (obj == win ||
+	    WIDGET(obj)->rView.w <= 0 || WIDGET(obj)->rView.h <= 0) {
+		win->dirty = 1;					/* Full redraw */
+		return;
 	}
+	AG_WindowDamage(win, &WIDGET(obj)->rView);
+}
+
+/*
+ * Add a rectangle (in display coordinates) to the damaged region of a
+ * window. No-op if the rectangle is empty or a full redraw is pending.
+ */
+void
+AG_WindowDamage(AG_Window *_Nonnull win, const AG_Rect2 *_Nonnull r)
+{
+	if (r->w <= 0 || r->h <= 0) {
+		return;
+	}
+	switch (win->dirty) {
+	case 0:
+		win->rDamage = *r;
+		win->dirty = AG_WINDOW_DIRTY_DAMAGED;
+		break;
+	case AG_WINDOW_DIRTY_DAMAGED:
+		AG_RectUnion2(&win->rDamage, &win->rDamage, r);
+		break;
+	default:					/* Full redraw pending */
+		break;
+	}
+}
+
+/* Return a snapshot of the redraw statistics. */
+void
+AG_GetRedrawStats(AG_RedrawStats *st)
+{
+	memcpy(st, &agRedrawStats, sizeof(AG_RedrawStats));
 }
 
 /*
@@ -3040,6 +3171,7 @@ Init(void *_Nonnull obj)
 #endif
 	win->visible = 0;
 	win->dirty = 0;
+	memset(&win->rDamage, 0, sizeof(AG_Rect2));
 	win->alignment = AG_WINDOW_ALIGNMENT_NONE;
 	win->tbar = NULL;
 	win->icon = NULL;
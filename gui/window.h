@@ -118,6 +118,7 @@ typedef struct ag_window {
 	char caption[AG_WINDOW_CAPTION_MAX];	/* Window caption */
 	int visible;				/* Window is visible */
 	int dirty;				/* Window needs redraw */
+#define AG_WINDOW_DIRTY_DAMAGED 2		/* Only rDamage needs redraw */
 	enum ag_window_alignment alignment;	/* Initial position */
 
 	struct ag_titlebar *_Nullable tbar;	/* Titlebar (or NULL) */
@@ -130,6 +131,7 @@ typedef struct ag_window {
 	int wResizeCtrl;			/* Resize controls size (px) */
 	AG_Rect r;				/* View area */
 	AG_Rect rSaved;				/* Saved geometry */
+	AG_Rect2 rDamage;			/* Damaged region (if dirty=2) */
 
 	int minPct;				/* For MINSIZEPCT */
 	int nFocused;				/* Widgets in focus chain */
@@ -146,6 +148,16 @@ typedef struct ag_window {
 	AG_WindowPvt pvt;			/* Private data */
 } AG_Window;
 
+/* Redraw statistics (see AG_GetRedrawStats()). */
+typedef struct ag_redraw_stats {
+	Uint nFrames;			/* Frames rendered */
+	Uint nPartial;			/* Frames limited to a damaged region */
+	Uint nDrawn;			/* Widgets drawn in last frame */
+	Uint nSkipped;			/* Widgets skipped in last frame */
+	Uint nDrawnCur;			/* Widgets drawn in current frame */
+	Uint nSkippedCur;		/* Widgets skipped in current frame */
+} AG_RedrawStats;
+
 typedef AG_TAILQ_HEAD(ag_windowq, ag_window) AG_WindowQ;
 typedef AG_VEC_HEAD(AG_Window *) AG_WindowVec;
 
@@ -161,6 +173,7 @@ extern AG_WindowQ agWindowHideQ;		/* AG_WindowHide() queue */
 extern AG_Window *_Nullable agWindowToFocus;	/* Window to focus next */
 extern AG_Window *_Nullable agWindowFocused;	/* Window holding focus */
 extern Uint agWindowPinnedCount;                /* Number of pinned windows */
+extern AG_RedrawStats agRedrawStats;            /* Redraw statistics */
 
 #if defined(AG_DEBUG) && defined(AG_WIDGETS)
 extern AG_Window *_Nullable agDebuggerTgtWindow;     /* For GUI debugger */
@@ -226,6 +239,7 @@ void AG_WindowRaise(AG_Window *_Nonnull);
 void AG_WindowShow(AG_Window *_Nonnull);
 void AG_WindowHide(AG_Window *_Nonnull);
 void AG_WindowDrawQueued(void);
+void AG_WindowDamage(AG_Window *_Nonnull, const AG_Rect2 *_Nonnull);
 void AG_WindowResize(AG_Window *_Nonnull);
 
 AG_Window *_Nullable AG_WindowFindFocused(void)
@@ -274,6 +288,7 @@ void AG_WidgetSetGeometry(void *_Nonnull, const AG_Rect *_Nonnull);
 void AG_WindowSetGeometryMax(AG_Window *_Nonnull);
 
 void AG_Redraw(void *_Nonnull);
+void AG_GetRedrawStats(AG_RedrawStats *_Nonnull);
 
 void AG_SetCursor(void *_Nonnull, AG_CursorArea *_Nonnull *_Nullable,
                   const AG_Rect *_Nonnull, struct ag_cursor *_Nonnull);
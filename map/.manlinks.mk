@@ -3,6 +3,15 @@ MANLINKS+=MAP.3:MAP_New.3
 MANLINKS+=MAP.3:MAP_AllocNodes.3
 MANLINKS+=MAP.3:MAP_FreeNodes.3
 MANLINKS+=MAP.3:MAP_SetZoom.3
+MANLINKS+=MAP.3:MAP_GetNode.3
+MANLINKS+=MAP.3:MAP_LookupNode.3
+MANLINKS+=MAP.3:MAP_RegionFirst.3
+MANLINKS+=MAP.3:MAP_RegionNext.3
+MANLINKS+=MAP.3:MAP_FOREACH_NODE.3
+MANLINKS+=MAP.3:MAP_NodeIsEmpty.3
+MANLINKS+=MAP.3:MAP_CompactNodes.3
+MANLINKS+=MAP.3:MAP_OpenPaged.3
+MANLINKS+=MAP.3:MAP_SyncPaged.3
 MANLINKS+=MAP.3:MAP_NodeInit.3
 MANLINKS+=MAP.3:MAP_NodeDestroy.3
 MANLINKS+=MAP.3:MAP_NodeLoad.3
@@ -40,29 +40,27 @@ EraseSelection(MAP_Tool *_Nonnull tool, AG_KeySym key, int state, void *_Nullabl
 {
 	MAP_View *mv = tool->mv;
 	MAP *map = mv->map;
-	Uint x, y;
-
-	for (y = 0; y < map->h; y++) {
-		for (x = 0; x < map->w; x++) {
-			MAP_Node *node = &map->map[y][x];
-			MAP_Item *mi;
-			Uint i;
-
-			TAILQ_FOREACH(mi, &node->items, items) {
-				if (mi->layer != map->layerCur) {
-					continue;
-				}
-				if (mi->flags & MAP_ITEM_SELECTED)
-					MAP_NodeDelItem(map, node, mi);
+	MAP_Region r;
+	MAP_Node *node;
+
+	MAP_FOREACH_NODE(node, &r, map, 0,0, map->w,map->h) {
+		MAP_Item *mi;
+		Uint i;
+
+		TAILQ_FOREACH(mi, &node->items, items) {
+			if (mi->layer != map->layerCur) {
+				continue;
 			}
-			for (i = 0; i < node->nLocs; i++) {
-				MAP_Location *loc = &node->locs[i];
-				MAP_Object *mo = loc->obj;
-
-				if ((loc->flags & MAP_OBJECT_LOCATION_SELECTED) ||
-				     (mo->flags & MAP_OBJECT_SELECTED)) {
-					MAP_NodeDelLocation(map, node, loc);
-				}
+			if (mi->flags & MAP_ITEM_SELECTED)
+				MAP_NodeDelItem(map, node, mi);
+		}
+		for (i = 0; i < node->nLocs; i++) {
+			MAP_Location *loc = &node->locs[i];
+			MAP_Object *mo = loc->obj;
+
+			if ((loc->flags & MAP_OBJECT_LOCATION_SELECTED) ||
+			     (mo->flags & MAP_OBJECT_SELECTED)) {
+				MAP_NodeDelLocation(map, node, loc);
 			}
 		}
 	}
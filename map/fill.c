@@ -86,6 +86,7 @@ Effect(void *_Nonnull obj, MAP_Node *_Nonnull node)
 	AG_TlistItem *it;
 	RG_Tile *tile;
 	MAP_NodeselTool *selTool;
+	MAP_Region r;
 #if 0
 	int i = 0;
 #endif
@@ -107,17 +108,18 @@ Effect(void *_Nonnull obj, MAP_Node *_Nonnull node)
 		count = 0;
 		for (y = dy; y < dy+dh; y++) {
 			for (x = dx; x < dx+dw; x++) {
-				MAP_Node *nodeSrc = &mapCopy->map[sy][sx];
-				MAP_Node *node = &map->map[y][x];
+				MAP_Node *nodeSrc = MAP_LookupNode(mapCopy, sx,sy);
+				MAP_Node *node = MAP_GetNode(map, x,y);
 				MAP_Item *mi;
 
 				MAP_NodeRevision(map, x,y, map->undo, map->nUndo);
 
 				MAP_NodeClear(map, node, map->layerCur);
 
-				TAILQ_FOREACH(mi, &nodeSrc->items, items) {
-					MAP_DuplicateItem(map, node,
-					    map->layerCur, mi);
+				if (nodeSrc != NULL) {
+					TAILQ_FOREACH(mi, &nodeSrc->items, items)
+						MAP_DuplicateItem(map, node,
+						    map->layerCur, mi);
 				}
 				if (++sx >= (int)mapCopy->w) {
 					sx = 0;
@@ -141,7 +143,7 @@ Effect(void *_Nonnull obj, MAP_Node *_Nonnull node)
 		tile = it->p1;
 		for (y = dy; y < dy+dh; y++) {
 			for (x = dx; x < dx+dw; x++) {
-				MAP_Node *node = &map->map[y][x];
+				MAP_Node *node = MAP_GetNode(map, x,y);
 				MAP_Tile *mt;
 
 				MAP_NodeRevision(map, x,y, map->undo, map->nUndo);
@@ -192,11 +194,9 @@ Effect(void *_Nonnull obj, MAP_Node *_Nonnull node)
 		}
 		break;
 	case FILL_CLEAR:
-		for (y = dy; y < dy+dh; y++) {
-			for (x = dx; x < dx+dw; x++) {
-				MAP_NodeRevision(map, x,y, map->undo, map->nUndo);
-				MAP_NodeClear(map, &map->map[y][x], map->layerCur);
-			}
+		MAP_FOREACH_NODE(node, &r, map, dx,dy, dw,dh) {
+			MAP_NodeRevision(map, r.x,r.y, map->undo, map->nUndo);
+			MAP_NodeClear(map, node, map->layerCur);
 		}
 		MAP_ViewStatus(mv, _("Cleared (%dx%d) nodes at "
 		                     "[" AGSI_BOLD "%d,%d" AGSI_RST "]."),
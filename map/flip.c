@@ -74,7 +74,9 @@ MouseButtonDown(void *_Nonnull obj, int xMap, int yMap, int b)
 	MAP *map = mv->map;
 	int xSel = mv->mx + mv->mouse.x;
 	int ySel = mv->my + mv->mouse.y;
-	int w=1, h=1, x,y;
+	int w=1, h=1;
+	MAP_Region r;
+	MAP_Node *node;
 
 	if (!mapFlipSelection ||
 	    MAP_ViewGetSelection(mv, &xSel, &ySel, &w, &h) == -1) {
@@ -85,22 +87,19 @@ MouseButtonDown(void *_Nonnull obj, int xMap, int yMap, int b)
 
 	MAP_BeginRevision(map);
 
-	for (y = ySel; y < ySel+h; y++) {
-		for (x = xSel ; x < xSel+w; x++) {
-			MAP_Node *node = &map->map[y][x];
-			MAP_Item *mi;
-
-			MAP_NodeRevision(map, x,y, map->undo, map->nUndo);
-			
-			TAILQ_FOREACH(mi, &node->items, items) {
-				if (mi->layer != map->layerCur)
-					continue;
-
-				if (b == AG_MOUSE_LEFT) {
-					ToggleXform(mi, RG_TRANSFORM_MIRROR);
-				} else if (b == AG_MOUSE_RIGHT) {
-					ToggleXform(mi, RG_TRANSFORM_FLIP);
-				}
+	MAP_FOREACH_NODE(node, &r, map, xSel,ySel, w,h) {
+		MAP_Item *mi;
+
+		MAP_NodeRevision(map, r.x,r.y, map->undo, map->nUndo);
+		
+		TAILQ_FOREACH(mi, &node->items, items) {
+			if (mi->layer != map->layerCur)
+				continue;
+
+			if (b == AG_MOUSE_LEFT) {
+				ToggleXform(mi, RG_TRANSFORM_MIRROR);
+			} else if (b == AG_MOUSE_RIGHT) {
+				ToggleXform(mi, RG_TRANSFORM_FLIP);
 			}
 		}
 	}
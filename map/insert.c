@@ -117,7 +117,7 @@ GenerateTileMap(MAP_InsertTool *_Nonnull tool, RG_Tile *_Nonnull tile)
 			dw = tile->su->w - sx;
 			dh = tile->su->h - sy;
 
-			mt = MAP_TileNew(mapTmp, &mapTmp->map[dy][dx],
+			mt = MAP_TileNew(mapTmp, MAP_GetNode(mapTmp, dx,dy),
 			                 tile->ts, tile->main_id);
 
 			mt->rs.x = dx * MAP_TILESZ_DEF;
@@ -243,8 +243,10 @@ Effect(void *_Nonnull obj, MAP_Node *_Nonnull node)
 			    dy < 0 || dy >= (int)mapDst->h) {
 				continue;
 			}
-			sn = &mapSrc->map[sy][sx]; 
-			dn = &mapDst->map[dy][dx];
+			if ((sn = MAP_LookupNode(mapSrc, sx,sy)) == NULL) {
+				continue;
+			}
+			dn = MAP_GetNode(mapDst, dx,dy);
 			
 			MAP_NodeRevision(mapDst, dx,dy, map->undo, map->nUndo);
 
@@ -330,9 +332,12 @@ Cursor(void *_Nonnull obj, AG_Rect *_Nonnull rd)
 	}
 	for (sy = sy0, dy = dy0; sy <= sy1; sy++, dy += tileSz) {
 		for (sx = sx0, dx = dx0; sx <= sx1; sx++, dx += tileSz) {
-			MAP_Node *sn = &mapSrc->map[sy][sx];
+			MAP_Node *sn = MAP_LookupNode(mapSrc, sx,sy);
 			MAP_Item *mi;
 
+			if (sn == NULL) {
+				continue;
+			}
 			TAILQ_FOREACH(mi, &sn->items, items)
 				MAP_ItemDraw(mv->map, mi, dx,dy, mv->cam);
 		}
@@ -69,7 +69,7 @@ EditPane(void *_Nonnull p, void *_Nonnull box)
 	MAP_View *mv = TOOL(tool)->mv;
 	AG_TlistItem *it;
 	MAP_Object *mo;
-	AG_ObjectClass **hier;
+	AG_ObjectClass *const *hier;
 	int          i, nHier;
 
 	if ((it = AG_TlistSelectedItem(mv->lib_tl)) == NULL ||
@@ -89,14 +89,14 @@ EditPane(void *_Nonnull p, void *_Nonnull box)
 
 	AG_SeparatorNewHoriz(box);
 
-	if (AG_ObjectGetInheritHier(mo, &hier, &nHier) != 0) {
+	if ((hier = AG_ObjectGetClassHier(mo, &nHier)) == NULL) {
 		AG_FatalError(NULL);
 	}
 	for (i = nHier-1; i >= 0; i--) {
 		MAP_ObjectClass *clsMo = (MAP_ObjectClass *)hier[i];
 		AG_Label *lbl;
 
-		if (!AG_ClassIsNamed(clsMo, "MAP_Object:*") ||
+		if (!AG_ClassIsA(clsMo, &mapObjectClass) ||
 		    clsMo->edit == NULL) {
 			continue;
 		}
@@ -106,7 +106,6 @@ EditPane(void *_Nonnull p, void *_Nonnull box)
 		clsMo->edit(mo, box, TOOL(tool));
 		AG_SeparatorNewHoriz(box);
 	}
-	free(hier);
 }
 
 static int
@@ -166,7 +165,7 @@ MouseMotion(void *_Nonnull p, int x, int y, int xrel, int yrel)
 		if (mv->cx == -1 || mv->cy == -1) {
 			return (0);
 		}
-		node = &m->map[mv->cy][mv->cx];
+		node = MAP_GetNode(m, mv->cx, mv->cy);
 #ifdef AG_DEBUG
 		if ((node->flags & MAP_NODE_VALID) == 0)
 			AG_FatalError("Invalid node");
@@ -199,7 +198,7 @@ MouseButtonDown(void *_Nonnull obj, int x, int y, int button)
 		AG_SetErrorS(_("Library item is not a MAP_Object"));
 		goto fail;
 	}
-	node = &map->map[mv->cy][mv->cx];
+	node = MAP_GetNode(map, mv->cx, mv->cy);
 	if ((node->flags & MAP_NODE_VALID) == 0) {
 		AG_SetErrorS(_("Invalid map node"));
 		goto fail;
@@ -132,6 +132,8 @@ MAP_ItemInit(void *obj, enum map_item_type type)
 	mi->type = type;
 	mi->flags = MAP_ITEM_VALID;
 	mi->layer = 0;
+	mi->z = 0.0f;
+	mi->h = 0.0f;
 	mi->p = NULL;
 	RG_TransformChainInit(&mi->transforms);
 
@@ -195,40 +197,36 @@ MAP_ItemAttrColor(Uint flag, int state, AG_Color *c)
 }
 
 /*
- * Allocate and initialize the two-dimensional array of MAP_Node's
- * to (w x h) nodes.
+ * Allocate the chunk table for a (w x h) node map. Chunks of
+ * MAP_CHUNK_SIZE x MAP_CHUNK_SIZE nodes are allocated on demand by
+ * MAP_GetNode(), so the memory used tracks the occupied area of the map.
+ * Any existing nodes must have been released with MAP_FreeNodes().
  */
 int
 MAP_AllocNodes(MAP *map, Uint w, Uint h)
 {
-	Uint x, y;
-	MAP_Node **mapNew;
+	MAP_Chunk **chunksNew;
+	Uint wChunks, hChunks;
 	
 	if (w > MAP_WIDTH_MAX || h > MAP_HEIGHT_MAX) {
 		AG_SetError(_("%ux%u nodes exceed the limit of %ux%u."),
 		    w,h, MAP_WIDTH_MAX, MAP_HEIGHT_MAX);
 		return (-1);
 	}
+	wChunks = (w + MAP_CHUNK_MASK) >> MAP_CHUNK_SHIFT;
+	hChunks = (h + MAP_CHUNK_MASK) >> MAP_CHUNK_SHIFT;
 
-	if ((mapNew = TryMalloc(h * sizeof(MAP_Node *))) == NULL) {
+	if ((chunksNew = TryMalloc((wChunks*hChunks + 1) *
+	                           sizeof(MAP_Chunk *))) == NULL) {
 		return (-1);
 	}
-	for (y = 0; y < h; y++) {
-		if ((mapNew[y] = TryMalloc(w * sizeof(MAP_Node))) == NULL) {
-			for (--y; y >= 0; y--) {
-				free(mapNew[y]);
-			}
-			free(mapNew);
-			return (-1);
-		}
-	}
-	for (y = 0; y < h; y++) {
-		for (x = 0; x < w; x++)
-			MAP_NodeInit(&mapNew[y][x]);
-	}
+	memset(chunksNew, 0, (wChunks*hChunks + 1) * sizeof(MAP_Chunk *));
 
 	AG_ObjectLock(map);
-	map->map = mapNew;
+	map->chunks = chunksNew;
+	map->wChunks = wChunks;
+	map->hChunks = hChunks;
+	map->nChunks = 0;
 	map->w = w;
 	map->h = h;
 	AG_ObjectUnlock(map);
@@ -236,23 +234,323 @@ MAP_AllocNodes(MAP *map, Uint w, Uint h)
 	return (0);
 }
 
-/* Release the node map. */
+static MAP_Chunk *_Nonnull
+AllocChunk(MAP *_Nonnull map, Uint i)
+{
+	MAP_Chunk *chunk;
+	Uint j;
+
+	chunk = Malloc(sizeof(MAP_Chunk));
+	for (j = 0; j < MAP_CHUNK_NODES; j++) {
+		MAP_NodeInit(&chunk->nodes[j]);
+	}
+	map->chunks[i] = chunk;
+	map->nChunks++;
+	return (chunk);
+}
+
+static void
+FreeChunk(MAP *_Nonnull map, MAP_Chunk *_Nonnull chunk)
+{
+	Uint i;
+
+	for (i = 0; i < MAP_CHUNK_NODES; i++) {
+		MAP_NodeDestroy(map, &chunk->nodes[i]);
+	}
+	free(chunk);
+	map->nChunks--;
+}
+
+/* Release the node map and close any paging source. */
 void
 MAP_FreeNodes(MAP *map)
 {
-	Uint x,y;
-	MAP_Node *node;
+	Uint i;
+
+	if (map->chunks != NULL) {
+		for (i = 0; i < map->wChunks*map->hChunks; i++) {
+			if (map->chunks[i] != NULL)
+				FreeChunk(map, map->chunks[i]);
+		}
+		free(map->chunks);
+		map->chunks = NULL;
+		map->wChunks = 0;
+		map->hChunks = 0;
+	}
+	if (map->pageDs != NULL) {
+		AG_CloseFile(map->pageDs);
+		map->pageDs = NULL;
+	}
+	Free(map->pages);
+	map->pages = NULL;
+	map->flags &= ~(MAP_PAGED_RDONLY | MAP_PAGED_DIRTY);
+}
+
+static int
+ChunkIsEmpty(const MAP_Chunk *_Nonnull chunk)
+{
+	Uint i;
+
+	for (i = 0; i < MAP_CHUNK_NODES; i++) {
+		if (!MAP_NodeIsEmpty(&chunk->nodes[i]))
+			return (0);
+	}
+	return (1);
+}
+
+/* Load the non-empty nodes of a chunk. */
+static int
+LoadChunk(MAP *_Nonnull map, AG_DataSource *_Nonnull ds,
+    MAP_Chunk *_Nonnull chunk)
+{
+	Uint i, nNodes, idx;
+
+	if ((nNodes = (Uint)AG_ReadUint16(ds)) > MAP_CHUNK_NODES) {
+		AG_SetError("Invalid node count (%u)", nNodes);
+		return (-1);
+	}
+	for (i = 0; i < nNodes; i++) {
+		MAP_Node *node;
+
+		if ((idx = (Uint)AG_ReadUint16(ds)) >= MAP_CHUNK_NODES) {
+			AG_SetError("Invalid node index (%u)", idx);
+			return (-1);
+		}
+		node = &chunk->nodes[idx];
+		if (!MAP_NodeIsEmpty(node)) {
+			AG_SetError("Duplicate node index (%u)", idx);
+			return (-1);
+		}
+		if (MAP_NodeLoad(map, ds, node) == -1)
+			return (-1);
+	}
+	return (0);
+}
 
-	if (map->map != NULL) {
-		for (y = 0; y < map->h; y++) {
-			for (x = 0; x < map->w; x++) {
-				node = &map->map[y][x];
-				MAP_NodeDestroy(map, node);
+/* Save the non-empty nodes of a chunk. */
+static void
+SaveChunk(MAP *_Nonnull map, AG_DataSource *_Nonnull ds,
+    MAP_Chunk *_Nonnull chunk)
+{
+	AG_Offset nNodesOffs;
+	Uint i, nNodes = 0;
+
+	nNodesOffs = AG_Tell(ds);
+	AG_WriteUint16(ds, 0);
+	for (i = 0; i < MAP_CHUNK_NODES; i++) {
+		MAP_Node *node = &chunk->nodes[i];
+
+		if (MAP_NodeIsEmpty(node)) {
+			continue;
+		}
+		AG_WriteUint16(ds, (Uint16)i);
+		MAP_NodeSave(map, ds, node);
+		nNodes++;
+	}
+	AG_WriteUint16At(ds, (Uint16)nNodes, nNodesOffs);
+}
+
+static Uint32
+HashChunkData(const Uint8 *_Nonnull data, AG_Size size)
+{
+	Uint32 h = 2166136261U;				/* FNV-1a */
+	AG_Size i;
+
+	for (i = 0; i < size; i++) {
+		h ^= data[i];
+		h *= 16777619U;
+	}
+	return (h);
+}
+
+/*
+ * Read chunk i in from the paging source. Return NULL if the chunk is
+ * not in the paging source. A chunk which cannot be read is reported,
+ * marked bad and treated as empty.
+ */
+static MAP_Chunk *_Nullable
+FaultChunk(MAP *_Nonnull map, Uint i)
+{
+	MAP_Page *page = &map->pages[i];
+	AG_DataSource *ds;
+	MAP_Chunk *chunk;
+	Uint8 *data;
+
+	if (page->size == 0 || (page->flags & MAP_PAGE_BAD)) {
+		return (NULL);
+	}
+	if ((data = TryMalloc(page->size)) == NULL) {
+		goto fail;
+	}
+	if (AG_ReadAt(map->pageDs, data, page->size,
+	    map->pageBase + page->offs) == -1 ||
+	    (ds = AG_OpenConstCore(data, page->size)) == NULL) {
+		free(data);
+		goto fail;
+	}
+#ifdef AG_DEBUG
+	AG_SetSourceDebug(ds, map->pageDs->debug);
+#endif
+	chunk = AllocChunk(map, i);
+	if (LoadChunk(map, ds, chunk) == -1) {
+		AG_CloseConstCore(ds);
+		free(data);
+		FreeChunk(map, chunk);
+		map->chunks[i] = NULL;
+		goto fail;
+	}
+	AG_CloseConstCore(ds);
+	page->hash = HashChunkData(data, page->size);
+	free(data);
+	return (chunk);
+fail:
+	AG_Verbose("%s: Chunk %u,%u: %s\n", OBJECT(map)->name,
+	    i % map->wChunks, i / map->wChunks, AG_GetError());
+	page->flags |= MAP_PAGE_BAD;
+	return (NULL);
+}
+
+/*
+ * Return the node at x,y, allocating its chunk (or reading it in from
+ * the paging source) if it is not resident. The coordinates must lie
+ * within the map. The map must be locked.
+ */
+MAP_Node *
+MAP_GetNode(MAP *map, int x, int y)
+{
+	MAP_Chunk *chunk;
+	Uint i;
+
+#ifdef AG_DEBUG
+	if (x < 0 || y < 0 || x >= (int)map->w || y >= (int)map->h)
+		AG_FatalError("MAP_GetNode: Bad node");
+#endif
+	i = (y >> MAP_CHUNK_SHIFT) * map->wChunks + (x >> MAP_CHUNK_SHIFT);
+	if ((chunk = map->chunks[i]) == NULL &&
+	    (map->pages == NULL || (chunk = FaultChunk(map, i)) == NULL))
+		chunk = AllocChunk(map, i);
+
+	return (&chunk->nodes[((y & MAP_CHUNK_MASK) << MAP_CHUNK_SHIFT) +
+	                      (x & MAP_CHUNK_MASK)]);
+}
+
+/*
+ * Return the node at x,y, or NULL if it is outside of the map or its
+ * chunk is not allocated (which implies an empty node). Chunks in the
+ * paging source are read in. The map must be locked.
+ */
+MAP_Node *
+MAP_LookupNode(MAP *map, int x, int y)
+{
+	MAP_Chunk *chunk;
+	Uint i;
+
+	if (x < 0 || y < 0 || x >= (int)map->w || y >= (int)map->h) {
+		return (NULL);
+	}
+	i = (y >> MAP_CHUNK_SHIFT) * map->wChunks + (x >> MAP_CHUNK_SHIFT);
+	if ((chunk = map->chunks[i]) == NULL &&
+	    (map->pages == NULL || (chunk = FaultChunk(map, i)) == NULL)) {
+		return (NULL);
+	}
+	return (&chunk->nodes[((y & MAP_CHUNK_MASK) << MAP_CHUNK_SHIFT) +
+	                      (x & MAP_CHUNK_MASK)]);
+}
+
+/*
+ * Return the next resident node at or after it->x,it->y in row-major
+ * order. Spans of unallocated chunks are skipped a chunk at a time.
+ * Chunks in the paging source are read in.
+ */
+static MAP_Node *_Nullable
+RegionScan(MAP *_Nonnull map, MAP_Region *_Nonnull r)
+{
+	MAP_Chunk *chunk;
+	Uint i;
+
+	for (; r->y < r->y2; r->y++, r->x = r->x1) {
+		while (r->x < r->x2) {
+			i = (r->y >> MAP_CHUNK_SHIFT) * map->wChunks +
+			    (r->x >> MAP_CHUNK_SHIFT);
+			if ((chunk = map->chunks[i]) != NULL ||
+			    (map->pages != NULL &&
+			     (chunk = FaultChunk(map, i)) != NULL)) {
+				return (&chunk->nodes[
+				    ((r->y & MAP_CHUNK_MASK) << MAP_CHUNK_SHIFT) +
+				    (r->x & MAP_CHUNK_MASK)]);
 			}
-			free(map->map[y]);
+			r->x = (r->x | MAP_CHUNK_MASK) + 1;
+		}
+	}
+	return (NULL);
+}
+
+/*
+ * Begin iterating over the resident nodes of the w x h region at x,y
+ * (clipped to the map). The coordinates of the returned node are
+ * available in r->x, r->y. The map must be locked.
+ */
+MAP_Node *
+MAP_RegionFirst(MAP *map, MAP_Region *r, int x, int y, int w, int h)
+{
+	r->x1 = (x > 0) ? x : 0;
+	r->y1 = (y > 0) ? y : 0;
+	r->x2 = (x+w < (int)map->w) ? x+w : (int)map->w;
+	r->y2 = (y+h < (int)map->h) ? y+h : (int)map->h;
+	r->x = r->x1;
+	r->y = r->y1;
+
+	if (map->chunks == NULL || r->x1 >= r->x2) {
+		return (NULL);
+	}
+	return RegionScan(map, r);
+}
+
+/* Return the next resident node of the region (or NULL). */
+MAP_Node *
+MAP_RegionNext(MAP *map, MAP_Region *r)
+{
+	if (++r->x >= r->x2) {
+		r->x = r->x1;
+		r->y++;
+	}
+	return RegionScan(map, r);
+}
+
+/* Return 1 if the node holds no items, object locations or flags. */
+int
+MAP_NodeIsEmpty(const MAP_Node *node)
+{
+	return (node->flags == MAP_NODE_VALID && node->nLocs == 0 &&
+	        TAILQ_EMPTY(&node->items));
+}
+
+/*
+ * Release the resident chunks whose nodes are all empty.
+ * Pointers to nodes in the released chunks become invalid.
+ * The map must be locked.
+ */
+void
+MAP_CompactNodes(MAP *map)
+{
+	Uint i;
+
+	if (map->chunks == NULL) {
+		return;
+	}
+	for (i = 0; i < map->wChunks*map->hChunks; i++) {
+		MAP_Chunk *chunk = map->chunks[i];
+
+		if (chunk == NULL || !ChunkIsEmpty(chunk)) {
+			continue;
+		}
+		FreeChunk(map, chunk);
+		map->chunks[i] = NULL;
+
+		if (map->pages != NULL && map->pages[i].size != 0) {
+			memset(&map->pages[i], 0, sizeof(MAP_Page));
+			map->flags |= MAP_PAGED_DIRTY;
 		}
-		free(map->map);
-		map->map = NULL;
 	}
 }
 
@@ -272,54 +570,99 @@ FreeCameras(MAP *_Nonnull map)
 	MAP_InitCamera(&map->cameras[0], _("Camera 0"));
 }
 
-/* Resize a map, initializing new nodes and destroying any excess ones. */
+/*
+ * Resize a map, destroying any excess nodes. Resident chunks are moved
+ * into the new chunk table without copying their nodes.
+ */
 int
 MAP_Resize(MAP *map, Uint w, Uint h)
 {
-	MAP mapTmp;
-	Uint x, y;
+	MAP_Chunk **chunksNew, *chunk;
+	MAP_Page *pagesNew = NULL;
+	Uint wChunks, hChunks, cx, cy, i, iOld;
+	int x, y, edge;
 
 	if (w > MAP_WIDTH_MAX || h > MAP_HEIGHT_MAX) {
 		AG_SetError(_("%ux%u nodes exceed the limit of %ux%u."),
 		    w,h, MAP_WIDTH_MAX, MAP_HEIGHT_MAX);
 		return (-1);
 	}
+	wChunks = (w + MAP_CHUNK_MASK) >> MAP_CHUNK_SHIFT;
+	hChunks = (h + MAP_CHUNK_MASK) >> MAP_CHUNK_SHIFT;
 
-	AG_ObjectInitStatic(&mapTmp, &mapClass);
+	if ((chunksNew = TryMalloc((wChunks*hChunks + 1) *
+	                           sizeof(MAP_Chunk *))) == NULL) {
+		return (-1);
+	}
+	memset(chunksNew, 0, (wChunks*hChunks + 1) * sizeof(MAP_Chunk *));
 
 	AG_ObjectLock(map);
 
-	if (MAP_AllocNodes(&mapTmp, map->w, map->h) == -1) {
-		goto fail;
-	}
-	for (y = 0; y < map->h && y < h; y++) {
-		for (x = 0; x < map->w && x < w; x++)
-			MAP_NodeCopy(&mapTmp, &mapTmp.map[y][x], -1,
-			             &map->map[y][x], -1);
-	}
-
-	/* Resize the map and restore the original nodes. */
-	MAP_FreeNodes(map);
-	if (MAP_AllocNodes(map, w,h) == -1) {
-		goto fail;
+	if (map->pages != NULL) {
+		if ((pagesNew = TryMalloc((wChunks*hChunks + 1) *
+		                          sizeof(MAP_Page))) == NULL) {
+			AG_ObjectUnlock(map);
+			free(chunksNew);
+			return (-1);
+		}
+		memset(pagesNew, 0, (wChunks*hChunks + 1) * sizeof(MAP_Page));
+		map->flags |= MAP_PAGED_DIRTY;
+	}
+	for (cy = 0; cy < map->hChunks; cy++) {
+		for (cx = 0; cx < map->wChunks; cx++) {
+			iOld = cy*map->wChunks + cx;
+			chunk = map->chunks[iOld];
+			if (cx >= wChunks || cy >= hChunks) {
+				if (chunk != NULL) {
+					FreeChunk(map, chunk);
+				}
+				continue;
+			}
+			edge = (((cx+1) << MAP_CHUNK_SHIFT) > w ||
+			        ((cy+1) << MAP_CHUNK_SHIFT) > h);
+			if (pagesNew != NULL) {
+				if (chunk == NULL && edge) {
+					chunk = FaultChunk(map, iOld);
+				}
+				pagesNew[cy*wChunks + cx] = map->pages[iOld];
+			}
+			if (chunk == NULL) {
+				continue;
+			}
+			if (edge) {
+				/* Clear the nodes outside of the new bounds. */
+				for (i = 0; i < MAP_CHUNK_NODES; i++) {
+					x = (cx << MAP_CHUNK_SHIFT) +
+					    (i & MAP_CHUNK_MASK);
+					y = (cy << MAP_CHUNK_SHIFT) +
+					    (i >> MAP_CHUNK_SHIFT);
+					if (x < (int)w && y < (int)h) {
+						continue;
+					}
+					MAP_NodeDestroy(map, &chunk->nodes[i]);
+					MAP_NodeInit(&chunk->nodes[i]);
+				}
+			}
+			chunksNew[cy*wChunks + cx] = chunk;
+		}
 	}
-	for (y = 0; y < mapTmp.h && y < map->h; y++) {
-		for (x = 0; x < mapTmp.w && x < map->w; x++)
-			MAP_NodeCopy(map, &map->map[y][x], -1,
-			             &mapTmp.map[y][x], -1);
+	Free(map->chunks);
+	map->chunks = chunksNew;
+	if (pagesNew != NULL) {
+		Free(map->pages);
+		map->pages = pagesNew;
 	}
+	map->wChunks = wChunks;
+	map->hChunks = hChunks;
+	map->w = w;
+	map->h = h;
 
 	/* Clamp the origin point. */
 	if (map->xOrigin >= (int)w) { map->xOrigin = (int)w - 1; }
 	if (map->yOrigin >= (int)h) { map->yOrigin = (int)h - 1; }
 
 	AG_ObjectUnlock(map);
-	AG_ObjectDestroy(&mapTmp);
 	return (0);
-fail:
-	AG_ObjectUnlock(map);
-	AG_ObjectDestroy(&mapTmp);
-	return (-1);
 }
 
 /* Set the display scaling factor. */
@@ -445,7 +788,14 @@ Init(void *_Nonnull obj)
 	map->xOrigin = 0;
 	map->yOrigin = 0;
 	map->layerOrigin = 0;
-	map->map = NULL;
+	map->chunks = NULL;
+	map->wChunks = 0;
+	map->hChunks = 0;
+	map->nChunks = 0;
+	map->pageDs = NULL;
+	map->pages = NULL;
+	map->pageBase = 0;
+	map->pageGeom = 0;
 	map->layers = Malloc(sizeof(MAP_Layer));
 	map->nLayers = 1;
 	map->cameras = Malloc(sizeof(MAP_Camera));
@@ -806,8 +1156,7 @@ Reset(void *_Nonnull obj)
 {
 	MAP *map = obj;
 
-	if (map->map != NULL)
-		MAP_FreeNodes(map);
+	MAP_FreeNodes(map);
 	if (map->layers != NULL)
 		FreeLayers(map);
 	if (map->cameras != NULL)
@@ -856,21 +1205,22 @@ MAP_ItemLoad(MAP *map, MAP_Node *node, AG_DataSource *ds)
 	if ((mi = TryMalloc(miClass->size)) == NULL) {
 		return (-1);
 	}
-	if (miClass->init != NULL) {
-		miClass->init(mi);
-	}
+	MAP_ItemInit(mi, type);
 	mi->flags = flags;
 	mi->layer = layer;
 	mi->z = z;
 	mi->h = h;
 
+	/* Same order as MAP_ItemSave(). */
+	if (RG_TransformChainLoad(ds, &mi->transforms) == -1) {
+		goto fail;
+	}
 	if (miClass->load != NULL) {
 		if (miClass->load(map, mi, ds) == -1)
-			return (-1);
+			goto fail;
 	}
-	if (RG_TransformChainLoad(ds, &mi->transforms) == -1)
-		goto fail;
 
+	TAILQ_INSERT_TAIL(&node->items, mi, items);
 	return (0);
 fail:
 	if (mi != NULL) {
@@ -904,7 +1254,9 @@ MAP_NodeLoad(MAP *map, AG_DataSource *ds, MAP_Node *node)
 		return (-1);
 	}
 
-	if ((locsNew = TryMalloc(nLocs * sizeof(MAP_Location))) == NULL) {
+	if (nLocs == 0) {
+		locsNew = NULL;
+	} else if ((locsNew = TryMalloc(nLocs * sizeof(MAP_Location))) == NULL) {
 		return (-1);
 	}
 	for (i = 0; i < nLocs; i++) {
@@ -956,6 +1308,71 @@ MAP_NodeLoad(MAP *map, AG_DataSource *ds, MAP_Node *node)
 	return (0);
 }
 
+/*
+ * Read the chunk directory. If the map is being opened by MAP_OpenPaged(),
+ * keep the directory for reading chunks in on demand. Otherwise, read all
+ * chunks in. Leave ds positioned at the end of the map data.
+ */
+static int
+LoadChunks(MAP *_Nonnull map, AG_DataSource *_Nonnull ds, AG_Offset geomOffs)
+{
+	MAP_Page *pages;
+	AG_Offset base, endOffs;
+	Uint i, nChunks, nTable = map->wChunks*map->hChunks;
+
+	base = AG_Tell(ds);
+	if (AG_Seek(ds, base + (AG_Offset)AG_ReadUint32(ds), AG_SEEK_SET) == -1) {
+		return (-1);
+	}
+	if ((nChunks = (Uint)AG_ReadUint32(ds)) > nTable) {
+		AG_SetError("Invalid chunk count (%u)", nChunks);
+		return (-1);
+	}
+	if ((pages = TryMalloc((nTable + 1) * sizeof(MAP_Page))) == NULL) {
+		return (-1);
+	}
+	memset(pages, 0, (nTable + 1) * sizeof(MAP_Page));
+
+	for (i = 0; i < nChunks; i++) {
+		Uint cx, cy;
+		MAP_Page *page;
+
+		cx = (Uint)AG_ReadUint16(ds);
+		cy = (Uint)AG_ReadUint16(ds);
+		if (cx >= map->wChunks || cy >= map->hChunks ||
+		    pages[cy*map->wChunks + cx].size != 0) {
+			AG_SetError("Invalid chunk (%u,%u)", cx,cy);
+			goto fail;
+		}
+		page = &pages[cy*map->wChunks + cx];
+		page->offs = AG_ReadUint32(ds);
+		if ((page->size = AG_ReadUint32(ds)) == 0) {
+			AG_SetError("Invalid chunk size (%u,%u)", cx,cy);
+			goto fail;
+		}
+	}
+	endOffs = AG_Tell(ds);
+
+	if (ds == map->pageDs) {
+		map->pages = pages;
+		map->pageBase = base;
+		map->pageGeom = geomOffs;
+		return (0);
+	}
+	for (i = 0; i < nTable; i++) {
+		if (pages[i].size == 0) {
+			continue;
+		}
+		if (AG_Seek(ds, base + pages[i].offs, AG_SEEK_SET) == -1 ||
+		    LoadChunk(map, ds, AllocChunk(map, i)) == -1)
+			goto fail;
+	}
+	free(pages);
+	return AG_Seek(ds, endOffs, AG_SEEK_SET);
+fail:
+	free(pages);
+	return (-1);
+}
 
 static int
 Load(void *_Nonnull obj, AG_DataSource *_Nonnull ds,
@@ -963,9 +1380,12 @@ Load(void *_Nonnull obj, AG_DataSource *_Nonnull ds,
 {
 	MAP *map = obj;
 	Uint32 w, h, origin_x, origin_y;
-	Uint i, x, y;
+	AG_Offset geomOffs;
+	Uint i;
+	int x, y;
 	
 	map->flags = (Uint)AG_ReadUint32(ds) & MAP_SAVED_FLAGS;
+	geomOffs = AG_Tell(ds);
 	w = AG_ReadUint32(ds);
 	h = AG_ReadUint32(ds);
 	if (w > MAP_WIDTH_MAX || h > MAP_HEIGHT_MAX) {
@@ -1044,7 +1464,7 @@ Load(void *_Nonnull obj, AG_DataSource *_Nonnull ds,
 
 	/* Map objects */
 	map->nObjs = (Uint)AG_ReadUint32(ds);
-	if ((map->objs = TryRealloc(map->objs, map->nObjs *
+	if ((map->objs = TryRealloc(map->objs, (map->nObjs + 1) *
 	                            sizeof(MAP_Object *))) == NULL) {
 		return (-1);
 	}
@@ -1082,14 +1502,64 @@ Load(void *_Nonnull obj, AG_DataSource *_Nonnull ds,
 		map->objs[i] = mo;
 	}
 
-	/* Populated nodes */
 	if (MAP_AllocNodes(map, map->w, map->h) == -1) {
 		return (-1);
 	}
-	for (y = 0; y < map->h; y++) {
-		for (x = 0; x < map->w; x++) {
-			if (MAP_NodeLoad(map, ds, &map->map[y][x]) == -1)
+	if (ver->minor >= 3) {
+		return LoadChunks(map, ds, geomOffs);
+	} else if (ver->minor == 2) {
+		Uint32 nNodes;
+		
+		/* Populated nodes (sparse list in v12.2). */
+		if ((nNodes = AG_ReadUint32(ds)) > map->w*map->h) {
+			AG_SetError("Invalid node count (%u)", (Uint)nNodes);
+			return (-1);
+		}
+		for (i = 0; i < nNodes; i++) {
+			MAP_Node *node;
+
+			x = (int)AG_ReadUint16(ds);
+			y = (int)AG_ReadUint16(ds);
+			if (x >= (int)map->w || y >= (int)map->h) {
+				AG_SetError("Invalid node (%d,%d)", x,y);
+				return (-1);
+			}
+			node = MAP_GetNode(map, x,y);
+			if (!MAP_NodeIsEmpty(node)) {
+				AG_SetError("Duplicate node (%d,%d)", x,y);
+				return (-1);
+			}
+			if (MAP_NodeLoad(map, ds, node) == -1)
+				return (-1);
+		}
+		return (0);
+	}
+
+	/*
+	 * Populated nodes (dense array in v12.1). Only the chunks holding
+	 * non-empty nodes are allocated.
+	 */
+	for (y = 0; y < (int)map->h; y++) {
+		for (x = 0; x < (int)map->w; x++) {
+			MAP_Node nodeTmp, *node;
+			MAP_Item *mi;
+
+			MAP_NodeInit(&nodeTmp);
+			if (MAP_NodeLoad(map, ds, &nodeTmp) == -1) {
 				return (-1);
+			}
+			if (MAP_NodeIsEmpty(&nodeTmp)) {
+				Free(nodeTmp.locs);
+				continue;
+			}
+			node = MAP_GetNode(map, x,y);
+			node->flags = nodeTmp.flags;
+			node->locs = nodeTmp.locs;
+			node->nLocs = nodeTmp.nLocs;
+			while ((mi = TAILQ_FIRST(&nodeTmp.items)) != NULL) {
+				TAILQ_REMOVE(&nodeTmp.items, mi, items);
+				TAILQ_INSERT_TAIL(&node->items, mi, items);
+			}
 		}
 	}
 	return (0);
@@ -1146,11 +1616,95 @@ MAP_NodeSave(MAP *map, AG_DataSource *ds, MAP_Node *node)
 	AG_WriteUint16At(ds, (Uint16)nItems, nItemsOffs);
 }
 
+/*
+ * Append the node chunk directory. Chunks having a zero size are skipped.
+ * The offsets are relative to the chunk data base offset.
+ */
+static void
+SaveChunkDir(MAP *_Nonnull map, AG_DataSource *_Nonnull ds,
+    const MAP_Page *_Nonnull pages)
+{
+	AG_Offset nChunksOffs;
+	Uint i, nChunks = 0;
+
+	nChunksOffs = AG_Tell(ds);
+	AG_WriteUint32(ds, 0);
+	for (i = 0; i < map->wChunks*map->hChunks; i++) {
+		if (pages[i].size == 0) {
+			continue;
+		}
+		AG_WriteUint16(ds, (Uint16)(i % map->wChunks));
+		AG_WriteUint16(ds, (Uint16)(i / map->wChunks));
+		AG_WriteUint32(ds, pages[i].offs);
+		AG_WriteUint32(ds, pages[i].size);
+		nChunks++;
+	}
+	AG_WriteUint32At(ds, (Uint32)nChunks, nChunksOffs);
+}
+
+/*
+ * Write the node chunks, followed by the chunk directory. Chunks which
+ * are not resident are copied from the paging source.
+ */
+static int
+SaveChunks(MAP *_Nonnull map, AG_DataSource *_Nonnull ds)
+{
+	MAP_Page *dir;
+	AG_Offset base;
+	Uint i, nTable = map->wChunks*map->hChunks;
+
+	if ((dir = TryMalloc((nTable + 1) * sizeof(MAP_Page))) == NULL) {
+		return (-1);
+	}
+	memset(dir, 0, (nTable + 1) * sizeof(MAP_Page));
+
+	base = AG_Tell(ds);
+	AG_WriteUint32(ds, 0);
+
+	for (i = 0; i < nTable; i++) {
+		MAP_Chunk *chunk = map->chunks[i];
+		AG_Offset offs = AG_Tell(ds);
+
+		if (chunk != NULL) {
+			if (ChunkIsEmpty(chunk)) {
+				continue;
+			}
+			SaveChunk(map, ds, chunk);
+		} else if (map->pages != NULL && map->pages[i].size != 0 &&
+		          (map->pages[i].flags & MAP_PAGE_BAD) == 0) {
+			const MAP_Page *page = &map->pages[i];
+			Uint8 *data;
+
+			if ((data = TryMalloc(page->size)) == NULL) {
+				goto fail;
+			}
+			if (AG_ReadAt(map->pageDs, data, page->size,
+			    map->pageBase + page->offs) == -1 ||
+			    AG_Write(ds, data, page->size) == -1) {
+				free(data);
+				goto fail;
+			}
+			free(data);
+		} else {
+			continue;
+		}
+		dir[i].offs = (Uint32)(offs - base);
+		dir[i].size = (Uint32)(AG_Tell(ds) - offs);
+	}
+	AG_WriteUint32At(ds, (Uint32)(AG_Tell(ds) - base), base);
+	SaveChunkDir(map, ds, dir);
+	free(dir);
+	return (0);
+fail:
+	free(dir);
+	return (-1);
+}
+
 static int
 Save(void *_Nonnull obj, AG_DataSource *_Nonnull ds)
 {
 	MAP *map = obj;
-	Uint i, x,y;
+	Uint i;
 	
 	AG_WriteUint32(ds, (Uint32)(map->flags & MAP_SAVED_FLAGS));
 	AG_WriteUint32(ds, (Uint32)map->w);
@@ -1225,12 +1779,225 @@ Save(void *_Nonnull obj, AG_DataSource *_Nonnull ds)
 		AG_WriteUint32At(ds, AG_Tell(ds) - skipSizeOffs, skipSizeOffs);
 	}
 
-	/* Populated nodes */
-	for (y = 0; y < map->h; y++) {
-		for (x = 0; x < map->w; x++)
-			MAP_NodeSave(map, ds, &map->map[y][x]);
+	/* Populated nodes (chunks of non-empty nodes) */
+	return SaveChunks(map, ds);
+}
+
+/*
+ * Open a map archive for paged access. Everything but the node chunks is
+ * loaded. Chunks are read in from the archive when first accessed, and
+ * MAP_SyncPaged() writes the modified chunks back. The archive remains
+ * open (for writing, if permitted) until the map is reset. Archives older
+ * than v12.3 are loaded entirely.
+ */
+int
+MAP_OpenPaged(MAP *map, const char *path)
+{
+	AG_ObjectHeader oh;
+	AG_ObjectClass *const *hier;
+	AG_DataSource *ds;
+	AG_Version ver;
+	Uint rdOnly = 0;
+	int i, nHier;
+
+	if (AG_ObjectLoadGenericFromFile(map, path) == -1) {
+		return (-1);
+	}
+	AG_LockVFS(map);
+	AG_ObjectLock(map);
+
+	if ((ds = AG_OpenFile(path, "r+b")) == NULL) {
+		if ((ds = AG_OpenFile(path, "rb")) == NULL) {
+			goto fail_unlock;
+		}
+		rdOnly = MAP_PAGED_RDONLY;
 	}
+	if (AG_ObjectReadHeader(ds, &oh) == -1 ||
+	    AG_Seek(ds, oh.dataOffs, AG_SEEK_SET) == -1 ||
+	    AG_ReadVersion(ds, OBJECT_CLASS(map)->name,
+	                   &OBJECT_CLASS(map)->ver, &ver) == -1) {
+		goto fail;
+	}
+	if (OBJECT(map)->flags & AG_OBJECT_DEBUG_DATA) {
+#ifdef AG_DEBUG
+		AG_SetSourceDebug(ds, 1);
+#else
+		AG_SetErrorS(_("Can't read without DEBUG"));
+		goto fail;
+#endif
+	}
+	if ((hier = AG_ObjectGetClassHier(map, &nHier)) == NULL) {
+		goto fail;
+	}
+	AG_ObjectReset(map);
+
+	map->pageDs = ds;
+	for (i = 0; i < nHier; i++) {
+		if (hier[i]->load == NULL) {
+			continue;
+		}
+		if (hier[i]->load(map, ds, &ver) == -1) {
+			AG_ObjectReset(map);		/* Closes ds */
+			goto fail_unlock;
+		}
+	}
+
+	if (map->pages == NULL) {			/* Loaded entirely */
+		map->pageDs = NULL;
+		AG_CloseFile(ds);
+	} else {
+		map->flags |= rdOnly;
+	}
+	AG_PostEvent(OBJECT(map)->root, "object-post-load", "%p,%s", map, path);
+
+	AG_ObjectUnlock(map);
+	AG_UnlockVFS(map);
 	return (0);
+fail:
+	AG_CloseFile(ds);
+fail_unlock:
+	AG_ObjectUnlock(map);
+	AG_UnlockVFS(map);
+	return (-1);
+}
+
+/* Update the map geometry in the header of a paged map. */
+static int
+SyncPagedGeometry(MAP *_Nonnull map, AG_DataSource *_Nonnull ds)
+{
+	if (AG_Seek(ds, map->pageGeom, AG_SEEK_SET) == -1) {
+		return (-1);
+	}
+	AG_WriteUint32(ds, (Uint32)map->w);
+	AG_WriteUint32(ds, (Uint32)map->h);
+	AG_WriteUint32(ds, (Uint32)map->xOrigin);
+	AG_WriteUint32(ds, (Uint32)map->yOrigin);
+	return AG_SyncDataSource(ds);
+}
+
+/*
+ * Write the resident chunks of a paged map which have changed since they
+ * were read back to the paging source, and update the map geometry.
+ * Changed chunks and the new chunk directory are appended to the archive,
+ * the previous versions are left as unreferenced space. Other changes
+ * (to layers, cameras and map objects) require a complete save.
+ */
+int
+MAP_SyncPaged(MAP *map)
+{
+	AG_DataSource *ds, *dsChunk;
+	Uint i, nTable, nWritten = 0, wOld, hOld;
+	int geomDone = 0;
+	AG_Offset offs;
+
+	AG_ObjectLock(map);
+
+	if ((ds = map->pageDs) == NULL) {
+		AG_SetErrorS("Map is not paged");
+		goto fail;
+	}
+	if (map->flags & MAP_PAGED_RDONLY) {
+		AG_SetErrorS("Paging source is read-only");
+		goto fail;
+	}
+	if ((dsChunk = AG_OpenAutoCore()) == NULL) {
+		goto fail;
+	}
+#ifdef AG_DEBUG
+	AG_SetSourceDebug(dsChunk, ds->debug);
+#endif
+	if (AG_Seek(ds, 0, AG_SEEK_END) == -1) {
+		goto fail_chunk;
+	}
+	offs = AG_Tell(ds);
+	nTable = map->wChunks*map->hChunks;
+	for (i = 0; i < nTable; i++) {
+		MAP_Chunk *chunk = map->chunks[i];
+		MAP_Page *page = &map->pages[i];
+		const Uint8 *data;
+		AG_Size size;
+		Uint32 hash;
+
+		if (chunk == NULL) {
+			continue;
+		}
+		if (ChunkIsEmpty(chunk)) {
+			if (page->size != 0) {
+				memset(page, 0, sizeof(MAP_Page));
+				nWritten++;
+			}
+			continue;
+		}
+		AG_Seek(dsChunk, 0, AG_SEEK_SET);
+		AG_CORE_SOURCE(dsChunk)->size = 0;
+		SaveChunk(map, dsChunk, chunk);
+		data = AG_CORE_SOURCE(dsChunk)->data;
+		size = AG_CORE_SOURCE(dsChunk)->size;
+		hash = HashChunkData(data, size);
+		if (page->size == size && page->hash == hash &&
+		    (page->flags & MAP_PAGE_BAD) == 0) {
+			continue;			/* Unchanged */
+		}
+		if ((AG_Size)(offs - map->pageBase) > 0xffffffffUL - size) {
+			AG_SetErrorS("Paged map exceeds 4GB of chunk data");
+			goto fail_chunk;
+		}
+		if (AG_Write(ds, data, size) == -1) {
+			goto fail_chunk;
+		}
+		page->offs = (Uint32)(offs - map->pageBase);
+		page->size = (Uint32)size;
+		page->hash = hash;
+		page->flags = 0;
+		offs += size;
+		nWritten++;
+	}
+	AG_CloseAutoCore(dsChunk);
+
+	/*
+	 * Append the new directory and commit it to storage before the
+	 * directory offset is patched in. The geometry is written last, so
+	 * that an interrupted shrink leaves the new directory within the old
+	 * (larger) bounds. If the chunk grid has grown, the geometry goes
+	 * first instead, so that the old directory is within the new bounds.
+	 */
+	if (nWritten > 0 || (map->flags & MAP_PAGED_DIRTY)) {
+		if ((AG_Size)(offs - map->pageBase) > 0xffffffffUL) {
+			AG_SetErrorS("Paged map exceeds 4GB of chunk data");
+			goto fail;
+		}
+		SaveChunkDir(map, ds, map->pages);
+		if (AG_SyncDataSource(ds) == -1 ||
+		    AG_Seek(ds, map->pageGeom, AG_SEEK_SET) == -1) {
+			goto fail;
+		}
+		wOld = (Uint)AG_ReadUint32(ds);
+		hOld = (Uint)AG_ReadUint32(ds);
+		if (((wOld + MAP_CHUNK_MASK) >> MAP_CHUNK_SHIFT) < map->wChunks ||
+		    ((hOld + MAP_CHUNK_MASK) >> MAP_CHUNK_SHIFT) < map->hChunks) {
+			if (SyncPagedGeometry(map, ds) == -1)
+				goto fail;
+			geomDone = 1;
+		}
+		if (AG_Seek(ds, map->pageBase, AG_SEEK_SET) == -1) {
+			goto fail;
+		}
+		AG_WriteUint32(ds, (Uint32)(offs - map->pageBase));
+		if (AG_SyncDataSource(ds) == -1) {
+			goto fail;
+		}
+		map->flags &= ~(MAP_PAGED_DIRTY);
+	}
+	if (!geomDone && SyncPagedGeometry(map, ds) == -1)
+		goto fail;
+
+	AG_ObjectUnlock(map);
+	return (0);
+fail_chunk:
+	AG_CloseAutoCore(dsChunk);
+fail:
+	AG_ObjectUnlock(map);
+	return (-1);
 }
 
 static MAP_Item *_Nullable
@@ -1257,69 +2024,45 @@ LocateItem(MAP *_Nonnull map, MAP_Node *_Nonnull node, int xOffs, int yOffs,
 	return (NULL);
 }
 
-/* Locate a map item. */
+/*
+ * Locate a map item at the given map coordinates (in pixels), looking
+ * at the node under the point first, then its neighbours.
+ */
 MAP_Item *
 MAP_ItemLocate(MAP *map, int xMap, int yMap, int ncam)
 {
-	MAP_Camera *cam = &map->cameras[ncam];
+	static const int neighs[9][2] = {
+		{  0, 0 },
+		{  0,+1 }, {  0,-1 }, { +1, 0 }, { -1, 0 },
+		{ +1,+1 }, { -1,-1 }, { -1,+1 }, { +1,-1 }
+	};
+	MAP_Camera *cam;
+	MAP_Node *node;
 	MAP_Item *mi;
-	const int tileSz = cam->tilesz;
-	int x,y, xOffs,yOffs;
+	int tileSz, x,y, xOffs,yOffs, i;
 
-	if (ncam < 0 || ncam >= map->nCameras ||
- 	    xMap < 0 || yMap < 0 || xMap >= map->w || yMap >= map->h) {
+	if (ncam < 0 || ncam >= (int)map->nCameras || xMap < 0 || yMap < 0) {
 		return (NULL);
 	}
+	cam = &map->cameras[ncam];
+	tileSz = cam->tilesz;
 	x = xMap / tileSz;
 	y = yMap / tileSz;
+	if (x >= (int)map->w || y >= (int)map->h) {
+		return (NULL);
+	}
 	xOffs = xMap % tileSz;
 	yOffs = yMap % tileSz;
 
-	if ((mi = LocateItem(map, &map->map[y][x], xOffs,yOffs, 0,0, ncam))
-	    != NULL) {
-		return (mi);
-	}
-
-	if (y+1 < map->h) {
-		if ((mi = LocateItem(map, &map->map[y+1][x], xOffs, yOffs,
-		    0, -cam->tilesz, ncam)) != NULL)
-			return (mi);
-	}
-	if (y-1 >= 0) {
-		if ((mi = LocateItem(map, &map->map[y-1][x], xOffs, yOffs,
-		    0, +cam->tilesz, ncam)) != NULL)
-			return (mi);
-	}
-	if (x+1 < (int)map->w) {
-		if ((mi = LocateItem(map, &map->map[y][x+1], xOffs, yOffs,
-		    -cam->tilesz, 0, ncam)) != NULL)
-			return (mi);
-	}
-	if (x-1 >= 0) {
-		if ((mi = LocateItem(map, &map->map[y][x-1], xOffs, yOffs,
-		    +cam->tilesz, 0, ncam)) != NULL)
-			return (mi);
-	}
+	for (i = 0; i < 9; i++) {
+		const int dx = neighs[i][0];
+		const int dy = neighs[i][1];
 
-	/* Check diagonal nodes. */
-	if (x+1 < map->w && y+1 < map->h) {
-		if ((mi = LocateItem(map, &map->map[y+1][x+1], xOffs, yOffs,
-		    -cam->tilesz, -cam->tilesz, ncam)) != NULL)
-			return (mi);
-	}
-	if (x-1 >= 0 && y-1 >= 0) {
-		if ((mi = LocateItem(map, &map->map[y-1][x-1], xOffs, yOffs,
-		    +cam->tilesz, +cam->tilesz, ncam)) != NULL)
-			return (mi);
-	}
-	if (x-1 >= 0 && y+1 < map->h) {
-		if ((mi = LocateItem(map, &map->map[y+1][x-1], xOffs, yOffs,
-		    +cam->tilesz, -cam->tilesz, ncam)) != NULL)
-			return (mi);
-	}
-	if (x+1 < map->w && y-1 >= 0) {
-		if ((mi = LocateItem(map, &map->map[y-1][x+1], xOffs, yOffs,
-		    -cam->tilesz, +cam->tilesz, ncam)) != NULL)
+		if ((node = MAP_LookupNode(map, x+dx, y+dy)) == NULL) {
+			continue;			/* Outside or empty */
+		}
+		if ((mi = LocateItem(map, node, xOffs, yOffs,
+		    -dx*tileSz, -dy*tileSz, ncam)) != NULL)
 			return (mi);
 	}
 	return (NULL);
@@ -1412,8 +2155,8 @@ MAP_UndoRevision(MAP *map, MAP_Revision *rev, MAP_Revision *undoRedo,
 		switch (chg->type) {
 		case MAP_CHANGE_NODECHG:
 		{
-			MAP_Node *node = &map->map[chg->mm_nodechg.y]
-			                          [chg->mm_nodechg.x];
+			MAP_Node *node = MAP_GetNode(map, chg->mm_nodechg.x,
+			                                  chg->mm_nodechg.y);
 
 			Debug(map, "Undo(#%d): Reverting node at "
 			           "[" AGSI_BOLD "%d,%d" AGSI_RST "]\n",
@@ -1505,7 +2248,8 @@ MAP_Redo(MAP *map)
 void
 MAP_NodeRevision(MAP *map, int x, int y, MAP_Revision *undoRedo, Uint nUndoRedo)
 {
-	MAP_Node *node = &map->map[y][x], *nodeSave;
+	const MAP_Node *node = MAP_LookupNode(map, x,y);
+	MAP_Node *nodeSave;
 	MAP_Revision *rev;
 	MAP_Change *chg;
 	MAP_Item *mi;
@@ -1536,6 +2280,9 @@ MAP_NodeRevision(MAP *map, int x, int y, MAP_Revision *undoRedo, Uint nUndoRedo)
 	nodeSave = &chg->mm_nodechg.node;
 	MAP_NodeInit(nodeSave);
 
+	if (node == NULL)			/* Not resident (empty) */
+		return;
+
 	/* Map Items */
 	TAILQ_FOREACH(mi, &node->items, items)
 		MAP_DuplicateItem(map,nodeSave,-1, mi);
@@ -1580,7 +2327,7 @@ AG_GenerateMapFromSurface(AG_Gfx *gfx, AG_Surface *sprite)
 			Uint32 sckflags = sprite->flags & (AG_SRCCOLORKEY);
 			Uint8 salpha = sprite->format->alpha;
 			Uint32 scolorkey = sprite->format->colorkey;
-			MAP_Node *node = &fragmap->map[my][mx];
+			MAP_Node *node = MAP_GetNode(fragmap, mx,my);
 			Uint32 nsprite;
 			int fw = MAP_TILESZ_DEF;
 			int fh = MAP_TILESZ_DEF;
@@ -2112,7 +2859,9 @@ DeleteLayer(AG_Event *_Nonnull event)
 	MAP *map = MAP_PTR(1);
 	MAP_Layer *pLayer = AG_PTR(2);
 	AG_Tlist *tlLayers = AG_TLIST_PTR(3);
-	Uint i, x,y, layer;
+	MAP_Region r;
+	MAP_Node *node;
+	Uint i, layer;
 	
 	for (layer = 0; layer < map->nLayers; layer++) {
 		if (&map->layers[layer] == pLayer)
@@ -2133,25 +2882,23 @@ DeleteLayer(AG_Event *_Nonnull event)
 	if (map->layerCur <= (int)map->nLayers)
 		map->layerCur = (int)map->nLayers - 1;
 
-	for (y = 0; y < map->h; y++) {
-		for (x = 0; x < map->w; x++) {
-			MAP_Node *node = &map->map[y][x];
-			MAP_Item *mi;
+	MAP_FOREACH_NODE(node, &r, map, 0,0, map->w,map->h) {
+		MAP_Item *mi;
 
-			MAP_NodeClear(map, node, layer);
+		MAP_NodeClear(map, node, layer);
 
-			TAILQ_FOREACH(mi, &node->items, items) {
-				if (mi->layer > layer)
-					mi->layer--;
-			}
-			for (i = 0; i < node->nLocs; i++) {
-				MAP_Location *loc = &node->locs[i];
+		TAILQ_FOREACH(mi, &node->items, items) {
+			if (mi->layer > layer)
+				mi->layer--;
+		}
+		for (i = 0; i < node->nLocs; i++) {
+			MAP_Location *loc = &node->locs[i];
 
-				if (loc->layer > layer)
-					loc->layer--;
-			}
+			if (loc->layer > layer)
+				loc->layer--;
 		}
 	}
+	MAP_CompactNodes(map);
 	AG_TlistRefresh(tlLayers);
 }
 
@@ -2161,15 +2908,18 @@ ClearLayer(AG_Event *_Nonnull event)
 {
 	MAP *map = MAP_PTR(1);
 	const MAP_Layer *pLayer = AG_PTR(2);
-	Uint x,y, layer;
+	MAP_Region r;
+	MAP_Node *node;
+	Uint layer;
 	
 	for (layer = 0; layer < map->nLayers; layer++) {
 		if (&map->layers[layer] == pLayer)
 			break;
 	}
-	for (y = 0; y < map->h; y++)
-		for (x = 0; x < map->w; x++)
-			MAP_NodeClear(map, &map->map[y][x], layer);
+	MAP_FOREACH_NODE(node, &r, map, 0,0, map->w,map->h) {
+		MAP_NodeClear(map, node, layer);
+	}
+	MAP_CompactNodes(map);
 }
 
 /* Move a layer (and its associated items) up or down the stack. */
@@ -2181,8 +2931,9 @@ MoveLayer(AG_Event *_Nonnull event)
 	MAP_Layer *lay1 = AG_PTR(2), *lay2;
 	const int moveDown = AG_INT(3);
 	AG_Tlist *tlLayers = AG_TLIST_PTR(4);
+	MAP_Region r;
+	MAP_Node *node;
 	Uint l1, l2;
-	Uint x, y;
 
 	for (l1 = 0; l1 < map->nLayers; l1++) {
 		if (&map->layers[l1] == lay1)
@@ -2204,27 +2955,24 @@ MoveLayer(AG_Event *_Nonnull event)
 	Strlcpy(lay1->name, lay2->name, sizeof(lay1->name));
 	Strlcpy(lay2->name, tmp, sizeof(lay2->name));
 
-	for (y = 0; y < map->h; y++) {
-		for (x = 0; x < map->w; x++) {
-			MAP_Node *node = &map->map[y][x];
-			MAP_Item *mi;
-			Uint i;
+	MAP_FOREACH_NODE(node, &r, map, 0,0, map->w,map->h) {
+		MAP_Item *mi;
+		Uint i;
 
-			TAILQ_FOREACH(mi, &node->items, items) {
-				if (mi->layer == l1) {
-					mi->layer = l2;
-				} else if (mi->layer == l2) {
-					mi->layer = l1;
-				}
+		TAILQ_FOREACH(mi, &node->items, items) {
+			if (mi->layer == l1) {
+				mi->layer = l2;
+			} else if (mi->layer == l2) {
+				mi->layer = l1;
 			}
-			for (i = 0; i < node->nLocs; i++) {
-				MAP_Location *loc = &node->locs[i];
+		}
+		for (i = 0; i < node->nLocs; i++) {
+			MAP_Location *loc = &node->locs[i];
 
-				if (loc->layer == l1) {
-					loc->layer = l2;
-				} else if (loc->layer == l2) {
-					loc->layer = l1;
-				}
+			if (loc->layer == l1) {
+				loc->layer = l2;
+			} else if (loc->layer == l2) {
+				loc->layer = l1;
 			}
 		}
 	}
@@ -2312,21 +3060,19 @@ RemoveAllRefsToTileset(AG_Event *_Nonnull event)
 	AG_TlistItem *it = AG_TlistSelectedItem(tl);
 	RG_Tileset *ts = it->p1;
 	MAP *map = mv->map;
-	Uint x,y;
-
-	for (y = 0; y < map->h; y++) {
-		for (x = 0; x < map->w; x++) {
-			MAP_Node *node = &map->map[y][x];
-			MAP_Item *mi, *miNext;
-
-			for (mi = TAILQ_FIRST(&node->items);
-			     mi != TAILQ_END(&node->items);
-			     mi = miNext) {
-				miNext = TAILQ_NEXT(mi, items);
-				if (mi->type == MAP_ITEM_TILE &&
-				    MAPTILE(mi)->obj == ts)
-					MAP_NodeDelItem(map, node, mi);
-			}
+	MAP_Region r;
+	MAP_Node *node;
+
+	MAP_FOREACH_NODE(node, &r, map, 0,0, map->w,map->h) {
+		MAP_Item *mi, *miNext;
+
+		for (mi = TAILQ_FIRST(&node->items);
+		     mi != TAILQ_END(&node->items);
+		     mi = miNext) {
+			miNext = TAILQ_NEXT(mi, items);
+			if (mi->type == MAP_ITEM_TILE &&
+			    MAPTILE(mi)->obj == ts)
+				MAP_NodeDelItem(map, node, mi);
 		}
 	}
 }
@@ -2340,26 +3086,24 @@ RemoveAllRefsToTile(AG_Event *_Nonnull event)
 	AG_TlistItem *it = AG_TlistSelectedItem(tl);
 	RG_Tile *tile = it->p1;
 	MAP *map = mv->map;
-	Uint x,y;
-
-	for (y = 0; y < map->h; y++) {
-		for (x = 0; x < map->w; x++) {
-			MAP_Node *node = &map->map[y][x];
-			MAP_Item *mi, *miNext;
-			RG_Tile *ntile;
-
-			for (mi = TAILQ_FIRST(&node->items);
-			     mi != TAILQ_END(&node->items);
-			     mi = miNext) {
-				miNext = TAILQ_NEXT(mi, items);
-
-				if (mi->type == MAP_ITEM_TILE &&
-				    RG_LookupTile(MAPTILE(mi)->obj,
-				                  MAPTILE(mi)->id,
-						  &ntile) == 0 &&
-				    (ntile == tile)) {
-					MAP_NodeDelItem(map, node, mi);
-				}
+	MAP_Region r;
+	MAP_Node *node;
+
+	MAP_FOREACH_NODE(node, &r, map, 0,0, map->w,map->h) {
+		MAP_Item *mi, *miNext;
+		RG_Tile *ntile;
+
+		for (mi = TAILQ_FIRST(&node->items);
+		     mi != TAILQ_END(&node->items);
+		     mi = miNext) {
+			miNext = TAILQ_NEXT(mi, items);
+
+			if (mi->type == MAP_ITEM_TILE &&
+			    RG_LookupTile(MAPTILE(mi)->obj,
+			                  MAPTILE(mi)->id,
+					  &ntile) == 0 &&
+			    (ntile == tile)) {
+				MAP_NodeDelItem(map, node, mi);
 			}
 		}
 	}
@@ -2829,7 +3573,7 @@ Edit(void *_Nonnull obj)
 AG_ObjectClass mapClass = {
 	"MAP",
 	sizeof(MAP),
-	{ 12,1, AGC_MAP, 0xE02D },
+	{ 12,3, AGC_MAP, 0xE02D },
 	Init,
 	Reset,
 	Destroy,
@@ -125,6 +125,34 @@ typedef struct map_node {
 	struct map_itemq               items; /* Static items */
 } MAP_Node;
 
+#ifndef MAP_CHUNK_SHIFT
+#define MAP_CHUNK_SHIFT 5			/* log2 of chunk width */
+#endif
+#define MAP_CHUNK_SIZE  (1 << MAP_CHUNK_SHIFT)	/* Chunk width in nodes */
+#define MAP_CHUNK_MASK  (MAP_CHUNK_SIZE - 1)
+#define MAP_CHUNK_NODES (MAP_CHUNK_SIZE * MAP_CHUNK_SIZE)
+
+/* Square block of nodes (allocated on demand). */
+typedef struct map_chunk {
+	MAP_Node nodes[MAP_CHUNK_NODES];	/* Nodes (row-major) */
+} MAP_Chunk;
+
+/* Location of a chunk in the paging source of a map (see MAP_OpenPaged()). */
+typedef struct map_page {
+	Uint32 offs;				/* Offset of chunk data */
+	Uint32 size;				/* Size of chunk data (or 0) */
+	Uint32 hash;				/* FNV-1a hash of chunk data */
+	Uint32 flags;
+#define MAP_PAGE_BAD	0x01			/* Chunk data is unreadable */
+} MAP_Page;
+
+/* Iterator over the resident nodes of a rectangular region. */
+typedef struct map_region {
+	int x1, y1;				/* Upper-left node */
+	int x2, y2;				/* Lower-right node (exclusive) */
+	int x, y;				/* Current node */
+} MAP_Region;
+
 typedef struct map_layer {
 	char name[MAP_LAYER_NAME_MAX];
 	int visible;				/* Show/hide flag */
@@ -190,6 +218,8 @@ typedef struct map {
 	Uint flags;
 #define MAP_SAVE_CAM0POS  0x01			/* Save cam0 position */
 #define MAP_SAVE_CAM0ZOOM 0x02			/* Save cam0 zoom factor */
+#define MAP_PAGED_RDONLY  0x100			/* Paging source is read-only */
+#define MAP_PAGED_DIRTY   0x200			/* Chunk directory changed */
 #define MAP_SAVED_FLAGS	(MAP_SAVE_CAM0POS | MAP_SAVE_CAM0ZOOM)
 
 	Uint w, h;				/* Map size (in nodes) */
@@ -197,7 +227,14 @@ typedef struct map {
 	int xOrigin, yOrigin;			/* Origin node */
 	int layerOrigin;			/* Origin node layer# */
 	Uint nChanges;				/* Changes since last action (for MAP_Tool) */
-	MAP_Node *_Nullable *_Nonnull map;	/* Arrays of nodes */
+	MAP_Chunk *_Nullable *_Nullable chunks;	/* Chunk table (row-major) */
+	Uint wChunks, hChunks;			/* Chunk table size */
+	Uint nChunks;				/* Resident chunks */
+	Uint32 _pad1;
+	AG_DataSource *_Nullable pageDs;	/* Paging source (or NULL) */
+	MAP_Page *_Nullable pages;		/* Chunks in paging source */
+	AG_Offset pageBase;			/* Base offset of chunk data */
+	AG_Offset pageGeom;			/* Offset of map geometry */
 	MAP_Layer *_Nonnull layers;		/* Layer information */
 	Uint               nLayers;		/* Layer count */
 	Uint                nCameras;		/* Camera count */
@@ -228,6 +265,12 @@ typedef struct map {
 
 #define MAPITEM(mi) ((MAP_Item *)(mi))
 
+/* Iterate over the resident nodes of a region, in row-major order. */
+#define MAP_FOREACH_NODE(node, r, map, x, y, w, h)			\
+	for ((node) = MAP_RegionFirst((map), (r), (x), (y), (w), (h));	\
+	     (node) != NULL;						\
+	     (node) = MAP_RegionNext((map), (r)))
+
 __BEGIN_DECLS
 extern AG_ObjectClass mapClass;
 extern MAP_ItemClass *mapItemClasses[MAP_ITEM_LAST];
@@ -240,6 +283,18 @@ MAP *_Nonnull MAP_New(void *_Nullable, const char *_Nonnull);
 int  MAP_AllocNodes(MAP *_Nonnull, Uint,Uint);
 void MAP_FreeNodes(MAP *_Nonnull);
 int  MAP_Resize(MAP *_Nonnull, Uint,Uint);
+void MAP_CompactNodes(MAP *_Nonnull);
+
+MAP_Node *_Nonnull  MAP_GetNode(MAP *_Nonnull, int,int);
+MAP_Node *_Nullable MAP_LookupNode(MAP *_Nonnull, int,int);
+MAP_Node *_Nullable MAP_RegionFirst(MAP *_Nonnull, MAP_Region *_Nonnull,
+                                    int,int, int,int);
+MAP_Node *_Nullable MAP_RegionNext(MAP *_Nonnull, MAP_Region *_Nonnull);
+int                 MAP_NodeIsEmpty(const MAP_Node *_Nonnull);
+
+int  MAP_OpenPaged(MAP *_Nonnull, const char *_Nonnull);
+int  MAP_SyncPaged(MAP *_Nonnull);
+
 void MAP_SetZoom(MAP *_Nonnull, int, Uint);
 int  MAP_PushLayer(MAP *_Nonnull, const char *_Nonnull);
 void MAP_PopLayer(MAP *_Nonnull);
@@ -416,8 +416,9 @@ Draw(void *_Nonnull obj)
 	MAP_View *mv = obj;
 	MAP_ViewDrawCb *dcb;
 	MAP *map = mv->map;
+	MAP_Region reg;
 	MAP_Node *node;
-	int mx, my, rx = 0, ry = 0, tileSz;
+	int mw = 0, mh = 0, rxEnd = 0, ryEnd = 0, tileSz;
 	Uint layer = 0;
 	AG_Rect r, rSel, mSel, rExtent;
 	AG_Color c, c2;
@@ -454,124 +455,136 @@ Draw(void *_Nonnull obj)
 
 	AG_ObjectLock(map);
 
-	if (map->map == NULL) {
+	if (map->chunks == NULL) {
 		goto out;
 	}
 	tileSz = MAP_TILESZ(mv);
+
+	/* Bounds of the visible area (in nodes and pixels). */
+	mw = (int)mv->mw + 1;
+	mh = (int)mv->mh + 1;
+	if (mv->mx + mw > (int)map->w) { mw = (int)map->w - mv->mx; }
+	if (mv->my + mh > (int)map->h) { mh = (int)map->h - mv->my; }
+	if (mw > 0 && mh > 0) {
+		rxEnd = mv->xOffs + mw*tileSz;
+		ryEnd = mv->yOffs + mh*tileSz;
+	} else {
+		ryEnd = mv->yOffs;
+	}
 draw_layer:
 	if (!map->layers[layer].visible) {
 		goto next_layer;
 	}
-	for (my = mv->my, ry = mv->yOffs;
-	     ((my - mv->my) <= (int)mv->mh) && (my < (int)map->h);
-	     my++, ry += tileSz) {
-
-		for (mx = mv->mx, rx = mv->xOffs;
-	     	     ((mx - mv->mx) <= (int)mv->mw) && (mx < (int)map->w);
-		     mx++, rx += tileSz) {
-			MAP_Item *mi;
-			Uint i;
 
-			node = &map->map[my][mx];
+	/* Only nodes in resident chunks hold anything to draw. */
+	MAP_FOREACH_NODE(node, &reg, map, mv->mx, mv->my, mw, mh) {
+		const int rx = mv->xOffs + (reg.x - mv->mx)*tileSz;
+		const int ry = mv->yOffs + (reg.y - mv->my)*tileSz;
+		MAP_Item *mi;
+		Uint i;
 
-			/*
-			 * Render static MAP_Items.
-			 */
-			TAILQ_FOREACH(mi, &node->items, items) {
-				MAP_ItemClass *miClass;
+		/*
+		 * Render static MAP_Items.
+		 */
+		TAILQ_FOREACH(mi, &node->items, items) {
+			MAP_ItemClass *miClass;
 
-				if (mi->layer != layer)
-					continue;
-
-				miClass = mapItemClasses[mi->type];
-				if (miClass->draw != NULL) {
-					miClass->draw(mv, mi, rx,ry, mv->cam);
-				}
-				if ((mi->layer == map->layerCur) &&
-				    (mv->mode == MAP_VIEW_EDIT_ATTRS)) {
-					MAP_ItemAttrColor(mv->edit_attr,
-					    (mi->flags & mv->edit_attr), &c);
-					r.x = rx;
-					r.y = ry;
-					r.w = tileSz;
-					r.h = tileSz;
-					AG_DrawRectBlended(mv, &r, &c,
-					    AG_ALPHA_SRC,
-					    AG_ALPHA_ONE_MINUS_SRC);
-				}
+			if (mi->layer != layer)
+				continue;
 
-				if ((mi->flags & MAP_ITEM_SELECTED) &&
-				    MAP_ItemExtent(map, mi, &rExtent, mv->cam) == 0) {
-					r.x = rx + rExtent.x - 1;
-					r.y = ry + rExtent.y - 1;
-					r.w = rExtent.w + 1;
-					r.h = rExtent.h + 1;
-					AG_ColorRGB_8(&c, 60,250,60);
-					AG_DrawRectOutline(mv, &r, &c);
-				}
+			miClass = mapItemClasses[mi->type];
+			if (miClass->draw != NULL) {
+				miClass->draw(mv, mi, rx,ry, mv->cam);
+			}
+			if ((mi->layer == map->layerCur) &&
+			    (mv->mode == MAP_VIEW_EDIT_ATTRS)) {
+				MAP_ItemAttrColor(mv->edit_attr,
+				    (mi->flags & mv->edit_attr), &c);
+				r.x = rx;
+				r.y = ry;
+				r.w = tileSz;
+				r.h = tileSz;
+				AG_DrawRectBlended(mv, &r, &c,
+				    AG_ALPHA_SRC,
+				    AG_ALPHA_ONE_MINUS_SRC);
 			}
 
-			/*
-			 * Render dynamic MAP_Objects.
-			 */
-			for (i = 0; i < node->nLocs; i++) {
-				MAP_Location *loc = &node->locs[i];
-				MAP_Object *mo = loc->obj;
-				AG_Rect rd;
-
-				if (loc->layer != layer) {
-					continue;
-				}
-				rd.x = rx;
-				rd.y = ry;
-				rd.w = MAP_TILESZ(mv);
-				rd.h = MAP_TILESZ(mv);
-				MAPOBJECTCLASS_OF(mo)->draw(mo, mv, &rd,
-				    MAP_OBJECT_TOP);
+			if ((mi->flags & MAP_ITEM_SELECTED) &&
+			    MAP_ItemExtent(map, mi, &rExtent, mv->cam) == 0) {
+				r.x = rx + rExtent.x - 1;
+				r.y = ry + rExtent.y - 1;
+				r.w = rExtent.w + 1;
+				r.h = rExtent.h + 1;
+				AG_ColorRGB_8(&c, 60,250,60);
+				AG_DrawRectOutline(mv, &r, &c);
 			}
+		}
 
-			if ((mv->flags & MAP_VIEW_EDIT) == 0)
-				continue;
+		/*
+		 * Render dynamic MAP_Objects.
+		 */
+		for (i = 0; i < node->nLocs; i++) {
+			MAP_Location *loc = &node->locs[i];
+			MAP_Object *mo = loc->obj;
+			AG_Rect rd;
 
-			/* TODO: move to tool draw callback */
-				
-			if ((mv->flags & MAP_VIEW_SHOW_ORIGIN) &&
-			    (mx == map->xOrigin && my == map->yOrigin)) {
-				const int t2 = tileSz >> 1;
-				const int rx2 = rx + tileSz;
-				const int ry2 = ry + tileSz;
-				const int rxt2 = rx+t2;
-				const int ryt2 = ry+t2;
-			
-				AG_ColorRGB_8(&c, 150,150,0);
-				AG_DrawCircle(mv, rxt2, ryt2, t2, &c);
-				AG_DrawLine(mv, rxt2, ry,   rxt2, ry2,  &c);
-				AG_DrawLine(mv, rx,   ryt2, rx2,  ryt2, &c);
-			}
-			if (mv->msel.set &&
-			    mv->msel.x == mx && mv->msel.y == my) {
-				mSel.x = rx + 1;
-				mSel.y = ry + 1;
-				mSel.w = mv->msel.xOffs * tileSz - 2;
-				mSel.h = mv->msel.yOffs * tileSz - 2;
-			}
-			if (mv->esel.set &&
-			    mv->esel.x == mx && mv->esel.y == my) {
-				rSel.x = rx;
-				rSel.y = ry;
-				rSel.w = tileSz * mv->esel.w;
-				rSel.h = tileSz * mv->esel.h;
+			if (loc->layer != layer) {
+				continue;
 			}
+			rd.x = rx;
+			rd.y = ry;
+			rd.w = MAP_TILESZ(mv);
+			rd.h = MAP_TILESZ(mv);
+			MAPOBJECTCLASS_OF(mo)->draw(mo, mv, &rd,
+			    MAP_OBJECT_TOP);
 		}
 	}
 next_layer:
 	if (++layer < map->nLayers)
 		goto draw_layer;			/* Draw next layer */
 
+	if ((mv->flags & MAP_VIEW_EDIT) && mw > 0 && mh > 0) {
+		/* TODO: move to tool draw callback */
+
+		if ((mv->flags & MAP_VIEW_SHOW_ORIGIN) &&
+		    map->xOrigin >= mv->mx && map->xOrigin < mv->mx+mw &&
+		    map->yOrigin >= mv->my && map->yOrigin < mv->my+mh) {
+			const int t2 = tileSz >> 1;
+			const int rxo = mv->xOffs + (map->xOrigin - mv->mx)*tileSz;
+			const int ryo = mv->yOffs + (map->yOrigin - mv->my)*tileSz;
+			const int rx2 = rxo + tileSz;
+			const int ry2 = ryo + tileSz;
+			const int rxt2 = rxo+t2;
+			const int ryt2 = ryo+t2;
+		
+			AG_ColorRGB_8(&c, 150,150,0);
+			AG_DrawCircle(mv, rxt2, ryt2, t2, &c);
+			AG_DrawLine(mv, rxt2, ryo,  rxt2, ry2,  &c);
+			AG_DrawLine(mv, rxo,  ryt2, rx2,  ryt2, &c);
+		}
+		if (mv->msel.set &&
+		    mv->msel.x >= mv->mx && mv->msel.x < mv->mx+mw &&
+		    mv->msel.y >= mv->my && mv->msel.y < mv->my+mh) {
+			mSel.x = mv->xOffs + (mv->msel.x - mv->mx)*tileSz + 1;
+			mSel.y = mv->yOffs + (mv->msel.y - mv->my)*tileSz + 1;
+			mSel.w = mv->msel.xOffs * tileSz - 2;
+			mSel.h = mv->msel.yOffs * tileSz - 2;
+		}
+		if (mv->esel.set &&
+		    mv->esel.x >= mv->mx && mv->esel.x < mv->mx+mw &&
+		    mv->esel.y >= mv->my && mv->esel.y < mv->my+mh) {
+			rSel.x = mv->xOffs + (mv->esel.x - mv->mx)*tileSz;
+			rSel.y = mv->yOffs + (mv->esel.y - mv->my)*tileSz;
+			rSel.w = tileSz * mv->esel.w;
+			rSel.h = tileSz * mv->esel.h;
+		}
+	}
+
 	if (mv->flags & MAP_VIEW_GRID) {
-		int rx2 = rx;
+		const int rx2 = rxEnd;
+		int rx = rxEnd, ry;
 
-		for (; ry >= mv->yOffs; ry -= tileSz) {
+		for (ry = ryEnd; ry >= mv->yOffs; ry -= tileSz) {
 			AG_DrawLineBlended(mv,
 			    mv->xOffs,     /* x1 */
 			    ry,            /* y1 */
@@ -776,21 +789,22 @@ ToggleAttribute(MAP_View *_Nonnull mv)
 	MAP_BeginRevision(map);
 	MAP_NodeRevision(map, mv->cx, mv->cy, map->undo, map->nUndo);
 
-	node = &map->map[mv->cy][mv->cx];
-	TAILQ_FOREACH(mi, &node->items, items) {
-		if (mi->layer != map->layerCur) {
-			continue;
-		}
-		if (mi->flags & mv->edit_attr) {
-			mi->flags &= ~(mv->edit_attr);
-			MAP_ViewStatus(mv, "[%d,%d]: ref %p flags 0x%x -> clear 0x%x",
-			    mv->cx, mv->cy, mi->flags, mv->edit_attr);
-		} else {
-			mi->flags |= mv->edit_attr;
-			MAP_ViewStatus(mv, "[%d,%d]: ref %p flags 0x%x -> set 0x%x",
-			    mv->cx, mv->cy, mi->flags, mv->edit_attr);
+	if ((node = MAP_LookupNode(map, mv->cx, mv->cy)) != NULL) {
+		TAILQ_FOREACH(mi, &node->items, items) {
+			if (mi->layer != map->layerCur) {
+				continue;
+			}
+			if (mi->flags & mv->edit_attr) {
+				mi->flags &= ~(mv->edit_attr);
+				MAP_ViewStatus(mv, "[%d,%d]: ref %p flags 0x%x -> clear 0x%x",
+				    mv->cx, mv->cy, mi->flags, mv->edit_attr);
+			} else {
+				mi->flags |= mv->edit_attr;
+				MAP_ViewStatus(mv, "[%d,%d]: ref %p flags 0x%x -> set 0x%x",
+				    mv->cx, mv->cy, mi->flags, mv->edit_attr);
+			}
+			nToggled++;
 		}
-		nToggled++;
 	}
 
 	MAP_CommitRevision(map);
@@ -848,7 +862,7 @@ MouseMotion(void *obj, int x, int y, int dx, int dy)
 			if (mv->curtool != NULL &&
 			    mv->curtool->ops->effect != NULL &&
 			    (rv = mv->curtool->ops->effect(mv->curtool,
-			     &map->map[mv->cy][mv->cx])) != -1) {
+			     MAP_GetNode(map, mv->cx, mv->cy))) != -1) {
 				map->nChanges += rv;
 				goto out;
 			}
@@ -953,7 +967,7 @@ MouseButtonDown(void *obj, AG_MouseButton button, int x, int y)
 			    mv->curtool->ops->effect != NULL &&
 			    InsideNodeSelection(mv, mv->cx, mv->cy)) {
 				if ((rv = mv->curtool->ops->effect(mv->curtool,
-				     &map->map[mv->cy][mv->cx])) != -1) {
+				     MAP_GetNode(map, mv->cx, mv->cy))) != -1) {
 					mv->map->nChanges = rv;
 					goto out;
 				}
@@ -1008,8 +1022,9 @@ MouseButtonDown(void *obj, AG_MouseButton button, int x, int y)
 			goto out;
 		} else {
 			const AG_KeyMod mod = AG_GetModState(mv);
+			MAP_Region r;
+			MAP_Node *node;
 			MAP_Item *mi;
-			int nx, ny;
 			
 			if (mv->curtool != NULL &&
 			    mv->curtool->ops == &mapNodeselOps &&
@@ -1018,15 +1033,10 @@ MouseButtonDown(void *obj, AG_MouseButton button, int x, int y)
 				goto out;
 			}
 			if ((mod & AG_KEYMOD_CTRL) == 0) {
-				for (ny = 0; ny < (int)map->h; ny++) {
-					for (nx = 0; nx < (int)map->w; nx++) {
-						MAP_Node *node = &map->map[ny][nx];
-						
-						TAILQ_FOREACH(mi, &node->items, items) {
-							mi->flags &=
-							   ~(MAP_ITEM_SELECTED);
-						}
-					}
+				MAP_FOREACH_NODE(node, &r, map,
+				    0,0, map->w,map->h) {
+					TAILQ_FOREACH(mi, &node->items, items)
+						mi->flags &= ~(MAP_ITEM_SELECTED);
 				}
 			}
 		}
@@ -220,10 +220,13 @@ Effect(MAP_Tool *_Nonnull t, MAP_Node *_Nonnull n)
 			for (sx = 0, dx = mv->cx;
 			     sx < mapSrc->w && dx < map->w;
 			     sx++, dx++) {
-				MAP_Node *nodeSrc = &mapSrc->map[sy][sx];
-				MAP_Node *nodeDst = &map->map[dy][dx];
+				MAP_Node *nodeSrc = MAP_LookupNode(mapSrc, sx,sy);
+				MAP_Node *nodeDst = MAP_LookupNode(map, dx,dy);
 				MAP_Item *miSrc, *miDst;
 
+				if (nodeSrc == NULL || nodeDst == NULL) {
+					continue;
+				}
 				TAILQ_FOREACH(miSrc, &nodeSrc->items, items) {
 					TAILQ_FOREACH(miDst, &nodeDst->items, items) {
 						Interpolate(
@@ -316,7 +319,7 @@ Cursor(MAP_Tool *_Nonnull t, AG_Rect *_Nonnull rd)
 			for (sx = 0, dx = rd->x;
 			     sx < mapSrc->w;
 			     sx++, dx += tileSz) {
-				MAP_Node *nodeSrc = &mapSrc->map[sy][sx];
+				MAP_Node *nodeSrc = MAP_GetNode(mapSrc, sx,sy);
 				MAP_Item *mi;
 
 				TAILQ_FOREACH(mi, &nodeSrc->items, items) {
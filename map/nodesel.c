@@ -101,7 +101,8 @@ MAP_NodeselMoveBegin(MAP_View *mv)
 {
 	MAP *map = mv->map;
 	MAP *mapTmp = &mv->esel.map;
-	int x,y, xTmp,yTmp;
+	MAP_Region r;
+	MAP_Node *nodeSrc;
 	Uint layerCur;
 	const int xSel = mv->esel.x;
 	const int ySel = mv->esel.y;
@@ -121,19 +122,11 @@ MAP_NodeselMoveBegin(MAP_View *mv)
 	
 	MAP_BeginRevision(map);
 
-	for (yTmp = 0, y = ySel;
-	     yTmp < hSel;
-	     yTmp++, y++) {
-		for (xTmp = 0, x = xSel;
-		     xTmp < wSel;
-		     xTmp++, x++) {
-			MAP_Node *nodeSrc = &map->map[y][x];
-
-			MAP_NodeRevision(map, x,y, map->undo, map->nUndo);
-			MAP_NodeCopy(mapTmp, &mapTmp->map[yTmp][xTmp], layerCur,
-			             nodeSrc, layerCur);
-			MAP_NodeClear(map, nodeSrc, layerCur);
-		}
+	MAP_FOREACH_NODE(nodeSrc, &r, map, xSel,ySel, wSel,hSel) {
+		MAP_NodeRevision(map, r.x,r.y, map->undo, map->nUndo);
+		MAP_NodeCopy(mapTmp, MAP_GetNode(mapTmp, r.x-xSel, r.y-ySel),
+		             layerCur, nodeSrc, layerCur);
+		MAP_NodeClear(map, nodeSrc, layerCur);
 	}
 	
 	mv->esel.flags |= MAP_VIEW_SELECTION_MOVING;
@@ -170,26 +163,28 @@ MAP_NodeselMoveEnd(MAP_View *mv)
 {
 	MAP *map = mv->map;
 	MAP *mapTmp = &mv->esel.map;
-	int x,y, xDst,yDst;
+	MAP_Region r;
+	MAP_Node *node;
 	const Uint layerCur = map->layerCur;
 	const int hSel = mv->esel.h;
 	const int wSel = mv->esel.w;
 	const int xSel = mv->esel.x;
 	const int ySel = mv->esel.y;
 
-	for (y=0, yDst=ySel;
-	     y < hSel;
-	     y++, yDst++) {
-		for (x=0, xDst=xSel;
-		     x < wSel;
-		     x++, xDst++) {
-			MAP_Node *nodeDst = &map->map[yDst][xDst];
-
-			MAP_NodeRevision(map, xDst,yDst, map->undo, map->nUndo);
-			MAP_NodeClear(map, nodeDst, layerCur);
-			MAP_NodeCopy(map, nodeDst, layerCur,
-			    &mapTmp->map[y][x], layerCur);
+	MAP_FOREACH_NODE(node, &r, map, xSel,ySel, wSel,hSel) {
+		MAP_NodeRevision(map, r.x,r.y, map->undo, map->nUndo);
+		MAP_NodeClear(map, node, layerCur);
+	}
+	MAP_FOREACH_NODE(node, &r, mapTmp, 0,0, wSel,hSel) {
+		const int xDst = xSel + r.x;
+		const int yDst = ySel + r.y;
+
+		if (xDst >= (int)map->w || yDst >= (int)map->h) {
+			continue;
 		}
+		MAP_NodeRevision(map, xDst,yDst, map->undo, map->nUndo);
+		MAP_NodeCopy(map, MAP_GetNode(map, xDst,yDst), layerCur,
+		    node, layerCur);
 	}
 
 	MAP_CommitRevision(map);
@@ -211,7 +206,8 @@ MAP_NodeselCopy(MAP_Tool *tool, AG_KeySym key, int state, void *arg)
 	MAP_NodeselTool *selTool = (MAP_NodeselTool *)tool;
 	MAP_View *mv = tool->mv;
 	MAP *map = mv->map, *mapCopy = &selTool->mapCopy;
-	int xSrc,ySrc, x,y;
+	MAP_Region r;
+	MAP_Node *nodeSrc;
 	const int xSel = mv->esel.x;
 	const int ySel = mv->esel.y;
 	const int wSel = mv->esel.w;
@@ -221,7 +217,7 @@ MAP_NodeselCopy(MAP_Tool *tool, AG_KeySym key, int state, void *arg)
 		AG_TextMsg(AG_MSG_ERROR, _("There is no selection to copy."));
 		return (0);
 	}
-	if (mapCopy->map != NULL) {
+	if (mapCopy->chunks != NULL) {
 		MAP_FreeNodes(mapCopy);
 	}
 	if (MAP_AllocNodes(mapCopy, wSel,hSel) == -1) {
@@ -229,14 +225,9 @@ MAP_NodeselCopy(MAP_Tool *tool, AG_KeySym key, int state, void *arg)
 		return (0);
 	}
 
-	for (ySrc=ySel, y=0;
-	     ySrc < ySel+hSel;
-	     ySrc++, y++) {
-		for (xSrc=xSel, x=0;
-		     xSrc < xSel+wSel;
-		     xSrc++, x++)
-			MAP_NodeCopy(map, &map->map[ySrc][xSrc], map->layerCur,
-			    &mapCopy->map[y][x], 0);
+	MAP_FOREACH_NODE(nodeSrc, &r, map, xSel,ySel, wSel,hSel) {
+		MAP_NodeCopy(mapCopy, MAP_GetNode(mapCopy, r.x-xSel, r.y-ySel),
+		    0, nodeSrc, map->layerCur);
 	}
 
 	MAP_ViewStatus(mv, _("Copied (%dx%d) nodes to clipboard."), wSel,hSel);
@@ -255,9 +246,11 @@ MAP_NodeselPaste(MAP_Tool *tool, AG_KeySym key, int state, void *arg)
 	const int hDst = (int)map->h;
 	const int xSel = mv->esel.x;
 	const int ySel = mv->esel.y;
-	int xSrc,ySrc, x,y;
+	MAP_Region r;
+	MAP_Node *nodeSrc;
+	int x,y;
 	
-	if (mapCopy->map == NULL) {
+	if (mapCopy->chunks == NULL) {
 		AG_TextMsg(AG_MSG_ERROR, _("The copy buffer is empty!"));
 		return (0);
 	}
@@ -279,16 +272,10 @@ MAP_NodeselPaste(MAP_Tool *tool, AG_KeySym key, int state, void *arg)
 
 	MAP_BeginRevision(map);
 
-	for (ySrc=0, y=ySel;
-	     ySrc < hCopy && y < hDst;
-	     ySrc++, y++) {
-		for (xSrc=0, x=xSel;
-		     xSrc < wCopy && x < wDst;
-		     xSrc++, x++) {
-			MAP_NodeRevision(map, x,y, map->undo, map->nUndo);
-			MAP_NodeCopy(map, &map->map[y][x], map->layerCur,
-			    &mapCopy->map[ySrc][xSrc], 0);
-		}
+	MAP_FOREACH_NODE(nodeSrc, &r, mapCopy, 0,0, wDst-x,hDst-y) {
+		MAP_NodeRevision(map, x+r.x, y+r.y, map->undo, map->nUndo);
+		MAP_NodeCopy(map, MAP_GetNode(map, x+r.x, y+r.y),
+		    map->layerCur, nodeSrc, 0);
 	}
 
 	MAP_CommitRevision(map);
@@ -306,18 +293,17 @@ MAP_NodeselClear(MAP_Tool *tool, AG_KeySym key, int state, void *arg)
 	const int ySel = mv->esel.y;
 	const int wSel = mv->esel.w;
 	const int hSel = mv->esel.h;
-	int x, y;
+	MAP_Region r;
+	MAP_Node *node;
 
 	if (!mv->esel.set)
 		return (0);
 	
 	MAP_BeginRevision(map);
 
-	for (y = ySel; y < ySel + hSel; y++) {
-		for (x = xSel; x < xSel + wSel; x++) {
-			MAP_NodeRevision(map, x,y, map->undo, map->nUndo);
-			MAP_NodeClear(map, &map->map[y][x], map->layerCur);
-		}
+	MAP_FOREACH_NODE(node, &r, map, xSel,ySel, wSel,hSel) {
+		MAP_NodeRevision(map, r.x,r.y, map->undo, map->nUndo);
+		MAP_NodeClear(map, node, map->layerCur);
 	}
 	MAP_ViewStatus(mv, _("Cleared (%dx%d) nodes at "
 	                     "[" AGSI_BOLD "%d,%d" AGSI_RST "]."),
@@ -72,6 +72,10 @@
  *	[Frontend 3, EVENT] <---- (text/event-stream) <------+
  */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE			/* memmem(), strcasestr() */
+#endif
+
 #include <agar/core/core.h>
 #include <agar/net/web.h>
 
@@ -82,6 +86,8 @@
 #include <sys/un.h>
 #include <sys/stat.h>
 #include <sys/wait.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 
 #include <assert.h>
 #include <ctype.h>
@@ -100,10 +106,16 @@
 #include <agar/config/enable_nls.h>
 #include <agar/config/version.h>
 #include <agar/config/have_zlib.h>
+#include <agar/config/have_epoll.h>
 
 #ifdef HAVE_ZLIB
 #include <zlib.h>
 #endif
+#ifdef HAVE_EPOLL
+#include <sys/epoll.h>
+#else
+#include <poll.h>
+#endif
 
 char webLogFile[FILENAME_MAX];			/* Logfile path */
 
@@ -121,7 +133,6 @@ WEB_DestroyFn  webDestroyFn = NULL;
 
 char webWorkerSess[WEB_SESSID_MAX];		/* Session ID (in Worker) */
 char webWorkerUser[WEB_USERNAME_MAX];		/* Username (in Worker) */
-struct web_variableq webVars;			/* Template variables */
 Uint webQueryCount;				/* Query counter */
 struct web_session_socketq webWorkSockets;	/* Frontend->Worker sockets */
 
@@ -133,6 +144,16 @@ static int  webFrontSockets[WEB_MAXWORKERSOCKETS]; /* Worker->Frontend */
 static Uint webFrontSocketCount;
 static int  webCtrlSock;			   /* Local control socket */
 static char webPeerAddress[256];		   /* Peer address */
+static int  webHttpSocks[WEB_MAXHTTPSOCKETS];	   /* Listening sockets */
+static Uint webHttpSockCount;
+static struct web_connectionq webConns;		   /* Client connections */
+static Uint webConnCount;
+static struct web_connectionq webPendingConns;	   /* With buffered requests */
+static Uint webPendingCount;
+static WEB_Connection *webCurConn = NULL;	   /* Connection being serviced */
+#ifdef HAVE_EPOLL
+static int  webPollFd = -1;			   /* epoll instance */
+#endif
 
 static const int   webLogLvlNameLength = 6;
 static const char *webLogLvlNames[] = {
@@ -296,6 +317,7 @@ WEB_InitFrontQuery(WEB_Query *_Nonnull q, WEB_Method meth, int sock,
 	WEB_QueryInit(q, webLangs[0]);
 	q->method = meth;
 	q->sock = sock;
+	q->flags |= WEB_QUERY_KEEPALIVE;		/* HTTP/1.1 default */
 	if (ParseURL(q, url) == -1) {
 		return (-1);
 	}
@@ -307,22 +329,38 @@ WEB_InitFrontQuery(WEB_Query *_Nonnull q, WEB_Method meth, int sock,
 	return (0);
 }
 
+/* Parse a byte position in a Range header (0 to AG_INT_MAX). */
+static int
+ParseRangeBound(const char *_Nonnull s, int *_Nonnull rv)
+{
+	char *ep;
+	long lv;
+
+	errno = 0;
+	lv = strtol(s, &ep, 10);
+	if (s[0] == '\0' || *ep != '\0' || errno == ERANGE ||
+	    lv < 0 || lv > AG_INT_MAX) {
+		return (-1);
+	}
+	*rv = (int)lv;
+	return (0);
+}
+
 /* Parse Range request header */
 static int
 ParseRange(WEB_Query *_Nonnull q, char *_Nonnull s)
 {
 	char *from, *to;
-	const char *err;
 
 	if (strchr(s, ',') != NULL ||			/* Single range only */
 	    (from = Strsep(&s, "-")) == NULL ||
 	    (to = Strsep(&s, "-")) == NULL) {
 		goto fail_416;
 	}
-	q->rangeFrom = (int)strtonum(from, 0, AG_INT_MAX, &err);
-	if (err) { goto fail_416; }
-	q->rangeTo = (int)strtonum(to, 0, AG_INT_MAX, &err);
-	if (err) { goto fail_416; }
+	if (ParseRangeBound(from, &q->rangeFrom) == -1 ||
+	    ParseRangeBound(to, &q->rangeTo) == -1)
+		goto fail_416;
+
 	q->flags |= WEB_QUERY_RANGE;
 	return (0);
 fail_416:
@@ -336,6 +374,8 @@ WEB_ParseHeader(WEB_Query *_Nonnull q, char *_Nonnull s)
 {
 	if (strcasecmp(s, "Connection: keep-alive") == 0) {
 		q->flags |= WEB_QUERY_KEEPALIVE;
+	} else if (strcasecmp(s, "Connection: close") == 0) {
+		q->flags &= ~(WEB_QUERY_KEEPALIVE);
 #ifdef HAVE_ZLIB
 	} else if (strncasecmp(s, "Accept-Encoding: ",17)==0 &&
 	           (strcasestr(&s[17], "deflate") != NULL)) {	/* or x-deflate */
@@ -364,7 +404,7 @@ WEB_KeepAlive(WEB_Query *_Nonnull q)
 {
 	if (q->flags & WEB_QUERY_KEEPALIVE) {
 		WEB_SetHeaderS(q, "Connection", "keep-alive");
-/*		WEB_SetHeaderS(q, "Keep-Alive", "timeout=30, max=25"); */
+		WEB_SetHeader(q, "Keep-Alive", "timeout=%d", WEB_HTTP_REQ_TIMEOUT);
 		return (1);
 	} else {
 		WEB_SetHeaderS(q, "Connection", "close");
@@ -483,14 +523,17 @@ WEB_FrontPOST(int sock, const char *_Nonnull url, char *_Nonnull pHeaders,
 		/*
 		 * Parse URL-encoded arguments (must fit in existing buffer).
 		 */
-		if (q.contentLength > WEB_FRONTEND_RDBUFSIZE-rdBufLen-1) {
+		if (q.contentLength > WEB_FRONTEND_RDBUFSIZE-1) {
 			WEB_SetCode(&q, "400 Bad Request");
 			AG_SetError("Urlenc body too large (max %lu)",
-			    (Ulong)(WEB_FRONTEND_RDBUFSIZE - rdBufLen));
+			    (Ulong)(WEB_FRONTEND_RDBUFSIZE-1));
+			q.flags &= ~(WEB_QUERY_KEEPALIVE);	/* Close */
 			goto fail;
 		}
-		if (WEB_SYS_Read(sock, &rdBuf[rdBufLen], q.contentLength - rdBufLen) == -1) {
-			WEB_SetCode(&q, "500 Internal Server Error");
+		if (q.contentLength > rdBufLen) {
+			WEB_SetCode(&q, "400 Bad Request");
+			AG_SetErrorS("Short body");
+			q.flags &= ~(WEB_QUERY_KEEPALIVE);	/* Close */
 			goto fail;
 		}
 		((char *)rdBuf)[q.contentLength] = '\0';
@@ -565,16 +608,7 @@ WEB_FrontOPTIONS(int sock, const char *_Nonnull url, char *_Nonnull pHeaders,
 		WEB_SetCode(&q, "400 Bad Request");
 		goto fail;
 	}
-	if (q.contentLength > rdBufLen) {
-		char ignore[1024];
-		if (q.contentLength-rdBufLen > sizeof(ignore)) {
-			WEB_SetCode(&q, "400 Bad Request");
-			q.flags &= ~(WEB_QUERY_KEEPALIVE);	/* Close */
-			goto fail;
-		}
-		WEB_SYS_Read(sock, ignore, q.contentLength-rdBufLen);
-	}
-	q.flags |= WEB_QUERY_CONTENT_READ;
+	q.flags |= WEB_QUERY_CONTENT_READ;		/* Body is ignored */
 	rv = WEB_KeepAlive(&q);
 	WEB_BeginFrontQuery(&q, url, Sops);
 	WEB_SetHeaderS(&q, "Allow", "GET,HEAD,POST,OPTIONS");
@@ -1068,6 +1102,9 @@ WEB_BeginWorkerQuery(WEB_Query *q)
 	WEB_SetHeaderS(q, "Date", q->date);
 	if (q->flags & WEB_QUERY_KEEPALIVE) {
 		WEB_SetHeaderS(q, "Connection", "keep-alive");
+		WEB_SetHeader(q, "Keep-Alive", "timeout=%d", WEB_HTTP_REQ_TIMEOUT);
+	} else {
+		WEB_SetHeaderS(q, "Connection", "close");
 	}
 	TAILQ_FOREACH(ck, &q->cookies, cookies) {
 		char sc[WEB_COOKIE_SET_MAX];
@@ -1160,6 +1197,117 @@ WEB_BeginWorkerQuery(WEB_Query *q)
 	    _("Logout"));
 }
 
+/*
+ * Write response output to an HTTP client. In the Frontend, output to the
+ * connection being serviced never blocks: whatever the socket does not
+ * accept immediately is queued, and sent from the event loop once the
+ * socket becomes writable. Elsewhere (e.g., in a Worker), write to fd.
+ */
+static int
+ClientWritev(int fd, struct iovec *_Nonnull iov, int iovcnt)
+{
+	WEB_Connection *conn = webCurConn;
+	AG_Size total = 0, skip, len, sizeNew;
+	ssize_t rv = 0;
+	char *outNew;
+	int i;
+
+	if (conn == NULL || conn->fd != fd) {
+		for (i = 0; i < iovcnt; i++) {
+			if (WEB_SYS_Write(fd, iov[i].iov_base, iov[i].iov_len) == -1)
+				return (-1);
+		}
+		return (0);
+	}
+	if (conn->flags & WEB_CONNECTION_ERROR) {
+		AG_SetErrorS("Client connection failed");
+		return (-1);
+	}
+	for (i = 0; i < iovcnt; i++) {
+		total += iov[i].iov_len;
+	}
+	if (conn->outLen == 0) {
+try_write:
+		if ((rv = writev(fd, iov, iovcnt)) == -1) {
+			if (errno == EINTR) {
+				WEB_CheckSignals();
+				goto try_write;
+			} else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				rv = 0;
+			} else {
+				AG_SetErrorS(strerror(errno));
+				goto fail;
+			}
+		}
+		if ((AG_Size)rv == total)
+			return (0);
+	}
+
+	/* Queue the output not yet sent. */
+	if (conn->outLen + (total - rv) > WEB_HTTP_OUTQ_MAX) {
+		AG_SetError("Output queue full (max %d)", WEB_HTTP_OUTQ_MAX);
+		goto fail;
+	}
+	if (conn->outOffs + conn->outLen + (total - rv) > conn->outSize) {
+		if (conn->outOffs > 0) {
+			memmove(conn->out, &conn->out[conn->outOffs],
+			    conn->outLen);
+			conn->outOffs = 0;
+		}
+		if (conn->outLen + (total - rv) > conn->outSize) {
+			sizeNew = conn->outLen + (total - rv) + WEB_DATA_BUFSIZE;
+			if ((outNew = TryRealloc(conn->out, sizeNew)) == NULL) {
+				goto fail;
+			}
+			conn->out = outNew;
+			conn->outSize = sizeNew;
+		}
+	}
+	for (i = 0, skip = (AG_Size)rv; i < iovcnt; i++) {
+		if (skip >= iov[i].iov_len) {
+			skip -= iov[i].iov_len;
+			continue;
+		}
+		len = iov[i].iov_len - skip;
+		memcpy(&conn->out[conn->outOffs + conn->outLen],
+		    (char *)iov[i].iov_base + skip, len);
+		conn->outLen += len;
+		skip = 0;
+	}
+	return (0);
+fail:
+	conn->flags |= WEB_CONNECTION_ERROR;
+	return (-1);
+}
+
+static __inline__ int
+ClientWrite(int fd, const void *_Nonnull data, AG_Size len)
+{
+	struct iovec iov;
+
+	iov.iov_base = (void *)data;
+	iov.iov_len = len;
+	return ClientWritev(fd, &iov, 1);
+}
+
+/* Write HTTP response headers and the given entity-body to a client. */
+static int
+ClientWriteResponse(WEB_Query *_Nonnull q, const void *_Nullable data,
+    AG_Size len)
+{
+	struct iovec iov[2];
+
+	q->head[q->headLen  ] = '\r';
+	q->head[q->headLen+1] = '\n';
+	q->head[q->headLen+2] = '\0';
+
+	iov[0].iov_base = q->head;
+	iov[0].iov_len = q->headLen+2;
+	iov[1].iov_base = (void *)data;
+	iov[1].iov_len = (data != NULL) ? len : 0;
+	return ClientWritev(q->sock, iov, 2);
+}
+
 #ifdef HAVE_ZLIB
 static void
 WEB_FlushQuery_DEFLATE(WEB_Query *_Nonnull q)
@@ -1182,7 +1330,7 @@ WEB_FlushQuery_DEFLATE(WEB_Query *_Nonnull q)
 	 */
 	if (q->method != WEB_METHOD_HEAD) {
 		WEB_SetHeaderS(q, "Transfer-Encoding", "chunked");
-		WEB_WriteHeaders(q->sock, q);
+		ClientWriteResponse(q, NULL, 0);
 	}
 	strm.zalloc = Z_NULL;
 	strm.zfree = Z_NULL;
@@ -1234,8 +1382,8 @@ WEB_FlushQuery_DEFLATE(WEB_Query *_Nonnull q)
 				vec[0].iov_len =  chunkHeadLen;
 				vec[1].iov_base = out;
 				vec[1].iov_len =  nGzipped+2;
-				if (writev(q->sock, vec, 2) == -1)
-					WEB_LogErr("Deflate writev: %s", strerror(errno));
+				if (ClientWritev(q->sock, vec, 2) == -1)
+					WEB_LogErr("Deflate writev: %s", AG_GetError());
 			}
 			nWrote += nGzipped+2;
 		} while (strm.avail_out == 0);
@@ -1249,10 +1397,10 @@ WEB_FlushQuery_DEFLATE(WEB_Query *_Nonnull q)
 	    ((float)q->dataLen/(float)nWrote)*100.0f);
 
 	if (q->method != WEB_METHOD_HEAD) {
-		WEB_SYS_Write(q->sock, "0\r\n\r\n",5);
+		ClientWrite(q->sock, "0\r\n\r\n",5);
 	} else {
 		WEB_SetHeader(q, "Content-Length", "%lu", nWrote);
-		WEB_WriteHeaders(q->sock, q);
+		ClientWriteResponse(q, NULL, 0);
 	}
 }
 #endif /* HAVE_ZLIB */
@@ -1279,17 +1427,16 @@ WEB_FlushQuery_RANGE(WEB_Query *_Nonnull q)
 	WEB_SetHeader(q, "Content-Length", "%u", rangeLen);
 
 	/* Write HTTP headers and partial content. */
-	WEB_WriteHeaders(q->sock, q);
-	if (q->method != WEB_METHOD_HEAD)
-		WEB_SYS_Write(q->sock, &q->data[q->rangeFrom], rangeLen);
+	ClientWriteResponse(q,
+	    (q->method != WEB_METHOD_HEAD) ? &q->data[q->rangeFrom] : NULL,
+	    rangeLen);
 
 	return;
 fail_416:
 	WEB_SetCode(q, "416 Range Not Satisfiable");
 	WEB_SetHeaderS(q, "Content-Language", "en");
 	WEB_OutputError(q, "Requested range is not satisfiable");
-	WEB_WriteHeaders(q->sock, q);
-	WEB_SYS_Write(q->sock, q->data, q->dataLen);
+	ClientWriteResponse(q, q->data, q->dataLen);
 }
 
 static __inline__ void
@@ -1321,12 +1468,10 @@ WEB_FlushQuery(WEB_Query *q)
 /*		WEB_LogDebug("FlushQuery_PLAIN(head=%u, data=%lu)",
 		    q->headLen, q->dataLen); */
 
-		if (q->dataLen > 0) {
-			WEB_SetHeader(q, "Content-Length", "%lu", q->dataLen);
-		}
-		WEB_WriteHeaders(q->sock, q);
-		if (q->method != WEB_METHOD_HEAD)
-			WEB_SYS_Write(q->sock, q->data, q->dataLen);
+		WEB_SetHeader(q, "Content-Length", "%lu", (Ulong)q->dataLen);
+		ClientWriteResponse(q,
+		    (q->method != WEB_METHOD_HEAD) ? q->data : NULL,
+		    q->dataLen);
 	}
 	WEB_ClearQuery(q);
 }
@@ -2009,6 +2154,8 @@ WEB_QueryDestroy(WEB_Query *q)
 		free(arg);
 	}
 	Free(q->data);
+
+	WEB_VAR_ClearQuery();			/* Release query variables */
 }
 
 /* Serialize WEB_Query data (+ 32-bit data offset) to fd. */
@@ -2170,6 +2317,63 @@ fail:
 	return (-1);
 }
 
+/* Close an HTTP client connection (in Frontend). */
+static void
+CloseConnection(WEB_Connection *_Nonnull conn)
+{
+#ifdef HAVE_EPOLL
+	/* The socket may be shared with a Worker forked in the meantime. */
+	epoll_ctl(webPollFd, EPOLL_CTL_DEL, conn->fd, NULL);
+#endif
+	close(conn->fd);
+	TAILQ_REMOVE(&webConns, conn, conns);
+	webConnCount--;
+	if (conn->flags & WEB_CONNECTION_PENDING) {
+		TAILQ_REMOVE(&webPendingConns, conn, pending);
+		webPendingCount--;
+	}
+	free(conn->buf);
+	free(conn->out);
+	free(conn);
+}
+
+/*
+ * Close all HTTP client connections and listening sockets. Called on exit
+ * and in newly forked Workers (so they do not hold connections open).
+ */
+static void
+CloseFrontConnections(void)
+{
+	WEB_Connection *conn, *connNext;
+	Uint i;
+
+#ifdef HAVE_EPOLL
+	if (webPollFd != -1) {
+		close(webPollFd);
+		webPollFd = -1;
+	}
+#endif
+	for (conn = TAILQ_FIRST(&webConns);
+	     conn != TAILQ_END(&webConns);
+	     conn = connNext) {
+		connNext = TAILQ_NEXT(conn, conns);
+		close(conn->fd);
+		free(conn->buf);
+		free(conn->out);
+		free(conn);
+	}
+	TAILQ_INIT(&webConns);
+	webCurConn = NULL;
+	webConnCount = 0;
+	TAILQ_INIT(&webPendingConns);
+	webPendingCount = 0;
+
+	for (i = 0; i < webHttpSockCount; i++) {
+		close(webHttpSocks[i]);
+	}
+	webHttpSockCount = 0;
+}
+
 static void SigPIPE(int sigraised) { pipeFlag++; }
 static void SigCHLD(int sigraised) { chldFlag++; }
 static void SigTERM(int sigraised) { termFlag++; }
@@ -2250,14 +2454,18 @@ WEB_Init(Uint clusterID, int eventSource)
 	Strlcat(webLogFile, ".log", sizeof(webLogFile));
 
 	webFrontSocketCount = 0;
+	webHttpSockCount = 0;
+	webConnCount = 0;
+	webPendingCount = 0;
 	webCtrlSock = -1;
 	webQueryCount = 0;
 	webClusterID = clusterID;
 	webPeerAddress[0] = '\0';
 	webEventSource = eventSource;
 	
-	TAILQ_INIT(&webVars);
 	TAILQ_INIT(&webWorkSockets);
+	TAILQ_INIT(&webConns);
+	TAILQ_INIT(&webPendingConns);
 	SetGlobalS("_progname", agProgName);
 	SetGlobal("WEB_USERNAME_MAX", "%d", WEB_USERNAME_MAX);
 	SetGlobal("WEB_PASSWORD_MAX", "%d", WEB_PASSWORD_MAX);
@@ -2298,19 +2506,15 @@ WEB_Init(Uint clusterID, int eventSource)
 void
 WEB_Destroy(void)
 {
-	VAR *V, *Vnext;
 	WEB_SessionSocket *sock, *sockNext;
 	
 	if (webDestroyFn != NULL)
 		webDestroyFn();
 
-	for (V = TAILQ_FIRST(&webVars);
-	     V != TAILQ_END(&webVars);
-	     V = Vnext) {
-		Vnext = TAILQ_NEXT(V, vars);
-		Free(V->value);
-		Free(V);
-	}
+	WEB_VAR_ClearTemplates();
+	WEB_VAR_Destroy();
+	CloseFrontConnections();
+
 	for (sock = TAILQ_FIRST(&webWorkSockets);
 	     sock != TAILQ_END(&webWorkSockets);
 	     sock = sockNext) {
@@ -2556,68 +2760,34 @@ MessageToHTML(char *_Nonnull h, AG_Size hLen, const char *_Nonnull msg)
 	*d = '\0';
 }
 
-/* Find the named HTML document and copy its absolute path into dst. */
-static int
-FindDoc(WEB_Query *_Nonnull q, const char *_Nonnull name,
-    char *_Nonnull dst, AG_Size dst_len, AG_Offset *_Nonnull docLen)
+/* Copy the path of the named HTML document in the given language into dst. */
+static void
+DocPath(const char *_Nonnull name, const char *_Nonnull lang,
+    char *_Nonnull dst, AG_Size dst_len)
 {
-	char path[FILENAME_MAX];
-	struct stat sb;
-
-	Strlcpy(path, "html/", sizeof(path)); 
-	Strlcat(path, name, sizeof(path)); 
-	if (stat(path, &sb) == 0 &&
-	    Strlcpy(dst, path, dst_len) < dst_len) {
-		*docLen = sb.st_size;
-		return (0);
-	}
-	AG_SetError("Document not found: %s", name);
-	return (-1);
+	Strlcpy(dst, "html/", dst_len);
+	Strlcat(dst, name, dst_len);
+	Strlcat(dst, ".html.", dst_len);
+	Strlcat(dst, lang, dst_len);
 }
 
 /*
  * Write an HTML document to the query output, appling the chain of
  * input filters which are registered for the `text/html' content-type.
- *
- * TODO: Implement a small memory cache
+ * Compiled documents are cached (see WEB_VAR_OutputTemplate()).
  */
 int
 WEB_OutputHTML(WEB_Query *q, const char *name)
 {
-	char file[FILENAME_MAX];
 	char path[FILENAME_MAX];
-	AG_DataSource *ds;
-	char *data;
-	AG_Offset len;
-
-	/* XXX inefficient */
-	/* TODO: memory cache */
-	Strlcpy(file, name, sizeof(file));
-	Strlcat(file, ".html.", sizeof(file));
-	Strlcat(file, q->lang, sizeof(file));
-	if (FindDoc(q, file, path,sizeof(path), &len) == -1) {
-		Strlcpy(file, name, sizeof(file));
-		Strlcat(file, ".html.en", sizeof(file));
-		if (FindDoc(q, file, path,sizeof(path), &len) == -1)
-			goto fail;
-	}
-	if ((ds = AG_OpenFile(path, "r")) == NULL) {
-		goto fail;
-	}
-	if ((data = TryMalloc(len)) == NULL) {
-		AG_CloseFile(ds);
-		goto fail;
-	}
-	if (AG_Read(ds, data, len) == -1) {
-		AG_CloseFile(ds);
-		free(data);
-		goto fail;
-	}
-	AG_CloseFile(ds);
 
 	/* Perform variable substitution and translation. Write to q->data. */
-	WEB_VAR_FilterDocument(q, data, len);
-	free(data);
+	DocPath(name, q->lang, path, sizeof(path));
+	if (WEB_VAR_OutputTemplate(q, path, 0) == -1) {
+		DocPath(name, "en", path, sizeof(path));
+		if (WEB_VAR_OutputTemplate(q, path, 0) == -1)
+			goto fail;
+	}
 	return (0);
 fail:
 	WEB_LogErr("WEB_OutputHTML: %s", AG_GetError());
@@ -2630,47 +2800,22 @@ fail:
 int
 WEB_PutJSON_HTML(WEB_Query *q, const char *key, const char *name)
 {
-	char file[FILENAME_MAX];
 	char path[FILENAME_MAX];
-	AG_DataSource *ds;
-	char *data;
-	AG_Offset len;
 
 	WEB_PutC(q, '"');
 	WEB_PutS(q, key);
 	WEB_PutS(q, "\": \"");
-	
-	/* XXX inefficient */
 
-	Strlcpy(file, name, sizeof(file));
-	Strlcat(file, ".html.", sizeof(file));
-	Strlcat(file, q->lang, sizeof(file));
-	if (FindDoc(q, file, path,sizeof(path), &len) == -1) {
-		Strlcpy(file, name, sizeof(file));
-		Strlcat(file, ".html.en", sizeof(file));
-		if (FindDoc(q, file, path,sizeof(path), &len) == -1)
-			goto fail_open;
-	}
-	
-	if ((ds = AG_OpenFile(path, "r")) == NULL) {
-		goto fail_open;
-	}
-	if ((data = TryMalloc(len)) == NULL ||
-	    AG_Read(ds, data, len) == -1) {
-		goto fail;
-	}
-	AG_CloseFile(ds);
-	
 	/* Perform variable substitution and translation. */
-	WEB_VAR_FilterFragment(q, data, len);
-
-	free(data);
+	DocPath(name, q->lang, path, sizeof(path));
+	if (WEB_VAR_OutputTemplate(q, path, WEB_TEMPLATE_FRAGMENT) == -1) {
+		DocPath(name, "en", path, sizeof(path));
+		if (WEB_VAR_OutputTemplate(q, path, WEB_TEMPLATE_FRAGMENT) == -1)
+			goto fail;
+	}
 	WEB_PutS(q, "\",");
 	return (0);
 fail:
-	AG_CloseFile(ds);
-	free(data);
-fail_open:
 	WEB_Log(WEB_LOG_CRIT, "WEB_PutJSON_HTML: %s", AG_GetError());
 	WEB_PutS(q, AG_GetError());
 	WEB_PutS(q, "\",");
@@ -2882,8 +3027,7 @@ WEB_PostEventS(const char *match, WEB_EventFilterFn filterFn,
 
 		Strlcpy(sun.sun_path, WEB_PATH_EVENTS, sizeof(sun.sun_path));
 		Strlcat(sun.sun_path, dent->d_name, sizeof(sun.sun_path));
-		sun.sun_len = strlen(sun.sun_path)+1;
-		sunLen = sun.sun_len + sizeof(sun.sun_family);
+		sunLen = SUN_LEN(&sun);
 
 		if ((sock = socket(AF_UNIX, SOCK_STREAM, 0)) == -1) {
 			AG_SetError("socket: %s", strerror(errno));
@@ -3033,11 +3177,12 @@ static int
 WEB_EventListener(WEB_Query *_Nonnull q, const WEB_SessionOps *_Nonnull Sops,
     const char *_Nonnull sessID, const char *_Nonnull username)
 {
-	int evSock, clntSock, status=0;
+	int evSock, clntSock, status=0, flags;
 	struct sockaddr_un sun;
 	Uint nEventsOrig = 0;
 	socklen_t sunLen;
 	struct stat sb;
+	struct timeval tv;
 	WEB_Session *S;
 	int try;
 		
@@ -3057,8 +3202,7 @@ WEB_EventListener(WEB_Query *_Nonnull q, const WEB_SessionOps *_Nonnull Sops,
 	Strlcat(sun.sun_path, username, sizeof(sun.sun_path));
 	Strlcat(sun.sun_path, ":", sizeof(sun.sun_path));
 	Strlcat(sun.sun_path, q->lang, sizeof(sun.sun_path));
-	sun.sun_len = strlen(sun.sun_path)+1;
-	sunLen = sun.sun_len + sizeof(sun.sun_family);
+	sunLen = SUN_LEN(&sun);
 
 	if (stat(sun.sun_path, &sb) == 0) {
 		WEB_BeginFrontQuery(q, "events", Sops);
@@ -3101,6 +3245,16 @@ WEB_EventListener(WEB_Query *_Nonnull q, const WEB_SessionOps *_Nonnull Sops,
 	WEB_SetHeaderS(q, "Connection", "close");
 	q->flags &= ~(WEB_QUERY_KEEPALIVE);
 
+	/*
+	 * The event stream is written synchronously until the connection
+	 * is closed. Make the client socket blocking (with a write timeout).
+	 */
+	if ((flags = fcntl(q->sock, F_GETFL)) != -1)
+		fcntl(q->sock, F_SETFL, flags & ~(O_NONBLOCK));
+	tv.tv_sec = WEB_HTTP_REQ_TIMEOUT;
+	tv.tv_usec = 0;
+	setsockopt(q->sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
 	if (WEB_WriteHeaders(q->sock, q) == -1)
 		goto fail;
 	
@@ -3262,7 +3416,7 @@ WEB_EventListener(WEB_Query *_Nonnull q, const WEB_SessionOps *_Nonnull Sops,
 #endif
 try_write:
 			if (writev(q->sock, msgv, iovcnt) == -1) {
-				if (errno == EINTR || errno == EAGAIN) {
+				if (errno == EINTR) {
 					WEB_CheckSignals();
 					goto try_write;
 				}
@@ -3303,7 +3457,7 @@ try_write:
 #endif
 try_ping:
 			if (writev(q->sock, msgv, iovcnt) == -1) {
-				if (errno == EINTR || errno == EAGAIN) {
+				if (errno == EINTR) {
 					WEB_CheckSignals();
 					goto try_ping;
 				}
@@ -3412,6 +3566,7 @@ CreateWorker(const WEB_SessionOps *_Nonnull Sops,
 		close(pp[1]);
 		return (-1);
 	} else if (pidNew == 0) {				/* In worker */
+		CloseFrontConnections();
 		if (WEB_WorkerMain(Sops, q, user, pass, sessID, pp,
 		    nRestoreAttempts) != 0) {
 			WEB_LogErr("Worker(%d) Failed: %s", getpid(),
@@ -3527,7 +3682,7 @@ WEB_ProcessQuery(WEB_Query *q, const WEB_SessionOps *Sops, void *rdBuf,
 	struct sockaddr_un sun;
 	socklen_t sunLen;
 	const char *op, *sessArg;
-	int nRestoreAttempts=0, detChunked;
+	int nRestoreAttempts=0, detChunked, keepAlive;
 	AG_Size headLen, nRead, nWrote, detContentLen;
 	WEB_SessionSocket *sock;
 	ssize_t rv;
@@ -3562,8 +3717,9 @@ WEB_ProcessQuery(WEB_Query *q, const WEB_SessionOps *Sops, void *rdBuf,
 			}
 			WEB_SetHeaderS(q, "Content-Language", q->lang);
 			cp->fn(q);
+			keepAlive = WEB_KeepAlive(q);
 			WEB_FlushQuery(q);
-			return WEB_KeepAlive(q);
+			return (keepAlive);
 		} else {                                /* Public module cmd? */
 			WEB_Module *mod = NULL;
 			WEB_ModuleClass *Cmod = NULL;
@@ -3586,8 +3742,9 @@ WEB_ProcessQuery(WEB_Query *q, const WEB_SessionOps *Sops, void *rdBuf,
 						WEB_BeginFrontQuery(q, op, Sops);
 						q->mod = mod;
 						WEB_CommandExec(q, op, cmd);
+						keepAlive = WEB_KeepAlive(q);
 						WEB_FlushQuery(q);
-						return WEB_KeepAlive(q);
+						return (keepAlive);
 					}
 				}
 			}
@@ -3659,8 +3816,7 @@ try_connect:
 		Strlcpy(sun.sun_path, WEB_PATH_SOCKETS, sizeof(sun.sun_path));
 		Strlcat(sun.sun_path, sessID, sizeof(sun.sun_path));
 		Strlcat(sun.sun_path, ".sock", sizeof(sun.sun_path));
-		sun.sun_len = strlen(sun.sun_path)+1;
-		sunLen = sun.sun_len + sizeof(sun.sun_family);
+		sunLen = SUN_LEN(&sun);
 		if (connect(sock->fd, (struct sockaddr *)&sun, sunLen) == -1) {
 			if (errno == EINTR || errno == EAGAIN) {
 				WEB_CheckSignals();
@@ -3753,47 +3909,28 @@ try_connect:
 	}
 
 	/*
-	 * If the Frontend isn't done reading all data from the request,
-	 * forward the rest of it to the Worker as-is.
+	 * If the request body has not been consumed by the Frontend, forward
+	 * it to the Worker as-is (the complete body is buffered in rdBuf).
 	 */
 	if (q->contentLength > 0 && !(q->flags & WEB_QUERY_CONTENT_READ)) {
-		WEB_LogDebug("Feed worker %lu bytes of %s data (got %lu)",
-		    (Ulong)q->contentLength, q->contentType, (Ulong)rdBufLen);
+		WEB_LogDebug("Feed worker %lu bytes of %s data",
+		    (Ulong)q->contentLength, q->contentType);
 
-		if (rdBufLen > 0 && WEB_SYS_Write(sock->fd, rdBuf, rdBufLen) == -1) {
+		if (rdBufLen < q->contentLength) {
+			AG_SetError("Forward: Short body (%lu < %lu)",
+			    (Ulong)rdBufLen, (Ulong)q->contentLength);
+			goto fail_data;
+		}
+		if (WEB_SYS_Write(sock->fd, rdBuf, q->contentLength) == -1) {
 			WEB_LogErr("Write to worker: %s", AG_GetError());
 			goto fail_data;
 		}
 #ifdef WEB_DEBUG_REQUESTS
 		FILE *dbgOut;
-		if ((dbgOut = fopen("debug-request.txt", "w")))
-			fwrite(rdBuf, 1, rdBufLen, dbgOut);
-#endif
-		for (nRead = rdBufLen;
-		     nRead < q->contentLength;
-		     ) {
-			rv = read(q->sock, buf,
-			    MIN(sizeof(buf), (q->contentLength-nRead)));
-			if (rv == -1) {
-				if (errno == EINTR || errno == EAGAIN) {
-					WEB_CheckSignals();
-					continue;
-				} else {
-					AG_SetError("Forward: %s", strerror(errno));
-					goto fail_data;
-				}
-			}
-			nRead += rv;
-			if (WEB_SYS_Write(sock->fd, buf, rv) == -1) {
-				WEB_LogErr("Write to worker: %s", AG_GetError());
-				goto fail_data;
-			}
-#ifdef WEB_DEBUG_REQUESTS
-			if (dbgOut) { fwrite(buf, 1, rv, dbgOut); }
-#endif
+		if ((dbgOut = fopen("debug-request.txt", "w"))) {
+			fwrite(rdBuf, 1, q->contentLength, dbgOut);
+			fclose(dbgOut);
 		}
-#ifdef WEB_DEBUG_REQUESTS
-		fclose(dbgOut);
 #endif
 	}
 
@@ -3850,7 +3987,8 @@ read_resp_head:
 	headLen = (&cHeadEnd[4] - head);
 
 	/* Write the unmodified HTTP headers back to Client. */
-	WEB_SYS_Write(q->sock, head, headLen);
+	if (ClientWrite(q->sock, head, headLen) == -1)
+		goto fail_client;
 
 	/* Scan for a Transfer-Encoding or Content-Length */
 	*cHeadEnd = '\0';
@@ -3915,9 +4053,8 @@ read_resp_head:
 			    nChunk, chunkHead, chunk, nRead);
 #endif
 			/* Write Chunk Header */
-			if (WEB_SYS_Write(q->sock, buf, nRead) == -1) {
-				WEB_LogErr("Client Flush: %s", AG_GetError());
-			}
+			if (ClientWrite(q->sock, buf, nRead) == -1)
+				goto fail_client;
 #ifdef WEB_DEBUG_TRANSFER
 			fwrite(buf, 1, nRead, dbgOut);
 			fflush(dbgOut);
@@ -3937,10 +4074,8 @@ read_resp_head:
 					}
 					nRead += rv;
 				}
-				if (WEB_SYS_Write(q->sock, buf, nRead) == -1) {
-					WEB_LogErr("Chunk #%u write: %s", nChunk,
-					    AG_GetError());
-				}
+				if (ClientWrite(q->sock, buf, nRead) == -1)
+					goto fail_client;
 				nWrote += nRead;
 #ifdef WEB_DEBUG_TRANSFER
 				fwrite(buf, 1, nRead, dbgOut);
@@ -3971,9 +4106,8 @@ read_resp_head:
 				}
 				nRead += rv;
 			}
-			if (WEB_SYS_Write(q->sock, buf, nRead) == -1) {
-				WEB_LogErr("Content-Len Write: %s", AG_GetError());
-			}
+			if (ClientWrite(q->sock, buf, nRead) == -1)
+				goto fail_client;
 			nWrote += nRead;
 			nRead = 0;
 		}
@@ -3989,15 +4123,17 @@ fail_auth:
 	WEB_BeginFrontQuery(q, "login", Sops);
 	WEB_SetErrorS(AG_GetError());
 	Sops->loginPage(q);
+	keepAlive = WEB_KeepAlive(q);
 	WEB_FlushQuery(q);
 	if (sock) { CloseWorkSocket(sock); }
-	return WEB_KeepAlive(q);
+	return (keepAlive);
 show_auth:
 	WEB_BeginFrontQuery(q, "login", Sops);
 	Sops->loginPage(q);
+	keepAlive = WEB_KeepAlive(q);
 	WEB_FlushQuery(q);
 	if (sock) { CloseWorkSocket(sock); }
-	return WEB_KeepAlive(q);
+	return (keepAlive);
 logout:
 	WEB_BeginFrontQuery(q, "logout", Sops);
 	WEB_SetHeaderS(q, "Connection", "close");
@@ -4018,9 +4154,19 @@ fail_data:
 	WEB_PutS(q, "{\"code\": -1,");
 	WEB_PutJSON_NoHTML_S(q, "error", AG_GetError());
 	WEB_PutS(q, "\"backend_version\": \"" VERSION "\"}\r\n");
+	keepAlive = WEB_KeepAlive(q);
 	WEB_FlushQuery(q);
 	if (sock) { CloseWorkSocket(sock); }
-	return WEB_KeepAlive(q);
+	return (keepAlive);
+fail_client:
+	/*
+	 * The client cannot receive the response. Stop relaying and discard
+	 * the rest of the Worker response along with the Worker socket.
+	 */
+	WEB_LogErr("Client %s: %s", webPeerAddress, AG_GetError());
+	CloseWorkSocket(sock);
+	q->flags &= ~(WEB_QUERY_KEEPALIVE);
+	return (0);				/* Force connection close */
 }
 
 static __inline__ void
@@ -4217,8 +4363,7 @@ regen_id:
 	Strlcpy(sun.sun_path, WEB_PATH_SOCKETS, sizeof(sun.sun_path));
 	Strlcat(sun.sun_path, S->id, sizeof(sun.sun_path));
 	Strlcat(sun.sun_path, ".sock", sizeof(sun.sun_path));
-	sun.sun_len = strlen(sun.sun_path)+1;
-	sunLen = sun.sun_len + sizeof(sun.sun_family);
+	sunLen = SUN_LEN(&sun);
 	if (bind(sockUn, (struct sockaddr *)&sun, sunLen) == -1) {
 		AG_SetError("bind(%s): %s", sun.sun_path, strerror(errno));
 		goto fail_close;
@@ -4461,8 +4606,7 @@ WEB_ControlCommand(Uint clusterID, const WEB_ControlCmd *cmd)
 	}
 try_connect:
 	sun.sun_family = AF_UNIX;
-	sun.sun_len = strlen(sun.sun_path)+1;
-	sunLen = sun.sun_len + sizeof(sun.sun_family);
+	sunLen = SUN_LEN(&sun);
 	if (connect(fd, (struct sockaddr *)&sun, sunLen) == -1) {
 		if (errno == EINTR || errno == EAGAIN) {
 			WEB_CheckSignals();
@@ -4524,21 +4668,539 @@ WEB_AddLanguage(const char *_Nonnull lang)
 	webLangs[++webLangCount] = NULL;
 }
 
-/* Standard loop for a web application server. */
+/*
+ * Check whether a client connection has buffered a complete request. If so,
+ * return 1 along with the header length (up to the blank line) and the body
+ * length. Return 0 if more input is needed (once the header is complete,
+ * with headerLen and bodyLen set so the buffer can be sized to fit the body),
+ * or -1 if the request is bad.
+ *
+ * Since the request boundaries must agree with those seen by any proxy in
+ * front of us, Transfer-Encoding and multiple or malformed Content-Length
+ * headers are rejected.
+ */
+static int
+ParseRequest(const WEB_Connection *_Nonnull conn, AG_Size *_Nonnull headerLen,
+    AG_Size *_Nonnull bodyLen)
+{
+	const char *buf = conn->buf, *hEnd, *c, *ep;
+	int haveLength = 0;
+	long lv;
+
+	*headerLen = 0;
+	*bodyLen = 0;
+
+	if ((hEnd = memmem(buf, conn->len, "\r\n\r\n", 4)) == NULL) {
+		if (conn->len >= WEB_HTTP_HEADER_MAX) {
+			goto too_large;
+		}
+		return (0);
+	}
+	if ((AG_Size)(hEnd - buf) >= WEB_HTTP_HEADER_MAX) {
+		goto too_large;
+	}
+
+	for (c = memchr(buf, '\n', (AG_Size)(hEnd - buf));
+	     c != NULL;
+	     c = memchr(c, '\n', (AG_Size)(hEnd - c))) {
+		if (strncasecmp(++c, "Transfer-Encoding:", 18) == 0) {
+			AG_SetErrorS("Transfer-Encoding not supported");
+			return (-1);
+		}
+		if (strncasecmp(c, "Content-Length:", 15) != 0) {
+			continue;
+		}
+		if (haveLength++) {
+			AG_SetErrorS("Multiple Content-Length");
+			return (-1);
+		}
+		c += 15;
+		while (*c == ' ' || *c == '\t') {
+			c++;
+		}
+		errno = 0;
+		lv = strtol(c, (char **)&ep, 10);
+		if (!isdigit((unsigned char)*c) || errno == ERANGE) {
+			goto bad_length;
+		}
+		while (*ep == ' ' || *ep == '\t') {
+			ep++;
+		}
+		if (*ep != '\r') {
+			goto bad_length;
+		}
+		if (lv > WEB_HTTP_BODY_MAX) {
+			AG_SetError("Request body too large (max %d)",
+			    WEB_HTTP_BODY_MAX);
+			return (-1);
+		}
+		*bodyLen = (AG_Size)lv;
+	}
+	*headerLen = (AG_Size)(hEnd - buf);
+	return (conn->len - (*headerLen + 4) >= *bodyLen) ? 1 : 0;
+bad_length:
+	AG_SetErrorS("Bad Content-Length");
+	return (-1);
+too_large:
+	AG_SetError("HTTP header too large (max %d)", WEB_HTTP_HEADER_MAX);
+	return (-1);
+}
+
+/*
+ * Parse the request-line of a complete HTTP request and invoke the method
+ * handler. Return 1 (keep connection alive) or 0 (close).
+ */
+static int
+DispatchRequest(int sock, char *_Nonnull header, AG_Size headerLen,
+    char *_Nonnull rdBuf, AG_Size rdBufLen, const WEB_SessionOps *_Nonnull Sops)
+{
+	char uri[MAXPATHLEN];
+	char *cEnd, *uriEnd = NULL;
+	WEB_Method meth;
+
+	if (headerLen < WEB_HTTP_HEADER_MIN) {
+		return (0);
+	}
+	if ((cEnd = strchr(header,' ')) == NULL) {
+		WEB_LogErr("Bad method");
+		return (0);
+	}
+	*cEnd = '\0';
+	uri[0] = '/';
+	uri[1] = '\0';
+
+	for (meth=0; meth < WEB_METHOD_LAST; meth++) {
+		AG_Size nameLen;
+
+		if (strcmp(header, webMethods[meth].name) != 0) {
+			continue;
+		}
+		nameLen = strlen(webMethods[meth].name);
+		if ((uriEnd = strchr(&header[nameLen+1],'\r')) == NULL) {
+			WEB_LogErr("Bad request");
+			return (0);
+		}
+		*uriEnd = '\0';
+		Strlcpy(uri, &header[nameLen+1], sizeof(uri));
+		if ((cEnd = strrchr(uri,' ')) == NULL ||
+		    strcasecmp(cEnd, " HTTP/1.1") != 0) {
+			WEB_LogErr("Bad protocol");
+			return (0);
+		}
+		*cEnd = '\0';
+		uriEnd += 2;			/* \r\n */
+		if (uri[0] == '\0') {
+			WEB_LogErr("Bad request");
+			return (0);
+		}
+		break;
+	}
+	if (meth == WEB_METHOD_LAST) {
+		return WEB_MethodNotAllowed(sock, uri, header, rdBuf, rdBufLen,
+		    Sops);
+	}
+	return webMethods[meth].fn(sock, uri, uriEnd, rdBuf, rdBufLen, Sops);
+}
+
+/* Restart the request/keep-alive timer of a client connection. */
+static __inline__ void
+RestartTimer(WEB_Connection *_Nonnull conn)
+{
+	conn->expire = time(NULL) + WEB_HTTP_REQ_TIMEOUT;
+	TAILQ_REMOVE(&webConns, conn, conns);
+	TAILQ_INSERT_TAIL(&webConns, conn, conns);
+}
+
+/*
+ * Resize the input buffer of a client connection (to fit a request body
+ * larger than the default buffer, or back to the default size).
+ */
+static int
+ResizeInput(WEB_Connection *_Nonnull conn, AG_Size size)
+{
+	char *bufNew;
+
+	if ((bufNew = TryRealloc(conn->buf, size)) == NULL) {
+		return (-1);
+	}
+	conn->buf = bufNew;
+	conn->bufSize = size;
+	return (0);
+}
+
+/*
+ * Send the output queued for a client connection. Return 1 if the queue
+ * has been drained, 0 if output remains queued, or -1 on failure.
+ */
+static int
+FlushConnection(WEB_Connection *_Nonnull conn)
+{
+	ssize_t rv;
+
+	while (conn->outLen > 0) {
+		rv = send(conn->fd, &conn->out[conn->outOffs], conn->outLen, 0);
+		if (rv == -1) {
+			if (errno == EINTR) {
+				WEB_CheckSignals();
+				continue;
+			}
+			if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				return (0);
+			}
+			if (errno != EPIPE && errno != ECONNRESET) {
+				WEB_LogErr("%s: %s", conn->peer, strerror(errno));
+			}
+			return (-1);
+		}
+		conn->outOffs += rv;
+		conn->outLen -= rv;
+		RestartTimer(conn);			/* Client is reading */
+	}
+	free(conn->out);
+	conn->out = NULL;
+	conn->outOffs = 0;
+	conn->outSize = 0;
+	return (1);
+}
+
+/*
+ * Wait for the output of a client connection to drain before reading any
+ * more of its input (or to resume reading its input).
+ */
+static void
+BlockConnection(WEB_Connection *_Nonnull conn, int enable)
+{
+#ifdef HAVE_EPOLL
+	struct epoll_event ev;
+
+	ev.events = enable ? EPOLLOUT : EPOLLIN;
+	ev.data.ptr = conn;
+	if (epoll_ctl(webPollFd, EPOLL_CTL_MOD, conn->fd, &ev) == -1) {
+		WEB_LogErr("epoll_ctl: %s", strerror(errno));
+	}
+#endif
+	if (enable) {
+		conn->flags |= WEB_CONNECTION_BLOCKED;
+	} else {
+		conn->flags &= ~(WEB_CONNECTION_BLOCKED);
+	}
+}
+
+/*
+ * Process the complete requests buffered for a client connection, in order
+ * (pipelined requests are processed back to back). To be fair to other
+ * connections, stop after WEB_HTTP_PIPELINE_MAX requests and leave the rest
+ * for the next poll cycle. If a response could not be sent in full, stop and
+ * wait for the queued output to drain.
+ * Return 0 if the connection remains open, or -1 if it has been closed.
+ */
+static int
+ProcessRequests(WEB_Connection *_Nonnull conn,
+    const WEB_SessionOps *_Nonnull Sops)
+{
+	static const char badRequest[] = "HTTP/1.1 400 Bad Request\r\n"
+	                                 "Connection: close\r\n"
+	                                 "Content-Length: 0\r\n\r\n";
+	AG_Size headerLen, bodyLen, reqLen;
+	Uint nReqs;
+	int rv;
+	char cSave;
+
+	if (conn->flags & WEB_CONNECTION_PENDING) {
+		TAILQ_REMOVE(&webPendingConns, conn, pending);
+		webPendingCount--;
+		conn->flags &= ~(WEB_CONNECTION_PENDING);
+	}
+	for (nReqs = 0; conn->len > 0; nReqs++) {
+		if (nReqs == WEB_HTTP_PIPELINE_MAX) {
+			TAILQ_INSERT_TAIL(&webPendingConns, conn, pending);
+			webPendingCount++;
+			conn->flags |= WEB_CONNECTION_PENDING;
+			return (0);
+		}
+		switch (ParseRequest(conn, &headerLen, &bodyLen)) {
+		case 0:					/* Need more input */
+			reqLen = headerLen + 4 + bodyLen + 1;
+			if (headerLen > 0 && reqLen > conn->bufSize &&
+			    ResizeInput(conn, reqLen) == -1) {
+				WEB_LogErr("%s: %s", conn->peer, AG_GetError());
+				goto close;
+			}
+			return (0);
+		case -1:
+			WEB_LogErr("%s: %s", conn->peer, AG_GetError());
+			(void)send(conn->fd, badRequest, sizeof(badRequest)-1,
+			    MSG_DONTWAIT);
+			goto close;
+		}
+		reqLen = headerLen + 4 + bodyLen;
+
+		/*
+		 * Process the request in place. Handlers may NUL-terminate
+		 * the body, so preserve the first byte of the next request.
+		 * Output to the client is written (or queued) by ClientWrite().
+		 */
+		conn->buf[headerLen] = '\0';
+		cSave = conn->buf[reqLen];
+		Strlcpy(webPeerAddress, conn->peer, sizeof(webPeerAddress));
+		webCurConn = conn;
+		rv = DispatchRequest(conn->fd, conn->buf, headerLen,
+		    &conn->buf[headerLen+4], bodyLen, Sops);
+		webCurConn = NULL;
+		conn->buf[reqLen] = cSave;
+		conn->nQueries++;
+		webQueryCount++;
+		WEB_CheckSignals();
+
+		if (conn->flags & WEB_CONNECTION_ERROR) {
+			goto close;
+		}
+		if (rv != 1) {
+			if (conn->outLen > 0) {
+				/* Close once the response has been sent. */
+				conn->flags |= WEB_CONNECTION_CLOSE;
+				BlockConnection(conn, 1);
+				return (0);
+			}
+			goto close;
+		}
+		if ((conn->len -= reqLen) > 0) {
+			memmove(conn->buf, &conn->buf[reqLen], conn->len);
+		}
+		if (conn->bufSize > WEB_CONNECTION_BUFSIZE &&
+		    conn->len < WEB_CONNECTION_BUFSIZE)
+			(void)ResizeInput(conn, WEB_CONNECTION_BUFSIZE);
+
+		RestartTimer(conn);
+
+		if (conn->outLen > 0) {
+			BlockConnection(conn, 1);	/* Client is not reading */
+			return (0);
+		}
+	}
+	return (0);
+close:
+	CloseConnection(conn);
+	return (-1);
+}
+
+/*
+ * Read available input from a client connection and process any complete
+ * requests. Return 0 if the connection remains open, or -1 if it has been
+ * closed.
+ */
+static int
+ReadConnection(WEB_Connection *_Nonnull conn, const WEB_SessionOps *_Nonnull Sops)
+{
+	ssize_t rv;
+
+	if (conn->len + 1 >= conn->bufSize) {		/* Buffer is full */
+		return ProcessRequests(conn, Sops);
+	}
+	rv = recv(conn->fd, &conn->buf[conn->len],
+	    conn->bufSize - conn->len - 1, MSG_DONTWAIT);
+	if (rv == -1) {
+		if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) {
+			WEB_CheckSignals();
+			return (0);
+		}
+		if (errno != ECONNRESET) {
+			WEB_LogErr("HTTP header: %s", strerror(errno));
+		}
+		CloseConnection(conn);
+		return (-1);
+	} else if (rv == 0) {					/* EOF */
+		CloseConnection(conn);
+		return (-1);
+	}
+	conn->len += rv;
+	return ProcessRequests(conn, Sops);
+}
+
+/*
+ * Handle an event on a client connection: either input, or (if we were
+ * waiting for its output to drain) the socket becoming writable.
+ */
+static void
+ServiceConnection(WEB_Connection *_Nonnull conn,
+    const WEB_SessionOps *_Nonnull Sops)
+{
+	if (conn->flags & WEB_CONNECTION_BLOCKED) {
+		switch (FlushConnection(conn)) {
+		case -1:
+			CloseConnection(conn);
+			return;
+		case 0:
+			return;				/* Output remains queued */
+		}
+		if (conn->flags & WEB_CONNECTION_CLOSE) {
+			CloseConnection(conn);
+			return;
+		}
+		BlockConnection(conn, 0);
+		ProcessRequests(conn, Sops);
+	} else {
+		ReadConnection(conn, Sops);
+	}
+}
+
+/*
+ * Resume processing the connections left with buffered requests after
+ * reaching WEB_HTTP_PIPELINE_MAX in the previous poll cycle.
+ */
+static void
+ProcessPendingConnections(const WEB_SessionOps *_Nonnull Sops)
+{
+	WEB_Connection *conn;
+	Uint i, count = webPendingCount;
+
+	for (i = 0; i < count; i++) {
+		if ((conn = TAILQ_FIRST(&webPendingConns)) == NULL) {
+			break;
+		}
+		ProcessRequests(conn, Sops);
+	}
+}
+
+/*
+ * Accept pending connections on a (non-blocking) listening socket. If the
+ * connection limit is reached, close the connection closest to expiring.
+ */
+static void
+AcceptConnections(int httpSock)
+{
+	struct sockaddr_storage paddr;
+	socklen_t paddrLen;
+	WEB_Connection *conn;
+#ifdef HAVE_EPOLL
+	struct epoll_event ev;
+#endif
+	int sock, flags, val;
+
+	for (;;) {
+		paddrLen = sizeof(paddr);
+		sock = accept(httpSock, (struct sockaddr *)&paddr, &paddrLen);
+		if (sock == -1) {
+			if (errno == EINTR) {
+				WEB_CheckSignals();
+				continue;
+			}
+			if (errno != EAGAIN && errno != EWOULDBLOCK &&
+			    errno != ECONNABORTED) {
+				WEB_LogErr("accept: %s", strerror(errno));
+			}
+			return;
+		}
+		/* Client I/O must never block the event loop. */
+		if ((flags = fcntl(sock, F_GETFL)) == -1 ||
+		    fcntl(sock, F_SETFL, flags | O_NONBLOCK) == -1) {
+			WEB_LogErr("fcntl: %s", strerror(errno));
+			close(sock);
+			continue;
+		}
+
+		/*
+		 * Responses are written as separate header and body writes;
+		 * avoid Nagle delays on persistent connections.
+		 */
+		val = 1;
+		setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &val, sizeof(val));
+
+		if (webConnCount >= WEB_MAXHTTPCONNS) {
+			conn = TAILQ_FIRST(&webConns);
+			WEB_LogDebug("Too many connections; closing %s",
+			    conn->peer);
+			CloseConnection(conn);
+		}
+		if ((conn = TryMalloc(sizeof(WEB_Connection))) == NULL) {
+			WEB_LogErr("accept: %s", AG_GetError());
+			close(sock);
+			continue;
+		}
+		if ((conn->buf = TryMalloc(WEB_CONNECTION_BUFSIZE)) == NULL) {
+			WEB_LogErr("accept: %s", AG_GetError());
+			close(sock);
+			free(conn);
+			continue;
+		}
+		conn->fd = sock;
+		conn->nQueries = 0;
+		conn->flags = 0;
+		conn->expire = time(NULL) + WEB_HTTP_REQ_TIMEOUT;
+		conn->len = 0;
+		conn->bufSize = WEB_CONNECTION_BUFSIZE;
+		conn->out = NULL;
+		conn->outOffs = 0;
+		conn->outLen = 0;
+		conn->outSize = 0;
+		if (getnameinfo((struct sockaddr *)&paddr, paddrLen, conn->peer,
+		    sizeof(conn->peer), NULL, 0, NI_NUMERICHOST) != 0)
+			conn->peer[0] = '\0';
+#ifdef HAVE_EPOLL
+		ev.events = EPOLLIN;
+		ev.data.ptr = conn;
+		if (epoll_ctl(webPollFd, EPOLL_CTL_ADD, sock, &ev) == -1) {
+			WEB_LogErr("epoll_ctl: %s", strerror(errno));
+			close(sock);
+			free(conn->buf);
+			free(conn);
+			continue;
+		}
+#endif
+		TAILQ_INSERT_TAIL(&webConns, conn, conns);
+		webConnCount++;
+	}
+}
+
+/*
+ * Close connections which have been idle (or incomplete) for more than
+ * WEB_HTTP_REQ_TIMEOUT. Return the time until the next expiration in
+ * milliseconds (or -1 if there are no open connections).
+ */
+static int
+ExpireConnections(void)
+{
+	WEB_Connection *conn;
+	time_t now = time(NULL);
+
+	while ((conn = TAILQ_FIRST(&webConns)) != NULL) {
+		if (conn->expire > now) {
+			return (int)(conn->expire - now)*1000;
+		}
+		CloseConnection(conn);
+	}
+	return (-1);
+}
+
+/*
+ * Standard loop for a web application server.
+ *
+ * Listening sockets, the control socket and client connections are
+ * multiplexed with epoll(7) (or poll(2) where unavailable). Requests are
+ * parsed incrementally from the input of each connection and dispatched
+ * to the method handlers once complete (including the body). Client
+ * sockets are non-blocking; response output which cannot be sent at once
+ * is queued and sent as the socket becomes writable. Connections are kept
+ * alive (and pipelined requests processed in order) until closed by the
+ * client or idle for WEB_HTTP_REQ_TIMEOUT seconds.
+ */
 void
 WEB_QueryLoop(const char *hostname, const char *port, const WEB_SessionOps *Sops)
 {
 	struct addrinfo hints, *res, *res0;
-	char   httpSocks[WEB_MAXHTTPSOCKETS];
-	Uint  nHttpSocks;
 	const char *cause = "";
 	struct sockaddr_un sun;
 	socklen_t sunLen;
-	fd_set httpSockFDs;
-	int maxFd = 0;
-	int i, rv, val, sock = -1;
-	ssize_t rvLen;
-	char *c, *cEnd, *uriEnd;
+#ifdef HAVE_EPOLL
+	struct epoll_event ev, events[WEB_POLL_EVENTS];
+#else
+	struct pollfd pfds[WEB_MAXHTTPSOCKETS + 1 + WEB_MAXHTTPCONNS];
+	WEB_Connection *pconns[WEB_MAXHTTPCONNS];
+	WEB_Connection *conn;
+	Uint nConns;
+	int j;
+#endif
+	int i, rv, val, timeout, flags;
 	struct stat sb;
 
 	if (webLangCount == 0) {
@@ -4576,9 +5238,8 @@ WEB_QueryLoop(const char *hostname, const char *port, const WEB_SessionOps *Sops
 		WEB_LogErr("%s:%s: %s", hostname, port, gai_strerror(rv));
 		return;
 	}
-	FD_ZERO(&httpSockFDs);
-	for (nHttpSocks=0, res=res0;
-	     res != NULL && nHttpSocks < WEB_MAXHTTPSOCKETS;
+	for (webHttpSockCount=0, res=res0;
+	     res != NULL && webHttpSockCount < WEB_MAXHTTPSOCKETS;
 	     res = res->ai_next) {
 		rv = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
 		if (rv == -1) {
@@ -4592,21 +5253,25 @@ WEB_QueryLoop(const char *hostname, const char *port, const WEB_SessionOps *Sops
 			close(rv);
 			continue;
 		}
-		if (listen(rv, 20) == -1) {
+		if (listen(rv, WEB_HTTP_BACKLOG) == -1) {
 			cause = "listen";
 			close(rv);
 			continue;
 		}
-		httpSocks[nHttpSocks++] = rv;
-		FD_SET(rv, &httpSockFDs);
-		if (rv > maxFd) { maxFd = rv; }
+		if ((flags = fcntl(rv, F_GETFL)) == -1 ||
+		    fcntl(rv, F_SETFL, flags | O_NONBLOCK) == -1) {
+			cause = "fcntl";
+			close(rv);
+			continue;
+		}
+		webHttpSocks[webHttpSockCount++] = rv;
 	}
-	if (nHttpSocks == 0) {
+	freeaddrinfo(res0);
+	if (webHttpSockCount == 0) {
 		AG_SetError("%s: %s", cause, strerror(errno));
 		goto fail;
 	}
-	freeaddrinfo(res0);
-	
+
 	/* Listen on control socket */
 	if ((webCtrlSock = socket(AF_UNIX, SOCK_STREAM, 0)) == -1) {
 		AG_SetError("socket(AF_UNIX): %s", strerror(errno));
@@ -4615,8 +5280,7 @@ WEB_QueryLoop(const char *hostname, const char *port, const WEB_SessionOps *Sops
 	sun.sun_family = AF_UNIX;
 	snprintf(sun.sun_path, sizeof(sun.sun_path), "%s%u.ctrl",
 	    WEB_PATH_SOCKETS, webClusterID);
-	sun.sun_len = strlen(sun.sun_path)+1;
-	sunLen = sun.sun_len + sizeof(sun.sun_family);
+	sunLen = SUN_LEN(&sun);
 	unlink(sun.sun_path);
 	if (bind(webCtrlSock, (struct sockaddr *)&sun, sunLen) == -1) {
 		AG_SetError("bind(%s): %s", sun.sun_path, strerror(errno));
@@ -4628,146 +5292,110 @@ WEB_QueryLoop(const char *hostname, const char *port, const WEB_SessionOps *Sops
 	}
 	chmod(sun.sun_path, 0700);
 
-	for (;;) {
-		char rdBuf[WEB_FRONTEND_RDBUFSIZE]; /* Must > sizeof(header) */
-		char header[WEB_HTTP_HEADER_MAX];
-		char uri[MAXPATHLEN];
-		struct sockaddr paddr;
-		socklen_t paddrLen = sizeof(paddr);
-		AG_Size headerLen, rdBufLen;
-		WEB_Method meth;
-		fd_set readFds = httpSockFDs;
-
-		FD_SET(webCtrlSock, &readFds);
-		if (webCtrlSock > maxFd) { maxFd = webCtrlSock; }
+#ifdef HAVE_EPOLL
+	if ((webPollFd = epoll_create1(EPOLL_CLOEXEC)) == -1) {
+		AG_SetError("epoll_create1: %s", strerror(errno));
+		goto fail;
+	}
+	/* Listening sockets are identified by pointers into webHttpSocks[]. */
+	for (i = 0; i < webHttpSockCount; i++) {
+		ev.events = EPOLLIN;
+		ev.data.ptr = &webHttpSocks[i];
+		if (epoll_ctl(webPollFd, EPOLL_CTL_ADD, webHttpSocks[i], &ev) == -1)
+			goto fail_epoll;
+	}
+	ev.events = EPOLLIN;
+	ev.data.ptr = &webCtrlSock;
+	if (epoll_ctl(webPollFd, EPOLL_CTL_ADD, webCtrlSock, &ev) == -1)
+		goto fail_epoll;
+#endif
 
-		rv = select(maxFd+1, &readFds, NULL, NULL, NULL);
+	for (;;) {
+		timeout = ExpireConnections();
+		if (webPendingCount > 0) {
+			timeout = 0;
+		}
+#ifdef HAVE_EPOLL
+		rv = epoll_wait(webPollFd, events, WEB_POLL_EVENTS, timeout);
+#else
+		for (i = 0; i < webHttpSockCount; i++) {
+			pfds[i].fd = webHttpSocks[i];
+			pfds[i].events = POLLIN;
+		}
+		pfds[i].fd = webCtrlSock;
+		pfds[i].events = POLLIN;
+		nConns = 0;
+		TAILQ_FOREACH(conn, &webConns, conns) {
+			pconns[nConns] = conn;
+			pfds[++i].fd = conn->fd;
+			pfds[i].events = (conn->flags & WEB_CONNECTION_BLOCKED) ?
+			                 POLLOUT : POLLIN;
+			nConns++;
+		}
+		rv = poll(pfds, i+1, timeout);
+#endif
 		if (rv == -1) {
-			if (errno == EINTR || errno == EAGAIN) {
+			if (errno == EINTR) {
 				WEB_CheckSignals();
 				continue;
 			} else {
-				AG_SetError("select: %s", strerror(errno));
+				AG_SetError("poll: %s", strerror(errno));
 				goto fail;
 			}
 		}
-		if (FD_ISSET(webCtrlSock, &readFds)) {
-			if (WEB_HandleControlCmd(webCtrlSock) == -1)
-				WEB_LogErr("Control socket (in main): %s",
-				    AG_GetError());
-		}
-		for (i = 0; i < nHttpSocks; i++) {
-			if (!FD_ISSET(httpSocks[i], &readFds))
-				continue;
-try_accept:
-			if ((sock = accept(httpSocks[i], &paddr, &paddrLen)) == -1) {
-				if (errno == EINTR) {
-					WEB_CheckSignals();
-					goto try_accept;
-				} else {
-					WEB_LogErr("accept: %s", strerror(errno));
-					continue;
-				}
-			}
-			break;
-		}
-		if (i == nHttpSocks) {
-			continue;
-		}
-		if (getnameinfo(&paddr, paddrLen, webPeerAddress,
-		    sizeof(webPeerAddress), NULL, 0, NI_NUMERICHOST) != 0)
-			webPeerAddress[0] = '\0';
-read_header:
-		/* Read HTTP request header */
-		header[0] = '\0';
-		headerLen = 0;
-		rdBufLen = 0;
-		for (;;) {
-			/* TODO: WEB_HTTP_REQ_TIMEOUT */
-			rvLen = read(sock, &header[headerLen], sizeof(header) -
-			                                       headerLen - 1);
-			if (rvLen == -1) {
-				if (errno == EINTR || errno == EAGAIN) {
-					WEB_CheckSignals();
-					continue;
-				} else {
-					WEB_LogErr("HTTP header: %s", strerror(errno));
-					goto finish;
-				}
-			}
-			header[headerLen+rvLen] = '\0';
-			headerLen += rvLen;
-
-			if ((c = strstr(header, "\r\n\r\n")) != NULL) {
-				*c = '\0';
-				if (headerLen > c-header+4) {      /* Extra */
-					rdBufLen = headerLen - (c-header+4);
-					memcpy(rdBuf, &c[4], rdBufLen);
-					headerLen = (c - &header[0]);
-				}
-				break;
-			}
-			if (rvLen == 0)
-				break;
-		}
-		if (headerLen < WEB_HTTP_HEADER_MIN) {
-			goto finish;
-		}
-		if ((cEnd = strchr(header,' ')) == NULL) {
-			WEB_LogErr("Bad method");
-			goto finish;
-		}
-		*cEnd = '\0';
+		/*
+		 * Process client input first, since accepting new connections
+		 * may close existing ones.
+		 */
+#ifdef HAVE_EPOLL
+		for (i = 0; i < rv; i++) {
+			void *p = events[i].data.ptr;
 
-		for (meth=0; meth < WEB_METHOD_LAST; meth++) {
-			AG_Size nameLen;
+			if (p != &webCtrlSock &&
+			    ((int *)p < &webHttpSocks[0] ||
+			     (int *)p >= &webHttpSocks[webHttpSockCount]))
+				ServiceConnection(p, Sops);
+		}
+		for (i = 0; i < rv; i++) {
+			void *p = events[i].data.ptr;
 
-			if (strcmp(header, webMethods[meth].name) != 0) {
-				continue;
-			}
-			nameLen = strlen(webMethods[meth].name);
-			if ((uriEnd = strchr(&header[nameLen+1],'\r')) == NULL) {
-				WEB_LogErr("Bad request");
-				goto finish;
-			}
-			*uriEnd = '\0';
-			Strlcpy(uri, &header[nameLen+1], sizeof(uri));
-			if ((cEnd = strrchr(uri,' ')) == NULL ||
-			    strcasecmp(cEnd, " HTTP/1.1") != 0) {
-				WEB_LogErr("Bad protocol");
-				goto finish;
-			}
-			*cEnd = '\0';
-			uriEnd += 2;			/* \r\n */
-			if (uri[0] == '\0') {
-				WEB_LogErr("Bad request");
-				goto finish;
+			if (p == &webCtrlSock) {
+				if (WEB_HandleControlCmd(webCtrlSock) == -1)
+					WEB_LogErr("Control socket (in main): %s",
+					    AG_GetError());
+			} else if ((int *)p >= &webHttpSocks[0] &&
+			           (int *)p < &webHttpSocks[webHttpSockCount]) {
+				AcceptConnections(*(int *)p);
 			}
-			break;
 		}
-		if (meth == WEB_METHOD_LAST) {
-			WEB_MethodNotAllowed(sock, uri, c, rdBuf, rdBufLen, Sops);
-			goto finish;
+#else
+		for (j = 0; j < nConns; j++) {
+			if (pfds[webHttpSockCount+1+j].revents != 0)
+				ServiceConnection(pconns[j], Sops);
 		}
-		c = uriEnd;
-		if (webMethods[meth].fn(sock, uri, c, rdBuf, rdBufLen, Sops)==1) {
-			webQueryCount++;
-			WEB_CheckSignals();
-			goto read_header;		/* Keep-alive */
+		if (pfds[webHttpSockCount].revents != 0) {
+			if (WEB_HandleControlCmd(webCtrlSock) == -1)
+				WEB_LogErr("Control socket (in main): %s",
+				    AG_GetError());
 		}
-		WEB_LogDebug("[%s]: Closing connection", uri);
-finish:
-		close(sock);
-		webQueryCount++;
-		WEB_CheckSignals();
+		for (j = 0; j < webHttpSockCount; j++) {
+			if (pfds[j].revents != 0)
+				AcceptConnections(webHttpSocks[j]);
+		}
+#endif
+		ProcessPendingConnections(Sops);
 	}
 
-	for (i = 0; i < nHttpSocks; i++) { close(httpSocks[i]); }
+	CloseFrontConnections();
 	close(webCtrlSock);
 	unlink(sun.sun_path);
 	return;
+#ifdef HAVE_EPOLL
+fail_epoll:
+	AG_SetError("epoll_ctl: %s", strerror(errno));
+#endif
 fail:
-	for (i = 0; i < nHttpSocks; i++) { close(httpSocks[i]); }
+	CloseFrontConnections();
 	if (webCtrlSock != -1) {
 		close(webCtrlSock);
 		unlink(sun.sun_path);
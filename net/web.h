@@ -16,7 +16,10 @@
 #define WEB_COMPAT_APACHE		/* Behind Apache 2.4 mod_proxy */
 /* #define WEB_COMPAT_NGINX */		/* Behind nginx */
 /* #define WEB_CHUNKED_EVENTS */	/* Chunked event streams */
+#if defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__) || \
+    defined(__DragonFly__)
 #define HAVE_SETPROCTITLE
+#endif
 
 #define WEB_FRONTEND_RDBUFSIZE	16384	/* Frontend I/O buffer (must fit header) */
 #define WEB_DATA_BUFSIZE	65536	/* Data buffer size */
@@ -39,6 +42,12 @@
 #define WEB_QUERY_MAX		4096	/* Max serialized WEB_Query size */
 
 #define WEB_MAXHTTPSOCKETS	5	/* Max listening sockets */
+#define WEB_MAXHTTPCONNS	1024	/* Max open HTTP client connections */
+#define WEB_HTTP_BACKLOG	128	/* HTTP listen queue length */
+#define WEB_HTTP_PIPELINE_MAX	8	/* Pipelined requests per poll cycle */
+#define WEB_HTTP_OUTQ_MAX (32*1024*1024) /* Max output queued per connection */
+#define WEB_HTTP_BODY_MAX WEB_FORMDATA_MAX /* Max request body (buffered) */
+#define WEB_POLL_EVENTS		64	/* Events processed per poll cycle */
 #define WEB_MAXWORKERSOCKETS	30	/* Max Worker->Frontend sockets */
 
 #define WEB_MAX_ARGS		256	/* URL-encoded argument count */
@@ -84,6 +93,11 @@
 #define WEB_VAR_NAME_MAX	32	/* Web variable name */
 #define WEB_VAR_BUF_INIT	128	/* Variable buffer size */
 #define WEB_VAR_BUF_GROW	1024
+#define WEB_VAR_BUCKETS_INIT	256	/* Initial variable table size */
+#define WEB_VAR_ARENA_SIZE	65536	/* Query variable arena chunk size */
+
+#define WEB_TEMPLATE_HASH_SIZE	64	/* Template cache buckets (power of 2) */
+#define WEB_TEMPLATE_CACHE_MAX	256	/* Max cached templates per process */
 
 #ifndef WEB_GLYPHICON
 #define WEB_GLYPHICON(x) "<span class='glyphicons glyphicons-" #x "'></span>"
@@ -121,12 +135,10 @@ typedef struct web_variable {
 	AG_Size len;				/* Content length (characters) */
 	AG_Size bufSize;			/* Buffer size */
 	int global;				/* 1 = Persist across queries */
-	Uint32 _pad;
-	AG_TAILQ_ENTRY(web_variable) vars;
+	Uint32 hash;				/* Hash of key */
+	struct web_variable *_Nullable next;	/* In hash bucket */
 } WEB_Variable;
 
-AG_TAILQ_HEAD(web_variableq, web_variable);
-
 /* Argument to script (key=value pair). */
 typedef struct web_argument {
 	enum web_argument_type {
@@ -368,6 +380,40 @@ typedef struct web_session_socket {
 
 AG_TAILQ_HEAD(web_session_socketq, web_session_socket);
 
+/*
+ * HTTP client connection (in Frontend). Input is accumulated in buf until
+ * a complete request (header and body) is available. Response output which
+ * the socket cannot accept immediately is queued in out, and sent once the
+ * socket becomes writable.
+ */
+typedef struct web_connection {
+	int    fd;				/* Client socket */
+	Uint   nQueries;			/* Queries processed */
+	Uint   flags;
+#define WEB_CONNECTION_PENDING	0x01	/* Has unprocessed requests buffered */
+#define WEB_CONNECTION_BLOCKED	0x02	/* Waiting for output to drain */
+#define WEB_CONNECTION_CLOSE	0x04	/* Close once output has drained */
+#define WEB_CONNECTION_ERROR	0x08	/* Output failed; discard and close */
+	Uint32 _pad;
+	time_t expire;				/* Request/keep-alive deadline */
+	char  *buf;				/* Input buffer */
+	AG_Size len;				/* Buffered input length */
+	AG_Size bufSize;			/* Input buffer size */
+	char  *out;				/* Output queue */
+	AG_Size outOffs;			/* Offset of unsent output */
+	AG_Size outLen;				/* Queued output length */
+	AG_Size outSize;			/* Output queue size */
+	char   peer[64];			/* Peer address */
+	AG_TAILQ_ENTRY(web_connection) conns;	/* In order of expiration */
+	AG_TAILQ_ENTRY(web_connection) pending;	/* In pending list */
+} WEB_Connection;
+
+/* Default input buffer size (fits a header and a small body, +1 for NUL). */
+#define WEB_CONNECTION_BUFSIZE (WEB_HTTP_HEADER_MAX + 4 + \
+                                WEB_FRONTEND_RDBUFSIZE + 1)
+
+AG_TAILQ_HEAD(web_connectionq, web_connection);
+
 /* Session Instance */
 typedef struct web_session {
 	const WEB_SessionOps *_Nonnull ops;	/* Operations */
@@ -412,7 +458,6 @@ extern char webWorkerUser[WEB_USERNAME_MAX];  /* Username (in Worker) */
 extern char webHomeOp[WEB_OPNAME_MAX];        /* Default (home) operation */
 
 extern const WEB_MethodOps  webMethods[];  /* HTTP methods handled */
-extern struct web_variableq webVars;       /* Variables for template substitution */
 extern Uint                 webQueryCount; /* Query counter (per process) */
 
 extern struct web_session_socketq webWorkSockets; /* Frontend->Worker sockets */
@@ -534,6 +579,9 @@ int  WEB_PutJSON_HTML(WEB_Query *_Nonnull, const char *_Nonnull,
 
 void WEB_VAR_FilterDocument(WEB_Query *_Nonnull, const char *_Nonnull, AG_Size);
 void WEB_VAR_FilterFragment(WEB_Query *_Nonnull, const char *_Nonnull, AG_Size);
+int  WEB_VAR_OutputTemplate(WEB_Query *_Nonnull, const char *_Nonnull, Uint);
+#define WEB_TEMPLATE_FRAGMENT 0x01	/* JSON-safe <body> fragment */
+void WEB_VAR_ClearTemplates(void);
 
 WEB_Variable *_Nonnull WEB_VAR_Set(const char *_Nullable,
                                    const char *_Nullable, ...)
@@ -559,6 +607,10 @@ void WEB_VAR_Unset(const char *_Nonnull);
 void WEB_VAR_Wipe(const char *_Nonnull);
 int  WEB_VAR_Defined(const char *_Nonnull) _Pure_Attribute;
 void WEB_VAR_Free(WEB_Variable *_Nonnull);
+void WEB_VAR_GrowBuffer(WEB_Variable *_Nonnull, AG_Size);
+char *_Nullable WEB_VAR_Get(const char *_Nonnull) _Pure_Attribute;
+void WEB_VAR_ClearQuery(void);
+void WEB_VAR_Destroy(void);
 
 int  WEB_OutputHTML(WEB_Query *_Nonnull, const char *_Nonnull);
 void WEB_OutputError(WEB_Query *_Nonnull, const char *_Nonnull);
@@ -626,10 +678,8 @@ WEB_VAR_New(const char *_Nullable key)
 static __inline__ void
 WEB_VAR_Grow(WEB_Variable *_Nonnull V, AG_Size len)
 {
-	if (V->len+len >= V->bufSize) {
-		V->bufSize = V->len + len + WEB_VAR_BUF_GROW;
-		V->value = AG_Realloc(V->value, V->bufSize);
-	}
+	if (V->len+len >= V->bufSize)
+		WEB_VAR_GrowBuffer(V, len);
 }
 
 static __inline__ void
@@ -741,19 +791,6 @@ WEB_VAR_CatN_NoNUL(WEB_Variable *_Nonnull V, const void *_Nonnull s, AG_Size len
 	V->len += len;
 }
 
-static __inline__ char *_Nullable _Pure_Attribute
-WEB_VAR_Get(const char *_Nonnull key)
-{
-	WEB_Variable *V;
-
-	AG_TAILQ_FOREACH(V, &webVars, vars) {
-		if (V->key[0] != '\0' &&
-		    strcmp(V->key, key) == 0)
-			break;
-	}
-	return (V != NULL) ? V->value : NULL;
-}
-
 /* Set an integer range (and collapse to a single integer if min=max). */
 static __inline__ WEB_Variable *_Nonnull
 WEB_VAR_SetIntRange(const char *_Nullable key, int min, int max)
@@ -809,7 +846,10 @@ WEB_GetArgument(const WEB_Query *_Nonnull q, const char *_Nonnull key)
 	return (arg);
 }
 
-/* Standard read loop. Read up to len bytes while checking signals. */
+/*
+ * Standard read loop. Read up to len bytes while checking signals. Fail if
+ * the socket receive timeout (SO_RCVTIMEO) expires.
+ */
 static __inline__ int
 WEB_SYS_Read(int fd, void *_Nonnull data, AG_Size len)
 {
@@ -819,9 +859,12 @@ WEB_SYS_Read(int fd, void *_Nonnull data, AG_Size len)
 	for (nread=0; nread < len; ) {
 		rv = read(fd, data+nread, len-nread);
 		if (rv == -1) {
-			if (errno == EINTR || errno == EAGAIN) {
+			if (errno == EINTR) {
 				WEB_CheckSignals();
 				continue;
+			} else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				AG_SetErrorS("Read timeout");
+				return (-1);
 			} else {
 				AG_SetErrorS(strerror(errno));
 				return (-1);
@@ -835,7 +878,10 @@ WEB_SYS_Read(int fd, void *_Nonnull data, AG_Size len)
 	return (0);
 }
 
-/* Standard write loop. Write up to len bytes while checking signals. */
+/*
+ * Standard write loop. Write up to len bytes while checking signals. Fail if
+ * the socket send timeout (SO_SNDTIMEO) expires.
+ */
 static __inline__ int
 WEB_SYS_Write(int fd, const void *_Nonnull data, AG_Size len)
 {
@@ -845,9 +891,12 @@ WEB_SYS_Write(int fd, const void *_Nonnull data, AG_Size len)
 	for (nwrote = 0; nwrote < len; ) {
 		rv = write(fd, data+nwrote, len-nwrote);
 		if (rv == -1) {
-			if (errno == EINTR || errno == EAGAIN) {
+			if (errno == EINTR) {
 				WEB_CheckSignals();
 				continue;
+			} else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				AG_SetErrorS("Write timeout");
+				return (-1);
 			} else {
 				AG_SetErrorS(strerror(errno));
 				return (-1);
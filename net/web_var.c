@@ -33,102 +33,362 @@
 
 #define VAR_GETTEXT_MAX 256	/* Max string length for $_(foo) */
 
+#include <sys/types.h>
+#include <sys/stat.h>
+
 #include <stdio.h>
 #include <ctype.h>
+#include <errno.h>
 
 #include <agar/config/enable_nls.h>
 
-enum web_varsubst_mode {
-	WEB_VARSUBST_NORMAL,
-	WEB_VARSUBST_VAR,
-	WEB_VARSUBST_ESCAPE,
-	WEB_VARSUBST_TRANSLATE
+enum web_template_seg_type {
+	WEB_TEMPLATE_LITERAL,			/* Literal text */
+	WEB_TEMPLATE_VAR,			/* $foo */
+	WEB_TEMPLATE_TRANSLATE			/* $_(foo) */
 };
 
-/* Set a variable (format string). */
-VAR *
-WEB_VAR_Set(const char *key, const char *fmt, ...)
+/*
+ * Variables are kept in two hash tables. Global variables are allocated
+ * from the heap and persist across queries. Other named variables (and
+ * their values) are allocated from a per-query arena, which is reset as a
+ * whole by WEB_VAR_ClearQuery() at the end of each query. Query variables
+ * shadow globals of the same name. Anonymous variables are not indexed and
+ * are allocated from the heap.
+ */
+typedef struct web_variable_table {
+	WEB_Variable *_Nullable *_Nullable buckets;
+	Uint nBuckets;				/* Bucket count (power of 2) */
+	Uint nVars;				/* Variable count */
+} WEB_VariableTable;
+
+typedef struct web_arena_chunk {
+	struct web_arena_chunk *_Nullable next;
+	AG_Size size;				/* Usable size */
+	AG_Size used;				/* Bytes allocated */
+	Uint8 *_Nullable last;			/* Last allocation */
+} WEB_ArenaChunk;
+
+#define WEB_ARENA_ALIGN		16
+#define WEB_ARENA_HEADER	((sizeof(WEB_ArenaChunk) + WEB_ARENA_ALIGN-1) & \
+				 ~(AG_Size)(WEB_ARENA_ALIGN-1))
+#define WEB_ARENA_DATA(ch)	((Uint8 *)(ch) + WEB_ARENA_HEADER)
+
+/* Whether the value of V is heap-allocated (otherwise it is in the arena). */
+#define WEB_VAR_HEAP(V)		((V)->global || (V)->key[0] == '\0')
+
+static WEB_VariableTable webVars = { NULL, 0, 0 };	/* Query variables */
+static WEB_VariableTable webGlobalVars = { NULL, 0, 0 }; /* Global variables */
+static WEB_ArenaChunk *_Nullable webArena = NULL;	/* Query arena */
+
+/* Heap memory to release along with the query arena. */
+typedef struct web_arena_deferred {
+	void *_Nonnull p;
+	struct web_arena_deferred *_Nullable next;
+} WEB_ArenaDeferred;
+
+static WEB_ArenaDeferred *_Nullable webArenaDeferred = NULL;
+
+/* Allocate memory from the query arena. */
+static void *_Nonnull
+ArenaAlloc(AG_Size size)
 {
-	VAR *V;
+	WEB_ArenaChunk *ch = webArena, *chNew;
+	Uint8 *p;
 
-	if (key != NULL) {
-		TAILQ_FOREACH(V, &webVars, vars) {
-			if (strcmp(V->key, key) == 0)
-				break;
+	size = (size + WEB_ARENA_ALIGN-1) & ~(AG_Size)(WEB_ARENA_ALIGN-1);
+	if (ch != NULL && ch->used + size <= ch->size) {
+		p = WEB_ARENA_DATA(ch) + ch->used;
+		ch->used += size;
+		ch->last = p;
+		return (p);
+	}
+	if (size > WEB_VAR_ARENA_SIZE/4 && ch != NULL) {
+		/*
+		 * Give large blocks a chunk of their own, so that the space
+		 * left in the current chunk is not wasted.
+		 */
+		chNew = Malloc(WEB_ARENA_HEADER + size);
+		chNew->size = size;
+		chNew->used = size;
+		chNew->last = WEB_ARENA_DATA(chNew);
+		chNew->next = ch->next;
+		ch->next = chNew;
+		return WEB_ARENA_DATA(chNew);
+	}
+	chNew = Malloc(WEB_ARENA_HEADER + MAX(size, WEB_VAR_ARENA_SIZE));
+	chNew->size = MAX(size, WEB_VAR_ARENA_SIZE);
+	chNew->used = size;
+	chNew->last = WEB_ARENA_DATA(chNew);
+	chNew->next = ch;
+	webArena = chNew;
+	return WEB_ARENA_DATA(chNew);
+}
+
+/*
+ * Grow a block previously returned by ArenaAlloc(). If it is the last
+ * allocation of the current chunk and there is room, extend it in place.
+ */
+static void *_Nonnull
+ArenaRealloc(void *_Nullable pOld, AG_Size sizeOld, AG_Size sizeNew)
+{
+	WEB_ArenaChunk *ch = webArena;
+	void *p;
+
+	if (pOld != NULL && ch != NULL && ch->last == pOld) {
+		AG_Size offs = (Uint8 *)pOld - WEB_ARENA_DATA(ch);
+		AG_Size end = (offs + sizeNew + WEB_ARENA_ALIGN-1) &
+		              ~(AG_Size)(WEB_ARENA_ALIGN-1);
+
+		if (end <= ch->size) {
+			ch->used = end;
+			return (pOld);
 		}
-	} else {
-		V = NULL;
 	}
-	if (V == NULL) {
-		V = Malloc(sizeof(VAR));
-		if (key != NULL) {
-			Strlcpy(V->key, key, sizeof(V->key));
+	p = ArenaAlloc(sizeNew);
+	if (pOld != NULL) {
+		memcpy(p, pOld, MIN(sizeOld, sizeNew));
+	}
+	return (p);
+}
+
+/* Arrange for heap memory p to be freed when the query arena is reset. */
+static void
+ArenaDefer(void *_Nonnull p)
+{
+	WEB_ArenaDeferred *d;
+
+	d = ArenaAlloc(sizeof(WEB_ArenaDeferred));
+	d->p = p;
+	d->next = webArenaDeferred;
+	webArenaDeferred = d;
+}
+
+/* Release all arena memory except for one chunk. */
+static void
+ArenaReset(void)
+{
+	WEB_ArenaChunk *ch, *chNext, *chKeep = NULL;
+	WEB_ArenaDeferred *d;
+
+	for (d = webArenaDeferred; d != NULL; d = d->next) {
+		free(d->p);
+	}
+	webArenaDeferred = NULL;
+
+	for (ch = webArena; ch != NULL; ch = chNext) {
+		chNext = ch->next;
+		if (chKeep == NULL && ch->size == WEB_VAR_ARENA_SIZE) {
+			chKeep = ch;
 		} else {
-			V->key[0] = '\0';
+			free(ch);
 		}
-		TAILQ_INSERT_HEAD(&webVars, V, vars);
-	} else {
-		free(V->value);
 	}
-	if (fmt != NULL) {
-		va_list ap;
-	
-		va_start(ap, fmt);
-		if (vasprintf(&V->value, fmt, ap) == -1) {
-			V->value = NULL;
-			V->len = 0;
-			V->bufSize = 0;
-		} else {
-			V->len = strlen(V->value);
-			V->bufSize = V->len+1;
+	if (chKeep != NULL) {
+		chKeep->next = NULL;
+		chKeep->used = 0;
+		chKeep->last = NULL;
+	}
+	webArena = chKeep;
+}
+
+/* Hash a variable name (up to WEB_VAR_NAME_MAX-1 characters). */
+static __inline__ Uint32
+HashVarName(const char *_Nonnull key)
+{
+	Uint32 h = 2166136261u;				/* FNV-1a */
+	const char *c;
+
+	for (c = key; *c != '\0' && c < &key[WEB_VAR_NAME_MAX-1]; c++) {
+		h ^= (Uint8)*c;
+		h *= 16777619u;
+	}
+	return (h);
+}
+
+static __inline__ WEB_Variable *_Nullable
+LookupVar(const WEB_VariableTable *_Nonnull T, const char *_Nonnull key,
+    Uint32 h)
+{
+	WEB_Variable *V;
+
+	if (T->nVars == 0) {
+		return (NULL);
+	}
+	for (V = T->buckets[h & (T->nBuckets-1)]; V != NULL; V = V->next) {
+		if (V->hash == h &&
+		    strncmp(V->key, key, WEB_VAR_NAME_MAX-1) == 0)
+			return (V);
+	}
+	return (NULL);
+}
+
+static void
+InsertVar(WEB_VariableTable *_Nonnull T, WEB_Variable *_Nonnull V)
+{
+	WEB_Variable **pb;
+
+	if (T->nVars >= T->nBuckets*2) {
+		Uint nBucketsNew = (T->nBuckets > 0) ? T->nBuckets*2 :
+		                                       WEB_VAR_BUCKETS_INIT;
+		WEB_Variable **bucketsNew, *Vb, *VbNext;
+		Uint i;
+
+		bucketsNew = Malloc(nBucketsNew*sizeof(WEB_Variable *));
+		memset(bucketsNew, 0, nBucketsNew*sizeof(WEB_Variable *));
+		for (i = 0; i < T->nBuckets; i++) {
+			for (Vb = T->buckets[i]; Vb != NULL; Vb = VbNext) {
+				VbNext = Vb->next;
+				pb = &bucketsNew[Vb->hash & (nBucketsNew-1)];
+				Vb->next = *pb;
+				*pb = Vb;
+			}
 		}
-		va_end(ap);
-	} else {
-		V->value = Malloc(WEB_VAR_BUF_INIT);
-		V->value[0] = '\0';
-		V->len = 0;
-		V->bufSize = WEB_VAR_BUF_INIT;
+		Free(T->buckets);
+		T->buckets = bucketsNew;
+		T->nBuckets = nBucketsNew;
 	}
-	V->global = 0;
-	return (V);
+	pb = &T->buckets[V->hash & (T->nBuckets-1)];
+	V->next = *pb;
+	*pb = V;
+	T->nVars++;
 }
 
-/* Set a variable (plain string). */
-VAR *
-WEB_VAR_SetS(const char *key, const char *s)
+static void
+RemoveVar(WEB_VariableTable *_Nonnull T, WEB_Variable *_Nonnull V)
 {
-	VAR *V;
+	WEB_Variable **pV;
 
-	if (key != NULL) {
-		TAILQ_FOREACH(V, &webVars, vars) {
-			if (strcmp(V->key, key) == 0)
-				break;
+	if (T->nVars == 0) {
+		return;
+	}
+	for (pV = &T->buckets[V->hash & (T->nBuckets-1)];
+	     *pV != NULL;
+	     pV = &(*pV)->next) {
+		if (*pV == V) {
+			*pV = V->next;
+			T->nVars--;
+			break;
 		}
-	} else {
-		V = NULL;
 	}
-	if (V == NULL) {
-		V = Malloc(sizeof(VAR));
-		if (key != NULL) {
-			Strlcpy(V->key, key, sizeof(V->key));
-		} else {
-			V->key[0] = '\0';
+}
+
+/*
+ * Look up a variable for assignment, creating it if it does not exist.
+ * Release its existing value.
+ */
+static WEB_Variable *_Nonnull
+GetVarForSet(const char *_Nullable key, int global)
+{
+	WEB_VariableTable *T = (global) ? &webGlobalVars : &webVars;
+	WEB_Variable *V;
+	Uint32 h;
+
+	if (key == NULL || key[0] == '\0') {		/* Anonymous */
+		V = Malloc(sizeof(WEB_Variable));
+		V->key[0] = '\0';
+		V->hash = 0;
+		V->next = NULL;
+		V->global = 0;
+		goto out;
+	}
+	h = HashVarName(key);
+	if ((V = LookupVar(T, key, h)) != NULL) {
+		if (WEB_VAR_HEAP(V)) {
+			Free(V->value);
 		}
-		TAILQ_INSERT_HEAD(&webVars, V, vars);
+		goto out;
+	}
+	if (global) {
+		WEB_Variable *Vq;
+
+		/* Setting a global overrides a query variable. */
+		if ((Vq = LookupVar(&webVars, key, h)) != NULL)
+			RemoveVar(&webVars, Vq);
+
+		V = Malloc(sizeof(WEB_Variable));
 	} else {
-		free(V->value);
+		V = ArenaAlloc(sizeof(WEB_Variable));
 	}
+	Strlcpy(V->key, key, sizeof(V->key));
+	V->hash = h;
+	V->global = global;
+	InsertVar(T, V);
+out:
+	V->value = NULL;
+	V->len = 0;
+	V->bufSize = 0;
+	return (V);
+}
+
+/* Allocate a value buffer for V (from the heap or the query arena). */
+static char *_Nonnull
+AllocValue(WEB_Variable *_Nonnull V, AG_Size size)
+{
+	V->value = (WEB_VAR_HEAP(V)) ? Malloc(size) : ArenaAlloc(size);
+	V->bufSize = size;
+	return (V->value);
+}
+
+static void
+SetValue(WEB_Variable *_Nonnull V, const char *_Nullable s, AG_Size len)
+{
 	if (s != NULL) {
-		V->value = Strdup(s);
-		V->len = strlen(s);
-		V->bufSize = V->len+1;
+		memcpy(AllocValue(V, len+1), s, len);
+		V->value[len] = '\0';
+		V->len = len;
 	} else {
-		V->value = Malloc(WEB_VAR_BUF_INIT);
-		V->value[0] = '\0';
+		AllocValue(V, WEB_VAR_BUF_INIT)[0] = '\0';
 		V->len = 0;
-		V->bufSize = WEB_VAR_BUF_INIT;
 	}
-	V->global = 0;
+}
+
+/* Set the value of V from a format string. */
+#define SET_VALUE_FMT(V, fmt) do {					\
+	char buf[WEB_VAR_BUF_INIT];					\
+	va_list ap;							\
+	int rv;								\
+									\
+	va_start(ap, fmt);						\
+	rv = vsnprintf(buf, sizeof(buf), fmt, ap);			\
+	va_end(ap);							\
+	if (rv < 0) {							\
+		break;							\
+	}								\
+	if ((AG_Size)rv < sizeof(buf)) {				\
+		SetValue((V), buf, (AG_Size)rv);			\
+	} else {							\
+		AllocValue((V), (AG_Size)rv + 1);			\
+		va_start(ap, fmt);					\
+		vsnprintf((V)->value, (AG_Size)rv + 1, fmt, ap);	\
+		va_end(ap);						\
+		(V)->len = (AG_Size)rv;					\
+	}								\
+} while (0)
+
+/* Set a variable (format string). */
+VAR *
+WEB_VAR_Set(const char *key, const char *fmt, ...)
+{
+	VAR *V;
+
+	V = GetVarForSet(key, 0);
+	if (fmt != NULL) {
+		SET_VALUE_FMT(V, fmt);
+	} else {
+		SetValue(V, NULL, 0);
+	}
+	return (V);
+}
+
+/* Set a variable (plain string). */
+VAR *
+WEB_VAR_SetS(const char *key, const char *s)
+{
+	VAR *V;
+
+	V = GetVarForSet(key, 0);
+	SetValue(V, s, (s != NULL) ? strlen(s) : 0);
 	return (V);
 }
 
@@ -138,29 +398,13 @@ WEB_VAR_SetS_NODUP(const char *key, char *s)
 {
 	VAR *V;
 
-	if (key != NULL) {
-		TAILQ_FOREACH(V, &webVars, vars) {
-			if (strcmp(V->key, key) == 0)
-				break;
-		}
-	} else {
-		V = NULL;
-	}
-	if (V == NULL) {
-		V = Malloc(sizeof(VAR));
-		if (key != NULL) {
-			Strlcpy(V->key, key, sizeof(V->key));
-		} else {
-			V->key[0] = '\0';
-		}
-		TAILQ_INSERT_HEAD(&webVars, V, vars);
-	} else {
-		free(V->value);
+	V = GetVarForSet(key, 0);
+	if (!WEB_VAR_HEAP(V)) {
+		ArenaDefer(s);			/* Free at end of query */
 	}
 	V->value = s;
 	V->len = strlen(s);
 	V->bufSize = V->len+1;
-	V->global = 0;
 	return (V);
 }
 
@@ -168,22 +412,23 @@ WEB_VAR_SetS_NODUP(const char *key, char *s)
 void
 WEB_VAR_Cat(VAR *V, const char *fmt, ...)
 {
-	char *s;
-	AG_Size len;
+	AG_Size avail = (V->value != NULL) ? V->bufSize - V->len : 0;
 	va_list ap;
+	int rv;
 
 	va_start(ap, fmt);
-	if (vasprintf(&s, fmt, ap) == -1) {
-		va_end(ap);
+	rv = vsnprintf((avail > 0) ? &V->value[V->len] : NULL, avail, fmt, ap);
+	va_end(ap);
+	if (rv < 0) {
 		return;
 	}
-	va_end(ap);
-
-	len = strlen(s);
-	WEB_VAR_Grow(V, len+1);
-	memcpy(&V->value[V->len], s, len+1);
-	V->len += len;
-	free(s);
+	if ((AG_Size)rv >= avail) {
+		WEB_VAR_Grow(V, (AG_Size)rv + 1);
+		va_start(ap, fmt);
+		vsnprintf(&V->value[V->len], (AG_Size)rv + 1, fmt, ap);
+		va_end(ap);
+	}
+	V->len += (AG_Size)rv;
 }
 
 /* Set a global variable (format string). */
@@ -192,37 +437,12 @@ WEB_VAR_SetGlobal(const char *key, const char *fmt, ...)
 {
 	VAR *V;
 
-	TAILQ_FOREACH(V, &webVars, vars) {
-		if (strcmp(V->key, key) == 0)
-			break;
-	}
-	if (V == NULL) {
-		V = Malloc(sizeof(VAR));
-		Strlcpy(V->key, key, sizeof(V->key));
-		TAILQ_INSERT_HEAD(&webVars, V, vars);
-	} else {
-		free(V->value);
-	}
+	V = GetVarForSet(key, 1);
 	if (fmt != NULL) {
-		va_list ap;
-	
-		va_start(ap, fmt);
-		if (vasprintf(&V->value, fmt, ap) == -1) {
-			V->value = NULL;
-			V->len = 0;
-			V->bufSize = 0;
-		} else {
-			V->len = strlen(V->value);
-			V->bufSize = V->len+1;
-		}
-		va_end(ap);
+		SET_VALUE_FMT(V, fmt);
 	} else {
-		V->value = Malloc(WEB_VAR_BUF_INIT);
-		V->value[0] = '\0';
-		V->len = 0;
-		V->bufSize = WEB_VAR_BUF_INIT;
+		SetValue(V, NULL, 0);
 	}
-	V->global = 1;
 	return (V);
 }
 
@@ -232,321 +452,796 @@ WEB_VAR_SetGlobalS(const char *key, const char *s)
 {
 	VAR *V;
 
-	TAILQ_FOREACH(V, &webVars, vars) {
-		if (strcmp(V->key, key) == 0)
-			break;
+	V = GetVarForSet(key, 1);
+	SetValue(V, s, (s != NULL) ? strlen(s) : 0);
+	return (V);
+}
+
+/*
+ * Grow the buffer of a variable such that len more bytes fit. Buffers
+ * grow geometrically. Called by WEB_VAR_Grow().
+ */
+void
+WEB_VAR_GrowBuffer(VAR *V, AG_Size len)
+{
+	AG_Size sizeNew = (V->bufSize > 0) ? V->bufSize : WEB_VAR_BUF_INIT;
+
+	while (sizeNew <= V->len + len) {
+		sizeNew <<= 1;
 	}
-	if (V == NULL) {
-		V = Malloc(sizeof(VAR));
-		Strlcpy(V->key, key, sizeof(V->key));
-		TAILQ_INSERT_HEAD(&webVars, V, vars);
+	if (WEB_VAR_HEAP(V)) {
+		V->value = Realloc(V->value, sizeNew);
 	} else {
-		free(V->value);
+		V->value = ArenaRealloc(V->value, V->bufSize, sizeNew);
 	}
-	if (s != NULL) {
-		V->value = Strdup(s);
-		V->len = strlen(V->value);
-		V->bufSize = V->len+1;
-	} else {
-		V->value = Malloc(WEB_VAR_BUF_INIT);
+	if (V->bufSize == 0) {
 		V->value[0] = '\0';
-		V->len = 0;
-		V->bufSize = WEB_VAR_BUF_INIT;
 	}
-	V->global = 1;
-	return (V);
+	V->bufSize = sizeNew;
+}
+
+/* Return the value of a variable given the hash of its name. */
+static __inline__ char *_Nullable
+GetVarHashed(const char *_Nonnull key, Uint32 h)
+{
+	WEB_Variable *V;
+
+	if ((V = LookupVar(&webVars, key, h)) != NULL ||
+	    (V = LookupVar(&webGlobalVars, key, h)) != NULL) {
+		return (V->value);
+	}
+	return (NULL);
+}
+
+/* Return the value of a variable (query variables shadow globals). */
+char *
+WEB_VAR_Get(const char *key)
+{
+	return GetVarHashed(key, HashVarName(key));
 }
 
 void
 WEB_VAR_Unset(const char *key)
 {
-	VAR *V;
+	Uint32 h = HashVarName(key);
+	WEB_Variable *V;
 
-	TAILQ_FOREACH(V, &webVars, vars) {
-		if (strcmp(V->key, key) == 0)
-			break;
+	if ((V = LookupVar(&webVars, key, h)) != NULL) {
+		RemoveVar(&webVars, V);
 	}
-	if (V != NULL) {
-		TAILQ_REMOVE(&webVars, V, vars);
+	if ((V = LookupVar(&webGlobalVars, key, h)) != NULL)
 		WEB_VAR_Free(V);
-	}
 }
 
 void
 WEB_VAR_Wipe(const char *key)
 {
-	VAR *V;
+	Uint32 h = HashVarName(key);
+	WEB_Variable *V;
 
-	TAILQ_FOREACH(V, &webVars, vars) {
-		if (strcmp(V->key, key) == 0)
-			break;
+	if ((V = LookupVar(&webVars, key, h)) != NULL ||
+	    (V = LookupVar(&webGlobalVars, key, h)) != NULL) {
+		if (V->value != NULL)
+			memset(V->value, 0, V->bufSize);
 	}
-	if (V != NULL)
-		memset(V->value, 0, V->bufSize);
 }
 
 int
 WEB_VAR_Defined(const char *key)
 {
-	VAR *V;
+	Uint32 h = HashVarName(key);
 
-	TAILQ_FOREACH(V, &webVars, vars) {
-		if (strcmp(V->key, key) == 0)
-			return (1);
-	}
-	return (0);
+	return (LookupVar(&webVars, key, h) != NULL ||
+	        LookupVar(&webGlobalVars, key, h) != NULL);
 }
 
+/*
+ * Release a variable. The memory of query variables is reclaimed at the
+ * end of the query.
+ */
 void
 WEB_VAR_Free(VAR *V)
 {
-	TAILQ_REMOVE(&webVars, V, vars);
+	if (V->key[0] != '\0') {
+		if (!V->global) {
+			RemoveVar(&webVars, V);
+			return;
+		}
+		RemoveVar(&webGlobalVars, V);
+	}
 	Free(V->value);
 	free(V);
 }
 
+/*
+ * Release all query variables (but not globals or anonymous variables)
+ * and reset the query arena.
+ */
+void
+WEB_VAR_ClearQuery(void)
+{
+	if (webVars.nVars > 0) {
+		memset(webVars.buckets, 0,
+		    webVars.nBuckets*sizeof(WEB_Variable *));
+		webVars.nVars = 0;
+	}
+	ArenaReset();
+}
+
+/* Release all variables and the query arena. */
+void
+WEB_VAR_Destroy(void)
+{
+	WEB_Variable *V, *Vnext;
+	Uint i;
+
+	WEB_VAR_ClearQuery();
+	for (i = 0; i < webGlobalVars.nBuckets; i++) {
+		for (V = webGlobalVars.buckets[i]; V != NULL; V = Vnext) {
+			Vnext = V->next;
+			Free(V->value);
+			free(V);
+		}
+	}
+	Free(webGlobalVars.buckets);
+	webGlobalVars.buckets = NULL;
+	webGlobalVars.nBuckets = 0;
+	webGlobalVars.nVars = 0;
+
+	Free(webVars.buckets);
+	webVars.buckets = NULL;
+	webVars.nBuckets = 0;
+
+	free(webArena);
+	webArena = NULL;
+}
+
 /*
  * Variable Substitution
+ *
+ * Templates are compiled into a list of segments: runs of literal text
+ * (which are written out as single blocks), "$variable" references and
+ * "$_(text)" translation references. "%24" is accepted in place of "$",
+ * and "$$" produces a literal "$".
+ *
+ * Compiled templates are cached in a per-process table keyed by path. An
+ * entry is recompiled whenever the file's mtime, ctime, size or inode
+ * changes. Timestamps are compared with nanosecond precision where the
+ * platform provides it, so that edits within the same second are noticed.
+ * Translations are resolved once per template and language.
  */
 
+/* Nanoseconds part of the stat(2) timestamps (or 0 if unavailable). */
+#if defined(__APPLE__) && defined(st_mtime)
+# define WEB_STAT_MTIME_NS(sb) ((long)(sb)->st_mtimespec.tv_nsec)
+# define WEB_STAT_CTIME_NS(sb) ((long)(sb)->st_ctimespec.tv_nsec)
+#elif defined(st_mtime)			/* Defined in terms of st_mtim */
+# define WEB_STAT_MTIME_NS(sb) ((long)(sb)->st_mtim.tv_nsec)
+# define WEB_STAT_CTIME_NS(sb) ((long)(sb)->st_ctim.tv_nsec)
+#else
+# define WEB_STAT_MTIME_NS(sb) 0L
+# define WEB_STAT_CTIME_NS(sb) 0L
+#endif
+
+/* Translated strings for a given language (one entry per segment). */
+typedef struct web_template_xlat {
+	char lang[8];				/* Language code */
+	char *_Nullable *_Nonnull s;		/* Translated text */
+	AG_Size *_Nonnull len;			/* Length of translated text */
+	struct web_template_xlat *_Nullable next;
+} WEB_TemplateXlat;
+
+typedef struct web_template_seg {
+	enum web_template_seg_type type;
+	Uint32 len;				/* Length of text */
+	AG_Size offs;				/* Offset of text in pool */
+	Uint32 hash;				/* Hash of variable name */
+	Uint32 _pad;
+} WEB_TemplateSeg;
+
+typedef struct web_template {
+	char *_Nullable path;			/* Source file (or NULL) */
+	Uint32 hash;				/* Hash of path */
+	Uint flags;				/* WEB_TEMPLATE_* flags */
+	time_t mtime;				/* Source modification time */
+	time_t ctime;				/* Source status change time */
+	long mtimeNs, ctimeNs;			/* Nanoseconds (if available) */
+	off_t size;				/* Source size */
+	ino_t ino;				/* Source inode */
+	char *_Nullable text;			/* Text pool */
+	AG_Size textLen, textSize;
+	WEB_TemplateSeg *_Nullable segs;	/* Compiled segments */
+	Uint nSegs, maxSegs;
+	Uint nXlat;				/* Translation segments */
+	Uint32 _pad;
+	WEB_TemplateXlat *_Nullable xlat;	/* Cached translations */
+	struct web_template *_Nullable next;	/* In hash bucket */
+} WEB_Template;
+
+static WEB_Template *_Nullable webTemplates[WEB_TEMPLATE_HASH_SIZE];
+static Uint webTemplateCount = 0;
+
 static __inline__ int
 VarNameChar(const char c)
 {
 	return (isalnum(c) || c == '_');
 }
 
+static __inline__ Uint32
+HashTemplatePath(const char *_Nonnull path, Uint flags)
+{
+	Uint32 h = 2166136261u;				/* FNV-1a */
+	const char *c;
+
+	for (c = path; *c != '\0'; c++) {
+		h ^= (Uint8)*c;
+		h *= 16777619u;
+	}
+	h ^= (Uint32)flags;
+	h *= 16777619u;
+	return (h);
+}
+
+/* Return the JSON escape sequence for c, or NULL if c is safe as-is. */
+static __inline__ const char *_Nullable
+EscapeJSON(char c)
+{
+	switch (c) {
+	case '\\':	return "\\\\";
+	case '"':	return "\\\"";
+	case '\r':	return "\\r";
+	case '\n':	return "\\n";
+	case '\t':	return "\\t";
+	default:	return (NULL);
+	}
+}
+
 /*
- * Perform variable substitution and translation on a whole HTML document.
- * Return results without further transformation. 
+ * Write a string to the query output, escaping characters to make the
+ * output JSON-safe. Runs of unescaped characters are written as blocks.
  */
-void
-WEB_VAR_FilterDocument(WEB_Query *q, const char *src, AG_Size srcLen)
+static void
+WEB_VAR_WriteJSON(WEB_Query *_Nonnull q, const char *_Nonnull s, AG_Size len)
 {
-	char vName[VAR_GETTEXT_MAX];
-	enum web_varsubst_mode mode;
-	const char *c, *s;
-	char cDst, *pName;
-
-	for (c = src; c < &src[srcLen]; ) {
-		/* XXX TODO: Block copy everything up first !NORMAL */
-		mode = WEB_VARSUBST_NORMAL;
-		if (c[0] == '%' && c < &src[srcLen-3] &&	/* %24foo */
-		    c[1] == '2' && c[2] == '4') {
-			if (c[3] == '%' && &c[3] < &src[srcLen-3] &&
-			    c[4] == '2' &&  c[5] == '4') {
-				mode = WEB_VARSUBST_ESCAPE;
-			} else {
-				mode = WEB_VARSUBST_VAR;
+	const char *c, *run, *esc;
+
+	for (c = run = s; c < &s[len]; c++) {
+		if ((esc = EscapeJSON(*c)) == NULL) {
+			continue;
+		}
+		if (c > run) {
+			WEB_Write(q, run, c - run);
+		}
+		WEB_Write(q, esc, 2);
+		run = &c[1];
+	}
+	if (c > run)
+		WEB_Write(q, run, c - run);
+}
+
+/* Return the length of s once escaped for JSON. */
+static AG_Size
+LengthJSON(const char *_Nonnull s, AG_Size len)
+{
+	AG_Size i, lenNew = len;
+
+	for (i = 0; i < len; i++) {
+		if (EscapeJSON(s[i]) != NULL)
+			lenNew++;
+	}
+	return (lenNew);
+}
+
+/* Copy s to d, escaping for JSON. */
+static void
+CopyJSON(char *_Nonnull d, const char *_Nonnull s, AG_Size len)
+{
+	const char *esc;
+	AG_Size i;
+
+	for (i = 0; i < len; i++) {
+		if ((esc = EscapeJSON(s[i])) != NULL) {
+			*d++ = esc[0];
+			*d++ = esc[1];
+		} else {
+			*d++ = s[i];
+		}
+	}
+}
+
+/* Append text to the template's pool (escaping for JSON if requested). */
+static int
+AppendText(WEB_Template *_Nonnull t, const char *_Nonnull s, AG_Size len,
+    int json)
+{
+	AG_Size lenNew = (json) ? LengthJSON(s, len) : len;
+	char *text;
+
+	if (t->textLen + lenNew + 1 > t->textSize) {
+		AG_Size sizeNew = (t->textSize > 0) ? t->textSize*2 : 256;
+
+		while (sizeNew < t->textLen + lenNew + 1) {
+			sizeNew *= 2;
+		}
+		if ((text = TryRealloc(t->text, sizeNew)) == NULL) {
+			return (-1);
+		}
+		t->text = text;
+		t->textSize = sizeNew;
+	}
+	if (lenNew != len) {
+		CopyJSON(&t->text[t->textLen], s, len);
+	} else {
+		memcpy(&t->text[t->textLen], s, len);
+	}
+	t->textLen += lenNew;
+	return (0);
+}
+
+static WEB_TemplateSeg *_Nullable
+AddSegment(WEB_Template *_Nonnull t, enum web_template_seg_type type)
+{
+	WEB_TemplateSeg *seg;
+
+	if (t->nSegs+1 > t->maxSegs) {
+		Uint maxNew = (t->maxSegs > 0) ? t->maxSegs*2 : 16;
+		WEB_TemplateSeg *segsNew;
+
+		if ((segsNew = TryRealloc(t->segs,
+		    maxNew*sizeof(WEB_TemplateSeg))) == NULL) {
+			return (NULL);
+		}
+		t->segs = segsNew;
+		t->maxSegs = maxNew;
+	}
+	seg = &t->segs[t->nSegs++];
+	seg->type = type;
+	seg->offs = t->textLen;
+	seg->len = 0;
+	seg->hash = 0;
+	return (seg);
+}
+
+/* Append literal text, extending the previous literal segment if possible. */
+static int
+AddLiteral(WEB_Template *_Nonnull t, const char *_Nonnull s, AG_Size len)
+{
+	WEB_TemplateSeg *seg;
+	AG_Size lenPrev = t->textLen;
+
+	if (len == 0) {
+		return (0);
+	}
+	if (t->nSegs > 0 &&
+	    t->segs[t->nSegs-1].type == WEB_TEMPLATE_LITERAL) {
+		seg = &t->segs[t->nSegs-1];
+	} else {
+		if ((seg = AddSegment(t, WEB_TEMPLATE_LITERAL)) == NULL)
+			return (-1);
+	}
+	if (AppendText(t, s, len, (t->flags & WEB_TEMPLATE_FRAGMENT)) == -1) {
+		return (-1);
+	}
+	seg->len += (Uint32)(t->textLen - lenPrev);
+	return (0);
+}
+
+/* Add a variable or translation reference (name is stored NUL-terminated). */
+static int
+AddReference(WEB_Template *_Nonnull t, enum web_template_seg_type type,
+    const char *_Nonnull name, AG_Size len)
+{
+	WEB_TemplateSeg *seg;
+
+#ifndef ENABLE_NLS
+	if (type == WEB_TEMPLATE_TRANSLATE)
+		return AddLiteral(t, name, len);
+#endif
+	if ((seg = AddSegment(t, type)) == NULL ||
+	    AppendText(t, name, len, 0) == -1) {
+		return (-1);
+	}
+	t->text[t->textLen++] = '\0';
+	seg->len = (Uint32)len;
+	if (type == WEB_TEMPLATE_TRANSLATE) {
+		t->nXlat++;
+	} else {
+		seg->hash = HashVarName(&t->text[seg->offs]);
+	}
+	return (0);
+}
+
+/* Return a pointer to the first occurrence of tag in [s, end) or NULL. */
+static const char *_Nullable
+FindTag(const char *_Nonnull s, const char *_Nonnull end,
+    const char *_Nonnull tag, AG_Size tagLen)
+{
+	const char *c;
+
+	for (c = s;
+	     (AG_Size)(end-c) >= tagLen &&
+	     (c = memchr(c, tag[0], end-c)) != NULL &&
+	     (AG_Size)(end-c) >= tagLen;
+	     c++) {
+		if (memcmp(c, tag, tagLen) == 0)
+			return (c);
+	}
+	return (NULL);
+}
+
+/*
+ * Compile template source into segments. In WEB_TEMPLATE_FRAGMENT mode,
+ * only the contents of <body></body> are used (or the whole document if it
+ * has no <body>), and literal text is stored JSON-escaped.
+ */
+static int
+CompileTemplate(WEB_Template *_Nonnull t, const char *_Nonnull src,
+    AG_Size srcLen)
+{
+	const char *c, *end, *lit, *p, *name;
+	int esc;
+
+	c = src;
+	end = &src[srcLen];
+	if (t->flags & WEB_TEMPLATE_FRAGMENT) {
+		const char *body, *bodyEnd;
+
+		if ((body = FindTag(src, end, "<body>", 6)) != NULL) {
+			c = body;
+			if ((bodyEnd = FindTag(body, end, "</body>", 7)) != NULL)
+				end = bodyEnd;
+		}
+	}
+	for (lit = c; c < end; ) {
+		if (*c == '$') {
+			p = &c[1];
+			esc = (p < end && *p == '$');
+			if (esc)
+				p++;
+		} else if (*c == '%' && end-c >= 3 &&		/* %24foo */
+		           c[1] == '2' && c[2] == '4') {
+			p = &c[3];
+			esc = (end-p >= 3 && p[0] == '%' &&
+			       p[1] == '2' && p[2] == '4');
+			if (esc)
+				p += 3;
+		} else {
+			c++;
+			continue;
+		}
+
+		if (esc) {					/* $$ */
+			if (AddLiteral(t, lit, c-lit) == -1 ||
+			    AddLiteral(t, "$", 1) == -1) {
+				return (-1);
 			}
-			c+=3;
-			if (c[0] == '_' && c[1] == '(') {
-				mode = WEB_VARSUBST_TRANSLATE;
-				c+=2;
-				for (pName = &vName[0];
-				     c < &src[srcLen-1] && *c != ')' &&
-				       isprint(*c) &&
-				       pName < &vName[sizeof(vName)-1];
-				     c++) {
-					*pName = *c;
-					pName++;
-				}
-				c++;
-			} else {
-				for (pName = &vName[0];
-				     c < &src[srcLen-1] && VarNameChar(*c) &&
-				       pName < &vName[sizeof(vName)-1];
-				     c++, pName++) {
-					*pName = *c;
-				}
+			c = lit = p;
+			continue;
+		}
+		if (end-p >= 2 && p[0] == '_' && p[1] == '(') {	/* $_(foo) */
+			for (p += 2, name = p;
+			     p < end && *p != ')' && isprint(*p) &&
+			     p-name < VAR_GETTEXT_MAX-1;
+			     p++)
+				;;
+			if (AddLiteral(t, lit, c-lit) == -1 ||
+			    AddReference(t, WEB_TEMPLATE_TRANSLATE, name,
+			                 p-name) == -1) {
+				return (-1);
 			}
-			*pName = '\0';
-		} else if (*c == '$') {
-			mode = (c[1]=='$') ? WEB_VARSUBST_ESCAPE :
-				             WEB_VARSUBST_VAR;
-			c++;
-			if (c[0] == '_' && c[1] == '(') {
-				mode = WEB_VARSUBST_TRANSLATE;
-				c+=2;
-				for (pName = &vName[0];
-				     c < &src[srcLen-1] && *c != ')' &&
-				       isprint(*c) &&
-				       pName < &vName[sizeof(vName)-1];
-				     c++) {
-					*pName = *c;
-					pName++;
-				}
-				c++;
-			} else {
-				for (pName = &vName[0];
-				     c < &src[srcLen-1] && VarNameChar(*c) &&
-				       pName < &vName[sizeof(vName)-1];
-				     c++, pName++) {
-					*pName = *c;
-				}
+			if (p < end && *p == ')')
+				p++;
+		} else {					/* $foo */
+			for (name = p;
+			     p < end && VarNameChar(*p) &&
+			     p-name < VAR_GETTEXT_MAX-1;
+			     p++)
+				;;
+			if (p == name) {		/* Not a reference */
+				c = p;
+				continue;
 			}
-			*pName = '\0';
+			if (AddLiteral(t, lit, c-lit) == -1 ||
+			    AddReference(t, WEB_TEMPLATE_VAR, name,
+			                 p-name) == -1)
+				return (-1);
 		}
+		c = lit = p;
+	}
+	return AddLiteral(t, lit, end-lit);
+}
+
+static void
+FreeTemplate(WEB_Template *_Nonnull t)
+{
+	WEB_TemplateXlat *xl, *xlNext;
+	Uint i;
+
+	for (xl = t->xlat; xl != NULL; xl = xlNext) {
+		xlNext = xl->next;
+		for (i = 0; i < t->nSegs; i++) {
+			Free(xl->s[i]);
+		}
+		free(xl->s);
+		free(xl->len);
+		free(xl);
+	}
+	Free(t->segs);
+	Free(t->text);
+	Free(t->path);
+}
 
-		switch (mode) {
-		case WEB_VARSUBST_NORMAL:
-			cDst = *(c++);
-			WEB_Write(q, &cDst, 1);
-			break;
-		case WEB_VARSUBST_ESCAPE:
-			cDst = '$';
-			WEB_Write(q, &cDst, 1);
-			WEB_Write(q, vName, strlen(vName));
-			break;
-		case WEB_VARSUBST_TRANSLATE:
 #ifdef ENABLE_NLS
-			s = gettext(vName);
-			WEB_Write(q, s, strlen(s));
-#else
-			WEB_Write(q, vName, strlen(vName));
+/* Duplicate a translated string (escaping for JSON if requested). */
+static char *_Nullable
+DupTranslation(const char *_Nonnull s, int json, AG_Size *_Nonnull len)
+{
+	AG_Size lenOrig = strlen(s);
+	char *d;
+
+	*len = (json) ? LengthJSON(s, lenOrig) : lenOrig;
+	if ((d = TryMalloc(*len + 1)) == NULL) {
+		return (NULL);
+	}
+	if (*len != lenOrig) {
+		CopyJSON(d, s, lenOrig);
+	} else {
+		memcpy(d, s, lenOrig);
+	}
+	d[*len] = '\0';
+	return (d);
+}
+
+/*
+ * Return the translations of a template's $_() references in the given
+ * language, resolving them with gettext() on first use.
+ */
+static WEB_TemplateXlat *_Nullable
+GetTranslations(WEB_Template *_Nonnull t, const char *_Nonnull lang)
+{
+	WEB_TemplateXlat *xl;
+	Uint i;
+
+	for (xl = t->xlat; xl != NULL; xl = xl->next) {
+		if (strcmp(xl->lang, lang) == 0)
+			return (xl);
+	}
+	if ((xl = TryMalloc(sizeof(WEB_TemplateXlat))) == NULL) {
+		return (NULL);
+	}
+	if ((xl->s = TryMalloc(t->nSegs*sizeof(char *))) == NULL) {
+		free(xl);
+		return (NULL);
+	}
+	if ((xl->len = TryMalloc(t->nSegs*sizeof(AG_Size))) == NULL) {
+		free(xl->s);
+		free(xl);
+		return (NULL);
+	}
+	Strlcpy(xl->lang, lang, sizeof(xl->lang));
+	for (i = 0; i < t->nSegs; i++) {
+		const WEB_TemplateSeg *seg = &t->segs[i];
+
+		if (seg->type == WEB_TEMPLATE_TRANSLATE) {
+			xl->s[i] = DupTranslation(gettext(&t->text[seg->offs]),
+			    (t->flags & WEB_TEMPLATE_FRAGMENT), &xl->len[i]);
+		} else {
+			xl->s[i] = NULL;
+			xl->len[i] = 0;
+		}
+	}
+	xl->next = t->xlat;
+	t->xlat = xl;
+	return (xl);
+}
+#endif /* ENABLE_NLS */
+
+/* Write the output of a compiled template. */
+static void
+OutputTemplate(WEB_Query *_Nonnull q, WEB_Template *_Nonnull t)
+{
+	WEB_TemplateXlat *xl = NULL;
+	const WEB_TemplateSeg *seg;
+	const char *s;
+	Uint i;
+
+#ifdef ENABLE_NLS
+	if (t->nXlat > 0)
+		xl = GetTranslations(t, q->lang);
 #endif
+	for (i = 0, seg = &t->segs[0]; i < t->nSegs; i++, seg++) {
+		switch (seg->type) {
+		case WEB_TEMPLATE_LITERAL:
+			WEB_Write(q, &t->text[seg->offs], seg->len);
 			break;
-		case WEB_VARSUBST_VAR:
-			if (vName[0] == '\0') {
+		case WEB_TEMPLATE_VAR:
+			if ((s = GetVarHashed(&t->text[seg->offs], seg->hash))
+			    == NULL) {
+				WEB_LogErr("Uninitialized: $%s",
+				    &t->text[seg->offs]);
 				break;
 			}
-			if ((s = Get(vName)) != NULL) {
+			if (t->flags & WEB_TEMPLATE_FRAGMENT) {
+				WEB_VAR_WriteJSON(q, s, strlen(s));
+			} else {
 				WEB_Write(q, s, strlen(s));
+			}
+			break;
+		case WEB_TEMPLATE_TRANSLATE:
+			if (xl != NULL && xl->s[i] != NULL) {
+				WEB_Write(q, xl->s[i], xl->len[i]);
+				break;
+			}
+#ifdef ENABLE_NLS
+			s = gettext(&t->text[seg->offs]);
+#else
+			s = &t->text[seg->offs];
+#endif
+			if (t->flags & WEB_TEMPLATE_FRAGMENT) {
+				WEB_VAR_WriteJSON(q, s, strlen(s));
 			} else {
-				WEB_LogErr("Uninitialized: $%s", vName);
+				WEB_Write(q, s, strlen(s));
 			}
 			break;
 		}
 	}
 }
 
+/* Compile and write a template from memory, without caching. */
+static void
+FilterTemplate(WEB_Query *_Nonnull q, const char *_Nonnull src,
+    AG_Size srcLen, Uint flags)
+{
+	WEB_Template t;
+
+	memset(&t, 0, sizeof(t));
+	t.flags = flags;
+	if (CompileTemplate(&t, src, srcLen) == 0) {
+		OutputTemplate(q, &t);
+	} else {
+		WEB_LogErr("Template: %s", AG_GetError());
+	}
+	FreeTemplate(&t);
+}
+
+/*
+ * Perform variable substitution and translation on a whole HTML document.
+ * Return results without further transformation. 
+ */
+void
+WEB_VAR_FilterDocument(WEB_Query *q, const char *src, AG_Size srcLen)
+{
+	FilterTemplate(q, src, srcLen, 0);
+}
+
 /*
  * Perform variable substitution and translation on a HTML code fragment.
  * Transform characters to make output JSON-safe for [json] mode.
  * Ignore contents outside of <body></body>.
  */
-static __inline__ void
-WEB_VAR_WriteJSON(WEB_Query *_Nonnull q, const char *_Nonnull s, AG_Size len)
+void
+WEB_VAR_FilterFragment(WEB_Query *q, const char *src, AG_Size srcLen)
 {
-	AG_Size i;
-	const char *c;
-	
-	for (i=0, c=s; i < len; i++, c++) {
-		if     (*c == '\\') { WEB_PutS(q, "\\\\"); }
-		else if (*c == '"') { WEB_PutS(q, "\\\""); }
-		else if (*c == '\n') { WEB_PutS(q, "\\n"); }
-		else if (*c == '\t') { WEB_PutS(q, "\\t"); }
-		else { WEB_PutC(q, *c); }
+	FilterTemplate(q, src, srcLen, WEB_TEMPLATE_FRAGMENT);
+}
+
+/* Load and compile a template file. */
+static WEB_Template *_Nullable
+LoadTemplate(const char *_Nonnull path, Uint flags,
+    const struct stat *_Nonnull sb)
+{
+	WEB_Template *t;
+	AG_DataSource *ds;
+	char *data;
+	AG_Size len = (AG_Size)sb->st_size;
+
+	if ((ds = AG_OpenFile(path, "rb")) == NULL) {
+		return (NULL);
 	}
+	if ((data = TryMalloc(len+1)) == NULL) {
+		AG_CloseFile(ds);
+		return (NULL);
+	}
+	if (AG_Read(ds, data, len) == -1) {
+		AG_CloseFile(ds);
+		free(data);
+		return (NULL);
+	}
+	AG_CloseFile(ds);
+
+	if ((t = TryMalloc(sizeof(WEB_Template))) == NULL) {
+		free(data);
+		return (NULL);
+	}
+	memset(t, 0, sizeof(WEB_Template));
+	t->flags = flags;
+	t->mtime = sb->st_mtime;
+	t->ctime = sb->st_ctime;
+	t->mtimeNs = WEB_STAT_MTIME_NS(sb);
+	t->ctimeNs = WEB_STAT_CTIME_NS(sb);
+	t->size = sb->st_size;
+	t->ino = sb->st_ino;
+	if ((t->path = TryStrdup(path)) == NULL ||
+	    CompileTemplate(t, data, len) == -1) {
+		FreeTemplate(t);
+		free(t);
+		free(data);
+		return (NULL);
+	}
+	free(data);
+	return (t);
 }
-void
-WEB_VAR_FilterFragment(WEB_Query *q, const char *src, AG_Size srcLen)
+
+/*
+ * Write the template file at path to the query output, performing variable
+ * substitution and translation. The compiled template is cached until the
+ * file is modified. With WEB_TEMPLATE_FRAGMENT, produce JSON-safe output
+ * from the contents of <body></body>.
+ */
+int
+WEB_VAR_OutputTemplate(WEB_Query *q, const char *path, Uint flags)
 {
-	char vName[VAR_GETTEXT_MAX];
-	enum web_varsubst_mode mode;
-	int inBody = 0;
-	const char *c, *s;
-	char cDst, *pName;
-
-	for (c = src; c < &src[srcLen]; ) {
-		if (*c == '<') {
-			if (strncmp(&c[1],"body>",5) == 0) {
-				inBody = 1;
-			} else if (strncmp(&c[1],"/body>",6) == 0) {
-				break;
-			}
+	WEB_Template *t, **pt;
+	struct stat sb;
+	Uint32 h;
+
+	if (stat(path, &sb) == -1) {
+		if (errno == ENOENT) {
+			AG_SetError("Document not found: %s", path);
+		} else {
+			AG_SetError("%s: %s", path, AG_Strerror(errno));
 		}
-		if (!inBody) {
-			continue;
+		return (-1);
+	}
+	h = HashTemplatePath(path, flags);
+	for (pt = &webTemplates[h & (WEB_TEMPLATE_HASH_SIZE-1)];
+	     (t = *pt) != NULL;
+	     pt = &t->next) {
+		if (t->hash == h && t->flags == flags &&
+		    strcmp(t->path, path) == 0)
+			break;
+	}
+	if (t != NULL &&
+	    (t->mtime != sb.st_mtime || t->mtimeNs != WEB_STAT_MTIME_NS(&sb) ||
+	     t->ctime != sb.st_ctime || t->ctimeNs != WEB_STAT_CTIME_NS(&sb) ||
+	     t->size != sb.st_size || t->ino != sb.st_ino)) {
+		*pt = t->next;				/* Stale */
+		FreeTemplate(t);
+		free(t);
+		webTemplateCount--;
+		t = NULL;
+	}
+	if (t == NULL) {
+		if ((t = LoadTemplate(path, flags, &sb)) == NULL) {
+			return (-1);
+		}
+		if (webTemplateCount >= WEB_TEMPLATE_CACHE_MAX) {
+			WEB_VAR_ClearTemplates();
 		}
+		t->hash = h;
+		pt = &webTemplates[h & (WEB_TEMPLATE_HASH_SIZE-1)];
+		t->next = *pt;
+		*pt = t;
+		webTemplateCount++;
+	}
+	OutputTemplate(q, t);
+	return (0);
+}
 
-		/* XXX TODO: Block copy everything up first !NORMAL */
-		mode = WEB_VARSUBST_NORMAL;
+/* Discard all compiled templates from the cache. */
+void
+WEB_VAR_ClearTemplates(void)
+{
+	WEB_Template *t, *tNext;
+	Uint i;
 
-		if (c[0] == '%' && c < &src[srcLen-3] &&	/* %24foo */
-		    c[1] == '2' && c[2] == '4') {
-			if (c[3] == '%' && &c[3] < &src[srcLen-3] &&
-			    c[4] == '2' &&  c[5] == '4') {
-				mode = WEB_VARSUBST_ESCAPE;
-			} else {
-				mode = WEB_VARSUBST_VAR;
-			}
-			c+=3;
-			if (c[0] == '_' && c[1] == '(') {
-				mode = WEB_VARSUBST_TRANSLATE;
-				c+=2;
-				for (pName = &vName[0];
-				     c < &src[srcLen-1] && *c != ')' &&
-				       isprint(*c) &&
-				       pName < &vName[sizeof(vName)-1];
-				     c++) {
-					*pName = *c;
-					pName++;
-				}
-				c++;
-			} else {
-				for (pName = &vName[0];
-				     c < &src[srcLen-1] && VarNameChar(*c) &&
-				       pName < &vName[sizeof(vName)-1];
-				     c++, pName++) {
-					*pName = *c;
-				}
-			}
-			*pName = '\0';
-		} else if (*c == '$') {
-			mode = (c[1]=='$') ? WEB_VARSUBST_ESCAPE :
-				             WEB_VARSUBST_VAR;
-			c++;
-			if (c[0] == '_' && c[1] == '(') {
-				mode = WEB_VARSUBST_TRANSLATE;
-				c+=2;
-				for (pName = &vName[0];
-				     c < &src[srcLen-1] && *c != ')' &&
-				       isprint(*c) &&
-				       pName < &vName[sizeof(vName)-1];
-				     c++) {
-					*pName = *c;
-					pName++;
-				}
-				c++;
-			} else {
-				for (pName = &vName[0];
-				     c < &src[srcLen-1] && VarNameChar(*c) &&
-				       pName < &vName[sizeof(vName)-1];
-				     c++, pName++) {
-					*pName = *c;
-				}
-			}
-			*pName = '\0';
-		}
-		
-		switch (mode) {
-		case WEB_VARSUBST_NORMAL:
-			cDst = *(c++);
-			WEB_VAR_WriteJSON(q, &cDst, 1);
-			break;
-		case WEB_VARSUBST_ESCAPE:
-			cDst = '$';
-			WEB_VAR_WriteJSON(q, &cDst, 1);
-			WEB_VAR_WriteJSON(q, vName, strlen(vName));
-			break;
-		case WEB_VARSUBST_TRANSLATE:
-#ifdef ENABLE_NLS
-			s = gettext(vName);
-			WEB_VAR_WriteJSON(q, s, strlen(s));
-#else
-			WEB_VAR_WriteJSON(q, vName, strlen(vName));
-#endif
-			break;
-		case WEB_VARSUBST_VAR:
-			if (vName[0] == '\0') {
-				break;
-			}
-			if ((s = Get(vName)) != NULL) {
-				WEB_VAR_WriteJSON(q, s, strlen(s));
-			} else {
-				WEB_LogErr("Uninitialized: $%s", vName);
-			}
-			break;
+	for (i = 0; i < WEB_TEMPLATE_HASH_SIZE; i++) {
+		for (t = webTemplates[i]; t != NULL; t = tNext) {
+			tNext = t->next;
+			FreeTemplate(t);
+			free(t);
 		}
+		webTemplates[i] = NULL;
 	}
+	webTemplateCount = 0;
 }
@@ -138,7 +138,7 @@ SG_NodeEdit(void *obj)
 	SG_Node *node = obj;
 	AG_Window *win;
 	void *wEdit;
-	AG_ObjectClass **hier;
+	AG_ObjectClass *const *hier;
 	int i, nHier;
 
 	if ((win = AG_WindowNew(0)) == NULL) {
@@ -146,13 +146,13 @@ SG_NodeEdit(void *obj)
 	}
 	AG_WindowSetCaptionS(win, OBJECT(node)->name);
 	
-	if (AG_ObjectGetInheritHier(node, &hier, &nHier) != 0) {
+	if ((hier = AG_ObjectGetClassHier(node, &nHier)) == NULL) {
 		AG_FatalError(NULL);
 	}
 	for (i = 0; i < nHier; i++) {
 		SG_NodeClass *nc = (SG_NodeClass *)hier[i];
 
-		if (!AG_ClassIsNamed(hier[i], "SG_Node:*") ||
+		if (!AG_ClassIsA(hier[i], &sgNodeClass) ||
 		    nc->edit == NULL)
 			continue;
 
@@ -160,7 +160,6 @@ SG_NodeEdit(void *obj)
 		if (wEdit != NULL && AG_WIDGET_ISA(wEdit))
 			AG_ObjectAttach(win, wEdit);
 	}
-	Free(hier);
 	return (win);
 }
 
@@ -236,7 +235,7 @@ SG_GetNodeTransformInverse(void *obj, M_Matrix44 *T)
 void
 SG_NodeDraw(SG *sg, SG_Node *node, SG_View *view)
 {
-	AG_ObjectClass **hier;
+	AG_ObjectClass *const *hier;
 	int i, nHier;
 	M_Matrix44 Tsave, T;
 	SG_Node *chld;
@@ -248,13 +247,13 @@ SG_NodeDraw(SG *sg, SG_Node *node, SG_View *view)
 	AG_ObjectLock(node);
 
 	/* Render this node. */
-	if (AG_ObjectGetInheritHier(node, &hier, &nHier) != 0) {
+	if ((hier = AG_ObjectGetClassHier(node, &nHier)) == NULL) {
 		AG_FatalError(NULL);
 	}
 	for (i = nHier-1; i >= 0; i--) {
 		SG_NodeClass *nc = (SG_NodeClass *)hier[i];
 
-		if (!AG_ClassIsNamed(hier[i], "SG_Node:*") ||
+		if (!AG_ClassIsA(hier[i], &sgNodeClass) ||
 		    nc->draw == NULL) {
 			continue;
 		}
@@ -269,7 +268,6 @@ SG_NodeDraw(SG *sg, SG_Node *node, SG_View *view)
 	AG_ObjectUnlock(node);
 
 	GL_LoadMatrixv(&Tsave);
-	Free(hier);
 }
 
 /* Save node data (and child nodes) to a data source. */
@@ -8,6 +8,11 @@ MANLINKS+=SK.3:SK_NodeDetach.3
 MANLINKS+=SK.3:SK_Scalev.3
 MANLINKS+=SK.3:SK_Rotatev.3
 MANLINKS+=SK.3:SK_GetNodeTransform.3
+MANLINKS+=SK.3:SK_FindNode.3
+MANLINKS+=SK.3:SK_FindNodeByName.3
+MANLINKS+=SK.3:SK_GenNodeName.3
+MANLINKS+=SK.3:SK_ProximitySearch.3
+MANLINKS+=SK.3:SK_NodeChanged.3
 MANLINKS+=SK_View.3:SK_ViewNew.3
 MANLINKS+=SK_View.3:SK_ViewZoom.3
 MANLINKS+=SK_View.3:SK_ViewRegTool.3
@@ -69,6 +69,7 @@ SK_NodeOps skNodeOps = {
 	NULL,			/* delete */
 	NULL,			/* move */
 	NULL,			/* constrained */
+	NULL,			/* extent */
 };
 
 SK_NodeOps **skElements = NULL;
@@ -127,6 +128,772 @@ SK_NodeOfClass(void *pNode, const char *cname)
 	return (SK_NodeOfClassGeneral(node, cname));	/* General case */
 }
 
+/*
+ * Hash tables of nodes by class and handle, and by name. Where several
+ * nodes match, lookups return the earliest inserted one (which is also the
+ * first one in the list of nodes).
+ */
+static __inline__ Uint32
+HashBytes(Uint32 h, const void *_Nonnull p, AG_Size len)
+{
+	const Uchar *c = p, *cEnd = &c[len];
+
+	for (; c < cEnd; c++) {
+		h ^= *c;
+		h *= 16777619U;
+	}
+	return (h);
+}
+static __inline__ Uint32
+HashStr(Uint32 h, const char *_Nonnull s)
+{
+	const Uchar *c;
+
+	for (c = (const Uchar *)s; *c != '\0'; c++) {
+		h ^= *c;
+		h *= 16777619U;
+	}
+	return (h);
+}
+static __inline__ Uint32
+HashHandle(const char *_Nonnull type, Uint handle)
+{
+	const Uint32 h32 = (Uint32)handle;
+
+	return HashBytes(HashStr(2166136261U, type), &h32, sizeof(Uint32));
+}
+static __inline__ Uint32
+HashPtr(const void *_Nonnull p)
+{
+	return HashBytes(2166136261U, &p, sizeof(void *));
+}
+static __inline__ Uint32
+HashNode(const SK_Node *_Nonnull node, int byName)
+{
+	return (byName) ? HashStr(2166136261U, node->name) :
+	                  HashHandle(node->ops->name, node->handle);
+}
+
+#define NODE_NEXT(n,byName) (*((byName) ? &(n)->hashName : &(n)->hashHandle))
+
+static void
+NodeTableInsert(SK_NodeTable *_Nonnull t, SK_Node *_Nonnull node, int byName)
+{
+	SK_Node **bucket;
+
+	if (t->nEnts >= t->nBuckets) {
+		Uint nBucketsNew = (t->nBuckets > 0) ? (t->nBuckets << 1) : 64;
+		SK_Node **bucketsNew, *nOld, *nNext;
+		Uint i;
+
+		bucketsNew = Malloc(nBucketsNew*sizeof(SK_Node *));
+		memset(bucketsNew, 0, nBucketsNew*sizeof(SK_Node *));
+		for (i = 0; i < t->nBuckets; i++) {
+			for (nOld = t->buckets[i]; nOld != NULL; nOld = nNext) {
+				nNext = NODE_NEXT(nOld,byName);
+				bucket = &bucketsNew[HashNode(nOld,byName) &
+				                     (nBucketsNew-1)];
+				NODE_NEXT(nOld,byName) = *bucket;
+				*bucket = nOld;
+			}
+		}
+		Free(t->buckets);
+		t->buckets = bucketsNew;
+		t->nBuckets = nBucketsNew;
+	}
+	bucket = &t->buckets[HashNode(node,byName) & (t->nBuckets-1)];
+	NODE_NEXT(node,byName) = *bucket;
+	*bucket = node;
+	t->nEnts++;
+}
+
+/*
+ * Remove a node from a table. Return 1 if it was found. If the key has
+ * been modified since insertion, fall back to scanning all buckets.
+ */
+static int
+NodeTableRemove(SK_NodeTable *_Nonnull t, SK_Node *_Nonnull node, int byName)
+{
+	SK_Node **pn;
+	Uint i, iHash;
+
+	if (t->nBuckets == 0) {
+		return (0);
+	}
+	iHash = HashNode(node,byName) & (t->nBuckets-1);
+	for (i = 0; i < t->nBuckets; i++) {
+		for (pn = &t->buckets[(iHash + i) & (t->nBuckets-1)];
+		     *pn != NULL;
+		     pn = &NODE_NEXT(*pn,byName)) {
+			if (*pn == node) {
+				*pn = NODE_NEXT(node,byName);
+				t->nEnts--;
+				return (1);
+			}
+		}
+	}
+	return (0);
+}
+
+static void
+NodeTableClear(SK_NodeTable *_Nonnull t)
+{
+	Free(t->buckets);
+	t->buckets = NULL;
+	t->nBuckets = 0;
+	t->nEnts = 0;
+}
+
+/* Return the handle hint for the given node class (or NULL). */
+static SK_HandleHint *_Nullable
+LookupHandleHint(SK *_Nonnull sk, const char *_Nonnull type)
+{
+	Uint i;
+
+	for (i = 0; i < sk->nHints; i++) {
+		if (strcmp(sk->hints[i].type, type) == 0)
+			return (&sk->hints[i]);
+	}
+	return (NULL);
+}
+
+/*
+ * Spatial index. Nodes with a proximity() operation are entered into the
+ * cells of a uniform grid covering their extent() box. Nodes without an
+ * extent, too large or outside of the grids go into an unbounded list
+ * which is tested by every query.
+ *
+ * Index entries depend on the position of the referenced nodes and parent
+ * nodes. Reverse references ("links") are kept so that a change to a node
+ * can be propagated to all nodes whose geometry depends on it.
+ */
+typedef struct sk_index_link {
+	SK_Node *_Nonnull ref;			/* Referenced node (key) */
+	SK_Node *_Nonnull user;			/* Referencing node */
+	struct sk_index_link *_Nullable next;	/* In bucket */
+	struct sk_index_link *_Nullable nextUser; /* Next link of user */
+} SK_IndexLink;
+
+#define INDEX_BUILT(idx) ((idx)->grids[0].cells != NULL)
+
+/* Nodes in the list of a sketch (the root has no parent). */
+#define NODE_ATTACHED(sk,n) ((n)->pNode != NULL || (n) == (sk)->root)
+
+static __inline__ Uint
+LinkBucket(Uint nBuckets, const SK_Node *_Nonnull ref)
+{
+	return (HashPtr(ref) & (nBuckets-1));
+}
+
+/* Record that the geometry of user depends on ref. */
+static void
+AddLink(SK *_Nonnull sk, SK_Node *_Nonnull user, SK_Node *_Nonnull ref)
+{
+	SK_Index *idx = &sk->index;
+	SK_IndexLink *link, **bucket;
+
+	if (idx->nLinks >= idx->nLinkBuckets) {
+		Uint nBucketsNew = (idx->nLinkBuckets > 0) ?
+		                   (idx->nLinkBuckets << 1) : 64;
+		SK_IndexLink **bucketsNew, *linkNext;
+		Uint i;
+
+		bucketsNew = Malloc(nBucketsNew*sizeof(SK_IndexLink *));
+		memset(bucketsNew, 0, nBucketsNew*sizeof(SK_IndexLink *));
+		for (i = 0; i < idx->nLinkBuckets; i++) {
+			for (link = idx->links[i]; link != NULL; link = linkNext) {
+				linkNext = link->next;
+				bucket = &bucketsNew[LinkBucket(nBucketsNew,
+				                                link->ref)];
+				link->next = *bucket;
+				*bucket = link;
+			}
+		}
+		Free(idx->links);
+		idx->links = bucketsNew;
+		idx->nLinkBuckets = nBucketsNew;
+	}
+	link = Malloc(sizeof(SK_IndexLink));
+	link->ref = ref;
+	link->user = user;
+	bucket = &idx->links[LinkBucket(idx->nLinkBuckets, ref)];
+	link->next = *bucket;
+	*bucket = link;
+	link->nextUser = user->idxLinks;
+	user->idxLinks = link;
+	idx->nLinks++;
+}
+
+static void
+UnlinkBucket(SK_Index *_Nonnull idx, SK_IndexLink *_Nonnull link)
+{
+	SK_IndexLink **pLink;
+
+	for (pLink = &idx->links[LinkBucket(idx->nLinkBuckets, link->ref)];
+	     *pLink != NULL;
+	     pLink = &(*pLink)->next) {
+		if (*pLink == link) {
+			*pLink = link->next;
+			idx->nLinks--;
+			break;
+		}
+	}
+}
+
+/* Forget one dependency of user on ref. */
+static void
+DelLink(SK *_Nonnull sk, SK_Node *_Nonnull user, SK_Node *_Nonnull ref)
+{
+	SK_IndexLink **pLink, *link;
+
+	for (pLink = &user->idxLinks;
+	     (link = *pLink) != NULL;
+	     pLink = &link->nextUser) {
+		if (link->ref == ref) {
+			*pLink = link->nextUser;
+			UnlinkBucket(&sk->index, link);
+			Free(link);
+			break;
+		}
+	}
+}
+
+/* Forget all dependencies of user. */
+static void
+DelLinks(SK *_Nonnull sk, SK_Node *_Nonnull user)
+{
+	SK_IndexLink *link, *linkNext;
+
+	for (link = user->idxLinks; link != NULL; link = linkNext) {
+		linkNext = link->nextUser;
+		UnlinkBucket(&sk->index, link);
+		Free(link);
+	}
+	user->idxLinks = NULL;
+}
+
+static void
+CellInsert(SK_IndexCell *_Nonnull cell, SK_Node *_Nonnull node)
+{
+	if (cell->nNodes+1 > cell->maxNodes) {
+		cell->maxNodes = (cell->maxNodes > 0) ? (cell->maxNodes << 1) : 4;
+		cell->nodes = Realloc(cell->nodes,
+		    cell->maxNodes*sizeof(SK_Node *));
+	}
+	cell->nodes[cell->nNodes++] = node;
+}
+
+static void
+CellRemove(SK_IndexCell *_Nonnull cell, SK_Node *_Nonnull node)
+{
+	Uint i;
+
+	for (i = 0; i < cell->nNodes; i++) {
+		if (cell->nodes[i] == node) {
+			cell->nodes[i] = cell->nodes[--cell->nNodes];
+			break;
+		}
+	}
+}
+
+/* Remove a node from the cells, unbounded list or dirty list. */
+static void
+IndexRemove(SK *_Nonnull sk, SK_Node *_Nonnull node)
+{
+	SK_Index *idx = &sk->index;
+	int x, y;
+
+	if (node->flags & SK_NODE_INDEXED) {
+		SK_IndexGrid *grid = &idx->grids[node->idxLevel];
+
+		for (y = node->idxCells[1]; y <= node->idxCells[3]; y++)
+			for (x = node->idxCells[0]; x <= node->idxCells[2]; x++)
+				CellRemove(&grid->cells[y*grid->w + x], node);
+	} else if (node->flags & SK_NODE_UNBOUNDED) {
+		TAILQ_REMOVE(&idx->unbounded, node, idx);
+		idx->nUnbounded--;
+	} else if (node->flags & SK_NODE_DIRTY) {
+		TAILQ_REMOVE(&idx->dirty, node, idx);
+	}
+	node->flags &= ~(SK_NODE_INDEX_FLAGS);
+}
+
+/* Compute the extent of a node. Return -1 if it is unbounded. */
+static int
+NodeExtent(SK_Node *_Nonnull node)
+{
+	M_Vector3 a, b;
+
+	if (node->ops->extent == NULL) {
+		return (-1);
+	}
+	node->ops->extent(node, &a, &b);
+
+	if (!(b.x - a.x >= 0.0 && b.x - a.x <= M_HUGEVAL &&
+	      b.y - a.y >= 0.0 && b.y - a.y <= M_HUGEVAL)) {
+		return (-1);
+	}
+	node->idxMin.x = a.x;
+	node->idxMin.y = a.y;
+	node->idxMax.x = b.x;
+	node->idxMax.y = b.y;
+	node->flags |= SK_NODE_EXTENT;
+	return (0);
+}
+
+/*
+ * Enter a node with a computed extent into the cells it overlaps, in the
+ * finest grid where it covers at most SK_INDEX_MAX_CELLS cells.
+ */
+static void
+PlaceNode(SK_Index *_Nonnull idx, SK_Node *_Nonnull node)
+{
+	int *c = node->idxCells, i, x, y;
+
+	for (i = 0; i < SK_INDEX_LEVELS; i++) {
+		SK_IndexGrid *grid = &idx->grids[i];
+		const M_Real cs = grid->cellSize;
+		const M_Real x1 = (node->idxMin.x - idx->x)/cs;
+		const M_Real y1 = (node->idxMin.y - idx->y)/cs;
+		const M_Real x2 = (node->idxMax.x - idx->x)/cs;
+		const M_Real y2 = (node->idxMax.y - idx->y)/cs;
+
+		if (!(x1 >= 0.0 && y1 >= 0.0 &&
+		      x2 < (M_Real)grid->w && y2 < (M_Real)grid->h)) {
+			break;				/* Outside of grids */
+		}
+		c[0] = (int)x1;
+		c[1] = (int)y1;
+		c[2] = (int)x2;
+		c[3] = (int)y2;
+		if ((c[2]-c[0]+1)*(c[3]-c[1]+1) > SK_INDEX_MAX_CELLS) {
+			continue;
+		}
+		for (y = c[1]; y <= c[3]; y++) {
+			for (x = c[0]; x <= c[2]; x++)
+				CellInsert(&grid->cells[y*grid->w + x], node);
+		}
+		node->idxLevel = i;
+		node->flags |= SK_NODE_INDEXED;
+		return;
+	}
+	TAILQ_INSERT_TAIL(&idx->unbounded, node, idx);
+	node->flags |= SK_NODE_UNBOUNDED;
+	idx->nUnbounded++;
+}
+
+/* Free the spatial index. It will be rebuilt by the next query. */
+static void
+IndexClear(SK *_Nonnull sk)
+{
+	SK_Index *idx = &sk->index;
+	SK_IndexLink *link, *linkNext;
+	SK_Node *node;
+	Uint i;
+	int l;
+
+	if (!INDEX_BUILT(idx)) {
+		return;
+	}
+	TAILQ_FOREACH(node, &sk->nodes, nodes) {
+		node->flags &= ~(SK_NODE_INDEX_FLAGS);
+		node->idxLinks = NULL;
+	}
+	for (l = 0; l < SK_INDEX_LEVELS; l++) {
+		SK_IndexGrid *grid = &idx->grids[l];
+
+		for (i = 0; i < (Uint)(grid->w*grid->h); i++) {
+			Free(grid->cells[i].nodes);
+		}
+		Free(grid->cells);
+		grid->cells = NULL;
+	}
+
+	for (i = 0; i < idx->nLinkBuckets; i++) {
+		for (link = idx->links[i]; link != NULL; link = linkNext) {
+			linkNext = link->next;
+			Free(link);
+		}
+	}
+	Free(idx->links);
+	idx->links = NULL;
+	idx->nLinkBuckets = 0;
+	idx->nLinks = 0;
+
+	TAILQ_INIT(&idx->unbounded);
+	TAILQ_INIT(&idx->dirty);
+	idx->nUnbounded = 0;
+}
+
+/*
+ * Build the spatial index. The cell size is chosen from the node density
+ * and the mean node size, such that a typical node covers few cells.
+ */
+static void
+IndexBuild(SK *_Nonnull sk)
+{
+	SK_Index *idx = &sk->index;
+	SK_Node *node;
+	M_Vector2 vMin, vMax;
+	M_Real w, h, cs, size, sizeSum = 0.0;
+	Uint i, nBounded = 0, nCellsMax;
+	int l;
+
+	IndexClear(sk);
+
+	vMin.x = vMin.y = M_HUGEVAL;
+	vMax.x = vMax.y = -M_HUGEVAL;
+	TAILQ_FOREACH(node, &sk->nodes, nodes) {
+		for (i = 0; i < node->nRefNodes; i++) {
+			AddLink(sk, node, node->refNodes[i]);
+		}
+		if (node->ops->proximity == NULL) {
+			continue;
+		}
+		if (NodeExtent(node) == -1) {
+			TAILQ_INSERT_TAIL(&idx->unbounded, node, idx);
+			node->flags |= SK_NODE_UNBOUNDED;
+			idx->nUnbounded++;
+			continue;
+		}
+		node->flags |= SK_NODE_DIRTY;		/* Place below */
+		if (node->idxMin.x < vMin.x) { vMin.x = node->idxMin.x; }
+		if (node->idxMin.y < vMin.y) { vMin.y = node->idxMin.y; }
+		if (node->idxMax.x > vMax.x) { vMax.x = node->idxMax.x; }
+		if (node->idxMax.y > vMax.y) { vMax.y = node->idxMax.y; }
+		nBounded++;
+	}
+	w = vMax.x - vMin.x;
+	h = vMax.y - vMin.y;
+	if (nBounded == 0 || !(w <= M_HUGEVAL && h <= M_HUGEVAL)) {
+		vMin.x = vMin.y = 0.0;
+		w = h = 0.0;
+	}
+
+	/*
+	 * Start from the mean spacing between nodes, and grow the cells to
+	 * the mean node size (ignoring the few largest nodes, which will
+	 * end up in the coarser grids anyway).
+	 */
+	nCellsMax = (nBounded << 2) + 16;
+	cs = M_Sqrt(w*h / (M_Real)(nBounded+1));
+	if (!(cs > 0.0 && cs <= M_HUGEVAL)) {
+		cs = 1.0;
+	}
+	if (nBounded > 0) {
+		TAILQ_FOREACH(node, &sk->nodes, nodes) {
+			if (!(node->flags & SK_NODE_DIRTY)) {
+				continue;
+			}
+			size = MAX(node->idxMax.x - node->idxMin.x,
+			           node->idxMax.y - node->idxMin.y);
+			sizeSum += MIN(size, cs*4.0);
+		}
+		if (cs < sizeSum/(M_Real)nBounded)
+			cs = sizeSum/(M_Real)nBounded;
+	}
+	while ((w/cs + 1.0)*(h/cs + 1.0) > (M_Real)nCellsMax)
+		cs *= 2.0;
+
+	idx->x = vMin.x;
+	idx->y = vMin.y;
+	for (l = 0; l < SK_INDEX_LEVELS; l++) {
+		SK_IndexGrid *grid = &idx->grids[l];
+		AG_Size len;
+
+		grid->cellSize = cs;
+		grid->w = (int)(w/cs) + 1;
+		grid->h = (int)(h/cs) + 1;
+		len = (AG_Size)grid->w*grid->h*sizeof(SK_IndexCell);
+		grid->cells = Malloc(len);
+		memset(grid->cells, 0, len);
+		cs *= 8.0;
+	}
+
+	TAILQ_FOREACH(node, &sk->nodes, nodes) {
+		if (node->flags & SK_NODE_DIRTY) {
+			node->flags &= ~(SK_NODE_DIRTY);
+			PlaceNode(idx, node);
+		}
+	}
+	idx->nBuilt = sk->handles.nEnts;
+	idx->nBuiltUnbounded = idx->nUnbounded;
+}
+
+/*
+ * Bring the spatial index up to date, reindexing the dirty nodes. Rebuild
+ * it if the sketch has grown or shrunk significantly, or if too many nodes
+ * have moved out of the grids.
+ */
+static void
+IndexUpdate(SK *_Nonnull sk)
+{
+	SK_Index *idx = &sk->index;
+	const Uint nNodes = sk->handles.nEnts;
+	SK_Node *node;
+
+	if (!INDEX_BUILT(idx) ||
+	    nNodes > (idx->nBuilt << 1) + 64 ||
+	    (nNodes << 2) + 64 < idx->nBuilt) {
+		IndexBuild(sk);
+		return;
+	}
+	while ((node = TAILQ_FIRST(&idx->dirty)) != NULL) {
+		TAILQ_REMOVE(&idx->dirty, node, idx);
+		node->flags &= ~(SK_NODE_DIRTY);
+		if (node->ops->proximity == NULL) {
+			continue;
+		}
+		if (NodeExtent(node) == 0) {
+			PlaceNode(idx, node);
+		} else {
+			TAILQ_INSERT_TAIL(&idx->unbounded, node, idx);
+			node->flags |= SK_NODE_UNBOUNDED;
+			idx->nUnbounded++;
+		}
+	}
+	if (idx->nUnbounded > (idx->nBuiltUnbounded << 1) + 64)
+		IndexBuild(sk);
+}
+
+/* Schedule a node, its descendants and its users for reindexing. */
+static void
+MarkDirty(SK *_Nonnull sk, SK_Node *_Nonnull node)
+{
+	SK_Index *idx = &sk->index;
+	SK_IndexLink *link;
+	SK_Node *cnode;
+
+	if (node->flags & SK_NODE_DIRTY) {
+		return;
+	}
+	IndexRemove(sk, node);
+	TAILQ_INSERT_TAIL(&idx->dirty, node, idx);
+	node->flags |= SK_NODE_DIRTY;
+
+	TAILQ_FOREACH(cnode, &node->cnodes, sknodes) {
+		MarkDirty(sk, cnode);
+	}
+	if (idx->nLinkBuckets > 0) {
+		for (link = idx->links[LinkBucket(idx->nLinkBuckets, node)];
+		     link != NULL;
+		     link = link->next) {
+			if (link->ref == node)
+				MarkDirty(sk, link->user);
+		}
+	}
+}
+
+/* Enter a node into the lookup tables and spatial index of a sketch. */
+static void
+EnterNode(SK *_Nonnull sk, SK_Node *_Nonnull node)
+{
+	Uint i;
+
+	node->stamp = 0;
+	NodeTableInsert(&sk->handles, node, 0);
+	NodeTableInsert(&sk->names, node, 1);
+	if (INDEX_BUILT(&sk->index)) {
+		for (i = 0; i < node->nRefNodes; i++) {
+			AddLink(sk, node, node->refNodes[i]);
+		}
+		MarkDirty(sk, node);
+	}
+}
+
+/* Enter a node into the list and lookup tables of a sketch. */
+static void
+InsertNode(SK *_Nonnull sk, SK_Node *_Nonnull node)
+{
+	TAILQ_INSERT_TAIL(&sk->nodes, node, nodes);
+	node->seq = sk->nodeSeq++;
+	EnterNode(sk, node);
+}
+
+/* Remove a node from the list and lookup tables of a sketch. */
+static void
+RemoveNode(SK *_Nonnull sk, SK_Node *_Nonnull node)
+{
+	SK_HandleHint *hint;
+
+	if (INDEX_BUILT(&sk->index)) {
+		IndexRemove(sk, node);
+		DelLinks(sk, node);
+	}
+	NodeTableRemove(&sk->handles, node, 0);
+	NodeTableRemove(&sk->names, node, 1);
+	if ((hint = LookupHandleHint(sk, node->ops->name)) != NULL &&
+	    node->handle < hint->handle) {
+		hint->handle = node->handle;
+	}
+	TAILQ_REMOVE(&sk->nodes, node, nodes);
+}
+
+/*
+ * Free the lookup tables and spatial index of a sketch. The index must be
+ * cleared (with IndexClear()) while the nodes are still allocated.
+ */
+static void
+ClearNodeTables(SK *_Nonnull sk)
+{
+	IndexClear(sk);
+	NodeTableClear(&sk->handles);
+	NodeTableClear(&sk->names);
+	Free(sk->hints);
+	sk->hints = NULL;
+	sk->nHints = 0;
+	sk->nodeSeq = 1;
+}
+
+/*
+ * Signal a change in the geometry of a node which was not made through
+ * the transformation macros (e.g., a direct update to the parameters of
+ * its class).
+ */
+void
+SK_NodeChanged(void *p)
+{
+	SK_Node *node = p;
+	SK *sk = node->sk;
+
+	if (sk == NULL) {
+		return;
+	}
+	AG_ObjectLock(sk);
+	if (INDEX_BUILT(&sk->index) && NODE_ATTACHED(sk, node)) {
+		MarkDirty(sk, node);
+	}
+	AG_ObjectUnlock(sk);
+}
+
+/*
+ * Table of constraint edges by incident node, allowing the edges of a
+ * cluster involving a given node to be found without scanning the entire
+ * cluster. Each list follows the order of the cluster's edges.
+ */
+SK_ClusterNode *
+SK_ClusterLookup(const SK_Cluster *cl, const SK_Node *node)
+{
+	SK_ClusterNode *ent;
+
+	if (cl->nNodeBuckets == 0) {
+		return (NULL);
+	}
+	for (ent = cl->nodeTbl[HashPtr(node) & (cl->nNodeBuckets-1)];
+	     ent != NULL;
+	     ent = ent->next) {
+		if (ent->node == node)
+			return (ent);
+	}
+	return (NULL);
+}
+
+static void
+AddIncidence(SK_Cluster *_Nonnull cl, SK_Node *_Nonnull node,
+    SK_Constraint *_Nonnull ct)
+{
+	SK_ClusterNode *ent, **bucket;
+
+	if ((ent = SK_ClusterLookup(cl, node)) == NULL) {
+		if (cl->nNodes >= cl->nNodeBuckets) {
+			Uint nBucketsNew = (cl->nNodeBuckets > 0) ?
+			                   (cl->nNodeBuckets << 1) : 16;
+			SK_ClusterNode **bucketsNew, *entNext;
+			Uint i;
+
+			bucketsNew = Malloc(nBucketsNew*sizeof(SK_ClusterNode *));
+			memset(bucketsNew, 0, nBucketsNew*sizeof(SK_ClusterNode *));
+			for (i = 0; i < cl->nNodeBuckets; i++) {
+				for (ent = cl->nodeTbl[i]; ent != NULL;
+				     ent = entNext) {
+					entNext = ent->next;
+					bucket = &bucketsNew[HashPtr(ent->node) &
+					                     (nBucketsNew-1)];
+					ent->next = *bucket;
+					*bucket = ent;
+				}
+			}
+			Free(cl->nodeTbl);
+			cl->nodeTbl = bucketsNew;
+			cl->nNodeBuckets = nBucketsNew;
+		}
+		ent = Malloc(sizeof(SK_ClusterNode));
+		ent->node = node;
+		ent->edges = NULL;
+		ent->nEdges = 0;
+		ent->maxEdges = 0;
+		bucket = &cl->nodeTbl[HashPtr(node) & (cl->nNodeBuckets-1)];
+		ent->next = *bucket;
+		*bucket = ent;
+		cl->nNodes++;
+	}
+	if (ent->nEdges+1 > ent->maxEdges) {
+		ent->maxEdges = (ent->maxEdges > 0) ? (ent->maxEdges << 1) : 4;
+		ent->edges = Realloc(ent->edges,
+		    ent->maxEdges*sizeof(SK_Constraint *));
+	}
+	ent->edges[ent->nEdges++] = ct;
+}
+
+static void
+DelIncidence(SK_Cluster *_Nonnull cl, const SK_Node *_Nonnull node,
+    const SK_Constraint *_Nonnull ct)
+{
+	SK_ClusterNode **pEnt, *ent;
+	Uint i;
+
+	if (cl->nNodeBuckets == 0) {
+		return;
+	}
+	for (pEnt = &cl->nodeTbl[HashPtr(node) & (cl->nNodeBuckets-1)];
+	     (ent = *pEnt) != NULL;
+	     pEnt = &ent->next) {
+		if (ent->node == node)
+			break;
+	}
+	if (ent == NULL) {
+		return;
+	}
+	for (i = 0; i < ent->nEdges; i++) {
+		if (ent->edges[i] != ct) {
+			continue;
+		}
+		if (i < ent->nEdges-1) {
+			memmove(&ent->edges[i], &ent->edges[i+1],
+			    (ent->nEdges - i - 1)*sizeof(SK_Constraint *));
+		}
+		ent->nEdges--;
+		break;
+	}
+	if (ent->nEdges == 0) {
+		*pEnt = ent->next;
+		Free(ent->edges);
+		Free(ent);
+		cl->nNodes--;
+	}
+}
+
+/* Insert an edge into a cluster. */
+static void
+ClusterInsert(SK_Cluster *_Nonnull cl, SK_Constraint *_Nonnull ct)
+{
+	TAILQ_INSERT_TAIL(&cl->edges, ct, constraints);
+	AddIncidence(cl, ct->n1, ct);
+	if (ct->n2 != ct->n1)
+		AddIncidence(cl, ct->n2, ct);
+}
+
+/* Remove an edge from a cluster. */
+static void
+ClusterRemove(SK_Cluster *_Nonnull cl, SK_Constraint *_Nonnull ct)
+{
+	DelIncidence(cl, ct->n1, ct);
+	if (ct->n2 != ct->n1) {
+		DelIncidence(cl, ct->n2, ct);
+	}
+	TAILQ_REMOVE(&cl->edges, ct, constraints);
+}
+
 /*
  * Register the SK classes with the Agar object system, and also register
  * the default SK node classes.
@@ -199,7 +966,9 @@ SK_InitRoot(SK *_Nonnull sk)
 	SK_PointColor(pt, M_ColorRGB(1.0, 1.0, 0.0));
 	SKNODE(pt)->sk = sk;
 	SKNODE(pt)->flags |= SK_NODE_FIXED;
-	TAILQ_INSERT_TAIL(&sk->nodes, sk->root, nodes);
+	TAILQ_INSERT_HEAD(&sk->nodes, sk->root, nodes);
+	sk->root->seq = 0;
+	EnterNode(sk, sk->root);
 }
 
 static void
@@ -216,6 +985,19 @@ Init(void *_Nonnull obj)
 	TAILQ_INIT(&sk->clusters);
 	TAILQ_INIT(&sk->insns);
 
+	sk->nodeSeq = 1;
+	sk->nHints = 0;
+	sk->hints = NULL;
+	memset(&sk->handles, 0, sizeof(SK_NodeTable));
+	memset(&sk->names, 0, sizeof(SK_NodeTable));
+	sk->clusterTbl = NULL;
+	sk->nClusterBuckets = 0;
+	sk->nClusterEnts = 0;
+	sk->clusterHint = 1;
+	memset(&sk->index, 0, sizeof(SK_Index));
+	TAILQ_INIT(&sk->index.unbounded);
+	TAILQ_INIT(&sk->index.dirty);
+
 	if ((un = AG_FindUnit("mm")) == NULL) {
 		AG_FatalError(NULL);
 	}
@@ -226,16 +1008,30 @@ Init(void *_Nonnull obj)
 	SK_InitRoot(sk);
 }
 
-/* Allocate a new node name. */
+/*
+ * Allocate a new node name. The search starts from the lowest handle which
+ * may be available for the class (names below it are known to be taken).
+ */
 Uint
 SK_GenNodeName(SK *sk, const char *type)
 {
-	Uint name = 1;
+	SK_HandleHint *hint;
+	Uint name;
 
-	while (SK_FindNode(sk, name, type) != NULL) {
-		if (++name >= SK_NAME_MAX)
+	if ((hint = LookupHandleHint(sk, type)) == NULL) {
+		sk->hints = Realloc(sk->hints, (sk->nHints+1) *
+		                               sizeof(SK_HandleHint));
+		hint = &sk->hints[sk->nHints++];
+		Strlcpy(hint->type, type, sizeof(hint->type));
+		hint->handle = 1;
+	}
+	for (name = hint->handle;
+	     SK_FindNode(sk, name, type) != NULL;
+	     name++) {
+		if (name+1 >= SK_NAME_MAX)
 			AG_FatalError("Out of node names");
 	}
+	hint->handle = name;
 	return (name);
 }
 
@@ -287,19 +1083,50 @@ SK_NodeInit(void *np, const void *ops, Uint handle, Uint flags)
 	n->nCons = 0;
 	M_MatIdentity44v(&n->T);
 	n->userData = NULL;
+	n->seq = 0;
+	n->clusters = NULL;
+	n->nClusters = 0;
+	n->maxClusters = 0;
+	n->stamp = 0;
+	n->idxLinks = NULL;
 	TAILQ_INIT(&n->cnodes);
 }
 
-/* Change the name string associated with a node. */
+/*
+ * Change the name string associated with a node. The node is also
+ * re-entered into the table of handles, since its handle may have been
+ * modified directly (e.g., by the node editor).
+ */
 void
 SK_NodeSetName(void *p, const char *fmt, ...)
 {
 	SK_Node *node = p;
+	SK *sk = node->sk;
+	SK_HandleHint *hint;
 	va_list ap;
+	int inTable = 0;
 
+	if (sk != NULL) {
+		AG_ObjectLock(sk);
+		if (NodeTableRemove(&sk->names, node, 1)) {
+			NodeTableRemove(&sk->handles, node, 0);
+			inTable = 1;
+		}
+	}
 	va_start(ap, fmt);
 	AG_Vsnprintf(node->name, sizeof(node->name), fmt, ap);
 	va_end(ap);
+
+	if (sk != NULL) {
+		if (inTable) {
+			NodeTableInsert(&sk->names, node, 1);
+			NodeTableInsert(&sk->handles, node, 0);
+			if ((hint = LookupHandleHint(sk, node->ops->name))
+			    != NULL)
+				hint->handle = 1;
+		}
+		AG_ObjectUnlock(sk);
+	}
 }
 
 /* Free a node and detach/free any child nodes. */
@@ -320,6 +1147,7 @@ SK_FreeNode(SK *_Nonnull sk, SK_Node *_Nonnull node)
 	}
 	Free(node->refNodes);
 	Free(node->cons);
+	Free(node->clusters);
 	Free(node);
 }
 
@@ -328,6 +1156,7 @@ Reset(void *_Nonnull obj)
 {
 	SK *sk = obj;
 
+	ClearNodeTables(sk);
 	if (sk->root != NULL) {
 		SK_FreeNode(sk, sk->root);
 		sk->root = NULL;
@@ -340,6 +1169,15 @@ Reset(void *_Nonnull obj)
 	SK_FreeInsns(sk);
 }
 
+static void
+Destroy(void *_Nonnull obj)
+{
+	SK *sk = obj;
+
+	ClearNodeTables(sk);
+	Free(sk->clusterTbl);
+}
+
 static int
 SK_NodeSaveData(SK *_Nonnull sk, SK_Node *_Nonnull node, AG_DataSource *_Nonnull buf)
 {
@@ -372,7 +1210,7 @@ SK_SaveNodeGeneric(SK *_Nonnull sk, SK_Node *_Nonnull node, AG_DataSource *_Nonn
 
 	AG_WriteUint32(buf, node->handle);
 	AG_WriteString(buf, node->name);
-	AG_WriteUint16(buf, (Uint16)node->flags);
+	AG_WriteUint16(buf, (Uint16)(node->flags & ~(SK_NODE_INDEX_FLAGS)));
 	M_WriteMatrix44(buf, &node->T);
 
 	/* Save the child nodes recursively. */
@@ -497,7 +1335,7 @@ SK_LoadNodeGeneric(SK *_Nonnull sk, SK_Node *_Nonnull *_Nullable rnode,
 	node->sk = sk;
 
 	AG_CopyString(node->name, buf, sizeof(node->name));
-	node->flags = (Uint)AG_ReadUint16(buf);
+	node->flags = (Uint)AG_ReadUint16(buf) & ~(SK_NODE_INDEX_FLAGS);
 	M_ReadMatrix44v(buf, &node->T);
 
 	/* Load the child nodes recursively. */
@@ -533,6 +1371,7 @@ Load(void *_Nonnull obj, AG_DataSource *_Nonnull buf, const AG_Version *_Nonnull
 	}
 
 	/* Free the existing root node. */
+	ClearNodeTables(sk);
 	if (sk->root != NULL) {
 		SK_FreeNode(sk, sk->root);
 		sk->root = NULL;
@@ -547,6 +1386,8 @@ Load(void *_Nonnull obj, AG_DataSource *_Nonnull buf, const AG_Version *_Nonnull
 		goto fail;
 	}
 	TAILQ_INSERT_HEAD(&sk->nodes, sk->root, nodes);
+	sk->root->seq = 0;
+	EnterNode(sk, sk->root);
 
 	/* Load the data part of all nodes. */
 	if (SK_LoadNodeData(sk, sk->root, buf) == -1)
@@ -572,7 +1413,7 @@ Load(void *_Nonnull obj, AG_DataSource *_Nonnull buf, const AG_Version *_Nonnull
 		}
 		SK_NodeAddConstraint(ct->n1, ct);
 		SK_NodeAddConstraint(ct->n2, ct);
-		TAILQ_INSERT_TAIL(&sk->ctGraph.edges, ct, constraints);
+		ClusterInsert(&sk->ctGraph, ct);
 	}
 	SK_Update(sk);
 	AG_MutexUnlock(&sk->lock);
@@ -675,6 +1516,12 @@ SK_NodeAddReference(void *pNode, void *pOther)
 	                         (node->nRefNodes+1)*sizeof(SK_Node *));
 	node->refNodes[node->nRefNodes++] = other;
 	other->nRefs++;
+
+	if (node->sk != NULL && INDEX_BUILT(&node->sk->index) &&
+	    NODE_ATTACHED(node->sk, node)) {
+		AddLink(node->sk, node, other);
+		MarkDirty(node->sk, node);
+	}
 }
 
 /* Remove a dependency table entry. */
@@ -698,6 +1545,12 @@ SK_NodeDelReference(void *pNode, void *pOther)
 		}
 		node->nRefNodes--;
 		other->nRefs--;
+
+		if (node->sk != NULL && INDEX_BUILT(&node->sk->index) &&
+		    NODE_ATTACHED(node->sk, node)) {
+			DelLink(node->sk, node, other);
+			MarkDirty(node->sk, node);
+		}
 		break;
 	}
 }
@@ -742,12 +1595,20 @@ SK_NodeDelConstraint(void *pNode, SK_Constraint *ct)
 void *
 SK_FindNode(SK *sk, Uint handle, const char *type)
 {
-	SK_Node *node;
-
-	TAILQ_FOREACH(node, &sk->nodes, nodes) {
-		if (node->handle == handle &&
-		    strcmp(node->ops->name, type) == 0)
-			return (node);
+	SK_Node *node, *nFound = NULL;
+
+	if (sk->handles.nBuckets > 0) {
+		for (node = sk->handles.buckets[HashHandle(type, handle) &
+		                                (sk->handles.nBuckets-1)];
+		     node != NULL;
+		     node = node->hashHandle) {
+			if (node->handle == handle &&
+			    strcmp(node->ops->name, type) == 0 &&
+			    (nFound == NULL || node->seq < nFound->seq))
+				nFound = node;
+		}
+		if (nFound != NULL)
+			return (nFound);
 	}
 	AG_SetError("No such node: %u", (Uint)handle);
 	return (NULL);
@@ -757,11 +1618,19 @@ SK_FindNode(SK *sk, Uint handle, const char *type)
 void *
 SK_FindNodeByName(SK *sk, const char *name)
 {
-	SK_Node *node;
+	SK_Node *node, *nFound = NULL;
 
-	TAILQ_FOREACH(node, &sk->nodes, nodes) {
-		if (strcmp(node->name, name) == 0)
-			return (node);
+	if (sk->names.nBuckets > 0) {
+		for (node = sk->names.buckets[HashStr(2166136261U, name) &
+		                              (sk->names.nBuckets-1)];
+		     node != NULL;
+		     node = node->hashName) {
+			if (strcmp(node->name, name) == 0 &&
+			    (nFound == NULL || node->seq < nFound->seq))
+				nFound = node;
+		}
+		if (nFound != NULL)
+			return (nFound);
 	}
 	AG_SetError("No such node: %s", name);
 	return (NULL);
@@ -803,7 +1672,7 @@ SK_NodeAttach(void *ppNode, void *pcNode)
 	cNode->sk = pNode->sk;
 	cNode->pNode = pNode;
 	TAILQ_INSERT_TAIL(&pNode->cnodes, cNode, sknodes);
-	TAILQ_INSERT_TAIL(&pNode->sk->nodes, cNode, nodes);
+	InsertNode(pNode->sk, cNode);
 }
 
 /* Detach a node from its parent in the sketch. */
@@ -814,20 +1683,16 @@ SK_NodeDetach(void *ppNode, void *pcNode)
 	SK_Node *cNode = pcNode;
 	SK_Node *subnode;
 	SK *sk = pNode->sk;
-	SK_Constraint *ct;
+	SK_ClusterNode *ent;
 
 	while ((subnode = TAILQ_FIRST(&cNode->cnodes)) != NULL) {
 		SK_NodeDetach(cNode, subnode);
 	}
-free_constraints:
-	TAILQ_FOREACH(ct, &sk->ctGraph.edges, constraints) {
-		if (ct->n1 == cNode || ct->n2 == cNode) {
-			SK_DelConstraint(&sk->ctGraph, ct);
-			goto free_constraints;
-		}
+	while ((ent = SK_ClusterLookup(&sk->ctGraph, cNode)) != NULL) {
+		SK_DelConstraint(&sk->ctGraph, ent->edges[0]);
 	}
 	TAILQ_REMOVE(&pNode->cnodes, cNode, sknodes);
-	TAILQ_REMOVE(&sk->nodes, cNode, nodes);
+	RemoveNode(sk, cNode);
 	cNode->sk = NULL;
 	cNode->pNode = NULL;
 }
@@ -910,6 +1775,7 @@ SK_NodeDel(void *p)
 {
 	SK_Node *node = p;
 	SK *sk = node->sk;
+	SK_ClusterNode *ent;
 	SK_Constraint *ct;
 
 	if (node == sk->root) {
@@ -927,14 +1793,11 @@ deldims:
 			}
 		}
 	}
-delcts:
-	TAILQ_FOREACH(ct, &sk->ctGraph.edges, constraints) {
-		if (ct->n1 == node || ct->n2 == node) {
-			SK_NodeDelConstraint(ct->n1, ct);
-			SK_NodeDelConstraint(ct->n2, ct);
-			SK_DelConstraint(&sk->ctGraph, ct);
-			goto delcts;
-		}
+	while ((ent = SK_ClusterLookup(&sk->ctGraph, node)) != NULL) {
+		ct = ent->edges[0];
+		SK_NodeDelConstraint(ct->n1, ct);
+		SK_NodeDelConstraint(ct->n2, ct);
+		SK_DelConstraint(&sk->ctGraph, ct);
 	}
 	if (node->nRefs > 0) {
 		AG_SetError("Node is being referenced");
@@ -980,10 +1843,149 @@ SK_SetLengthUnit(SK *sk, const AG_Unit *unit)
 	AG_MutexUnlock(&sk->lock);
 }
 
+/* State of a proximity query. */
+struct sk_index_query {
+	const char *_Nullable type;		/* Class to match (or NULL) */
+	const SK_NodeOps *_Nullable ops;	/* Registered class of type */
+	void *_Nullable ignoreNode;		/* Node to skip */
+	M_Vector3 v;				/* Query point */
+	SK_Node *_Nullable nClosest;		/* Closest node so far */
+	M_Real rClosest;
+	M_Vector3 vClosest;
+	Uint stamp;				/* Visit stamp */
+};
+
+/*
+ * Return 1 if no node at a distance of at least d can improve upon the
+ * current result. We allow for rounding differences between our estimate
+ * and the proximity() operation.
+ */
+static __inline__ int
+QueryPrune(const struct sk_index_query *_Nonnull q, M_Real d)
+{
+	d -= d*1e-5;
+	return (q->nClosest != NULL) ? (d > q->rClosest) :
+	                               (d >= M_INFINITY);
+}
+
+static void
+QueryNode(struct sk_index_query *_Nonnull q, SK_Node *_Nonnull node)
+{
+	M_Vector3 vC;
+	M_Real x, y, p;
+
+	if (node->stamp == q->stamp) {
+		return;
+	}
+	node->stamp = q->stamp;
+
+	if (node == q->ignoreNode) {
+		return;
+	}
+	if (q->type != NULL && node->ops != q->ops &&
+	    strcmp(node->ops->name, q->type) != 0) {
+		return;
+	}
+	if (node->flags & SK_NODE_EXTENT) {
+		/*
+		 * Outside of its extent, the proximity of a node is at least
+		 * the distance to the extent.
+		 */
+		x = (q->v.x < node->idxMin.x) ? node->idxMin.x :
+		    (q->v.x > node->idxMax.x) ? node->idxMax.x : q->v.x;
+		y = (q->v.y < node->idxMin.y) ? node->idxMin.y :
+		    (q->v.y > node->idxMax.y) ? node->idxMax.y : q->v.y;
+		if ((x != q->v.x || y != q->v.y) &&
+		    QueryPrune(q, M_Sqrt((x - q->v.x)*(x - q->v.x) +
+		                         (y - q->v.y)*(y - q->v.y))))
+			return;
+	}
+	p = node->ops->proximity(node, &q->v, &vC);
+	if (p < q->rClosest ||
+	    (p == q->rClosest && q->nClosest != NULL &&
+	     node->seq < q->nClosest->seq)) {
+		q->nClosest = node;
+		q->rClosest = p;
+		q->vClosest.x = vC.x;
+		q->vClosest.y = vC.y;
+	}
+}
+
+static __inline__ void
+QueryCell(struct sk_index_query *_Nonnull q, const SK_IndexCell *_Nonnull cell)
+{
+	Uint i;
+
+	for (i = 0; i < cell->nNodes; i++)
+		QueryNode(q, cell->nodes[i]);
+}
+
+/*
+ * Visit the cells of a grid in rings of increasing size around the query
+ * point, until the distance to the unvisited cells exceeds the distance
+ * of the closest node found.
+ */
+static void
+QueryGrid(struct sk_index_query *_Nonnull q, const SK_Index *_Nonnull idx,
+    const SK_IndexGrid *_Nonnull grid)
+{
+	const M_Vector3 *v = &q->v;
+	const M_Real cs = grid->cellSize;
+	const M_Real fx = (v->x - idx->x)/cs;
+	const M_Real fy = (v->y - idx->y)/cs;
+	const int w = grid->w, h = grid->h;
+	int k, x, y, x1, y1, x2, y2, cx, cy, more;
+	M_Real bound;
+
+	cx = (fx >= 0.0) ? ((fx < (M_Real)w) ? (int)fx : w-1) : 0;
+	cy = (fy >= 0.0) ? ((fy < (M_Real)h) ? (int)fy : h-1) : 0;
+
+	for (k = 0; ; k++) {
+		x1 = cx - k;
+		y1 = cy - k;
+		x2 = cx + k;
+		y2 = cy + k;
+		for (y = MAX(y1,0); y <= MIN(y2,h-1); y++) {
+			if (y == y1 || y == y2) {
+				for (x = MAX(x1,0); x <= MIN(x2,w-1); x++)
+					QueryCell(q, &grid->cells[y*w + x]);
+			} else {
+				if (x1 >= 0)
+					QueryCell(q, &grid->cells[y*w + x1]);
+				if (x2 < w)
+					QueryCell(q, &grid->cells[y*w + x2]);
+			}
+		}
+
+		/* Distance from v to the nearest unvisited cell. */
+		bound = M_INFINITY;
+		more = 0;
+		if (x1 > 0) {
+			bound = MIN(bound, v->x - (idx->x + (M_Real)x1*cs));
+			more = 1;
+		}
+		if (x2 < w-1) {
+			bound = MIN(bound, (idx->x + (M_Real)(x2+1)*cs) - v->x);
+			more = 1;
+		}
+		if (y1 > 0) {
+			bound = MIN(bound, v->y - (idx->y + (M_Real)y1*cs));
+			more = 1;
+		}
+		if (y2 < h-1) {
+			bound = MIN(bound, (idx->y + (M_Real)(y2+1)*cs) - v->y);
+			more = 1;
+		}
+		if (!more || QueryPrune(q, bound))
+			break;
+	}
+}
+
 /*
  * Perform a proximity query with the given vector against all elements
  * of the given type (or all elements if type is NULL), and return the
- * closest item.
+ * closest item. Ties are resolved in favor of the earliest node in the
+ * list of nodes.
  *
  * The closest point of the closest item is also returned in vC.
  */
@@ -991,43 +1993,67 @@ void *
 SK_ProximitySearch(SK *sk, const char *type, const M_Vector3 *v, M_Vector3 *vC,
     void *nodeIgnore)
 {
-	SK_Node *node, *nClosest = NULL;
-	M_Real rClosest = M_INFINITY, p;
-	M_Vector3 vClosest = M_VecGet3(M_INFINITY, M_INFINITY, 0.0);
+	SK_Index *idx = &sk->index;
+	struct sk_index_query q;
+	SK_Node *node;
+	Uint i;
+	int l;
 
-	TAILQ_FOREACH(node, &sk->nodes, nodes) {
-		if (node == nodeIgnore ||
-		    node->ops->proximity == NULL) {
-			continue;
-		}
-		if (type != NULL &&
-		    strcmp(node->ops->name, type) != 0) {
-			continue;
+	AG_ObjectLock(sk);
+
+	IndexUpdate(sk);
+
+	q.type = type;
+	q.ops = NULL;
+	if (type != NULL) {
+		for (i = 0; i < skElementsCnt; i++) {
+			if (strcmp(skElements[i]->name, type) == 0) {
+				q.ops = skElements[i];
+				break;
+			}
 		}
-		p = node->ops->proximity(node, v, vC);
-		if (p < rClosest) {
-			rClosest = p;
-			nClosest = node;
-			vClosest.x = vC->x;
-			vClosest.y = vC->y;
+	}
+	q.ignoreNode = nodeIgnore;
+	q.v = *v;
+	q.nClosest = NULL;
+	q.rClosest = M_INFINITY;
+	q.vClosest = M_VecGet3(M_INFINITY, M_INFINITY, 0.0);
+
+	if (++idx->stamp == 0) {
+		TAILQ_FOREACH(node, &sk->nodes, nodes) {
+			node->stamp = 0;
 		}
+		idx->stamp = 1;
+	}
+	q.stamp = idx->stamp;
+
+	for (l = 0; l < SK_INDEX_LEVELS; l++) {
+		QueryGrid(&q, idx, &idx->grids[l]);
 	}
-	vC->x = vClosest.x;
-	vC->y = vClosest.y;
+	TAILQ_FOREACH(node, &idx->unbounded, idx)
+		QueryNode(&q, node);
+
+	vC->x = q.vClosest.x;
+	vC->y = q.vClosest.y;
 	vC->z = 0.0;
-	return (nClosest);
+
+	AG_ObjectUnlock(sk);
+	return (q.nClosest);
 }
 
-/* Search a node by name in a sketch. */
-/* XXX use a hash table */
+/* Search a cluster by name in a sketch. */
 SK_Cluster *
 SK_FindCluster(SK *sk, Uint name)
 {
 	SK_Cluster *cl;
 
-	TAILQ_FOREACH(cl, &sk->clusters, clusters) {
-		if (cl->name == name)
-			return (cl);
+	if (sk->nClusterBuckets > 0) {
+		for (cl = sk->clusterTbl[name & (sk->nClusterBuckets-1)];
+		     cl != NULL;
+		     cl = cl->hashNext) {
+			if (cl->name == name)
+				return (cl);
+		}
 	}
 	AG_SetError("No such cluster: %u", name);
 	return (NULL);
@@ -1037,12 +2063,13 @@ SK_FindCluster(SK *sk, Uint name)
 Uint
 SK_GenClusterName(SK *sk)
 {
-	Uint name = 1;
+	Uint name = sk->clusterHint;
 
 	while (SK_FindCluster(sk, name) != NULL) {
 		if (++name >= SK_NAME_MAX)
 			AG_FatalError("Out of cluster names");
 	}
+	sk->clusterHint = name;
 	return (name);
 }
 
@@ -1050,7 +2077,107 @@ void
 SK_InitCluster(SK_Cluster *cl, Uint name)
 {
 	cl->name = name;
+	cl->mark = 0;
 	TAILQ_INIT(&cl->edges);
+	cl->nodeTbl = NULL;
+	cl->nNodeBuckets = 0;
+	cl->nNodes = 0;
+	cl->hashNext = NULL;
+}
+
+/*
+ * Attach a cluster to the list of clusters of a sketch. The cluster is
+ * also entered into the list of clusters of each of its nodes, so its
+ * edges must not be modified until it is detached.
+ */
+void
+SK_AttachCluster(SK *sk, SK_Cluster *cl)
+{
+	SK_Cluster **bucket;
+	SK_ClusterNode *ent;
+	SK_Node *node;
+	Uint i;
+
+	if (sk->nClusterEnts >= sk->nClusterBuckets) {
+		Uint nBucketsNew = (sk->nClusterBuckets > 0) ?
+		                   (sk->nClusterBuckets << 1) : 16;
+		SK_Cluster *clOld, *clNext;
+
+		bucket = Malloc(nBucketsNew*sizeof(SK_Cluster *));
+		memset(bucket, 0, nBucketsNew*sizeof(SK_Cluster *));
+		for (i = 0; i < sk->nClusterBuckets; i++) {
+			for (clOld = sk->clusterTbl[i]; clOld != NULL;
+			     clOld = clNext) {
+				clNext = clOld->hashNext;
+				clOld->hashNext = bucket[clOld->name &
+				                         (nBucketsNew-1)];
+				bucket[clOld->name & (nBucketsNew-1)] = clOld;
+			}
+		}
+		Free(sk->clusterTbl);
+		sk->clusterTbl = bucket;
+		sk->nClusterBuckets = nBucketsNew;
+	}
+	bucket = &sk->clusterTbl[cl->name & (sk->nClusterBuckets-1)];
+	cl->hashNext = *bucket;
+	*bucket = cl;
+	sk->nClusterEnts++;
+	TAILQ_INSERT_TAIL(&sk->clusters, cl, clusters);
+
+	for (i = 0; i < cl->nNodeBuckets; i++) {
+		for (ent = cl->nodeTbl[i]; ent != NULL; ent = ent->next) {
+			node = ent->node;
+			if (node->nClusters+1 > node->maxClusters) {
+				node->maxClusters = (node->maxClusters > 0) ?
+				                    (node->maxClusters << 1) : 4;
+				node->clusters = Realloc(node->clusters,
+				    node->maxClusters*sizeof(SK_Cluster *));
+			}
+			node->clusters[node->nClusters++] = cl;
+		}
+	}
+}
+
+/* Detach a cluster from a sketch (without freeing it). */
+void
+SK_DetachCluster(SK *sk, SK_Cluster *cl)
+{
+	SK_Cluster **pCl;
+	SK_ClusterNode *ent;
+	SK_Node *node;
+	Uint i, j;
+
+	for (i = 0; i < cl->nNodeBuckets; i++) {
+		for (ent = cl->nodeTbl[i]; ent != NULL; ent = ent->next) {
+			node = ent->node;
+			for (j = 0; j < node->nClusters; j++) {
+				if (node->clusters[j] != cl) {
+					continue;
+				}
+				if (j < node->nClusters-1) {
+					memmove(&node->clusters[j],
+					    &node->clusters[j+1],
+					    (node->nClusters - j - 1) *
+					    sizeof(SK_Cluster *));
+				}
+				node->nClusters--;
+				break;
+			}
+		}
+	}
+	for (pCl = &sk->clusterTbl[cl->name & (sk->nClusterBuckets-1)];
+	     *pCl != NULL;
+	     pCl = &(*pCl)->hashNext) {
+		if (*pCl == cl) {
+			*pCl = cl->hashNext;
+			sk->nClusterEnts--;
+			break;
+		}
+	}
+	if (cl->name < sk->clusterHint) {
+		sk->clusterHint = cl->name;
+	}
+	TAILQ_REMOVE(&sk->clusters, cl, clusters);
 }
 
 void
@@ -1062,27 +2189,50 @@ SK_CopyCluster(const SK_Cluster *clSrc, SK_Cluster *clDst)
 		SK_AddConstraintCopy(clDst, ct);
 }
 
+/* Free the edges of a cluster. The cluster remains initialized. */
 void
 SK_FreeCluster(SK_Cluster *cl)
 {
+	SK_ClusterNode *ent, *entNext;
 	SK_Constraint *ct;
+	Uint i;
 
 	while ((ct = TAILQ_FIRST(&cl->edges)) != NULL) {
 		TAILQ_REMOVE(&cl->edges, ct, constraints);
 		Free(ct);
 	}
+	for (i = 0; i < cl->nNodeBuckets; i++) {
+		for (ent = cl->nodeTbl[i]; ent != NULL; ent = entNext) {
+			entNext = ent->next;
+			Free(ent->edges);
+			Free(ent);
+		}
+	}
+	Free(cl->nodeTbl);
+	cl->nodeTbl = NULL;
+	cl->nNodeBuckets = 0;
+	cl->nNodes = 0;
 }
 
 void
 SK_FreeClusters(SK *sk)
 {
 	SK_Cluster *cl;
+	SK_Node *node;
 
 	while ((cl = TAILQ_FIRST(&sk->clusters)) != NULL) {
 		TAILQ_REMOVE(&sk->clusters, cl, clusters);
 		SK_FreeCluster(cl);
 		Free(cl);
 	}
+	Free(sk->clusterTbl);
+	sk->clusterTbl = NULL;
+	sk->nClusterBuckets = 0;
+	sk->nClusterEnts = 0;
+	sk->clusterHint = 1;
+
+	TAILQ_FOREACH(node, &sk->nodes, nodes)
+		node->nClusters = 0;
 }
 
 void
@@ -1145,7 +2295,7 @@ SK_AddConstraint(SK_Cluster *cl, void *node1, void *node2,
 		ct->type = ct->uType;
 		break;
 	}
-	TAILQ_INSERT_TAIL(&cl->edges, ct, constraints);
+	ClusterInsert(cl, ct);
 	return (ct);
 }
 
@@ -1194,7 +2344,7 @@ SK_AddConstraintCopy(SK_Cluster *clDst, const SK_Constraint *ct)
 void
 SK_DelConstraint(SK_Cluster *cl, SK_Constraint *ct)
 {
-	TAILQ_REMOVE(&cl->edges, ct, constraints);
+	ClusterRemove(cl, ct);
 	Free(ct);
 }
 
@@ -1242,9 +2392,15 @@ SK_Constraint *
 SK_FindConstraint(const SK_Cluster *cl, enum sk_constraint_type type,
     void *n1, void *n2)
 {
+	const SK_ClusterNode *ent;
 	SK_Constraint *ct;
+	Uint i;
 
-	TAILQ_FOREACH(ct, &cl->edges, constraints) {
+	if ((ent = SK_ClusterLookup(cl, n1)) == NULL) {
+		return (NULL);
+	}
+	for (i = 0; i < ent->nEdges; i++) {
+		ct = ent->edges[i];
 		if ((ct->type == type || type == SK_CONSTRAINT_ANY) &&
 		    ((ct->n1 == n1 && ct->n2 == n2) ||
 		     (ct->n1 == n2 && ct->n2 == n1)))
@@ -1257,11 +2413,15 @@ SK_FindConstraint(const SK_Cluster *cl, enum sk_constraint_type type,
 SK_Constraint *
 SK_FindSimilarConstraint(const SK_Cluster *cl, const SK_Constraint *ct)
 {
-	SK_Constraint *ct2;
+	const SK_ClusterNode *ent;
+	Uint i;
 
-	TAILQ_FOREACH(ct2, &cl->edges, constraints) {
-		if (SK_CompareConstraints(ct2, ct) == 0)
-			return (ct2);
+	if ((ent = SK_ClusterLookup(cl, ct->n1)) == NULL) {
+		return (NULL);
+	}
+	for (i = 0; i < ent->nEdges; i++) {
+		if (SK_CompareConstraints(ent->edges[i], ct) == 0)
+			return (ent->edges[i]);
 	}
 	return (NULL);
 }
@@ -1274,9 +2434,15 @@ SK_Constraint *
 SK_ConstrainedNodes(const SK_Cluster *cl, const SK_Node *n1,
     const SK_Node *n2)
 {
+	const SK_ClusterNode *ent;
 	SK_Constraint *ct;
+	Uint i;
 
-	TAILQ_FOREACH(ct, &cl->edges, constraints) {
+	if ((ent = SK_ClusterLookup(cl, n1)) == NULL) {
+		return (NULL);
+	}
+	for (i = 0; i < ent->nEdges; i++) {
+		ct = ent->edges[i];
 		if ((ct->n1 == n1 && ct->n2 == n2) ||
 		    (ct->n1 == n2 && ct->n2 == n1))
 			return (ct);
@@ -1291,15 +2457,16 @@ SK_ConstrainedNodes(const SK_Cluster *cl, const SK_Node *n1,
 Uint
 SK_NodeConstraintCount(const SK_Cluster *cl, void *node)
 {
+	const SK_ClusterNode *ent;
 	SK_Node *nOther;
 	SK_Constraint *ct;
-	Uint count = 0;
+	Uint i, count = 0;
 
-	/* TODO use nCons */
-	TAILQ_FOREACH(ct, &cl->edges, constraints) {
-		if (ct->n1 != node && ct->n2 != node) {
-			continue;
-		}
+	if ((ent = SK_ClusterLookup(cl, node)) == NULL) {
+		return (0);
+	}
+	for (i = 0; i < ent->nEdges; i++) {
+		ct = ent->edges[i];
 		nOther = (ct->n1 == node) ? ct->n2 : ct->n1;
 		if (ct->type == SK_DISTANCE && ct->data.dist == 0.0) {
 			if (SK_NodeOfClass(node, "Point:*") &&
@@ -1317,17 +2484,10 @@ SK_NodeConstraintCount(const SK_Cluster *cl, void *node)
 }
 
 /* Evaluate whether the given node is in the given constraint graph. */
-/* XXX optimize */
 int
 SK_NodeInCluster(const SK_Node *node, const SK_Cluster *cl)
 {
-	SK_Constraint *ct;
-
-	TAILQ_FOREACH(ct, &cl->edges, constraints) {
-		if (ct->n1 == node || ct->n2 == node)
-			return (1);
-	}
-	return (0);
+	return (SK_ClusterLookup(cl, node) != NULL);
 }
 
 /*
@@ -1338,10 +2498,15 @@ Uint
 SK_ConstraintsToSubgraph(const SK_Cluster *clOrig, const SK_Node *node,
     const SK_Cluster *clSub, SK_Constraint *rv[2])
 {
+	const SK_ClusterNode *ent;
 	SK_Constraint *ct;
-	Uint count = 0;
+	Uint i, count = 0;
 
-	TAILQ_FOREACH(ct, &clOrig->edges, constraints) {
+	if ((ent = SK_ClusterLookup(clOrig, node)) == NULL) {
+		return (0);
+	}
+	for (i = 0; i < ent->nEdges; i++) {
+		ct = ent->edges[i];
 		if ((ct->n1 == node && SK_NodeInCluster(ct->n2, clSub)) ||
 		    (ct->n2 == node && SK_NodeInCluster(ct->n1, clSub))) {
 			if (count < 2) {
@@ -1579,7 +2744,7 @@ AG_ObjectClass skClass = {
 	{ 0,0 },
 	Init,
 	Reset,
-	NULL,		/* destroy */
+	Destroy,
 	Load,
 	Save,
 	SK_Edit
@@ -39,6 +39,8 @@
 
 struct sk;
 struct sk_node;
+struct sk_cluster;
+struct sk_index_link;
 struct sk_point;
 struct sk_constraint;
 struct sk_group;
@@ -77,6 +79,8 @@ typedef struct sk_node_ops {
 	int (*_Nullable move)(void *_Nonnull, const M_Vector3 *_Nonnull,
 	                      const M_Vector3 *_Nonnull);
 	SK_Status (*_Nullable constrained)(void *_Nonnull);
+	void (*_Nullable extent)(void *_Nonnull, M_Vector3 *_Nonnull,
+	                         M_Vector3 *_Nonnull);
 } SK_NodeOps;
 
 AG_TAILQ_HEAD(sk_nodeq,sk_node);
@@ -94,6 +98,12 @@ typedef struct sk_node {
 #define SK_NODE_FIXED          0x10	/* Treat position as known */
 #define SK_NODE_KNOWN          0x20	/* Position found by solver */
 #define SK_NODE_CHECKED        0x40	/* For constrainedness check */
+#define SK_NODE_INDEXED        0x80	/* In spatial index cells */
+#define SK_NODE_UNBOUNDED      0x100	/* In unbounded list of index */
+#define SK_NODE_DIRTY          0x200	/* In dirty list of index */
+#define SK_NODE_EXTENT         0x400	/* idxMin/idxMax are valid */
+#define SK_NODE_INDEX_FLAGS (SK_NODE_INDEXED | SK_NODE_UNBOUNDED | \
+                             SK_NODE_DIRTY | SK_NODE_EXTENT)
 
 	Uint nRefs;			 /* Reference count */
 	struct sk *_Nullable sk;	 /* Back pointer to sk */
@@ -108,14 +118,27 @@ typedef struct sk_node {
 	struct sk_constraint *_Nonnull *_Nonnull cons;	/* Constraint edges */
 
 	Uint nEdges;			/* For solver */
-	Uint32 _pad1;
+	Uint seq;			/* Order of insertion in sk */
 	void *userData;			/* Optional user pointer */
 
+	struct sk_cluster *_Nonnull *_Nullable clusters; /* For solver */
+	Uint                                  nClusters;
+	Uint                                  maxClusters;
+	Uint solveIdx;			/* For solver (position in list) */
+	Uint solveCnt;			/* For solver (edges to cluster) */
+
+	Uint stamp;			/* For proximity queries */
+	int idxLevel;			/* Grid of spatial index */
+	int idxCells[4];		/* Cells of spatial index */
+	M_Vector2 idxMin, idxMax;	/* Extent (for spatial index) */
+	struct sk_index_link *_Nullable idxLinks; /* References (for index) */
+	struct sk_node *_Nullable hashHandle;	/* In handle table */
+	struct sk_node *_Nullable hashName;	/* In name table */
+
 	AG_TAILQ_ENTRY(sk_node) sknodes; /* Entry in transformation tree */
 	AG_TAILQ_ENTRY(sk_node) nodes;	 /* Entry in flat node list */
 	AG_TAILQ_ENTRY(sk_node) rnodes;	 /* Reverse entry (optimization) */
-	Uint32 _pad2;
-	Uint32 _pad3;
+	AG_TAILQ_ENTRY(sk_node) idx;	 /* In unbounded or dirty list */
 } SK_Node;
 
 /* Pair of nodes */
@@ -149,11 +172,24 @@ typedef struct sk_constraint {
 	AG_TAILQ_ENTRY(sk_constraint) constraints;
 } SK_Constraint;
 
+/* Constraint edges of a cluster incident to a given node */
+typedef struct sk_cluster_node {
+	SK_Node *_Nonnull node;
+	SK_Constraint *_Nonnull *_Nonnull edges;  /* In order of insertion */
+	Uint                             nEdges;
+	Uint                             maxEdges;
+	struct sk_cluster_node *_Nullable next;	  /* In bucket */
+} SK_ClusterNode;
+
 /* Rigid cluster of constrained nodes */
 typedef struct sk_cluster {
 	Uint name;
-	Uint32 _pad;
+	Uint mark;				/* For solver */
 	AG_TAILQ_HEAD_(sk_constraint) edges;
+	SK_ClusterNode *_Nullable *_Nullable nodeTbl; /* Edges by node */
+	Uint                                nNodeBuckets;
+	Uint                                nNodes;
+	struct sk_cluster *_Nullable hashNext;	/* In cluster table */
 	AG_TAILQ_ENTRY(sk_cluster) clusters;
 } SK_Cluster;
 
@@ -186,6 +222,53 @@ typedef struct sk_geometry_fn {
 	                    struct sk_node *_Nonnull *_Nonnull);
 } SK_GeometryFn;
 
+/* Hash table of nodes (by class and handle, or by name). */
+typedef struct sk_node_table {
+	SK_Node *_Nullable *_Nullable buckets;
+	Uint nBuckets;
+	Uint nEnts;
+} SK_NodeTable;
+
+/* Lowest handle possibly available for a node class. */
+typedef struct sk_handle_hint {
+	char type[SK_TYPE_NAME_MAX];
+	Uint handle;
+} SK_HandleHint;
+
+/* Cell of the spatial index */
+typedef struct sk_index_cell {
+	SK_Node *_Nonnull *_Nullable nodes;
+	Uint                        nNodes;
+	Uint                        maxNodes;
+} SK_IndexCell;
+
+typedef struct sk_index_grid {
+	SK_IndexCell *_Nullable cells;		/* w*h cells */
+	int w, h;
+	M_Real cellSize;
+} SK_IndexGrid;
+
+#define SK_INDEX_MAX_CELLS 16		/* Max cells covered by a node */
+#define SK_INDEX_LEVELS    3		/* Number of grids */
+
+/*
+ * Spatial index for proximity queries. Grids are 8 times coarser at each
+ * level. The index is built on the first query and updated incrementally.
+ */
+typedef struct sk_index {
+	SK_IndexGrid grids[SK_INDEX_LEVELS];
+	M_Real x, y;				/* Origin of grids */
+	Uint nBuilt;				/* Node count at build time */
+	Uint nBuiltUnbounded;			/* Unbounded count at build */
+	Uint nUnbounded;			/* Unbounded node count */
+	Uint stamp;				/* Query stamp */
+	struct sk_index_link *_Nullable *_Nullable links; /* By referenced */
+	Uint nLinkBuckets;
+	Uint nLinks;
+	AG_TAILQ_HEAD_(sk_node) unbounded;	/* Not in any grid */
+	AG_TAILQ_HEAD_(sk_node) dirty;		/* To reindex */
+} SK_Index;
+
 /* Sketch class */
 typedef struct sk {
 	struct ag_object obj;
@@ -206,6 +289,17 @@ typedef struct sk {
 	AG_TAILQ_HEAD_(sk_cluster) clusters;	/* Rigid clusters */
 	AG_TAILQ_HEAD_(sk_insn) insns;		/* Construction steps */
 	AG_TAILQ_HEAD_(sk_group) group;		/* Item groups */
+
+	Uint nodeSeq;				/* Insertion counter */
+	Uint nHints;
+	SK_HandleHint *_Nullable hints;		/* Per-class handle hints */
+	SK_NodeTable handles;			/* Nodes by class and handle */
+	SK_NodeTable names;			/* Nodes by name */
+	SK_Cluster *_Nullable *_Nullable clusterTbl; /* Clusters by name */
+	Uint nClusterBuckets;
+	Uint nClusterEnts;
+	Uint clusterHint;			/* Lowest free cluster name */
+	SK_Index index;				/* Spatial index */
 } SK;
 
 #define  SKSK(o)           ((SK *)(o))
@@ -302,6 +396,7 @@ void SK_NodeDelConstraint(void *_Nonnull, SK_Constraint *_Nonnull);
 Uint SK_GenNodeName(SK *_Nonnull, const char *_Nonnull);
 Uint SK_GenClusterName(SK *_Nonnull);
 void SK_NodeRedraw(void *_Nonnull, struct sk_view *_Nonnull);
+void SK_NodeChanged(void *_Nonnull);
 
 M_Color	SK_NodeColor(void *_Nonnull, const M_Color *_Nonnull);
 
@@ -318,9 +413,13 @@ int  SK_Solve(SK *_Nonnull);
 void SK_FreeClusters(SK *_Nonnull);
 void SK_FreeInsns(SK *_Nonnull);
 void SK_InitCluster(SK_Cluster *_Nonnull, Uint);
+void SK_AttachCluster(SK *_Nonnull, SK_Cluster *_Nonnull);
+void SK_DetachCluster(SK *_Nonnull, SK_Cluster *_Nonnull);
 void SK_FreeCluster(SK_Cluster *_Nonnull);
 void SK_CopyCluster(const SK_Cluster *_Nonnull, SK_Cluster *_Nonnull);
 int  SK_NodeInCluster(const SK_Node *_Nonnull, const SK_Cluster *_Nonnull);
+SK_ClusterNode *_Nullable SK_ClusterLookup(const SK_Cluster *_Nonnull,
+                                           const SK_Node *_Nonnull);
 
 SK_Constraint *_Nullable SK_AddConstraint(SK_Cluster *_Nonnull, void *_Nonnull,
                                           void *_Nonnull,
@@ -369,13 +468,13 @@ Uint SK_NodeConstraintCount(const SK_Cluster *_Nonnull, void *_Nonnull);
 void SK_ComputeIntersections(SK_Group *_Nonnull, SK_Node *_Nonnull, SK_Node *_Nonnull);
 void SK_GeometryMenu(struct sk_view *_Nonnull, void *_Nonnull);
 
-#define	SK_Identity(n)       M_MatIdentity44v(&SKNODE(n)->T)
-#define	SK_Translate(n,x,y)  M_MatTranslate44(&SKNODE(n)->T,(v).x,(v).y,0.0)
-#define	SK_Translatev(n,v)   M_MatTranslate44(&SKNODE(n)->T,(v)->x,(v)->y,0.0)
-#define	SK_TranslateVec(n,v) M_MatTranslate44(&SKNODE(n)->T,(v).x,(v).y,0.0)
-#define	SK_Translate2(n,x,y) M_MatTranslate44(&SKNODE(n)->T,(x),(y),0.0)
-#define	SK_Rotatev(n,theta)  M_MatRotate44K(&SKNODE(n)->T,(theta))
-#define	SK_MatrixCopy(nDst,nSrc) M_MatCopy44(&SKNODE(nDst)->T,&SKNODE(nSrc)->T)
+#define	SK_Identity(n)       (M_MatIdentity44v(&SKNODE(n)->T), SK_NodeChanged(n))
+#define	SK_Translate(n,x,y)  (M_MatTranslate44(&SKNODE(n)->T,(v).x,(v).y,0.0), SK_NodeChanged(n))
+#define	SK_Translatev(n,v)   (M_MatTranslate44(&SKNODE(n)->T,(v)->x,(v)->y,0.0), SK_NodeChanged(n))
+#define	SK_TranslateVec(n,v) (M_MatTranslate44(&SKNODE(n)->T,(v).x,(v).y,0.0), SK_NodeChanged(n))
+#define	SK_Translate2(n,x,y) (M_MatTranslate44(&SKNODE(n)->T,(x),(y),0.0), SK_NodeChanged(n))
+#define	SK_Rotatev(n,theta)  (M_MatRotate44K(&SKNODE(n)->T,(theta)), SK_NodeChanged(n))
+#define	SK_MatrixCopy(nDst,nSrc) (M_MatCopy44(&SKNODE(nDst)->T,&SKNODE(nSrc)->T), SK_NodeChanged(nDst))
 
 #define SK_LockNode(n) AG_ObjectLock(SKNODE(n)->sk)
 #define SK_UnlockNode(n) AG_ObjectUnlock(SKNODE(n)->sk)
@@ -143,6 +143,7 @@ SK_NodeOps skArcOps = {
 	NULL,		/* delete */
 	NULL,		/* move */
 	NULL,		/* constrained */
+	NULL,		/* extent */
 };
 
 struct sk_arc_tool {
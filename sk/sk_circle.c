@@ -50,6 +50,7 @@ SK_CircleFromValue(void *pnode, M_Circle2 C)
 	Cn = SK_CircleNew(pnode);
 	Cn->r = C.r;
 	Cn->p = SK_PointNew(pnode);
+	SK_NodeAddReference(Cn, Cn->p);
 	SK_Translatev(Cn->p, &C.p);
 	return (Cn);
 }
@@ -132,14 +133,22 @@ SK_CircleDraw(void *p, SK_View *skv)
 	GL_Translate(M_VecFlip3(v));
 }
 
+static void
+RadiusChanged(AG_Event *_Nonnull event)
+{
+	SK_NodeChanged(AG_PTR(1));
+}
+
 void
 SK_CircleEdit(void *p, AG_Widget *box, SK_View *skv)
 {
 	SK_Circle *circle = p;
 	const char *unit = skv->sk->uLen->abbr;
+	AG_Numerical *num;
 //	AG_HSVPal *pal;
 
-	M_NumericalNewReal(box, 0, unit, _("Radius: "), &circle->r);
+	num = M_NumericalNewReal(box, 0, unit, _("Radius: "), &circle->r);
+	AG_SetEvent(num, "numerical-changed", RadiusChanged, "%p", circle);
 	M_NumericalNewReal(box, 0, unit, _("Width: "), &circle->width);
 //	pal = AG_HSVPalNew(box, AG_HSVPAL_EXPAND);
 //	M_BindReal(pal, "RGBAv", (void *)&circle->color);
@@ -159,6 +168,24 @@ SK_CircleProximity(void *p, const M_Vector3 *v, M_Vector3 *vC)
 	return M_VecDistance3p(v, vC);
 }
 
+void
+SK_CircleExtent(void *p, M_Vector3 *a, M_Vector3 *b)
+{
+	SK_Circle *circle = p;
+	M_Vector3 c;
+	M_Real r;
+
+	if (circle->p == NULL) {			/* Incomplete */
+		*a = M_VecGet3(M_INFINITY, M_INFINITY, 0.0);
+		*b = M_VecGet3(-M_INFINITY, -M_INFINITY, 0.0);
+		return;
+	}
+	c = SK_Pos(circle->p);
+	r = M_Fabs(circle->r);
+	*a = M_VecGet3(c.x - r, c.y - r, 0.0);
+	*b = M_VecGet3(c.x + r, c.y + r, 0.0);
+}
+
 int
 SK_CircleDelete(void *p)
 {
@@ -232,7 +259,8 @@ SK_NodeOps skCircleOps = {
 	SK_CircleProximity,
 	SK_CircleDelete,
 	SK_CircleMove,
-	SK_CircleConstrained
+	SK_CircleConstrained,
+	SK_CircleExtent
 };
 
 struct sk_circle_tool {
@@ -259,6 +287,7 @@ ToolMouseMotion(void *_Nonnull p, M_Vector3 pos, M_Vector3 vel)
 	if (t->curCircle != NULL) {
 		vCenter = SK_Pos(t->curCircle->p);
 		t->curCircle->r = M_VecDistance3(vCenter, pos);
+		SK_NodeChanged(t->curCircle);
 	}
 	return (0);
 }
@@ -27,6 +27,8 @@ void   SK_CircleEdit(void *_Nonnull, struct ag_widget *_Nonnull,
                      struct sk_view *_Nonnull);
 M_Real SK_CircleProximity(void *_Nonnull, const M_Vector3 *_Nonnull,
                           M_Vector3 *_Nonnull);
+void   SK_CircleExtent(void *_Nonnull, M_Vector3 *_Nonnull,
+                       M_Vector3 *_Nonnull);
 int    SK_CircleDelete(void *_Nonnull);
 int    SK_CircleMove(void *_Nonnull, const M_Vector3 *_Nonnull,
                      const M_Vector3 *_Nonnull);
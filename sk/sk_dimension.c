@@ -546,6 +546,7 @@ SK_NodeOps skDimensionOps = {
 	SK_DimensionDelete,
 	SK_DimensionMove,
 	NULL,			/* constrained */
+	NULL,			/* extent */
 };
 
 struct sk_dimension_tool {
@@ -90,4 +90,5 @@ SK_NodeOps skDummyOps = {
 	NULL,		/* proximity */
 	NULL,		/* delete */
 	NULL,		/* constrained */
+	NULL,		/* extent */
 };
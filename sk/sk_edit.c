@@ -414,8 +414,7 @@ NodeSetName(AG_Event *_Nonnull event)
 {
 	SK_Node *node = AG_PTR(1);
 
-	AG_Snprintf(node->name, sizeof(node->name), "%s%u", node->ops->name,
-	   (Uint)node->handle);
+	SK_NodeSetName(node, "%s%u", node->ops->name, (Uint)node->handle);
 }
 
 static void
@@ -120,5 +120,6 @@ SK_NodeOps skGroupOps = {
 	NULL,			/* proximity */
 	NULL,			/* delete */
 	NULL,			/* move */
-	NULL			/* constrained */
+	NULL,			/* constrained */
+	NULL			/* extent */
 };
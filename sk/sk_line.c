@@ -51,6 +51,8 @@ SK_LineFromValue(void *pnode, M_Line2 L)
 	Ln = SK_LineNew(pnode);
 	Ln->p1 = SK_PointNew(pnode);
 	Ln->p2 = SK_PointNew(pnode);
+	SK_NodeAddReference(Ln, Ln->p1);
+	SK_NodeAddReference(Ln, Ln->p2);
 	M_LineToPts2(SK_LineValue(Ln), &v1, &v2);
 	SK_Translatev(Ln->p1, &v1);
 	SK_Translatev(Ln->p2, &v2);
@@ -158,6 +160,23 @@ SK_LineProximity(void *p, const M_Vector3 *v, M_Vector3 *vC)
 	return M_VecDistance3p(v, vC);
 }
 
+void
+SK_LineExtent(void *p, M_Vector3 *a, M_Vector3 *b)
+{
+	SK_Line *line = p;
+	M_Vector3 p1, p2;
+
+	if (line->p1 == NULL || line->p2 == NULL) {	/* Incomplete */
+		*a = M_VecGet3(M_INFINITY, M_INFINITY, 0.0);
+		*b = M_VecGet3(-M_INFINITY, -M_INFINITY, 0.0);
+		return;
+	}
+	p1 = SK_Pos(line->p1);
+	p2 = SK_Pos(line->p2);
+	*a = M_VecGet3(MIN(p1.x,p2.x), MIN(p1.y,p2.y), 0.0);
+	*b = M_VecGet3(MAX(p1.x,p2.x), MAX(p1.y,p2.y), 0.0);
+}
+
 int
 SK_LineDelete(void *p)
 {
@@ -311,7 +330,8 @@ SK_NodeOps skLineOps = {
 	SK_LineProximity,
 	SK_LineDelete,
 	SK_LineMove,
-	SK_LineConstrained
+	SK_LineConstrained,
+	SK_LineExtent
 };
 
 struct sk_line_tool {
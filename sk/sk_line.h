@@ -28,6 +28,7 @@ void SK_LineEdit(void *_Nonnull, struct ag_widget *_Nonnull,
 
 M_Real SK_LineProximity(void *_Nonnull, const M_Vector3 *_Nonnull,
                         M_Vector3 *_Nonnull);
+void   SK_LineExtent(void *_Nonnull, M_Vector3 *_Nonnull, M_Vector3 *_Nonnull);
 
 int SK_LineDelete(void *_Nonnull);
 int SK_LineMove(void *_Nonnull, const M_Vector3 *_Nonnull,
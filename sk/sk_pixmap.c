@@ -234,7 +234,8 @@ SK_NodeOps skPixmapOps = {
 	SK_PixmapProximity,
 	SK_PixmapDelete,
 	SK_PixmapMove,
-	SK_PixmapConstrained
+	SK_PixmapConstrained,
+	NULL		/* extent */
 };
 
 struct sk_pixmap_tool {
@@ -143,6 +143,13 @@ SK_PointProximity(void *p, const M_Vector3 *v, M_Vector3 *vC)
 	return M_VecDistance3p(v, &pv);
 }
 
+void
+SK_PointExtent(void *p, M_Vector3 *a, M_Vector3 *b)
+{
+	*a = SK_Pos(p);
+	*b = *a;
+}
+
 int
 SK_PointDelete(void *p)
 {
@@ -191,7 +198,8 @@ SK_NodeOps skPointOps = {
 	SK_PointProximity,
 	SK_PointDelete,
 	SK_PointMove,
-	SK_PointConstrained
+	SK_PointConstrained,
+	SK_PointExtent
 };
 
 static int
@@ -207,7 +215,7 @@ ToolMouseButtonDown(void *_Nonnull pTool, M_Vector3 pos, int btn)
 	pt = Malloc(sizeof(SK_Point));
 	SK_PointInit(pt, SK_GenNodeName(sk, "Point"));
 	SK_NodeAttach(sk->root, pt);
-	M_MatTranslate44(&SKNODE(pt)->T, pos.x, pos.y, 0.0);
+	SK_Translate2(pt, pos.x, pos.y);
 	
 	SK_Update(sk);
 	return (0);
@@ -23,6 +23,8 @@ void      SK_PointEdit(void *_Nonnull, struct ag_widget *_Nonnull,
                        struct sk_view *_Nonnull);
 M_Real    SK_PointProximity(void *_Nonnull, const M_Vector3 *_Nonnull,
                             M_Vector3 *_Nonnull);
+void      SK_PointExtent(void *_Nonnull, M_Vector3 *_Nonnull,
+                         M_Vector3 *_Nonnull);
 int       SK_PointDelete(void *_Nonnull);
 int       SK_PointMove(void *_Nonnull, const M_Vector3 *_Nonnull,
                        const M_Vector3 *_Nonnull);
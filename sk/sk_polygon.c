@@ -159,6 +159,25 @@ SK_PolygonProximity(void *p, const M_Vector3 *v, M_Vector3 *vC)
 	return (M_INFINITY);
 }
 
+void
+SK_PolygonExtent(void *p, M_Vector3 *a, M_Vector3 *b)
+{
+	SK_Polygon *poly = p;
+	M_Polygon P;
+	Uint i;
+
+	*a = M_VecGet3(M_INFINITY, M_INFINITY, 0.0);
+	*b = M_VecGet3(-M_INFINITY, -M_INFINITY, 0.0);
+	P = SK_PolygonValue(poly);
+	for (i = 0; i < P.n; i++) {
+		if (P.v[i].x < a->x) { a->x = P.v[i].x; }
+		if (P.v[i].y < a->y) { a->y = P.v[i].y; }
+		if (P.v[i].x > b->x) { b->x = P.v[i].x; }
+		if (P.v[i].y > b->y) { b->y = P.v[i].y; }
+	}
+	M_PolygonFree(&P);
+}
+
 int
 SK_PolygonDelete(void *p)
 {
@@ -245,6 +264,7 @@ SK_NodeOps skPolygonOps = {
 	SK_PolygonDelete,
 	NULL,			/* move */
 	NULL,			/* constrained */
+	SK_PolygonExtent
 };
 
 struct sk_polygon_tool {
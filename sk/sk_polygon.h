@@ -22,6 +22,8 @@ int    SK_PolygonSave(SK *_Nonnull, void *_Nonnull, AG_DataSource *_Nonnull);
 void   SK_PolygonDraw(void *_Nonnull, struct sk_view *_Nonnull);
 M_Real SK_PolygonProximity(void *_Nonnull, const M_Vector3 *_Nonnull,
                            M_Vector3 *_Nonnull);
+void   SK_PolygonExtent(void *_Nonnull, M_Vector3 *_Nonnull,
+                        M_Vector3 *_Nonnull);
 int    SK_PolygonDelete(void *_Nonnull);
 
 void      SK_PolygonWidth(SK_Polygon *_Nonnull, M_Real);
@@ -52,64 +52,203 @@
 
 #include "sk.h"
 
+/* State of MergeConstrainedRings(). */
+struct sk_ring_merge {
+	SK_Cluster *_Nonnull clOrig;
+	SK_Cluster *_Nonnull cl;
+	SK_Node *_Nonnull *_Nullable heap;	/* Candidates (by solveIdx) */
+	Uint nHeap, maxHeap;
+	SK_Node *_Nonnull *_Nullable touched;	/* Nodes to reset solveCnt */
+	Uint nTouched, maxTouched;
+};
+
+static void
+HeapPush(struct sk_ring_merge *_Nonnull m, SK_Node *_Nonnull node)
+{
+	Uint i, iParent;
+
+	if (m->nHeap+1 > m->maxHeap) {
+		m->maxHeap = (m->maxHeap > 0) ? (m->maxHeap << 1) : 32;
+		m->heap = Realloc(m->heap, m->maxHeap*sizeof(SK_Node *));
+	}
+	for (i = m->nHeap++; i > 0; i = iParent) {
+		iParent = (i-1) >> 1;
+		if (m->heap[iParent]->solveIdx <= node->solveIdx) {
+			break;
+		}
+		m->heap[i] = m->heap[iParent];
+	}
+	m->heap[i] = node;
+}
+
+static SK_Node *_Nonnull
+HeapPop(struct sk_ring_merge *_Nonnull m)
+{
+	SK_Node *node = m->heap[0], *last = m->heap[--m->nHeap];
+	Uint i = 0, iChild;
+
+	while ((iChild = (i << 1) + 1) < m->nHeap) {
+		if (iChild+1 < m->nHeap &&
+		    m->heap[iChild+1]->solveIdx < m->heap[iChild]->solveIdx) {
+			iChild++;
+		}
+		if (last->solveIdx <= m->heap[iChild]->solveIdx) {
+			break;
+		}
+		m->heap[i] = m->heap[iChild];
+		i = iChild;
+	}
+	m->heap[i] = last;
+	return (node);
+}
+
+/*
+ * Update the count of clOrig edges between a node and the cluster. Nodes
+ * reaching a count of exactly two become candidates for merging.
+ */
+static void
+CountEdge(struct sk_ring_merge *_Nonnull m, SK_Node *_Nonnull node, int incr)
+{
+	if (incr > 0) {
+		if (node->solveCnt++ == 0) {
+			if (m->nTouched+1 > m->maxTouched) {
+				m->maxTouched = (m->maxTouched > 0) ?
+				                (m->maxTouched << 1) : 32;
+				m->touched = Realloc(m->touched,
+				    m->maxTouched*sizeof(SK_Node *));
+			}
+			m->touched[m->nTouched++] = node;
+		}
+	} else {
+		node->solveCnt--;
+	}
+	if (node->solveCnt == 2 &&
+	    !(node->flags & (SK_NODE_SUPCONSTRAINTS|SK_NODE_FIXED)))
+		HeapPush(m, node);
+}
+
+/* A node has joined the cluster; count its edges in clOrig. */
+static void
+CountJoined(struct sk_ring_merge *_Nonnull m, SK_Node *_Nonnull node)
+{
+	const SK_ClusterNode *ent;
+	const SK_Constraint *ct;
+	Uint i;
+
+	if ((ent = SK_ClusterLookup(m->clOrig, node)) == NULL) {
+		return;
+	}
+	for (i = 0; i < ent->nEdges; i++) {
+		ct = ent->edges[i];
+		CountEdge(m, (ct->n1 == node) ? ct->n2 : ct->n1, 1);
+	}
+}
+
 /*
  * Look for nodes in clOrig that share exactly two edges with cluster cl
  * and merge them into it (deleting them from clOrig). Since our elements
  * have two degrees of freedom, any element connected to a rigid cluster
  * by two constraints can be merged in that cluster.
+ *
+ * Candidates are considered in the order of the list of nodes. Rather
+ * than rescanning the graph after every merge, we maintain the number of
+ * edges between each node and the cluster in solveCnt.
  */
 static void
 MergeConstrainedRings(SK *_Nonnull sk, SK_Cluster *_Nonnull clOrig,
     SK_Cluster *_Nonnull cl)
 {
+	struct sk_ring_merge m;
+	const SK_ClusterNode *ent;
 	SK_Constraint *ct, *ctPair[2];
-	SK_Node *nUnknown, *nKnown[2];
-	Uint i, count;
+	SK_Node *nUnknown, *nKnown[2], *n;
+	Uint i, j, count;
+	int in1, in2;
 	
 	Debug(sk, "Solver: MergeConstrainedRings(Cluster%u)\n", (Uint)cl->name);
-restart:
-	TAILQ_FOREACH(nUnknown, &sk->nodes, nodes) {
-		if (nUnknown->flags & (SK_NODE_SUPCONSTRAINTS|SK_NODE_FIXED)) {
+
+	m.clOrig = clOrig;
+	m.cl = cl;
+	m.heap = NULL;
+	m.nHeap = 0;
+	m.maxHeap = 0;
+	m.touched = NULL;
+	m.nTouched = 0;
+	m.maxTouched = 0;
+	for (i = 0; i < cl->nNodeBuckets; i++) {
+		for (ent = cl->nodeTbl[i]; ent != NULL; ent = ent->next)
+			CountJoined(&m, ent->node);
+	}
+	while (m.nHeap > 0) {
+		nUnknown = HeapPop(&m);
+		if (nUnknown->solveCnt != 2) {
 			continue;
 		}
-		count = 0;
-		TAILQ_FOREACH(ct, &clOrig->edges, constraints) {
+		ent = SK_ClusterLookup(clOrig, nUnknown);
+		for (i = 0, count = 0; i < ent->nEdges && count < 2; i++) {
+			ct = ent->edges[i];
 			if (ct->n1 == nUnknown &&
 			    SK_NodeInCluster(ct->n2, cl)) {
-				if (count < 2) {
-					ctPair[count] = ct;
-					nKnown[count] = ct->n2;
-				}
-				count++;
+				ctPair[count] = ct;
+				nKnown[count++] = ct->n2;
 			} else if (ct->n2 == nUnknown &&
 			     SK_NodeInCluster(ct->n1, cl)) {
-				if (count < 2) {
-					ctPair[count] = ct;
-					nKnown[count] = ct->n1;
-				}
-				count++;
+				ctPair[count] = ct;
+				nKnown[count++] = ct->n1;
 			}
 		}
-		if (count != 2) {
-			continue;
-		}
 		SK_AddInsn(sk, SK_COMPOSE_RING,
 		    nUnknown, nKnown[0], nKnown[1],
 		    SK_DupConstraint(ctPair[0]),
 		    SK_DupConstraint(ctPair[1]));
 		for (i = 0; i < 2; i++) {
-			SK_AddConstraintCopy(cl, ctPair[i]);
-			SK_DelConstraint(clOrig, ctPair[i]);
+			ct = ctPair[i];
+			in1 = SK_NodeInCluster(ct->n1, cl);
+			in2 = SK_NodeInCluster(ct->n2, cl);
+			SK_AddConstraintCopy(cl, ct);
+			if (!in1 && SK_NodeInCluster(ct->n1, cl)) {
+				CountJoined(&m, ct->n1);
+			}
+			if (!in2 && ct->n2 != ct->n1 &&
+			    SK_NodeInCluster(ct->n2, cl)) {
+				CountJoined(&m, ct->n2);
+			}
+			if (SK_NodeInCluster(ct->n2, cl)) {
+				CountEdge(&m, ct->n1, -1);
+			}
+			if (ct->n2 != ct->n1 && SK_NodeInCluster(ct->n1, cl)) {
+				CountEdge(&m, ct->n2, -1);
+			}
+			SK_DelConstraint(clOrig, ct);
 		}
+	}
+	for (j = 0; j < m.nTouched; j++) {
+		n = m.touched[j];
+		n->solveCnt = 0;
+	}
+	Free(m.heap);
+	Free(m.touched);
+}
+
+/* Mark the clusters sharing a node with the given cluster. */
+static void
+MarkAdjacentClusters(const SK_Cluster *_Nonnull cl)
+{
+	const SK_ClusterNode *ent;
+	Uint i, j;
 
-		/* XXX is this needed? */
-		goto restart;
+	for (i = 0; i < cl->nNodeBuckets; i++) {
+		for (ent = cl->nodeTbl[i]; ent != NULL; ent = ent->next) {
+			for (j = 0; j < ent->node->nClusters; j++)
+				ent->node->clusters[j]->mark = 1;
+		}
 	}
 }
 
 /*
  * Look for any sketch cluster that shares two elements with the given
- * cluster, and merge them into a single cluster.
+ * cluster, and merge them into a single cluster. Only clusters sharing
+ * a node with clMerged (marked) need to be examined.
  *
  * cl must not be already attached to sk.
  */
@@ -122,8 +261,16 @@ MergeConstrainedClusters(SK *_Nonnull sk, SK_Cluster *_Nonnull clMerged)
 	
 	Debug(sk, "Solver: MergeConstrainedClusters(Cluster%u)\n",
 	    (Uint)clMerged->name);
+
+	TAILQ_FOREACH(cl, &sk->clusters, clusters) {
+		cl->mark = 0;
+	}
+	MarkAdjacentClusters(clMerged);
 restart:
 	TAILQ_FOREACH(cl, &sk->clusters, clusters) {
+		if (!cl->mark) {
+			continue;
+		}
 		count = 0;
 		TAILQ_FOREACH(ct, &cl->edges, constraints) {
 			if (SK_NodeInCluster(ct->n1, clMerged) ||
@@ -135,7 +282,8 @@ restart:
 			    "Solver: Merging cluster%d into cluster%d (pair)\n",
 			    cl->name, clMerged->name);
 			SK_CopyCluster(cl, clMerged);
-			TAILQ_REMOVE(&sk->clusters, cl, clusters);
+			MarkAdjacentClusters(cl);
+			SK_DetachCluster(sk, cl);
 			SK_FreeCluster(cl);
 			Free(cl);
 			goto restart;		/* Cluster chain changed */
@@ -224,7 +372,7 @@ SK_Solve(SK *sk)
 	SK_Cluster *cl, *clRing[3], *clPair[2];
 	SK_Constraint *ct;
 	SK_Node *node;
-	Uint i, j, count, nRing;
+	Uint i, j, nRing;
 
 	AG_MutexLock(&sk->lock);
 
@@ -238,6 +386,11 @@ SK_Solve(SK *sk)
 	/* Copy the source graph since we will modify its elements. */
 	SK_FreeClusters(sk);
 	SK_FreeInsns(sk);
+	i = 0;
+	TAILQ_FOREACH(node, &sk->nodes, nodes) {
+		node->solveIdx = i++;
+		node->solveCnt = 0;
+	}
 	SK_InitCluster(&clOrig, 1);
 	SK_CopyCluster(&sk->ctGraph, &clOrig);
 
@@ -256,8 +409,9 @@ SK_Solve(SK *sk)
 	
 		/* Keep merging constrained rings into this cluster. */
 		MergeConstrainedRings(sk, &clOrig, cl);
-		TAILQ_INSERT_TAIL(&sk->clusters, cl, clusters);
+		SK_AttachCluster(sk, cl);
 	}
+	SK_FreeCluster(&clOrig);
 
 	/*
 	 * Search for constrained rings of 3 clusters and merge them into
@@ -266,34 +420,26 @@ SK_Solve(SK *sk)
 merge_rings:
 	nRing = 0;
 	TAILQ_FOREACH(node, &sk->nodes, nodes) {
-		if (node->flags & SK_NODE_SUPCONSTRAINTS) {
+		if ((node->flags & SK_NODE_SUPCONSTRAINTS) ||
+		    node->nClusters != 2) {
 			continue;
 		}
-		count = 0;
-		TAILQ_FOREACH(cl, &sk->clusters, clusters) {
-			if (SK_NodeInCluster(node, cl)) {
-				if (count < 2) {
-					clPair[count] = cl;
-				}
-				count++;
+		clPair[0] = node->clusters[0];
+		clPair[1] = node->clusters[1];
+		Debug(sk,
+		    "Solver: %s is shared by Cluster%u and Cluster%u\n",
+		    node->name, (Uint)clPair[0]->name, (Uint)clPair[1]->name);
+		for (j = 0; j < 2; j++) {
+			for (i = 0; i < nRing; i++) {
+				if (clRing[i] == clPair[j])
+					break;
 			}
-		}
-		if (count == 2) {
-			Debug(sk,
-			    "Solver: %s is shared by Cluster%u and Cluster%u\n",
-			    node->name, (Uint)clPair[0]->name, (Uint)clPair[1]->name);
-			for (j = 0; j < 2; j++) {
-				for (i = 0; i < nRing; i++) {
-					if (clRing[i] == clPair[j])
-						break;
-				}
-				if (i == nRing && nRing < 3) {
-					clRing[nRing++] = clPair[j];
-				}
+			if (i == nRing && nRing < 3) {
+				clRing[nRing++] = clPair[j];
 			}
-			if (nRing == 3)
-				break;
 		}
+		if (nRing == 3)
+			break;
 	}
 	if (nRing == 3) {
 		SK_Cluster *clMerged;
@@ -307,7 +453,7 @@ merge_rings:
 		    clMerged->name);
 		for (i = 0; i < 3; i++) {
 			SK_CopyCluster(clRing[i], clMerged);
-			TAILQ_REMOVE(&sk->clusters, clRing[i], clusters);
+			SK_DetachCluster(sk, clRing[i]);
 			SK_FreeCluster(clRing[i]);
 			Free(clRing[i]);
 		}
@@ -318,7 +464,7 @@ merge_rings:
 		 */
 		MergeConstrainedClusters(sk, clMerged);
 
-		TAILQ_INSERT_TAIL(&sk->clusters, clMerged, clusters);
+		SK_AttachCluster(sk, clMerged);
 		goto merge_rings;
 	}
 	UpdateConstraintStatus(sk);
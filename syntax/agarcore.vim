@@ -988,7 +988,7 @@ if !exists("c_no_agar_core") || exists("c_agar_core_typedefs")
   syn keyword cConstant AG_NEWLINE_EBCDIC AG_NEWLINE_LAST AG_NEWLINE_DOS 
   syn keyword cConstant AG_NEWLINE_UNIX
   " core/tbl.h
-  syn keyword cType AG_Tbl AG_TblBucket
+  syn keyword cType AG_Tbl AG_TblEnt
   syn keyword cConstant AG_TBL_DUPLICATES
   " core/text.h
   syn keyword cType AG_Language AG_Text AG_TextElement AG_TextEnt
@@ -30,6 +30,7 @@
 
 #include "config/have_agar_au.h"
 #include "config/have_agar_math.h"
+#include "config/have_agar_vg.h"
 #include "config/datadir.h"
 
 extern const AG_TestCase buttonsTest;
@@ -37,10 +38,12 @@ extern const AG_TestCase checkboxTest;
 extern const AG_TestCase configsettingsTest;
 extern const AG_TestCase consoleTest;
 extern const AG_TestCase customwidgetTest;
+extern const AG_TestCase damageTest;
 extern const AG_TestCase fixedresTest;
 extern const AG_TestCase focusingTest;
 extern const AG_TestCase fontsTest;
 extern const AG_TestCase fspathsTest;
+extern const AG_TestCase headlessTest;
 extern const AG_TestCase imageloadingTest;
 extern const AG_TestCase keyeventsTest;
 extern const AG_TestCase loaderTest;
@@ -52,13 +55,17 @@ extern const AG_TestCase radioTest;
 extern const AG_TestCase rendertosurfaceTest;
 extern const AG_TestCase scrollbarTest;
 extern const AG_TestCase scrollviewTest;
+extern const AG_TestCase serializationTest;
 extern const AG_TestCase socketsTest;
 extern const AG_TestCase surfaceTest;
 extern const AG_TestCase tableTest;
+extern const AG_TestCase tblTest;
 extern const AG_TestCase textboxTest;
+extern const AG_TestCase textcacheTest;
 extern const AG_TestCase textdlgTest;
 extern const AG_TestCase threadsTest;
 extern const AG_TestCase unitconvTest;
+extern const AG_TestCase variablesTest;
 extern const AG_TestCase widgetsTest;
 extern const AG_TestCase windowsTest;
 #if defined(AG_TIMERS) && defined(AG_HAVE_FLOAT)
@@ -86,6 +93,9 @@ extern const AG_TestCase mathTest;
 extern const AG_TestCase plottingTest;
 extern const AG_TestCase stringTest;
 #endif
+#ifdef HAVE_AGAR_VG
+extern const AG_TestCase vgTest;
+#endif
 
 /* Autorun "widgets" when no test specified on the command-line. */
 #define AUTORUN_WIDGETS
@@ -96,10 +106,12 @@ const AG_TestCase *testCases[] = {
 	&configsettingsTest,
 	&consoleTest,
 	&customwidgetTest,
+	&damageTest,
 	&fixedresTest,
 	&focusingTest,
 	&fontsTest,
 	&fspathsTest,
+	&headlessTest,
 	&imageloadingTest,
 	&keyeventsTest,
 	&loaderTest,
@@ -111,13 +123,17 @@ const AG_TestCase *testCases[] = {
 	&rendertosurfaceTest,
 	&scrollbarTest,
 	&scrollviewTest,
+	&serializationTest,
 	&socketsTest,
 	&surfaceTest,
 	&tableTest,
+	&tblTest,
 	&textboxTest,
+	&textcacheTest,
 	&textdlgTest,
 	&threadsTest,
 	&unitconvTest,
+	&variablesTest,
 	&widgetsTest,
 	&windowsTest,
 #if defined(HAVE_AGAR_AU) && !defined(_WIN32)
@@ -144,6 +160,9 @@ const AG_TestCase *testCases[] = {
 	&mathTest,
 	&plottingTest,
 	&stringTest,
+#endif
+#ifdef HAVE_AGAR_VG
+	&vgTest,
 #endif
 	NULL
 };
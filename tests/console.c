@@ -172,6 +172,92 @@ TestGUI(void *obj, AG_Window *win)
 	return (0);
 }
 
+static int
+Test(void *obj)
+{
+	AG_TestInstance *ti = obj;
+	AG_Window *win;
+	AG_Console *cons;
+	Uint i;
+	int rv = -1;
+
+	if ((win = AG_WindowNew(0)) == NULL) {
+		return (-1);
+	}
+	cons = AG_ConsoleNew(win, AG_CONSOLE_EXPAND);
+
+	TestMsgS(ti, "Checking line limit");
+	AG_ConsoleSetMaxLines(cons, 100);
+	for (i = 0; i < 1000; i++) {
+		AG_ConsoleMsg(cons, "Line %u", i);
+	}
+	if (cons->nLines != 100 ||
+	    strcmp(cons->lines[0]->text, "Line 900") != 0 ||
+	    strcmp(cons->lines[99]->text, "Line 999") != 0) {
+		TestMsg(ti, "Bad buffer (%u lines)", cons->nLines);
+		goto out;
+	}
+
+	TestMsgS(ti, "Checking size limit");
+	AG_ConsoleSetMaxLines(cons, 0);
+	AG_ConsoleSetMaxBytes(cons, 65536);
+	for (i = 0; i < 10000; i++) {
+		AG_ConsoleMsgS(cons, "The Quick Brown Fox Jumps Over The Lazy Dog");
+	}
+	if (cons->nBytes > 65536 || cons->nLines < 100) {
+		TestMsg(ti, "Bad buffer (%u lines, %lu bytes)", cons->nLines,
+		    (unsigned long)cons->nBytes);
+		goto out;
+	}
+
+	TestMsgS(ti, "Checking multi-line eviction");
+	AG_ConsoleSetMaxBytes(cons, 0);
+	AG_ConsoleSetMaxLines(cons, 3);
+	AG_ConsoleMsgS(cons, "1\n2\n3\n4");
+	if (cons->nLines != 3 ||
+	    strcmp(cons->lines[2]->text, "1") != 0 ||
+	    cons->lines[0]->parent != cons->lines[2] ||
+	    cons->lines[1]->parent != cons->lines[2]) {
+		TestMsgS(ti, "Bad multi-line group");
+		goto out;
+	}
+	rv = 0;
+out:
+	AG_ObjectDetach(win);
+	return (rv);
+}
+
+static int
+Bench(void *obj)
+{
+	AG_TestInstance *ti = obj;
+	AG_Window *win;
+	AG_Console *cons;
+	const Uint nLines = 200000, maxLines = 10000;
+	Uint32 t1, t2;
+	Uint i;
+
+	if ((win = AG_WindowNew(0)) == NULL) {
+		return (-1);
+	}
+	cons = AG_ConsoleNew(win, AG_CONSOLE_EXPAND);
+	AG_ConsoleSetMaxLines(cons, maxLines);
+
+	TestMsgS(ti, "");
+	TestMsgS(ti, AGSI_LEAGUE_SPARTAN "C O N S O L E   S C R O L L B A C K");
+
+	t1 = AG_GetTicks();
+	for (i = 0; i < nLines; i++) {
+		AG_ConsoleMsgS(cons, "The Quick Brown Fox Jumps Over The Lazy Dog");
+	}
+	t2 = AG_GetTicks();
+	TestMsg(ti, "\tAG_ConsoleMsgS(): %.3fus per line (%u lines retained)",
+	    (double)(t2 - t1) * 1000.0 / nLines, cons->nLines);
+
+	AG_ObjectDetach(win);
+	return (0);
+}
+
 const AG_TestCase consoleTest = {
 	AGSI_IDEOGRAM AGSI_CONSOLE AGSI_RST,
 	"console",
@@ -181,7 +267,7 @@ const AG_TestCase consoleTest = {
 	sizeof(AG_TestInstance),
 	NULL,		/* init */
 	NULL,		/* destroy */
-	NULL,		/* test */
+	Test,
 	TestGUI,
-	NULL		/* bench */
+	Bench
 };
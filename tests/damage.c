@@ -0,0 +1,120 @@
+/*	Public domain	*/
+/*
+ * Test the damaged region tracking of AG_Window(3): redrawing a widget
+ * damages its area, and moving or resizing a widget damages both its
+ * previous and its new area.
+ */
+
+#include "agartest.h"
+
+typedef struct {
+	AG_TestInstance _inherit;
+	AG_Window *win;
+} MyTestInstance;
+
+static int
+Init(void *obj)
+{
+	MyTestInstance *ti = obj;
+
+	ti->win = NULL;
+	return (0);
+}
+
+static void
+Destroy(void *obj)
+{
+	MyTestInstance *ti = obj;
+
+	if (ti->win != NULL)
+		AG_ObjectDetach(ti->win);
+}
+
+/* Check that the damaged region of the window is exactly the given area. */
+static int
+CheckDamage(MyTestInstance *ti, const char *what, const AG_Rect2 *rExp)
+{
+	const AG_Window *win = ti->win;
+	const AG_Rect2 *r = &win->rDamage;
+
+	if (win->dirty != AG_WINDOW_DIRTY_DAMAGED) {
+		TestMsg(ti, "%s: dirty=%d (expected damaged region)", what,
+		    win->dirty);
+		return (-1);
+	}
+	if (AG_RectCompare2(r, rExp) != 0) {
+		TestMsg(ti, "%s: damaged [%d,%d %dx%d] (expected [%d,%d %dx%d])",
+		    what, r->x1, r->y1, r->w, r->h,
+		    rExp->x1, rExp->y1, rExp->w, rExp->h);
+		return (-1);
+	}
+	return (0);
+}
+
+static int
+Test(void *obj)
+{
+	MyTestInstance *ti = obj;
+	AG_Window *win;
+	AG_Fixed *fx;
+	AG_Label *lbl;
+	AG_Rect2 rOld, rExp;
+
+	win = ti->win = AG_WindowNew(AG_WINDOW_NOTITLE | AG_WINDOW_NOBORDERS);
+	fx = AG_FixedNew(win, AG_FIXED_EXPAND | AG_FIXED_NO_UPDATE);
+	lbl = AG_LabelNewS(NULL, 0, "Damage");
+	AG_FixedPut(fx, lbl, 10, 10);
+	AG_FixedSize(fx, lbl, 60, 20);
+	AG_WindowSetGeometry(win, 0, 0, 320, 240);
+	AG_WindowShow(win);
+	AG_WindowUpdate(win);
+	win->dirty = 0;				/* As after rendering a frame */
+
+	TestMsgS(ti, "Redrawing a widget");
+	AG_Redraw(lbl);
+	if (CheckDamage(ti, "AG_Redraw", &AGWIDGET(lbl)->rView) == -1)
+		return (-1);
+	win->dirty = 0;
+
+	TestMsgS(ti, "Moving a widget");
+	rOld = AGWIDGET(lbl)->rView;
+	AG_WidgetSetPosition(lbl, 200, 150);
+	AG_WindowUpdate(win);
+	AG_RectUnion2(&rExp, &rOld, &AGWIDGET(lbl)->rView);
+	if (CheckDamage(ti, "Move", &rExp) == -1)
+		return (-1);
+	win->dirty = 0;
+
+	TestMsgS(ti, "Resizing a widget");
+	rOld = AGWIDGET(lbl)->rView;
+	AG_WidgetSetSize(lbl, 30, 10);
+	AG_WindowUpdate(win);
+	AG_RectUnion2(&rExp, &rOld, &AGWIDGET(lbl)->rView);
+	if (CheckDamage(ti, "Resize", &rExp) == -1)
+		return (-1);
+	win->dirty = 0;
+
+	TestMsgS(ti, "Updating without changes");
+	AG_WindowUpdate(win);
+	if (win->dirty != 0) {
+		TestMsg(ti, "Unchanged geometry: dirty=%d", win->dirty);
+		return (-1);
+	}
+
+	TestMsgS(ti, "OK");
+	return (0);
+}
+
+const AG_TestCase damageTest = {
+	AGSI_IDEOGRAM AGSI_SMALL_WINDOW AGSI_RST,
+	"damage",
+	N_("Test the damaged region of windows"),
+	"1.7.1",
+	0,
+	sizeof(MyTestInstance),
+	Init,
+	Destroy,
+	Test,
+	NULL,		/* testGUI */
+	NULL		/* bench */
+};
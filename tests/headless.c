@@ -0,0 +1,173 @@
+/*	Public domain	*/
+/*
+ * Test rendering into the display surface of the headless driver. Pixels
+ * drawn by the wide, stippled and polygon primitives are read back with
+ * videoCapture() and compared against their expected coverage.
+ */
+
+#include "agartest.h"
+
+#include <string.h>
+
+typedef struct {
+	AG_TestInstance _inherit;
+	AG_Window *win;
+	AG_Surface *S;
+} MyTestInstance;
+
+static int
+Init(void *obj)
+{
+	MyTestInstance *ti = obj;
+
+	ti->win = NULL;
+	ti->S = NULL;
+	return (0);
+}
+
+static void
+Destroy(void *obj)
+{
+	MyTestInstance *ti = obj;
+
+	if (ti->S != NULL) {
+		AG_SurfaceFree(ti->S);
+	}
+	if (ti->win != NULL)
+		AG_ObjectDetach(ti->win);
+}
+
+/* Replace the captured surface with a new capture of the display. */
+static int
+Capture(MyTestInstance *ti, AG_Driver *drv)
+{
+	if (ti->S != NULL) {
+		AG_SurfaceFree(ti->S);
+	}
+	if ((ti->S = AGDRIVER_SW_CLASS(drv)->videoCapture(drv)) == NULL) {
+		TestMsg(ti, "videoCapture: %s", AG_GetError());
+		return (-1);
+	}
+	return (0);
+}
+
+/* Check whether the captured pixel at x,y has color c (or not). */
+static int
+CheckPixel(MyTestInstance *ti, const char *what, int x, int y,
+    const AG_Color *c, int expectSet)
+{
+	const AG_Pixel px = AG_SurfaceGet(ti->S, x,y);
+	const int isSet = (px == AG_MapPixel(&ti->S->format, c));
+
+	if (isSet != expectSet) {
+		TestMsg(ti, "%s: pixel %d,%d is %s (0x%lx)", what, x,y,
+		    isSet ? "set" : "not set", (Ulong)px);
+		return (-1);
+	}
+	return (0);
+}
+
+static int
+Test(void *obj)
+{
+	MyTestInstance *ti = obj;
+	AG_Driver *drv;
+	AG_DriverClass *dc;
+	AG_Color cBg, cFg;
+	AG_Pt pts[4];
+	Uint8 stipple[32*4];
+	int x, y, nSet;
+
+	if (agDriverSw == NULL ||
+	    strcmp(AGDRIVER_CLASS(agDriverSw)->name, "headless") != 0) {
+		TestMsgS(ti, "Not using the headless driver; skipping");
+		return (0);
+	}
+	drv = AGDRIVER(agDriverSw);
+	dc = AGDRIVER_CLASS(drv);
+
+	AG_ColorRGB_8(&cBg, 0,0,0);
+	AG_ColorRGB_8(&cFg, 255,0,0);
+	AGDRIVER_SW_CLASS(drv)->videoClear(drv, &cBg);
+
+	/* Horizontal line of width 5, centered on row 10. */
+	dc->drawLineW(drv, 10,10, 90,10, &cFg, 5.0f);
+
+	/* Stippled line: 8 pixels on, 8 pixels off. */
+	dc->drawLineW_Sti16(drv, 10,30, 73,30, &cFg, 1.0f, 0x00ff);
+
+	/* Square filled with a pattern of 4 columns on, 4 columns off. */
+	memset(stipple, 0xf0, sizeof(stipple));
+	pts[0].x = 100;  pts[0].y = 100;
+	pts[1].x = 140;  pts[1].y = 100;
+	pts[2].x = 140;  pts[2].y = 140;
+	pts[3].x = 100;  pts[3].y = 140;
+	dc->drawPolygonSti32(drv, pts, 4, &cFg, stipple);
+
+	if (Capture(ti, drv) == -1)
+		return (-1);
+
+	TestMsgS(ti, "Checking drawLineW()");
+	for (y = 8; y <= 12; y++) {
+		if (CheckPixel(ti, "drawLineW", 50,y, &cFg, 1) == -1)
+			return (-1);
+	}
+	if (CheckPixel(ti, "drawLineW", 50,5, &cFg, 0) == -1 ||
+	    CheckPixel(ti, "drawLineW", 50,15, &cFg, 0) == -1)
+		return (-1);
+
+	TestMsgS(ti, "Checking drawLineW_Sti16()");
+	for (x = 10; x <= 73; x++) {
+		const int on = (((x - 10) & 15) < 8);
+
+		if (CheckPixel(ti, "drawLineW_Sti16", x,30, &cFg, on) == -1)
+			return (-1);
+	}
+
+	TestMsgS(ti, "Checking drawPolygonSti32()");
+	for (y = 105, nSet = 0; y < 135; y++) {
+		for (x = 105; x < 135; x++) {
+			const int on = ((x & 7) < 4);
+
+			if (CheckPixel(ti, "drawPolygonSti32", x,y, &cFg,
+			    on) == -1) {
+				return (-1);
+			}
+			nSet += on;
+		}
+	}
+	if (CheckPixel(ti, "drawPolygonSti32", 150,120, &cFg, 0) == -1)
+		return (-1);
+	TestMsg(ti, "%d stippled pixels", nSet);
+
+	/* Render a window through the regular widget drawing path. */
+	TestMsgS(ti, "Rendering a window");
+	AGDRIVER_SW_CLASS(drv)->videoClear(drv, &cBg);
+	ti->win = AG_WindowNew(AG_WINDOW_NOTITLE | AG_WINDOW_NOBORDERS);
+	AG_LabelNewS(ti->win, 0, "Headless");
+	AG_WindowSetGeometry(ti->win, 200, 200, 120, 60);
+	AG_WindowShow(ti->win);
+	AG_WindowDrawQueued();
+	if (Capture(ti, drv) == -1)
+		return (-1);
+	if (CheckPixel(ti, "Window", 260,250, &cBg, 0) == -1 ||
+	    CheckPixel(ti, "Window", 100,50, &cBg, 1) == -1)
+		return (-1);
+
+	TestMsgS(ti, "OK");
+	return (0);
+}
+
+const AG_TestCase headlessTest = {
+	AGSI_IDEOGRAM AGSI_RENDER_TO_SURFACE AGSI_RST,
+	"headless",
+	N_("Test rendering with the headless driver"),
+	"1.7.1",
+	0,
+	sizeof(MyTestInstance),
+	Init,
+	Destroy,
+	Test,
+	NULL,		/* testGUI */
+	NULL		/* bench */
+};
@@ -53,6 +53,41 @@ Destroy(void *obj)
 	}
 }
 
+static int
+Test(void *obj)
+{
+	AG_TestInstance *ti = obj;
+	AG_ObjectClass *const *hier;
+	AG_Object *mammal;
+	int nHier, rv = -1;
+
+	mammal = AG_ObjectNew(NULL, "Mammal", &myMammalClass);
+
+	TestMsgS(ti, "Checking inheritance hierarchy of MY_Mammal");
+	if ((hier = AG_ObjectGetClassHier(mammal, &nHier)) == NULL) {
+		TestMsg(ti, "AG_ObjectGetClassHier: %s", AG_GetError());
+		goto out;
+	}
+	if (nHier != 2 || hier[0] != &myAnimalClass ||
+	    hier[1] != &myMammalClass) {
+		TestMsg(ti, "Bad hierarchy (%d classes)", nHier);
+		goto out;
+	}
+	if (!AG_ClassIsA(&myMammalClass, &myAnimalClass) ||
+	    !AG_ClassIsA(&myMammalClass, &agObjectClass) ||
+	    AG_ClassIsA(&myAnimalClass, &myMammalClass) ||
+	    !AG_OfClass(mammal, "MY_Animal:*") ||
+	    !AG_OfClass(mammal, "*:MY_Mammal:*") ||
+	    AG_OfClass(mammal, "MY_Animal")) {
+		TestMsgS(ti, "Bad class membership test");
+		goto out;
+	}
+	rv = 0;
+out:
+	AG_ObjectDestroy(mammal);
+	return (rv);
+}
+
 static int
 TestGUI(void *obj, AG_Window *win)
 {
@@ -86,7 +121,7 @@ const AG_TestCase objsystemTest = {
 	sizeof(MyTestInstance),
 	Init,
 	Destroy,
-	NULL,		/* test */
+	Test,
 	TestGUI,
 	NULL		/* bench */
 };
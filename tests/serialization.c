@@ -0,0 +1,445 @@
+/*	Public domain	*/
+/*
+ * Test AG_DataSource(3) serialization through the buffered fast path.
+ */
+
+#include "agartest.h"
+
+#include <string.h>
+
+#define NELEMS 4096			/* Elements in bulk arrays */
+
+typedef struct {
+	AG_TestInstance _inherit;
+	char path[AG_PATHNAME_MAX];	/* Temporary file */
+	Uint32 u32[NELEMS];		/* Test patterns */
+	Uint16 u16[NELEMS];
+	float flt[NELEMS];
+	double dbl[NELEMS];
+	Uint32 u32In[NELEMS];		/* Read back */
+	Uint16 u16In[NELEMS];
+	float fltIn[NELEMS];
+	double dblIn[NELEMS];
+} MyTestInstance;
+
+static int
+Init(void *obj)
+{
+	MyTestInstance *ti = obj;
+	int i;
+
+	AG_ConfigGetPath(AG_CONFIG_PATH_TEMP, 0, ti->path, sizeof(ti->path));
+	Strlcat(ti->path, AG_PATHSEP, sizeof(ti->path));
+	Strlcat(ti->path, "agartest-serialization.dat", sizeof(ti->path));
+
+	for (i = 0; i < NELEMS; i++) {
+		ti->u32[i] = (Uint32)i * 2654435761U;
+		ti->u16[i] = (Uint16)(i * 40503);
+		ti->flt[i] = (float)i / 3.0f;
+		ti->dbl[i] = (double)i * 1.0e-3;
+	}
+	return (0);
+}
+
+static void
+Destroy(void *obj)
+{
+	MyTestInstance *ti = obj;
+
+	if (AG_FileExists(ti->path) == 1)
+		AG_FileDelete(ti->path);
+}
+
+/* Write a mix of scalars, strings and arrays. */
+static void
+WriteRecord(MyTestInstance *ti, AG_DataSource *ds, AG_Offset *posPatch)
+{
+	AG_WriteUint8(ds, 0xa5);
+	AG_WriteSint16(ds, -1234);
+	*posPatch = AG_Tell(ds);
+	AG_WriteUint32(ds, 0);				/* Patched later */
+#ifdef AG_HAVE_64BIT
+	AG_WriteUint64(ds, 0x0123456789abcdefULL);
+#endif
+	AG_WriteFloat(ds, 1.5f);
+	AG_WriteDouble(ds, -2.25);
+	AG_WriteString(ds, "Hello, world");
+	AG_WriteStringPadded(ds, "Padded", 32);
+	AG_WriteUint32v(ds, ti->u32, NELEMS);
+	AG_WriteUint16v(ds, ti->u16, NELEMS);
+	AG_WriteFloatv(ds, ti->flt, NELEMS);
+	AG_WriteDoublev(ds, ti->dbl, NELEMS);
+	AG_WriteUint32(ds, 0xdeadbeef);
+}
+
+static int
+CheckRecord(MyTestInstance *ti, AG_DataSource *ds)
+{
+	char buf[8];
+	char *s;
+
+	if (AG_ReadUint8(ds) != 0xa5 ||
+	    AG_ReadSint16(ds) != -1234 ||
+	    AG_ReadUint32(ds) != 0x12345678) {
+		TestMsg(ti, "Scalar mismatch");
+		return (-1);
+	}
+#ifdef AG_HAVE_64BIT
+	if (AG_ReadUint64(ds) != 0x0123456789abcdefULL) {
+		TestMsg(ti, "Uint64 mismatch");
+		return (-1);
+	}
+#endif
+	if (AG_ReadFloat(ds) != 1.5f ||
+	    AG_ReadDouble(ds) != -2.25) {
+		TestMsg(ti, "Real mismatch");
+		return (-1);
+	}
+	if (AG_CopyString(buf, ds, sizeof(buf)) < sizeof(buf) ||
+	    strcmp(buf, "Hello, ") != 0) {
+		TestMsg(ti, "Truncated string mismatch (\"%s\")", buf);
+		return (-1);
+	}
+	if ((s = AG_ReadStringPadded(ds, 32)) == NULL ||
+	    strcmp(s, "Padded") != 0) {
+		TestMsg(ti, "Padded string mismatch");
+		return (-1);
+	}
+	Free(s);
+
+	AG_ReadUint32v(ds, ti->u32In, NELEMS);
+	AG_ReadUint16v(ds, ti->u16In, NELEMS);
+	AG_ReadFloatv(ds, ti->fltIn, NELEMS);
+	AG_ReadDoublev(ds, ti->dblIn, NELEMS);
+	if (memcmp(ti->u32In, ti->u32, sizeof(ti->u32)) != 0 ||
+	    memcmp(ti->u16In, ti->u16, sizeof(ti->u16)) != 0 ||
+	    memcmp(ti->fltIn, ti->flt, sizeof(ti->flt)) != 0 ||
+	    memcmp(ti->dblIn, ti->dbl, sizeof(ti->dbl)) != 0) {
+		TestMsg(ti, "Array mismatch");
+		return (-1);
+	}
+	if (AG_ReadUint32(ds) != 0xdeadbeef) {
+		TestMsg(ti, "Trailer mismatch");
+		return (-1);
+	}
+	return (0);
+}
+
+static int
+TestSource(MyTestInstance *ti, AG_DataSource *ds, AG_ByteOrder order)
+{
+	AG_Offset posPatch, posEnd;
+
+	AG_SetByteOrder(ds, order);
+	WriteRecord(ti, ds, &posPatch);
+	posEnd = AG_Tell(ds);
+
+	/* Patch a value that may still be sitting in the write buffer. */
+	AG_WriteUint32At(ds, 0x12345678, posPatch);
+	if (AG_Tell(ds) != posEnd) {
+		TestMsg(ti, "AG_WriteAt() moved the offset");
+		return (-1);
+	}
+	AG_Seek(ds, 0, AG_SEEK_SET);
+	if (CheckRecord(ti, ds) == -1) {
+		return (-1);
+	}
+	if (AG_Tell(ds) != posEnd) {
+		TestMsg(ti, "AG_Tell() mismatch (%ld != %ld)",
+		    (long)AG_Tell(ds), (long)posEnd);
+		return (-1);
+	}
+
+	/* Seek backwards and forwards within the read window. */
+	AG_Seek(ds, posPatch, AG_SEEK_SET);
+	AG_ReadUint32(ds);
+	AG_Seek(ds, -4, AG_SEEK_CUR);
+	if (AG_ReadUint32(ds) != 0x12345678) {
+		TestMsg(ti, "AG_Seek(CUR) mismatch");
+		return (-1);
+	}
+	return (0);
+}
+
+/*
+ * Alternate between reading and writing without an explicit flush (which
+ * requires the underlying stream to be repositioned).
+ */
+static int
+TestReadAfterWrite(MyTestInstance *ti, AG_DataSource *ds)
+{
+	Uint8 data[64], in[4];
+	const Uint8 patch[4] = { 0xde, 0xad, 0xbe, 0xef };
+	int i;
+
+	for (i = 0; i < 64; i++) {
+		data[i] = (Uint8)i;
+	}
+	if (AG_Write(ds, data, sizeof(data)) != 0 ||
+	    AG_Seek(ds, 8, AG_SEEK_SET) != 0 ||
+	    AG_Write(ds, patch, sizeof(patch)) != 0 ||
+	    AG_Read(ds, in, sizeof(in)) != 0) {
+		TestMsg(ti, "Write then read: %s", AG_GetError());
+		return (-1);
+	}
+	if (memcmp(in, &data[12], sizeof(in)) != 0 || AG_Tell(ds) != 16) {
+		TestMsg(ti, "Write then read: mismatch (offset %ld)",
+		    (long)AG_Tell(ds));
+		return (-1);
+	}
+	if (AG_Write(ds, patch, sizeof(patch)) != 0 || AG_Tell(ds) != 20) {
+		TestMsg(ti, "Read then write: mismatch (offset %ld)",
+		    (long)AG_Tell(ds));
+		return (-1);
+	}
+
+	/* Write after the input has been consumed entirely. */
+	if (AG_Seek(ds, 48, AG_SEEK_SET) != 0 ||
+	    AG_Read(ds, data, 16) != 0 ||
+	    AG_Write(ds, patch, sizeof(patch)) != 0 ||
+	    AG_Seek(ds, 16, AG_SEEK_SET) != 0 ||
+	    AG_Read(ds, in, sizeof(in)) != 0 ||
+	    memcmp(in, patch, sizeof(in)) != 0 ||
+	    AG_Seek(ds, 64, AG_SEEK_SET) != 0 ||
+	    AG_Read(ds, in, sizeof(in)) != 0 ||
+	    memcmp(in, patch, sizeof(in)) != 0) {
+		TestMsg(ti, "Write at end of input: mismatch");
+		return (-1);
+	}
+	return (0);
+}
+
+/* Borrow the bulk arrays of a record in place. */
+static int
+CheckBorrow(MyTestInstance *ti, AG_DataSource *ds)
+{
+	const Uint8 *p, *pAt;
+	AG_Offset pos;
+	AG_Size len;
+
+	if (ds->borrow == NULL) {
+		TestMsg(ti, "Borrowing not supported; skipping");
+		return (0);
+	}
+	pos = AG_Tell(ds) - 4 - sizeof(ti->dbl);
+	AG_Seek(ds, pos, AG_SEEK_SET);
+	if ((p = AG_BorrowData(ds, sizeof(ti->dbl))) == NULL ||
+	    memcmp(p, ti->dbl, sizeof(ti->dbl)) != 0) {
+		TestMsg(ti, "AG_BorrowData() mismatch");
+		return (-1);
+	}
+	if (AG_Tell(ds) != pos + (AG_Offset)sizeof(ti->dbl)) {
+		TestMsg(ti, "AG_BorrowData() did not advance");
+		return (-1);
+	}
+	if ((pAt = AG_BorrowDataAt(ds, sizeof(ti->dbl), pos)) != p) {
+		TestMsg(ti, "AG_BorrowDataAt() mismatch");
+		return (-1);
+	}
+	if (AG_BorrowData(ds, 5) != NULL) {
+		TestMsg(ti, "AG_BorrowData() past end succeeded");
+		return (-1);
+	}
+	if (AG_BorrowDataP(ds, 5, &len) == NULL || len != 4 ||
+	    AG_BorrowDataP(ds, 5, &len) == NULL || len != 0) {
+		TestMsg(ti, "AG_BorrowDataP() mismatch");
+		return (-1);
+	}
+	return (0);
+}
+
+static int
+Test(void *obj)
+{
+	MyTestInstance *ti = obj;
+	AG_DataSource *ds;
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		AG_ByteOrder order = (i == 0) ? AG_BYTEORDER_BE : AG_BYTEORDER_LE;
+		const char *orderName = (i == 0) ? "big" : "little";
+
+		TestMsg(ti, "AutoCore source (%s-endian)", orderName);
+		if ((ds = AG_OpenAutoCore()) == NULL) {
+			return (-1);
+		}
+		if (TestSource(ti, ds, order) == -1) {
+			AG_CloseAutoCore(ds);
+			return (-1);
+		}
+		AG_CloseAutoCore(ds);
+
+		if (i == 0) {
+			TestMsg(ti, "File source, reading after writing");
+			if ((ds = AG_OpenFile(ti->path, "w+b")) == NULL) {
+				TestMsg(ti, "%s", AG_GetError());
+				return (-1);
+			}
+			if (TestReadAfterWrite(ti, ds) == -1) {
+				AG_CloseFile(ds);
+				return (-1);
+			}
+			AG_CloseFile(ds);
+		}
+
+		TestMsg(ti, "File source (%s-endian)", orderName);
+		if ((ds = AG_OpenFile(ti->path, "w+b")) == NULL) {
+			TestMsg(ti, "%s", AG_GetError());
+			return (-1);
+		}
+		if (TestSource(ti, ds, order) == -1) {
+			AG_CloseFile(ds);
+			return (-1);
+		}
+		AG_CloseFile(ds);
+
+		TestMsg(ti, "File source, reopened (%s-endian)", orderName);
+		if ((ds = AG_OpenFile(ti->path, "rb")) == NULL) {
+			TestMsg(ti, "%s", AG_GetError());
+			return (-1);
+		}
+		AG_SetByteOrder(ds, order);
+		if (CheckRecord(ti, ds) == -1) {
+			AG_CloseFile(ds);
+			return (-1);
+		}
+		AG_CloseFile(ds);
+
+		TestMsg(ti, "Mapped file source (%s-endian)", orderName);
+		if ((ds = AG_OpenMappedFile(ti->path, AG_MAPPED_SEQUENTIAL)) == NULL) {
+			TestMsg(ti, "%s", AG_GetError());
+			return (-1);
+		}
+		AG_SetByteOrder(ds, order);
+		if (CheckRecord(ti, ds) == -1 ||
+		    CheckBorrow(ti, ds) == -1) {
+			AG_CloseMappedFile(ds);
+			return (-1);
+		}
+		AG_CloseMappedFile(ds);
+	}
+	TestMsg(ti, "OK");
+	return (0);
+}
+
+/* Write and read back NELEMS Uint32s, one at a time or in bulk. */
+static void
+Bench_Uint32(MyTestInstance *ti, AG_DataSource *ds, int bulk)
+{
+	int i;
+
+	AG_Seek(ds, 0, AG_SEEK_SET);
+	if (bulk) {
+		AG_WriteUint32v(ds, ti->u32, NELEMS);
+	} else {
+		for (i = 0; i < NELEMS; i++)
+			AG_WriteUint32(ds, ti->u32[i]);
+	}
+	AG_Seek(ds, 0, AG_SEEK_SET);
+	if (bulk) {
+		AG_ReadUint32v(ds, ti->u32In, NELEMS);
+	} else {
+		for (i = 0; i < NELEMS; i++)
+			ti->u32In[i] = AG_ReadUint32(ds);
+	}
+}
+
+static void
+Bench_Throughput(MyTestInstance *ti, AG_DataSource *ds, const char *name)
+{
+	const Uint nPasses = 500;
+	Uint i, t1, t2, bulk;
+
+	for (bulk = 0; bulk < 2; bulk++) {
+		t1 = AG_GetTicks();
+		for (i = 0; i < nPasses; i++) {
+			Bench_Uint32(ti, ds, bulk);
+		}
+		t2 = AG_GetTicks();
+		if (t2 > t1) {
+			TestMsg(ti, "\t%s (%s): %lu MB/s", name,
+			    bulk ? "AG_ReadUint32v" : "AG_ReadUint32",
+			    (Ulong)nPasses*NELEMS*4*2 / 1000UL / (t2 - t1));
+		}
+	}
+}
+
+/* Read back a file of nPasses*NELEMS Uint32s with AG_ReadUint32(). */
+static void
+Bench_ReadFile(MyTestInstance *ti, Uint nPasses, int mapped)
+{
+	AG_DataSource *ds;
+	Uint i, j, t1, t2;
+	Uint32 sum = 0;
+
+	t1 = AG_GetTicks();
+	ds = mapped ? AG_OpenMappedFile(ti->path, AG_MAPPED_SEQUENTIAL) :
+	              AG_OpenFile(ti->path, "rb");
+	if (ds == NULL) {
+		TestMsg(ti, "%s", AG_GetError());
+		return;
+	}
+	for (i = 0; i < nPasses; i++) {
+		for (j = 0; j < NELEMS; j++)
+			sum += AG_ReadUint32(ds);
+	}
+	AG_CloseDataSource(ds);
+	t2 = AG_GetTicks();
+	if (t2 > t1) {
+		TestMsg(ti, "\t%s: %lu MB/s (sum %x)",
+		    mapped ? "AG_OpenMappedFile" : "AG_OpenFile",
+		    (Ulong)nPasses*NELEMS*4 / 1000UL / (t2 - t1), (Uint)sum);
+	}
+}
+
+static int
+Bench(void *obj)
+{
+	MyTestInstance *ti = obj;
+	AG_DataSource *ds;
+	int i;
+
+	TestMsg(ti, "");
+	TestMsg(ti, AGSI_LEAGUE_SPARTAN "S E R I A L I Z A T I O N   B E N C H M A R K S");
+	TestMsg(ti, "Uint32 write+read throughput:");
+
+	if ((ds = AG_OpenAutoCore()) == NULL) {
+		return (-1);
+	}
+	Bench_Throughput(ti, ds, "AutoCore");
+	AG_CloseAutoCore(ds);
+
+	if ((ds = AG_OpenFile(ti->path, "w+b")) == NULL) {
+		TestMsg(ti, "%s", AG_GetError());
+		return (-1);
+	}
+	Bench_Throughput(ti, ds, "File");
+	AG_CloseFile(ds);
+
+	TestMsg(ti, "Sequential read of a 64MB file:");
+	if ((ds = AG_OpenFile(ti->path, "wb")) == NULL) {
+		TestMsg(ti, "%s", AG_GetError());
+		return (-1);
+	}
+	for (i = 0; i < 1024; i++) {
+		AG_WriteUint32v(ds, ti->u32, NELEMS);
+	}
+	AG_CloseFile(ds);
+	Bench_ReadFile(ti, 1024, 0);
+	Bench_ReadFile(ti, 1024, 1);
+	return (0);
+}
+
+const AG_TestCase serializationTest = {
+	AGSI_IDEOGRAM AGSI_FILESYSTEM AGSI_RST,
+	"serialization",
+	N_("Test AG_DataSource(3) serialization and throughput"),
+	"1.7.1",
+	0,
+	sizeof(MyTestInstance),
+	Init,
+	Destroy,
+	Test,
+	NULL,		/* testGUI */
+	Bench
+};
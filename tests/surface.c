@@ -20,6 +20,7 @@ typedef struct {
 	AG_Surface *_Nullable Sparrot;
 	AG_Surface *_Nullable S[24];
 	int nSurfaces;
+	AG_Surface *_Nullable Sblit[3];		/* 32-bit RGBA, RGB and target */
 	AG_Color randColorA;
 	AG_Color randColorNoA;
 } MyTestInstance;
@@ -144,6 +145,12 @@ Init(void *obj)
 	ti->nSurfaces = 16;
 #endif
 
+	/* 32-bit surfaces in the standard format for the blitter tests. */
+	ti->Sblit[0] = AG_SurfaceStdRGBA(256,256);
+	ti->Sblit[1] = AG_SurfaceRGB(256,256, 32, 0,
+	    agSurfaceFmt->Rmask, agSurfaceFmt->Gmask, agSurfaceFmt->Bmask);
+	ti->Sblit[2] = AG_SurfaceStdRGBA(256,256);
+
 	RandomizeColors(ti);
 	ClearSurfaces(ti);
 	return (0);
@@ -162,6 +169,137 @@ Destroy(void *obj)
 
 	for (i = 0; i < ti->nSurfaces; i++)
 		AG_SurfaceFree(ti->S[i]);
+	for (i = 0; i < 3; i++)
+		AG_SurfaceFree(ti->Sblit[i]);
+}
+
+/* Fill a 32-bit surface with pseudo-random pixels (including alpha). */
+static void
+RandomizeBlitSurface(AG_Surface *S, Uint32 seed)
+{
+	Uint8 *p = S->pixels;
+	int x, y;
+
+	for (y = 0; y < S->h; y++) {
+		for (x = 0; x < S->w; x++) {
+			seed = seed*1103515245 + 12345;
+			AG_SurfacePut32_At(S, p, seed ^ (seed >> 16));
+			p += 4;
+		}
+		p += S->padding;
+	}
+}
+
+/*
+ * Blit Ssrc to Sdst with the current blitter selection and compare the
+ * result against the same blit with SIMD blitters disabled, and against
+ * a reference computed with AG_SurfaceBlend().
+ */
+static int
+TestBlit32Case(MyTestInstance *ti, AG_Surface *Ssrc, AG_Surface *Sdst,
+    const char *what)
+{
+	const Uint32 extSave = agCPU.ext;
+	AG_Surface *Sref, *Sfast, *Sscalar;
+	int x, y, rv = 0;
+
+	Sref = AG_SurfaceDup(Sdst);
+	Sfast = AG_SurfaceDup(Sdst);
+	Sscalar = AG_SurfaceDup(Sdst);
+
+	for (y = 0; y < Ssrc->h; y++) {
+		for (x = 0; x < Ssrc->w; x++) {
+			AG_Pixel px = AG_SurfaceGet(Ssrc, x,y);
+			AG_Color c;
+
+			if ((Ssrc->flags & AG_SURFACE_COLORKEY) &&
+			    px == Ssrc->colorkey) {
+				continue;
+			}
+			AG_GetColor(&c, px, &Ssrc->format);
+			if (c.a > Ssrc->alpha) { c.a = Ssrc->alpha; }
+			if (c.a != AG_TRANSPARENT)
+				AG_SurfaceBlend(Sref, x,y, &c);
+		}
+	}
+
+	AG_SurfaceBlit(Ssrc, NULL, Sfast, 0,0);
+	agCPU.ext &= ~(AG_EXT_SSE2 | AG_EXT_AVX2);
+	AG_SurfaceBlit(Ssrc, NULL, Sscalar, 0,0);
+	agCPU.ext = extSave;
+
+	for (y = 0; y < Sdst->h && rv == 0; y++) {
+		for (x = 0; x < Sdst->w; x++) {
+			const Uint32 pxFast = AG_SurfaceGet32(Sfast, x,y);
+			const Uint32 pxRef = AG_SurfaceGet32(Sref, x,y);
+			int i;
+
+			if (pxFast != AG_SurfaceGet32(Sscalar, x,y)) {
+				TestMsg(ti, "%s: SIMD/scalar mismatch at %d,%d",
+				    what, x,y);
+				rv = -1;
+				break;
+			}
+			for (i = 0; i < 32; i += 8) {
+				const int d = (int)((pxFast >> i) & 0xff) -
+				              (int)((pxRef >> i) & 0xff);
+				if (d < -1 || d > 1)
+					break;
+			}
+			if (i < 32) {
+				TestMsg(ti, "%s: 0x%08x != 0x%08x at %d,%d",
+				    what, pxFast, pxRef, x,y);
+				rv = -1;
+				break;
+			}
+		}
+	}
+	AG_SurfaceFree(Sref);
+	AG_SurfaceFree(Sfast);
+	AG_SurfaceFree(Sscalar);
+	return (rv);
+}
+
+static int
+TestBlit32(MyTestInstance *ti)
+{
+	AG_Surface *Sdst = ti->Sblit[2];
+	int i;
+
+	RandomizeBlitSurface(Sdst, 1234);
+
+	for (i = 0; i < 2; i++) {
+		AG_Surface *S = ti->Sblit[i];
+		const char *fmt = (i == 0) ? "RGBA" : "RGB";
+		char what[64];
+
+		RandomizeBlitSurface(S, 5678+i);
+		AG_SurfaceSetColorKey(S, 0, 0);
+		AG_SurfaceSetAlpha(S, 0, AG_OPAQUE);
+
+		Snprintf(what, sizeof(what), "%s", fmt);
+		if (TestBlit32Case(ti, S, Sdst, what) == -1)
+			return (-1);
+
+		AG_SurfaceSetAlpha(S, AG_SURFACE_ALPHA, AG_OPAQUE/2);
+		Snprintf(what, sizeof(what), "%s, alpha", fmt);
+		if (TestBlit32Case(ti, S, Sdst, what) == -1)
+			return (-1);
+
+		AG_SurfaceSetColorKey(S, AG_SURFACE_COLORKEY,
+		    AG_SurfaceGet(S, 10,10));
+		Snprintf(what, sizeof(what), "%s, alpha, colorkey", fmt);
+		if (TestBlit32Case(ti, S, Sdst, what) == -1)
+			return (-1);
+
+		AG_SurfaceSetAlpha(S, 0, AG_OPAQUE);
+		Snprintf(what, sizeof(what), "%s, colorkey", fmt);
+		if (TestBlit32Case(ti, S, Sdst, what) == -1)
+			return (-1);
+
+		AG_SurfaceSetColorKey(S, 0, 0);
+	}
+	return (0);
 }
 
 static void
@@ -277,6 +415,13 @@ Test(void *obj)
 	}
 
 	RandomizeSurfaces(ti);
+
+	TestMsg(ti, "");
+	TestMsg(ti, "Testing 32-bit blitters (cpu 0x%x)...", agCPU.ext);
+	if (TestBlit32(ti) == -1) {
+		return (-1);
+	}
+	TestMsg(ti, "OK");
 	return (0);
 }
 
@@ -586,6 +731,46 @@ struct ag_benchmark blitOps = {
 	10, 100, 10000000
 };
 
+/*
+ * 32-bit blitters (256x256 source). Bits 0-1 of arg select the source
+ * surface capabilities; bit 2 selects the RGB (no alpha channel) source
+ * and bit 3 restricts the blit to the scalar fallback.
+ */
+static void
+Bench_Blit32(void *obj, int arg)
+{
+	MyTestInstance *ti = obj;
+	AG_Surface *S = ti->Sblit[(arg & 4) ? 1 : 0];
+	const Uint32 extSave = agCPU.ext;
+
+	AG_SurfaceSetAlpha(S, (arg & 1) ? AG_SURFACE_ALPHA : 0,
+	    (arg & 1) ? AG_OPAQUE/2 : AG_OPAQUE);
+	AG_SurfaceSetColorKey(S, (arg & 2) ? AG_SURFACE_COLORKEY : 0, 0);
+	if (arg & 8) {
+		agCPU.ext &= ~(AG_EXT_SSE2 | AG_EXT_AVX2);
+	}
+	AG_SurfaceBlit(S, NULL, ti->Sblit[2], 0,0);
+	agCPU.ext = extSave;
+}
+static struct ag_benchmark_fn blit32OpsFns[] = {
+	{ "AG_SurfaceBlit(RGBA <- RGBA)",                Bench_Blit32, 0 },
+	{ "AG_SurfaceBlit(RGBA <- RGBA, alpha)",         Bench_Blit32, 1 },
+	{ "AG_SurfaceBlit(RGBA <- RGBA, colorkey)",      Bench_Blit32, 2 },
+	{ "AG_SurfaceBlit(RGBA <- RGBA, alpha+colorkey)",Bench_Blit32, 3 },
+	{ "AG_SurfaceBlit(RGBA <- RGB)",                 Bench_Blit32, 4 },
+	{ "AG_SurfaceBlit(RGBA <- RGB, colorkey)",       Bench_Blit32, 6 },
+	{ "AG_SurfaceBlit(RGBA <- RGBA) [scalar]",       Bench_Blit32, 8 },
+	{ "AG_SurfaceBlit(RGBA <- RGBA, alpha) [scalar]",Bench_Blit32, 9 },
+	{ "AG_SurfaceBlit(RGBA <- RGBA, colorkey) [scalar]", Bench_Blit32, 10 },
+	{ "AG_SurfaceBlit(RGBA <- RGB) [scalar]",        Bench_Blit32, 12 },
+};
+struct ag_benchmark blit32Ops = {
+	"AG_SurfaceBlit(3) 32-bit",
+	&blit32OpsFns[0],
+	sizeof(blit32OpsFns) / sizeof(blit32OpsFns[0]),
+	10, 100, 0
+};
+
 static int
 Bench(void *obj)
 {
@@ -597,6 +782,9 @@ Bench(void *obj)
 	TestMsg(ti, "AG_SurfaceBlit():");
 	TestExecBenchmark(obj, &blitOps);
 
+	TestMsg(ti, "AG_SurfaceBlit() 32-bit (cpu 0x%x):", agCPU.ext);
+	TestExecBenchmark(obj, &blit32Ops);
+
 //	TestMsg(ti, "AG_FillRect():");
 //	TestExecBenchmark(obj, &fillRectOps);
 
@@ -12,6 +12,9 @@
  *
  * In EXAMPLE 3, we show how arbitrary widgets can be inserted into a Table
  * and just how conveniently Agar bindings can handle the situation.
+ *
+ * The non-interactive test and benchmark exercise keyed rows
+ * (AG_TableAddRowKeyed()).
  */
 
 #include "agartest.h"
@@ -333,6 +336,134 @@ TestGUI(void *obj, AG_Window *win)
 	return (0);
 }
 
+/* Return the row whose first cell is the given integer (or -1). */
+static int
+FindRow(AG_Table *t, int i)
+{
+	int m;
+
+	for (m = 0; m < t->m; m++) {
+		if (t->cells[m][0].data.i == i)
+			return (m);
+	}
+	return (-1);
+}
+
+static int
+Test(void *obj)
+{
+	AG_TestInstance *ti = obj;
+	AG_Table *t;
+	int i, m5, m50, su5, su50;
+	int rv = -1;
+
+	t = AG_TableNew(NULL, 0);
+	AG_TableAddCol(t, "A", NULL, NULL);
+	AG_TableAddCol(t, "B", NULL, NULL);
+
+	TestMsgS(ti, "Inserting 100 keyed rows");
+	AG_TableBegin(t);
+	for (i = 0; i < 100; i++) {
+		AG_TableAddRowKeyed(t, i, "%d:%s", i, "Row");
+	}
+	AG_TableEnd(t);
+	if (t->m != 100 || !(t->flags & AG_TABLE_KEYED)) {
+		TestMsg(ti, "Bad row count (%d)", t->m);
+		goto out;
+	}
+	m5 = FindRow(t, 5);
+	m50 = FindRow(t, 50);
+	su5 = AG_WidgetMapSurface(t, AG_SurfaceStdRGB(1,1));
+	su50 = AG_WidgetMapSurface(t, AG_SurfaceStdRGB(1,1));
+	t->cells[m5][1].surface = su5;
+	t->cells[m50][1].surface = su50;
+	AG_TableSelectRow(t, m5);
+
+	TestMsgS(ti, "Updating one row and removing another");
+	AG_TableBegin(t);
+	for (i = 1; i < 100; i++) {
+		AG_TableAddRowKeyed(t, i, "%d:%s", i, (i == 50) ? "Changed" : "Row");
+	}
+	AG_TableEnd(t);
+	if (t->m != 99 || FindRow(t, 0) != -1) {
+		TestMsg(ti, "Row 0 not removed (%d rows)", t->m);
+		goto out;
+	}
+	m5 = FindRow(t, 5);
+	m50 = FindRow(t, 50);
+	if (t->cells[m5][1].surface != su5 || !AG_TableRowSelected(t, m5)) {
+		TestMsgS(ti, "Unchanged row lost its surface or selection");
+		goto out;
+	}
+	if (t->cells[m50][1].surface != -1 ||
+	    strcmp(t->cells[m50][1].data.s, "Changed") != 0) {
+		TestMsgS(ti, "Changed row was not updated");
+		goto out;
+	}
+
+	TestMsgS(ti, "Clearing");
+	AG_TableClear(t);
+	AG_TableEnd(t);
+	if (t->m != 0 || (t->flags & AG_TABLE_KEYED)) {
+		TestMsgS(ti, "Table not cleared");
+		goto out;
+	}
+	TestMsgS(ti, "OK");
+	rv = 0;
+out:
+	AG_ObjectDestroy(t);
+	return (rv);
+}
+
+static int
+Bench(void *obj)
+{
+	AG_TestInstance *ti = obj;
+	AG_Table *t;
+	const int nRows = 50000, nPasses = 4;
+	Uint32 t1, t2;
+	int i, pass;
+
+	TestMsgS(ti, "");
+	TestMsgS(ti, AGSI_LEAGUE_SPARTAN "P O L L E D   T A B L E   U P D A T E S");
+	TestMsg(ti, "%d rows, 1%% changing per pass:", nRows);
+
+	t = AG_TableNew(NULL, 0);
+	AG_TableAddCol(t, "A", NULL, NULL);
+	AG_TableAddCol(t, "B", NULL, NULL);
+	t1 = AG_GetTicks();
+	for (pass = 0; pass < nPasses; pass++) {
+		AG_TableBegin(t);
+		for (i = 0; i < nRows; i++) {
+			AG_TableAddRow(t, "%d:Item %d", i,
+			    (i % 100 == 0) ? i+pass : i);
+		}
+		AG_TableEnd(t);
+	}
+	t2 = AG_GetTicks();
+	TestMsg(ti, "\tAG_TableAddRow():      %ums/pass",
+	    (Uint)(t2 - t1) / nPasses);
+	AG_ObjectDestroy(t);
+
+	t = AG_TableNew(NULL, 0);
+	AG_TableAddCol(t, "A", NULL, NULL);
+	AG_TableAddCol(t, "B", NULL, NULL);
+	t1 = AG_GetTicks();
+	for (pass = 0; pass < nPasses; pass++) {
+		AG_TableBegin(t);
+		for (i = 0; i < nRows; i++) {
+			AG_TableAddRowKeyed(t, i, "%d:Item %d", i,
+			    (i % 100 == 0) ? i+pass : i);
+		}
+		AG_TableEnd(t);
+	}
+	t2 = AG_GetTicks();
+	TestMsg(ti, "\tAG_TableAddRowKeyed(): %ums/pass",
+	    (Uint)(t2 - t1) / nPasses);
+	AG_ObjectDestroy(t);
+	return (0);
+}
+
 const AG_TestCase tableTest = {
 	AGSI_IDEOGRAM AGSI_TABLE AGSI_RST,
 	"table",
@@ -342,7 +473,7 @@ const AG_TestCase tableTest = {
 	sizeof(AG_TestInstance),
 	NULL,		/* init */
 	NULL,		/* destroy */
-	NULL,		/* test */
+	Test,
 	TestGUI,
-	NULL		/* bench */
+	Bench
 };
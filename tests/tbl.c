@@ -0,0 +1,132 @@
+/*	Public domain	*/
+/*
+ * Test the AG_Tbl(3) hash table, including operations performed while
+ * entries are being migrated to a larger slot array.
+ */
+
+#include "agartest.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define NKEYS 1000
+
+/* Insert keys until the table begins an incremental resize. */
+static int
+FillUntilMigrating(AG_TestInstance *ti, AG_Tbl *tbl, int *nKeys)
+{
+	char key[16];
+	int i;
+
+	for (i = *nKeys; i < NKEYS; i++) {
+		Snprintf(key, sizeof(key), "key%d", i);
+		if (AG_TblInsertPointer(tbl, key, (void *)(AG_Size)(i+1)) == -1) {
+			TestMsg(ti, "Insert %s: %s", key, AG_GetError());
+			return (-1);
+		}
+		if (tbl->ents[1] != NULL) {
+			*nKeys = i+1;
+			return (0);
+		}
+	}
+	TestMsgS(ti, "Table did not begin migrating");
+	return (-1);
+}
+
+/* Check that each entry is visited exactly once by AG_TBL_FOREACH. */
+static int
+CheckIteration(AG_TestInstance *ti, AG_Tbl *tbl, int nKeys)
+{
+	char seen[NKEYS];
+	AG_Variable *V;
+	Uint i, j, count = 0;
+
+	memset(seen, 0, sizeof(seen));
+	AG_TBL_FOREACH(V, i,j, tbl) {
+		const int k = (int)(AG_Size)V->data.p - 1;
+
+		if (k < 0 || k >= nKeys || seen[k]) {
+			TestMsg(ti, "Iteration: duplicate or bad entry (%d)", k);
+			return (-1);
+		}
+		seen[k] = 1;
+		count++;
+	}
+	if (count != tbl->nEnts) {
+		TestMsg(ti, "Iteration: %u entries, expected %u", count,
+		    tbl->nEnts);
+		return (-1);
+	}
+	return (0);
+}
+
+static int
+Test(void *obj)
+{
+	AG_TestInstance *ti = obj;
+	AG_Tbl *tbl;
+	char key[16];
+	void *p;
+	int i, nKeys = 0;
+
+	tbl = AG_TblNew(256, 0);
+	if (FillUntilMigrating(ti, tbl, &nKeys) == -1)
+		goto fail;
+
+	TestMsg(ti, "Migrating %u slots after %d inserts", tbl->nSlots[1],
+	    nKeys);
+	if (CheckIteration(ti, tbl, nKeys) == -1)
+		goto fail;
+
+	for (i = 0; i < nKeys; i += 17) {
+		Snprintf(key, sizeof(key), "key%d", i);
+		if (AG_TblDelete(tbl, key) == -1) {
+			TestMsg(ti, "Delete %s: %s", key, AG_GetError());
+			goto fail;
+		}
+	}
+	for (i = 0; i < nKeys; i++) {
+		const int deleted = ((i % 17) == 0);
+
+		Snprintf(key, sizeof(key), "key%d", i);
+		if (AG_TblLookupPointer(tbl, key, &p) == 0) {
+			if (deleted || p != (void *)(AG_Size)(i+1)) {
+				TestMsg(ti, "Lookup %s: wrong result", key);
+				goto fail;
+			}
+		} else if (!deleted) {
+			TestMsg(ti, "Lookup %s: not found", key);
+			goto fail;
+		}
+	}
+	if (CheckIteration(ti, tbl, nKeys) == -1)
+		goto fail;
+
+	if (tbl->ents[1] == NULL) {
+		TestMsgS(ti, "Migration completed too early");
+		goto fail;
+	}
+	TestMsgS(ti, "Destroying table during migration");
+	AG_TblDestroy(tbl);
+	free(tbl);
+	TestMsgS(ti, "OK");
+	return (0);
+fail:
+	AG_TblDestroy(tbl);
+	free(tbl);
+	return (-1);
+}
+
+const AG_TestCase tblTest = {
+	AGSI_IDEOGRAM AGSI_NUL_TERMINATION AGSI_RST,
+	"tbl",
+	N_("Test the AG_Tbl(3) hash table"),
+	"1.7.1",
+	0,
+	sizeof(AG_TestInstance),
+	NULL,		/* init */
+	NULL,		/* destroy */
+	Test,
+	NULL,		/* testGUI */
+	NULL		/* bench */
+};
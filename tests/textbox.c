@@ -288,6 +288,67 @@ TestGUI(void *obj, AG_Window *win)
 	return (0);
 }
 
+static int
+Bench(void *obj)
+{
+	AG_TestInstance *ti = obj;
+	AG_Window *win;
+	AG_Textbox *tb;
+	AG_Editable *ed;
+	const AG_Size sizes[] = { 10000, 1000000 };
+	const Uint nKeys = 100;
+	Uint32 t1, t2;
+	Uint i, j;
+
+	TestMsgS(ti, "");
+	TestMsgS(ti, AGSI_LEAGUE_SPARTAN "S H A R E D   B U F F E R   E D I T S");
+
+	for (i = 0; i < sizeof(sizes)/sizeof(sizes[0]); i++) {
+		const AG_Size size = sizes[i];
+		char *buf;
+
+		if ((buf = TryMalloc(size << 1)) == NULL) {
+			return (-1);
+		}
+		for (j = 0; j < size; j++) {
+			buf[j] = ((j % 60) == 59) ? '\n' : 'a' + (j % 26);
+		}
+		buf[size] = '\0';
+
+		if ((win = AG_WindowNew(0)) == NULL) {
+			free(buf);
+			return (-1);
+		}
+		tb = AG_TextboxNewS(win, AG_TEXTBOX_MULTILINE |
+		                         AG_TEXTBOX_EXPAND, NULL);
+		AG_TextboxBindUTF8(tb, buf, size << 1);
+		ed = tb->ed;
+
+		t1 = AG_GetTicks();
+		for (j = 0; j < nKeys; j++) {
+			AGWIDGET_OPS(ed)->key_down(ed, AG_KEY_X, 0, 'x');
+			AGWIDGET_OPS(ed)->key_up(ed, AG_KEY_X, 0, 'x');
+		}
+		t2 = AG_GetTicks();
+		TestMsg(ti, "\tInsert into %lu-byte string: %.3fms per keystroke",
+		    (Ulong)size, (double)(t2 - t1) / nKeys);
+
+		AG_TextboxSetCursorPos(tb, -1);		/* To end of string */
+		t1 = AG_GetTicks();
+		for (j = 0; j < nKeys; j++) {
+			AGWIDGET_OPS(ed)->key_down(ed, AG_KEY_X, 0, 'x');
+			AGWIDGET_OPS(ed)->key_up(ed, AG_KEY_X, 0, 'x');
+		}
+		t2 = AG_GetTicks();
+		TestMsg(ti, "\tAppend to %lu-byte string: %.3fms per keystroke",
+		    (Ulong)size, (double)(t2 - t1) / nKeys);
+
+		AG_ObjectDetach(win);
+		free(buf);
+	}
+	return (0);
+}
+
 const AG_TestCase textboxTest = {
 	AGSI_IDEOGRAM AGSI_TEXTBOX AGSI_RST,
 	"textbox",
@@ -299,5 +360,5 @@ const AG_TestCase textboxTest = {
 	NULL,		/* destroy */
 	NULL,		/* test */
 	TestGUI,
-	NULL		/* bench */
+	Bench
 };
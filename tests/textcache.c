@@ -0,0 +1,165 @@
+/*	Public domain	*/
+/*
+ * Test the hit, miss and eviction statistics of the rendered text cache
+ * (AG_TextCache), including surfaces shared between two widgets.
+ */
+
+#include "agartest.h"
+
+#define NSTRINGS 8
+
+typedef struct {
+	AG_TestInstance _inherit;
+	AG_Window *win;
+	AG_TextCache *tc[2];
+} MyTestInstance;
+
+static int
+Init(void *obj)
+{
+	MyTestInstance *ti = obj;
+
+	ti->win = NULL;
+	ti->tc[0] = NULL;
+	ti->tc[1] = NULL;
+	return (0);
+}
+
+static void
+Destroy(void *obj)
+{
+	MyTestInstance *ti = obj;
+
+	if (ti->tc[0] != NULL) { AG_TextCacheDestroy(ti->tc[0]); }
+	if (ti->tc[1] != NULL) { AG_TextCacheDestroy(ti->tc[1]); }
+	if (ti->win != NULL)
+		AG_ObjectDetach(ti->win);
+}
+
+/* Compare the change in a counter against the expected value. */
+static int
+CheckDelta(MyTestInstance *ti, const char *what, Uint before, Uint after,
+    Uint expected)
+{
+	if (after - before != expected) {
+		TestMsg(ti, "%s: %u (expected %u)", what, after - before,
+		    expected);
+		return (-1);
+	}
+	return (0);
+}
+
+static int
+Test(void *obj)
+{
+	MyTestInstance *ti = obj;
+	AG_TextCacheStats st0, st;
+	AG_Label *lbl[2];
+	char text[NSTRINGS][64];
+	AG_Size maxBytesSave;
+	int i;
+
+	ti->win = AG_WindowNew(0);
+	lbl[0] = AG_LabelNewS(ti->win, 0, "A");
+	lbl[1] = AG_LabelNewS(ti->win, 0, "B");
+	ti->tc[0] = AG_TextCacheNew(lbl[0], 16, 4);
+	ti->tc[1] = AG_TextCacheNew(lbl[1], 16, 4);
+
+	/* Use strings unique to this run so that each first lookup misses. */
+	for (i = 0; i < NSTRINGS; i++)
+		Snprintf(text[i], sizeof(text[i]), "textcache %p #%d", ti, i);
+
+	AG_GetTextCacheStats(&st0);
+	for (i = 0; i < NSTRINGS; i++) {
+		if (AG_TextCacheGet(ti->tc[0], text[i]) == -1) {
+			TestMsg(ti, "TextCacheGet: %s", AG_GetError());
+			return (-1);
+		}
+	}
+	AG_GetTextCacheStats(&st);
+	if (CheckDelta(ti, "Misses", st0.nMisses, st.nMisses, NSTRINGS) == -1 ||
+	    CheckDelta(ti, "Hits", st0.nHits, st.nHits, 0) == -1 ||
+	    CheckDelta(ti, "Entries", st0.nEnts, st.nEnts, NSTRINGS) == -1)
+		return (-1);
+	TestMsg(ti, "%u misses, %lu bytes cached", st.nMisses,
+	    (Ulong)st.curBytes);
+
+	/* Lookups in the same widget hit its own cache. */
+	st0 = st;
+	for (i = 0; i < NSTRINGS; i++) {
+		AG_TextCacheGet(ti->tc[0], text[i]);
+	}
+	AG_GetTextCacheStats(&st);
+	if (CheckDelta(ti, "Hits", st0.nHits, st.nHits, NSTRINGS) == -1 ||
+	    CheckDelta(ti, "Misses", st0.nMisses, st.nMisses, 0) == -1)
+		return (-1);
+
+	/* Lookups from another widget share the rendered surfaces. */
+	st0 = st;
+	for (i = 0; i < NSTRINGS; i++) {
+		AG_TextCacheGet(ti->tc[1], text[i]);
+	}
+	AG_GetTextCacheStats(&st);
+	if (CheckDelta(ti, "Shared hits", st0.nSharedHits, st.nSharedHits,
+	    NSTRINGS) == -1 ||
+	    CheckDelta(ti, "Misses", st0.nMisses, st.nMisses, 0) == -1 ||
+	    CheckDelta(ti, "Entries", st0.nEnts, st.nEnts, 0) == -1)
+		return (-1);
+
+	/*
+	 * Shrink the cache. Entries still referenced by a widget must be
+	 * kept; they are evicted once both widgets have released them.
+	 */
+	maxBytesSave = st.maxBytes;
+	st0 = st;
+	AG_TextCacheClear(ti->tc[0]);
+	AG_TextCacheSetMaxBytes(0);
+	AG_GetTextCacheStats(&st);
+	if (st.nEnts < NSTRINGS) {
+		TestMsgS(ti, "Referenced entries were evicted");
+		goto fail;
+	}
+	AG_TextCacheClear(ti->tc[1]);
+	AG_GetTextCacheStats(&st);
+	if (st.nEvicted - st0.nEvicted < NSTRINGS) {
+		TestMsg(ti, "Evicted %u entries (expected >= %u)",
+		    st.nEvicted - st0.nEvicted, NSTRINGS);
+		goto fail;
+	}
+	if (st.nEvictedBytes - st0.nEvictedBytes !=
+	    st0.curBytes - st.curBytes) {
+		TestMsg(ti, "Evicted %lu bytes, freed %lu bytes",
+		    (Ulong)(st.nEvictedBytes - st0.nEvictedBytes),
+		    (Ulong)(st0.curBytes - st.curBytes));
+		goto fail;
+	}
+	TestMsg(ti, "%u entries evicted", st.nEvicted - st0.nEvicted);
+	AG_TextCacheSetMaxBytes(maxBytesSave);
+
+	/* An evicted string must be rendered again. */
+	st0 = st;
+	AG_TextCacheGet(ti->tc[0], text[0]);
+	AG_GetTextCacheStats(&st);
+	if (CheckDelta(ti, "Misses", st0.nMisses, st.nMisses, 1) == -1)
+		return (-1);
+
+	TestMsgS(ti, "OK");
+	return (0);
+fail:
+	AG_TextCacheSetMaxBytes(maxBytesSave);
+	return (-1);
+}
+
+const AG_TestCase textcacheTest = {
+	AGSI_IDEOGRAM AGSI_TYPOGRAPHY AGSI_RST,
+	"textcache",
+	N_("Test the text cache statistics"),
+	"1.7.1",
+	0,
+	sizeof(MyTestInstance),
+	Init,
+	Destroy,
+	Test,
+	NULL,		/* testGUI */
+	NULL		/* bench */
+};
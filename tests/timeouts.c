@@ -10,6 +10,7 @@ typedef struct {
 	AG_Timer to[3], toReg;
 	AG_Window *win;
 	Uint tick, period;
+	Uint nFired;
 } MyTestInstance;
 
 static Uint32
@@ -44,6 +45,109 @@ TimeoutRegular(AG_Timer *to, AG_Event *event)
 	return (to->ival);
 }
 
+static Uint32
+TimeoutCount(AG_Timer *to, AG_Event *event)
+{
+	MyTestInstance *ti = AG_PTR(1);
+
+	ti->nFired++;
+	return (0);
+}
+
+/* Check that the next soft timer expires in [tMin,tMax] ticks. */
+static int
+CheckNext(MyTestInstance *ti, const char *what, Uint32 tMin, Uint32 tMax)
+{
+	Uint32 t = AG_NextTimeout(AG_GetTicks());
+
+	if (t < tMin || t > tMax) {
+		TestMsg(ti, "%s: next timeout in %u ticks (expected %u-%u)",
+		    what, t, tMin, tMax);
+		return (-1);
+	}
+	return (0);
+}
+
+static int
+Test(void *obj)
+{
+	MyTestInstance *ti = obj;
+	AG_EventSource *src = AG_GetEventSource();
+	const int softHeap = !src->caps[AG_SINK_TIMER];
+	Uint32 t;
+	int i;
+
+	ti->nFired = 0;
+	if (AG_AddTimer(NULL, &ti->to[0], 3000, TimeoutCount, "%p", ti) == -1 ||
+	    AG_AddTimer(NULL, &ti->to[1], 1000, TimeoutCount, "%p", ti) == -1 ||
+	    AG_AddTimer(NULL, &ti->to[2], 2000, TimeoutCount, "%p", ti) == -1) {
+		TestMsg(ti, "AddTimer: %s", AG_GetError());
+		goto fail;
+	}
+	if (softHeap && CheckNext(ti, "Add", 900, 1000) == -1)
+		goto fail;
+
+	/* Reset the earliest timer; the next one should move up. */
+	AG_LockTimers(NULL);
+	if (AG_ResetTimer(NULL, &ti->to[1], 5000) == -1) {
+		AG_UnlockTimers(NULL);
+		TestMsg(ti, "ResetTimer: %s", AG_GetError());
+		goto fail;
+	}
+	AG_UnlockTimers(NULL);
+	if (softHeap && CheckNext(ti, "Reset", 1900, 2000) == -1)
+		goto fail;
+
+	/* Delete the earliest timer, then re-add it with a short interval. */
+	AG_DelTimer(NULL, &ti->to[2]);
+	if (AG_TimerIsRunning(NULL, &ti->to[2])) {
+		TestMsgS(ti, "DelTimer: timer still running");
+		goto fail;
+	}
+	if (softHeap && CheckNext(ti, "Delete", 2900, 3000) == -1)
+		goto fail;
+	if (AG_AddTimer(NULL, &ti->to[2], 500, TimeoutCount, "%p", ti) == -1) {
+		TestMsg(ti, "AddTimer: %s", AG_GetError());
+		goto fail;
+	}
+	if (softHeap && CheckNext(ti, "Re-add", 400, 500) == -1)
+		goto fail;
+
+	for (i = 0; i < 3; i++) {
+		if (!AG_TimerIsRunning(NULL, &ti->to[i])) {
+			TestMsg(ti, "Timer %d is not running", i);
+			goto fail;
+		}
+	}
+	if (!softHeap) {
+		TestMsgS(ti, "Event sink provides timers; skipping heap checks");
+		goto out;
+	}
+
+	/* Expire the timers in two steps and check the remaining order. */
+	t = AG_GetTicks();
+	AG_ProcessTimeouts(t + 3500);
+	if (ti->nFired != 2 || !AG_TimerIsRunning(NULL, &ti->to[1])) {
+		TestMsg(ti, "Expired %u timers (expected 2)", ti->nFired);
+		goto fail;
+	}
+	AG_ProcessTimeouts(t + 6000);
+	if (ti->nFired != 3 || AG_NextTimeout(t + 6000) != AG_TIMEOUT_NONE) {
+		TestMsg(ti, "Expired %u timers (expected 3)", ti->nFired);
+		goto fail;
+	}
+out:
+	for (i = 0; i < 3; i++) {
+		AG_DelTimer(NULL, &ti->to[i]);
+	}
+	TestMsgS(ti, "OK");
+	return (0);
+fail:
+	for (i = 0; i < 3; i++) {
+		AG_DelTimer(NULL, &ti->to[i]);
+	}
+	return (-1);
+}
 
 static void
 TestOneShot(AG_Event *event)
@@ -88,6 +192,7 @@ Init(void *obj)
 	ti->win = NULL;
 	ti->tick = 0;
 	ti->period = 1000;
+	ti->nFired = 0;
 	AG_InitTimer(&ti->to[0], "testTimer1", 0);
 	AG_InitTimer(&ti->to[1], "testTimer2", 0);
 	AG_InitTimer(&ti->to[2], "testTimer3", 0);
@@ -143,7 +248,7 @@ const AG_TestCase timeoutsTest = {
 	sizeof(MyTestInstance),
 	Init,
 	NULL,
-	NULL,		/* test */
+	Test,
 	TestGUI,
 	NULL		/* bench */
 };
@@ -0,0 +1,177 @@
+/*	Public domain	*/
+/*
+ * Test the AG_Object(3) variable table (AG_Variable(3) lookups).
+ */
+
+#include "agartest.h"
+
+#include <string.h>
+
+static const int varCounts[] = { 1, 4, 8, 16, 64, 256, 1024 };
+#define NCOUNTS (sizeof(varCounts) / sizeof(varCounts[0]))
+
+typedef struct {
+	AG_TestInstance _inherit;
+	AG_Object obj[NCOUNTS];		/* Objects with varCounts[i] variables */
+	char last[NCOUNTS][16];		/* Name of last variable defined */
+} MyTestInstance;
+
+static int
+Init(void *obj)
+{
+	MyTestInstance *ti = obj;
+	Uint i;
+	int j;
+
+	for (i = 0; i < NCOUNTS; i++) {
+		AG_ObjectInitStatic(&ti->obj[i], NULL);
+		for (j = 0; j < varCounts[i]; j++) {
+			Snprintf(ti->last[i], sizeof(ti->last[i]), "var%d", j);
+			AG_SetInt(&ti->obj[i], ti->last[i], j);
+		}
+	}
+	return (0);
+}
+
+static void
+Destroy(void *obj)
+{
+	MyTestInstance *ti = obj;
+	Uint i;
+
+	for (i = 0; i < NCOUNTS; i++)
+		AG_ObjectDestroy(&ti->obj[i]);
+}
+
+static int
+Test(void *obj)
+{
+	MyTestInstance *ti = obj;
+	AG_Object *ob = &ti->obj[NCOUNTS-1];
+	AG_Variable *V;
+	char name[16];
+	int i, nVars = varCounts[NCOUNTS-1];
+
+	TestMsg(ti, "Looking up %d variables", nVars);
+	for (i = 0; i < nVars; i++) {
+		Snprintf(name, sizeof(name), "var%d", i);
+		if (AG_GetInt(ob, name) != i) {
+			TestMsg(ti, "%s: bad value", name);
+			return (-1);
+		}
+	}
+	TestMsg(ti, "Unsetting every second variable");
+	for (i = 0; i < nVars; i += 2) {
+		Snprintf(name, sizeof(name), "var%d", i);
+		AG_Unset(ob, name);
+	}
+	for (i = 0; i < nVars; i++) {
+		Snprintf(name, sizeof(name), "var%d", i);
+		if (AG_Defined(ob, name) != (i & 1)) {
+			TestMsg(ti, "%s: AG_Defined() mismatch", name);
+			return (-1);
+		}
+	}
+	TestMsg(ti, "Redefining variables");
+	for (i = 0; i < nVars; i += 2) {
+		Snprintf(name, sizeof(name), "var%d", i);
+		AG_SetInt(ob, name, i);
+	}
+
+	TestMsg(ti, "Resolving P_VARIABLE proxies");
+	AG_BindVariable(&ti->obj[0], "proxy", ob, "var1000");
+	AG_ObjectLock(&ti->obj[0]);
+	if ((V = AG_AccessVariable(&ti->obj[0], "proxy")) == NULL ||
+	    V->type != AG_VARIABLE_INT || V->data.i != 1000) {
+		TestMsg(ti, "proxy: bad target");
+		AG_ObjectUnlock(&ti->obj[0]);
+		return (-1);
+	}
+	AG_UnlockVariable(V);
+	AG_ObjectUnlock(&ti->obj[0]);
+	AG_Unset(&ti->obj[0], "proxy");
+
+	TestMsg(ti, "OK");
+	return (0);
+}
+
+static void
+Bench_Access(void *obj, int arg)
+{
+	MyTestInstance *ti = obj;
+	AG_Variable *V;
+
+	if ((V = AG_AccessVariable(&ti->obj[arg], ti->last[arg])) != NULL)
+		AG_UnlockVariable(V);
+}
+static void
+Bench_Defined(void *obj, int arg)
+{
+	MyTestInstance *ti = obj;
+
+	if (AG_Defined(&ti->obj[arg], "undefined"))
+		TestMsg(ti, "Unexpected variable");
+}
+static struct ag_benchmark_fn lookupFns[] = {
+	{ "AG_AccessVariable(1 var)",       Bench_Access,  0 },
+	{ "AG_AccessVariable(4 vars)",      Bench_Access,  1 },
+	{ "AG_AccessVariable(8 vars)",      Bench_Access,  2 },
+	{ "AG_AccessVariable(16 vars)",     Bench_Access,  3 },
+	{ "AG_AccessVariable(64 vars)",     Bench_Access,  4 },
+	{ "AG_AccessVariable(256 vars)",    Bench_Access,  5 },
+	{ "AG_AccessVariable(1024 vars)",   Bench_Access,  6 },
+	{ "AG_Defined(1 var, miss)",        Bench_Defined, 0 },
+	{ "AG_Defined(16 vars, miss)",      Bench_Defined, 3 },
+	{ "AG_Defined(1024 vars, miss)",    Bench_Defined, 6 },
+};
+static struct ag_benchmark lookupBench = {
+	"AG_AccessVariable(3)",
+	&lookupFns[0],
+	sizeof(lookupFns) / sizeof(lookupFns[0]),
+	10, 10000, 0
+};
+
+static int
+Bench(void *obj)
+{
+	MyTestInstance *ti = obj;
+	Uint i, j, t1, t2;
+	const Uint nLookups = 1000000;
+
+	TestMsg(ti, "");
+	TestMsg(ti, AGSI_LEAGUE_SPARTAN "V A R I A B L E   L O O K U P   M I C R O B E N C H M A R K S");
+
+	TestMsg(ti, "Lookups/sec vs. variable count:");
+	for (i = 0; i < NCOUNTS; i++) {
+		t1 = AG_GetTicks();
+		for (j = 0; j < nLookups; j++) {
+			Bench_Access(ti, i);
+		}
+		t2 = AG_GetTicks();
+		if (t2 > t1) {
+			TestMsg(ti, "\t%4d vars: %lu lookups/sec", varCounts[i],
+			    (Ulong)nLookups * 1000UL / (t2 - t1));
+		} else {
+			TestMsg(ti, "\t%4d vars: >%lu lookups/sec", varCounts[i],
+			    (Ulong)nLookups * 1000);
+		}
+	}
+
+	TestMsg(ti, "AG_AccessVariable():");
+	TestExecBenchmark(obj, &lookupBench);
+	return (0);
+}
+
+const AG_TestCase variablesTest = {
+	AGSI_IDEOGRAM AGSI_NUL_TERMINATION AGSI_RST,
+	"variables",
+	N_("Test AG_Variable(3) lookups in AG_Object(3)"),
+	"1.7.1",
+	0,
+	sizeof(MyTestInstance),
+	Init,
+	Destroy,
+	Test,
+	NULL,		/* testGUI */
+	Bench
+};
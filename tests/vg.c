@@ -0,0 +1,191 @@
+/*	Public domain	*/
+/*
+ * Test the spatial index of the VG(3) vector graphics library: proximity
+ * queries are compared against a linear scan, and the node setters are
+ * checked for flagging their node for an index update.
+ */
+
+#include "agartest.h"
+
+#include <agar/vg.h>
+#include <agar/vg/vg_view.h>
+
+#define NPOINTS_X 16
+#define NPOINTS_Y 12
+
+typedef struct {
+	AG_TestInstance _inherit;
+	AG_Window *win;
+	VG *vg;
+	VG_View *vv;
+	VG_Point *pts[NPOINTS_X*NPOINTS_Y];
+} MyTestInstance;
+
+/* Compare an indexed proximity query against a scan of all nodes. */
+static int
+CheckQuery(MyTestInstance *ti, float x, float y)
+{
+	VG_Vector vPt = VGVECTOR(x,y), v;
+	VG_Node *vn, *vnIdx;
+	float d, dMin = AG_FLT_MAX;
+
+	VG_FOREACH_NODE(vn, ti->vg, vg_node) {
+		if (vn->ops->pointProximity == NULL) {
+			continue;
+		}
+		v = vPt;
+		if ((d = vn->ops->pointProximity(vn, ti->vv, &v)) < dMin)
+			dMin = d;
+	}
+	if ((vnIdx = VG_PointProximity(ti->vv, NULL, &vPt, NULL, NULL)) == NULL) {
+		TestMsg(ti, "(%.2f,%.2f): no node found", x, y);
+		return (-1);
+	}
+	v = vPt;
+	d = vnIdx->ops->pointProximity(vnIdx, ti->vv, &v);
+	if (d > dMin + 1e-4f) {
+		TestMsg(ti, "(%.2f,%.2f): found %s at %f, expected %f",
+		    x, y, vnIdx->ops->name, d, dMin);
+		return (-1);
+	}
+	return (0);
+}
+
+static int
+CheckQueries(MyTestInstance *ti)
+{
+	int x, y;
+
+	for (y = -2; y < NPOINTS_Y+2; y++) {
+		for (x = -2; x < NPOINTS_X+2; x++) {
+			if (CheckQuery(ti, (float)x + 0.3f, (float)y + 0.6f) == -1)
+				return (-1);
+		}
+	}
+	return (0);
+}
+
+/*
+ * Check that a setter has flagged its node for an index update, then
+ * query again (which updates the index).
+ */
+static int
+CheckChanged(MyTestInstance *ti, void *p, const char *fn)
+{
+	if ((VGNODE(p)->flags & VG_NODE_DIRTY) == 0) {
+		TestMsg(ti, "%s() did not mark the node as changed", fn);
+		return (-1);
+	}
+	return CheckQueries(ti);
+}
+
+static int
+Init(void *obj)
+{
+	MyTestInstance *ti = obj;
+
+	VG_InitSubsystem();
+	ti->win = NULL;
+	ti->vg = NULL;
+	return (0);
+}
+
+static void
+Destroy(void *obj)
+{
+	MyTestInstance *ti = obj;
+
+	if (ti->win != NULL) {
+		AG_ObjectDetach(ti->win);
+	}
+	if (ti->vg != NULL) {
+		AG_ObjectDestroy(ti->vg);
+	}
+}
+
+static int
+Test(void *obj)
+{
+	MyTestInstance *ti = obj;
+	VG_Point **pts = ti->pts;
+	VG_Line *vl;
+	VG_Text *vt;
+	VG_Polygon *ply;
+	VG_Circle *vc;
+	VG_Arc *va;
+	int x, y;
+
+	ti->vg = VG_New(0);
+	for (y = 0; y < NPOINTS_Y; y++) {
+		for (x = 0; x < NPOINTS_X; x++) {
+			pts[y*NPOINTS_X + x] = VG_PointNew(ti->vg->root,
+			    VGVECTOR((float)x, (float)y));
+		}
+	}
+	vl = VG_LineNew(ti->vg->root, pts[0], pts[NPOINTS_X+5]);
+	vt = VG_TextNew(ti->vg->root, pts[20], pts[21]);
+	VG_TextString(vt, "Agar");
+	ply = VG_PolygonNew(ti->vg->root);
+	VG_PolygonVertex(ply, pts[40]);
+	VG_PolygonVertex(ply, pts[44]);
+	VG_PolygonVertex(ply, pts[90]);
+	vc = VG_CircleNew(ti->vg->root, pts[100], 2.5f);
+	va = VG_ArcNew(ti->vg->root, pts[120], 1.5f, 0.0f, 180.0f);
+
+	ti->win = AG_WindowNew(0);
+	ti->vv = VG_ViewNew(ti->win, ti->vg, VG_VIEW_EXPAND);
+	AG_WindowSetGeometry(ti->win, 0, 0, 320, 240);
+
+	TestMsg(ti, "Querying %u nodes", (Uint)(NPOINTS_X*NPOINTS_Y + 5));
+	if (CheckQueries(ti) == -1)
+		return (-1);
+
+	TestMsgS(ti, "Checking setters");
+	VG_PointSize(pts[1], 2.0);
+	if (CheckChanged(ti, pts[1], "VG_PointSize") == -1) { return (-1); }
+	VG_LineThickness(vl, 3);
+	if (CheckChanged(ti, vl, "VG_LineThickness") == -1) { return (-1); }
+	VG_LineStipple(vl, 0xf0f0);
+	if (CheckChanged(ti, vl, "VG_LineStipple") == -1) { return (-1); }
+	VG_LineEndpointStyle(vl, VG_LINE_ROUNDED);
+	if (CheckChanged(ti, vl, "VG_LineEndpointStyle") == -1) { return (-1); }
+	VG_TextString(vt, "Agar GUI System");
+	if (CheckChanged(ti, vt, "VG_TextString") == -1) { return (-1); }
+	VG_TextPrintf(vt, "%d nodes", NPOINTS_X*NPOINTS_Y);
+	if (CheckChanged(ti, vt, "VG_TextPrintf") == -1) { return (-1); }
+	VG_TextAlignment(vt, VG_ALIGN_TL);
+	if (CheckChanged(ti, vt, "VG_TextAlignment") == -1) { return (-1); }
+	VG_TextFontSize(vt, 24.0f);
+	if (CheckChanged(ti, vt, "VG_TextFontSize") == -1) { return (-1); }
+	VG_TextFontFlags(vt, VG_TEXT_BOLD);
+	if (CheckChanged(ti, vt, "VG_TextFontFlags") == -1) { return (-1); }
+	VG_TextFontFace(vt, "monoalgue");
+	if (CheckChanged(ti, vt, "VG_TextFontFace") == -1) { return (-1); }
+	VG_PolygonSetOutline(ply, 1);
+	if (CheckChanged(ti, ply, "VG_PolygonSetOutline") == -1) { return (-1); }
+	VG_PolygonDelVertex(ply, 2);
+	if (CheckChanged(ti, ply, "VG_PolygonDelVertex") == -1) { return (-1); }
+	VG_CircleCenter(vc, pts[150]);
+	if (CheckChanged(ti, vc, "VG_CircleCenter") == -1) { return (-1); }
+	VG_ArcRadius(va, 4.0);
+	if (CheckChanged(ti, va, "VG_ArcRadius") == -1) { return (-1); }
+	VG_ArcCenter(va, pts[60]);
+	if (CheckChanged(ti, va, "VG_ArcCenter") == -1) { return (-1); }
+
+	TestMsgS(ti, "OK");
+	return (0);
+}
+
+const AG_TestCase vgTest = {
+	AGSI_IDEOGRAM AGSI_BEZIER AGSI_RST,
+	"vg",
+	N_("Test the spatial index of VG(3)"),
+	"1.7.1",
+	0,
+	sizeof(MyTestInstance),
+	Init,
+	Destroy,
+	Test,
+	NULL,		/* testGUI */
+	NULL		/* bench */
+};
@@ -836,6 +836,124 @@ Destroy(void *obj)
 	AG_TextFree(ti->textElement);
 }
 
+static int
+CountWidgets(AG_Widget *wid)
+{
+	AG_Widget *chld;
+	int n = 1;
+
+	AGOBJECT_FOREACH_CHILD(chld, wid, ag_widget) {
+		n += CountWidgets(chld);
+	}
+	return (n);
+}
+
+/* Repopulate a polled tree of nNodes expanded nodes of nChildren items. */
+static void
+PollTree(AG_Tlist *tl, int nNodes, int nChildren)
+{
+	AG_TlistItem *it;
+	int i, j;
+
+	AG_TlistBegin(tl);
+	for (i = 0; i < nNodes; i++) {
+		it = AG_TlistAddPtr(tl, NULL, "Node", (void *)(AG_Size)(i+1));
+		it->flags |= AG_TLIST_HAS_CHILDREN;
+		if (!AG_TlistVisibleChildren(tl, it)) {
+			continue;
+		}
+		it->flags |= AG_TLIST_ITEM_EXPANDED;
+		for (j = 0; j < nChildren; j++) {
+			it = AG_TlistAddPtr(tl, NULL, "Leaf",
+			    (void *)(AG_Size)((i+1)*nChildren + j + 1));
+			it->depth = 1;
+			it->selected = (j == 0);
+		}
+	}
+	AG_TlistEnd(tl);
+}
+
+/* Linear compare function (no hash function available). */
+static int
+ComparePtrsLinear(const AG_TlistItem *a, const AG_TlistItem *b)
+{
+	return (a->p1 == b->p1);
+}
+
+/*
+ * Benchmark recompiling the style of a large widget tree (as happens on
+ * any font, palette or stylesheet change), and the restore of selection
+ * and expansion state in a large polled AG_Tlist(3).
+ */
+static int
+Bench(void *obj)
+{
+	AG_TestInstance *ti = obj;
+	AG_Window *win;
+	AG_Tlist *tl;
+	const int nBoxes = 500, nPasses = 10;
+	const int nNodes = 2000, nChildren = 9, nPolls = 4;
+	int i, nWidgets, pass;
+	Uint32 t1, t2;
+
+	if ((win = AG_WindowNew(0)) == NULL) {
+		return (-1);
+	}
+	for (i = 0; i < nBoxes; i++) {
+		AG_Box *box;
+
+		box = AG_BoxNewHoriz(win, AG_BOX_HFILL);
+		AG_LabelNew(box, 0, "Label %d", i);
+		AG_ButtonNew(box, 0, "Button %d", i);
+		AG_CheckboxNew(box, 0, "Checkbox %d", i);
+		AG_NumericalNew(box, 0, NULL, "Numerical");
+		AG_ComboNew(box, 0, "Combo");
+		AG_TextboxNewS(box, 0, "Textbox");
+	}
+	nWidgets = CountWidgets(AGWIDGET(win));
+
+	TestMsgS(ti, "");
+	TestMsgS(ti, AGSI_LEAGUE_SPARTAN "S T Y L E   C O M P I L A T I O N");
+	TestMsg(ti, "%d widgets:", nWidgets);
+
+	t1 = AG_GetTicks();
+	for (pass = 0; pass < nPasses; pass++) {
+		AG_WidgetCompileStyle(win);
+	}
+	t2 = AG_GetTicks();
+	TestMsg(ti, "\tAG_WidgetCompileStyle(): %.2fms per 1000 widgets",
+	    (double)(t2 - t1) * 1000.0 / nWidgets / nPasses);
+
+	AG_ObjectDetach(win);
+
+	TestMsgS(ti, "");
+	TestMsgS(ti, AGSI_LEAGUE_SPARTAN "P O L L E D   T R E E   L I S T");
+	TestMsg(ti, "%d items, %d expanded nodes:", nNodes*(nChildren+1),
+	    nNodes);
+
+	tl = AG_TlistNew(NULL, AG_TLIST_EXPAND_NODES);
+	PollTree(tl, nNodes, nChildren);
+	t1 = AG_GetTicks();
+	for (pass = 0; pass < nPolls; pass++) {
+		PollTree(tl, nNodes, nChildren);
+	}
+	t2 = AG_GetTicks();
+	TestMsg(ti, "\tAG_TlistComparePtrs() (hashed): %ums/poll",
+	    (Uint)(t2 - t1) / nPolls);
+
+	AG_TlistSetCompareFn(tl, ComparePtrsLinear);
+	t1 = AG_GetTicks();
+	for (pass = 0; pass < nPolls; pass++) {
+		PollTree(tl, nNodes, nChildren);
+	}
+	t2 = AG_GetTicks();
+	TestMsg(ti, "\tUser compare function (linear): %ums/poll",
+	    (Uint)(t2 - t1) / nPolls);
+
+	AG_ObjectDestroy(tl);
+	return (0);
+}
+
 const AG_TestCase widgetsTest = {
 	AGSI_IDEOGRAM AGSI_POPULATED_WINDOW AGSI_RST,
 	"widgets",
@@ -847,5 +965,5 @@ const AG_TestCase widgetsTest = {
 	Destroy,
 	NULL,		/* test */
 	TestGUI,
-	NULL		/* bench */
+	Bench
 };
@@ -66,6 +66,148 @@ DoStyleEditor(void)
 		AG_WindowShow(win);
 }
 
+/*
+ * Benchmark mode: generate a large constrained sketch (rings of three
+ * triangulated strips of points, plus scattered lines and circles), and
+ * time the solver, proximity queries and node lookups.
+ */
+static Uint32 benchSeed = 1;
+
+static M_Real
+BenchRandom(M_Real range)
+{
+	benchSeed = benchSeed*1103515245U + 12345U;
+	return ((M_Real)((benchSeed >> 8) & 0xffff) / 65536.0) * range;
+}
+
+static SK_Point *
+BenchPoint(SK *sk, M_Real x, M_Real y)
+{
+	SK_Point *pt;
+
+	pt = SK_PointNew(sk->root);
+	SK_Translate2(pt, x, y);
+	return (pt);
+}
+
+static void
+BenchDistance(SK *sk, void *n1, void *n2)
+{
+	SK_AddConstraint(&sk->ctGraph, n1, n2, SK_DISTANCE,
+	    (double)M_VecDistance3(SK_Pos(n1), SK_Pos(n2)));
+}
+
+static void
+BenchRing(SK *sk, M_Real x, M_Real y, int nTris)
+{
+	SK_Point *a, *b, *c, *start;
+	int i, k;
+
+	a = start = BenchPoint(sk, x, y);
+	for (k = 0; k < 3; k++) {
+		b = BenchPoint(sk, x + BenchRandom(10.0), y + BenchRandom(10.0));
+		BenchDistance(sk, a, b);
+		for (i = 0; i < nTris; i++) {
+			if (k == 2 && i == nTris-1) {
+				c = start;			/* Close the ring */
+			} else {
+				c = BenchPoint(sk, x + BenchRandom(50.0),
+				                   y + BenchRandom(50.0));
+			}
+			BenchDistance(sk, a, c);
+			BenchDistance(sk, b, c);
+			a = b;
+			b = c;
+		}
+		a = b;
+	}
+}
+
+static int
+Benchmark(int nRings)
+{
+	SK *sk;
+	SK_Node *node;
+	SK_Line *line;
+	SK_Circle *circle;
+	M_Vector3 v, vC;
+	M_Real x, y, w, h;
+	Uint32 t;
+	Uint nNodes = 0, nPoints = 0, nFound = 0;
+	int i;
+
+	if ((sk = SK_New(NULL, "benchmark")) == NULL) {
+		return (-1);
+	}
+	for (i = 0; i < nRings; i++) {
+		BenchRing(sk, (M_Real)(i % 50)*100.0, (M_Real)(i / 50)*100.0,
+		    20);
+	}
+	w = (M_Real)((nRings < 50) ? nRings : 50)*100.0;
+	h = (M_Real)(nRings/50 + 1)*100.0;
+	for (i = 0; i < nRings*20; i++) {
+		x = BenchRandom(w);
+		y = BenchRandom(h);
+		if (i & 1) {
+			line = SK_LineNew(sk->root);
+			line->p1 = BenchPoint(sk, x, y);
+			line->p2 = BenchPoint(sk, x + BenchRandom(40.0) - 20.0,
+			                          y + BenchRandom(40.0) - 20.0);
+			SK_NodeAddReference(line, line->p1);
+			SK_NodeAddReference(line, line->p2);
+			SK_AddConstraint(&sk->ctGraph, line, line->p1,
+			    SK_INCIDENT);
+			SK_AddConstraint(&sk->ctGraph, line, line->p2,
+			    SK_INCIDENT);
+		} else {
+			circle = SK_CircleNew(sk->root);
+			circle->p = BenchPoint(sk, x, y);
+			circle->r = 1.0 + BenchRandom(20.0);
+			SK_NodeAddReference(circle, circle->p);
+		}
+	}
+	SK_FOREACH_NODE(node, sk, sk_node) {
+		if (strcmp(node->ops->name, "Point") == 0) {
+			nPoints++;
+		}
+		nNodes++;
+	}
+	printf("Sketch: %u rings, %u nodes\n", (Uint)nRings, nNodes);
+
+	t = AG_GetTicks();
+	SK_Solve(sk);
+	printf("SK_Solve(): %u ms (%s)\n", (Uint)(AG_GetTicks() - t),
+	    sk->statusText);
+
+	t = AG_GetTicks();
+	for (i = 0; i < 10000; i++) {
+		v = M_VecGet3(BenchRandom(w), BenchRandom(h), 0.0);
+		if (SK_ProximitySearch(sk, (i & 1) ? "Point" : NULL, &v, &vC,
+		    NULL) != NULL)
+			nFound++;
+	}
+	printf("SK_ProximitySearch(): %u ms / 10000 queries (%u found)\n",
+	    (Uint)(AG_GetTicks() - t), nFound);
+
+	t = AG_GetTicks();
+	for (i = 0, nFound = 0; i < 100000; i++) {
+		if (SK_FindNode(sk, 1 + (Uint)i % nPoints, "Point") != NULL)
+			nFound++;
+	}
+	printf("SK_FindNode(): %u ms / 100000 lookups (%u found)\n",
+	    (Uint)(AG_GetTicks() - t), nFound);
+
+	t = AG_GetTicks();
+	for (i = 0; i < 1000; i++) {
+		(void)BenchPoint(sk, BenchRandom(w), BenchRandom(h));
+	}
+	printf("SK_PointNew(): %u ms / 1000 insertions\n",
+	    (Uint)(AG_GetTicks() - t));
+
+	AG_ObjectDestroy(sk);
+	return (0);
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -77,6 +219,7 @@ main(int argc, char *argv[])
 	SK *sk;
 	int c, openedFiles = 0;
 	int forceScalar = 0;
+	int benchRings = 0, driverSet = 0;
 
 #ifdef ENABLE_NLS
 	bindtextdomain("skedit", LOCALEDIR);
@@ -88,7 +231,7 @@ main(int argc, char *argv[])
 		fprintf(stderr, "%s\n", AG_GetError());
 		return (1);
 	}
-	while ((c = AG_Getopt(argc, argv, "?vDsd:t:p:", &optArg, &optInd)) != -1) {
+	while ((c = AG_Getopt(argc, argv, "?vDsd:t:p:B:", &optArg, &optInd)) != -1) {
 		switch (c) {
 		case 'v':
 			printf("skedit %s\n", VERSION);
@@ -98,6 +241,7 @@ main(int argc, char *argv[])
 			break;
 		case 'd':
 			driverSpec = optArg;
+			driverSet = 1;
 			break;
 		case 's':
 			forceScalar = 1;
@@ -107,14 +251,21 @@ main(int argc, char *argv[])
 			break;
 		case 'p':
 			break;
+		case 'B':
+			benchRings = atoi(optArg);
+			break;
 		case '?':
 		default:
-			printf("%s [-vDs] [-d agar-driver] [-t font,pts]\n",
+			printf("%s [-vDs] [-d agar-driver] [-t font,pts] "
+			       "[-B rings]\n",
 			    agProgName);
 			exit(0);
 		}
 	}
 
+	if (benchRings > 0 && !driverSet) {
+		driverSpec = "headless";
+	}
 	if (fontSpec != NULL) {
 		AG_TextParseFontSpec(fontSpec);
 	}
@@ -143,6 +294,10 @@ main(int argc, char *argv[])
 		mVecOps4 = &mVecOps4_FPU;
 		mMatOps44 = &mMatOps44_FPU;
 	}
+	if (benchRings > 0) {
+		rv = (Benchmark(benchRings) == 0) ? 0 : 1;
+		goto out;
+	}
 
 	if (optInd == argc) {
 		/* Create an initial scene. */
@@ -0,0 +1,439 @@
+/*
+ * Copyright (c) 2026 Julien Nadeau Carriere <vedge@csoft.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Benchmarks for the Agar-Web(3) application server.
+ *
+ * "webbench template" measures WEB_VAR_OutputTemplate(3) over a synthetic
+ * page with variable references (the compiled template is reused across
+ * iterations unless the file changes).
+ *
+ * "webbench vars" simulates the variable traffic of a query: it sets a few
+ * hundred variables, builds up a large one with WEB_VAR_Cat(3), outputs a
+ * 2MB template referencing them and finally clears the query variables.
+ *
+ * "webbench server" runs WEB_QueryLoop(3) on 127.0.0.1 with a single
+ * pre-authentication command ("ping"), and "webbench load" is an HTTP load
+ * generator for it: each of -c threads opens a connection and issues -r
+ * requests, -p at a time (pipelined), or one per connection with -C. The
+ * request rate and the median and 99th percentile latencies (including the
+ * connection time) are reported. For example:
+ *
+ *	$ webbench server 8080 &
+ *	$ webbench -c 32 -r 2000 load 8080
+ *	$ webbench -c 64 -r 50 -C load 8080
+ */
+
+#define _USE_AGAR_STD			/* For <agar/net/web.h> */
+#define _GNU_SOURCE			/* For strchrnul() */
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include <agar/core.h>
+#include <agar/net/web.h>
+
+#define LOAD_BUFSIZE	65536		/* Response buffer (per thread) */
+#define LOAD_MAXCONNS	1024		/* Max concurrent connections */
+#define LOAD_MAXDEPTH	64		/* Max pipelining depth */
+
+static int nRuns = 100;			/* Iterations (template, vars) */
+static int nConns = 32;			/* Connections (load) */
+static int nRequests = 1000;		/* Requests per connection (load) */
+static int depth = 1;			/* Pipelining depth (load) */
+static int keepAlive = 1;		/* Use persistent connections (load) */
+static int loadPort;
+static char loadReq[256];
+
+static void
+printusage(void)
+{
+	fprintf(stderr, "Usage: webbench [-n runs] template [file]\n"
+	                "       webbench [-n runs] vars\n"
+	                "       webbench server port\n"
+	                "       webbench [-C] [-c conns] [-r requests] "
+	                "[-p depth] load port [path]\n");
+	exit(1);
+}
+
+static double
+Now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec + ts.tv_nsec/1e9);
+}
+
+/* Write a synthetic page of about size bytes referencing nVars variables. */
+static int
+GeneratePage(const char *path, size_t size, int nVars)
+{
+	FILE *f;
+	size_t n = 0;
+	int i;
+
+	if ((f = fopen(path, "w")) == NULL) {
+		perror(path);
+		return (-1);
+	}
+	for (i = 0; n < size; i++) {
+		n += fprintf(f, "<tr><td class=\"c\">lorem ipsum dolor $v%d "
+		                "sit amet</td></tr>\n", (i*7919) % nVars);
+	}
+	fclose(f);
+	return (0);
+}
+
+static void
+BenchTemplate(const char *path)
+{
+	WEB_Query q;
+	char key[16];
+	double t0, t;
+	int i;
+
+	if (path == NULL) {
+		path = "webbench-template.html";
+		if (GeneratePage(path, 1024*1024, 16) == -1)
+			exit(1);
+	}
+	WEB_QueryInit(&q, "en");
+	for (i = 0; i < 16; i++) {
+		snprintf(key, sizeof(key), "v%d", i);
+		WEB_VAR_Set(key, "value %d", i);
+	}
+	if (WEB_VAR_OutputTemplate(&q, path, 0) == -1) {	/* Warm up */
+		fprintf(stderr, "%s: %s\n", path, AG_GetError());
+		exit(1);
+	}
+	t0 = Now();
+	for (i = 0; i < nRuns; i++) {
+		q.dataLen = 0;
+		WEB_VAR_OutputTemplate(&q, path, 0);
+	}
+	t = (Now() - t0) / nRuns;
+	printf("template: %.3f ms/page (%lu bytes out, %.0f MB/s)\n",
+	    t*1e3, (unsigned long)q.dataLen, (q.dataLen/1e6) / t);
+
+	WEB_VAR_ClearQuery();
+	WEB_VAR_ClearTemplates();
+	WEB_QueryDestroy(&q);
+}
+
+static void
+BenchVars(void)
+{
+	const char *path = "webbench-vars.html";
+	WEB_Query q;
+	WEB_Variable *V;
+	char key[16];
+	double t0, tSet = 0.0, tOut = 0.0;
+	int i, j;
+
+	if (GeneratePage(path, 2*1024*1024, 400) == -1) {
+		exit(1);
+	}
+	WEB_QueryInit(&q, "en");
+	for (i = 0; i < nRuns; i++) {
+		t0 = Now();
+		for (j = 0; j < 400; j++) {
+			snprintf(key, sizeof(key), "v%d", j);
+			WEB_VAR_Set(key, "value %d of query %d", j, i);
+		}
+		V = WEB_VAR_SetS("list", NULL);
+		for (j = 0; j < 5000; j++) {
+			WEB_VAR_Cat(V, "<li>%d</li>", j);
+		}
+		tSet += Now() - t0;
+
+		t0 = Now();
+		q.dataLen = 0;
+		if (WEB_VAR_OutputTemplate(&q, path, 0) == -1) {
+			fprintf(stderr, "%s: %s\n", path, AG_GetError());
+			exit(1);
+		}
+		WEB_VAR_ClearQuery();
+		tOut += Now() - t0;
+	}
+	printf("vars: set %.3f ms/query, output %.3f ms/query "
+	       "(%lu bytes out)\n", tSet*1e3/nRuns, tOut*1e3/nRuns,
+	       (unsigned long)q.dataLen);
+
+	WEB_VAR_ClearTemplates();
+	WEB_QueryDestroy(&q);
+}
+
+static void
+Ping(WEB_Query *q)
+{
+	WEB_PutS(q, "pong\n");
+}
+
+static void
+LoginPage(WEB_Query *q)
+{
+	WEB_PutS(q, "login\n");
+}
+
+static void
+Logout(WEB_Query *q)
+{
+}
+
+static WEB_SessionOps benchSessionOps = {
+	.name = "webbench",
+	.size = sizeof(WEB_Session),
+	.sessTimeout = 60,
+	.workerTimeout = 60,
+	.preAuthCmds = {
+		{ "ping", Ping, "text/plain" },
+		{ NULL,   NULL, NULL }
+	},
+	.loginPage = LoginPage,
+	.logout = Logout
+};
+
+static void
+Server(const char *port)
+{
+	WEB_Init(1, 0);
+	WEB_SetLogFile("/dev/null");
+	WEB_QueryLoop("127.0.0.1", port, &benchSessionOps);
+	fprintf(stderr, "%s\n", AG_GetError());
+	exit(1);
+}
+
+static int
+LoadConnect(void)
+{
+	struct sockaddr_in sin;
+	int sock, val = 1;
+
+	if ((sock = socket(AF_INET, SOCK_STREAM, 0)) == -1) {
+		perror("socket");
+		exit(1);
+	}
+	setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &val, sizeof(val));
+	memset(&sin, 0, sizeof(sin));
+	sin.sin_family = AF_INET;
+	sin.sin_port = htons(loadPort);
+	sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (connect(sock, (struct sockaddr *)&sin, sizeof(sin)) == -1) {
+		perror("connect");
+		exit(1);
+	}
+	return (sock);
+}
+
+/*
+ * Read one response (header and Content-Length body) into buf, which holds
+ * len bytes left over from the previous response.
+ */
+static int
+LoadReadResponse(int sock, char *buf, size_t *len)
+{
+	char *hEnd, *cl;
+	size_t respLen;
+	ssize_t rv;
+
+	for (;;) {
+		if ((hEnd = memmem(buf, *len, "\r\n\r\n", 4)) != NULL) {
+			*hEnd = '\0';
+			cl = strcasestr(buf, "Content-Length:");
+			*hEnd = '\r';
+			respLen = (hEnd - buf) + 4 +
+			          ((cl != NULL) ? strtoul(&cl[15], NULL, 10) : 0);
+			if (*len >= respLen) {
+				memmove(buf, &buf[respLen], *len - respLen);
+				*len -= respLen;
+				return (0);
+			}
+		}
+		if (*len == LOAD_BUFSIZE - 1) {
+			fprintf(stderr, "Response too large\n");
+			return (-1);
+		}
+		if ((rv = read(sock, &buf[*len], LOAD_BUFSIZE-1 - *len)) <= 0) {
+			return (-1);
+		}
+		*len += rv;
+		buf[*len] = '\0';
+	}
+}
+
+/* Load generator thread. Return an array of nRequests latencies. */
+static void *
+LoadThread(void *arg)
+{
+	double *lat, t0;
+	char *buf, *out;
+	size_t reqLen = strlen(loadReq), len = 0;
+	int i, j, n, sock = -1;
+
+	lat = Malloc(nRequests*sizeof(double));
+	buf = Malloc(LOAD_BUFSIZE);
+	out = Malloc(reqLen*depth);
+	for (j = 0; j < depth; j++) {
+		memcpy(&out[j*reqLen], loadReq, reqLen);
+	}
+	for (i = 0; i < nRequests; i += n) {
+		n = AG_MIN(depth, nRequests - i);
+		t0 = Now();
+		if (sock == -1) {
+			sock = LoadConnect();
+			len = 0;
+		}
+		if (write(sock, out, n*reqLen) != (ssize_t)(n*reqLen)) {
+			perror("write");
+			exit(1);
+		}
+		for (j = 0; j < n; j++) {
+			if (LoadReadResponse(sock, buf, &len) == -1) {
+				fprintf(stderr, "Bad response\n");
+				exit(1);
+			}
+			lat[i+j] = Now() - t0;
+		}
+		if (!keepAlive) {
+			close(sock);
+			sock = -1;
+		}
+	}
+	if (sock != -1) {
+		close(sock);
+	}
+	free(out);
+	free(buf);
+	return (lat);
+}
+
+static int
+CompareLatency(const void *p1, const void *p2)
+{
+	double d1 = *(const double *)p1, d2 = *(const double *)p2;
+
+	return (d1 < d2) ? -1 : (d1 > d2);
+}
+
+static void
+Load(const char *port, const char *path)
+{
+#ifdef AG_THREADS
+	AG_Thread th[LOAD_MAXCONNS];
+	double *lat, *latThread, t0, t;
+	int i, nTotal = nConns*nRequests;
+
+	loadPort = atoi(port);
+	snprintf(loadReq, sizeof(loadReq),
+	    "GET %s HTTP/1.1\r\n"
+	    "Host: localhost\r\n"
+	    "%s\r\n", path, keepAlive ? "" : "Connection: close\r\n");
+	lat = Malloc(nTotal*sizeof(double));
+
+	t0 = Now();
+	for (i = 0; i < nConns; i++) {
+		AG_ThreadCreate(&th[i], LoadThread, NULL);
+	}
+	for (i = 0; i < nConns; i++) {
+		AG_ThreadJoin(th[i], (void **)&latThread);
+		memcpy(&lat[i*nRequests], latThread, nRequests*sizeof(double));
+		free(latThread);
+	}
+	t = Now() - t0;
+	qsort(lat, nTotal, sizeof(double), CompareLatency);
+	printf("load: %d conns, %d requests, %s, depth %d: %.0f req/s, "
+	       "p50 %.3f ms, p99 %.3f ms\n", nConns, nTotal,
+	       keepAlive ? "keep-alive" : "close", depth, nTotal/t,
+	       lat[nTotal/2]*1e3, lat[(int)(nTotal*0.99)]*1e3);
+	free(lat);
+#else
+	fprintf(stderr, "Agar was compiled without threads\n");
+	exit(1);
+#endif
+}
+
+int
+main(int argc, char *argv[])
+{
+	int c;
+
+	while ((c = getopt(argc, argv, "Cc:n:p:r:?")) != -1) {
+		switch (c) {
+		case 'C':
+			keepAlive = 0;
+			break;
+		case 'c':
+			nConns = atoi(optarg);
+			break;
+		case 'n':
+			nRuns = atoi(optarg);
+			break;
+		case 'p':
+			depth = atoi(optarg);
+			break;
+		case 'r':
+			nRequests = atoi(optarg);
+			break;
+		default:
+			printusage();
+		}
+	}
+	argc -= optind;
+	argv += optind;
+	if (argc < 1 || nRuns < 1 || nRequests < 1 ||
+	    nConns < 1 || nConns > LOAD_MAXCONNS ||
+	    depth < 1 || depth > LOAD_MAXDEPTH)
+		printusage();
+
+	if (AG_InitCore("webbench", 0) == -1) {
+		fprintf(stderr, "%s\n", AG_GetError());
+		return (1);
+	}
+	WEB_SetLogFile("/dev/null");
+
+	if (strcmp(argv[0], "template") == 0) {
+		BenchTemplate(argc > 1 ? argv[1] : NULL);
+	} else if (strcmp(argv[0], "vars") == 0) {
+		BenchVars();
+	} else if (strcmp(argv[0], "server") == 0 && argc > 1) {
+		Server(argv[1]);
+	} else if (strcmp(argv[0], "load") == 0 && argc > 1) {
+		Load(argv[1], (argc > 2) ? argv[2] : "/ping");
+	} else {
+		printusage();
+	}
+	AG_Destroy();
+	return (0);
+}
@@ -43,6 +43,7 @@ MANLINKS+=VG.3:VG_Scale.3
 MANLINKS+=VG.3:VG_Rotate.3
 MANLINKS+=VG.3:VG_FlipVert.3
 MANLINKS+=VG.3:VG_FlipHoriz.3
+MANLINKS+=VG.3:VG_NodeChanged.3
 MANLINKS+=VG.3:VG_NodeTransform.3
 MANLINKS+=VG.3:VG_PushMatrix.3
 MANLINKS+=VG.3:VG_PopMatrix.3
@@ -80,6 +80,14 @@ VG_ToolOps *vgBuiltinTools[] = {
 	NULL
 };
 
+static void InsertNode(VG *_Nonnull, VG_Node *_Nonnull);
+static void RemoveNode(VG *_Nonnull, VG_Node *_Nonnull);
+static void NodeTableClear(VG_NodeTable *_Nonnull);
+static void IndexClear(VG *_Nonnull);
+static void MarkDirty(VG *_Nonnull, VG_Node *_Nonnull);
+static void AddLink(VG *_Nonnull, VG_Node *_Nonnull, VG_Node *_Nonnull);
+static void DelLink(VG *_Nonnull, VG_Node *_Nonnull, VG_Node *_Nonnull);
+
 void
 VG_InitSubsystem(void)
 {
@@ -153,6 +161,14 @@ Init(void *_Nonnull obj)
 	vg->layers = NULL;
 	vg->nLayers = 0;
 	TAILQ_INIT(&vg->nodes);
+	vg->nodeSeq = 0;
+	vg->nHints = 0;
+	vg->hints = NULL;
+	memset(&vg->handles, 0, sizeof(VG_NodeTable));
+	memset(&vg->syms, 0, sizeof(VG_NodeTable));
+	memset(&vg->index, 0, sizeof(VG_Index));
+	TAILQ_INIT(&vg->index.unbounded);
+	TAILQ_INIT(&vg->index.dirty);
 	
 	vg->nT = 1;
 	vg->T = Malloc(sizeof(VG_Matrix));
@@ -192,7 +208,7 @@ VG_NodeDestroy(void *p)
 	     vnChld != TAILQ_END(&vn->cNodes);
 	     vnChld = vnNext) {
 		vnNext = TAILQ_NEXT(vnChld, tree);
-		TAILQ_REMOVE(&vnChld->vg->nodes, vnChld, list);
+		RemoveNode(vnChld->vg, vnChld);
 		VG_NodeDestroy(vnChld);
 	}
 	TAILQ_INIT(&vn->cNodes);
@@ -217,18 +233,23 @@ VG_ClearNodes(VG *vg)
 {
 	VG_Node *vnChld, *vnNext;
 
-	if (vg->root == NULL) {
-		return;
-	}
-	for (vnChld = TAILQ_FIRST(&vg->root->cNodes);
-	     vnChld != TAILQ_END(&vg->root->cNodes);
-	     vnChld = vnNext) {
-		vnNext = TAILQ_NEXT(vnChld, tree);
-		VG_NodeDetach(vnChld);
-		VG_NodeDestroy(vnChld);
+	IndexClear(vg);
+	if (vg->root != NULL) {
+		for (vnChld = TAILQ_FIRST(&vg->root->cNodes);
+		     vnChld != TAILQ_END(&vg->root->cNodes);
+		     vnChld = vnNext) {
+			vnNext = TAILQ_NEXT(vnChld, tree);
+			VG_NodeDetach(vnChld);
+			VG_NodeDestroy(vnChld);
+		}
+		TAILQ_INIT(&vg->root->cNodes);
+		TAILQ_INIT(&vg->nodes);
 	}
-	TAILQ_INIT(&vg->root->cNodes);
-	TAILQ_INIT(&vg->nodes);
+	NodeTableClear(&vg->handles);
+	NodeTableClear(&vg->syms);
+	Free(vg->hints);
+	vg->hints = NULL;
+	vg->nHints = 0;
 }
 
 /* Reinitialize the color array. */
@@ -285,6 +306,607 @@ VG_LookupClass(const char *name)
 	return (NULL);
 }
 
+/*
+ * Hash tables of nodes by class and handle, and by symbol. Where several
+ * nodes match, lookups return the earliest inserted one (which is also the
+ * first one in the list of nodes).
+ */
+static __inline__ Uint32
+HashBytes(Uint32 h, const void *_Nonnull p, AG_Size len)
+{
+	const Uchar *c = p, *cEnd = &c[len];
+
+	for (; c < cEnd; c++) {
+		h ^= *c;
+		h *= 16777619U;
+	}
+	return (h);
+}
+static __inline__ Uint32
+HashStr(Uint32 h, const char *_Nonnull s)
+{
+	const Uchar *c;
+
+	for (c = (const Uchar *)s; *c != '\0'; c++) {
+		h ^= *c;
+		h *= 16777619U;
+	}
+	return (h);
+}
+static __inline__ Uint32
+HashHandle(const char *_Nonnull type, Uint32 handle)
+{
+	return HashBytes(HashStr(2166136261U, type), &handle, sizeof(Uint32));
+}
+static __inline__ Uint32
+HashNode(const VG_Node *_Nonnull vn, int bySym)
+{
+	return (bySym) ? HashStr(2166136261U, vn->sym) :
+	                 HashHandle(vn->ops->name, vn->handle);
+}
+
+#define NODE_NEXT(vn,bySym) (*((bySym) ? &(vn)->hashSym : &(vn)->hashHandle))
+
+static void
+NodeTableInsert(VG_NodeTable *_Nonnull t, VG_Node *_Nonnull vn, int bySym)
+{
+	VG_Node **bucket;
+
+	if (t->nEnts >= t->nBuckets) {
+		Uint nBucketsNew = (t->nBuckets > 0) ? (t->nBuckets << 1) : 64;
+		VG_Node **bucketsNew, *vnOld, *vnNext;
+		Uint i;
+
+		bucketsNew = Malloc(nBucketsNew*sizeof(VG_Node *));
+		memset(bucketsNew, 0, nBucketsNew*sizeof(VG_Node *));
+		for (i = 0; i < t->nBuckets; i++) {
+			for (vnOld = t->buckets[i]; vnOld != NULL; vnOld = vnNext) {
+				vnNext = NODE_NEXT(vnOld,bySym);
+				bucket = &bucketsNew[HashNode(vnOld,bySym) &
+				                     (nBucketsNew-1)];
+				NODE_NEXT(vnOld,bySym) = *bucket;
+				*bucket = vnOld;
+			}
+		}
+		Free(t->buckets);
+		t->buckets = bucketsNew;
+		t->nBuckets = nBucketsNew;
+	}
+	bucket = &t->buckets[HashNode(vn,bySym) & (t->nBuckets-1)];
+	NODE_NEXT(vn,bySym) = *bucket;
+	*bucket = vn;
+	t->nEnts++;
+}
+
+static void
+NodeTableRemove(VG_NodeTable *_Nonnull t, VG_Node *_Nonnull vn, int bySym)
+{
+	VG_Node **pvn;
+
+	if (t->nBuckets == 0) {
+		return;
+	}
+	for (pvn = &t->buckets[HashNode(vn,bySym) & (t->nBuckets-1)];
+	     *pvn != NULL;
+	     pvn = &NODE_NEXT(*pvn,bySym)) {
+		if (*pvn == vn) {
+			*pvn = NODE_NEXT(vn,bySym);
+			t->nEnts--;
+			break;
+		}
+	}
+}
+
+static void
+NodeTableClear(VG_NodeTable *_Nonnull t)
+{
+	Free(t->buckets);
+	t->buckets = NULL;
+	t->nBuckets = 0;
+	t->nEnts = 0;
+}
+
+/* Return the handle hint for the given node class (or NULL). */
+static VG_HandleHint *_Nullable
+LookupHandleHint(VG *_Nonnull vg, const char *_Nonnull type)
+{
+	Uint i;
+
+	for (i = 0; i < vg->nHints; i++) {
+		if (strcmp(vg->hints[i].type, type) == 0)
+			return (&vg->hints[i]);
+	}
+	return (NULL);
+}
+
+/*
+ * Spatial index. Nodes with a pointProximity() operation are entered into
+ * the cells of a uniform grid covering their extent() box. Nodes without
+ * an extent, too large or outside of the grid go into an unbounded list
+ * which is tested by every query.
+ *
+ * Index entries depend on the position of the referenced nodes and parent
+ * nodes. Reverse references ("links") are kept so that a change to a node
+ * can be propagated to all nodes whose geometry depends on it.
+ */
+typedef struct vg_index_link {
+	VG_Node *_Nonnull ref;			/* Referenced node (key) */
+	VG_Node *_Nonnull user;			/* Referencing node */
+	struct vg_index_link *_Nullable next;	/* In bucket */
+	struct vg_index_link *_Nullable nextUser; /* Next link of user */
+} VG_IndexLink;
+
+#define INDEX_BUILT(idx) ((idx)->grids[0].cells != NULL)
+
+static __inline__ Uint
+LinkBucket(Uint nBuckets, const VG_Node *_Nonnull ref)
+{
+	return (HashBytes(2166136261U, &ref, sizeof(void *)) & (nBuckets-1));
+}
+
+/* Record that the geometry of user depends on ref. */
+static void
+AddLink(VG *_Nonnull vg, VG_Node *_Nonnull user, VG_Node *_Nonnull ref)
+{
+	VG_Index *idx = &vg->index;
+	VG_IndexLink *link, **bucket;
+
+	if (idx->nLinks >= idx->nLinkBuckets) {
+		Uint nBucketsNew = (idx->nLinkBuckets > 0) ?
+		                   (idx->nLinkBuckets << 1) : 64;
+		VG_IndexLink **bucketsNew, *linkNext;
+		Uint i;
+
+		bucketsNew = Malloc(nBucketsNew*sizeof(VG_IndexLink *));
+		memset(bucketsNew, 0, nBucketsNew*sizeof(VG_IndexLink *));
+		for (i = 0; i < idx->nLinkBuckets; i++) {
+			for (link = idx->links[i]; link != NULL; link = linkNext) {
+				linkNext = link->next;
+				bucket = &bucketsNew[LinkBucket(nBucketsNew,
+				                                link->ref)];
+				link->next = *bucket;
+				*bucket = link;
+			}
+		}
+		Free(idx->links);
+		idx->links = bucketsNew;
+		idx->nLinkBuckets = nBucketsNew;
+	}
+	link = Malloc(sizeof(VG_IndexLink));
+	link->ref = ref;
+	link->user = user;
+	bucket = &idx->links[LinkBucket(idx->nLinkBuckets, ref)];
+	link->next = *bucket;
+	*bucket = link;
+	link->nextUser = user->idxLinks;
+	user->idxLinks = link;
+	idx->nLinks++;
+}
+
+static void
+UnlinkBucket(VG_Index *_Nonnull idx, VG_IndexLink *_Nonnull link)
+{
+	VG_IndexLink **pLink;
+
+	for (pLink = &idx->links[LinkBucket(idx->nLinkBuckets, link->ref)];
+	     *pLink != NULL;
+	     pLink = &(*pLink)->next) {
+		if (*pLink == link) {
+			*pLink = link->next;
+			idx->nLinks--;
+			break;
+		}
+	}
+}
+
+/* Forget one dependency of user on ref. */
+static void
+DelLink(VG *_Nonnull vg, VG_Node *_Nonnull user, VG_Node *_Nonnull ref)
+{
+	VG_IndexLink **pLink, *link;
+
+	for (pLink = &user->idxLinks;
+	     (link = *pLink) != NULL;
+	     pLink = &link->nextUser) {
+		if (link->ref == ref) {
+			*pLink = link->nextUser;
+			UnlinkBucket(&vg->index, link);
+			Free(link);
+			break;
+		}
+	}
+}
+
+/* Forget all dependencies of user. */
+static void
+DelLinks(VG *_Nonnull vg, VG_Node *_Nonnull user)
+{
+	VG_IndexLink *link, *linkNext;
+
+	for (link = user->idxLinks; link != NULL; link = linkNext) {
+		linkNext = link->nextUser;
+		UnlinkBucket(&vg->index, link);
+		Free(link);
+	}
+	user->idxLinks = NULL;
+}
+
+static void
+CellInsert(VG_IndexCell *_Nonnull cell, VG_Node *_Nonnull vn)
+{
+	if (cell->nNodes+1 > cell->maxNodes) {
+		cell->maxNodes = (cell->maxNodes > 0) ? (cell->maxNodes << 1) : 4;
+		cell->nodes = Realloc(cell->nodes,
+		    cell->maxNodes*sizeof(VG_Node *));
+	}
+	cell->nodes[cell->nNodes++] = vn;
+}
+
+static void
+CellRemove(VG_IndexCell *_Nonnull cell, VG_Node *_Nonnull vn)
+{
+	Uint i;
+
+	for (i = 0; i < cell->nNodes; i++) {
+		if (cell->nodes[i] == vn) {
+			cell->nodes[i] = cell->nodes[--cell->nNodes];
+			break;
+		}
+	}
+}
+
+/* Remove a node from the cells, unbounded list or dirty list. */
+static void
+IndexRemove(VG *_Nonnull vg, VG_Node *_Nonnull vn)
+{
+	VG_Index *idx = &vg->index;
+	int x, y;
+
+	if (vn->flags & VG_NODE_INDEXED) {
+		VG_IndexGrid *grid = &idx->grids[vn->idxLevel];
+
+		for (y = vn->idxCells[1]; y <= vn->idxCells[3]; y++)
+			for (x = vn->idxCells[0]; x <= vn->idxCells[2]; x++)
+				CellRemove(&grid->cells[y*grid->w + x], vn);
+	} else if (vn->flags & VG_NODE_UNBOUNDED) {
+		TAILQ_REMOVE(&idx->unbounded, vn, idx);
+		idx->nUnbounded--;
+	} else if (vn->flags & VG_NODE_DIRTY) {
+		TAILQ_REMOVE(&idx->dirty, vn, idx);
+	}
+	vn->flags &= ~(VG_NODE_INDEX_FLAGS);
+}
+
+/* Compute the extent of a node. Return -1 if it is unbounded. */
+static int
+NodeExtent(VG_View *_Nonnull vv, VG_Node *_Nonnull vn)
+{
+	VG_Vector *a = &vn->idxMin, *b = &vn->idxMax;
+
+	if (vn->ops->extent == NULL) {
+		return (-1);
+	}
+	vn->ops->extent(vn, vv, a, b);
+
+	if (!(b->x - a->x >= 0.0f && b->x - a->x <= AG_FLT_MAX &&
+	      b->y - a->y >= 0.0f && b->y - a->y <= AG_FLT_MAX)) {
+		return (-1);
+	}
+	vn->flags |= VG_NODE_EXTENT;
+	return (0);
+}
+
+/*
+ * Enter a node with a computed extent into the cells it overlaps, in the
+ * finest grid where it covers at most VG_INDEX_MAX_CELLS cells.
+ */
+static void
+PlaceNode(VG_Index *_Nonnull idx, VG_Node *_Nonnull vn)
+{
+	int *c = vn->idxCells, i, x, y;
+
+	for (i = 0; i < VG_INDEX_LEVELS; i++) {
+		VG_IndexGrid *grid = &idx->grids[i];
+		const float cs = grid->cellSize;
+		const float x1 = (vn->idxMin.x - idx->x)/cs;
+		const float y1 = (vn->idxMin.y - idx->y)/cs;
+		const float x2 = (vn->idxMax.x - idx->x)/cs;
+		const float y2 = (vn->idxMax.y - idx->y)/cs;
+
+		if (!(x1 >= 0.0f && y1 >= 0.0f &&
+		      x2 < (float)grid->w && y2 < (float)grid->h)) {
+			break;				/* Outside of grids */
+		}
+		c[0] = (int)x1;
+		c[1] = (int)y1;
+		c[2] = (int)x2;
+		c[3] = (int)y2;
+		if ((c[2]-c[0]+1)*(c[3]-c[1]+1) > VG_INDEX_MAX_CELLS) {
+			continue;
+		}
+		for (y = c[1]; y <= c[3]; y++) {
+			for (x = c[0]; x <= c[2]; x++)
+				CellInsert(&grid->cells[y*grid->w + x], vn);
+		}
+		vn->idxLevel = i;
+		vn->flags |= VG_NODE_INDEXED;
+		return;
+	}
+	TAILQ_INSERT_TAIL(&idx->unbounded, vn, idx);
+	vn->flags |= VG_NODE_UNBOUNDED;
+	idx->nUnbounded++;
+}
+
+/* Free the spatial index. It will be rebuilt by the next query. */
+static void
+IndexClear(VG *_Nonnull vg)
+{
+	VG_Index *idx = &vg->index;
+	VG_IndexLink *link, *linkNext;
+	VG_Node *vn;
+	Uint i;
+	int l;
+
+	if (!INDEX_BUILT(idx)) {
+		return;
+	}
+	TAILQ_FOREACH(vn, &vg->nodes, list) {
+		vn->flags &= ~(VG_NODE_INDEX_FLAGS);
+		vn->idxLinks = NULL;
+	}
+	if (vg->root != NULL) {
+		vg->root->idxLinks = NULL;
+	}
+	for (l = 0; l < VG_INDEX_LEVELS; l++) {
+		VG_IndexGrid *grid = &idx->grids[l];
+
+		for (i = 0; i < (Uint)(grid->w*grid->h); i++) {
+			Free(grid->cells[i].nodes);
+		}
+		Free(grid->cells);
+		grid->cells = NULL;
+	}
+
+	for (i = 0; i < idx->nLinkBuckets; i++) {
+		for (link = idx->links[i]; link != NULL; link = linkNext) {
+			linkNext = link->next;
+			Free(link);
+		}
+	}
+	Free(idx->links);
+	idx->links = NULL;
+	idx->nLinkBuckets = 0;
+	idx->nLinks = 0;
+
+	TAILQ_INIT(&idx->unbounded);
+	TAILQ_INIT(&idx->dirty);
+	idx->nUnbounded = 0;
+}
+
+/*
+ * Build the spatial index. The cell size is chosen from the node density
+ * and the mean node size, such that a typical node covers few cells.
+ */
+static void
+IndexBuild(VG *_Nonnull vg, VG_View *_Nonnull vv)
+{
+	VG_Index *idx = &vg->index;
+	VG_Node *vn;
+	VG_Vector vMin, vMax;
+	float w, h, cs, size, sizeSum = 0.0f;
+	Uint i, nBounded = 0, nCellsMax;
+	int l;
+
+	IndexClear(vg);
+
+	vMin.x = vMin.y = AG_FLT_MAX;
+	vMax.x = vMax.y = -AG_FLT_MAX;
+	TAILQ_FOREACH(vn, &vg->nodes, list) {
+		for (i = 0; i < vn->nRefs; i++) {
+			AddLink(vg, vn, vn->refs[i]);
+		}
+		if (vn->ops->pointProximity == NULL) {
+			continue;
+		}
+		if (NodeExtent(vv, vn) == -1) {
+			TAILQ_INSERT_TAIL(&idx->unbounded, vn, idx);
+			vn->flags |= VG_NODE_UNBOUNDED;
+			idx->nUnbounded++;
+			continue;
+		}
+		vn->flags |= VG_NODE_DIRTY;		/* Place below */
+		if (vn->idxMin.x < vMin.x) { vMin.x = vn->idxMin.x; }
+		if (vn->idxMin.y < vMin.y) { vMin.y = vn->idxMin.y; }
+		if (vn->idxMax.x > vMax.x) { vMax.x = vn->idxMax.x; }
+		if (vn->idxMax.y > vMax.y) { vMax.y = vn->idxMax.y; }
+		nBounded++;
+	}
+	w = vMax.x - vMin.x;
+	h = vMax.y - vMin.y;
+	if (nBounded == 0 || !(w <= AG_FLT_MAX && h <= AG_FLT_MAX)) {
+		vMin.x = vMin.y = 0.0f;
+		w = h = 0.0f;
+	}
+
+	/*
+	 * Start from the mean spacing between nodes, and grow the cells to
+	 * the mean node size (ignoring the few largest nodes, which will
+	 * end up in the unbounded list anyway).
+	 */
+	nCellsMax = (nBounded << 2) + 16;
+	cs = Sqrt(w*h / (float)(nBounded+1));
+	if (!(cs > 0.0f && cs <= AG_FLT_MAX)) {
+		cs = 1.0f;
+	}
+	if (nBounded > 0) {
+		TAILQ_FOREACH(vn, &vg->nodes, list) {
+			if (!(vn->flags & VG_NODE_DIRTY)) {
+				continue;
+			}
+			size = MAX(vn->idxMax.x - vn->idxMin.x,
+			           vn->idxMax.y - vn->idxMin.y);
+			sizeSum += MIN(size, cs*4.0f);
+		}
+		if (cs < sizeSum/(float)nBounded)
+			cs = sizeSum/(float)nBounded;
+	}
+	while ((w/cs + 1.0f)*(h/cs + 1.0f) > (float)nCellsMax)
+		cs *= 2.0f;
+
+	idx->x = vMin.x;
+	idx->y = vMin.y;
+	for (l = 0; l < VG_INDEX_LEVELS; l++) {
+		VG_IndexGrid *grid = &idx->grids[l];
+		AG_Size size;
+
+		grid->cellSize = cs;
+		grid->w = (int)(w/cs) + 1;
+		grid->h = (int)(h/cs) + 1;
+		size = (AG_Size)grid->w*grid->h*sizeof(VG_IndexCell);
+		grid->cells = Malloc(size);
+		memset(grid->cells, 0, size);
+		cs *= 8.0f;
+	}
+
+	TAILQ_FOREACH(vn, &vg->nodes, list) {
+		if (vn->flags & VG_NODE_DIRTY) {
+			vn->flags &= ~(VG_NODE_DIRTY);
+			PlaceNode(idx, vn);
+		}
+	}
+	idx->nBuilt = vg->handles.nEnts;
+	idx->nBuiltUnbounded = idx->nUnbounded;
+}
+
+/*
+ * Bring the spatial index up to date, reindexing the dirty nodes. Rebuild
+ * it if the drawing has grown or shrunk significantly, or if too many nodes
+ * have moved out of the grid.
+ */
+static void
+IndexUpdate(VG *_Nonnull vg, VG_View *_Nonnull vv)
+{
+	VG_Index *idx = &vg->index;
+	const Uint nNodes = vg->handles.nEnts;
+	VG_Node *vn;
+
+	if (!INDEX_BUILT(idx) ||
+	    nNodes > (idx->nBuilt << 1) + 64 ||
+	    (nNodes << 2) + 64 < idx->nBuilt) {
+		IndexBuild(vg, vv);
+		return;
+	}
+	while ((vn = TAILQ_FIRST(&idx->dirty)) != NULL) {
+		TAILQ_REMOVE(&idx->dirty, vn, idx);
+		vn->flags &= ~(VG_NODE_DIRTY);
+		if (vn->ops->pointProximity == NULL) {
+			continue;
+		}
+		if (NodeExtent(vv, vn) == 0) {
+			PlaceNode(idx, vn);
+		} else {
+			TAILQ_INSERT_TAIL(&idx->unbounded, vn, idx);
+			vn->flags |= VG_NODE_UNBOUNDED;
+			idx->nUnbounded++;
+		}
+	}
+	if (idx->nUnbounded > (idx->nBuiltUnbounded << 1) + 64)
+		IndexBuild(vg, vv);
+}
+
+/* Schedule a node, its descendants and its users for reindexing. */
+static void
+MarkDirty(VG *_Nonnull vg, VG_Node *_Nonnull vn)
+{
+	VG_Index *idx = &vg->index;
+	VG_IndexLink *link;
+	VG_Node *vnChld;
+
+	if (vn->flags & VG_NODE_DIRTY) {
+		return;
+	}
+	if (vn != vg->root) {
+		IndexRemove(vg, vn);
+		TAILQ_INSERT_TAIL(&idx->dirty, vn, idx);
+		vn->flags |= VG_NODE_DIRTY;
+	}
+	VG_FOREACH_CHLD(vnChld, vn, vg_node) {
+		MarkDirty(vg, vnChld);
+	}
+	if (idx->nLinkBuckets > 0) {
+		for (link = idx->links[LinkBucket(idx->nLinkBuckets, vn)];
+		     link != NULL;
+		     link = link->next) {
+			if (link->ref == vn)
+				MarkDirty(vg, link->user);
+		}
+	}
+}
+
+/* Enter an attached node into the list and lookup tables of a VG. */
+static void
+InsertNode(VG *_Nonnull vg, VG_Node *_Nonnull vn)
+{
+	Uint i;
+
+	TAILQ_INSERT_TAIL(&vg->nodes, vn, list);
+	vn->seq = vg->nodeSeq++;
+	vn->stamp = 0;
+	NodeTableInsert(&vg->handles, vn, 0);
+	if (vn->sym[0] != '\0') {
+		NodeTableInsert(&vg->syms, vn, 1);
+	}
+	if (INDEX_BUILT(&vg->index)) {
+		for (i = 0; i < vn->nRefs; i++) {
+			AddLink(vg, vn, vn->refs[i]);
+		}
+		MarkDirty(vg, vn);
+	}
+}
+
+/* Remove a node from the list and lookup tables of a VG. */
+static void
+RemoveNode(VG *_Nonnull vg, VG_Node *_Nonnull vn)
+{
+	VG_HandleHint *hint;
+
+	if (INDEX_BUILT(&vg->index)) {
+		IndexRemove(vg, vn);
+		DelLinks(vg, vn);
+	}
+	NodeTableRemove(&vg->handles, vn, 0);
+	if (vn->sym[0] != '\0') {
+		NodeTableRemove(&vg->syms, vn, 1);
+	}
+	if (vn->handle > 0 &&
+	    (hint = LookupHandleHint(vg, vn->ops->name)) != NULL &&
+	    vn->handle < hint->handle) {
+		hint->handle = vn->handle;
+	}
+	TAILQ_REMOVE(&vg->nodes, vn, list);
+}
+
+/*
+ * Signal a change in the geometry of a node which was not made through
+ * the VG interface (e.g., a direct update to its transformation matrix
+ * or to the parameters of its class).
+ */
+void
+VG_NodeChanged(void *p)
+{
+	VG_Node *vn = p;
+	VG *vg = vn->vg;
+
+	if (vg == NULL) {
+		return;
+	}
+	AG_ObjectLock(vg);
+	if (INDEX_BUILT(&vg->index)) {
+		MarkDirty(vg, vn);
+	}
+	AG_ObjectUnlock(vg);
+}
+
 /* Detach and free the specified node and its children. */
 int
 VG_Delete(void *pVn)
@@ -317,17 +939,20 @@ fail:
 }
 
 static void
-MoveNodesRecursively(VG *_Nonnull vgDst, VG_Node *_Nonnull vn)
+MoveNodesRecursively(VG *_Nonnull vgSrc, VG *_Nonnull vgDst,
+    VG_Node *_Nonnull vn)
 {
 	VG_Node *vnChld;
 
 	VG_FOREACH_CHLD(vnChld, vn, vg_node) {
-		MoveNodesRecursively(vgDst, vnChld);
+		MoveNodesRecursively(vgSrc, vgDst, vnChld);
+	}
+	if (vn != vgSrc->root) {
+		RemoveNode(vgSrc, vn);
 	}
 	vn->handle = VG_GenNodeName(vgDst, vn->ops->name);
-	TAILQ_REMOVE(&vn->vg->nodes, vn, list);
 	vn->vg = vgDst;
-	TAILQ_INSERT_TAIL(&vgDst->nodes, vn, list);
+	InsertNode(vgDst, vn);
 }
 
 /*
@@ -340,11 +965,9 @@ VG_Merge(void *pVnDst, VG *vgSrc)
 	VG_Node *vnDst = pVnDst;
 	VG_Node *vn = vgSrc->root;
 
-	vn->vg = vnDst->vg;
 	vn->parent = vnDst;
-	TAILQ_INSERT_TAIL(&vnDst->vg->nodes, vn, list);
 	TAILQ_INSERT_TAIL(&vnDst->cNodes, vn, tree);
-	MoveNodesRecursively(vnDst->vg, vn);
+	MoveNodesRecursively(vgSrc, vnDst->vg, vn);
 	vgSrc->root = NULL;
 }
 
@@ -359,6 +982,10 @@ VG_AddRef(void *p, void *pRef)
 	vn->refs = Realloc(vn->refs, (vn->nRefs+1)*sizeof(VG_Node *));
 	vn->refs[vn->nRefs++] = VGNODE(pRef);
 	VGNODE(pRef)->nDeps++;
+	if (vg && INDEX_BUILT(&vg->index)) {
+		AddLink(vg, vn, VGNODE(pRef));
+		MarkDirty(vg, vn);
+	}
 	if (vg) { AG_ObjectUnlock(vg); }
 }
 
@@ -389,6 +1016,10 @@ VG_DelRef(void *pVn, void *pRef)
 	newDeps = (--VGNODE(pRef)->nDeps);
 
 	if (vg) {
+		if (INDEX_BUILT(&vg->index)) {
+			DelLink(vg, vn, VGNODE(pRef));
+			MarkDirty(vg, vn);
+		}
 		AG_ObjectUnlock(vg);
 	}
 	return (newDeps);
@@ -416,22 +1047,43 @@ VG_NodeInit(void *p, VG_NodeOps *vnOps)
 	vn->nDeps = 0;
 	vn->T = VG_MatrixIdentity();
 	vn->p = NULL;
+	vn->seq = 0;
+	vn->stamp = 0;
+	vn->idxLinks = NULL;
+	vn->hashHandle = NULL;
+	vn->hashSym = NULL;
 	TAILQ_INIT(&vn->cNodes);
 
 	if (vn->ops->init != NULL)
 		vn->ops->init(vn);
 }
 
-/* Generate a unique name for a node of the specified type. */
+/*
+ * Generate a unique name for a node of the specified type. The search
+ * starts from the per-class hint, below which all handles are in use.
+ */
 Uint32
 VG_GenNodeName(VG *vg, const char *type)
 {
-	Uint32 name = 1;
+	VG_HandleHint *hint;
+	Uint32 name;
 
+	if ((hint = LookupHandleHint(vg, type)) == NULL &&
+	    strlen(type) < VG_TYPE_NAME_MAX) {
+		vg->hints = Realloc(vg->hints,
+		    (vg->nHints+1)*sizeof(VG_HandleHint));
+		hint = &vg->hints[vg->nHints++];
+		Strlcpy(hint->type, type, sizeof(hint->type));
+		hint->handle = 1;
+	}
+	name = (hint != NULL) ? hint->handle : 1;
 	while (VG_FindNode(vg, name, type) != NULL) {
 		if (++name >= VG_HANDLE_MAX)
 			AG_FatalError("Out of node names");
 	}
+	if (hint != NULL) {
+		hint->handle = name;
+	}
 	return (name);
 }
 
@@ -460,8 +1112,8 @@ VG_NodeAttach(void *pParent, void *pNode)
 	}
 	vn->parent = vnParent;
 	TAILQ_INSERT_TAIL(&vnParent->cNodes, vn, tree);
-	TAILQ_INSERT_TAIL(&vg->nodes, vn, list);
 	vn->vg = vg;
+	InsertNode(vg, vn);
 
 	AG_ObjectUnlock(vg);
 }
@@ -496,7 +1148,7 @@ VG_NodeDetach(void *p)
 		TAILQ_REMOVE(&vn->parent->cNodes, vn, tree);
 		vn->parent = NULL;
 	}
-	TAILQ_REMOVE(&vg->nodes, vn, list);
+	RemoveNode(vg, vn);
 	vn->vg = NULL;
 
 	AG_ObjectUnlock(vg);
@@ -509,13 +1161,22 @@ VG_SetSym(void *pNode, const char *fmt, ...)
 	VG_Node *vn = pNode;
 	va_list args;
 
-	if (vn->vg) { AG_ObjectLock(vn->vg); }
+	if (vn->vg) {
+		AG_ObjectLock(vn->vg);
+		if (vn->sym[0] != '\0')
+			NodeTableRemove(&vn->vg->syms, vn, 1);
+	}
 
 	va_start(args, fmt);
 	Vsnprintf(vn->sym, sizeof(vn->sym), fmt, args);
 	va_end(args);
 
-	if (vn->vg) { AG_ObjectUnlock(vn->vg); }
+	if (vn->vg) {
+		if (vn->sym[0] != '\0') {
+			NodeTableInsert(&vn->vg->syms, vn, 1);
+		}
+		AG_ObjectUnlock(vn->vg);
+	}
 }
 
 void
@@ -714,7 +1375,7 @@ LoadNodeGeneric(VG *_Nonnull vg, VG_Node *_Nonnull vnParent,
 	VG_NodeInit(vn, vnOps);
 	AG_CopyString(vn->sym, ds, sizeof(vn->sym));
 	vn->handle = AG_ReadUint32(ds);
-	vn->flags = AG_ReadUint32(ds);
+	vn->flags = AG_ReadUint32(ds) & ~(VG_NODE_INDEX_FLAGS);
 	vn->layer = (int)AG_ReadUint32(ds);
 	vn->color = VG_ReadColor(ds);
 	LoadMatrix(&vn->T, ds);
@@ -876,73 +1537,221 @@ VG_ReadRef(AG_DataSource *ds, void *pNode, const char *expType)
 	return (vnFound);
 }
 
-/* Return the element closest to the given point. */
-void *
-VG_PointProximity(VG_View *vv, const char *type, const VG_Vector *vPt,
-    VG_Vector *vC, void *ignoreNode)
+/* State of a proximity query. */
+struct vg_index_query {
+	VG_View *_Nonnull vv;
+	const char *_Nullable type;		/* Class to match (or NULL) */
+	VG_NodeOps *_Nullable ops;		/* Registered class of type */
+	void *_Nullable ignoreNode;		/* Node to skip */
+	VG_Vector vPt;				/* Query point */
+	float distMax;				/* Skip nodes this far or farther */
+	VG_Node *_Nullable vnClosest;		/* Closest node so far */
+	float distClosest;
+	VG_Vector vClosest;
+	Uint32 stamp;				/* Visit stamp */
+};
+
+/*
+ * Return 1 if no node at a distance of at least d can improve upon the
+ * current result. We allow for rounding differences between our estimate
+ * and the pointProximity() operation.
+ */
+static __inline__ int
+QueryPrune(const struct vg_index_query *_Nonnull q, float d)
 {
-	VG *vg = vv->vg;
-	VG_Node *vn, *vnClosest = NULL;
-	float distClosest = AG_FLT_MAX, p;
-	VG_Vector v, vClosest = VGVECTOR(AG_FLT_MAX,AG_FLT_MAX);
+	d -= d*1e-5f;
+	return (q->vnClosest != NULL) ? (d > q->distClosest) :
+	                                (d >= q->distMax);
+}
 
-	VG_FOREACH_NODE(vn, vg, vg_node) {
-		if (vn == ignoreNode ||
-		    vn->ops->pointProximity == NULL) {
-			continue;
+static void
+QueryNode(struct vg_index_query *_Nonnull q, VG_Node *_Nonnull vn)
+{
+	VG_Vector v;
+	float d;
+
+	if (vn->stamp == q->stamp) {
+		return;
+	}
+	vn->stamp = q->stamp;
+
+	if (vn == q->ignoreNode) {
+		return;
+	}
+	if (q->type != NULL && vn->ops != q->ops &&
+	    strcmp(vn->ops->name, q->type) != 0) {
+		return;
+	}
+	if (vn->flags & VG_NODE_EXTENT) {
+		/*
+		 * Outside of its extent, the proximity of a node is at least
+		 * the distance to the extent (inside, it may be negative).
+		 */
+		v.x = (q->vPt.x < vn->idxMin.x) ? vn->idxMin.x :
+		      (q->vPt.x > vn->idxMax.x) ? vn->idxMax.x : q->vPt.x;
+		v.y = (q->vPt.y < vn->idxMin.y) ? vn->idxMin.y :
+		      (q->vPt.y > vn->idxMax.y) ? vn->idxMax.y : q->vPt.y;
+		if ((v.x != q->vPt.x || v.y != q->vPt.y) &&
+		    QueryPrune(q, VG_Distance(q->vPt, v)))
+			return;
+	}
+	v = q->vPt;
+	d = vn->ops->pointProximity(vn, q->vv, &v);
+	if (d < q->distMax &&
+	    (q->vnClosest == NULL || d < q->distClosest ||
+	     (d == q->distClosest && vn->seq < q->vnClosest->seq))) {
+		q->vnClosest = vn;
+		q->distClosest = d;
+		q->vClosest = v;
+	}
+}
+
+static __inline__ void
+QueryCell(struct vg_index_query *_Nonnull q, const VG_IndexCell *_Nonnull cell)
+{
+	Uint i;
+
+	for (i = 0; i < cell->nNodes; i++)
+		QueryNode(q, cell->nodes[i]);
+}
+
+/*
+ * Visit the cells of a grid in rings of increasing size around the query
+ * point, until the distance to the unvisited cells exceeds the distance
+ * of the closest node found.
+ */
+static void
+QueryGrid(struct vg_index_query *_Nonnull q, const VG_Index *_Nonnull idx,
+    const VG_IndexGrid *_Nonnull grid)
+{
+	const VG_Vector *vPt = &q->vPt;
+	const float cs = grid->cellSize;
+	const float fx = (vPt->x - idx->x)/cs;
+	const float fy = (vPt->y - idx->y)/cs;
+	const int w = grid->w, h = grid->h;
+	int k, x, y, x1, y1, x2, y2, cx, cy, more;
+	float bound;
+
+	cx = (fx >= 0.0f) ? ((fx < (float)w) ? (int)fx : w-1) : 0;
+	cy = (fy >= 0.0f) ? ((fy < (float)h) ? (int)fy : h-1) : 0;
+
+	for (k = 0; ; k++) {
+		x1 = cx - k;
+		y1 = cy - k;
+		x2 = cx + k;
+		y2 = cy + k;
+		for (y = MAX(y1,0); y <= MIN(y2,h-1); y++) {
+			if (y == y1 || y == y2) {
+				for (x = MAX(x1,0); x <= MIN(x2,w-1); x++)
+					QueryCell(q, &grid->cells[y*w + x]);
+			} else {
+				if (x1 >= 0)
+					QueryCell(q, &grid->cells[y*w + x1]);
+				if (x2 < w)
+					QueryCell(q, &grid->cells[y*w + x2]);
+			}
 		}
-		if (type != NULL &&
-		    strcmp(vn->ops->name, type) != 0) {
-			continue;
+
+		/* Distance from vPt to the nearest unvisited cell. */
+		bound = AG_FLT_MAX;
+		more = 0;
+		if (x1 > 0) {
+			bound = MIN(bound, vPt->x - (idx->x + (float)x1*cs));
+			more = 1;
 		}
-		v = *vPt;
-		p = vn->ops->pointProximity(vn, vv, &v);
-		if (p < distClosest) {
-			distClosest = p;
-			vnClosest = vn;
-			vClosest = v;
+		if (x2 < w-1) {
+			bound = MIN(bound, (idx->x + (float)(x2+1)*cs) - vPt->x);
+			more = 1;
 		}
+		if (y1 > 0) {
+			bound = MIN(bound, vPt->y - (idx->y + (float)y1*cs));
+			more = 1;
+		}
+		if (y2 < h-1) {
+			bound = MIN(bound, (idx->y + (float)(y2+1)*cs) - vPt->y);
+			more = 1;
+		}
+		if (!more || QueryPrune(q, bound))
+			break;
 	}
-	if (vC != NULL) {
-		*vC = vClosest;
-	}
-	return (vnClosest);
 }
 
 /*
- * Return the element closest to the given point, ignoring all elements
- * beyond a specified distance.
+ * Return the node closest to vPt at a distance below distMax. Ties are
+ * resolved in favor of the earliest node in the list of nodes.
  */
-void *
-VG_PointProximityMax(VG_View *vv, const char *type, const VG_Vector *vPt,
-    VG_Vector *vC, void *ignoreNode, float distMax)
+static VG_Node *_Nullable
+IndexQuery(VG_View *_Nonnull vv, const char *_Nullable type,
+    const VG_Vector *_Nonnull vPt, VG_Vector *_Nullable vC,
+    void *_Nullable ignoreNode, float distMax)
 {
 	VG *vg = vv->vg;
-	VG_Node *vn, *vnClosest = NULL;
-	float distClosest = AG_FLT_MAX, p;
-	VG_Vector v, vClosest = VGVECTOR(AG_FLT_MAX,AG_FLT_MAX);
+	VG_Index *idx = &vg->index;
+	struct vg_index_query q;
+	VG_Node *vn;
+	Uint i;
+	int l;
 
-	VG_FOREACH_NODE(vn, vg, vg_node) {
-		if (vn == ignoreNode ||
-		    vn->ops->pointProximity == NULL) {
-			continue;
-		}
-		if (type != NULL &&
-		    strcmp(vn->ops->name, type) != 0) {
-			continue;
+	AG_ObjectLock(vg);
+
+	IndexUpdate(vg, vv);
+
+	q.vv = vv;
+	q.type = type;
+	q.ops = NULL;
+	if (type != NULL) {
+		for (i = 0; i < vgNodeClassCount; i++) {
+			if (strcmp(vgNodeClasses[i]->name, type) == 0) {
+				q.ops = vgNodeClasses[i];
+				break;
+			}
 		}
-		v = *vPt;
-		p = vn->ops->pointProximity(vn, vv, &v);
-		if (p < distMax && p < distClosest) {
-			distClosest = p;
-			vnClosest = vn;
-			vClosest = v;
+	}
+	q.ignoreNode = ignoreNode;
+	q.vPt = *vPt;
+	q.distMax = distMax;
+	q.vnClosest = NULL;
+	q.distClosest = AG_FLT_MAX;
+	q.vClosest = VGVECTOR(AG_FLT_MAX, AG_FLT_MAX);
+
+	if (++idx->stamp == 0) {
+		TAILQ_FOREACH(vn, &vg->nodes, list) {
+			vn->stamp = 0;
 		}
+		idx->stamp = 1;
+	}
+	q.stamp = idx->stamp;
+
+	for (l = 0; l < VG_INDEX_LEVELS; l++) {
+		QueryGrid(&q, idx, &idx->grids[l]);
 	}
+	TAILQ_FOREACH(vn, &idx->unbounded, idx)
+		QueryNode(&q, vn);
+
 	if (vC != NULL) {
-		*vC = vClosest;
+		*vC = q.vClosest;
 	}
-	return (vnClosest);
+	AG_ObjectUnlock(vg);
+	return (q.vnClosest);
+}
+
+/* Return the element closest to the given point. */
+void *
+VG_PointProximity(VG_View *vv, const char *type, const VG_Vector *vPt,
+    VG_Vector *vC, void *ignoreNode)
+{
+	return IndexQuery(vv, type, vPt, vC, ignoreNode, AG_FLT_MAX);
+}
+
+/*
+ * Return the element closest to the given point, ignoring all elements
+ * beyond a specified distance.
+ */
+void *
+VG_PointProximityMax(VG_View *vv, const char *type, const VG_Vector *vPt,
+    VG_Vector *vC, void *ignoreNode, float distMax)
+{
+	return IndexQuery(vv, type, vPt, vC, ignoreNode, distMax);
 }
 
 /*
@@ -1060,27 +1869,48 @@ VG_BlendColors(VG_Color *_Nonnull cDst, VG_Color cSrc)
 void *
 VG_FindNodeSym(VG *vg, const char *sym)
 {
-	VG_Node *vn;
+	VG_Node *vn, *vnFound = NULL;
 
-	AG_TAILQ_FOREACH(vn, &vg->nodes, list) {
-		if (strcmp(vn->sym, sym) == 0)
-			return (vn);
+	if (sym[0] == '\0') {			/* Not in table */
+		AG_TAILQ_FOREACH(vn, &vg->nodes, list) {
+			if (vn->sym[0] == '\0')
+				return (vn);
+		}
+		return (NULL);
 	}
-	return (NULL);
+	if (vg->syms.nBuckets == 0) {
+		return (NULL);
+	}
+	for (vn = vg->syms.buckets[HashStr(2166136261U, sym) &
+	                           (vg->syms.nBuckets-1)];
+	     vn != NULL;
+	     vn = vn->hashSym) {
+		if (strcmp(vn->sym, sym) == 0 &&
+		    (vnFound == NULL || vn->seq < vnFound->seq))
+			vnFound = vn;
+	}
+	return (vnFound);
 }
 
 /* Search a node by handle and class. Used for loading datafiles. */
 void *
 VG_FindNode(VG *vg, Uint32 handle, const char *type)
 {
-	VG_Node *vn;
+	VG_Node *vn, *vnFound = NULL;
 
-	AG_TAILQ_FOREACH(vn, &vg->nodes, list) {
+	if (vg->handles.nBuckets == 0) {
+		return (NULL);
+	}
+	for (vn = vg->handles.buckets[HashHandle(type, handle) &
+	                              (vg->handles.nBuckets-1)];
+	     vn != NULL;
+	     vn = vn->hashHandle) {
 		if (vn->handle == handle &&
-		    strcmp(vn->ops->name, type) == 0)
-			return (vn);
+		    strcmp(vn->ops->name, type) == 0 &&
+		    (vnFound == NULL || vn->seq < vnFound->seq))
+			vnFound = vn;
 	}
-	return (NULL);
+	return (vnFound);
 }
 
 /* Push the transformation matrix stack. */
@@ -1112,6 +1942,7 @@ VG_LoadIdentity(void *pNode)
 	vn->T.m[0][0] = 1.0f;	vn->T.m[0][1] = 0.0f;	vn->T.m[0][2] = 0.0f;
 	vn->T.m[1][0] = 0.0f;	vn->T.m[1][1] = 1.0f;	vn->T.m[1][2] = 0.0f;
 	vn->T.m[2][0] = 0.0f;	vn->T.m[2][1] = 0.0f;	vn->T.m[2][2] = 1.0f;
+	VG_NodeChanged(vn);
 }
 
 /* Set the position of the given node relative to its parent. */
@@ -1122,6 +1953,7 @@ VG_SetPositionInParent(void *pNode, VG_Vector v)
 	
 	vn->T.m[0][2] = v.x;
 	vn->T.m[1][2] = v.y;
+	VG_NodeChanged(vn);
 }
 
 /* Translate the given node. */
@@ -1136,6 +1968,7 @@ VG_Translate(void *pNode, VG_Vector v)
 	T.m[2][0] = 0.0f;	T.m[2][1] = 0.0f;	T.m[2][2] = 1.0f;
 
 	VG_MultMatrix(&vn->T, &T);
+	VG_NodeChanged(vn);
 }
 
 /* Apply uniform scaling to the current viewing matrix. */
@@ -1150,6 +1983,7 @@ VG_Scale(void *pNode, float s)
 	T.m[2][0] = 0.0f;	T.m[2][1] = 0.0f;	T.m[2][2] = s;
 
 	VG_MultMatrix(&vn->T, &T);
+	VG_NodeChanged(vn);
 }
 
 /* Apply a rotation to the current viewing matrix. */
@@ -1166,6 +2000,7 @@ VG_Rotate(void *pNode, float theta)
 	T.m[2][0] = 0.0f;	T.m[2][1] = 0.0f;	T.m[2][2] = 1.0f;
 
 	VG_MultMatrix(&vn->T, &T);
+	VG_NodeChanged(vn);
 }
 
 /* Reflection about vertical line going through the origin. */
@@ -1180,6 +2015,7 @@ VG_FlipVert(void *pNode)
 	T.m[2][0] = 0.0f;	T.m[2][1] = 0.0f;	T.m[2][2] = 1.0f;
 
 	VG_MultMatrix(&vn->T, &T);
+	VG_NodeChanged(vn);
 }
 
 /* Reflection about horizontal line going through the origin. */
@@ -1194,6 +2030,7 @@ VG_FlipHoriz(void *pNode)
 	T.m[2][0] = 0.0f;	T.m[2][1] = 0.0f;	T.m[2][2] = 1.0f;
 
 	VG_MultMatrix(&vn->T, &T);
+	VG_NodeChanged(vn);
 }
 
 /* Mark node as selected. */
@@ -1256,6 +2093,7 @@ VG_SetPosition(void *pNode, VG_Vector v)
 		vn->T.m[0][2] -= vParent.x;
 		vn->T.m[1][2] -= vParent.y;
 	}
+	VG_NodeChanged(vn);
 }
 
 static void *_Nonnull
@@ -1334,7 +2172,7 @@ Edit(void *_Nonnull p)
 AG_ObjectClass vgClass = {
 	"VG",
 	sizeof(VG),
-	{ 0, 0 },
+	{ 0,0, AGC_VG, 0xE013 },
 	Init,
 	NULL,		/* reset */
 	Destroy,
@@ -52,6 +52,7 @@ typedef struct vg_indexed_color {
 struct vg;
 struct vg_view;
 struct vg_node;
+struct vg_index_link;
 struct ag_static_icon;
 
 #include <agar/vg/vg_snap.h>
@@ -107,7 +108,13 @@ typedef struct vg_node {
 #define VG_NODE_NOSAVE		0x01	/* Don't save with drawing */
 #define VG_NODE_SELECTED	0x02	/* Selection flag */
 #define VG_NODE_MOUSEOVER	0x04	/* Mouse overlap flag */
+#define VG_NODE_INDEXED		0x08	/* In cells of spatial index */
+#define VG_NODE_UNBOUNDED	0x10	/* In unbounded list of spatial index */
+#define VG_NODE_DIRTY		0x20	/* Spatial index update pending */
+#define VG_NODE_EXTENT		0x40	/* Indexed bounding box is valid */
 #define VG_NODE_SAVED_FLAGS	0
+#define VG_NODE_INDEX_FLAGS	(VG_NODE_INDEXED | VG_NODE_UNBOUNDED | \
+				 VG_NODE_DIRTY | VG_NODE_EXTENT)
 
 	struct vg      *_Nullable vg;     /* Back pointer to VG */
 	struct vg_node *_Nullable parent; /* Back pointer to parent node */
@@ -123,15 +130,81 @@ typedef struct vg_node {
 
 	void *_Nullable p;		/* User pointer */
 
+	Uint32 seq;			/* Insertion order in VG */
+	Uint32 stamp;			/* Last proximity query visiting us */
+	VG_Vector idxMin, idxMax;	/* Bounding box in spatial index */
+	int idxLevel;			/* Grid in spatial index */
+	int idxCells[4];		/* Cell range in spatial index */
+	struct vg_index_link *_Nullable idxLinks; /* Indexed references */
+	struct vg_node *_Nullable hashHandle; /* In handle table */
+	struct vg_node *_Nullable hashSym;    /* In symbol table */
+
 	AG_TAILQ_HEAD_(vg_node) cNodes;	/* Child nodes */
 	AG_TAILQ_ENTRY(vg_node) tree;	/* Entry in tree */
 	AG_TAILQ_ENTRY(vg_node) list;	/* Entry in global list */
 	AG_TAILQ_ENTRY(vg_node) reverse; /* For VG_NodeTransform() */
 	AG_TAILQ_ENTRY(vg_node) user;	/* Entry in user list */
+	AG_TAILQ_ENTRY(vg_node) idx;	/* In dirty or unbounded list */
 } VG_Node;
 
 #define VGNODE(p) ((VG_Node *)(p))
 
+/* Hash table of nodes (by handle or by symbol). */
+typedef struct vg_node_table {
+	VG_Node *_Nullable *_Nullable buckets;
+	Uint                         nBuckets;	/* Power of 2 (or 0) */
+	Uint                         nEnts;
+} VG_NodeTable;
+
+/* Lowest possibly free handle of a node class. */
+typedef struct vg_handle_hint {
+	char type[VG_TYPE_NAME_MAX];		/* Class name */
+	Uint32 handle;				/* Handles below are in use */
+} VG_HandleHint;
+
+/* Cell of the spatial index. */
+typedef struct vg_index_cell {
+	VG_Node *_Nonnull *_Nullable nodes;
+	Uint                        nNodes;
+	Uint                        maxNodes;
+} VG_IndexCell;
+
+/* Uniform grid of the spatial index. */
+typedef struct vg_index_grid {
+	VG_IndexCell *_Nullable cells;		/* w*h cells (or NULL) */
+	int w, h;				/* Size in cells */
+	float cellSize;				/* Size of a cell */
+	Uint32 _pad;
+} VG_IndexGrid;
+
+#ifndef VG_INDEX_MAX_CELLS
+#define VG_INDEX_MAX_CELLS 16		/* Max cells covered by a node */
+#endif
+#ifndef VG_INDEX_LEVELS
+#define VG_INDEX_LEVELS 3		/* Grids of increasing cell size */
+#endif
+
+/*
+ * Uniform grids over the extents of the nodes of a VG, used to accelerate
+ * proximity queries. Each grid has cells 8 times larger than the previous
+ * one, and nodes go into the finest grid where they cover few cells.
+ * The index is built on the first query and updated lazily from the list
+ * of nodes marked dirty by VG_NodeChanged().
+ */
+typedef struct vg_index {
+	VG_IndexGrid grids[VG_INDEX_LEVELS];	/* Grids from finest */
+	float x, y;				/* Origin of grids */
+	Uint nBuilt;				/* Node count at build time */
+	Uint nBuiltUnbounded;			/* Unbounded count at build time */
+	Uint nUnbounded;			/* Nodes in unbounded list */
+	Uint32 stamp;				/* Query stamp */
+	struct vg_index_link *_Nullable *_Nullable links; /* Reverse refs */
+	Uint                                      nLinkBuckets;
+	Uint                                      nLinks;
+	AG_TAILQ_HEAD_(vg_node) unbounded;	/* Tested on every query */
+	AG_TAILQ_HEAD_(vg_node) dirty;		/* Pending update */
+} VG_Index;
+
 typedef struct vg {
 	struct ag_object _inherit;		/* AG_Object -> VG */
 	Uint flags;
@@ -151,6 +224,13 @@ typedef struct vg {
 	VG_Node *_Nullable root;		/* Tree of entities */
 	AG_TAILQ_HEAD_(vg_node) nodes;		/* List of entities */
 	AG_TAILQ_ENTRY(vg) user;		/* Entry in user list */
+
+	Uint32 nodeSeq;				/* Node insertion counter */
+	Uint nHints;				/* Handle hint count */
+	VG_HandleHint *_Nullable hints;		/* Lowest free handles */
+	VG_NodeTable handles;			/* Nodes by class and handle */
+	VG_NodeTable syms;			/* Nodes by symbol */
+	VG_Index index;				/* Spatial index */
 } VG;
 
 #define  VGVG(o)         ((VG *)(o))
@@ -225,6 +305,7 @@ void   VG_Merge(void *_Nonnull, VG *_Nonnull);
 void   VG_AddRef(void *_Nonnull, void *_Nonnull);
 Uint   VG_DelRef(void *_Nonnull, void *_Nonnull);
 void   VG_NodeTransform(void *_Nonnull, VG_Matrix *_Nonnull);
+void   VG_NodeChanged(void *_Nonnull);
 Uint32 VG_GenNodeName(VG *_Nonnull, const char *_Nonnull)
                      _Warn_Unused_Result;
 
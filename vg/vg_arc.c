@@ -70,6 +70,7 @@ VG_ArcRadius(VG_Arc *va, double r)
 
 	AG_ObjectLock(vg);
 	va->r = r;
+	VG_NodeChanged(va);
 	AG_ObjectUnlock(vg);
 }
 
@@ -189,13 +190,21 @@ Move(void *p, VG_Vector vCurs, VG_Vector vRel)
 	va->r = VG_Distance(VG_Pos(va->p), vCurs);
 }
 
+static void
+RadiusChanged(AG_Event *event)
+{
+	VG_NodeChanged(AG_PTR(1));
+}
+
 static void *
 Edit(void *p, VG_View *vv)
 {
 	VG_Arc *va = p;
 	AG_Box *box = AG_BoxNewVert(NULL, AG_BOX_EXPAND);
+	AG_Numerical *num;
 
-	AG_NumericalNewDbl(box, 0, NULL, _("Radius: "), &va->r);
+	num = AG_NumericalNewDbl(box, 0, NULL, _("Radius: "), &va->r);
+	AG_SetEvent(num, "numerical-changed", RadiusChanged, "%p", va);
 	AG_NumericalNewFlt(box, 0, NULL, _("Start angle: "), &va->a1);
 	AG_NumericalNewFlt(box, 0, NULL, _("End angle: "), &va->a2);
 
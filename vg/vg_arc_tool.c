@@ -52,6 +52,7 @@ static __inline__ void
 AdjustRadius(VG_Arc *_Nonnull va, VG_Vector vPos)
 {
 	va->r = VG_Distance(vPos, VG_Pos(va->p));
+	VG_NodeChanged(va);
 }
 
 static int
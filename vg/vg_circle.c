@@ -152,13 +152,21 @@ Move(void *_Nonnull obj, VG_Vector vCurs, VG_Vector vRel)
 	vc->r = VG_Distance(VG_Pos(vc->p), vCurs);
 }
 
+static void
+RadiusChanged(AG_Event *_Nonnull event)
+{
+	VG_NodeChanged(AG_PTR(1));
+}
+
 static void *_Nonnull
 Edit(void *_Nonnull obj, VG_View *_Nonnull vv)
 {
 	VG_Circle *vc = obj;
 	AG_Box *box = AG_BoxNewVert(NULL, AG_BOX_EXPAND);
+	AG_Numerical *num;
 
-	AG_NumericalNewDbl(box, 0, NULL, _("Radius: "), &vc->r);
+	num = AG_NumericalNewDbl(box, 0, NULL, _("Radius: "), &vc->r);
+	AG_SetEvent(num, "numerical-changed", RadiusChanged, "%p", vc);
 	return (box);
 }
 
@@ -52,6 +52,7 @@ static __inline__ void
 AdjustRadius(VG_Circle *_Nonnull vc, VG_Vector vPos)
 {
 	vc->r = VG_Distance(vPos, VG_Pos(vc->p));
+	VG_NodeChanged(vc);
 }
 
 static int
@@ -60,6 +60,7 @@ VG_LineThickness(VG_Line *vl, Uint8 t)
 
 	AG_ObjectLock(vg);
 	vl->thickness = t;
+	VG_NodeChanged(vl);
 	AG_ObjectUnlock(vg);
 }
 
@@ -70,6 +71,7 @@ VG_LineStipple(VG_Line *vl, Uint16 s)
 
 	AG_ObjectLock(vg);
 	vl->stipple = s;
+	VG_NodeChanged(vl);
 	AG_ObjectUnlock(vg);
 }
 
@@ -101,6 +103,7 @@ VG_LineEndpointStyle(VG_Line *vl, enum vg_line_endpoint style, ...)
 		vl->miterLen = (Uint8)va_arg(ap, int);
 		va_end(ap);
 	}
+	VG_NodeChanged(vl);
 
 	AG_ObjectUnlock(vg);
 }
@@ -55,6 +55,7 @@ VG_PointSize(VG_Point *vp, double r)
 
 	AG_ObjectLock(vg);
 	vp->size = r;
+	VG_NodeChanged(vp);
 	AG_ObjectUnlock(vg);
 }
 
@@ -52,6 +52,7 @@ void
 VG_PolygonSetOutline(VG_Polygon *ply, int flag)
 {
 	ply->outline = flag;
+	VG_NodeChanged(ply);
 }
 
 Uint
@@ -49,58 +49,28 @@ typedef struct vg_select_tool {
 static void *_Nullable
 ProximityQuery(VG_View *_Nonnull vv, VG_Vector vPos)
 {
-	VG *vg = vv->vg;
-	float prox, proxNearest;
-	VG_Node *vn, *vnNearest;
+	VG_Node *vn;
 	VG_Vector v;
 
 #if 0
 	/* First check if we intersect a block. */
-	TAILQ_FOREACH(vn, &vg->nodes, list) {
+	TAILQ_FOREACH(vn, &vv->vg->nodes, list) {
 		if (!VG_NodeIsClass(vn, "Block")) {
 			continue;
 		}
 		v = vPos;
-		prox = vn->ops->pointProximity(vn, vv, &v);
-		if (prox == 0.0f)
+		if (vn->ops->pointProximity(vn, vv, &v) == 0.0f)
 			return (vn);
 	}
 #endif
 
 	/* Then prioritize points at a fixed distance. */
-	proxNearest = AG_FLT_MAX;
-	vnNearest = NULL;
-	TAILQ_FOREACH(vn, &vg->nodes, list) {
-		if (!VG_NodeIsClass(vn, "Point")) {
-			continue;
-		}
-		v = vPos;
-		prox = vn->ops->pointProximity(vn, vv, &v);
-		if (prox <= vv->pointSelRadius) {
-			if (prox < proxNearest) {
-				proxNearest = prox;
-				vnNearest = vn;
-			}
-		}
-	}
-	if (vnNearest != NULL)
-		return (vnNearest);
+	vn = VG_PointProximity(vv, "Point", &vPos, &v, NULL);
+	if (vn != NULL && VG_Distance(vPos, v) <= vv->pointSelRadius)
+		return (vn);
 
 	/* Finally, fallback to a general query. */
-	proxNearest = AG_FLT_MAX;
-	vnNearest = NULL;
-	TAILQ_FOREACH(vn, &vg->nodes, list) {
-		if (vn->ops->pointProximity == NULL) {
-			continue;
-		}
-		v = vPos;
-		prox = vn->ops->pointProximity(vn, vv, &v);
-		if (prox < proxNearest) {
-			proxNearest = prox;
-			vnNearest = vn;
-		}
-	}
-	return (vnNearest);
+	return VG_PointProximity(vv, NULL, &vPos, NULL, NULL);
 }
 
 static int
@@ -187,6 +157,7 @@ MouseMotion(void *_Nonnull obj, VG_Vector vPos, VG_Vector vRel)
 					continue;
 				}
 				vn->ops->moveNode(vn, v, vSnapRel);
+				VG_NodeChanged(vn);
 				VG_Status(vv, _("Moving entity: %s%u (grid)"),
 				    vn->ops->name, (Uint)vn->handle);
 			}
@@ -199,6 +170,7 @@ MouseMotion(void *_Nonnull obj, VG_Vector vPos, VG_Vector vRel)
 				continue;
 			}
 			vn->ops->moveNode(vn, v, vRel);
+			VG_NodeChanged(vn);
 			VG_Status(vv, _("Moving entity: %s%u (free)"),
 			    vn->ops->name, (Uint)vn->handle);
 		}
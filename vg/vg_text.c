@@ -62,6 +62,7 @@ void
 VG_TextAlignment(VG_Text *vt, enum vg_alignment align)
 {
 	vt->align = align;
+	VG_NodeChanged(vt);
 }
 
 void
@@ -71,6 +72,7 @@ VG_TextFontFace(VG_Text *vt, const char *face)
 
 	AG_ObjectLock(vg);
 	AG_Strlcpy(vt->fontFace, face, sizeof(vt->fontFace));
+	VG_NodeChanged(vt);
 	AG_ObjectUnlock(vg);
 }
 
@@ -78,12 +80,14 @@ void
 VG_TextFontSize(VG_Text *vt, float sizePts)
 {
 	vt->fontSize = sizePts;
+	VG_NodeChanged(vt);
 }
 
 void
 VG_TextFontFlags(VG_Text *vt, Uint flags)
 {
 	vt->fontFlags = flags;
+	VG_NodeChanged(vt);
 }
 
 void
@@ -93,6 +97,7 @@ VG_TextSubstObject(VG_Text *vt, void *obj)
 
 	AG_ObjectLock(vg);
 	vt->vsObj = obj;
+	VG_NodeChanged(vt);
 	AG_ObjectUnlock(vg);
 }
 
@@ -159,6 +164,7 @@ VG_TextString(VG_Text *vt, const char *s)
 	} else {
 		vt->text[0] = '\0';
 	}
+	VG_NodeChanged(vt);
 
 	AG_ObjectUnlock(vg);
 }
@@ -179,6 +185,7 @@ VG_TextPrintf(VG_Text *vt, const char *fmt, ...)
 	} else {
 		vt->text[0] = '\0';
 	}
+	VG_NodeChanged(vt);
 
 	AG_ObjectUnlock(vg);
 }
@@ -281,15 +288,17 @@ Extent(void *_Nonnull obj, VG_View *_Nonnull vv, VG_Vector *_Nonnull a,
 	VG_Vector v1, v2;
 	int su;
 
+	v1 = VG_Pos(vt->p1);
+	v2 = VG_Pos(vt->p2);
 	if ((su = AG_TextCacheGet(vv->tCache, vt->text)) == -1) {
-		a->x = 0.0f;
-		a->y = 0.0f;
+		a->x = MIN(v1.x,v2.x);
+		a->y = MIN(v1.y,v2.y);
+		b->x = MAX(v1.x,v2.x);
+		b->y = MAX(v1.y,v2.y);
 		return;
 	}
 	wText = (float)WSURFACE(vv,su)->w/vv->scale;
 	hText = (float)WSURFACE(vv,su)->h/vv->scale;
-	v1 = VG_Pos(vt->p1);
-	v2 = VG_Pos(vt->p2);
 	a->x = MIN(v1.x,v2.x) - wText/2.0f;
 	a->y = MIN(v1.y,v2.y) - hText/2.0f;
 	b->x = MAX(v1.x,v2.x) + hText/2.0f;
@@ -324,7 +333,13 @@ SetAlign(AG_Event *_Nonnull event)
 	VG_Text *vt = AG_PTR(1);
 	enum vg_alignment align = (enum vg_alignment)AG_INT(2);
 
-	vt->align = align;
+	VG_TextAlignment(vt, align);
+}
+
+static void
+TextChanged(AG_Event *_Nonnull event)
+{
+	VG_NodeChanged(AG_PTR(1));
 }
 
 static void
@@ -339,6 +354,7 @@ SelectFont(AG_Event *_Nonnull event)
 	vt->fontFlags = 0;
 	if (fs->curStyle & AG_FONT_BOLD) { vt->fontFlags |= VG_TEXT_BOLD; }
 	if (fs->curStyle & AG_FONT_ITALIC) { vt->fontFlags |= VG_TEXT_ITALIC; }
+	VG_NodeChanged(vt);
 
 	AG_ObjectDetach(win);
 }
@@ -386,6 +402,7 @@ Edit(void *_Nonnull obj, VG_View *_Nonnull vv)
 #else
 	AG_TextboxBindASCII(tb, vt->text, sizeof(vt->text));
 #endif
+	AG_SetEvent(tb, "textbox-postchg", TextChanged, "%p", vt);
 
 	bAlv = AG_BoxNewVert(vPane->div[1], AG_BOX_HFILL | AG_BOX_NO_SPACING);
 	AG_LabelNew(bAlv, 0, _("Alignment: "));
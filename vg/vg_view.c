@@ -75,99 +75,37 @@ VG_ViewNew(void *parent, VG *vg, Uint flags)
 void *
 VG_NearestPoint(VG_View *vv, VG_Vector vPos, void *ignore)
 {
-	float prox, proxNearest = AG_FLT_MAX;
-	VG_Node *vn, *vnNearest = NULL;
-	VG_Vector v;
-
-	TAILQ_FOREACH(vn, &vv->vg->nodes, list) {
-		if (vn->ops->pointProximity == NULL ||
-		    vn == ignore ||
-		    !VG_NodeIsClass(vn, "Point")) {
-			continue;
-		}
-		v = vPos;
-		prox = vn->ops->pointProximity(vn, vv, &v);
-		if (prox < vv->grid[0].ival) {
-			if (prox < proxNearest) {
-				proxNearest = prox;
-				vnNearest = vn;
-			}
-		}
-	}
-	return (vnNearest);
+	return VG_PointProximityMax(vv, "Point", &vPos, NULL, ignore,
+	    (float)vv->grid[0].ival);
 }
 
 /* Return the entity nearest to vPos. */
 void *
 VG_Nearest(VG_View *vv, VG_Vector vPos)
 {
-	VG *vg = vv->vg;
-	float prox, proxNearest;
-	VG_Node *vn, *vnNearest;
+	VG_Node *vn;
 	VG_Vector v;
 
 	/* Prioritize points at a fixed distance. */
-	proxNearest = AG_FLT_MAX;
-	vnNearest = NULL;
-	TAILQ_FOREACH(vn, &vg->nodes, list) {
-		if (!VG_NodeIsClass(vn, "Point")) {
-			continue;
-		}
-		v = vPos;
-		prox = vn->ops->pointProximity(vn, vv, &v);
-		if (prox <= vv->pointSelRadius) {
-			if (prox < proxNearest) {
-				proxNearest = prox;
-				vnNearest = vn;
-			}
-		}
-	}
-	if (vnNearest != NULL)
-		return (vnNearest);
+	vn = VG_PointProximity(vv, "Point", &vPos, &v, NULL);
+	if (vn != NULL && VG_Distance(vPos, v) <= vv->pointSelRadius)
+		return (vn);
 
 	/* Fallback to a general query. */
-	proxNearest = AG_FLT_MAX;
-	vnNearest = NULL;
-	TAILQ_FOREACH(vn, &vg->nodes, list) {
-		if (vn->ops->pointProximity == NULL) {
-			continue;
-		}
-		v = vPos;
-		prox = vn->ops->pointProximity(vn, vv, &v);
-		if (prox < proxNearest) {
-			proxNearest = prox;
-			vnNearest = vn;
-		}
-	}
-	return (vnNearest);
+	return VG_PointProximity(vv, NULL, &vPos, NULL, NULL);
 }
 
 /* Highlight and return the Point nearest to vPos. */
 void *
 VG_HighlightNearestPoint(VG_View *vv, VG_Vector vPos, void *ignore)
 {
-	VG *vg = vv->vg;
-	float prox, proxNearest = AG_FLT_MAX;
-	VG_Node *vn, *vnNearest = NULL;
-	VG_Vector v;
+	VG_Node *vn;
 
-	TAILQ_FOREACH(vn, &vg->nodes, list) {
+	TAILQ_FOREACH(vn, &vv->vg->nodes, list) {
 		vn->flags &= ~(VG_NODE_MOUSEOVER);
-		if (vn->ops->pointProximity == NULL ||
-		    vn == ignore ||
-		    !VG_NodeIsClass(vn, "Point")) {
-			continue;
-		}
-		v = vPos;
-		prox = vn->ops->pointProximity(vn, vv, &v);
-		if (prox < vv->grid[0].ival) {
-			if (prox < proxNearest) {
-				proxNearest = prox;
-				vnNearest = vn;
-			}
-		}
 	}
-	return (vnNearest);
+	return VG_PointProximityMax(vv, "Point", &vPos, NULL, ignore,
+	    (float)vv->grid[0].ival);
 }
 
 /*
@@ -1106,7 +1044,7 @@ AG_WidgetClass vgViewClass = {
 	{
 		"AG_Widget:VG_View",
 		sizeof(VG_View),
-		{ 0,0 },
+		{ 0,0, AGC_VG_VIEW, 0xE013 },
 		Init,
 		NULL,		/* reset */
 		Destroy,